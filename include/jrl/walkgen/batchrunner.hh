@@ -0,0 +1,119 @@
+/*
+ * Copyright 2019,
+ *
+ * Olivier Stasse
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+/*! \file batchrunner.hh
+  \brief Run batches of walking rollouts on several pattern generators
+  in parallel.
+*/
+
+#ifndef _PATTERN_GENERATOR_BATCH_RUNNER_H_
+#define _PATTERN_GENERATOR_BATCH_RUNNER_H_
+
+#include <vector>
+
+#include <boost/function.hpp>
+
+#include <jrl/walkgen/patterngeneratorinterface.hh>
+
+namespace PatternGeneratorJRL
+{
+  class WorkStealingPool;
+
+  /** @ingroup Interface
+      Drives several pattern generators over a pool of threads.
+
+      Pattern generator instances do not share any mutable state,
+      so several of them can run at the same time provided that each
+      one is used by a single thread and has its own PinocchioRobot
+      and pinocchio::Data. The pinocchio::Model can be shared as it is
+      only read once the robot is initialized.
+
+      The batch runner enforces this rule: one instance is created
+      per worker thread through the factory, and each worker only runs
+      its rollouts on its own instance.
+      The rollouts are balanced between the workers by work stealing.
+      A rollout is thus responsible for the re-initialization of the
+      generator it receives (for instance with :HerdtOnline).
+  */
+  class WALK_GEN_JRL_EXPORT PatternGeneratorBatchRunner
+  {
+  public:
+    /*! \brief Creates the pattern generator of a worker.
+      Called once per worker by the constructor. */
+    typedef boost::function<PatternGeneratorInterface *
+                            (unsigned int WorkerId)> Factory;
+
+    /*! \brief Releases the pattern generator of a worker.
+      When empty, the generator is deleted. */
+    typedef boost::function<void (unsigned int WorkerId,
+                                  PatternGeneratorInterface *)> Release;
+
+    /*! \brief One rollout on the pattern generator of a worker,
+      returns false if the rollout failed. */
+    typedef boost::function<bool (unsigned int WorkerId,
+                                  unsigned int RolloutId,
+                                  PatternGeneratorInterface &)> Rollout;
+
+    /*! \brief Start NbOfWorkers threads, with 0 one per hardware thread. */
+    PatternGeneratorBatchRunner(const Factory & aFactory,
+                                unsigned int NbOfWorkers=0,
+                                const Release & aRelease=Release());
+
+    /*! \brief Stop the threads and release the pattern generators. */
+    ~PatternGeneratorBatchRunner();
+
+    /*! \brief Number of worker threads. */
+    unsigned int NbOfWorkers() const;
+
+    /*! \brief Run the rollouts 0 to NbOfRollouts-1 and wait for them.
+      Returns the number of rollouts which succeeded. */
+    unsigned int Run(unsigned int NbOfRollouts,
+                     const Rollout & aRollout);
+
+    /*! \brief Number of rollouts run by each worker during the last Run(). */
+    const std::vector<unsigned int> & NbOfRolloutsPerWorker() const
+    { return m_NbOfRollouts; }
+
+  private:
+    void RunOneRollout(unsigned int WorkerId,
+                       unsigned int RolloutId,
+                       const Rollout * aRollout);
+
+    Factory m_Factory;
+    Release m_Release;
+    WorkStealingPool * m_Pool;
+
+    /*! \name Per worker data, only accessed by the worker thread
+      while the rollouts are running.
+      @{ */
+    std::vector<PatternGeneratorInterface *> m_Instances;
+    std::vector<unsigned int> m_NbOfRollouts, m_NbOfSuccesses;
+    /*! @} */
+
+    PatternGeneratorBatchRunner(const PatternGeneratorBatchRunner &);
+    PatternGeneratorBatchRunner &
+    operator=(const PatternGeneratorBatchRunner &);
+  };
+}
+
+#endif /* _PATTERN_GENERATOR_BATCH_RUNNER_H_ */
@@ -269,6 +269,21 @@ namespace PatternGeneratorJRL
 
       /*! \brief Parse a command (to be used out of a plugin) and call all objects which registered the method. */
       virtual int ParseCmd(std::istringstream &strm)=0;
+
+      /*! \brief Resolve once the name of a command into a handle.
+	Returns -1 if no object registered the command.
+	The handle stays valid for the life time of the object. */
+      virtual CommandHandle ResolveCommand(const std::string &aCommandName)=0;
+
+      /*! \brief Call a command resolved by ResolveCommand() with typed
+	arguments. Unlike ParseCmd(), no string is built nor parsed for the
+	commands which support it (for instance :setVelReference,
+	:setCoMPerturbationForce, :feedBackControl), which makes it
+	suitable for the control loop. Boolean arguments are passed
+	as 0 or 1.
+	Returns false if the handle is invalid. */
+      virtual bool CallCommand(CommandHandle aHandle,
+			       const CommandArguments &Arguments)=0;
     
 
       /*! @} */
@@ -301,6 +316,70 @@ namespace PatternGeneratorJRL
        */
       virtual void setCoMPerturbationForce(double x, double y)=0;
 
+      /*! \name Snapshot of the generator state.
+	Used to explore several futures from the same state, for instance
+	several velocity references, without creating a new pattern generator.
+	Only the on-line algorithms (Herdt and Naveau) support it.
+	@{ */
+
+      /*! \brief Capture the state of the pattern generator: the trajectory
+	buffers, the step stack, and the state of the active ZMP and CoM
+	trajectory generator.
+	The storage of a released snapshot is reused by the next one, so after
+	the first captures no memory is allocated.
+	Returns -1 if the current algorithm does not support snapshots. */
+      virtual SnapshotHandle Snapshot()=0;
+
+      /*! \brief Set back the state captured by Snapshot().
+	A snapshot can be restored several times.
+	Returns false if the handle is invalid or if the algorithm
+	has changed since the capture. */
+      virtual bool Restore(SnapshotHandle aHandle)=0;
+
+      /*! \brief Give back the storage of a snapshot. */
+      virtual void ReleaseSnapshot(SnapshotHandle aHandle)=0;
+
+      /*! @} */
+
+      /*! \brief Copy the next NbOfSamples samples of the planned
+	trajectory into aWindow, one column per channel.
+	The first sample is the front of the internal buffers, i.e. the next
+	sample as planned by the last call to RunOneStepOfTheControlLoop();
+	the on-line algorithms may replan it. The window is shorter if the
+	buffers hold less samples.
+	The matrices are only resized when the number of samples changes.
+	Returns the number of samples copied. */
+      virtual unsigned int GetTrajectoryWindow(unsigned int NbOfSamples,
+					       TrajectoryWindow & aWindow)
+	const=0;
+
+      /*! \name Latency of the control cycle.
+	The duration of each stage of RunOneStepOfTheControlLoop() is
+	recorded in a histogram of fixed size, so the measurement is
+	always on and does not allocate memory.
+	@{ */
+
+      /*! \brief Number of samples, median, 99th percentile and maximum
+	of the duration of a stage since the last reset. */
+      virtual void GetStageLatency(ControlCycleStage aStage,
+				   StageLatency & aLatency) const=0;
+
+      /*! \brief Restart the measurement of all the stages. */
+      virtual void ResetStageLatencies()=0;
+
+      /*! @} */
+
+      /*! \brief Metrics of the asynchronous planning
+	(command :asyncplanning) of the Naveau 2015 algorithm.
+	Returns false if the current algorithm is not Naveau 2015. */
+      virtual bool GetPlannerStatistics(PlannerStatistics & aStatistics)
+	const=0;
+
+      /*! \brief Report of the last SQP solve of the Naveau 2015
+	algorithm. Returns false if the current algorithm is not
+	Naveau 2015. */
+      virtual bool GetSQPSolveStatus(SQPSolveStatus & aStatus) const=0;
+
     };
 
   /*! Factory of Pattern generator interface. */
@@ -323,5 +323,155 @@ namespace PatternGeneratorJRL
     return os;
   }
 
+  /*! Handle on a command resolved once by
+    PatternGeneratorInterface::ResolveCommand().
+    A negative value is an invalid handle. */
+  typedef int CommandHandle;
+
+  /*! Handle on a state of the pattern generator captured by
+    PatternGeneratorInterface::Snapshot().
+    A negative value is an invalid handle. */
+  typedef int SnapshotHandle;
+
+  /*! Time window of the planned trajectory stored as structure of arrays:
+    each matrix has one row per sample and one column per channel.
+    The matrices are column-major, so a channel is contiguous in memory.
+    Filled by PatternGeneratorInterface::GetTrajectoryWindow(). */
+  struct TrajectoryWindow_s
+  {
+    /*! Columns of CoM, LeftFoot and RightFoot: position, velocity
+      and acceleration along x, y, z, and around the vertical axis
+      (yaw of the CoM, theta of the feet). */
+    enum { X=0, DX, DDX, Y, DY, DDY, Z, DZ, DDZ,
+	   YAW, DYAW, DDYAW, NB_OF_CHANNELS };
+
+    /*! Columns of ZMP. */
+    enum { ZMP_X=0, ZMP_Y, ZMP_Z, NB_OF_ZMP_CHANNELS };
+
+    typedef Eigen::Matrix<double,Eigen::Dynamic,NB_OF_CHANNELS> Channels;
+    typedef Eigen::Matrix<double,Eigen::Dynamic,NB_OF_ZMP_CHANNELS>
+      ZMPChannels;
+
+    /*! Time of each sample. */
+    Eigen::VectorXd Time;
+    ZMPChannels ZMP;
+    Channels CoM;
+    Channels LeftFoot, RightFoot;
+  };
+  typedef struct TrajectoryWindow_s TrajectoryWindow;
+
+  /*! Stages of a control cycle whose latency is measured.
+    Some stages are nested: the QP, dynamic filter and foot trajectory
+    stages are part of the ZMP and CoM generation. */
+  enum ControlCycleStage_t
+  {
+    STAGE_CONTROL_CYCLE=0,
+    STAGE_STEP_STACK,
+    STAGE_ZMP_COM_GENERATION,
+    STAGE_QP_BUILD,
+    STAGE_QP_SOLVE,
+    STAGE_DYNAMIC_FILTER,
+    STAGE_FOOT_TRAJECTORY,
+    STAGE_IK,
+    NB_OF_CONTROL_CYCLE_STAGES
+  };
+  typedef enum ControlCycleStage_t ControlCycleStage;
+
+  /*! Latency statistics of a stage of the control cycle,
+    in seconds. The percentiles are upper bounds with a relative
+    precision of about 3 %. */
+  struct StageLatency_s
+  {
+    unsigned long int Count;
+    double P50, P99, Max;
+  };
+  typedef struct StageLatency_s StageLatency;
+
+  /*! Metrics of the asynchronous planning of the Naveau 2015
+    generator (command :asyncplanning), filled by
+    PatternGeneratorInterface::GetPlannerStatistics(). */
+  struct PlannerStatistics_s
+  {
+    /*! The planner thread is running. */
+    bool Running;
+    /*! Age of the plan used at the last update, i.e. the time (s)
+      elapsed since the initial condition it has been computed for,
+      and its maximum since the beginning of the walk. */
+    double PlanAge, MaxPlanAge;
+    /*! Number of plans received from the planner thread. */
+    unsigned long int NbOfPlans;
+    /*! Number of updates for which no new plan was available before
+      the end of the first sampling period of the plan in use.
+      The control thread then keeps following this plan. */
+    unsigned long int NbOfMissedDeadlines;
+  };
+  typedef struct PlannerStatistics_s PlannerStatistics;
+
+  /*! Report of the last SQP solve of the Naveau 2015 generator,
+    filled by PatternGeneratorInterface::GetSQPSolveStatus().
+    The solve is bounded by the commands :sqpmaxiterations and
+    :sqpsolvebudget. With asynchronous planning, it reports the
+    solve of the last plan received. */
+  struct SQPSolveStatus_s
+  {
+    /*! Number of SQP iterations done. */
+    unsigned int NbOfIterations;
+    /*! The last step was small enough to stop. */
+    bool Converged;
+    /*! The iterations were stopped by the time budget. */
+    bool DeadlineReached;
+    /*! A QP failed. */
+    bool QPFailed;
+    /*! The returned iterate satisfies the inequality constraints,
+      and the sum of their violations. */
+    bool Feasible;
+    double ConstraintViolation;
+    /*! Time spent in the solve, and in its longest iteration (s). */
+    double Duration, MaxIterationDuration;
+  };
+  typedef struct SQPSolveStatus_s SQPSolveStatus;
+
+  /// Structure to store the typed arguments of a resolved command.
+  /// Boolean arguments are stored as 0.0 or 1.0.
+  struct CommandArguments_s
+  {
+    enum { MAX_NB_OF_ARGUMENTS=8 };
+
+    /*! Number of arguments really used. */
+    unsigned int NbOfArguments;
+    double Values[MAX_NB_OF_ARGUMENTS];
+
+    CommandArguments_s():
+      NbOfArguments(0) {}
+    explicit CommandArguments_s(double a0):
+      NbOfArguments(1) { Values[0]=a0; }
+    CommandArguments_s(double a0, double a1):
+      NbOfArguments(2) { Values[0]=a0; Values[1]=a1; }
+    CommandArguments_s(double a0, double a1, double a2):
+      NbOfArguments(3) { Values[0]=a0; Values[1]=a1; Values[2]=a2; }
+
+    /*! Returns false if there is no room left. */
+    inline bool push_back(double aValue)
+    {
+      if (NbOfArguments>=MAX_NB_OF_ARGUMENTS)
+        return false;
+      Values[NbOfArguments++]=aValue;
+      return true;
+    }
+    inline unsigned int size() const
+    { return NbOfArguments; }
+    inline double operator[](unsigned int i) const
+    { return Values[i]; }
+  };
+  typedef struct CommandArguments_s CommandArguments;
+
+  inline std::ostream & operator<<(std::ostream & os,
+                                   const CommandArguments_s & args)
+  {
+    for(unsigned int i=0;i<args.NbOfArguments;i++)
+      os << " " << args.Values[i];
+    return os;
+  }
+
 }
 #endif
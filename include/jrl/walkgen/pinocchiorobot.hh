@@ -154,6 +154,17 @@ namespace PatternGeneratorJRL
     void DetectAutomaticallyOneShoulder(pinocchio::JointIndex aWrist,
                                         pinocchio::JointIndex & aShoulder);
 
+    /// \brief Convert (q,v,a), with roll-pitch-yaw angles for the free
+    /// flyer, to the vectors of pinocchio (qp,vp,ap).
+    /// The last 6 entries of the joints are not set.
+    void toPinocchioState(const Eigen::VectorXd & q,
+                          const Eigen::VectorXd & v,
+                          const Eigen::VectorXd & a,
+                          Eigen::Quaterniond & quat,
+                          Eigen::Matrix3d & rot,
+                          Eigen::VectorXd & qp,
+                          Eigen::VectorXd & vp,
+                          Eigen::VectorXd & ap) const;
 
   public :
     /// Getters
@@ -207,6 +218,27 @@ namespace PatternGeneratorJRL
       zmp(2) = 0.0 ; // by default
     }
 
+    /// \brief Inverse dynamics and multibody ZMP of (q,v,a), given as
+    /// for computeInverseDynamics, computed in aData.
+    /// qp, vp and ap are buffers for the vectors of pinocchio. They are
+    /// filled as by computeInverseDynamics, so that both give the same ZMP.
+    /// The members of the robot are not modified: several threads can
+    /// call this method at the same time, with their own aData and buffers,
+    /// as long as no other method of the robot is called meanwhile.
+    void zeroMomentumPoint(const Eigen::VectorXd & q,
+                           const Eigen::VectorXd & v,
+                           const Eigen::VectorXd & a,
+                           pinocchio::Data & aData,
+                           Eigen::VectorXd & qp,
+                           Eigen::VectorXd & vp,
+                           Eigen::VectorXd & ap,
+                           Eigen::Vector3d & zmp) const;
+
+    /// \brief New data of the model, for zeroMomentumPoint
+    /// called from another thread. To be deleted by the caller.
+    inline pinocchio::Data * newData() const
+    { return new pinocchio::Data(*m_robotModel); }
+
     inline void positionCenterOfMass(Eigen::Vector3d & com)
     {
       m_com = m_robotData->com[0] ;
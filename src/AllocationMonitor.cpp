@@ -0,0 +1,129 @@
+/*
+ * Copyright 2019,
+ *
+ * Olivier Stasse
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+/*! \file AllocationMonitor.cpp
+  \brief Hook on the heap allocations to check the real-time loop.
+*/
+#include <cassert>
+#include <cstdlib>
+
+#include <AllocationMonitor.hh>
+
+using namespace PatternGeneratorJRL;
+
+namespace
+{
+  /* Per thread status: several pattern generators can run
+     in different threads, and the planner or the worker threads
+     of a generator allocate while the control thread is in its
+     section. Nothing process-wide (like the flag of
+     EIGEN_RUNTIME_NO_MALLOC) may be used.
+     The initial-exec model is required because the variables
+     are read by the allocation hook: the dynamic model may
+     allocate on the first access. */
+  __thread int s_RealTimeSectionDepth
+  __attribute__((tls_model("initial-exec"))) = 0;
+  __thread unsigned long int s_NbOfAllocations
+  __attribute__((tls_model("initial-exec"))) = 0;
+}
+
+void AllocationMonitor::EnterRealTimeSection()
+{
+  s_RealTimeSectionDepth++;
+}
+
+void AllocationMonitor::LeaveRealTimeSection()
+{
+  if (s_RealTimeSectionDepth>0)
+    s_RealTimeSectionDepth--;
+}
+
+bool AllocationMonitor::InRealTimeSection()
+{
+  return s_RealTimeSectionDepth>0;
+}
+
+void AllocationMonitor::RecordAllocation()
+{
+  if (s_RealTimeSectionDepth>0)
+  {
+    s_NbOfAllocations++;
+#ifndef NDEBUG
+    // The report of the assertion allocates.
+    s_RealTimeSectionDepth = 0;
+#endif
+    assert(false && "heap allocation inside the real-time control loop");
+  }
+}
+
+unsigned long int AllocationMonitor::NbOfAllocations()
+{
+  return s_NbOfAllocations;
+}
+
+void AllocationMonitor::Reset()
+{
+  s_NbOfAllocations = 0;
+}
+
+bool AllocationMonitor::IsHookActive()
+{
+#ifdef JRL_WALKGEN_CHECK_RT_ALLOCATIONS
+  return true;
+#else
+  return false;
+#endif
+}
+
+#ifdef JRL_WALKGEN_CHECK_RT_ALLOCATIONS
+/* Interposition of the allocation functions of the C library (glibc).
+   operator new and the aligned allocations of Eigen both end up
+   in malloc, so that every allocation of the current thread is seen.
+   Only the allocations are reported: a deallocation inside the loop
+   always releases memory which has been allocated somewhere,
+   and this allocation is reported if it happened in the loop. */
+extern "C"
+{
+  void * __libc_malloc(size_t size);
+  void * __libc_calloc(size_t nmemb, size_t size);
+  void * __libc_realloc(void * ptr, size_t size);
+
+  void * malloc(size_t size)
+  {
+    AllocationMonitor::RecordAllocation();
+    return __libc_malloc(size);
+  }
+
+  void * calloc(size_t nmemb, size_t size)
+  {
+    AllocationMonitor::RecordAllocation();
+    return __libc_calloc(nmemb,size);
+  }
+
+  void * realloc(void * ptr, size_t size)
+  {
+    AllocationMonitor::RecordAllocation();
+    return __libc_realloc(ptr,size);
+  }
+}
+#endif
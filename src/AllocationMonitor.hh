@@ -0,0 +1,102 @@
+/*
+ * Copyright 2019,
+ *
+ * Olivier Stasse
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+
+/*! \file AllocationMonitor.hh
+    \brief Detects heap allocations performed inside the real-time loop.
+*/
+#ifndef _HWPG_ALLOCATION_MONITOR_H_
+# define _HWPG_ALLOCATION_MONITOR_H_
+
+namespace PatternGeneratorJRL
+{
+  /*! \brief Count the heap allocations performed inside a real-time section.
+
+    A real-time section is opened by RealTimeSection around the code
+    which is supposed to run at the control frequency
+    (typically RunOneStepOfTheControlLoop).
+
+    When the library is compiled with CHECK_REALTIME_ALLOCATIONS,
+    malloc is hooked (glibc only) and every allocation performed
+    by the current thread inside a section is counted, including
+    the ones of operator new and of Eigen.
+    In debug builds (NDEBUG not defined) such an allocation triggers
+    an assertion. The other threads are not affected: they can
+    allocate while the control thread is inside its section.
+    Without this option the sections are no-ops and NbOfAllocations()
+    always returns 0.
+  */
+  class AllocationMonitor
+  {
+  public:
+
+    /*! \brief Open a real-time section for the current thread.
+      Sections can be nested. */
+    static void EnterRealTimeSection();
+
+    /*! \brief Close the last opened real-time section. */
+    static void LeaveRealTimeSection();
+
+    /*! \brief Returns true if the current thread is inside a section. */
+    static bool InRealTimeSection();
+
+    /*! \brief Called by the allocation hook. */
+    static void RecordAllocation();
+
+    /*! \brief Number of allocations done by the current thread
+      inside real-time sections since the last Reset(). */
+    static unsigned long int NbOfAllocations();
+
+    /*! \brief Reset the counter of the current thread. */
+    static void Reset();
+
+    /*! \brief Returns true if the allocation hook is compiled in. */
+    static bool IsHookActive();
+  };
+
+  /*! \brief Scoped real-time section.
+    Nothing is done if the section is not active. */
+  class RealTimeSection
+  {
+  public:
+    explicit RealTimeSection(bool active)
+      : m_Active(active)
+    {
+      if (m_Active)
+        AllocationMonitor::EnterRealTimeSection();
+    }
+
+    ~RealTimeSection()
+    {
+      if (m_Active)
+        AllocationMonitor::LeaveRealTimeSection();
+    }
+
+  private:
+    bool m_Active;
+
+    RealTimeSection(const RealTimeSection &);
+    RealTimeSection & operator=(const RealTimeSection &);
+  };
+}
+#endif /* _HWPG_ALLOCATION_MONITOR_H_ */
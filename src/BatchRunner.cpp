@@ -0,0 +1,114 @@
+/*
+ * Copyright 2019,
+ *
+ * Olivier Stasse
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+/*! \file BatchRunner.cpp
+  \brief Run batches of walking rollouts on several pattern generators
+  in parallel.
+*/
+
+// Placeholders are in the global namespace with all Boost versions.
+#define BOOST_BIND_GLOBAL_PLACEHOLDERS
+#include <boost/bind.hpp>
+
+#include <jrl/walkgen/batchrunner.hh>
+#include <WorkStealingPool.hh>
+
+#include <Debug.hh>
+
+using namespace std;
+using namespace PatternGeneratorJRL;
+
+PatternGeneratorBatchRunner::
+PatternGeneratorBatchRunner(const Factory & aFactory,
+                            unsigned int NbOfWorkers,
+                            const Release & aRelease):
+  m_Factory(aFactory),
+  m_Release(aRelease)
+{
+  m_Pool = new WorkStealingPool(NbOfWorkers);
+  m_Instances.resize(m_Pool->NbOfWorkers(),0);
+  for(unsigned int i=0;i<m_Instances.size();i++)
+    m_Instances[i] = m_Factory(i);
+  m_NbOfRollouts.resize(m_Pool->NbOfWorkers(),0);
+  m_NbOfSuccesses.resize(m_Pool->NbOfWorkers(),0);
+}
+
+PatternGeneratorBatchRunner::~PatternGeneratorBatchRunner()
+{
+  delete m_Pool;
+
+  for(unsigned int i=0;i<m_Instances.size();i++)
+  {
+    if (m_Instances[i]==0)
+      continue;
+    if (m_Release)
+      m_Release(i,m_Instances[i]);
+    else
+      delete m_Instances[i];
+  }
+}
+
+unsigned int PatternGeneratorBatchRunner::NbOfWorkers() const
+{
+  return m_Pool->NbOfWorkers();
+}
+
+unsigned int PatternGeneratorBatchRunner::
+Run(unsigned int NbOfRollouts,
+    const Rollout & aRollout)
+{
+  for(unsigned int i=0;i<m_NbOfRollouts.size();i++)
+  {
+    m_NbOfRollouts[i] = 0;
+    m_NbOfSuccesses[i] = 0;
+  }
+
+  for(unsigned int lRolloutId=0;lRolloutId<NbOfRollouts;lRolloutId++)
+    m_Pool->Submit(boost::bind(&PatternGeneratorBatchRunner::RunOneRollout,
+                               this,_1,lRolloutId,&aRollout));
+  m_Pool->Wait();
+
+  unsigned int lNbOfSuccesses = 0;
+  for(unsigned int i=0;i<m_NbOfSuccesses.size();i++)
+    lNbOfSuccesses += m_NbOfSuccesses[i];
+  ODEBUG("Batch of " << NbOfRollouts << " rollouts, "
+         << lNbOfSuccesses << " succeeded, "
+         << m_Pool->NbOfSteals() << " steals so far");
+  return lNbOfSuccesses;
+}
+
+void PatternGeneratorBatchRunner::
+RunOneRollout(unsigned int WorkerId,
+              unsigned int RolloutId,
+              const Rollout * aRollout)
+{
+  m_NbOfRollouts[WorkerId]++;
+  if (m_Instances[WorkerId]==0)
+  {
+    cerr << "PatternGeneratorBatchRunner: no pattern generator for worker "
+         << WorkerId << endl;
+    return;
+  }
+  if ((*aRollout)(WorkerId,RolloutId,*m_Instances[WorkerId]))
+    m_NbOfSuccesses[WorkerId]++;
+}
@@ -43,11 +43,6 @@ using namespace PatternGeneratorJRL;
 Clock::Clock()
 {
   Reset();
-  m_DataBuffer.resize(300000);
-
-  struct timeval startingtime;
-  gettimeofday(&startingtime,0);
-  m_StartingTime = startingtime.tv_sec + 0.000001 * startingtime.tv_usec;
 }
 
 
@@ -58,32 +53,21 @@ Clock::~Clock()
 void Clock::Reset()
 {
   m_NbOfIterations = 0;
-  m_MaximumTime = 0.0;
   m_TotalTime=0.0;
-
-  struct timeval startingtime;
-  gettimeofday(&startingtime,0);
-  m_StartingTime = startingtime.tv_sec + 0.000001 * startingtime.tv_usec;
+  m_BeginTimeStamp = MonotonicTime();
+  m_Histogram.Reset();
 }
 
 void Clock::StartTiming()
 {
-  gettimeofday(&m_BeginTimeStamp,0);
-
+  m_BeginTimeStamp = MonotonicTime();
 }
 
 void Clock::StopTiming()
 {
-  gettimeofday(&m_EndTimeStamp,0);
-  double ltime = m_EndTimeStamp.tv_sec - m_BeginTimeStamp.tv_sec +
-    0.000001 * (m_EndTimeStamp.tv_usec - m_BeginTimeStamp.tv_usec);
-
-  m_MaximumTime = m_MaximumTime < ltime ? ltime : m_MaximumTime;
-  m_TotalTime += ltime;
-
-  m_DataBuffer[(m_NbOfIterations*2)%3000000]=m_BeginTimeStamp.tv_sec +
-    0.000001 * m_BeginTimeStamp.tv_usec - m_StartingTime;
-  m_DataBuffer[(m_NbOfIterations*2+1)%3000000]=ltime;
+  unsigned long long lDuration = MonotonicTime()-m_BeginTimeStamp;
+  m_Histogram.Record(lDuration);
+  m_TotalTime += 1e-9*(double)lDuration;
 }
 
 void Clock::IncIteration(int lNbOfIts)
@@ -93,9 +77,11 @@ void Clock::IncIteration(int lNbOfIts)
 
 void Clock::RecordDataBuffer(std::string filename)
 {
+  const double lFractions[6] = { 0.5, 0.9, 0.99, 0.999, 0.9999, 1.0 };
   std::ofstream aof(filename.c_str());
-  for(unsigned int i=0;i<2*m_NbOfIterations%300000;i+=2)
-    aof << m_DataBuffer[i]<< " " << m_DataBuffer[i+1] << std::endl;
+  for(unsigned int i=0;i<6;i++)
+    aof << lFractions[i] << " "
+        << 1e-9*(double)m_Histogram.Percentile(lFractions[i]) << std::endl;
   aof.close();
 }
 unsigned long int Clock::NbOfIterations()
@@ -105,7 +91,7 @@ unsigned long int Clock::NbOfIterations()
 
 double Clock::MaxTime()
 {
-  return m_MaximumTime;
+  return 1e-9*(double)m_Histogram.Max();
 }
 
 double Clock::TotalTime()
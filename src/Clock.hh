@@ -28,16 +28,9 @@
 */
 #ifndef _HWPG_CLOCK_H_
 # define _HWPG_CLOCK_H_
-# include <time.h>
-# include <vector>
 # include <string>
 
-# include "portability/gettimeofday.hh"
-
-# ifdef WIN32
-#  include <Windows.h>
-# endif
-
+# include <LatencyHistogram.hh>
 
 namespace PatternGeneratorJRL
 {
@@ -47,7 +40,8 @@ namespace PatternGeneratorJRL
     MaxTime() and AverageTime() returns the maximum time spend in one iteration,
     and the average time spends in one iteration respectively.
     TotalTime() returns the time spend in total in the code measured.
-    The precision is expected to be in micro-second but is OS dependent.
+    The durations are measured with a monotonic clock and stored in a
+    histogram of fixed size, so the clock can stay enabled.
   */
   class  Clock
   {
@@ -89,28 +83,27 @@ namespace PatternGeneratorJRL
     /*! \brief Display a brief description of the current status. */
     void Display();
 
-    /*! \brief Record buffer of time consumption. */
+    /*! \brief Record the distribution of the time consumption:
+      one line per percentile with the fraction and the duration. */
     void RecordDataBuffer(std::string filename);
 
-  private:
+    /*! \brief Distribution of the measured durations. */
+    const LatencyHistogram & Histogram() const
+    { return m_Histogram; }
 
-    /*! Storing begin and end timestamps. */
-    struct timeval m_BeginTimeStamp, m_EndTimeStamp;
+  private:
 
-    /*! Starting time of the clock. */
-    double m_StartingTime;
+    /*! Begin timestamp in nanoseconds. */
+    unsigned long long m_BeginTimeStamp;
 
     /*! Number of iterations. */
     unsigned long int m_NbOfIterations;
 
-    /*! Maximum time. */
-    double m_MaximumTime;
-
     /*! Total time. */
     double m_TotalTime;
 
-    /*! Buffer */
-    std::vector<double> m_DataBuffer;
+    /*! Distribution of the durations. */
+    LatencyHistogram m_Histogram;
   };
 }
 #endif /* _HWPG_CLOCK_H_ */
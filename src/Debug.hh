@@ -74,16 +74,22 @@ DebugFile << x << std::endl; \
 #endif
 
 #ifdef _DEBUG_MODE_ON_
+#include <TraceRecorder.hh>
+
 #define RESETDEBUG4(y) { std::ofstream DebugFile; DebugFile.open(y,ofstream::out); DebugFile.close();}
 #define ODEBUG4(x,y) { std::ofstream DebugFile; DebugFile.open(y,ofstream::app); \
     DebugFile << __FILE__ << ":" \
               << __FUNCTION__ << "(#" \
               << __LINE__ << "):" << x << std::endl; \
     DebugFile.close();}
-#define ODEBUG4SIMPLE(x,y) { std::ofstream DebugFile; \
+/* The columns go to the trace recorder when it is started. */
+#define ODEBUG4SIMPLE(x,y) { \
+  if (PatternGeneratorJRL::TraceRecorder::Instance().IsRunning()) \
+    OTRACE(x,y) \
+  else { std::ofstream DebugFile; \
 DebugFile.open(y,ofstream::app); \
 DebugFile << x << std::endl; \
-          DebugFile.close();}
+          DebugFile.close();} }
 
 #define _DEBUG_4_ACTIVATED_ 1
 #else
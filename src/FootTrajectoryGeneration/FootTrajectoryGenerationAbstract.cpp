@@ -100,8 +100,8 @@ void FootTrajectoryGenerationAbstract::CallMethod(std::string &Method,
 
 void FootTrajectoryGenerationAbstract::
 UpdateFootPosition
-(std::deque<FootAbsolutePosition> & , //SupportFootAbsolutePositions,
- std::deque<FootAbsolutePosition> &, //NoneSupportFootAbsolutePositions,
+(RingBuffer<FootAbsolutePosition> & , //SupportFootAbsolutePositions,
+ RingBuffer<FootAbsolutePosition> &, //NoneSupportFootAbsolutePositions,
  int , //CurrentAbsoluteIndex,
  int , //IndexInitial,
  double , //ModulatedSingleSupportTime,
@@ -114,8 +114,8 @@ UpdateFootPosition
 
 void FootTrajectoryGenerationAbstract::
 UpdateFootPosition
-(std::deque<FootAbsolutePosition> & ,//SupportFootAbsolutePositions,
- std::deque<FootAbsolutePosition> & ,//NoneSupportFootAbsolutePositions,
+(RingBuffer<FootAbsolutePosition> & ,//SupportFootAbsolutePositions,
+ RingBuffer<FootAbsolutePosition> & ,//NoneSupportFootAbsolutePositions,
  int , // StartIndex,
  int , //k,
  double , //LocalInterpolationStartTime,
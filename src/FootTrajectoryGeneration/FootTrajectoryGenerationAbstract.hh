@@ -36,6 +36,7 @@
 #include <deque>
 
 
+#include <RingBuffer.hh>
 /* dynamics pinocchio related inclusions */
 #include <jrl/walkgen/pinocchiorobot.hh>
 
@@ -105,15 +106,15 @@ namespace PatternGeneratorJRL
       @param StepType: Type of steps (for book-keeping).
       @param LeftOrRight: Specify if it is left (1) or right (-1).
     */
-    virtual void UpdateFootPosition(std::deque<FootAbsolutePosition> &SupportFootAbsolutePositions,
-				    std::deque<FootAbsolutePosition> &NoneSupportFootAbsolutePositions,
+    virtual void UpdateFootPosition(RingBuffer<FootAbsolutePosition> &SupportFootAbsolutePositions,
+				    RingBuffer<FootAbsolutePosition> &NoneSupportFootAbsolutePositions,
 				    int CurrentAbsoluteIndex,
 				    int IndexInitial,
 				    double ModulatedSingleSupportTime,
 				    int StepType, int LeftOrRight);
 
-    virtual void UpdateFootPosition(std::deque<FootAbsolutePosition> &SupportFootAbsolutePositions,
-				    std::deque<FootAbsolutePosition> &NoneSupportFootAbsolutePositions,
+    virtual void UpdateFootPosition(RingBuffer<FootAbsolutePosition> &SupportFootAbsolutePositions,
+				    RingBuffer<FootAbsolutePosition> &NoneSupportFootAbsolutePositions,
 				    int StartIndex, int k,
 				    double LocalInterpolationStartTime,
 				    double ModulatedSingleSupportTime,
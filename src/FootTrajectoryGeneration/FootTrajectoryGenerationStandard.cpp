@@ -33,6 +33,9 @@
 
 using namespace PatternGeneratorJRL;
 
+const std::vector<double> FootTrajectoryGenerationStandard::
+m_NoMiddlePos(3,-1);
+
 FootTrajectoryGenerationStandard::
 FootTrajectoryGenerationStandard
 (SimplePluginManager *lSPM,
@@ -51,6 +54,8 @@ FootTrajectoryGenerationStandard
   m_BsplinesX = 0;
   m_BsplinesY = 0;
   m_BsplinesZ = 0;
+  m_MP.reserve(2);
+  m_ToMP.reserve(2);
 
 
   /* Computes information on foot dimension
@@ -244,15 +249,17 @@ SetParametersWithInitPosInitSpeed
  double FinalPosition,
  double InitPosition,
  double InitSpeed,
- vector<double> MiddlePos)
+ const vector<double> & MiddlePos)
 {
   double epsilon = 0.0001;
   double WayPoint_x = MiddlePos[0] ;
   double WayPoint_y = MiddlePos[1] ;
   double WayPoint_z = MiddlePos[2] ;
 
-  vector<double> MP ;
-  vector<double> ToMP ;
+  vector<double> & MP = m_MP;
+  vector<double> & ToMP = m_ToMP;
+  MP.clear();
+  ToMP.clear();
 
   bool isWayPointSet =
     WayPoint_x != WayPoint_y &&
@@ -370,15 +377,17 @@ SetParameters
  double InitPosition,
  double InitSpeed,
  double InitAcc,
- vector<double> MiddlePos)
+ const vector<double> & MiddlePos)
 {
   double epsilon = 0.0001;
   double WayPoint_x = MiddlePos[0] ;
   double WayPoint_y = MiddlePos[1] ;
   double WayPoint_z = MiddlePos[2] ;
 
-  vector<double> MP ;
-  vector<double> ToMP ;
+  vector<double> & MP = m_MP;
+  vector<double> & ToMP = m_ToMP;
+  MP.clear();
+  ToMP.clear();
 
   bool isWayPointSet =
     WayPoint_y!=WayPoint_x &&
@@ -837,8 +846,8 @@ ComputeSecDerivative
 
 void FootTrajectoryGenerationStandard::
 UpdateFootPosition
-(deque<FootAbsolutePosition> &SupportFootAbsolutePositions,
- deque<FootAbsolutePosition> &NoneSupportFootAbsolutePositions,
+(RingBuffer<FootAbsolutePosition> &SupportFootAbsolutePositions,
+ RingBuffer<FootAbsolutePosition> &NoneSupportFootAbsolutePositions,
  int CurrentAbsoluteIndex,
  int IndexInitial,
  double ModulatedSingleSupportTime,
@@ -1005,8 +1014,8 @@ UpdateFootPosition
 
 void FootTrajectoryGenerationStandard::
 UpdateFootPosition
-(deque<FootAbsolutePosition> &SupportFootAbsolutePositions,
- deque<FootAbsolutePosition> &NoneSupportFootAbsolutePositions,
+(RingBuffer<FootAbsolutePosition> &SupportFootAbsolutePositions,
+ RingBuffer<FootAbsolutePosition> &NoneSupportFootAbsolutePositions,
  int StartIndex, int k,
  double LocalInterpolationStartTime,
  double ModulatedSingleSupportTime,
@@ -1245,7 +1254,7 @@ UpdateFootPosition
 void FootTrajectoryGenerationStandard::
 ComputingAbsFootPosFromQueueOfRelPos
 (deque<RelativeFootPosition> &RelativeFootPositions,
- deque<FootAbsolutePosition> &AbsoluteFootPositions )
+ RingBuffer<FootAbsolutePosition> &AbsoluteFootPositions )
 {
 
   if (AbsoluteFootPositions.size()==0)
@@ -1321,7 +1330,7 @@ void FootTrajectoryGenerationStandard::
 copyPolynomesFromFTGS
 (FootTrajectoryGenerationStandard * FTGS)
 {
-  vector<double> tmp_coefficients ;
+  vector<double> & tmp_coefficients = m_Coefficients ;
   FTGS->m_PolynomeX->GetCoefficients(tmp_coefficients);
   m_PolynomeX->SetCoefficients(tmp_coefficients);
   FTGS->m_PolynomeY->GetCoefficients(tmp_coefficients);
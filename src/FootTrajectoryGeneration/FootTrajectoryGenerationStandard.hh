@@ -92,15 +92,15 @@ namespace PatternGeneratorJRL
       @param StepType: Type of steps (for book-keeping).
       @param LeftOrRight: Specify if it is left (1) or right (-1).
     */
-   virtual void UpdateFootPosition(deque<FootAbsolutePosition> &SupportFootAbsolutePositions,
-				   deque<FootAbsolutePosition> &NoneSupportFootAbsolutePositions,
+   virtual void UpdateFootPosition(RingBuffer<FootAbsolutePosition> &SupportFootAbsolutePositions,
+				   RingBuffer<FootAbsolutePosition> &NoneSupportFootAbsolutePositions,
 				   int CurrentAbsoluteIndex,
 				   int IndexInitial,
 				   double ModulatedSingleSupportTime,
 				   int StepType,int LeftOrRight);
 
-   virtual void UpdateFootPosition(deque<FootAbsolutePosition> &SupportFootAbsolutePositions,
-				   deque<FootAbsolutePosition> &NoneSupportFootAbsolutePositions,
+   virtual void UpdateFootPosition(RingBuffer<FootAbsolutePosition> &SupportFootAbsolutePositions,
+				   RingBuffer<FootAbsolutePosition> &NoneSupportFootAbsolutePositions,
 				   int StartIndex, int k,
 				   double LocalInterpolationStartTime,
 				   double ModulatedSingleSupportTime,
@@ -143,7 +143,7 @@ namespace PatternGeneratorJRL
                                          double FinalPosition,
                                          double InitPosition,
                                          double InitSpeed,
-                                         vector<double> MiddlePos=vector<double>(3,-1));
+                                         const vector<double> & MiddlePos=m_NoMiddlePos);
 
    /*! Overloading -- BSPlines Init Function
     This method specifies the parameters for each of the Bsplines used by this object
@@ -203,7 +203,7 @@ namespace PatternGeneratorJRL
    /// \param[in] InitAcc
    int SetParameters(int PolynomeIndex, double TimeInterval,
        double FinalPosition, double InitPosition, double InitSpeed, double InitAcc,
-       std::vector<double> MiddlePos=vector<double>(3,-1) );
+       const std::vector<double> & MiddlePos=m_NoMiddlePos );
 
    /*! Fill an absolute foot position structure for a given time. */
    // Using Polynoms
@@ -224,7 +224,7 @@ namespace PatternGeneratorJRL
      There is not direct dependency with time.
     */
    void ComputingAbsFootPosFromQueueOfRelPos(deque<RelativeFootPosition> &RelativeFootPositions,
-					     deque<FootAbsolutePosition> &AbsoluteFootPositions);
+					     RingBuffer<FootAbsolutePosition> &AbsoluteFootPositions);
 
    /*! Methods to compute a set of positions for the feet according to the discrete time given in parameters
      and the phase of walking.
@@ -268,6 +268,16 @@ namespace PatternGeneratorJRL
    /*! \brief Position of the ankle in the right foot. */
    Eigen::Vector3d m_AnklePositionRight;
 
+   /*! \brief Way points of the BSplines, kept to set the parameters
+     without allocation. */
+   std::vector<double> m_MP, m_ToMP;
+
+   /*! \brief Coefficients copied between two polynomials. */
+   std::vector<double> m_Coefficients;
+
+   /*! \brief Default middle position: no way point. */
+   static const std::vector<double> m_NoMiddlePos;
+
 
   };
 
@@ -221,7 +221,7 @@ InitializeFromRelativeSteps
 (deque<RelativeFootPosition> &RelativeFootPositions,
  FootAbsolutePosition &LeftFootInitialPosition,
  FootAbsolutePosition &RightFootInitialPosition,
- deque<FootAbsolutePosition> &SupportFootAbsoluteFootPositions,
+ RingBuffer<FootAbsolutePosition> &SupportFootAbsoluteFootPositions,
  bool IgnoreFirst, bool Continuity)
 {
   ODEBUG("LeftFootInitialPosition.stepType: "
@@ -238,7 +238,7 @@ InitializeFromRelativeSteps
     lNbOfIntervals = RelativeFootPositions.size();
   /*! It is assumed that a set of relative positions for the support foot
     are given as an input. */
-  deque<FootAbsolutePosition> AbsoluteFootPositions;
+  RingBuffer<FootAbsolutePosition> AbsoluteFootPositions;
 
   /*! Those two variables are needed to compute intermediate
     initial positions for the feet. */
@@ -737,7 +737,7 @@ ComputeAbsoluteStepsFromRelativeSteps
 (deque<RelativeFootPosition> &RelativeFootPositions,
  FootAbsolutePosition &LeftFootInitialPosition,
  FootAbsolutePosition &RightFootInitialPosition,
- deque<FootAbsolutePosition> &SupportFootAbsoluteFootPositions)
+ RingBuffer<FootAbsolutePosition> &SupportFootAbsoluteFootPositions)
 {
   FootAbsolutePosition aSupportFootAbsolutePosition;
 
@@ -763,7 +763,7 @@ void LeftAndRightFootTrajectoryGenerationMultiple::
 ComputeAbsoluteStepsFromRelativeSteps
 (deque<RelativeFootPosition> &RelativeFootPositions,
  FootAbsolutePosition &SupportFootInitialAbsolutePosition,
- deque<FootAbsolutePosition> &SupportFootAbsoluteFootPositions)
+ RingBuffer<FootAbsolutePosition> &SupportFootAbsoluteFootPositions)
 {
   /*! Makes sure the size of the SupportFootAbsolutePositions is the same than
    the relative foot positions. */
@@ -774,7 +774,7 @@ ComputeAbsoluteStepsFromRelativeSteps
   long unsigned int lNbOfIntervals = RelativeFootPositions.size();
   /*! It is assumed that a set of relative positions for the support foot
     are given as an input. */
-  deque<FootAbsolutePosition> AbsoluteFootPositions;
+  RingBuffer<FootAbsolutePosition> AbsoluteFootPositions;
 
   AbsoluteFootPositions.resize(lNbOfIntervals);
   lNbOfIntervals = 2*lNbOfIntervals+1;
@@ -878,7 +878,7 @@ void LeftAndRightFootTrajectoryGenerationMultiple::
 ChangeRelStepsFromAbsSteps
 (deque<RelativeFootPosition> &RelativeFootPositions,
  FootAbsolutePosition &SupportFootInitialPosition,
- deque<FootAbsolutePosition> &SupportFootAbsoluteFootPositions,
+ RingBuffer<FootAbsolutePosition> &SupportFootAbsoluteFootPositions,
  unsigned int ChangedInterval)
 {
   if (ChangedInterval>=SupportFootAbsoluteFootPositions.size())
@@ -1033,7 +1033,7 @@ bool LeftAndRightFootTrajectoryGenerationMultiple::
 ComputeAnAbsoluteFootPosition
 (int LeftOrRight,
 double time,
-deque<FootAbsolutePosition> & adFAP,
+RingBuffer<FootAbsolutePosition> & adFAP,
 unsigned int IndexInterval)
 {
 
@@ -93,7 +93,7 @@ namespace PatternGeneratorJRL
       void InitializeFromRelativeSteps(deque<RelativeFootPosition> &RelativeFootPositions,
 				       FootAbsolutePosition &LeftFootInitialPosition,
 				       FootAbsolutePosition &RightFootInitialPosition,
-				       deque<FootAbsolutePosition> &SupportFootAbsoluteFootPositions,
+				       RingBuffer<FootAbsolutePosition> &SupportFootAbsoluteFootPositions,
 				       bool IgnoreFirst, bool Continuity);
 
       /*! \brief Method to compute the absolute position of the foot.
@@ -120,7 +120,7 @@ namespace PatternGeneratorJRL
     /*
        bool ComputeAnAbsoluteFootPosition(int LeftOrRight,
 										 double time,
-										 std::deque<FootAbsolutePosition> & adFAP,
+										 RingBuffer<FootAbsolutePosition> & adFAP,
 										 unsigned int IndexInterval);*/
 
     /*! \brief Method to compute absolute feet positions from a set of relative one.
@@ -134,7 +134,7 @@ namespace PatternGeneratorJRL
       void ComputeAbsoluteStepsFromRelativeSteps(deque<RelativeFootPosition> &RelativeFootPositions,
 						 FootAbsolutePosition &LeftFootInitialPosition,
 						 FootAbsolutePosition &RightFootInitialPosition,
-						 deque<FootAbsolutePosition> &SupportFootAbsoluteFootPositions);
+						 RingBuffer<FootAbsolutePosition> &SupportFootAbsoluteFootPositions);
 
       /*! \brief Method to compute absolute feet positions from a set of relative one.
 	@param[in] RelativeFootPositions: The set of relative positions for the support foot.
@@ -145,7 +145,7 @@ namespace PatternGeneratorJRL
        */
       void ComputeAbsoluteStepsFromRelativeSteps(deque<RelativeFootPosition> &RelativeFootPositions,
 						 FootAbsolutePosition &SupportFootInitialPosition,
-						 deque<FootAbsolutePosition> &SupportFootAbsoluteFootPositions);
+						 RingBuffer<FootAbsolutePosition> &SupportFootAbsoluteFootPositions);
 
       /*! \brief Method to compute relative feet positions from a set of absolute one
 	where one has changed.
@@ -158,7 +158,7 @@ namespace PatternGeneratorJRL
        */
       void ChangeRelStepsFromAbsSteps(deque<RelativeFootPosition> &RelativeFootPositions,
 				      FootAbsolutePosition &SupportFootInitialPosition,
-				      deque<FootAbsolutePosition> &SupportFootAbsoluteFootPositions,
+				      RingBuffer<FootAbsolutePosition> &SupportFootAbsoluteFootPositions,
 				      unsigned int ChangedInterval);
 
       /*! Returns foot */
@@ -57,6 +57,42 @@ OnLineFootTrajectoryGeneration::~OnLineFootTrajectoryGeneration()
 
 }
 
+void OnLineFootTrajectoryGeneration::
+getState(online_foot_trajectory_state_t & aState) const
+{
+  const PolynomeFoot * lPolynomes[online_foot_trajectory_state_t::NB_OF_POLYNOMES] =
+    { m_PolynomeX, m_PolynomeY, m_PolynomeTheta,
+      m_PolynomeOmega, m_PolynomeOmega2, m_PolynomeZ };
+  for(unsigned int i=0;i<online_foot_trajectory_state_t::NB_OF_POLYNOMES;i++)
+    {
+      lPolynomes[i]->GetCoefficients(aState.Coefficients[i]);
+      aState.FinalTimes[i] = lPolynomes[i]->FinalTime();
+    }
+  aState.HalfTimePassed = HalfTimePassed_;
+  aState.FirstPrvSuppFootX_vec = FirstPrvSuppFootX_vec;
+  aState.FirstPrvSuppFootY_vec = FirstPrvSuppFootY_vec;
+  aState.FPx = FPx_;
+  aState.FPy = FPy_;
+}
+
+void OnLineFootTrajectoryGeneration::
+setState(const online_foot_trajectory_state_t & aState)
+{
+  PolynomeFoot * lPolynomes[online_foot_trajectory_state_t::NB_OF_POLYNOMES] =
+    { m_PolynomeX, m_PolynomeY, m_PolynomeTheta,
+      m_PolynomeOmega, m_PolynomeOmega2, m_PolynomeZ };
+  for(unsigned int i=0;i<online_foot_trajectory_state_t::NB_OF_POLYNOMES;i++)
+    {
+      lPolynomes[i]->SetCoefficients(aState.Coefficients[i]);
+      lPolynomes[i]->FinalTime(aState.FinalTimes[i]);
+    }
+  HalfTimePassed_ = aState.HalfTimePassed;
+  FirstPrvSuppFootX_vec = aState.FirstPrvSuppFootX_vec;
+  FirstPrvSuppFootY_vec = aState.FirstPrvSuppFootY_vec;
+  FPx_ = aState.FPx;
+  FPy_ = aState.FPy;
+}
+
 void OnLineFootTrajectoryGeneration::
 ComputeXYThetaFootPosition
 (double t, FootAbsolutePosition& curr_NSFAP)
@@ -89,8 +125,8 @@ ComputeXYThetaFootPosition
 void
 OnLineFootTrajectoryGeneration::
 UpdateFootPosition
-(deque<FootAbsolutePosition> &SupportFootAbsolutePositions,
- deque<FootAbsolutePosition> &NoneSupportFootAbsolutePositions,
+(RingBuffer<FootAbsolutePosition> &SupportFootAbsolutePositions,
+ RingBuffer<FootAbsolutePosition> &NoneSupportFootAbsolutePositions,
  int StartIndex, int k,
  double LocalInterpolationStartTime,
  double UnlockedSwingPeriod,
@@ -281,11 +317,11 @@ void
 OnLineFootTrajectoryGeneration::
 interpolate_feet_positions
 (double Time,
- const deque<support_state_t> & PrwSupportStates_deq,
+ const RingBuffer<support_state_t> & PrwSupportStates_deq,
  const solution_t & Solution,
- const deque<double> & PreviewedSupportAngles_deq,
- deque<FootAbsolutePosition> & FinalLeftFootTraj_deq,
- deque<FootAbsolutePosition> & FinalRightFootTraj_deq)
+ const RingBuffer<double> & PreviewedSupportAngles_deq,
+ RingBuffer<FootAbsolutePosition> & FinalLeftFootTraj_deq,
+ RingBuffer<FootAbsolutePosition> & FinalRightFootTraj_deq)
 {
   support_state_t CurrentSupport = PrwSupportStates_deq.front();
 
@@ -443,11 +479,11 @@ void OnLineFootTrajectoryGeneration::
 interpolate_feet_positions
 (double Time, unsigned CurrentIndex,
  const support_state_t & CurrentSupport,
- std::vector<double> FootStepX,
- std::vector<double> FootStepY,
- std::vector<double> FootStepYaw,
- deque<FootAbsolutePosition> & FinalLeftFootTraj_deq,
- deque<FootAbsolutePosition> & FinalRightFootTraj_deq)
+ const std::vector<double> & FootStepX,
+ const std::vector<double> & FootStepY,
+ const std::vector<double> & FootStepYaw,
+ RingBuffer<FootAbsolutePosition> & FinalLeftFootTraj_deq,
+ RingBuffer<FootAbsolutePosition> & FinalRightFootTraj_deq)
 {
   --CurrentIndex;
   int StepType = 1;
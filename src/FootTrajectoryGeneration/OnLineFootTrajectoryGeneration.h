@@ -36,6 +36,18 @@
 namespace PatternGeneratorJRL
 {
 
+  /// \brief Part of OnLineFootTrajectoryGeneration kept from one
+  /// interpolation to the next: the polynomials and the landing position.
+  struct online_foot_trajectory_state_t
+  {
+    enum { NB_OF_POLYNOMES=6 };
+    std::vector<double> Coefficients[NB_OF_POLYNOMES] ;
+    double FinalTimes[NB_OF_POLYNOMES] ;
+    bool HalfTimePassed ;
+    vector<double> FirstPrvSuppFootX_vec, FirstPrvSuppFootY_vec ;
+    double FPx, FPy ;
+  };
+
   /// @ingroup foottrajectorygeneration
   /// Generate online trajectories for the swinging and the stance foot some amount in the future.
   class  OnLineFootTrajectoryGeneration : public FootTrajectoryGenerationStandard
@@ -61,19 +73,19 @@ namespace PatternGeneratorJRL
     /// \param[out] FinalLeftFootTraj_deq Left foot trajectory
     /// \param[out] FinalRightFootTraj_deq Right foot trajectory
     virtual void interpolate_feet_positions(double Time,
-        const deque<support_state_t> & PrwSupportStates_deq,
+        const RingBuffer<support_state_t> & PrwSupportStates_deq,
         const solution_t & Solution,
-        const deque<double> & PreviewedSupportAngles_deq,
-        deque<FootAbsolutePosition> &FinalLeftFootTraj_deq,
-        deque<FootAbsolutePosition> &FinalRightFootTraj_deq);
+        const RingBuffer<double> & PreviewedSupportAngles_deq,
+        RingBuffer<FootAbsolutePosition> &FinalLeftFootTraj_deq,
+        RingBuffer<FootAbsolutePosition> &FinalRightFootTraj_deq);
 
     virtual void interpolate_feet_positions(double Time, unsigned CurrentIndex,
         const PatternGeneratorJRL::support_state_t &CurrentSupport,
-        std::vector<double> FootStepX,
-        std::vector<double> FootStepY,
-        std::vector<double> FootStepYaw,
-        deque<FootAbsolutePosition> &FinalLeftFootTraj_deq,
-        deque<FootAbsolutePosition> &FinalRightFootTraj_deq);
+        const std::vector<double> & FootStepX,
+        const std::vector<double> & FootStepY,
+        const std::vector<double> & FootStepYaw,
+        RingBuffer<FootAbsolutePosition> &FinalLeftFootTraj_deq,
+        RingBuffer<FootAbsolutePosition> &FinalRightFootTraj_deq);
 
     /// \name Accessors
     /// \{
@@ -91,6 +103,12 @@ namespace PatternGeneratorJRL
     { FeetDistanceDS_ = FeetDistance; };
     /// \}
 
+    /// \name Snapshot of the state
+    /// \{
+    void getState(online_foot_trajectory_state_t & aState) const;
+    void setState(const online_foot_trajectory_state_t & aState);
+    /// \}
+
     //
     // Protected methods:
     //
@@ -121,8 +139,8 @@ namespace PatternGeneratorJRL
     /// \param UnlockedSwingPeriod: Amount of time where the swinging foot can move horizontally.
     /// \param StepType: Type of steps (for book-keeping).
     /// \param LeftOrRight: Specify if it is left (1) or right (-1).
-    virtual void UpdateFootPosition(deque<FootAbsolutePosition> &SupportFootTraj_deq,
-        deque<FootAbsolutePosition> &StanceFootTraj_deq,
+    virtual void UpdateFootPosition(RingBuffer<FootAbsolutePosition> &SupportFootTraj_deq,
+        RingBuffer<FootAbsolutePosition> &StanceFootTraj_deq,
         int StartIndex, int k,
         double LocalInterpolationStartTime,
         double UnlockedSwingPeriod,
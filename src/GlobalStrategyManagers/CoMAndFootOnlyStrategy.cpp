@@ -226,10 +226,10 @@ int CoMAndFootOnlyStrategy::EndOfMotion()
   return 0;
 }
 
-void CoMAndFootOnlyStrategy::Setup(deque<ZMPPosition> &,          // aZMPPositions,
-				   deque<COMState> &,             // aCOMBuffer,
-				   deque<FootAbsolutePosition> &, // aLeftFootAbsolutePositions,
-				   deque<FootAbsolutePosition> &) // aRightFootAbsolutePositions)
+void CoMAndFootOnlyStrategy::Setup(RingBuffer<ZMPPosition> &,          // aZMPPositions,
+				   RingBuffer<COMState> &,             // aCOMBuffer,
+				   RingBuffer<FootAbsolutePosition> &, // aLeftFootAbsolutePositions,
+				   RingBuffer<FootAbsolutePosition> &) // aRightFootAbsolutePositions)
 {
 }
 
@@ -117,6 +117,13 @@ namespace PatternGeneratorJRL
     /* Fix the end of the buffer to be tested. */
     void SetTheLimitOfTheBuffer(unsigned int lBufferSizeLimit);
 
+    /*! Number of successive hits on the bottom of the buffers,
+      to save and restore the state of EndOfMotion(). */
+    inline int GetNbOfHitBottom() const
+    { return m_NbOfHitBottom; }
+    inline void SetNbOfHitBottom(int lNbOfHitBottom)
+    { m_NbOfHitBottom = lNbOfHitBottom; }
+
     /*! @} */
 
 
@@ -124,10 +131,10 @@ namespace PatternGeneratorJRL
     void CallMethod(std::string &Method, std::istringstream &astrm);
 
     /*! */
-    void Setup(deque<ZMPPosition> & aZMPPositions,
-	       deque<COMState> & aCOMBuffer,
-	       deque<FootAbsolutePosition> & aLeftFootAbsolutePositions,
-	       deque<FootAbsolutePosition> & aRightFootAbsolutePositions);
+    void Setup(RingBuffer<ZMPPosition> & aZMPPositions,
+	       RingBuffer<COMState> & aCOMBuffer,
+	       RingBuffer<FootAbsolutePosition> & aLeftFootAbsolutePositions,
+	       RingBuffer<FootAbsolutePosition> & aRightFootAbsolutePositions);
 
     /*! \brief Initialization of the inter objects relationship. */
     int InitInterObjects(PinocchioRobot * aPR,
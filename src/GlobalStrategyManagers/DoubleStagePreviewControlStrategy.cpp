@@ -328,10 +328,10 @@ void DoubleStagePreviewControlStrategy::CallMethod(std::string &Method, std::ist
     }
 }
 
-void DoubleStagePreviewControlStrategy::Setup(deque<ZMPPosition> & aZMPPositions,
-					      deque<COMState> & aCOMBuffer,
-					      deque<FootAbsolutePosition> & aLeftFootAbsolutePositions,
-					      deque<FootAbsolutePosition> & aRightFootAbsolutePositions)
+void DoubleStagePreviewControlStrategy::Setup(RingBuffer<ZMPPosition> & aZMPPositions,
+					      RingBuffer<COMState> & aCOMBuffer,
+					      RingBuffer<FootAbsolutePosition> & aLeftFootAbsolutePositions,
+					      RingBuffer<FootAbsolutePosition> & aRightFootAbsolutePositions)
 {
   m_ZMPpcwmbz->Setup(aZMPPositions,
 		     aCOMBuffer,
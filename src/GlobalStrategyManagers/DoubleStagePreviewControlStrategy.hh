@@ -131,10 +131,10 @@ namespace PatternGeneratorJRL
       @param[out] aLeftFootAbsolutePositions: Trajectory of absolute positions for the left foot.
       @param[out] aRightFootAbsolutePositions: Trajectory of absolute positions for the right foot.
      */
-    void Setup(deque<ZMPPosition> & aZMPositions,
-	       deque<COMState> & aCOMBuffer,
-	       deque<FootAbsolutePosition> & aLeftFootAbsolutePositions,
-	       deque<FootAbsolutePosition> & aRightFootAbsolutePositions );
+    void Setup(RingBuffer<ZMPPosition> & aZMPositions,
+	       RingBuffer<COMState> & aCOMBuffer,
+	       RingBuffer<FootAbsolutePosition> & aLeftFootAbsolutePositions,
+	       RingBuffer<FootAbsolutePosition> & aRightFootAbsolutePositions );
 
     /*! \brief Get Waist state. */
     bool getWaistState(WaistState & aWaistState);
@@ -43,10 +43,10 @@ GlobalStrategyManager
   
 void GlobalStrategyManager::
 SetBufferPositions
-(deque<ZMPPosition> * aZMPPositions,
- deque<COMState> * aCOMBuffer,
- deque<FootAbsolutePosition> *aLeftFootAbsolutePositions,
- deque<FootAbsolutePosition> *aRightFootAbsolutePositions )
+(RingBuffer<ZMPPosition> * aZMPPositions,
+ RingBuffer<COMState> * aCOMBuffer,
+ RingBuffer<FootAbsolutePosition> *aLeftFootAbsolutePositions,
+ RingBuffer<FootAbsolutePosition> *aRightFootAbsolutePositions )
 {
   m_ZMPPositions = aZMPPositions;
   m_COMBuffer = aCOMBuffer;
@@ -27,6 +27,7 @@
 #include <deque> 
 
 
+#include <RingBuffer.hh>
 /*! JRL inclusion */
 
 // Dynamics
@@ -128,16 +129,16 @@ namespace PatternGeneratorJRL
       \param[in] aLeftFootAbsolutePositions: Absolute frame positions buffer of the left foot.
       \param[in] aRightFootAbsolutePositions: Absolute frame positions buffer of the right foot.
     */
-    void SetBufferPositions(deque<ZMPPosition> * aZMPositions,
-			    deque<COMState> * aCOMBuffer,
-			    deque<FootAbsolutePosition> *aLeftFootAbsolutePositions,
-			    deque<FootAbsolutePosition> *aRightFootAbsolutePositions );
+    void SetBufferPositions(RingBuffer<ZMPPosition> * aZMPositions,
+			    RingBuffer<COMState> * aCOMBuffer,
+			    RingBuffer<FootAbsolutePosition> *aLeftFootAbsolutePositions,
+			    RingBuffer<FootAbsolutePosition> *aRightFootAbsolutePositions );
 
     /*! Prepare the buffers at the beginning of the foot positions. */
-    virtual void Setup(deque<ZMPPosition> & aZMPositions,
-		       deque<COMState> & aCOMBuffer,
-		       deque<FootAbsolutePosition> & aLeftFootAbsolutePositions,
-		       deque<FootAbsolutePosition> & aRightFootAbsolutePositions )=0;
+    virtual void Setup(RingBuffer<ZMPPosition> & aZMPositions,
+		       RingBuffer<COMState> & aCOMBuffer,
+		       RingBuffer<FootAbsolutePosition> & aLeftFootAbsolutePositions,
+		       RingBuffer<FootAbsolutePosition> & aRightFootAbsolutePositions )=0;
       
   protected:
 
@@ -146,13 +147,13 @@ namespace PatternGeneratorJRL
      */
     
     /*! Buffer of ZMP positions */
-    deque<ZMPPosition> * m_ZMPPositions;
+    RingBuffer<ZMPPosition> * m_ZMPPositions;
 
     /*! Buffer for the COM position. */
-    deque<COMState> * m_COMBuffer;
+    RingBuffer<COMState> * m_COMBuffer;
 
     /*! Buffer of absolute foot position. */
-    deque<FootAbsolutePosition> * m_LeftFootPositions, *m_RightFootPositions;
+    RingBuffer<FootAbsolutePosition> * m_LeftFootPositions, *m_RightFootPositions;
     
     /* @} */
     
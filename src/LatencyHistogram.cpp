@@ -0,0 +1,142 @@
+/*
+ * Copyright 2019,
+ *
+ * Olivier Stasse
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+
+/*! \file LatencyHistogram.cpp
+    \brief Always-on measurement of the latency of the control cycle stages.
+*/
+
+#ifdef WIN32
+# include <Windows.h>
+#else
+# include <time.h>
+#endif
+
+#include <LatencyHistogram.hh>
+
+using namespace PatternGeneratorJRL;
+
+unsigned long long PatternGeneratorJRL::MonotonicTime()
+{
+#ifdef WIN32
+  LARGE_INTEGER lFrequency, lCounter;
+  QueryPerformanceFrequency(&lFrequency);
+  QueryPerformanceCounter(&lCounter);
+  return (unsigned long long)
+    ((double)lCounter.QuadPart*1e9/(double)lFrequency.QuadPart);
+#else
+  struct timespec lTime;
+  clock_gettime(CLOCK_MONOTONIC,&lTime);
+  return (unsigned long long)lTime.tv_sec*1000000000ULL +
+    (unsigned long long)lTime.tv_nsec;
+#endif
+}
+
+LatencyHistogram::LatencyHistogram()
+{
+  Reset();
+}
+
+void LatencyHistogram::Reset()
+{
+  for(unsigned int i=0;i<NB_OF_BUCKETS;i++)
+    m_Counts[i] = 0;
+  m_Count = 0;
+  m_Max = 0;
+}
+
+unsigned long long LatencyHistogram::BucketUpperBound(unsigned int Index)
+{
+  if (Index<SUB_BUCKET_COUNT)
+    return Index;
+  unsigned int lMagnitude = Index/SUB_BUCKET_COUNT + SUB_BUCKET_BITS - 1;
+  unsigned int lSubBucket = Index%SUB_BUCKET_COUNT;
+  unsigned int lShift = lMagnitude-SUB_BUCKET_BITS;
+  unsigned long long lLowerBound =
+    (unsigned long long)(SUB_BUCKET_COUNT+lSubBucket) << lShift;
+  return lLowerBound + ((1ULL << lShift)-1);
+}
+
+unsigned long long LatencyHistogram::Percentile(double aFraction) const
+{
+  if (m_Count==0)
+    return 0;
+
+  // Rank of the sample, starting from 1.
+  double lRank = aFraction*(double)m_Count;
+  unsigned long int lTarget = (unsigned long int)lRank;
+  if ((double)lTarget<lRank)
+    lTarget++;
+  if (lTarget<1)
+    lTarget = 1;
+
+  unsigned long int lCumulated = 0;
+  for(unsigned int i=0;i<NB_OF_BUCKETS;i++)
+  {
+    lCumulated += m_Counts[i];
+    if (lCumulated>=lTarget)
+    {
+      // The last bucket also holds the durations out of range.
+      if (i==NB_OF_BUCKETS-1)
+        return m_Max;
+      unsigned long long lUpperBound = BucketUpperBound(i);
+      return lUpperBound<m_Max ? lUpperBound : m_Max;
+    }
+  }
+  return m_Max;
+}
+
+void LatencyHistogram::Statistics(StageLatency & aLatency) const
+{
+  aLatency.Count = m_Count;
+  aLatency.P50 = 1e-9*(double)Percentile(0.5);
+  aLatency.P99 = 1e-9*(double)Percentile(0.99);
+  aLatency.Max = 1e-9*(double)m_Max;
+}
+
+LatencyProfile::LatencyProfile():
+  m_Enabled(true)
+{
+}
+
+void LatencyProfile::Reset()
+{
+  for(unsigned int i=0;i<NB_OF_CONTROL_CYCLE_STAGES;i++)
+    m_Stages[i].Reset();
+}
+
+const char * LatencyProfile::StageName(ControlCycleStage aStage)
+{
+  switch(aStage)
+  {
+  case STAGE_CONTROL_CYCLE: return "control cycle";
+  case STAGE_STEP_STACK: return "step stack";
+  case STAGE_ZMP_COM_GENERATION: return "ZMP and CoM generation";
+  case STAGE_QP_BUILD: return "QP build";
+  case STAGE_QP_SOLVE: return "QP solve";
+  case STAGE_DYNAMIC_FILTER: return "dynamic filter";
+  case STAGE_FOOT_TRAJECTORY: return "foot trajectory";
+  case STAGE_IK: return "inverse kinematics";
+  default: return "unknown";
+  }
+}
@@ -0,0 +1,180 @@
+/*
+ * Copyright 2019,
+ *
+ * Olivier Stasse
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+
+/*! \file LatencyHistogram.hh
+    \brief Always-on measurement of the latency of the control cycle stages.
+*/
+#ifndef _HWPG_LATENCY_HISTOGRAM_H_
+# define _HWPG_LATENCY_HISTOGRAM_H_
+
+#include <jrl/walkgen/pgtypes.hh>
+
+namespace PatternGeneratorJRL
+{
+  /*! \brief Monotonic time in nanoseconds. */
+  unsigned long long MonotonicTime();
+
+  /*! \brief Histogram of durations with a fixed memory size.
+
+    The buckets follow a log-linear scale: each power of two is split in
+    2^SUB_BUCKET_BITS buckets, so the relative precision is about 3 %
+    from 32 ns to 2^MAX_MAGNITUDE ns (18 minutes). Recording a sample is
+    a few integer operations and never allocates memory.
+  */
+  class LatencyHistogram
+  {
+  public:
+    LatencyHistogram();
+
+    /*! \brief Add a duration in nanoseconds. */
+    inline void Record(unsigned long long Duration)
+    {
+      m_Counts[BucketIndex(Duration)]++;
+      m_Count++;
+      if (Duration>m_Max)
+	m_Max = Duration;
+    }
+
+    /*! \brief Number of recorded durations. */
+    inline unsigned long int Count() const
+    { return m_Count; }
+
+    /*! \brief Maximal recorded duration in nanoseconds. */
+    inline unsigned long long Max() const
+    { return m_Max; }
+
+    /*! \brief Upper bound of the duration under which
+      a fraction aFraction of the samples lies, in nanoseconds. */
+    unsigned long long Percentile(double aFraction) const;
+
+    /*! \brief Fill aLatency, converted in seconds. */
+    void Statistics(StageLatency & aLatency) const;
+
+    void Reset();
+
+  protected:
+    enum { SUB_BUCKET_BITS=5,
+	   SUB_BUCKET_COUNT=1<<SUB_BUCKET_BITS,
+	   MAX_MAGNITUDE=40,
+	   NB_OF_BUCKETS=(MAX_MAGNITUDE-SUB_BUCKET_BITS+1)*SUB_BUCKET_COUNT };
+
+    static inline unsigned int BucketIndex(unsigned long long Duration)
+    {
+      if (Duration<SUB_BUCKET_COUNT)
+	return (unsigned int)Duration;
+      unsigned int lMagnitude = HighestBit(Duration);
+      if (lMagnitude>=MAX_MAGNITUDE)
+	return NB_OF_BUCKETS-1;
+      unsigned int lSubBucket = (unsigned int)
+	(Duration >> (lMagnitude-SUB_BUCKET_BITS)) & (SUB_BUCKET_COUNT-1);
+      return (lMagnitude-SUB_BUCKET_BITS+1)*SUB_BUCKET_COUNT + lSubBucket;
+    }
+
+    static inline unsigned int HighestBit(unsigned long long Value)
+    {
+#ifdef __GNUC__
+      return 63-__builtin_clzll(Value);
+#else
+      unsigned int lBit=0;
+      while (Value>>=1)
+	lBit++;
+      return lBit;
+#endif
+    }
+
+    /*! \brief Largest duration falling in the bucket. */
+    static unsigned long long BucketUpperBound(unsigned int Index);
+
+    unsigned long int m_Counts[NB_OF_BUCKETS];
+    unsigned long int m_Count;
+    unsigned long long m_Max;
+  };
+
+  /*! \brief One histogram per stage of the control cycle.
+    The profile is owned by the SimplePluginManager, so every object
+    of a pattern generator can reach it. It is not thread-safe: it is
+    only fed by the thread running the control loop. */
+  class LatencyProfile
+  {
+  public:
+    LatencyProfile();
+
+    inline LatencyHistogram & Stage(ControlCycleStage aStage)
+    { return m_Stages[aStage]; }
+    inline const LatencyHistogram & Stage(ControlCycleStage aStage) const
+    { return m_Stages[aStage]; }
+
+    /*! \brief When disabled, ScopedLatency does not read the clock. */
+    inline bool Enabled() const
+    { return m_Enabled; }
+    inline void Enabled(bool Enabled)
+    { m_Enabled = Enabled; }
+
+    /*! \brief For the stages which do not fit in a scope:
+      the value returned by Begin() has to be given to End(). */
+    inline unsigned long long Begin() const
+    { return m_Enabled ? MonotonicTime() : 0; }
+    inline void End(ControlCycleStage aStage, unsigned long long aBegin)
+    {
+      if (m_Enabled)
+	m_Stages[aStage].Record(MonotonicTime()-aBegin);
+    }
+
+    void Reset();
+
+    /*! \brief Name of a stage, for display. */
+    static const char * StageName(ControlCycleStage aStage);
+
+  protected:
+    LatencyHistogram m_Stages[NB_OF_CONTROL_CYCLE_STAGES];
+    bool m_Enabled;
+  };
+
+  /*! \brief Record the time spent in a scope into a stage of a profile.
+    Nothing is done if the profile is null or disabled. */
+  class ScopedLatency
+  {
+  public:
+    inline ScopedLatency(LatencyProfile * aProfile, ControlCycleStage aStage):
+      m_Histogram(0), m_Begin(0)
+    {
+      if ((aProfile!=0) && (aProfile->Enabled()))
+      {
+	m_Histogram = &aProfile->Stage(aStage);
+	m_Begin = MonotonicTime();
+      }
+    }
+
+    inline ~ScopedLatency()
+    {
+      if (m_Histogram!=0)
+	m_Histogram->Record(MonotonicTime()-m_Begin);
+    }
+
+  private:
+    LatencyHistogram * m_Histogram;
+    unsigned long long m_Begin;
+  };
+}
+#endif /* _HWPG_LATENCY_HISTOGRAM_H_ */
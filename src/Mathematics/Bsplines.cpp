@@ -446,8 +446,8 @@ int BSplinesFoot::Compute(double t, double& x, double& dx, double& ddx)
 void  BSplinesFoot::SetParameters(double FT,
                                   double IP,
                                   double FP,
-                                  std::vector<double>ToMP,
-                                  std::vector<double> MP,
+                                  const std::vector<double> & ToMP,
+                                  const std::vector<double> & MP,
                                   double IS, double IA,
                                   double FS, double FA)
 {
@@ -470,7 +470,7 @@ void  BSplinesFoot::SetParameters(double FT,
 
 
   // initialize some variables
-  std::deque<double> knot;
+  std::deque<double> & knot = m_knot;
   knot.resize(ToMP.size()+2*(m_degree+1));
   m_control_points.resize(ToMP.size()+m_degree+1);
 
@@ -485,11 +485,10 @@ void  BSplinesFoot::SetParameters(double FT,
         {knot[i]=0.0;}
 
       for (long int i=knot.size()-(m_degree+1) ;
-	   i<=(long int)knot.size() ;
+	   i<(long int)knot.size() ;
 	   i++)
         {knot[i]=1.0;}
 
-      SetKnotVector(knot);
       ComputeControlPointFrom2DataPoint();
       break ;
 
@@ -500,11 +499,10 @@ void  BSplinesFoot::SetParameters(double FT,
       knot[m_degree+1] = m_ToMP[0]/m_FT ;
 
       for (long int i=knot.size()-(m_degree+1) ;
-	   i<=(long int)knot.size() ;
+	   i<(long int)knot.size() ;
 	   i++)
         {knot[i]=1.0;}
 
-      SetKnotVector(knot);
       ComputeControlPointFrom3DataPoint();
 
       break ;
@@ -517,11 +515,10 @@ void  BSplinesFoot::SetParameters(double FT,
       knot[m_degree+2] = m_ToMP[1]/m_FT ;
 
       for (long int i=knot.size()-(m_degree+1) ;
-	   i<=(long int)knot.size() ;
+	   i<(long int)knot.size() ;
 	   i++)
         {knot[i]=1.0;}
 
-      SetKnotVector(knot);
       ComputeControlPointFrom4DataPoint();
 
       break ;
@@ -533,12 +530,16 @@ void  BSplinesFoot::SetParameters(double FT,
 void BSplinesFoot::ComputeControlPointFrom2DataPoint(void)
 {
   ComputeBasisFunctions(0);
-  vector<double> dNi5T0  = m_basis_functions_derivative ;
-  vector<double> ddNi5T0 = m_basis_functions_sec_derivative ;
+  vector<double> & dNi5T0  = m_dNi5T0;
+  dNi5T0  = m_basis_functions_derivative ;
+  vector<double> & ddNi5T0 = m_ddNi5T0;
+  ddNi5T0 = m_basis_functions_sec_derivative ;
 
   ComputeBasisFunctions(1);
-  vector<double> dNi5T  = m_basis_functions_derivative ;
-  vector<double> ddNi5T = m_basis_functions_sec_derivative ;
+  vector<double> & dNi5T  = m_dNi5T;
+  dNi5T  = m_basis_functions_derivative ;
+  vector<double> & ddNi5T = m_ddNi5T;
+  ddNi5T = m_basis_functions_sec_derivative ;
 
   double IP=m_IP ;
   double IS=m_IS ;
@@ -682,15 +683,20 @@ void BSplinesFoot::ComputeControlPointFrom2DataPoint(void)
 void BSplinesFoot::ComputeControlPointFrom3DataPoint(void)
 {
   ComputeBasisFunctions(0);
-  vector<double> dNi5T0  = m_basis_functions_derivative ;
-  vector<double> ddNi5T0 = m_basis_functions_sec_derivative ;
+  vector<double> & dNi5T0  = m_dNi5T0;
+  dNi5T0  = m_basis_functions_derivative ;
+  vector<double> & ddNi5T0 = m_ddNi5T0;
+  ddNi5T0 = m_basis_functions_sec_derivative ;
 
   ComputeBasisFunctions(m_ToMP[0]/m_FT);
-  vector<double> Ni5Tm  = m_basis_functions[m_degree] ;
+  vector<double> & Ni5Tm  = m_Ni5Tm1;
+  Ni5Tm  = m_basis_functions[m_degree] ;
 
   ComputeBasisFunctions(1.0);
-  vector<double> dNi5T  = m_basis_functions_derivative ;
-  vector<double> ddNi5T = m_basis_functions_sec_derivative ;
+  vector<double> & dNi5T  = m_dNi5T;
+  dNi5T  = m_basis_functions_derivative ;
+  vector<double> & ddNi5T = m_ddNi5T;
+  ddNi5T = m_basis_functions_sec_derivative ;
 
   double IP=m_IP ;
   double IS=m_IS ;
@@ -1001,18 +1007,24 @@ void BSplinesFoot::ComputeControlPointFrom3DataPoint(void)
 void BSplinesFoot::ComputeControlPointFrom4DataPoint(void)
 {
   ComputeBasisFunctions(0);
-  vector<double> dNi5T0  = m_basis_functions_derivative ;
-  vector<double> ddNi5T0 = m_basis_functions_sec_derivative ;
+  vector<double> & dNi5T0  = m_dNi5T0;
+  dNi5T0  = m_basis_functions_derivative ;
+  vector<double> & ddNi5T0 = m_ddNi5T0;
+  ddNi5T0 = m_basis_functions_sec_derivative ;
 
   ComputeBasisFunctions(m_ToMP[0]/m_FT);
-  vector<double> Ni5Tm1  = m_basis_functions[m_degree] ;
+  vector<double> & Ni5Tm1  = m_Ni5Tm1;
+  Ni5Tm1  = m_basis_functions[m_degree] ;
 
   ComputeBasisFunctions(m_ToMP[1]/m_FT);
-  vector<double> Ni5Tm2  = m_basis_functions[m_degree] ;
+  vector<double> & Ni5Tm2  = m_Ni5Tm2;
+  Ni5Tm2  = m_basis_functions[m_degree] ;
 
   ComputeBasisFunctions(1.0);
-  vector<double> dNi5T  = m_basis_functions_derivative ;
-  vector<double> ddNi5T = m_basis_functions_sec_derivative ;
+  vector<double> & dNi5T  = m_dNi5T;
+  dNi5T  = m_basis_functions_derivative ;
+  vector<double> & ddNi5T = m_ddNi5T;
+  ddNi5T = m_basis_functions_sec_derivative ;
 
   double IP=m_IP ;
   double IS=m_IS ;
@@ -1880,8 +1892,8 @@ void  BSplinesFoot::SetParametersWithInitFinalPose(double FT,
 
 
   // initialize some variables
-  std::deque<double> knot;
-  std::vector<double> control_points;
+  std::deque<double> & knot = m_knot;
+  std::vector<double> & control_points = m_control_points;
   knot.clear();
   control_points.clear();
 
@@ -1963,9 +1975,6 @@ void  BSplinesFoot::SetParametersWithInitFinalPose(double FT,
       break ;
     }// end switch case
 
-  SetKnotVector(knot);
-  SetControlPoints(control_points);
-
   return ;
 }
 
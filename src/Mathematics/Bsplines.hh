@@ -123,8 +123,8 @@ namespace PatternGeneratorJRL
     void SetParameters(double FT,
 		       double IP,
 		       double FP,
-		       std::vector<double>ToMP,
-		       std::vector<double> MP,
+		       const std::vector<double> & ToMP,
+		       const std::vector<double> & MP,
 		       double IS = 0.0, double IA = 0.0,
 		       double FS = 0.0, double FA = 0.0);
     void SetParametersWithoutMPAndToMP(double FT,
@@ -185,6 +185,11 @@ namespace PatternGeneratorJRL
     double m_FA ; // Final Acceleration
     std::vector<double> m_ToMP ; // times to reach the middle (intermediate) positions
     std::vector<double> m_MP ; // middle (intermediate) positions
+
+    // basis functions at the data points, kept to compute the
+    // control points without allocation
+    std::vector<double> m_dNi5T0, m_ddNi5T0, m_Ni5Tm1, m_Ni5Tm2 ;
+    std::vector<double> m_dNi5T, m_ddNi5T ;
   };
 
 }
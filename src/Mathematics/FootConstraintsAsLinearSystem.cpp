@@ -261,9 +261,9 @@ ComputeLinearSystem
   return 0;
 }
 
-int FootConstraintsAsLinearSystem::BuildLinearConstraintInequalities(deque<FootAbsolutePosition>
+int FootConstraintsAsLinearSystem::BuildLinearConstraintInequalities(RingBuffer<FootAbsolutePosition>
 								     &LeftFootAbsolutePositions,
-								     deque<FootAbsolutePosition>
+								     RingBuffer<FootAbsolutePosition>
 								     &RightFootAbsolutePositions,
 								     deque<LinearConstraintInequality_t *> &
 								     QueueOfLConstraintInequalities,
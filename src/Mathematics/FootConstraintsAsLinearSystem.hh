@@ -33,6 +33,7 @@
 
 #include <vector>
 #include <deque>
+#include <RingBuffer.hh>
 #include <string>
 #include <sstream>
 
@@ -72,16 +73,16 @@ namespace PatternGeneratorJRL
       /*!  Build a queue of constraint Inequalities based on a list of Foot Absolute
 	Position.
        */
-      int BuildLinearConstraintInequalities(std::deque< FootAbsolutePosition> &LeftFootAbsolutePositions,
-					    std::deque<FootAbsolutePosition> &RightFootAbsolutePositions,
+      int BuildLinearConstraintInequalities(RingBuffer<FootAbsolutePosition> &LeftFootAbsolutePositions,
+					    RingBuffer<FootAbsolutePosition> &RightFootAbsolutePositions,
 					    std::deque<LinearConstraintInequality_t *> &
 					    QueueOfLConstraintInequalities,
 					    double ConstraintOnX,
 					    double ConstraintOnY);
 
       /*!  Build a queue of constraint Inequalities based on a list of Foot Absolute Position.  */
-      int BuildLinearConstraintInequalities2(std::deque< FootAbsolutePosition> &LeftFootAbsolutePositions,
-					     std::deque<FootAbsolutePosition> &RightFootAbsolutePositions,
+      int BuildLinearConstraintInequalities2(RingBuffer<FootAbsolutePosition> &LeftFootAbsolutePositions,
+					     RingBuffer<FootAbsolutePosition> &RightFootAbsolutePositions,
 					     std::deque<LinearConstraintInequality_t *> &
 					     QueueOfLConstraintInequalities,
 					     double ConstraintOnX,
@@ -25,11 +25,17 @@
     \brief This object performs a cholesky decomposition optimized for 
     the problem to solved. */
 #include <math.h>
+#include <algorithm>
 #include <Mathematics/OptCholesky.hh>
 #include <Debug.hh>
 
 using namespace PatternGeneratorJRL;
 
+/* Row major view on m_L, whose leading dimension is m_NbMaxOfConstraints. */
+typedef Eigen::Map<Eigen::Matrix<double,Eigen::Dynamic,Eigen::Dynamic,
+				 Eigen::RowMajor>,
+		   0,Eigen::OuterStride<> > MapL_t;
+
 OptCholesky::OptCholesky(unsigned int lNbMaxOfConstraints,
 			 unsigned int lCardU,
 			 unsigned int lUpdateMode):
@@ -39,6 +45,7 @@ OptCholesky::OptCholesky(unsigned int lNbMaxOfConstraints,
   m_L(0),
   m_iL(0),
   m_UpdateMode(lUpdateMode),
+  m_BlockedUpdate(false),
   m_NbOfConstraints(0)
 {
   InitializeInternalVariables();
@@ -51,6 +58,8 @@ OptCholesky::~OptCholesky()
 
 void OptCholesky::InitializeInternalVariables()
 {
+  m_E.resize(m_NbMaxOfConstraints,m_CardU);
+  m_x.resize(m_NbMaxOfConstraints);
 }
 
 void OptCholesky::SetToZero()
@@ -79,13 +88,23 @@ void OptCholesky::SetA(double *aA,
 
 int OptCholesky::AddActiveConstraints(vector<unsigned int> & lConstraints)
 {
-  int r=0;
-  for(unsigned int li=0;li<lConstraints.size();li++)
+  if (!m_BlockedUpdate)
     {
-      r=AddActiveConstraint(lConstraints[li]);
-      if (r<0)
-	return -((int)(li));
+      for(unsigned int li=0;li<lConstraints.size();li++)
+	{
+	  if (AddActiveConstraint(lConstraints[li])<0)
+	    return -((int)li+1);
+	}
+      return 0;
     }
+
+  std::size_t FirstNewRow = m_SetActiveConstraints.size();
+  m_SetActiveConstraints.insert(m_SetActiveConstraints.end(),
+				lConstraints.begin(),lConstraints.end());
+
+  int r = UpdateCholeskyMatrix(FirstNewRow);
+  if (r>0)
+    return -r;
   return r;
 }
 
@@ -94,13 +113,61 @@ int OptCholesky::AddActiveConstraint(unsigned int aConstraint)
   /* Update set of active constraints */
   m_SetActiveConstraints.push_back(aConstraint);
 
-  int r = 0;
-  if (m_UpdateMode==MODE_NORMAL)
-    UpdateCholeskyMatrixNormal();
-  else if (m_UpdateMode==MODE_FORTRAN)
-    UpdateCholeskyMatrixFortran();
-    
-  return r;
+  if (UpdateCholeskyMatrix(m_SetActiveConstraints.size()-1)!=0)
+    return -1;
+  return 0;
+}
+
+int OptCholesky::RemoveActiveConstraint(unsigned int aConstraint)
+{
+  vector<unsigned int>::iterator it =
+    std::find(m_SetActiveConstraints.begin(),
+	      m_SetActiveConstraints.end(),aConstraint);
+  if (it==m_SetActiveConstraints.end())
+    return -1;
+
+  long int n = (long int)m_SetActiveConstraints.size();
+  long int k = (long int)(it - m_SetActiveConstraints.begin());
+
+  if (m_L!=0)
+    {
+      MapL_t L(m_L,n,n,Eigen::OuterStride<>(m_NbMaxOfConstraints));
+
+      /* Move the rows below k one row up and drop their column k.
+	 With x this column, the trailing block T is such that
+	 T T' + x x' is the trailing block of the new E E'. */
+      for(long int li=k+1;li<n;li++)
+	{
+	  m_x(li-k-1) = L(li,k);
+	  L.row(li-1).head(k) = L.row(li).head(k);
+	  L.row(li-1).segment(k,li-k) = L.row(li).segment(k+1,li-k);
+	}
+
+      /* Rank one update of T with Givens rotations. */
+      long int m = n-1-k;
+      for(long int lj=0;lj<m;lj++)
+	{
+	  long int J = k+lj;
+	  double Ljj = L(J,J), xj = m_x(lj);
+	  double r = sqrt(Ljj*Ljj + xj*xj);
+	  double c = r/Ljj, s = xj/Ljj;
+	  L(J,J) = r;
+
+	  long int lSize = m-lj-1;
+	  if (lSize>0)
+	    {
+	      L.col(J).segment(J+1,lSize) =
+		(L.col(J).segment(J+1,lSize) + s*m_x.segment(lj+1,lSize))/c;
+	      m_x.segment(lj+1,lSize) =
+		c*m_x.segment(lj+1,lSize) - s*L.col(J).segment(J+1,lSize);
+	    }
+	}
+    }
+
+  for(long int li=k+1;li<n;li++)
+    m_E.row(li-1) = m_E.row(li);
+  m_SetActiveConstraints.erase(it);
+  return 0;
 }
 
 std::size_t OptCholesky::CurrentNumberOfRows()
@@ -120,108 +187,91 @@ void OptCholesky::SetiL(double *aiL)
   m_iL = aiL;
 }
 
-int OptCholesky::UpdateCholeskyMatrixNormal()
+void OptCholesky::CopyRowOfA(unsigned int aConstraint, std::size_t aRow)
+{
+  if (m_UpdateMode==MODE_FORTRAN)
+    m_E.row(aRow) = Eigen::Map<const Eigen::RowVectorXd,0,Eigen::InnerStride<> >
+      (m_A + aConstraint,m_CardU,Eigen::InnerStride<>(m_NbOfConstraints+1));
+  else
+    m_E.row(aRow) = Eigen::Map<const Eigen::RowVectorXd>
+      (m_A + m_CardU * aConstraint,m_CardU);
+}
+
+int OptCholesky::UpdateCholeskyMatrix(std::size_t FirstNewRow)
 {
 
   if ((m_A==0) | (m_L==0))
     return -1;
 
-  double Mij=0.0;
-  std::size_t  IndexNewRowAKAi = 0;
-  if (m_SetActiveConstraints.size()>0)
-    IndexNewRowAKAi = m_SetActiveConstraints.size()-1;
-  
-  double *PointerArow_i = m_A +  m_CardU * 
-    m_SetActiveConstraints[IndexNewRowAKAi];
+  long int n = (long int)m_SetActiveConstraints.size();
+  long int p = (long int)FirstNewRow;
+  long int k = n-p;
+  if (k<=0)
+    return 0;
 
-  /* Compute Li,j */
-  for(int lj=0;lj<(int)m_SetActiveConstraints.size();lj++)
-    {
+  /* The new rows of E are gathered once, whatever the layout of A,
+     so that all the products below run on contiguous memory. */
+  for(long int li=p;li<n;li++)
+    CopyRowOfA(m_SetActiveConstraints[li],li);
 
-      /* A value M(i,j) is computed once,
-	 directly from the matrix A */      
-      double *Arow_i = PointerArow_i;
-      double *Arow_j = m_A + m_CardU * m_SetActiveConstraints[lj];
-      Mij=0.0;
-      for(int lk=0;lk<(int)m_CardU;lk++)
-	{
-	  Mij+= (*Arow_i++) * (*Arow_j++);
-	}
-
-      /* */
-      double r = Mij;
-      double * ptLik =m_L + IndexNewRowAKAi*m_NbMaxOfConstraints;
-      double * ptLjk =m_L + lj*m_NbMaxOfConstraints;
+  MapL_t L(m_L,n,n,Eigen::OuterStride<>(m_NbMaxOfConstraints));
 
-      for(int lk=0;lk<lj;lk++)
+  if (k==1)
+    {
+      /* One row: matrix-vector product and triangular solve on a vector. */
+      if (p>0)
 	{
-	  r = r - (*ptLik++)  * (*ptLjk++);
+	  L.row(p).head(p).transpose().noalias() =
+	    m_E.topRows(p) * m_E.row(p).transpose();
+	  L.topLeftCorner(p,p).triangularView<Eigen::Lower>().
+	    solveInPlace(L.row(p).head(p).transpose());
 	}
-      if (lj!=(int)m_SetActiveConstraints.size()-1)
-	m_L[IndexNewRowAKAi*m_NbMaxOfConstraints+lj]=
-	  r/m_L[lj*m_NbMaxOfConstraints+lj];
-      else
-	m_L[IndexNewRowAKAi*m_NbMaxOfConstraints+lj] =  sqrt(r);
-      
+      L(p,p) = m_E.row(p).squaredNorm() - L.row(p).head(p).squaredNorm();
     }
-  
-  return 0;
-  
-}
-
-int OptCholesky::UpdateCholeskyMatrixFortran()
-{
-
-  if ((m_A==0) | (m_L==0))
-    return -1;
-
-  double Mij=0.0;
-  std::size_t IndexNewRowAKAi = 0;
-  if (m_SetActiveConstraints.size()>0)
-    IndexNewRowAKAi = m_SetActiveConstraints.size()-1;
-  
-  double *PointerArow_i = m_A +  
-    m_SetActiveConstraints[IndexNewRowAKAi];
-
-  /* Compute Li,j */
-  for(int lj=0;lj<(int)m_SetActiveConstraints.size();lj++)
+  else
     {
-
-      /* A value M(i,j) is computed once,
-	 directly from the matrix A */      
-      double *Arow_i = PointerArow_i;
-      double *Arow_j = m_A + m_SetActiveConstraints[lj];
-      Mij=0.0;
-      for(int lk=0;lk<(int)m_CardU;lk++)
+      /* L21 L11' = M21 with M21 = E2 E1' */
+      if (p>0)
 	{
-	  Mij+= (*Arow_i) * (*Arow_j);
-	  Arow_i+= m_NbOfConstraints+1;
-	  Arow_j+= m_NbOfConstraints+1;
+	  if (m_M.rows()<k)
+	    m_M.resize(k,m_NbMaxOfConstraints);
+	  m_M.topLeftCorner(k,p).noalias() =
+	    m_E.middleRows(p,k) * m_E.topRows(p).transpose();
+	  L.block(p,0,k,p) = m_M.topLeftCorner(k,p);
+	  L.topLeftCorner(p,p).triangularView<Eigen::Lower>().transpose().
+	    solveInPlace<Eigen::OnTheRight>(L.block(p,0,k,p));
 	}
 
-      /* */
-      double r = Mij;
-      ODEBUG("r: M("<< m_SetActiveConstraints[IndexNewRowAKAi] << "," 
-	      << m_SetActiveConstraints[lj] <<")="<< r);
-      double * ptLik =m_L + IndexNewRowAKAi*m_NbMaxOfConstraints;
-      double * ptLjk =m_L + lj*m_NbMaxOfConstraints;
+      /* L22 L22' = E2 E2' - L21 L21', only the lower parts are computed. */
+      L.block(p,p,k,k).triangularView<Eigen::Lower>().setZero();
+      L.block(p,p,k,k).selfadjointView<Eigen::Lower>().
+	rankUpdate(m_E.middleRows(p,k));
+      if (p>0)
+	L.block(p,p,k,k).selfadjointView<Eigen::Lower>().
+	  rankUpdate(L.block(p,0,k,p),-1.0);
+    }
 
-      for(int lk=0;lk<lj;lk++)
+  int r=0;
+  for(long int li=p;li<n;li++)
+    {
+      for(long int lj=p;lj<=li;lj++)
 	{
-	  r = r - (*ptLik++)  * (*ptLjk++);
+	  double Lij = L(li,lj) -
+	    L.row(li).segment(p,lj-p).dot(L.row(lj).segment(p,lj-p));
+	  if (lj!=li)
+	    L(li,lj) = Lij/L(lj,lj);
+	  else
+	    {
+	      if ((Lij<=0.0) && (r==0))
+		r = (int)(li-p)+1;
+	      L(li,li) = sqrt(Lij);
+	    }
 	}
-      if (lj!=(int)m_SetActiveConstraints.size()-1)
-	m_L[IndexNewRowAKAi*m_NbMaxOfConstraints+lj]=
-	  r/m_L[lj*m_NbMaxOfConstraints+lj];
-      else
-	m_L[IndexNewRowAKAi*m_NbMaxOfConstraints+lj] = sqrt(r);
-      
-      ODEBUG("m_L(" << IndexNewRowAKAi << "," << lj << ")="
-	      << m_L[IndexNewRowAKAi*m_NbMaxOfConstraints+lj] );
+      ODEBUG("m_L(" << li << ",.)=" << L.row(li).head(li+1));
     }
-  
-  return 0;
-  
+
+  return r;
+
 }
 
 int OptCholesky::ComputeNormalCholeskyOnANormal()
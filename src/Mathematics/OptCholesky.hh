@@ -34,6 +34,7 @@
 
 #include <vector>
 
+#include <Eigen/Dense>
 
 using namespace::std;
 
@@ -50,6 +51,10 @@ namespace PatternGeneratorJRL
     {
 
     public:
+      /*! \brief Row major matrix, the layout of \f$ {\bf L} \f$. */
+      typedef Eigen::Matrix<double,Eigen::Dynamic,Eigen::Dynamic,
+			    Eigen::RowMajor> MatrixRowMajor;
+
       /*! \brief Constructor
 	@param[in] lNbMaxOfConstraints \f$ m \f$ the number
 	of constraints of matrix \f$ \bf A \f$
@@ -67,18 +72,53 @@ namespace PatternGeneratorJRL
 		unsigned int lNbOfConstraints);
 
       /*! \brief Add a list of active constraints
+	The constraints are added one by one, unless the blocked update
+	is set (see SetBlockedUpdate()).
 	@param[in] lConstraints: row indexes of constraints in \f${\bf A} \f$.
-	@return \f$ -i \f$ where \f$ i \f$ is the constraint for
-	which there is a problem.
+	@return 0 on success, \f$ -i \f$ where \f$ i \f$ is the position
+	in lConstraints, counted from 1, of the constraint for which
+	there is a problem, i.e. which depends linearly on the previous
+	ones. The factor is then invalid.
        */
       int AddActiveConstraints(vector<unsigned int> & lConstraints);
 
+      /*! \brief Compute the rows of \f$ {\bf L} \f$ added by
+	AddActiveConstraints() in one blocked operation: products of
+	matrices for \f$ E E^{\top} \f$ and a triangular solve with
+	several right hand sides, instead of one row at a time.
+	It is only faster for large sets of constraints:
+	see the timings of TestOptCholesky. */
+      void SetBlockedUpdate(bool BlockedUpdate)
+      { m_BlockedUpdate = BlockedUpdate; }
+
       /*! \brief Add one active constraint
 	@param[in] lConstraints: row indexes of constraints in \f${\bf A} \f$.
-	@return -1 if the constraint was not added, 0 otherwise.
+	@return -1 if the constraint depends linearly on the active ones
+	(the factor is then invalid), 0 otherwise.
        */
       int AddActiveConstraint(unsigned int aConstraint);
 
+      /*! \brief Remove one active constraint.
+	The row of \f$ {\bf L} \f$ is deleted and the rows below
+	are brought back to a lower triangular form with Givens
+	rotations, i.e. a rank one update of the trailing block
+	in \f$ O(n^2) \f$ instead of a new decomposition.
+	@param[in] aConstraint: row index of the constraint in \f${\bf A} \f$.
+	@return -1 if the constraint is not active, 0 otherwise.
+       */
+      int RemoveActiveConstraint(unsigned int aConstraint);
+
+      /*! \brief Returns the active constraints in the order
+	of the rows of \f$ {\bf L} \f$. */
+      const vector<unsigned int> & ActiveConstraints() const
+      { return m_SetActiveConstraints; }
+
+      /*! \brief Returns \f$ {\bf E} \f$, the rows of \f$ {\bf A} \f$
+	of the active constraints in the order of the rows of \f$ {\bf L} \f$.
+	Only the first CurrentNumberOfRows() rows are meaningful. */
+      const MatrixRowMajor & ActiveRows() const
+      { return m_E; }
+
       /*! \brief Returns the current number of rows
        or the current number of active constraints on \f$ {\bf A} \f$.*/
       std::size_t CurrentNumberOfRows();
@@ -131,6 +171,9 @@ namespace PatternGeneratorJRL
       /*! \brief Mode to update the cholesky. */
       unsigned int m_UpdateMode;
 
+      /*! \brief Add a list of constraints in one blocked update. */
+      bool m_BlockedUpdate;
+
       /*! \brief Number of constraints related with matrix A. */
       unsigned int m_NbOfConstraints;
 
@@ -138,12 +181,26 @@ namespace PatternGeneratorJRL
 	Its size gives the size of \f$ {\bf L} \f$, and \f$ {\bf E} \f$ */
       vector<unsigned int> m_SetActiveConstraints;
 
+      /*! \brief Copy of the active rows of \f$ {\bf A} \f$,
+	i.e. \f$ {\bf E} \f$, stored contiguously whatever the
+	layout of \f$ {\bf A} \f$ so that the products are vectorized. */
+      MatrixRowMajor m_E;
+
+      /*! \brief Buffer for the new rows of \f$ E E^{\top} \f$. */
+      MatrixRowMajor m_M;
+
+      /*! \brief Buffer for the Givens rotations of the downdate. */
+      Eigen::VectorXd m_x;
 
-      /*! \brief Update Cholesky computation */
-      int UpdateCholeskyMatrixFortran();
+      /*! \brief Copy the row aConstraint of \f$ {\bf A} \f$
+	in the row aRow of \f$ {\bf E} \f$ according to the layout. */
+      void CopyRowOfA(unsigned int aConstraint, std::size_t aRow);
 
-      /*! \brief Update Cholesky computation */
-      int UpdateCholeskyMatrixNormal();
+      /*! \brief Update Cholesky computation for the active
+	constraints from index FirstNewRow.
+	@return -1 if there is no matrix, \f$ 1+i \f$
+	if the new row i has a non-positive pivot, 0 otherwise. */
+      int UpdateCholeskyMatrix(std::size_t FirstNewRow);
 
       /*! \brief  Free memory. */
       void FreeMemory();
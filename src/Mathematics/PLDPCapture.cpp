@@ -0,0 +1,175 @@
+/*
+ * Copyright 2019,
+ *
+ * Olivier Stasse
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+/*! \file PLDPCapture.cpp
+  \brief Binary capture of the problems solved by the PLDP solvers.
+*/
+#include <string.h>
+
+#include <Mathematics/PLDPCapture.hh>
+
+using namespace Optimization::Solver;
+using namespace std;
+
+namespace
+{
+  const char PLDP_CAPTURE_MAGIC[8] = { 'J','R','L','P','L','D','P','C' };
+  const unsigned int PLDP_CAPTURE_VERSION = 1;
+
+  /* Upper bound on the sizes read from a file. */
+  const unsigned int PLDP_CAPTURE_MAX_SIZE = 100000;
+
+  template <typename T>
+  bool ReadArray(istream &aStream, vector<T> &anArray, unsigned int lSize)
+  {
+    anArray.resize(lSize);
+    if (lSize==0)
+      return true;
+    return (bool)aStream.read((char *)&anArray[0],lSize*sizeof(T));
+  }
+}
+
+PLDPCapture::PLDPCapture():
+  m_CardU(0)
+{
+}
+
+PLDPCapture::~PLDPCapture()
+{
+  Close();
+}
+
+int PLDPCapture::Open(const string & aFileName,
+		      unsigned int CardU,
+		      const double *iPu,
+		      const double *Px,
+		      const double *Pu,
+		      const double *iLQ)
+{
+  Close();
+  m_Stream.open(aFileName.c_str(),ofstream::out | ofstream::binary);
+  if (!m_Stream.is_open())
+    return -1;
+
+  m_CardU = CardU;
+  m_Stream.write(PLDP_CAPTURE_MAGIC,sizeof(PLDP_CAPTURE_MAGIC));
+  m_Stream.write((const char *)&PLDP_CAPTURE_VERSION,
+		 sizeof(PLDP_CAPTURE_VERSION));
+  m_Stream.write((const char *)&m_CardU,sizeof(m_CardU));
+  m_Stream.write((const char *)iPu,CardU*CardU*sizeof(double));
+  m_Stream.write((const char *)Px,CardU*3*sizeof(double));
+  m_Stream.write((const char *)Pu,CardU*CardU*sizeof(double));
+  m_Stream.write((const char *)iLQ,4*CardU*CardU*sizeof(double));
+  return m_Stream.good() ? 0 : -1;
+}
+
+void PLDPCapture::Record(double Time,
+			 const double *CstPartOfTheCostFunction,
+			 unsigned int NbOfConstraints,
+			 const double *LinearPartOfConstraints,
+			 const double *CstPartOfConstraints,
+			 const double *ZMPRef,
+			 const double *XkYk,
+			 const vector<int> &SimilarConstraints,
+			 unsigned int NumberOfRemovedConstraints,
+			 bool StartingSequence,
+			 const double *X)
+{
+  if (!m_Stream.is_open())
+    return;
+
+  unsigned int n = 2*m_CardU;
+  unsigned int lStartingSequence = StartingSequence ? 1 : 0;
+  m_Stream.write((const char *)&Time,sizeof(Time));
+  m_Stream.write((const char *)&NbOfConstraints,sizeof(NbOfConstraints));
+  m_Stream.write((const char *)&NumberOfRemovedConstraints,
+		 sizeof(NumberOfRemovedConstraints));
+  m_Stream.write((const char *)&lStartingSequence,sizeof(lStartingSequence));
+  m_Stream.write((const char *)CstPartOfTheCostFunction,n*sizeof(double));
+  m_Stream.write((const char *)LinearPartOfConstraints,
+		 (NbOfConstraints+1)*n*sizeof(double));
+  m_Stream.write((const char *)CstPartOfConstraints,
+		 NbOfConstraints*sizeof(double));
+  m_Stream.write((const char *)ZMPRef,n*sizeof(double));
+  m_Stream.write((const char *)XkYk,6*sizeof(double));
+  for(unsigned int i=0;i<NbOfConstraints;i++)
+    {
+      int lSimilar = i<SimilarConstraints.size() ? SimilarConstraints[i] : 0;
+      m_Stream.write((const char *)&lSimilar,sizeof(lSimilar));
+    }
+  m_Stream.write((const char *)X,n*sizeof(double));
+}
+
+void PLDPCapture::Close()
+{
+  if (m_Stream.is_open())
+    m_Stream.close();
+}
+
+bool PLDPCapture::ReadConstants(istream &aStream,
+				PLDPConstants &aConstants)
+{
+  char lMagic[sizeof(PLDP_CAPTURE_MAGIC)];
+  unsigned int lVersion=0;
+  aStream.read(lMagic,sizeof(lMagic));
+  aStream.read((char *)&lVersion,sizeof(lVersion));
+  aStream.read((char *)&aConstants.CardU,sizeof(aConstants.CardU));
+  if ((!aStream) ||
+      (memcmp(lMagic,PLDP_CAPTURE_MAGIC,sizeof(lMagic))!=0) ||
+      (lVersion!=PLDP_CAPTURE_VERSION) ||
+      (aConstants.CardU==0) ||
+      (aConstants.CardU>PLDP_CAPTURE_MAX_SIZE/8))
+    return false;
+
+  unsigned int N = aConstants.CardU;
+  return ReadArray(aStream,aConstants.iPu,N*N) &&
+    ReadArray(aStream,aConstants.Px,N*3) &&
+    ReadArray(aStream,aConstants.Pu,N*N) &&
+    ReadArray(aStream,aConstants.iLQ,4*N*N);
+}
+
+bool PLDPCapture::ReadProblem(istream &aStream,
+			      unsigned int CardU,
+			      PLDPProblem &aProblem)
+{
+  unsigned int n = 2*CardU;
+  unsigned int lStartingSequence=0;
+  aStream.read((char *)&aProblem.Time,sizeof(aProblem.Time));
+  aStream.read((char *)&aProblem.NbOfConstraints,
+	       sizeof(aProblem.NbOfConstraints));
+  aStream.read((char *)&aProblem.NumberOfRemovedConstraints,
+	       sizeof(aProblem.NumberOfRemovedConstraints));
+  aStream.read((char *)&lStartingSequence,sizeof(lStartingSequence));
+  if ((!aStream) || (aProblem.NbOfConstraints>PLDP_CAPTURE_MAX_SIZE))
+    return false;
+  aProblem.StartingSequence = (lStartingSequence!=0);
+
+  unsigned int m = aProblem.NbOfConstraints;
+  return ReadArray(aStream,aProblem.CstPartOfTheCostFunction,n) &&
+    ReadArray(aStream,aProblem.LinearPartOfConstraints,(m+1)*n) &&
+    ReadArray(aStream,aProblem.CstPartOfConstraints,m) &&
+    ReadArray(aStream,aProblem.ZMPRef,n) &&
+    ReadArray(aStream,aProblem.XkYk,6) &&
+    ReadArray(aStream,aProblem.SimilarConstraints,m) &&
+    ReadArray(aStream,aProblem.X,n);
+}
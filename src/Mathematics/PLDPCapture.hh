@@ -0,0 +1,135 @@
+/*
+ * Copyright 2019,
+ *
+ * Olivier Stasse
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+/*! \file PLDPCapture.hh
+  \brief Binary capture of the problems solved by the PLDP solvers,
+  to replay them off-line.
+*/
+
+#ifndef _PLDP_CAPTURE_H_
+#define _PLDP_CAPTURE_H_
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace Optimization
+{
+  namespace Solver
+    {
+      /*! Constant matrices given to the constructor of the PLDP solvers,
+	with \f$ N \f$ the size of the preview window. The arrays are
+	stored as the solvers read them. */
+      struct PLDPConstants
+      {
+	unsigned int CardU;
+	/*! \f$ N \times N \f$ */
+	std::vector<double> iPu;
+	/*! \f$ N \times 3 \f$ */
+	std::vector<double> Px;
+	/*! \f$ N \times N \f$ */
+	std::vector<double> Pu;
+	/*! \f$ 2N \times 2N \f$ */
+	std::vector<double> iLQ;
+      };
+
+      /*! Arguments of one call to SolveProblem and the solution found
+	during the capture. */
+      struct PLDPProblem
+      {
+	double Time;
+	unsigned int NbOfConstraints;
+	unsigned int NumberOfRemovedConstraints;
+	bool StartingSequence;
+	/*! \f$ 2N \f$ */
+	std::vector<double> CstPartOfTheCostFunction;
+	/*! Column major, \f$ 2N \f$ columns with a leading dimension
+	  of NbOfConstraints+1. */
+	std::vector<double> LinearPartOfConstraints;
+	std::vector<double> CstPartOfConstraints;
+	/*! \f$ 2N \f$ */
+	std::vector<double> ZMPRef;
+	/*! \f$ 6 \f$ */
+	std::vector<double> XkYk;
+	std::vector<int> SimilarConstraints;
+	/*! \f$ 2N \f$ */
+	std::vector<double> X;
+      };
+
+      /*! Write the problems given to a PLDP solver in a binary file:
+	a header with the constant matrices, then one record per call. */
+      class PLDPCapture
+	{
+	public:
+	  PLDPCapture();
+	  ~PLDPCapture();
+
+	  /*! \brief Create the file and write the constant part.
+	    @return -1 if the file can not be created, 0 otherwise. */
+	  int Open(const std::string & aFileName,
+		   unsigned int CardU,
+		   const double *iPu,
+		   const double *Px,
+		   const double *Pu,
+		   const double *iLQ);
+
+	  /*! \brief Returns true if the problems are recorded. */
+	  bool IsOpen() const
+	  { return m_Stream.is_open(); }
+
+	  /*! \brief Append the arguments of SolveProblem and its solution X. */
+	  void Record(double Time,
+		      const double *CstPartOfTheCostFunction,
+		      unsigned int NbOfConstraints,
+		      const double *LinearPartOfConstraints,
+		      const double *CstPartOfConstraints,
+		      const double *ZMPRef,
+		      const double *XkYk,
+		      const std::vector<int> &SimilarConstraints,
+		      unsigned int NumberOfRemovedConstraints,
+		      bool StartingSequence,
+		      const double *X);
+
+	  /*! \brief Close the file. */
+	  void Close();
+
+	  /*! \brief Read the constant part of a capture.
+	    @return false if the stream is not a capture. */
+	  static bool ReadConstants(std::istream &aStream,
+				    PLDPConstants &aConstants);
+
+	  /*! \brief Read the next problem of a capture.
+	    @return false at the end of the stream. */
+	  static bool ReadProblem(std::istream &aStream,
+				  unsigned int CardU,
+				  PLDPProblem &aProblem);
+
+	private:
+	  std::ofstream m_Stream;
+
+	  /*! Size of the preview window. */
+	  unsigned int m_CardU;
+	};
+    }
+}
+#endif /* _PLDP_CAPTURE_H_ */
@@ -48,6 +48,7 @@
 inline int isinf (double x){return isnan (x - x);}
 #endif /* WIN32 */
 
+#include <TraceRecorder.hh>
 #include <Debug.hh>
 
 using namespace PatternGeneratorJRL;
@@ -846,8 +847,13 @@ int PLDPSolverHerdt::SolveProblem(deque<LinearConstraintInequalityFreeFeet_t> &
 	      m_ActivatedConstraints.push_back(IndexFootCstr);
 	    }
 	}
-      if(m_ActivatedConstraints.size()>0)
-	m_OptCholesky->AddActiveConstraints(m_ActivatedConstraints);
+      /* Cold start if the previous active set is degenerated. */
+      if((m_ActivatedConstraints.size()>0) &&
+	 (m_OptCholesky->AddActiveConstraints(m_ActivatedConstraints)<0))
+	{
+	  m_OptCholesky->SetToZero();
+	  m_ActivatedConstraints.clear();
+	}
     }
 
   m_PreviouslyActivatedConstraints.clear();
@@ -984,10 +990,12 @@ int PLDPSolverHerdt::SolveProblem(deque<LinearConstraintInequalityFreeFeet_t> &
 
     }
 
-  if (1)
+  TraceRecorder & aRecorder = TraceRecorder::Instance();
+  if (aRecorder.IsRunning())
     {
-      ofstream aof;
-      aof.open("ActivatedConstraints.dat",ofstream::app);
+      static unsigned int lChannel =
+	aRecorder.Channel("ActivatedConstraints.dat");
+      TraceEntry aof(lChannel);
       for(unsigned int i=0;i<320;i++)
       {
 	bool FoundConstraint=false;
@@ -997,17 +1005,15 @@ int PLDPSolverHerdt::SolveProblem(deque<LinearConstraintInequalityFreeFeet_t> &
 	    for(unsigned int j=0;j<m_ActivatedConstraints.size();j++)
 	      if (m_ActivatedConstraints[j]==i)
 		{
-		  aof << "1 ";
+		  aof << 1;
 		  FoundConstraint=true;
 		  break;
 		}
 	  }
 	if (!FoundConstraint)
-	  aof << "0 ";
+	  aof << 0;
 
       }
-      aof << endl;
-      aof.close();
     }
 
   if ((isnan(X[0])) ||
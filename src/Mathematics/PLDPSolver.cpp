@@ -52,6 +52,7 @@
 inline int isinf (double x){return isnan (x - x);}
 #endif /* WIN32 */
 
+#include <TraceRecorder.hh>
 #include <Debug.hh>
 
 using namespace PatternGeneratorJRL;
@@ -792,8 +793,13 @@ int PLDPSolver::SolveProblem(double *CstPartOfTheCostFunction,
 	    }
 
 	}
-      if (m_ActivatedConstraints.size()>0)
-	m_OptCholesky->AddActiveConstraints(m_ActivatedConstraints);
+      /* Cold start if the previous active set is degenerated. */
+      if ((m_ActivatedConstraints.size()>0) &&
+	  (m_OptCholesky->AddActiveConstraints(m_ActivatedConstraints)<0))
+	{
+	  m_OptCholesky->SetToZero();
+	  m_ActivatedConstraints.clear();
+	}
 
     }
 
@@ -921,7 +927,7 @@ int PLDPSolver::SolveProblem(double *CstPartOfTheCostFunction,
 	  if (m_v2[i]<0.0)
 	    {
 	      m_PreviouslyActivatedConstraints.push_back(m_ActivatedConstraints[i]);
-	      ODEBUG3( m_ActivatedConstraints[i] << " " );
+	      ODEBUG( m_ActivatedConstraints[i] << " " );
 	    }
 	}
       ODEBUG( (int)m_ActivatedConstraints.size() - (int)m_PreviouslyActivatedConstraints.size() <<  " "
@@ -930,10 +936,12 @@ int PLDPSolver::SolveProblem(double *CstPartOfTheCostFunction,
 
     }
 
-  if (0)
+  TraceRecorder & aRecorder = TraceRecorder::Instance();
+  if (aRecorder.IsRunning())
     {
-      ofstream aof;
-      aof.open("ActivatedConstraints.dat",ofstream::app);
+      static unsigned int lChannel =
+	aRecorder.Channel("ActivatedConstraints.dat");
+      TraceEntry aof(lChannel);
       for(unsigned int i=0;i<320;i++)
       {
 	bool FoundConstraint=false;
@@ -943,17 +951,15 @@ int PLDPSolver::SolveProblem(double *CstPartOfTheCostFunction,
 	    for(unsigned int j=0;j<m_ActivatedConstraints.size();j++)
 	      if (m_ActivatedConstraints[j]==i)
 		{
-		  aof << "1 ";
+		  aof << 1;
 		  FoundConstraint=true;
 		  break;
 		}
 	  }
 	if (!FoundConstraint)
-	  aof << "0 ";
+	  aof << 0;
 
       }
-      aof << endl;
-      aof.close();
     }
 
   if ((isnan(X[0])) ||
@@ -66,6 +66,18 @@ namespace Optimization
 			   std::vector<int> &SimilarConstraint,
 			   unsigned int NumberOfRemovedConstraints,
 			   bool StartingSequence);
+
+	  /*! \brief Stop the iterations once lAmount (s) has been spent
+	    in SolveProblem if lLimited is true. */
+	  void SetLimitedComputationTime(bool lLimited, double lAmount)
+	  {
+	    m_LimitedComputationTime = lLimited;
+	    m_AmountOfLimitedComputationTime = lAmount;
+	  }
+
+	  /*! \brief Number of iterations of the last call. */
+	  int NbOfIterations() const
+	  { return m_ItNb; }
 	protected:
 	  
 	  /*! \name Initial solution methods related 
@@ -0,0 +1,344 @@
+/*
+ * Copyright 2019,
+ *
+ * Olivier Stasse
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+/*! \file PLDPSolverEigen.cpp
+  \brief Allocation free implementation of the QP solver proposed by
+  Dimitrov 2009.
+*/
+#include <iostream>
+#include <algorithm>
+
+#include "portability/gettimeofday.hh"
+
+#include <Mathematics/PLDPSolverEigen.hh>
+
+#include <Debug.hh>
+
+using namespace PatternGeneratorJRL;
+using namespace Optimization::Solver;
+using namespace std;
+
+namespace
+{
+  typedef Eigen::Map<const OptCholesky::MatrixRowMajor> ConstMapRowMajor;
+  typedef Eigen::Map<const Eigen::MatrixXd,0,Eigen::OuterStride<> >
+    ConstMapConstraints;
+}
+
+PLDPSolverEigen::PLDPSolverEigen(unsigned int CardU,
+				 double *iPu,
+				 double *Px,
+				 double *Pu,
+				 double *):
+  m_Pu(Pu),
+  m_iPu(iPu),
+  m_Px(Px),
+  m_OptCholesky(0),
+  m_A(0),
+  m_b(0),
+  m_CstPartOfCostFunction(0),
+  m_NbMaxOfConstraints(8*CardU),
+  m_NbOfConstraints(0),
+  m_CardV(CardU),
+  m_ItNb(0),
+  m_HotStart(true),
+  m_InternalTime(0.0),
+  m_tol(1e-8),
+  m_LimitedComputationTime(true),
+  m_AmountOfLimitedComputationTime(0.0013)
+{
+  m_OptCholesky = new OptCholesky(m_NbMaxOfConstraints,2*m_CardV,
+				  OptCholesky::MODE_FORTRAN);
+  AllocateMemoryForSolver();
+}
+
+PLDPSolverEigen::~PLDPSolverEigen()
+{
+  if (m_OptCholesky!=0)
+    delete m_OptCholesky;
+}
+
+void PLDPSolverEigen::AllocateMemoryForSolver()
+{
+  unsigned int n = 2*m_CardV;
+
+  ConstMapRowMajor iPu(m_iPu,m_CardV,m_CardV);
+  ConstMapRowMajor Px(m_Px,m_CardV,3);
+  m_iPuPx.noalias() = iPu.transpose() * Px;
+
+  m_Vk.setZero(n);
+  m_PreviousZMPSolution.setZero(n);
+  m_ZMPRef.setZero(m_CardV);
+  m_UnconstrainedDescentDirection.setZero(n);
+  m_d.setZero(n);
+  m_v1.setZero(m_NbMaxOfConstraints);
+  m_v2.setZero(m_NbMaxOfConstraints);
+  m_Ad.setZero(m_NbMaxOfConstraints);
+  m_AVk.setZero(m_NbMaxOfConstraints);
+  m_L.setZero(m_NbMaxOfConstraints,m_NbMaxOfConstraints);
+  m_IsActive.assign(m_NbMaxOfConstraints,false);
+  m_PreviouslyActivatedConstraints.reserve(m_NbMaxOfConstraints);
+  m_HotStartConstraints.reserve(m_NbMaxOfConstraints);
+
+  m_OptCholesky->SetL(m_L.data());
+}
+
+void PLDPSolverEigen::ComputeInitialSolution(double *ZMPRef,
+					     double *XkYk,
+					     bool StartingSequence)
+{
+  /*! U0 = iPu * (ZMPRef - Px [Xkt Ykt]t) for each axis.
+    With the hot start, the ZMP reference is the last solution
+    shifted by one sample. */
+  ConstMapRowMajor iPu(m_iPu,m_CardV,m_CardV);
+  unsigned int N = m_CardV;
+
+  for(unsigned int lAxis=0;lAxis<2;lAxis++)
+    {
+      if ((m_HotStart) && (!StartingSequence))
+	{
+	  m_ZMPRef.head(N-1) = m_PreviousZMPSolution.segment(lAxis*N+1,N-1);
+	  m_ZMPRef(N-1) = ZMPRef[lAxis*N+N-1];
+	}
+      else
+	m_ZMPRef = Eigen::Map<const Eigen::VectorXd>(ZMPRef+lAxis*N,N);
+
+      m_Vk.segment(lAxis*N,N).noalias() = iPu.transpose() * m_ZMPRef;
+      m_Vk.segment(lAxis*N,N).noalias() -=
+	m_iPuPx * Eigen::Map<const Eigen::Vector3d>(XkYk+3*lAxis);
+    }
+}
+
+void PLDPSolverEigen::ComputeProjectedDescentDirection()
+{
+  long int lNbActive = (long int)m_OptCholesky->CurrentNumberOfRows();
+
+  m_d = m_UnconstrainedDescentDirection;
+  if (lNbActive==0)
+    return;
+
+  OptCholesky::MatrixRowMajor::ConstRowsBlockXpr E =
+    m_OptCholesky->ActiveRows().topRows(lNbActive);
+
+  // v1 = E c eq (14a), then L L' v2 = v1 (14b).
+  m_v1.head(lNbActive).noalias() = E * m_UnconstrainedDescentDirection;
+  m_v2.head(lNbActive) = m_v1.head(lNbActive);
+  m_L.topLeftCorner(lNbActive,lNbActive).
+    triangularView<Eigen::Lower>().solveInPlace(m_v2.head(lNbActive));
+  m_L.topLeftCorner(lNbActive,lNbActive).transpose().
+    triangularView<Eigen::Upper>().solveInPlace(m_v2.head(lNbActive));
+
+  // d = c - E' v2
+  m_d.noalias() -= E.transpose() * m_v2.head(lNbActive);
+}
+
+double PLDPSolverEigen::ComputeAlpha(int &TheConstraintToActivate)
+{
+  double Alpha=10000000.0;
+  TheConstraintToActivate=-1;
+
+  ConstMapConstraints A(m_A,m_NbOfConstraints,2*m_CardV,
+			Eigen::OuterStride<>(m_NbOfConstraints+1));
+  m_Ad.head(m_NbOfConstraints).noalias() = A * m_d;
+  m_AVk.head(m_NbOfConstraints).noalias() = A * m_Vk;
+
+  for(unsigned int li=0;li<m_NbOfConstraints;li++)
+    {
+      if ((m_IsActive[li]) || (m_Ad(li)>=0.0))
+	continue;
+
+      double lValue = -m_b[li] - m_AVk(li);
+      if (lValue>m_tol)
+	{
+	  std::cerr << "PB ON constraint "<<li<< " at time "
+		    << m_InternalTime << endl;
+	  std::cerr << " Check current V k="<<m_ItNb<< endl;
+	}
+      else if (lValue>0.0)
+	lValue = -m_tol;
+
+      double lalpha = lValue/m_Ad(li);
+      if (Alpha>lalpha)
+	{
+	  Alpha = lalpha;
+	  if (Alpha<1)
+	    TheConstraintToActivate=(int)li;
+	}
+    }
+  return Alpha;
+}
+
+int PLDPSolverEigen::SolveProblem(double *CstPartOfTheCostFunction,
+				  unsigned int NbOfConstraints,
+				  double *LinearPartOfConstraints,
+				  double *CstPartOfConstraints,
+				  double *ZMPRef,
+				  double *XkYk,
+				  double *X,
+				  vector<int> &,
+				  unsigned int NumberOfRemovedConstraints,
+				  bool StartingSequence)
+{
+  if (NbOfConstraints>m_NbMaxOfConstraints)
+    {
+      std::cerr << "PLDPSolverEigen: " << NbOfConstraints
+		<< " constraints for at most " << m_NbMaxOfConstraints
+		<< std::endl;
+      return -1;
+    }
+
+  if (StartingSequence)
+    m_InternalTime = 0.0;
+
+  m_A = LinearPartOfConstraints;
+  m_b = CstPartOfConstraints;
+  m_NbOfConstraints = NbOfConstraints;
+  m_CstPartOfCostFunction = CstPartOfTheCostFunction;
+
+  ComputeInitialSolution(ZMPRef,XkYk,StartingSequence);
+
+  /*! Initialization de cholesky. */
+  m_OptCholesky->SetA(LinearPartOfConstraints,m_NbOfConstraints);
+  m_OptCholesky->SetToZero();
+  std::fill(m_IsActive.begin(),m_IsActive.end(),false);
+
+  struct timeval begin;
+  gettimeofday(&begin,0);
+
+  // Hot Start
+  if (m_HotStart)
+    {
+      m_HotStartConstraints.clear();
+      for(unsigned int i=0;i<m_PreviouslyActivatedConstraints.size();i++)
+	{
+	  int lindex=(int)m_PreviouslyActivatedConstraints[i]-
+	    (int)NumberOfRemovedConstraints;
+	  if ((lindex>=0) && (lindex<(int)m_NbOfConstraints))
+	    {
+	      m_HotStartConstraints.push_back(lindex);
+	      m_IsActive[lindex]=true;
+	    }
+	}
+      /* Cold start if the previous active set is degenerated. */
+      if ((m_HotStartConstraints.size()>0) &&
+	  (m_OptCholesky->AddActiveConstraints(m_HotStartConstraints)<0))
+	{
+	  m_OptCholesky->SetToZero();
+	  std::fill(m_IsActive.begin(),m_IsActive.end(),false);
+	}
+    }
+  m_PreviouslyActivatedConstraints.clear();
+
+  Eigen::Map<const Eigen::VectorXd>
+    CstPart(m_CstPartOfCostFunction,2*m_CardV);
+
+  bool ContinueAlgo=true;
+  double alpha=0.0;
+  m_ItNb=0;
+  while(ContinueAlgo)
+    {
+      /* Step one : Compute descent direction. */
+      m_UnconstrainedDescentDirection = -CstPart - m_Vk;
+
+      /*! Step two: Compute the projected descent direction. */
+      ComputeProjectedDescentDirection();
+
+      /*! Step three : Compute alpha */
+      int TheConstraintToActivate=-1;
+      alpha = ComputeAlpha(TheConstraintToActivate);
+
+      if (alpha>=1.0)
+	{
+	  alpha=1.0;
+	  ContinueAlgo=false;
+	}
+      if (alpha<0.0)
+	{
+	  std::cerr << "Problem with alpha: should be positive" << std::endl;
+	  std::cerr << "The initial solution is incorrect: "
+		    << m_ItNb << " " << m_InternalTime << std::endl;
+	  return -1;
+	}
+
+      /*! Compute new solution. */
+      m_Vk += alpha * m_d;
+
+      if ((ContinueAlgo) && (TheConstraintToActivate>=0))
+	{
+	  ODEBUG("Activate constraint " << TheConstraintToActivate);
+	  m_OptCholesky->AddActiveConstraint(TheConstraintToActivate);
+	  m_IsActive[TheConstraintToActivate]=true;
+	}
+
+      // If limited computation time stop the algorithm.
+      if (m_LimitedComputationTime)
+	{
+	  struct timeval current;
+	  gettimeofday(&current,0);
+	  double r=(double)(current.tv_sec-begin.tv_sec) +
+	    0.000001*(current.tv_usec-begin.tv_usec);
+	  if (r> m_AmountOfLimitedComputationTime)
+	    ContinueAlgo=false;
+	}
+
+      m_ItNb++;
+    }
+
+  Eigen::Map<Eigen::VectorXd>(X,2*m_CardV) = m_Vk;
+
+  if (m_HotStart)
+    {
+      const vector<unsigned int> & lActive =
+	m_OptCholesky->ActiveConstraints();
+      for(unsigned int i=0;i<lActive.size();i++)
+	if (m_v2[i]<0.0)
+	  m_PreviouslyActivatedConstraints.push_back(lActive[i]);
+      StoreCurrentZMPSolution(XkYk);
+    }
+
+  m_InternalTime += 0.02;
+
+  if (!m_Vk.allFinite())
+    {
+      std::cerr << "Nan or inf value " << X[0]<< " " << X[m_CardV]
+		<< " at iteration " << m_ItNb -1 <<endl;
+      return -1;
+    }
+  return 0;
+}
+
+/* Store the ZMP solution for hotstart. */
+void PLDPSolverEigen::StoreCurrentZMPSolution(double *XkYk)
+{
+  ConstMapRowMajor Pu(m_Pu,m_CardV,m_CardV);
+  ConstMapRowMajor Px(m_Px,m_CardV,3);
+  unsigned int N = m_CardV;
+
+  for(unsigned int lAxis=0;lAxis<2;lAxis++)
+    {
+      m_PreviousZMPSolution.segment(lAxis*N,N).noalias() =
+	Pu.transpose() * m_Vk.segment(lAxis*N,N);
+      m_PreviousZMPSolution.segment(lAxis*N,N).noalias() +=
+	Px * Eigen::Map<const Eigen::Vector3d>(XkYk+3*lAxis);
+    }
+}
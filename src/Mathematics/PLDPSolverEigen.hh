@@ -0,0 +1,211 @@
+/*
+ * Copyright 2019,
+ *
+ * Olivier Stasse
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+/*! \file PLDPSolverEigen.hh
+  \brief Allocation free implementation of the QP solver proposed by
+  Dimitrov 2009.
+    On the Application of Linear Model Predictive Control
+    for Walking Pattern Generation in the Presence of Strong Disturbances
+    D. Dimitrov and P.-B. Wieber and H. Diedam and O. Stasse
+*/
+
+#ifndef _PLDP_SOLVER_EIGEN_H_
+#define _PLDP_SOLVER_EIGEN_H_
+
+#include <vector>
+
+#include <Eigen/Dense>
+
+#include <Mathematics/OptCholesky.hh>
+
+namespace Optimization
+{
+  namespace Solver
+    {
+      /*! Same algorithm and interface as PLDPSolver, for the on-line use:
+	- every buffer is allocated by AllocateMemoryForSolver(),
+	SolveProblem() does not allocate memory once the active set has
+	reached its largest size,
+	- the products are done by Eigen on maps of the arrays given by
+	the generator, and the projection of the descent direction by
+	triangular solves on the factor of OptCholesky,
+	- the debugging dumps of PLDPSolver are left out, only ODEBUG
+	remains.
+
+	The values of the constraints are computed for all of them with
+	one matrix-vector product, so the similar constraints given to
+	SolveProblem() are not used.
+      */
+      class PLDPSolverEigen
+	{
+	public:
+	  /*! \brief Constructor, see PLDPSolver. */
+	  PLDPSolverEigen(unsigned int CardU,
+			  double * iPu,
+			  double * Px,
+			  double * Pu,
+			  double * iLQ);
+
+	  /*! \brief Destructor */
+	  ~PLDPSolverEigen();
+
+	  /*! \brief Solve the optimization problem, see PLDPSolver.
+	    @return -1 if the problem is too large, if the initial
+	    solution is not feasible or if the solution is not finite,
+	    0 otherwise.
+	   */
+	  int SolveProblem(double *CstPartOfTheCostFunction,
+			   unsigned int NbOfConstraints,
+			   double *LinearPartOfConstraints,
+			   double *CstPartOfConstraints,
+			   double *ZMPRef,
+			   double *XkYk,
+			   double *X,
+			   std::vector<int> &SimilarConstraint,
+			   unsigned int NumberOfRemovedConstraints,
+			   bool StartingSequence);
+
+	  /*! \brief Stop the iterations once lAmount (s) has been spent
+	    in SolveProblem if lLimited is true. */
+	  void SetLimitedComputationTime(bool lLimited, double lAmount)
+	  {
+	    m_LimitedComputationTime = lLimited;
+	    m_AmountOfLimitedComputationTime = lAmount;
+	  }
+
+	  /*! \brief Number of iterations of the last call. */
+	  int NbOfIterations() const
+	  { return m_ItNb; }
+
+	protected:
+	  /*! Allocate memory for solver. */
+	  void AllocateMemoryForSolver();
+
+	  /*! Compute the initial solution, eq(14) Dimitrov ICRA 2008. */
+	  void ComputeInitialSolution(double *ZMPRef,
+				      double *XkYk,
+				      bool StartingSequence);
+
+	  /*! \brief Compute the projected descent direction
+	    \f$ d = c - E^{\top} (E E^{\top})^{-1} E c \f$. */
+	  void ComputeProjectedDescentDirection();
+
+	  /*! \brief Detect the first violated constraint along \f$ d \f$.
+	    @param[out] TheConstraintToActivate: its index if the step is
+	    smaller than 1, -1 otherwise.
+	    @return the step. */
+	  double ComputeAlpha(int &TheConstraintToActivate);
+
+	  /*! Store the current ZMP solution for hot start purposes. */
+	  void StoreCurrentZMPSolution(double *XkYk);
+
+	private:
+	  typedef PatternGeneratorJRL::OptCholesky::MatrixRowMajor
+	    MatrixRowMajor;
+
+	  /*! \name Constant matrices given by the generator, read by rows.
+	    @{ */
+	  double *m_Pu;
+	  double *m_iPu;
+	  double *m_Px;
+	  /*! @} */
+
+	  /*! \brief \f$ iPu^{\top} Px \f$ */
+	  MatrixRowMajor m_iPuPx;
+
+	  /*! \brief Current solution. */
+	  Eigen::VectorXd m_Vk;
+
+	  /*! \brief ZMP trajectory of the last solution. */
+	  Eigen::VectorXd m_PreviousZMPSolution;
+
+	  /*! \brief ZMP reference of one axis for the initial solution. */
+	  Eigen::VectorXd m_ZMPRef;
+
+	  /*! \brief Unconstrained descent direction \f$ c \f$. */
+	  Eigen::VectorXd m_UnconstrainedDescentDirection;
+
+	  /*! \brief Projected descent direction \f$ d \f$. */
+	  Eigen::VectorXd m_d;
+
+	  /*! \brief \f$ v_1 = E c \f$ and
+	    \f$ v_2 = (E E^{\top})^{-1} v_1 \f$ */
+	  Eigen::VectorXd m_v1, m_v2;
+
+	  /*! \brief Values of \f$ A d \f$ and \f$ A V_k \f$
+	    for all the constraints. */
+	  Eigen::VectorXd m_Ad, m_AVk;
+
+	  /*! \brief Cholesky factor of \f$ E E^{\top} \f$,
+	    updated by m_OptCholesky. */
+	  MatrixRowMajor m_L;
+
+	  /*! \brief Flag of the active constraints. */
+	  std::vector<bool> m_IsActive;
+
+	  /*! \brief Active constraints kept for the next call. */
+	  std::vector<unsigned int> m_PreviouslyActivatedConstraints;
+
+	  /*! \brief Buffer of the constraints activated by the hot start. */
+	  std::vector<unsigned int> m_HotStartConstraints;
+
+	  /*! \brief Cholesky decomposition optimized for QP solving. */
+	  PatternGeneratorJRL::OptCholesky * m_OptCholesky;
+
+	  /*! \name Arguments of the current call.
+	    @{ */
+	  double *m_A;
+	  double *m_b;
+	  double *m_CstPartOfCostFunction;
+	  /*! @} */
+
+	  /*! Maximum number of constraints. */
+	  unsigned int m_NbMaxOfConstraints;
+
+	  /*! Current number of constraints. */
+	  unsigned int m_NbOfConstraints;
+
+	  /*! Size of the control vector for one axis. */
+	  unsigned int m_CardV;
+
+	  /*! Number of iterations */
+	  int m_ItNb;
+
+	  /*! Boolean to perform a hotstart */
+	  bool m_HotStart;
+
+	  /*! Internal time, for the error messages. */
+	  double m_InternalTime;
+
+	  /*! Tolerance for zero value */
+	  double m_tol;
+
+	  /*! \name Data related to a limited amount of computational time
+	    @{ */
+	  bool m_LimitedComputationTime;
+	  double m_AmountOfLimitedComputationTime;
+	  /*! @} */
+	};
+    }
+}
+#endif /* _PLDP_SOLVER_EIGEN_H_ */
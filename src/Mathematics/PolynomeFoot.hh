@@ -66,6 +66,12 @@ namespace PatternGeneratorJRL
     /*! Compute the value of the third derivative (jerk). */
     double ComputeJerk(double t);
 
+    /*! Get and set the final time. */
+    inline double FinalTime() const
+    { return FT_; }
+    inline void FinalTime(double FT)
+    { FT_ = FT; }
+
 };
 
   /// Polynome used for X,Y and Theta trajectories.
@@ -0,0 +1,307 @@
+/*
+ * Copyright 2019,
+ *
+ * Olivier Stasse
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+/*! \file active-set-cache.cpp
+  \brief Optimal active sets of the linear MPC indexed by the support
+  pattern. */
+
+#include <math.h>
+#include <string.h>
+
+#include <Mathematics/active-set-cache.hh>
+#include <Mathematics/active-set-qp.hh>
+
+#include <Debug.hh>
+
+using namespace PatternGeneratorJRL;
+
+const unsigned long long ActiveSetCache::EmptyKey = 14695981039346656037ULL;
+
+namespace
+{
+  /// \brief Residual under which a constraint is active in store()
+  const double ActiveTolerance = 1e-7;
+  /// \brief Violation of the constraints accepted by solve()
+  const double FeasibilityTolerance = 1e-8;
+  /// \brief Smallest multiplier of an active inequality accepted by solve()
+  const double DualTolerance = -1e-9;
+  /// \brief Conditioning under which the active rows are dependent
+  const double PivotTolerance = 1e-12;
+}
+
+ActiveSetCache::ActiveSetCache( unsigned int MaxNbOfPatterns,
+                                unsigned int MaxNbOfActiveSets ):
+  MaxNbOfPatterns_(MaxNbOfPatterns),
+  MaxNbOfActiveSets_(MaxNbOfActiveSets),
+  Identity_(false),
+  Factorized_(false),
+  NbHits_(0), NbMisses_(0), Clock_(0)
+{
+}
+
+
+void
+ActiveSetCache::clear()
+{
+  Patterns_.clear();
+  NbHits_ = NbMisses_ = 0;
+}
+
+
+unsigned long long
+ActiveSetCache::combine( unsigned long long Key,
+                         const double * Data, unsigned int Size )
+{
+  const unsigned char * lBytes = (const unsigned char *)Data;
+  for( unsigned int i = 0; i < Size*sizeof(double); i++ )
+    {
+      Key ^= lBytes[i];
+      Key *= 1099511628211ULL;
+    }
+  return Key;
+}
+
+
+bool
+ActiveSetCache::factorize( int n, const double * Q )
+{
+  bool lIdentity = (Q == 0);
+  if( Factorized_ && Q_.rows() == n && Identity_ == lIdentity &&
+      (lIdentity || memcmp(Q_.data(), Q, n*n*sizeof(double)) == 0) )
+    return true;
+
+  Patterns_.clear();
+  Identity_ = lIdentity;
+  Factorized_ = false;
+  if( Identity_ )
+    Q_.setIdentity(n,n);
+  else
+    {
+      Q_ = Eigen::Map<const Eigen::MatrixXd>(Q,n,n);
+      LLT_.compute(Q_);
+      if( LLT_.info() != Eigen::Success )
+        return false;
+    }
+  Factorized_ = true;
+  return true;
+}
+
+
+bool
+ActiveSetCache::solve( unsigned long long Key, int n, int m, int me,
+                       const double * Q, const double * D,
+                       const double * DU, int ldDU, const double * DS,
+                       const double * XL, const double * XU,
+                       double * X )
+{
+  // factorize() drops the patterns if Q has changed.
+  Patterns_t::iterator it;
+  if( !factorize(n,Q) || (it = Patterns_.find(Key)) == Patterns_.end() )
+    {
+      NbMisses_++;
+      return false;
+    }
+
+  std::vector<ActiveSet> & lActiveSets = it->second.ActiveSets;
+  for( unsigned int i = 0; i < lActiveSets.size(); i++ )
+    if( try_active_set(lActiveSets[i], n, m, me, D, DU, ldDU, DS, XL, XU, X) )
+      {
+        // Most recently used first.
+        for( ; i > 0; i-- )
+          std::swap(lActiveSets[i], lActiveSets[i-1]);
+        it->second.LastUse = ++Clock_;
+        NbHits_++;
+        return true;
+      }
+  NbMisses_++;
+  return false;
+}
+
+
+bool
+ActiveSetCache::try_active_set( const ActiveSet & anActiveSet,
+                                int n, int m, int me,
+                                const double * D,
+                                const double * DU, int ldDU, const double * DS,
+                                const double * XL, const double * XU,
+                                double * X )
+{
+  const std::vector<int> & lRows = anActiveSet.Rows;
+  int k = (int)lRows.size();
+
+  // The active rows have to be those of the factorization.
+  b_.resize(k);
+  for( int i = 0; i < k; i++ )
+    {
+      int r = lRows[i];
+      if( r < m )
+        {
+          for( int j = 0; j < n; j++ )
+            if( DU[r+ldDU*j] != anActiveSet.A(i,j) )
+              return false;
+          b_(i) = DS[r];
+        }
+      else if( r < m+n )
+        {
+          if( XL[r-m] < -ActiveSetQP::InfiniteBound )
+            return false;
+          b_(i) = -XL[r-m];
+        }
+      else
+        {
+          if( XU[r-m-n] > ActiveSetQP::InfiniteBound )
+            return false;
+          b_(i) = XU[r-m-n];
+        }
+    }
+
+  // Q x + D = A^T lambda and A x + b = 0 give
+  // A Q^{-1} A^T lambda = A Q^{-1} D - b, i.e. with y = L^{-1} D,
+  // M^T M lambda = M^T y - b and x = L^{-T} (M lambda - y).
+  y_ = Eigen::Map<const Eigen::VectorXd>(D,n);
+  if( !Identity_ )
+    LLT_.matrixL().solveInPlace(y_);
+  lambda_.noalias() = anActiveSet.M.transpose()*y_;
+  lambda_ -= b_;
+  anActiveSet.S.solveInPlace(lambda_);
+  for( int i = 0; i < k; i++ )
+    if( lRows[i] >= me && lambda_(i) < DualTolerance )
+      return false;
+
+  x_.noalias() = anActiveSet.M*lambda_;
+  x_ -= y_;
+  if( !Identity_ )
+    LLT_.matrixU().solveInPlace(x_);
+
+  // The active rows are checked since S may be badly conditioned.
+  for( int i = 0; i < k; i++ )
+    if( fabs(anActiveSet.A.row(i).dot(x_)+b_(i)) > FeasibilityTolerance )
+      return false;
+  for( int r = 0; r < m; r++ )
+    {
+      double s = DS[r];
+      for( int j = 0; j < n; j++ )
+        s += DU[r+ldDU*j]*x_(j);
+      if( s < -FeasibilityTolerance )
+        return false;
+    }
+  for( int j = 0; j < n; j++ )
+    if( x_(j) < XL[j]-FeasibilityTolerance ||
+        x_(j) > XU[j]+FeasibilityTolerance )
+      return false;
+
+  Eigen::Map<Eigen::VectorXd>(X,n) = x_;
+  return true;
+}
+
+
+void
+ActiveSetCache::store( unsigned long long Key, int n, int m, int me,
+                       const double * Q,
+                       const double * DU, int ldDU, const double * DS,
+                       const double * XL, const double * XU,
+                       const double * X )
+{
+  if( MaxNbOfPatterns_ == 0 || MaxNbOfActiveSets_ == 0 || !factorize(n,Q) )
+    return;
+
+  ActiveSet anActiveSet;
+  for( int r = 0; r < m; r++ )
+    {
+      double s = DS[r];
+      for( int j = 0; j < n; j++ )
+        s += DU[r+ldDU*j]*X[j];
+      if( r < me || fabs(s) <= ActiveTolerance*(1.0+fabs(DS[r])) )
+        anActiveSet.Rows.push_back(r);
+    }
+  for( int j = 0; j < n; j++ )
+    if( XL[j] >= -ActiveSetQP::InfiniteBound &&
+        fabs(X[j]-XL[j]) <= ActiveTolerance*(1.0+fabs(XL[j])) )
+      anActiveSet.Rows.push_back(m+j);
+  for( int j = 0; j < n; j++ )
+    if( XU[j] <= ActiveSetQP::InfiniteBound &&
+        fabs(X[j]-XU[j]) <= ActiveTolerance*(1.0+fabs(XU[j])) )
+      anActiveSet.Rows.push_back(m+n+j);
+
+  // More active rows than variables: degenerate, no unique multipliers.
+  int k = (int)anActiveSet.Rows.size();
+  if( k > n )
+    return;
+
+  anActiveSet.A.setZero(k,n);
+  for( int i = 0; i < k; i++ )
+    {
+      int r = anActiveSet.Rows[i];
+      if( r < m )
+        for( int j = 0; j < n; j++ )
+          anActiveSet.A(i,j) = DU[r+ldDU*j];
+      else if( r < m+n )
+        anActiveSet.A(i,r-m) = 1.0;
+      else
+        anActiveSet.A(i,r-m-n) = -1.0;
+    }
+  anActiveSet.M = anActiveSet.A.transpose();
+  if( !Identity_ )
+    LLT_.matrixL().solveInPlace(anActiveSet.M);
+  Eigen::MatrixXd S = anActiveSet.M.transpose()*anActiveSet.M;
+  anActiveSet.S.compute(S);
+  if( anActiveSet.S.info() != Eigen::Success )
+    return;
+  if( k > 0 )
+    {
+      Eigen::VectorXd lPivots = anActiveSet.S.matrixLLT().diagonal();
+      if( lPivots.minCoeff() <= sqrt(PivotTolerance)*lPivots.maxCoeff() )
+        return;
+    }
+
+  Patterns_t::iterator it = Patterns_.find(Key);
+  if( it == Patterns_.end() )
+    {
+      if( Patterns_.size() >= MaxNbOfPatterns_ )
+        {
+          // Drop the least recently used pattern.
+          Patterns_t::iterator lOldest = Patterns_.begin();
+          for( Patterns_t::iterator lit = Patterns_.begin();
+               lit != Patterns_.end(); lit++ )
+            if( lit->second.LastUse < lOldest->second.LastUse )
+              lOldest = lit;
+          Patterns_.erase(lOldest);
+        }
+      it = Patterns_.insert(std::make_pair(Key,Pattern())).first;
+    }
+
+  std::vector<ActiveSet> & lActiveSets = it->second.ActiveSets;
+  for( unsigned int i = 0; i < lActiveSets.size(); i++ )
+    if( lActiveSets[i].Rows == anActiveSet.Rows &&
+        lActiveSets[i].A == anActiveSet.A )
+      {
+        lActiveSets.erase(lActiveSets.begin()+i);
+        break;
+      }
+  if( lActiveSets.size() >= MaxNbOfActiveSets_ )
+    lActiveSets.pop_back();
+  lActiveSets.insert(lActiveSets.begin(), anActiveSet);
+  it->second.LastUse = ++Clock_;
+  ODEBUG("Active set of " << k << " rows stored, "
+         << Patterns_.size() << " patterns");
+}
@@ -0,0 +1,160 @@
+/*
+ * Copyright 2019,
+ *
+ * Olivier Stasse
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+/*! \file active-set-cache.hh
+  \brief Optimal active sets of the linear MPC indexed by the support
+  pattern, with an explicit solution of the QP for each of them. */
+
+#ifndef _ACTIVE_SET_CACHE_H_
+#define _ACTIVE_SET_CACHE_H_
+
+#include <map>
+#include <vector>
+
+#include <Eigen/Dense>
+
+namespace PatternGeneratorJRL
+{
+
+  /// \brief Cache of the optimal active sets of a parametric QP.
+  ///
+  /// In the formulations of Wieber 2006 and Dimitrov 2008 the Hessian is
+  /// constant and the constraint matrix only depends on the sequence of
+  /// support polygons over the preview window: the initial state and the
+  /// position of the feet only change the vectors D and DS. For a given
+  /// support pattern the optimal active set is then constant over a
+  /// polyhedral region of these parameters (a critical region of the
+  /// explicit MPC), and a regular gait visits a few of them.
+  ///
+  /// The problem has the layout of QLD (see ActiveSetQP). For each support
+  /// pattern, given as a key computed by the caller, the cache keeps the
+  /// last active sets found by the iterative solver with the factorization
+  /// of their KKT system. solve() tries them in turn: the solution of the
+  /// equality constrained problem costs two triangular solves, and it is
+  /// optimal if the multipliers are nonnegative and the inactive
+  /// constraints are satisfied. Otherwise the caller runs its iterative
+  /// solver and gives the solution to store().
+  ///
+  /// The active rows are compared with the stored ones, so a collision of
+  /// the keys can only cost a miss.
+  class ActiveSetCache
+  {
+  public:
+    /// \param MaxNbOfPatterns Number of support patterns kept
+    /// \param MaxNbOfActiveSets Number of active sets kept per pattern
+    ActiveSetCache( unsigned int MaxNbOfPatterns = 256,
+                    unsigned int MaxNbOfActiveSets = 4 );
+
+    /// \brief Solve the problem with the active sets stored for Key.
+    ///
+    /// The arguments are those of ActiveSetQP::solve(), Q may be null
+    /// for the identity.
+    /// \return true if X is the solution, false if none of the active
+    /// sets is optimal.
+    bool solve( unsigned long long Key, int n, int m, int me,
+                const double * Q, const double * D,
+                const double * DU, int ldDU, const double * DS,
+                const double * XL, const double * XU,
+                double * X );
+
+    /// \brief Store the active set of the solution X of the problem
+    /// found by another solver.
+    void store( unsigned long long Key, int n, int m, int me,
+                const double * Q,
+                const double * DU, int ldDU, const double * DS,
+                const double * XL, const double * XU,
+                const double * X );
+
+    /// \brief Forget all the active sets.
+    void clear();
+
+    /// \brief Add Size values to a key (FNV-1a on their bytes).
+    static unsigned long long combine( unsigned long long Key,
+                                       const double * Data,
+                                       unsigned int Size );
+    /// \brief Initial value of a key
+    static const unsigned long long EmptyKey;
+
+    /// \name Statistics since the last clear()
+    /// \{
+    inline unsigned long int NbHits() const
+    { return NbHits_; }
+    inline unsigned long int NbMisses() const
+    { return NbMisses_; }
+    inline double HitRate() const
+    { return (NbHits_+NbMisses_==0) ? 0.0 :
+        (double)NbHits_/(double)(NbHits_+NbMisses_); }
+    inline unsigned int NbOfPatterns() const
+    { return (unsigned int)Patterns_.size(); }
+    /// \}
+
+  private:
+    /// \brief Active set and factorization of its KKT system.
+    struct ActiveSet
+    {
+      /// \brief Active rows with the numbering of the multipliers of
+      /// ActiveSetQP: constraints, lower bounds, upper bounds.
+      std::vector<int> Rows;
+      /// \brief Normals of the active constraints (one row each)
+      Eigen::MatrixXd A;
+      /// \brief \f$ L^{-1} A^T \f$ with \f$ Q = L L^T \f$
+      Eigen::MatrixXd M;
+      /// \brief \f$ M^T M = A Q^{-1} A^T \f$
+      Eigen::LLT<Eigen::MatrixXd> S;
+    };
+
+    struct Pattern
+    {
+      /// \brief Most recently used first
+      std::vector<ActiveSet> ActiveSets;
+      unsigned long int LastUse;
+    };
+
+    /// \brief Factorize Q unless it is the one of the previous call.
+    /// All the active sets are dropped when Q changes.
+    bool factorize( int n, const double * Q );
+
+    /// \brief Solve the KKT system of anActiveSet and check optimality.
+    bool try_active_set( const ActiveSet & anActiveSet, int n, int m, int me,
+                         const double * D,
+                         const double * DU, int ldDU, const double * DS,
+                         const double * XL, const double * XU,
+                         double * X );
+
+    typedef std::map<unsigned long long, Pattern> Patterns_t;
+    Patterns_t Patterns_;
+    unsigned int MaxNbOfPatterns_, MaxNbOfActiveSets_;
+
+    Eigen::MatrixXd Q_;
+    Eigen::LLT<Eigen::MatrixXd> LLT_;
+    bool Identity_;
+    bool Factorized_;
+
+    /// \brief Work vectors, to avoid allocations when the cache hits
+    Eigen::VectorXd y_, b_, lambda_, x_;
+
+    unsigned long int NbHits_, NbMisses_, Clock_;
+  };
+
+}
+#endif /* _ACTIVE_SET_CACHE_H_ */
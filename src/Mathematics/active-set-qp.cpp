@@ -0,0 +1,489 @@
+/*
+ * Copyright 2019,
+ *
+ * Olivier Stasse
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+/*! \file active-set-qp.cpp
+  \brief Dense active-set QP solver with hot start. */
+
+#include <math.h>
+#include <string.h>
+
+#include <limits>
+
+#include <Mathematics/active-set-qp.hh>
+
+#include <Debug.hh>
+
+using namespace PatternGeneratorJRL;
+
+const double ActiveSetQP::InfiniteBound = 1e7;
+
+namespace
+{
+  /// \brief Violation under which a constraint is satisfied.
+  const double ConstraintTolerance = 1e-9;
+  const double Infinity = std::numeric_limits<double>::infinity();
+  const double Epsilon = std::numeric_limits<double>::epsilon();
+}
+
+ActiveSetQP::ActiveSetQP():
+  Rnorm_(1.0),
+  NbActive_(0), NbEqualities_(0),
+  NbRows_(0),
+  Cancel_(0),
+  NbIterations_(0), NbHotStartConstraints_(0),
+  FactorizationReused_(false),
+  Factorized_(false)
+{
+}
+
+
+void
+ActiveSetQP::reset()
+{
+  WorkingSet_.clear();
+  Factorized_ = false;
+}
+
+
+void
+ActiveSetQP::shift_working_set( int NbRemovedRows )
+{
+  unsigned int w = 0;
+  for( unsigned int i = 0; i < WorkingSet_.size(); i++ )
+    {
+      int k = WorkingSet_[i];
+      if( k < NbRemovedRows || k >= NbRows_ )
+        continue;
+      WorkingSet_[w++] = k-NbRemovedRows;
+    }
+  WorkingSet_.resize(w);
+}
+
+
+void
+ActiveSetQP::factorization( const Eigen::MatrixXd & Q, const Eigen::MatrixXd & J0 )
+{
+  StoragePool_.resize(Q_,Q.rows(),Q.cols());
+  Q_ = Q;
+  StoragePool_.resize(J0_,J0.rows(),J0.cols());
+  J0_ = J0;
+  Factorized_ = true;
+}
+
+
+bool
+ActiveSetQP::factorize( int n, const double * Q )
+{
+  FactorizationReused_ = false;
+  if( Factorized_ && Q_.rows() == n &&
+      memcmp(Q_.data(), Q, n*n*sizeof(double)) == 0 )
+    {
+      FactorizationReused_ = true;
+      return true;
+    }
+
+  StoragePool_.resize(Q_,n,n);
+  Q_ = Eigen::Map<const Eigen::MatrixXd>(Q,n,n);
+  LLT_.compute(Q_);
+  if( LLT_.info() != Eigen::Success )
+    {
+      Factorized_ = false;
+      return false;
+    }
+  // J0 J0^T = Q^{-1}
+  StoragePool_.resize(J0_,n,n);
+  J0_.setIdentity();
+  LLT_.matrixU().solveInPlace(J0_);
+  Factorized_ = true;
+  return true;
+}
+
+
+void
+ActiveSetQP::build_constraints( int n, int m,
+                                const double * DU, int ldDU, const double * DS,
+                                const double * XL, const double * XU )
+{
+  int NbConstraints = m+2*n;
+  // The storage only grows, so that problems with a varying number
+  // of constraints do not reallocate it.
+  if( N_.rows() != n || N_.cols() < NbConstraints )
+    {
+      StoragePool_.resize(N_,n,NbConstraints);
+      StoragePool_.resize(c_,NbConstraints);
+    }
+  Enabled_.assign(NbConstraints,true);
+
+  for( int i = 0; i < m; i++ )
+    {
+      for( int j = 0; j < n; j++ )
+        N_(j,i) = DU[i+ldDU*j];
+      c_(i) = DS[i];
+    }
+
+  N_.middleCols(m,2*n).setZero();
+  for( int j = 0; j < n; j++ )
+    {
+      N_(j,m+j) = 1.0;
+      c_(m+j) = -XL[j];
+      Enabled_[m+j] = XL[j] > -InfiniteBound;
+      N_(j,m+n+j) = -1.0;
+      c_(m+n+j) = XU[j];
+      Enabled_[m+n+j] = XU[j] < InfiniteBound;
+    }
+}
+
+
+void
+ActiveSetQP::compute_directions( int k )
+{
+  int n = (int)J_.rows();
+  int iq = NbActive_;
+
+  d_.noalias() = J_.transpose()*N_.col(k);
+  z_.noalias() = J_.rightCols(n-iq)*d_.tail(n-iq);
+  for( int i = iq-1; i >= 0; i-- )
+    {
+      double sum = d_(i);
+      for( int j = i+1; j < iq; j++ )
+        sum -= R_(i,j)*r_(j);
+      r_(i) = sum/R_(i,i);
+    }
+}
+
+
+bool
+ActiveSetQP::add_constraint()
+{
+  int n = (int)J_.rows();
+  int iq = NbActive_;
+
+  // Givens rotations cancelling d(iq+1..n-1).
+  for( int j = n-1; j > iq; j-- )
+    {
+      double cc = d_(j-1), ss = d_(j);
+      double h = hypot(cc,ss);
+      if( h == 0.0 )
+        continue;
+      d_(j) = 0.0;
+      cc /= h; ss /= h;
+      if( cc < 0.0 )
+        {
+          cc = -cc; ss = -ss;
+          d_(j-1) = -h;
+        }
+      else
+        d_(j-1) = h;
+      double xny = ss/(1.0+cc);
+      for( int k = 0; k < n; k++ )
+        {
+          double t1 = J_(k,j-1), t2 = J_(k,j);
+          J_(k,j-1) = t1*cc+t2*ss;
+          J_(k,j) = xny*(t1+J_(k,j-1))-t2;
+        }
+    }
+
+  NbActive_++;
+  R_.col(iq).head(iq+1) = d_.head(iq+1);
+  if( fabs(d_(iq)) <= Epsilon*Rnorm_ )
+    return false;
+  if( fabs(d_(iq)) > Rnorm_ )
+    Rnorm_ = fabs(d_(iq));
+  return true;
+}
+
+
+void
+ActiveSetQP::delete_constraint( int Position )
+{
+  int n = (int)J_.rows();
+  int iq = NbActive_;
+
+  IsActive_[Active_[Position]] = false;
+  // The candidate constraint at position iq is shifted as well.
+  for( int i = Position; i < iq; i++ )
+    {
+      Active_[i] = Active_[i+1];
+      u_(i) = u_(i+1);
+      if( i < iq-1 )
+        R_.col(i) = R_.col(i+1);
+    }
+  Active_[iq] = -1;
+  u_(iq) = 0.0;
+  R_.col(iq-1).setZero();
+  NbActive_ = --iq;
+
+  // Restore the triangular form of R.
+  for( int j = Position; j < iq; j++ )
+    {
+      double cc = R_(j,j), ss = R_(j+1,j);
+      double h = hypot(cc,ss);
+      if( h == 0.0 )
+        continue;
+      cc /= h; ss /= h;
+      R_(j+1,j) = 0.0;
+      if( cc < 0.0 )
+        {
+          R_(j,j) = -h;
+          cc = -cc; ss = -ss;
+        }
+      else
+        R_(j,j) = h;
+      double xny = ss/(1.0+cc);
+      for( int k = j+1; k < iq; k++ )
+        {
+          double t1 = R_(j,k), t2 = R_(j+1,k);
+          R_(j,k) = t1*cc+t2*ss;
+          R_(j+1,k) = xny*(t1+R_(j,k))-t2;
+        }
+      for( int k = 0; k < n; k++ )
+        {
+          double t1 = J_(k,j), t2 = J_(k,j+1);
+          J_(k,j) = t1*cc+t2*ss;
+          J_(k,j+1) = xny*(J_(k,j)+t1)-t2;
+        }
+    }
+}
+
+
+void
+ActiveSetQP::solve_active_set( int n )
+{
+  int iq = NbActive_;
+
+  // x = -J2 J2^T D - J1 R^{-T} c_A
+  for( int i = 0; i < iq; i++ )
+    {
+      double sum = c_(Active_[i]);
+      for( int j = 0; j < i; j++ )
+        sum -= R_(j,i)*tmp_(j);
+      tmp_(i) = sum/R_(i,i);
+    }
+  d_.tail(n-iq).noalias() = J_.rightCols(n-iq).transpose()*D_;
+  x_.noalias() = -J_.rightCols(n-iq)*d_.tail(n-iq);
+  x_.noalias() -= J_.leftCols(iq)*tmp_.head(iq);
+
+  // u = R^{-1} J1^T (Q x + D)
+  z_ = D_;
+  z_.noalias() += Q_*x_;
+  d_.head(iq).noalias() = J_.leftCols(iq).transpose()*z_;
+  for( int i = iq-1; i >= 0; i-- )
+    {
+      double sum = d_(i);
+      for( int j = i+1; j < iq; j++ )
+        sum -= R_(i,j)*u_(j);
+      u_(i) = sum/R_(i,i);
+    }
+}
+
+
+int
+ActiveSetQP::solve( int n, int m, int me,
+                    const double * Q, const double * D,
+                    const double * DU, int ldDU, const double * DS,
+                    const double * XL, const double * XU,
+                    double * X, double * U )
+{
+  NbIterations_ = 0;
+  NbHotStartConstraints_ = 0;
+  NbRows_ = m;
+  int NbConstraints = m+2*n;
+  int Fail = 0;
+
+  if( !factorize(n,Q) )
+    {
+      WorkingSet_.clear();
+      return 3;
+    }
+  StoragePool_.resize(D_,n);
+  D_ = Eigen::Map<const Eigen::VectorXd>(D,n);
+  build_constraints(n,m,DU,ldDU,DS,XL,XU);
+
+  StoragePool_.resize(J_,n,n);
+  J_ = J0_;
+  StoragePool_.resize(R_,n,n);
+  R_.setZero();
+  Rnorm_ = 1.0;
+  StoragePool_.resize(x_,n); StoragePool_.resize(d_,n);
+  StoragePool_.resize(z_,n); StoragePool_.resize(r_,n);
+  StoragePool_.resize(tmp_,n);
+  StoragePool_.resize(u_,n+1);
+  u_.setZero();
+  Active_.assign(n+1,-1);
+  IsActive_.assign(NbConstraints,false);
+  NbActive_ = 0;
+
+  // Unconstrained minimum.
+  d_.noalias() = J_.transpose()*D_;
+  x_.noalias() = -J_*d_;
+
+  // Equality constraints.
+  for( int i = 0; i < me && Fail == 0; i++ )
+    {
+      if( N_.col(i).squaredNorm() == 0.0 )
+        continue;
+      compute_directions(i);
+      if( z_.squaredNorm() <= Epsilon )
+        continue;
+      int iq = NbActive_;
+      double t2 = -(N_.col(i).dot(x_)+c_(i))/z_.dot(N_.col(i));
+      x_ += t2*z_;
+      u_.head(iq) -= t2*r_.head(iq);
+      u_(iq) = t2;
+      Active_[iq] = i;
+      IsActive_[i] = true;
+      if( !add_constraint() )
+        Fail = 2;
+    }
+  NbEqualities_ = NbActive_;
+
+  // Hot start: the previous active set is added at once,
+  // then the constraints with a negative multiplier are dropped.
+  for( unsigned int w = 0; w < WorkingSet_.size() && Fail == 0; w++ )
+    {
+      int k = WorkingSet_[w];
+      if( NbActive_ == n )
+        break;
+      if( k < me || k >= NbConstraints || !Enabled_[k] || IsActive_[k] )
+        continue;
+      compute_directions(k);
+      if( z_.squaredNorm() <= Epsilon )
+        continue;
+      Active_[NbActive_] = k;
+      IsActive_[k] = true;
+      if( !add_constraint() )
+        delete_constraint(NbActive_-1);
+    }
+  NbHotStartConstraints_ = NbActive_-NbEqualities_;
+  while( NbHotStartConstraints_ > 0 && Fail == 0 )
+    {
+      solve_active_set(n);
+      int q = -1;
+      double umin = 0.0;
+      for( int i = NbEqualities_; i < NbActive_; i++ )
+        if( u_(i) < umin )
+          {
+            umin = u_(i);
+            q = i;
+          }
+      if( q < 0 )
+        break;
+      delete_constraint(q);
+      NbIterations_++;
+    }
+
+  // Dual iterations.
+  unsigned int MaxIterations = 40*(n+m);
+  while( Fail == 0 )
+    {
+      // Most violated constraint.
+      int p = -1;
+      double ss = -ConstraintTolerance;
+      for( int k = me; k < NbConstraints; k++ )
+        {
+          if( !Enabled_[k] || IsActive_[k] )
+            continue;
+          double s = N_.col(k).dot(x_)+c_(k);
+          if( s < ss )
+            {
+              ss = s;
+              p = k;
+            }
+        }
+      if( p < 0 )
+        break;
+
+      Active_[NbActive_] = p;
+      u_(NbActive_) = 0.0;
+      while( Fail == 0 )
+        {
+          if( ++NbIterations_ > MaxIterations )
+            {
+              Fail = 1;
+              break;
+            }
+          if( Cancel_ != 0 && Cancel_->load(boost::memory_order_relaxed) )
+            {
+              Fail = 4;
+              break;
+            }
+          compute_directions(p);
+          int iq = NbActive_;
+
+          // Largest step keeping the multipliers positive.
+          int l = -1;
+          double t1 = Infinity;
+          for( int k = NbEqualities_; k < iq; k++ )
+            if( r_(k) > 0.0 && u_(k)/r_(k) < t1 )
+              {
+                t1 = u_(k)/r_(k);
+                l = k;
+              }
+          // Step reaching the constraint.
+          double t2 = Infinity;
+          if( z_.squaredNorm() > Epsilon )
+            t2 = -ss/z_.dot(N_.col(p));
+
+          double t = (t1 < t2) ? t1 : t2;
+          if( t == Infinity )
+            {
+              Fail = 10+p;
+              break;
+            }
+
+          u_.head(iq) -= t*r_.head(iq);
+          u_(iq) += t;
+          if( t2 == Infinity )
+            {
+              // Step in the dual space only.
+              delete_constraint(l);
+              continue;
+            }
+
+          x_ += t*z_;
+          if( t2 <= t1 )
+            {
+              IsActive_[p] = true;
+              if( !add_constraint() )
+                Fail = 2;
+              break;
+            }
+          delete_constraint(l);
+          ss = N_.col(p).dot(x_)+c_(p);
+        }
+    }
+
+  for( int i = 0; i < n; i++ )
+    X[i] = x_(i);
+  memset(U, 0, NbConstraints*sizeof(double));
+  WorkingSet_.clear();
+  for( int i = 0; i < NbActive_; i++ )
+    {
+      U[Active_[i]] = u_(i);
+      if( i >= NbEqualities_ && (Fail == 0 || Fail == 4) )
+        WorkingSet_.push_back(Active_[i]);
+    }
+  ODEBUG("Active set QP: " << NbIterations_ << " iterations, "
+         << NbHotStartConstraints_ << " hot start constraints");
+  return Fail;
+}
@@ -0,0 +1,192 @@
+/*
+ * Copyright 2019,
+ *
+ * Olivier Stasse
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+/*! \file active-set-qp.hh
+  \brief Dense active-set QP solver with hot start. */
+
+#ifndef _ACTIVE_SET_QP_H_
+#define _ACTIVE_SET_QP_H_
+
+#include <vector>
+
+#include <Eigen/Dense>
+
+#include <MatrixStoragePool.hh>
+
+#include <boost/atomic.hpp>
+
+namespace PatternGeneratorJRL
+{
+
+  /// \brief Dense dual active-set solver (Goldfarb-Idnani) keeping its
+  /// Cholesky factor and its active set between two calls.
+  ///
+  /// The problem has the layout of QLD:
+  /// \f$ \min \frac{1}{2} x^T Q x + D^T x \f$ such that
+  /// \f$ DU_i x + DS_i = 0 \f$ for the first me rows,
+  /// \f$ DU_i x + DS_i \geq 0 \f$ for the others, and
+  /// \f$ XL \leq x \leq XU \f$. Q has to be positive definite.
+  ///
+  /// The factorization of Q is reused when Q has not changed since the
+  /// previous call. The solver then starts from the constraints which
+  /// were active at the previous solution: they are added at once, those
+  /// with a negative multiplier are dropped, and the dual iterations
+  /// only handle the changes of the active set.
+  class ActiveSetQP
+  {
+  public:
+    ActiveSetQP();
+
+    /// \brief Solve the problem, with the arrays of QLD (column major).
+    ///
+    /// \param[in] n Number of variables
+    /// \param[in] m Number of constraints (rows of DU)
+    /// \param[in] me Number of equality constraints (first rows of DU)
+    /// \param[in] Q Hessian (n x n)
+    /// \param[in] D Gradient (n)
+    /// \param[in] DU Constraints matrix, leading dimension ldDU
+    /// \param[in] DS Constraints vector (m)
+    /// \param[in] XL Lower bounds (n), values under -InfiniteBound are ignored
+    /// \param[in] XU Upper bounds (n), values over InfiniteBound are ignored
+    /// \param[out] X Solution (n)
+    /// \param[out] U Multipliers: constraints, lower bounds and upper bounds (m+2n)
+    /// \return 0 on success, 1 if the maximal number of iterations is
+    /// reached, 2 if a constraint cannot be added for numerical reasons,
+    /// 3 if Q is not positive definite, 4 if cancelled, 10+i if constraint i
+    /// is inconsistent with the active ones (with the numbering of U).
+    int solve( int n, int m, int me,
+               const double * Q, const double * D,
+               const double * DU, int ldDU, const double * DS,
+               const double * XL, const double * XU,
+               double * X, double * U );
+
+    /// \brief Forget the active set and the factorization.
+    void reset();
+
+    /// \brief Flag stopping solve() at the next iteration when it is set
+    /// by another thread. The active set reached is kept for the next call.
+    inline void cancel_flag( const boost::atomic<bool> * Cancel )
+    { Cancel_ = Cancel; }
+
+    /// \brief Renumber the active set of the previous solution when the
+    /// next problem drops its first NbRemovedRows rows of DU, as a
+    /// receding horizon does. The active bounds are forgotten.
+    void shift_working_set( int NbRemovedRows );
+
+    /// \brief Provide the factorization of the next Hessian.
+    /// It is used by solve() if its Hessian is equal to Q.
+    ///
+    /// \param[in] Q Hessian
+    /// \param[in] J0 Any matrix such that \f$ J0 J0^T = Q^{-1} \f$
+    void factorization( const Eigen::MatrixXd & Q, const Eigen::MatrixXd & J0 );
+
+    /// \name Report of the last call
+    /// \{
+    /// \brief Number of changes of the active set
+    inline unsigned int NbIterations() const
+    { return NbIterations_; }
+    /// \brief Number of constraints taken from the previous active set
+    inline unsigned int NbHotStartConstraints() const
+    { return NbHotStartConstraints_; }
+    /// \brief Number of active inequality constraints and bounds
+    inline unsigned int NbActiveConstraints() const
+    { return (unsigned int)WorkingSet_.size(); }
+    /// \brief True if the factorization of the previous call was reused
+    inline bool FactorizationReused() const
+    { return FactorizationReused_; }
+    /// \}
+
+    /// \brief Bounds over this value are considered as infinite
+    static const double InfiniteBound;
+
+  private:
+    /// \brief Factorize Q unless it is the one of the previous call.
+    bool factorize( int n, const double * Q );
+
+    /// \brief Fill the constraint normals and constants.
+    void build_constraints( int n, int m,
+                            const double * DU, int ldDU, const double * DS,
+                            const double * XL, const double * XU );
+
+    /// \brief d = J^T np, z = J2 d2 and r = R^{-1} d1.
+    void compute_directions( int k );
+
+    /// \brief Add the constraint of normal J d to the factorization.
+    bool add_constraint();
+
+    /// \brief Remove the constraint at position Position of the active set.
+    void delete_constraint( int Position );
+
+    /// \brief Primal solution and multipliers of the current active set.
+    void solve_active_set( int n );
+
+    /// \name Problem
+    /// \{
+    Eigen::MatrixXd Q_;
+    Eigen::VectorXd D_;
+    /// \brief Normals of the constraints (one column per constraint)
+    Eigen::MatrixXd N_;
+    /// \brief Constants of the constraints
+    Eigen::VectorXd c_;
+    /// \brief False for infinite bounds
+    std::vector<bool> Enabled_;
+    /// \}
+
+    /// \name Factorization
+    /// \{
+    Eigen::LLT<Eigen::MatrixXd> LLT_;
+    /// \brief Inverse of the transposed Cholesky factor
+    Eigen::MatrixXd J0_;
+    /// \brief J0 rotated by the active constraints: J^T N = [R;0]
+    Eigen::MatrixXd J_;
+    Eigen::MatrixXd R_;
+    double Rnorm_;
+    /// \}
+
+    /// \name Iterates
+    /// \{
+    Eigen::VectorXd x_, u_, d_, z_, r_, tmp_;
+    /// \brief Active constraints, the candidate is at position NbActive_
+    std::vector<int> Active_;
+    std::vector<bool> IsActive_;
+    int NbActive_, NbEqualities_;
+    /// \}
+
+    /// \brief Active inequalities of the previous solution
+    std::vector<int> WorkingSet_;
+    /// \brief Number of rows of DU in the previous problem
+    int NbRows_;
+
+    /// \brief Set by another thread to stop solve(), may be null
+    const boost::atomic<bool> * Cancel_;
+
+    /// \brief Storage of the matrices for the sizes met before
+    MatrixStoragePool StoragePool_;
+
+    unsigned int NbIterations_, NbHotStartConstraints_;
+    bool FactorizationReused_;
+    bool Factorized_;
+  };
+
+}
+#endif /* _ACTIVE_SET_QP_H_ */
@@ -133,8 +133,18 @@ namespace PatternGeneratorJRL
     { return StateMatrices_.Ref; };
     inline reference_t & Reference()
     { return StateMatrices_.Ref; };
+    /// \brief Set the constant references, the reference vectors
+    /// keep their storage and are filled by the generator.
     inline void Reference( const reference_t & Ref )
-    { StateMatrices_.Ref = Ref; };
+    {
+      reference_t & StateRef = StateMatrices_.Ref;
+      StateRef.Global.X = Ref.Global.X;
+      StateRef.Global.Y = Ref.Global.Y;
+      StateRef.Global.Yaw = Ref.Global.Yaw;
+      StateRef.Local.X = Ref.Local.X;
+      StateRef.Local.Y = Ref.Local.Y;
+      StateRef.Local.Yaw = Ref.Local.Yaw;
+    };
 
     inline support_state_t const & SupportState() const
     { return StateMatrices_.SupportState; };
@@ -400,16 +400,16 @@ doublereal *eps1;
 /*    integer s_wsfe(), do_fio(), e_wsfe(); */
 
     /* Local variables */
-    static doublereal diag;
+    doublereal diag;
     /* extern int ql0002_(); */
-    static integer nact, info;
-    static doublereal zero;
-    static integer i, j, idiag, maxit;
-    static doublereal qpeps;
-    static integer in, mn, lw;
-    static doublereal ten;
-    static logical lql;
-    static integer inw1, inw2;
+    integer nact, info;
+    doublereal zero;
+    integer i, j, idiag, maxit;
+    doublereal qpeps;
+    integer in, mn, lw;
+    doublereal ten;
+    logical lql;
+    integer inw1, inw2;
 
 
 
@@ -650,35 +650,35 @@ integer *lw;
     /* double sqrt();    */
 
     /* Local variables */
-    static doublereal onha, xmag, suma, sumb, sumc, temp, step, zero;
-    static integer iwwn;
-    static doublereal sumx, sumy;
-    static integer i, j, k;
-    static doublereal fdiff;
-    static integer iflag, jflag, kflag, lflag;
-    static doublereal diagr;
-    static integer ifinc, kfinc, jfinc, mflag, nflag;
-    static doublereal vfact, tempa;
-    static integer iterc, itref;
-    static doublereal cvmax, ratio, xmagr;
-    static integer kdrop;
-    static logical lower;
-    static integer knext, k1;
-    static doublereal ga, gb;
-    static integer ia, id;
-    static doublereal fdiffa;
-    static integer ii, il, kk, jl, ip, ir, nm, is, iu, iw, ju, ix, iz, nu, iy;
-
-    static doublereal parinc, parnew;
-    static integer ira, irb, iwa;
-    static doublereal one;
-    static integer iwd, iza;
-    static doublereal res;
-    static integer ipp, iwr, iws;
-    static doublereal sum;
-    static integer iww, iwx, iwy;
-    static doublereal two;
-    static integer iwz;
+    doublereal onha, xmag, suma, sumb, sumc, temp, step, zero;
+    integer iwwn;
+    doublereal sumx, sumy;
+    integer i, j, k;
+    doublereal fdiff;
+    integer iflag, jflag, kflag, lflag;
+    doublereal diagr;
+    integer ifinc, kfinc, jfinc, mflag, nflag;
+    doublereal vfact, tempa;
+    integer iterc, itref;
+    doublereal cvmax, ratio, xmagr;
+    integer kdrop;
+    logical lower;
+    integer knext, k1;
+    doublereal ga, gb;
+    integer ia, id;
+    doublereal fdiffa;
+    integer ii, il, kk, jl, ip, ir, nm, is, iu, iw, ju, ix, iz, nu, iy;
+
+    doublereal parinc, parnew;
+    integer ira, irb, iwa;
+    doublereal one;
+    integer iwd, iza;
+    doublereal res;
+    integer ipp, iwr, iws;
+    doublereal sum;
+    integer iww, iwx, iwy;
+    doublereal two;
+    integer iwz;
 
 
 /*       WHETHER THE CONSTRAINT IS ACTIVE. */
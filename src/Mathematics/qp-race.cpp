@@ -0,0 +1,355 @@
+/*
+ * Copyright 2019,
+ *
+ * Olivier Stasse
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+/*! \file qp-race.cpp
+  \brief Race of several QP solvers on a pool of threads. */
+
+#include <string.h>
+
+#include <algorithm>
+
+#include <Mathematics/qp-race.hh>
+#include <Mathematics/qld.hh>
+#include <WorkStealingPool.hh>
+
+#include <Debug.hh>
+
+using namespace PatternGeneratorJRL;
+
+namespace
+{
+  /// \brief Bound given to QLD for the missing bounds
+  const double NoBound = 1e10;
+}
+
+QPRace::QPRace():
+  Pool_(0),
+  NbVariables_(0),
+  NbConstraints_(0),
+  Race_(0),
+  Winner_(-1),
+  NbDone_(0),
+  LastWinner_(NB_OF_BACKENDS),
+  NbOfSkips_(0)
+{
+  Backends_.push_back(ACTIVE_SET_HOT);
+  Backends_.push_back(QLD_BACKEND);
+  Backends_.push_back(ACTIVE_SET_COLD);
+  for( unsigned int i = 0; i <= NB_OF_BACKENDS; i++ )
+    NbOfWins_[i] = 0;
+}
+
+
+QPRace::~QPRace()
+{
+  stop();
+}
+
+
+bool
+QPRace::backend( const std::string & Name, backend_e & Backend )
+{
+  for( unsigned int i = 0; i < NB_OF_BACKENDS; i++ )
+    if( Name == name((backend_e)i) )
+      {
+        Backend = (backend_e)i;
+        return true;
+      }
+  return false;
+}
+
+
+const char *
+QPRace::name( backend_e Backend )
+{
+  switch( Backend )
+    {
+    case QLD_BACKEND: return "qld";
+    case ACTIVE_SET_HOT: return "activeset";
+    case ACTIVE_SET_COLD: return "coldactiveset";
+    default: return "none";
+    }
+}
+
+
+void
+QPRace::backends( const std::vector<backend_e> & Backends )
+{
+  stop();
+  Backends_ = Backends;
+}
+
+
+void
+QPRace::Problem::reserve( int NbVariables, int NbConstraints )
+{
+  int lmmax = NbConstraints+1;
+  Q.reserve(NbVariables*NbVariables);
+  D.reserve(NbVariables);
+  DU.reserve(lmmax*NbVariables);
+  DS.reserve(lmmax);
+  XL.reserve(NbVariables);
+  XU.reserve(NbVariables);
+}
+
+
+void
+QPRace::Problem::assign( const Problem & aProblem )
+{
+  n = aProblem.n; m = aProblem.m; me = aProblem.me; mmax = aProblem.mmax;
+  Q.assign(aProblem.Q.begin(),aProblem.Q.end());
+  D.assign(aProblem.D.begin(),aProblem.D.end());
+  DU.assign(aProblem.DU.begin(),aProblem.DU.end());
+  DS.assign(aProblem.DS.begin(),aProblem.DS.end());
+  XL.assign(aProblem.XL.begin(),aProblem.XL.end());
+  XU.assign(aProblem.XU.begin(),aProblem.XU.end());
+}
+
+
+void
+QPRace::start()
+{
+  if( Pool_ != 0 )
+    return;
+  for( unsigned int i = 0; i < Backends_.size(); i++ )
+    {
+      Runner * aRunner = new Runner();
+      aRunner->Backend = Backends_[i];
+      aRunner->Fail = 0;
+      aRunner->Cancel.store(false);
+      aRunner->Race = 0;
+      aRunner->Busy = false;
+      aRunner->Solver.cancel_flag(&aRunner->Cancel);
+      reserve(*aRunner);
+      Runners_.push_back(aRunner);
+    }
+  Entrants_.reserve(Runners_.size());
+  Pool_ = new WorkStealingPool((unsigned int)Runners_.size());
+}
+
+
+void
+QPRace::reserve( int NbVariables, int NbConstraints )
+{
+  if( NbVariables <= NbVariables_ && NbConstraints <= NbConstraints_ )
+    return;
+  NbVariables_ = std::max(NbVariables,NbVariables_);
+  NbConstraints_ = std::max(NbConstraints,NbConstraints_);
+  Problem_.reserve(NbVariables_,NbConstraints_);
+  // A runner busy with a previous race is sized by the next call.
+  boost::lock_guard<boost::mutex> lock(Mutex_);
+  for( unsigned int i = 0; i < Runners_.size(); i++ )
+    if( !Runners_[i]->Busy )
+      reserve(*Runners_[i]);
+}
+
+
+void
+QPRace::reserve( Runner & aRunner )
+{
+  int n = NbVariables_, mmax = NbConstraints_+1;
+  aRunner.Data.reserve(NbVariables_,NbConstraints_);
+  aRunner.X.reserve(n);
+  aRunner.U.reserve(NbConstraints_+2*n);
+  if( aRunner.Backend == QLD_BACKEND )
+    {
+      aRunner.war.reserve(3*n*n/2+10*n+2*mmax+20000);
+      aRunner.iwar.reserve(n);
+    }
+}
+
+
+void
+QPRace::stop()
+{
+  // The destructor of the pool waits for the running solvers.
+  if( Pool_ != 0 )
+    delete Pool_;
+  Pool_ = 0;
+  for( unsigned int i = 0; i < Runners_.size(); i++ )
+    delete Runners_[i];
+  Runners_.clear();
+}
+
+
+void
+QPRace::factorization( const Eigen::MatrixXd & Q, const Eigen::MatrixXd & J0 )
+{
+  if( Pool_ == 0 )
+    start();
+  // A solver still busy with a previous race factorizes the Hessian
+  // itself when it solves the next problem.
+  boost::lock_guard<boost::mutex> lock(Mutex_);
+  for( unsigned int i = 0; i < Runners_.size(); i++ )
+    if( Runners_[i]->Backend != QLD_BACKEND && !Runners_[i]->Busy )
+      Runners_[i]->Solver.factorization(Q,J0);
+}
+
+
+int
+QPRace::solve( int n, int m, int me,
+               const double * Q, const double * D,
+               const double * DU, int ldDU, const double * DS,
+               const double * XL, const double * XU,
+               double * X, double * U )
+{
+  if( Backends_.empty() )
+    return 1;
+  if( Pool_ == 0 )
+    start();
+  // Larger problems than the reserved ones grow the copies once.
+  reserve(n,m);
+
+  Problem_.n = n; Problem_.m = m; Problem_.me = me; Problem_.mmax = m+1;
+  Problem_.Q.assign(Q,Q+n*n);
+  Problem_.D.assign(D,D+n);
+  Problem_.DU.assign(Problem_.mmax*n,0.0);
+  for( int j = 0; j < n; j++ )
+    memcpy(&Problem_.DU[Problem_.mmax*j], DU+ldDU*j, m*sizeof(double));
+  Problem_.DS.assign(Problem_.mmax,0.0);
+  if( m > 0 )
+    memcpy(&Problem_.DS[0], DS, m*sizeof(double));
+  if( XL != 0 )
+    Problem_.XL.assign(XL,XL+n);
+  else
+    Problem_.XL.assign(n,-NoBound);
+  if( XU != 0 )
+    Problem_.XU.assign(XU,XU+n);
+  else
+    Problem_.XU.assign(n,NoBound);
+
+  // The losers of the previous race which are still running, such as
+  // QLD which cannot be stopped, are left out. The winner of the
+  // previous race is done, so at least one solver enters.
+  Entrants_.clear();
+  {
+    boost::lock_guard<boost::mutex> lock(Mutex_);
+    Race_++;
+    Winner_ = -1;
+    NbDone_ = 0;
+    for( unsigned int i = 0; i < Runners_.size(); i++ )
+      {
+        Runner & aRunner = *Runners_[i];
+        if( aRunner.Busy )
+          {
+            NbOfSkips_++;
+            continue;
+          }
+        aRunner.Busy = true;
+        aRunner.Race = Race_;
+        aRunner.Cancel.store(false);
+        Entrants_.push_back(i);
+      }
+  }
+  for( unsigned int k = 0; k < Entrants_.size(); k++ )
+    {
+      Task aTask;
+      aTask.Race = this;
+      aTask.Index = Entrants_[k];
+      Runners_[aTask.Index]->Data.assign(Problem_);
+      Pool_->Submit(aTask,aTask.Index);
+    }
+
+  // Wait for the first success, or for all the failures.
+  int lWinner;
+  {
+    boost::unique_lock<boost::mutex> lock(Mutex_);
+    while( (lWinner = Winner_) < 0 && NbDone_ < Entrants_.size() )
+      Done_.wait(lock);
+  }
+
+  Runner * aRunner = Runners_[lWinner < 0 ? Entrants_[0] : lWinner];
+  if( lWinner < 0 )
+    {
+      // All the solvers are done.
+      LastWinner_ = NB_OF_BACKENDS;
+      NbOfWins_[NB_OF_BACKENDS]++;
+    }
+  else
+    {
+      LastWinner_ = aRunner->Backend;
+      NbOfWins_[LastWinner_]++;
+    }
+  memcpy(X, &aRunner->X[0], n*sizeof(double));
+  memcpy(U, &aRunner->U[0], (m+2*n)*sizeof(double));
+  ODEBUG("Race won by " << name(LastWinner_));
+  return aRunner->Fail;
+}
+
+
+void
+QPRace::run( unsigned int Index )
+{
+  Runner & aRunner = *Runners_[Index];
+  Problem & aProblem = aRunner.Data;
+  int n = aProblem.n, m = aProblem.m;
+  aRunner.X.resize(n);
+  aRunner.U.resize(m+2*n);
+
+  if( aRunner.Cancel.load() )
+    aRunner.Fail = 4;
+  else if( aRunner.Backend == QLD_BACKEND )
+    {
+      int me = aProblem.me, mmax = aProblem.mmax, nmax = n, mnn = m+2*n;
+      int iout = 0, iprint = 0;
+      int lwar = 3*n*n/2+10*n+2*mmax+20000, liwar = n;
+      double eps = 1e-8;
+      aRunner.war.resize(lwar);
+      aRunner.iwar.resize(liwar);
+      aRunner.iwar[0] = 1;
+      ql0001_(&m, &me, &mmax, &n, &nmax, &mnn,
+              &aProblem.Q[0], &aProblem.D[0], &aProblem.DU[0],
+              &aProblem.DS[0], &aProblem.XL[0], &aProblem.XU[0],
+              &aRunner.X[0], &aRunner.U[0], &iout, &aRunner.Fail, &iprint,
+              &aRunner.war[0], &lwar, &aRunner.iwar[0], &liwar, &eps);
+    }
+  else
+    {
+      if( aRunner.Backend == ACTIVE_SET_COLD )
+        aRunner.Solver.reset();
+      aRunner.Fail = aRunner.Solver.solve(n, m, aProblem.me,
+                                          &aProblem.Q[0], &aProblem.D[0],
+                                          &aProblem.DU[0], aProblem.mmax,
+                                          &aProblem.DS[0],
+                                          &aProblem.XL[0], &aProblem.XU[0],
+                                          &aRunner.X[0], &aRunner.U[0]);
+    }
+
+  {
+    boost::lock_guard<boost::mutex> lock(Mutex_);
+    // A loser of a previous race does not take part in the current one.
+    if( aRunner.Race == Race_ )
+      {
+        if( aRunner.Fail == 0 && Winner_ < 0 )
+          {
+            Winner_ = (int)Index;
+            for( unsigned int i = 0; i < Runners_.size(); i++ )
+              if( Runners_[i]->Race == Race_ )
+                Runners_[i]->Cancel.store(true);
+          }
+        NbDone_++;
+      }
+    aRunner.Busy = false;
+  }
+  Done_.notify_all();
+}
@@ -0,0 +1,204 @@
+/*
+ * Copyright 2019,
+ *
+ * Olivier Stasse
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+/*! \file qp-race.hh
+  \brief Race of several QP solvers on a pool of threads. */
+
+#ifndef _QP_RACE_H_
+#define _QP_RACE_H_
+
+#include <string>
+#include <vector>
+
+#include <boost/atomic.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+
+#include <Mathematics/active-set-qp.hh>
+
+namespace PatternGeneratorJRL
+{
+  class WorkStealingPool;
+
+  /// \brief Solve the same QP with several solvers in parallel and keep
+  /// the first solution found.
+  ///
+  /// The solve time of a solver depends on the problem: the hot start of
+  /// the active-set solver is fast when the active set changes little and
+  /// slow after a change of support, where QLD or a cold start may be
+  /// faster. Racing them on idle cores bounds the latency by the fastest
+  /// one. Each solver runs on its own thread of a persistent pool,
+  /// created by start() or by the first call to solve().
+  ///
+  /// The first solver succeeding wins; the active-set solvers which are
+  /// still running stop at their next iteration, QLD cannot be stopped
+  /// and runs to its end in the background. Each solver works on its
+  /// own copy of the problem: solve() never waits for the losers of the
+  /// previous race, the solvers still busy with it are left out of the
+  /// race.
+  ///
+  /// The problem has the layout of QLD, see ActiveSetQP.
+  class QPRace
+  {
+  public:
+    enum backend_e
+      {
+        /// QLD, which cannot be cancelled
+        QLD_BACKEND,
+        /// ActiveSetQP hot started from the previous problem
+        ACTIVE_SET_HOT,
+        /// ActiveSetQP started from the unconstrained optimum
+        ACTIVE_SET_COLD,
+        NB_OF_BACKENDS
+      };
+
+    /// \brief By default QLD and the hot and cold active-set solvers race.
+    QPRace();
+    ~QPRace();
+
+    /// \brief Create the threads, so that the first race does not
+    /// pay for it. Does nothing if they are running.
+    void start();
+
+    /// \brief Size the copies of the problem for NbVariables variables
+    /// and NbConstraints constraints, so that the races of problems
+    /// up to this size do not allocate memory.
+    void reserve( int NbVariables, int NbConstraints );
+
+    /// \brief Solvers taking part in the race.
+    /// The threads are restarted at the next call to solve().
+    void backends( const std::vector<backend_e> & Backends );
+    inline const std::vector<backend_e> & backends() const
+    { return Backends_; }
+
+    /// \brief Backend of a name: qld, activeset or coldactiveset.
+    /// \return false if the name is unknown.
+    static bool backend( const std::string & Name, backend_e & Backend );
+    static const char * name( backend_e Backend );
+
+    /// \brief Solve the problem, with the arguments of ActiveSetQP::solve().
+    /// XL and XU may be null when there is no bound.
+    ///
+    /// \return 0 on success, or the report of the first solver
+    /// if all of them failed.
+    int solve( int n, int m, int me,
+               const double * Q, const double * D,
+               const double * DU, int ldDU, const double * DS,
+               const double * XL, const double * XU,
+               double * X, double * U );
+
+    /// \brief Provide the factorization of the next Hessian
+    /// to the active-set solvers, see ActiveSetQP::factorization().
+    void factorization( const Eigen::MatrixXd & Q, const Eigen::MatrixXd & J0 );
+
+    /// \name Report
+    /// \{
+    /// \brief Winner of the last race, NB_OF_BACKENDS if all failed.
+    inline backend_e winner() const
+    { return LastWinner_; }
+    /// \brief Number of races won by Backend
+    inline unsigned long int NbOfWins( backend_e Backend ) const
+    { return NbOfWins_[Backend]; }
+    /// \brief Number of races lost by all the solvers
+    inline unsigned long int NbOfFailures() const
+    { return NbOfWins_[NB_OF_BACKENDS]; }
+    /// \brief Number of times a solver was left out of a race
+    /// because it was still busy with a previous one.
+    inline unsigned long int NbOfSkips() const
+    { return NbOfSkips_; }
+    /// \}
+
+  private:
+    /// \brief Problem with the layout of QLD
+    struct Problem
+    {
+      int n, m, me, mmax;
+      std::vector<double> Q, D, DU, DS, XL, XU;
+      void reserve( int NbVariables, int NbConstraints );
+      /// \brief Copy of aProblem in the memory already reserved.
+      void assign( const Problem & aProblem );
+    };
+
+    /// \brief Solver of one thread, its problem and its results.
+    struct Runner
+    {
+      backend_e Backend;
+      ActiveSetQP Solver;
+      Problem Data;
+      std::vector<double> X, U, war;
+      std::vector<int> iwar;
+      int Fail;
+      /// \brief Set by the winner to stop the active-set solver
+      boost::atomic<bool> Cancel;
+      /// \brief Race of the solver, and whether it is still running.
+      /// Protected by Mutex_.
+      unsigned long int Race;
+      bool Busy;
+    };
+
+    /// \brief Task running the solver of Runners_[Index].
+    /// Small enough to be stored in the task without allocation,
+    /// which a boost::bind of run() is not.
+    struct Task
+    {
+      QPRace * Race;
+      unsigned int Index;
+      inline void operator()( unsigned int ) const
+      { Race->run(Index); }
+    };
+
+    /// \brief Run the solver of Runners_[Index] on the current problem.
+    void run( unsigned int Index );
+
+    /// \brief Reserve the memory of a runner.
+    void reserve( Runner & aRunner );
+    /// \brief Wait for the solvers and stop the threads.
+    void stop();
+
+    std::vector<backend_e> Backends_;
+    std::vector<Runner *> Runners_;
+    WorkStealingPool * Pool_;
+
+    /// \brief Problem of the current race, copied by each runner.
+    Problem Problem_;
+    /// \brief Size of the problems given to reserve()
+    int NbVariables_, NbConstraints_;
+    /// \brief Runners of the current race
+    std::vector<unsigned int> Entrants_;
+
+    /// \name State of the current race, protected by Mutex_
+    /// \{
+    unsigned long int Race_;
+    int Winner_;
+    unsigned int NbDone_;
+    /// \}
+    boost::mutex Mutex_;
+    boost::condition_variable Done_;
+
+    backend_e LastWinner_;
+    unsigned long int NbOfWins_[NB_OF_BACKENDS+1];
+    unsigned long int NbOfSkips_;
+  };
+
+}
+#endif /* _QP_RACE_H_ */
@@ -0,0 +1,406 @@
+/*
+ * Copyright 2019,
+ *
+ * Olivier Stasse
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+/*! \file riccati-qp.cpp
+  \brief Interior-point solver for stage-wise linear MPC problems. */
+
+#include <math.h>
+
+#include <algorithm>
+
+#include <Mathematics/riccati-qp.hh>
+
+#include <Debug.hh>
+
+using namespace PatternGeneratorJRL;
+
+namespace
+{
+  /// \brief Fraction of the step to the boundary.
+  const double StepFactor = 0.995;
+}
+
+RiccatiQP::RiccatiQP():
+  N_(0), nx_(0), nu_(0),
+  MaxIterations_(50), NbIterations_(0),
+  Tolerance_(1e-8)
+{
+}
+
+
+void
+RiccatiQP::resize( unsigned int N, unsigned int nx, unsigned int nu )
+{
+  N_ = N; nx_ = nx; nu_ = nu;
+  Stages_.resize(N+1);
+  Work_.resize(N+1);
+  x0_.setZero(nx);
+
+  for(unsigned int k=0;k<=N;k++)
+    {
+      unsigned int lnu = (k<N) ? nu : 0;
+      stage_t & aStage = Stages_[k];
+      aStage.A.setIdentity(nx,nx);
+      aStage.B.setZero(nx,lnu);
+      aStage.b.setZero(nx);
+      aStage.Q.setZero(nx,nx);
+      aStage.S.setZero(nx,lnu);
+      aStage.R.setZero(lnu,lnu);
+      aStage.q.setZero(nx);
+      aStage.r.setZero(lnu);
+      aStage.x.setZero(nx);
+      aStage.u.setZero(lnu);
+
+      work_t & aWork = Work_[k];
+      aWork.pi.setZero((k<N) ? nx : 0);
+      aWork.pinew.setZero((k<N) ? nx : 0);
+      aWork.gx.setZero(nx);
+      aWork.gu.setZero(lnu);
+      aWork.rd.setZero((k<N) ? nx : 0);
+      aWork.P.setZero(nx,nx);
+      aWork.K.setZero(lnu,nx);
+      aWork.p.setZero(nx);
+      aWork.k.setZero(lnu);
+      aWork.dx.setZero(nx);
+      aWork.du.setZero(lnu);
+      NbInequalities(k,0);
+    }
+}
+
+
+void
+RiccatiQP::NbInequalities( unsigned int k, unsigned int nc )
+{
+  stage_t & aStage = Stages_[k];
+  unsigned int lnu = (unsigned int)aStage.u.size();
+  if (aStage.C.rows()==(int)nc &&
+      aStage.C.cols()==(int)nx_ && aStage.D.cols()==(int)lnu)
+    {
+      aStage.C.setZero();
+      aStage.D.setZero();
+      aStage.d.setZero();
+      return;
+    }
+  aStage.C.setZero(nc,nx_);
+  aStage.D.setZero(nc,lnu);
+  aStage.d.setZero(nc);
+  aStage.lambda.setZero(nc);
+
+  work_t & aWork = Work_[k];
+  aWork.s.setZero(nc);
+  aWork.rg.setZero(nc);
+  aWork.rc.setZero(nc);
+  aWork.w.setZero(nc);
+  aWork.v.setZero(nc);
+  aWork.ds.setZero(nc);
+  aWork.dlambda.setZero(nc);
+  aWork.ds_aff.setZero(nc);
+  aWork.dlambda_aff.setZero(nc);
+}
+
+
+double
+RiccatiQP::compute_residuals()
+{
+  double lNorm = 0.0;
+  for(unsigned int k=0;k<=N_;k++)
+    {
+      const stage_t & aStage = Stages_[k];
+      work_t & aWork = Work_[k];
+
+      aWork.gx.noalias() = aStage.Q*aStage.x;
+      aWork.gx.noalias() += aStage.S*aStage.u;
+      aWork.gx += aStage.q;
+      aWork.gx.noalias() -= aStage.C.transpose()*aStage.lambda;
+
+      aWork.rg.noalias() = aStage.C*aStage.x;
+      aWork.rg.noalias() += aStage.D*aStage.u;
+      aWork.rg += aStage.d - aWork.s;
+      if (aWork.rg.size()>0)
+        lNorm = std::max(lNorm,aWork.rg.cwiseAbs().maxCoeff());
+
+      // The initial state is fixed: no stationarity condition.
+      if (k>0)
+        {
+          tmpx_ = aWork.gx - Work_[k-1].pi;
+          if (k<N_)
+            tmpx_.noalias() += aStage.A.transpose()*aWork.pi;
+          lNorm = std::max(lNorm,tmpx_.cwiseAbs().maxCoeff());
+        }
+
+      if (k<N_)
+        {
+          aWork.gu.noalias() = aStage.S.transpose()*aStage.x;
+          aWork.gu.noalias() += aStage.R*aStage.u;
+          aWork.gu += aStage.r;
+          aWork.gu.noalias() -= aStage.D.transpose()*aStage.lambda;
+          hu_ = aWork.gu;
+          hu_.noalias() += aStage.B.transpose()*aWork.pi;
+          if (hu_.size()>0)
+            lNorm = std::max(lNorm,hu_.cwiseAbs().maxCoeff());
+
+          aWork.rd.noalias() = aStage.A*aStage.x;
+          aWork.rd.noalias() += aStage.B*aStage.u;
+          aWork.rd += aStage.b - Stages_[k+1].x;
+          lNorm = std::max(lNorm,aWork.rd.cwiseAbs().maxCoeff());
+        }
+    }
+  return lNorm;
+}
+
+
+bool
+RiccatiQP::factorize()
+{
+  for(unsigned int k=0;k<=N_;k++)
+    {
+      work_t & aWork = Work_[k];
+      aWork.w = Stages_[k].lambda.cwiseQuotient(aWork.s);
+    }
+
+  // Value function of the last stage.
+  {
+    const stage_t & aStage = Stages_[N_];
+    work_t & aWork = Work_[N_];
+    aWork.P = aStage.Q;
+    WC_.noalias() = aWork.w.asDiagonal()*aStage.C;
+    aWork.P.noalias() += aStage.C.transpose().lazyProduct(WC_);
+  }
+
+  for(int k=(int)N_-1;k>=0;k--)
+    {
+      const stage_t & aStage = Stages_[k];
+      work_t & aWork = Work_[k];
+      const Eigen::MatrixXd & P = Work_[k+1].P;
+
+      PA_.noalias() = P.lazyProduct(aStage.A);
+      PB_.noalias() = P.lazyProduct(aStage.B);
+
+      Huu_ = aStage.R;
+      Huu_.noalias() += aStage.B.transpose().lazyProduct(PB_);
+      Hux_ = aStage.S.transpose();
+      Hux_.noalias() += aStage.B.transpose().lazyProduct(PA_);
+      Hxx_ = aStage.Q;
+      Hxx_.noalias() += aStage.A.transpose().lazyProduct(PA_);
+      if (aStage.C.rows()>0)
+        {
+          WC_.noalias() = aWork.w.asDiagonal()*aStage.C;
+          WD_.noalias() = aWork.w.asDiagonal()*aStage.D;
+          Huu_.noalias() += aStage.D.transpose().lazyProduct(WD_);
+          Hux_.noalias() += aStage.D.transpose().lazyProduct(WC_);
+          Hxx_.noalias() += aStage.C.transpose().lazyProduct(WC_);
+        }
+
+      aWork.Huu.compute(Huu_);
+      if (aWork.Huu.info()!=Eigen::Success)
+        {
+          ODEBUG("Riccati recursion failed at stage " << k);
+          return false;
+        }
+      aWork.K = Hux_;
+      aWork.Huu.solveInPlace(aWork.K);
+      aWork.K *= -1.0;
+      aWork.P = Hxx_;
+      aWork.P.noalias() += Hux_.transpose().lazyProduct(aWork.K);
+      aWork.P.triangularView<Eigen::StrictlyLower>() =
+        aWork.P.transpose();
+    }
+  return true;
+}
+
+
+void
+RiccatiQP::solve_newton_step()
+{
+  for(unsigned int k=0;k<=N_;k++)
+    {
+      work_t & aWork = Work_[k];
+      aWork.v = (aWork.rc + Stages_[k].lambda.cwiseProduct(aWork.rg))
+        .cwiseQuotient(aWork.s);
+    }
+
+  // Backward pass on the linear terms.
+  {
+    const stage_t & aStage = Stages_[N_];
+    work_t & aWork = Work_[N_];
+    aWork.p = aWork.gx;
+    aWork.p.noalias() += aStage.C.transpose()*aWork.v;
+  }
+  for(int k=(int)N_-1;k>=0;k--)
+    {
+      const stage_t & aStage = Stages_[k];
+      work_t & aWork = Work_[k];
+      const work_t & aNext = Work_[k+1];
+
+      tmpx_ = aNext.p;
+      tmpx_.noalias() += aNext.P*aWork.rd;
+
+      hu_ = aWork.gu;
+      hu_.noalias() += aStage.D.transpose()*aWork.v;
+      hu_.noalias() += aStage.B.transpose()*tmpx_;
+      aWork.k = -hu_;
+      aWork.Huu.solveInPlace(aWork.k);
+
+      aWork.p = aWork.gx;
+      aWork.p.noalias() += aStage.C.transpose()*aWork.v;
+      aWork.p.noalias() += aStage.A.transpose()*tmpx_;
+      aWork.p.noalias() += aWork.K.transpose()*hu_;
+    }
+
+  // Forward pass.
+  Work_[0].dx.setZero();
+  for(unsigned int k=0;k<=N_;k++)
+    {
+      const stage_t & aStage = Stages_[k];
+      work_t & aWork = Work_[k];
+      if (k<N_)
+        {
+          work_t & aNext = Work_[k+1];
+          aWork.du = aWork.k;
+          aWork.du.noalias() += aWork.K*aWork.dx;
+          aNext.dx = aWork.rd;
+          aNext.dx.noalias() += aStage.A*aWork.dx;
+          aNext.dx.noalias() += aStage.B*aWork.du;
+          aWork.pinew = aNext.p;
+          aWork.pinew.noalias() += aNext.P*aNext.dx;
+        }
+      aWork.ds = aWork.rg;
+      aWork.ds.noalias() += aStage.C*aWork.dx;
+      aWork.ds.noalias() += aStage.D*aWork.du;
+      aWork.dlambda = -(aWork.rc + aStage.lambda.cwiseProduct(aWork.ds))
+        .cwiseQuotient(aWork.s);
+    }
+}
+
+
+void
+RiccatiQP::max_step( double & alphaPrimal, double & alphaDual ) const
+{
+  alphaPrimal = 1.0;
+  alphaDual = 1.0;
+  for(unsigned int k=0;k<=N_;k++)
+    {
+      const work_t & aWork = Work_[k];
+      const Eigen::VectorXd & lambda = Stages_[k].lambda;
+      for(int i=0;i<aWork.s.size();i++)
+        {
+          if (aWork.ds(i)<0.0)
+            alphaPrimal = std::min(alphaPrimal,-aWork.s(i)/aWork.ds(i));
+          if (aWork.dlambda(i)<0.0)
+            alphaDual = std::min(alphaDual,-lambda(i)/aWork.dlambda(i));
+        }
+    }
+}
+
+
+int
+RiccatiQP::solve()
+{
+  NbIterations_ = 0;
+
+  // Initial point: zero input, feasible dynamics,
+  // slacks and multipliers away from the boundary.
+  unsigned int NbIneq = 0;
+  Stages_[0].x = x0_;
+  for(unsigned int k=0;k<=N_;k++)
+    {
+      stage_t & aStage = Stages_[k];
+      work_t & aWork = Work_[k];
+      aStage.u.setZero();
+      if (k<N_)
+        {
+          Stages_[k+1].x = aStage.b;
+          Stages_[k+1].x.noalias() += aStage.A*aStage.x;
+          aWork.pi.setZero();
+        }
+      aWork.s = aStage.C*aStage.x + aStage.d;
+      aWork.s = aWork.s.cwiseMax(1.0);
+      aStage.lambda.setOnes();
+      NbIneq += (unsigned int)aWork.s.size();
+    }
+
+  for(NbIterations_=0;NbIterations_<MaxIterations_;NbIterations_++)
+    {
+      double lResidual = compute_residuals();
+      double mu = 0.0;
+      for(unsigned int k=0;k<=N_;k++)
+        mu += Work_[k].s.dot(Stages_[k].lambda);
+      if (NbIneq>0)
+        mu /= NbIneq;
+      ODEBUG("Iteration " << NbIterations_ << " residual " << lResidual
+             << " mu " << mu);
+      if (lResidual<Tolerance_ && mu<Tolerance_)
+        return 0;
+
+      if (!factorize())
+        return 2;
+
+      // Predictor: affine scaling direction.
+      for(unsigned int k=0;k<=N_;k++)
+        Work_[k].rc = Work_[k].s.cwiseProduct(Stages_[k].lambda);
+      solve_newton_step();
+
+      double alphaPrimal, alphaDual;
+      max_step(alphaPrimal,alphaDual);
+      double alpha = std::min(alphaPrimal,alphaDual);
+
+      // Corrector: centering and second order term.
+      if (NbIneq>0)
+        {
+          double muAff = 0.0;
+          for(unsigned int k=0;k<=N_;k++)
+            {
+              work_t & aWork = Work_[k];
+              muAff += (aWork.s + alpha*aWork.ds).
+                dot(Stages_[k].lambda + alpha*aWork.dlambda);
+            }
+          muAff /= NbIneq;
+          double sigma = pow(muAff/mu,3);
+
+          for(unsigned int k=0;k<=N_;k++)
+            {
+              work_t & aWork = Work_[k];
+              aWork.ds_aff = aWork.ds;
+              aWork.dlambda_aff = aWork.dlambda;
+              aWork.rc += aWork.ds_aff.cwiseProduct(aWork.dlambda_aff);
+              aWork.rc.array() -= sigma*mu;
+            }
+          solve_newton_step();
+          max_step(alphaPrimal,alphaDual);
+          alpha = std::min(1.0,StepFactor*std::min(alphaPrimal,alphaDual));
+        }
+
+      for(unsigned int k=0;k<=N_;k++)
+        {
+          stage_t & aStage = Stages_[k];
+          work_t & aWork = Work_[k];
+          aStage.x += alpha*aWork.dx;
+          aStage.u += alpha*aWork.du;
+          aWork.s += alpha*aWork.ds;
+          aStage.lambda += alpha*aWork.dlambda;
+          if (k<N_)
+            aWork.pi += alpha*(aWork.pinew - aWork.pi);
+        }
+    }
+  return 1;
+}
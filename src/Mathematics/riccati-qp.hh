@@ -0,0 +1,186 @@
+/*
+ * Copyright 2019,
+ *
+ * Olivier Stasse
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+/*! \file riccati-qp.hh
+  \brief Interior-point solver for stage-wise linear MPC problems. */
+
+#ifndef _RICCATI_QP_H_
+#define _RICCATI_QP_H_
+
+#include <vector>
+
+#include <Eigen/Dense>
+
+namespace PatternGeneratorJRL
+{
+
+  /// \brief Primal-dual interior-point solver (Mehrotra predictor-corrector)
+  /// for optimal control problems with linear dynamics.
+  ///
+  /// The problem is
+  /// \f$ \min \sum_{k=0}^{N} \frac{1}{2} x_k^T Q_k x_k + x_k^T S_k u_k
+  ///     + \frac{1}{2} u_k^T R_k u_k + q_k^T x_k + r_k^T u_k \f$
+  /// such that \f$ x_{k+1} = A_k x_k + B_k u_k + b_k \f$,
+  /// \f$ C_k x_k + D_k u_k + d_k \geq 0 \f$ and \f$ x_0 \f$ given.
+  /// The last stage N has no input.
+  ///
+  /// The states are kept as variables: each Newton step is solved by a
+  /// Riccati recursion whose cost is linear in the number of stages,
+  /// instead of the cubic cost of the condensed problem.
+  class RiccatiQP
+  {
+  public:
+    /// \brief Data and solution of one stage.
+    struct stage_t
+    {
+      /// \name Dynamics (unused for the last stage)
+      /// \{
+      Eigen::MatrixXd A, B;
+      Eigen::VectorXd b;
+      /// \}
+
+      /// \name Cost
+      /// \{
+      Eigen::MatrixXd Q, S, R;
+      Eigen::VectorXd q, r;
+      /// \}
+
+      /// \name Inequalities, the number of rows may change between stages
+      /// \{
+      Eigen::MatrixXd C, D;
+      Eigen::VectorXd d;
+      /// \}
+
+      /// \name Solution
+      /// \{
+      Eigen::VectorXd x, u;
+      /// \brief Multipliers of the inequalities
+      Eigen::VectorXd lambda;
+      /// \}
+    };
+
+    RiccatiQP();
+
+    /// \brief Allocate N+1 stages and set all the data to zero
+    /// (identity dynamics, no inequality).
+    ///
+    /// \param[in] N Number of inputs
+    /// \param[in] nx Size of the state
+    /// \param[in] nu Size of the input
+    void resize( unsigned int N, unsigned int nx, unsigned int nu );
+
+    /// \brief Set the number of inequalities of a stage,
+    /// the new rows are set to zero.
+    void NbInequalities( unsigned int k, unsigned int nc );
+
+    inline stage_t & stage( unsigned int k )
+    { return Stages_[k]; }
+    inline const stage_t & stage( unsigned int k ) const
+    { return Stages_[k]; }
+
+    inline Eigen::VectorXd & InitialState()
+    { return x0_; }
+    inline const Eigen::VectorXd & InitialState() const
+    { return x0_; }
+
+    inline unsigned int NbStages() const
+    { return N_; }
+
+    /// \brief Solve the problem.
+    ///
+    /// \return 0 on success, 1 if the maximal number of iterations
+    /// is reached, 2 if a Newton step cannot be computed.
+    int solve();
+
+    /// \name Parameters
+    /// \{
+    inline void MaxIterations( unsigned int MaxIterations )
+    { MaxIterations_ = MaxIterations; }
+    inline void Tolerance( double Tolerance )
+    { Tolerance_ = Tolerance; }
+    /// \}
+
+    /// \brief Number of interior-point iterations of the last call
+    inline unsigned int NbIterations() const
+    { return NbIterations_; }
+
+  private:
+    /// \brief Working data of a stage.
+    struct work_t
+    {
+      /// \brief Slacks of the inequalities
+      Eigen::VectorXd s;
+      /// \brief Multiplier of the dynamics towards the next stage
+      Eigen::VectorXd pi;
+      /// \brief Gradients of the Lagrangian without the dynamics terms
+      Eigen::VectorXd gx, gu;
+      /// \brief Residuals of the dynamics and of the inequalities
+      Eigen::VectorXd rd, rg;
+      /// \brief Complementarity right hand side
+      Eigen::VectorXd rc;
+      /// \brief Weights lambda/s of the barrier, and (rc+lambda rg)/s
+      Eigen::VectorXd w, v;
+
+      /// \name Riccati recursion
+      /// \{
+      Eigen::MatrixXd P, K;
+      Eigen::VectorXd p, k;
+      Eigen::LLT<Eigen::MatrixXd> Huu;
+      /// \}
+
+      /// \name Newton step
+      /// \{
+      Eigen::VectorXd dx, du, ds, dlambda, pinew;
+      Eigen::VectorXd ds_aff, dlambda_aff;
+      /// \}
+    };
+
+    /// \brief Residuals of the KKT conditions, returns their norm.
+    double compute_residuals();
+
+    /// \brief Factorize the Newton system for the current barrier weights.
+    bool factorize();
+
+    /// \brief Backward and forward passes for the current right hand side.
+    void solve_newton_step();
+
+    /// \brief Largest steps keeping the slacks and multipliers positive.
+    void max_step( double & alphaPrimal, double & alphaDual ) const;
+
+    unsigned int N_, nx_, nu_;
+    std::vector<stage_t> Stages_;
+    std::vector<work_t> Work_;
+    Eigen::VectorXd x0_;
+
+    /// \name Temporary arrays
+    /// \{
+    Eigen::MatrixXd Hxx_, Hux_, Huu_, PA_, PB_, WC_, WD_;
+    Eigen::VectorXd hu_, tmpx_;
+    /// \}
+
+    unsigned int MaxIterations_, NbIterations_;
+    double Tolerance_;
+  };
+
+}
+#endif /* _RICCATI_QP_H_ */
@@ -0,0 +1,103 @@
+/*
+ * Copyright 2019,
+ *
+ * Olivier Stasse
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+
+/*! \file MatrixStoragePool.hh
+    \brief Storage of the matrices whose size changes during the walk.
+*/
+#ifndef _HWPG_MATRIX_STORAGE_POOL_H_
+# define _HWPG_MATRIX_STORAGE_POOL_H_
+
+#include <vector>
+
+#include <Eigen/Dense>
+
+namespace PatternGeneratorJRL
+{
+  /*! \brief Keep the storage of the Eigen matrices between two
+    changes of size.
+
+    The size of a dynamic Eigen matrix is its capacity: a matrix
+    allocates each time its number of coefficients changes.
+    In the QP generators the sizes depend on the number of previewed
+    steps, which switches during the walk, and some work matrices are
+    used with several sizes in one cycle.
+
+    Resizing through the pool exchanges the storage of the matrix
+    with a stored block of the new number of coefficients.
+    The previous block is kept in the pool, so that once all the sizes
+    have been met the matrices are resized without allocation.
+    The content of a resized matrix is undefined.
+  */
+  class MatrixStoragePool
+  {
+  public:
+    /*! \param Capacity Number of blocks of each kind stored without
+      growing the pool. */
+    explicit MatrixStoragePool(unsigned int Capacity=32)
+    {
+      m_Matrices.reserve(Capacity);
+      m_Vectors.reserve(Capacity);
+    }
+
+    /*! \brief Resize M to Rows x Cols. */
+    void resize(Eigen::MatrixXd & M, Eigen::Index Rows, Eigen::Index Cols)
+    { exchange(m_Matrices,M,Rows,Cols); }
+
+    /*! \brief Resize V to Size. */
+    void resize(Eigen::VectorXd & V, Eigen::Index Size)
+    { exchange(m_Vectors,V,Size,1); }
+
+  protected:
+    template <typename Matrix>
+    static void exchange(std::vector<Matrix> & Blocks, Matrix & M,
+                         Eigen::Index Rows, Eigen::Index Cols)
+    {
+      if ((M.rows()==Rows) && (M.cols()==Cols))
+        return;
+      if (M.size()!=Rows*Cols)
+      {
+        bool Found = false;
+        for(unsigned int i=0;(i<Blocks.size()) && !Found;i++)
+          if (Blocks[i].size()==Rows*Cols)
+          {
+            Blocks[i].swap(M);
+            Found = true;
+          }
+        // First time this size is met: keep the current block,
+        // M allocates below.
+        if ((!Found) && (M.size()>0))
+        {
+          Blocks.push_back(Matrix());
+          Blocks.back().swap(M);
+        }
+      }
+      M.resize(Rows,Cols);
+    }
+
+    /*! Blocks which are not used by a matrix. */
+    std::vector<Eigen::MatrixXd> m_Matrices;
+    std::vector<Eigen::VectorXd> m_Vectors;
+  };
+}
+#endif /* _HWPG_MATRIX_STORAGE_POOL_H_ */
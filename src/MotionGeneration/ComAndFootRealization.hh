@@ -161,8 +161,8 @@ namespace PatternGeneratorJRL
     /*! This initialization phase, make sure that the needed buffers
       for the upper body motion are correctly setup.
     */
-    virtual    bool InitializationUpperBody(deque<ZMPPosition> &inZMPPositions,
-					    deque<COMPosition> &inCOMBuffer,
+    virtual    bool InitializationUpperBody(RingBuffer<ZMPPosition> &inZMPPositions,
+					    RingBuffer<COMPosition> &inCOMBuffer,
 					    deque<RelativeFootPosition> lRelativeFootPositions)=0;
 
     /* @} */
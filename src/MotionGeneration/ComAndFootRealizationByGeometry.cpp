@@ -500,8 +500,8 @@ InitializationCoM
 
 bool ComAndFootRealizationByGeometry::
 InitializationUpperBody
-(deque<ZMPPosition> &inZMPPositions,
- deque<COMPosition> &inCOMBuffer,
+(RingBuffer<ZMPPosition> &inZMPPositions,
+ RingBuffer<COMPosition> &inCOMBuffer,
  deque<RelativeFootPosition> lRelativeFootPositions)
 {
 
@@ -528,7 +528,7 @@ InitializationUpperBody
   //this function calculates a buffer with COM values after a first preview round,
   // currently required to calculate the arm swing before "onglobal step of control"
   // in order to take the arm swing motion into account in the second preview loop
-  deque<ZMPPosition> aZMPBuffer;
+  RingBuffer<ZMPPosition> aZMPBuffer;
 
   aZMPBuffer.resize(inCOMBuffer.size());
 
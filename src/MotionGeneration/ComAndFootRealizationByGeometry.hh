@@ -145,8 +145,8 @@ namespace PatternGeneratorJRL
     /*! This initialization phase, make sure that the needed buffers
       for the upper body motion are correctly setup.
     */
-    bool InitializationUpperBody(deque<ZMPPosition> &inZMPPositions,
-				 deque<COMPosition> &inCOMBuffer,
+    bool InitializationUpperBody(RingBuffer<ZMPPosition> &inZMPPositions,
+				 RingBuffer<COMPosition> &inCOMBuffer,
 				 deque<RelativeFootPosition> lRelativeFootPositions);
 
     /* @} */
@@ -291,6 +291,12 @@ namespace PatternGeneratorJRL
     inline Eigen::VectorXd & GetPreviousVelocityStage1()
     { return m_prev_Velocity1 ;};
 
+    inline Eigen::VectorXd & GetPreviousConfigurationStage2()
+    { return m_prev_Configuration2 ;};
+
+    inline Eigen::VectorXd & GetPreviousVelocityStage2()
+    { return m_prev_Velocity2 ;};
+
     inline void leftLegIndexinConfiguration(std::vector<int> & leftLegMaps) const
     { leftLegMaps = m_LeftLegIndexinConfiguration ;}
     inline void rightLegIndexinConfiguration(std::vector<int> & rightLegMaps) const
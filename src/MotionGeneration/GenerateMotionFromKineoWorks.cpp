@@ -191,9 +191,9 @@ namespace PatternGeneratorJRL
   }
 
 
-  void GenerateMotionFromKineoWorks::CreateBufferFirstPreview(deque<ZMPPosition> &ZMPRefBuffer)
+  void GenerateMotionFromKineoWorks::CreateBufferFirstPreview(RingBuffer<ZMPPosition> &ZMPRefBuffer)
   {
-    deque<ZMPPosition> aFIFOZMPRefPositions;
+    RingBuffer<ZMPPosition> aFIFOZMPRefPositions;
     Eigen::MatrixXd aPC1x;
     Eigen::MatrixXd aPC1y;
     double aSxzmp, aSyzmp;
@@ -88,7 +88,7 @@ namespace PatternGeneratorJRL
       void CreateUpperBodyMotion();
 	
       /*! Create a trajectory for COM  */
-      void CreateBufferFirstPreview(deque<ZMPPosition> &ZMPRefBuffer);
+      void CreateBufferFirstPreview(RingBuffer<ZMPPosition> &ZMPRefBuffer);
 	
       /*! Update the link towards the Preview Control object in 
 	order to simulate the trajectory. */
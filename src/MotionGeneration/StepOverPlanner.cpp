@@ -618,10 +618,10 @@ void StepOverPlanner::DoubleSupportFeasibility()
     }
 }
 
-void StepOverPlanner::PolyPlanner(deque<COMState> &aCOMBuffer, 
-				  deque<FootAbsolutePosition> & aLeftFootBuffer, 
-				  deque<FootAbsolutePosition> & aRightFootBuffer,
-				  deque<ZMPPosition> & aZMPPositions)
+void StepOverPlanner::PolyPlanner(RingBuffer<COMState> &aCOMBuffer, 
+				  RingBuffer<FootAbsolutePosition> & aLeftFootBuffer, 
+				  RingBuffer<FootAbsolutePosition> & aRightFootBuffer,
+				  RingBuffer<ZMPPosition> & aZMPPositions)
 {
   m_RightFootBuffer = aRightFootBuffer;
   m_LeftFootBuffer = aLeftFootBuffer; 
@@ -750,7 +750,7 @@ void StepOverPlanner::PolyPlanner(deque<COMState> &aCOMBuffer,
 }
 
 
-void StepOverPlanner::PolyPlannerFirstStep(deque<FootAbsolutePosition> &aStepOverFootBuffer)
+void StepOverPlanner::PolyPlannerFirstStep(RingBuffer<FootAbsolutePosition> &aStepOverFootBuffer)
 {
  
   Eigen::Matrix<double,8,1> aBoundCondZ;
@@ -1062,7 +1062,7 @@ void StepOverPlanner::PolyPlannerFirstStep(deque<FootAbsolutePosition> &aStepOve
 
 }
 
-void StepOverPlanner::PolyPlannerSecondStep(deque<FootAbsolutePosition> &aStepOverFootBuffer)
+void StepOverPlanner::PolyPlannerSecondStep(RingBuffer<FootAbsolutePosition> &aStepOverFootBuffer)
 {
  
   Eigen::Matrix<double,8,1> aBoundCondZ;
@@ -1457,9 +1457,9 @@ void StepOverPlanner::PolyPlannerHip()
 }
 
 
-void StepOverPlanner::SetExtraBuffer(deque<COMState> aExtraCOMBuffer,
-				     deque<FootAbsolutePosition> aExtraRightFootBuffer, 
-				     deque<FootAbsolutePosition> aExtraLeftFootBuffer)
+void StepOverPlanner::SetExtraBuffer(RingBuffer<COMState> aExtraCOMBuffer,
+				     RingBuffer<FootAbsolutePosition> aExtraRightFootBuffer, 
+				     RingBuffer<FootAbsolutePosition> aExtraLeftFootBuffer)
 {
   m_ExtraCOMBuffer=aExtraCOMBuffer;
   m_ExtraRightFootBuffer = aExtraRightFootBuffer;
@@ -1468,24 +1468,24 @@ void StepOverPlanner::SetExtraBuffer(deque<COMState> aExtraCOMBuffer,
 
 
 
-void StepOverPlanner::GetExtraBuffer(deque<COMState> &aExtraCOMBuffer,
-				     deque<FootAbsolutePosition> &aExtraRightFootBuffer, 
-				     deque<FootAbsolutePosition> &aExtraLeftFootBuffer)
+void StepOverPlanner::GetExtraBuffer(RingBuffer<COMState> &aExtraCOMBuffer,
+				     RingBuffer<FootAbsolutePosition> &aExtraRightFootBuffer, 
+				     RingBuffer<FootAbsolutePosition> &aExtraLeftFootBuffer)
 {
   aExtraCOMBuffer = m_ExtraCOMBuffer;
   aExtraRightFootBuffer = m_ExtraRightFootBuffer;
   aExtraLeftFootBuffer = m_ExtraLeftFootBuffer;
 }
 
-void StepOverPlanner::SetFootBuffers(deque<FootAbsolutePosition> aLeftFootBuffer, 
-				     deque<FootAbsolutePosition> aRightFootBuffer)
+void StepOverPlanner::SetFootBuffers(RingBuffer<FootAbsolutePosition> aLeftFootBuffer, 
+				     RingBuffer<FootAbsolutePosition> aRightFootBuffer)
 {
   m_RightFootBuffer = aRightFootBuffer;
   m_LeftFootBuffer = aLeftFootBuffer;
 }
 
-void StepOverPlanner::GetFootBuffers(deque<FootAbsolutePosition> & aRightFootBuffer, 
-				     deque<FootAbsolutePosition> & aLeftFootBuffer)
+void StepOverPlanner::GetFootBuffers(RingBuffer<FootAbsolutePosition> & aRightFootBuffer, 
+				     RingBuffer<FootAbsolutePosition> & aLeftFootBuffer)
 {
   aRightFootBuffer = m_RightFootBuffer;
   aLeftFootBuffer = m_LeftFootBuffer;
@@ -1588,11 +1588,11 @@ void StepOverPlanner::SetDeltaStepOverCOMHeightMax(double aDeltaStepOverCOMHeigh
 }
 
 
-void StepOverPlanner::CreateBufferFirstPreview(deque<COMState> &m_COMBuffer,
-					       deque<ZMPPosition> &m_ZMPBuffer, 
-					       deque<ZMPPosition> &m_ZMPRefBuffer)
+void StepOverPlanner::CreateBufferFirstPreview(RingBuffer<COMState> &m_COMBuffer,
+					       RingBuffer<ZMPPosition> &m_ZMPBuffer, 
+					       RingBuffer<ZMPPosition> &m_ZMPRefBuffer)
 {
-  deque<ZMPPosition> aFIFOZMPRefPositions;
+  RingBuffer<ZMPPosition> aFIFOZMPRefPositions;
   Eigen::MatrixXd aPC1x;
   Eigen::MatrixXd aPC1y; 
   double aSxzmp, aSyzmp;
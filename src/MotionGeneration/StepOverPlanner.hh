@@ -40,6 +40,7 @@
 #include <string>
 #include <deque>
 
+#include <RingBuffer.hh>
 /*! MAL */
 
 /*! Abstract Interface for dynamic robot. */
@@ -82,16 +83,16 @@ namespace PatternGeneratorJRL
     void CalculateFootHolds(deque<RelativeFootPosition> &FootHolds);
 	
     /*! \brief Call for polynomial planning of both steps during the obstacle stepover */
-    void PolyPlanner(deque<COMState> &aCOMBuffer, 
-		     deque<FootAbsolutePosition> & aLeftFootBuffer, 
-		     deque<FootAbsolutePosition> & aRightFootBuffer,
-		     deque<ZMPPosition> & aZMPPositions);
+    void PolyPlanner(RingBuffer<COMState> &aCOMBuffer, 
+		     RingBuffer<FootAbsolutePosition> & aLeftFootBuffer, 
+		     RingBuffer<FootAbsolutePosition> & aRightFootBuffer,
+		     RingBuffer<ZMPPosition> & aZMPPositions);
 	
     /*! function which calculates the polynomial coeficients for the first step*/
-    void PolyPlannerFirstStep(deque<FootAbsolutePosition> &aFirstStepOverFootBuffer);
+    void PolyPlannerFirstStep(RingBuffer<FootAbsolutePosition> &aFirstStepOverFootBuffer);
 	
     /*! function which calculates the polynomial coeficients for the first step*/
-    void PolyPlannerSecondStep(deque<FootAbsolutePosition> &aSecondStepOverFootBuffer);
+    void PolyPlannerSecondStep(RingBuffer<FootAbsolutePosition> &aSecondStepOverFootBuffer);
 
     /*! function which calculates the polynomial coeficients for the changing COM height*/
     void PolyPlannerHip();
@@ -99,23 +100,23 @@ namespace PatternGeneratorJRL
 	
 
     /*! this sets the extra COM buffer calculated in the ZMPMultybody class*/
-    void SetExtraBuffer(deque<COMState> aExtraCOMBuffer, 
-			deque<FootAbsolutePosition> aExtraRightFootBuffer, 
-			deque<FootAbsolutePosition> aExtraLeftFootBuffer);
+    void SetExtraBuffer(RingBuffer<COMState> aExtraCOMBuffer, 
+			RingBuffer<FootAbsolutePosition> aExtraRightFootBuffer, 
+			RingBuffer<FootAbsolutePosition> aExtraLeftFootBuffer);
 
     /*! this gets the extra COM buPreviewControlffer calculated in the ZMPMultybody class*/
-    void GetExtraBuffer(deque<COMState> &aExtraCOMBuffer, 
-			deque<FootAbsolutePosition> &aExtraRightFootBuffer, 
-			deque<FootAbsolutePosition> &aExtraLeftFootBuffer);
+    void GetExtraBuffer(RingBuffer<COMState> &aExtraCOMBuffer, 
+			RingBuffer<FootAbsolutePosition> &aExtraRightFootBuffer, 
+			RingBuffer<FootAbsolutePosition> &aExtraLeftFootBuffer);
 
 
     /*! this sets the extra COM buffer calculated in the ZMPMultybody class*/
-    void SetFootBuffers(deque<FootAbsolutePosition> aLeftFootBuffer, 
-			deque<FootAbsolutePosition> aRightFootBuffer);
+    void SetFootBuffers(RingBuffer<FootAbsolutePosition> aLeftFootBuffer, 
+			RingBuffer<FootAbsolutePosition> aRightFootBuffer);
 
     /*! this gets the extra COM buffer calculated in the ZMPMultybody class*/
-    void GetFootBuffers(deque<FootAbsolutePosition> & aLeftFootBuffer, 
-			deque<FootAbsolutePosition> & aRightFootBuffer);
+    void GetFootBuffers(RingBuffer<FootAbsolutePosition> & aLeftFootBuffer, 
+			RingBuffer<FootAbsolutePosition> & aRightFootBuffer);
 
     /*!  Set obstacle information.*/
     void SetObstacleInformation(ObstaclePar ObstacleParameters);
@@ -139,9 +140,9 @@ namespace PatternGeneratorJRL
     void SetDeltaStepOverCOMHeightMax(double aDeltaStepOverCOMHeightMax);
 
     /*!  create the complete COM and ZMP buffer by the first preview round. */
-    void CreateBufferFirstPreview(deque<COMState> &m_COMBuffer,
-				  deque<ZMPPosition> &m_ZMPBuffer, 
-				  deque<ZMPPosition> &m_ZMPRefBuffer);
+    void CreateBufferFirstPreview(RingBuffer<COMState> &m_COMBuffer,
+				  RingBuffer<ZMPPosition> &m_ZMPBuffer, 
+				  RingBuffer<ZMPPosition> &m_ZMPRefBuffer);
 
     /*! Calculates the absolute coordinates (ref frame) 
       of a point on the lower legs given in relative coordinates 
@@ -199,23 +200,23 @@ namespace PatternGeneratorJRL
     StepOverClampedCubicSpline *m_ClampedCubicSplineStepOverFootOmegaImpact;
 	
     /*! Extra COMState buffer calculated in ZMPMultibody class  */
-    deque<COMState> m_ExtraCOMBuffer;
+    RingBuffer<COMState> m_ExtraCOMBuffer;
 	
     /*! Extra foot buffers with the same lenght as extra COM buffer
       and representing the two stpes over the obstacle */
-    deque<FootAbsolutePosition> m_ExtraRightFootBuffer, m_ExtraLeftFootBuffer;
+    RingBuffer<FootAbsolutePosition> m_ExtraRightFootBuffer, m_ExtraLeftFootBuffer;
 	  
 	  
 	  
     /*! Buffers for first preview */
-    deque<COMState> m_COMBuffer;
-    deque<ZMPPosition> m_ZMPBuffer;
+    RingBuffer<COMState> m_COMBuffer;
+    RingBuffer<ZMPPosition> m_ZMPBuffer;
 	
     /*! Buffer of complete foot course to be changed  */
-    deque<FootAbsolutePosition> m_RightFootBuffer, m_LeftFootBuffer;
+    RingBuffer<FootAbsolutePosition> m_RightFootBuffer, m_LeftFootBuffer;
       
     /*! Buffer of complete ZMP course to be changed */
-    deque<ZMPPosition> m_ZMPPositions;
+    RingBuffer<ZMPPosition> m_ZMPPositions;
 
     unsigned int m_StartStepOver;
     unsigned int m_StartDoubleSupp;
@@ -292,19 +293,19 @@ namespace PatternGeneratorJRL
     Eigen::MatrixXd Finalqr;
 		
     /*! Fifo for the ZMP ref.*/
-    deque<ZMPPosition> m_FIFOZMPRefPositions;
+    RingBuffer<ZMPPosition> m_FIFOZMPRefPositions;
 		
     /*! Fifo for the ZMP ref.*/
-    deque<ZMPPosition> m_FIFODeltaZMPPositions;
+    RingBuffer<ZMPPosition> m_FIFODeltaZMPPositions;
 
     /*! Fifo for the COM reference.*/
-    deque<COMState> m_FIFOCOMStates;
+    RingBuffer<COMState> m_FIFOCOMStates;
       
     /*! Fifo for the positionning of the left foot.*/
-    deque<FootAbsolutePosition> m_FIFOLeftFootPosition;
+    RingBuffer<FootAbsolutePosition> m_FIFOLeftFootPosition;
       
     /*! Fifo for the positionning of the right foot.*/
-    deque<FootAbsolutePosition> m_FIFORightFootPosition;
+    RingBuffer<FootAbsolutePosition> m_FIFORightFootPosition;
 
     /*! Error on preview control for the cart model.*/
     double m_sxzmp, m_syzmp;
@@ -324,7 +325,7 @@ namespace PatternGeneratorJRL
     bool m_StartingNewSequence;
 		
     /*! Keep the ZMP reference.*/
-    deque<ZMPPosition> m_FIFOTmpZMPPosition;
+    RingBuffer<ZMPPosition> m_FIFOTmpZMPPosition;
 		
     /*! time distribution at which the specific intermediate points
       for the stepping over splines are to be exerted*/
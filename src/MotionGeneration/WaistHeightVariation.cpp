@@ -50,9 +50,9 @@ WaistHeightVariation::~WaistHeightVariation()
 }
 
 
-void WaistHeightVariation::PolyPlanner(deque<COMPosition> &aCOMBuffer,
+void WaistHeightVariation::PolyPlanner(RingBuffer<COMPosition> &aCOMBuffer,
 				       deque<RelativeFootPosition> &aFootHolds,
-				       deque<ZMPPosition> aZMPPosition)
+				       RingBuffer<ZMPPosition> aZMPPosition)
 {
 	
 
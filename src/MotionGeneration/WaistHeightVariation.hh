@@ -48,6 +48,7 @@
 #include <string>
 #include <deque>
 
+#include <RingBuffer.hh>
 #include <Mathematics/Polynome.hh>
 #include <ZMPRefTrajectoryGeneration/ZMPDiscretization.hh>
 #include <PreviewControl/PreviewControl.hh>
@@ -92,9 +93,9 @@ namespace PatternGeneratorJRL
     ~WaistHeightVariation();
 
     ///call for polynomial planning of both steps during the obstacle stepover
-    void PolyPlanner(deque<COMPosition> &aCOMBuffer,
+    void PolyPlanner(RingBuffer<COMPosition> &aCOMBuffer,
 		     deque<RelativeFootPosition> &aFootHolds,
-		     deque<ZMPPosition> aZMPPosition);
+		     RingBuffer<ZMPPosition> aZMPPosition);
 	
   protected:
 
@@ -113,7 +114,7 @@ namespace PatternGeneratorJRL
 	
 
     /// buffers for first preview
-    deque<COMPosition> m_COMBuffer;
+    RingBuffer<COMPosition> m_COMBuffer;
     unsigned int m_ExtraBufferLength;
     double m_ModulationSupportCoefficient;
     float m_Tsingle,m_TsingleStepOver; 
@@ -32,6 +32,7 @@
 /* \doc This object is the interface to the walking gait
    generation architecture. */
 #include <fstream>
+#include <algorithm>
 #include <time.h>
 #include <fenv.h>
 
@@ -43,6 +44,7 @@
 #endif /* WIN32 */
 
 #include <patterngeneratorinterfaceprivate.hh>
+#include <AllocationMonitor.hh>
 #include <Debug.hh>
 
 namespace PatternGeneratorJRL {
@@ -62,6 +64,7 @@ namespace PatternGeneratorJRL {
     m_ObstacleDetected = false;
     m_AutoFirstStep = false;
     m_feedBackControl = false;
+    m_RealTimeMode = false;
 
     // Initialization of obstacle parameters informations.
     m_ObstaclePars.x=1.0;
@@ -103,6 +106,7 @@ namespace PatternGeneratorJRL {
       m_NL = 0;
     else
       m_NL = (unsigned int)(m_PreviewControlTime/m_SamplingPeriod);
+    PreallocateRealTimeBuffers();
 
     /* For debug purposes. */
     m_Debug_prev_qr.resize(6);
@@ -184,7 +188,7 @@ namespace PatternGeneratorJRL {
 
   void PatternGeneratorInterfacePrivate::RegisterPluginMethods()
   {
-#define number_of_method 18
+#define number_of_method 19
     std::string aMethodName[number_of_method] =
     {":LimitsFeasibility",
      ":ZMPShiftParameters",
@@ -203,11 +207,24 @@ namespace PatternGeneratorJRL {
      ":NaveauOnline",
      ":setVelReference",
      ":setCoMPerturbationForce",
-     ":feedBackControl"};
+     ":feedBackControl",
+     ":realtimemode"};
+
+    // The last methods are also available without parsing.
+    int aMethodId[number_of_method];
+    for(int i=0;i<number_of_method;i++)
+      aMethodId[i] = -1;
+    aMethodId[15] = SET_VEL_REFERENCE;
+    aMethodId[16] = SET_COM_PERTURBATION_FORCE;
+    aMethodId[17] = FEEDBACK_CONTROL;
+    aMethodId[18] = REAL_TIME_MODE;
 
     for(int i=0;i<number_of_method;i++)
     {
-      if (!SimplePlugin::RegisterMethod(aMethodName[i]))
+      bool lRegistered = (aMethodId[i]<0) ?
+        SimplePlugin::RegisterMethod(aMethodName[i]) :
+        SimplePlugin::RegisterMethod(aMethodName[i],aMethodId[i]);
+      if (!lRegistered)
       {
         std::cerr << "Unable to register " << aMethodName << std::endl;
       }
@@ -430,6 +447,9 @@ namespace PatternGeneratorJRL {
     if (m_CoMAndFootOnlyStrategy!=0)
       delete m_CoMAndFootOnlyStrategy;
 
+    for(unsigned int i=0;i<m_Snapshots.size();i++)
+      delete m_Snapshots[i];
+
 
   }
 
@@ -537,22 +557,29 @@ namespace PatternGeneratorJRL {
 	      << strm.str() << std::endl;
 #endif // DEBUG
     // Read the data inside strm.
-#if USE_QUADPROG==1
-    m_ZMPVRQP->Reference(strm);
-    istringstream strm2(strm.str());
-    m_ZMPVRSQP->Reference(strm2);
-#endif
+    double x=0.0,y=0.0,yaw=0.0;
+    strm >> x;
+    strm >> y;
+    strm >> yaw;
+    setVelocityReference(x,y,yaw);
   }
 
   void PatternGeneratorInterfacePrivate::
   setCoMPerturbationForce(istringstream &strm)
   {
     // Read the data inside strm.
-    m_ZMPVRQP->setCoMPerturbationForce(strm);
-    istringstream strm2(strm.str());
-#if USE_QUADPROG==1
-    m_ZMPVRSQP->setCoMPerturbationForce(strm2);
-#endif
+    double x=0.0,y=0.0;
+    strm >> x;
+    strm >> y;
+    setCoMPerturbationForce(x,y);
+  }
+
+  void PatternGeneratorInterfacePrivate::setRealTimeMode(bool aRealTimeMode)
+  {
+    m_RealTimeMode = aRealTimeMode;
+    if (m_RealTimeMode)
+      PreallocateRealTimeBuffers();
+    ODEBUG("realtimemode: " << m_RealTimeMode);
   }
 
 
@@ -596,6 +623,9 @@ namespace PatternGeneratorJRL {
                                    m_LeftFootPositions,
                                    m_RightFootPositions);
 
+    if (m_RealTimeMode)
+      PreallocateRealTimeBuffers();
+
     m_ShouldBeRunning=true;
   }
 
@@ -640,6 +670,9 @@ namespace PatternGeneratorJRL {
                                    m_LeftFootPositions,
                                    m_RightFootPositions);
 
+    if (m_RealTimeMode)
+      PreallocateRealTimeBuffers();
+
     m_ShouldBeRunning=true;
   }
 
@@ -914,6 +947,8 @@ namespace PatternGeneratorJRL {
       }
     }
 
+    if (m_RealTimeMode)
+      PreallocateRealTimeBuffers();
   }
 
 
@@ -1091,7 +1126,7 @@ namespace PatternGeneratorJRL {
     ODEBUG("First m_ZMPPositions"
 	   << m_ZMPPositions[0].px << " "
 	   << m_ZMPPositions[0].py);
-    deque<ZMPPosition> aZMPBuffer;
+    RingBuffer<ZMPPosition> aZMPBuffer;
 
     // Option : Use Wieber06's algorithm to compute a new ZMP
     // profil. Suppose to preempt the first stage of control.
@@ -1196,6 +1231,48 @@ namespace PatternGeneratorJRL {
     ODEBUG6("Fini..","DebugGMFKW.dat");
   }
 
+  CommandHandle PatternGeneratorInterfacePrivate::
+  ResolveCommand(const std::string &aCommandName)
+  {
+    return SimplePluginManager::ResolveCommand(aCommandName);
+  }
+
+  bool PatternGeneratorInterfacePrivate::
+  CallCommand(CommandHandle aHandle,
+	      const CommandArguments &Arguments)
+  {
+    return SimplePluginManager::CallMethod(aHandle,Arguments);
+  }
+
+  bool PatternGeneratorInterfacePrivate::
+  CallTypedMethod(int MethodId,
+		  const CommandArguments &Arguments)
+  {
+    // Missing arguments are taken as zero.
+    double lArgs[3];
+    for(unsigned int i=0;i<3;i++)
+      lArgs[i] = (i<Arguments.size()) ? Arguments[i] : 0.0;
+
+    switch(MethodId)
+    {
+    case SET_VEL_REFERENCE:
+      setVelocityReference(lArgs[0],lArgs[1],lArgs[2]);
+      break;
+    case SET_COM_PERTURBATION_FORCE:
+      setCoMPerturbationForce(lArgs[0],lArgs[1]);
+      break;
+    case FEEDBACK_CONTROL:
+      m_feedBackControl = (lArgs[0]!=0.0);
+      break;
+    case REAL_TIME_MODE:
+      setRealTimeMode(lArgs[0]!=0.0);
+      break;
+    default:
+      return false;
+    }
+    return true;
+  }
+
   int PatternGeneratorInterfacePrivate::ParseCmd(istringstream &strm)
   {
     string aCmd;
@@ -1301,6 +1378,15 @@ namespace PatternGeneratorJRL {
         m_feedBackControl = false;
       ODEBUG("feedBackControl: " << m_feedBackControl);
     }
+    else if(aCmd==":realtimemode")
+    {
+      std::string lRealTimeMode;
+      strm>> lRealTimeMode;
+      if (lRealTimeMode=="true")
+        setRealTimeMode(true);
+      else  if (lRealTimeMode=="false")
+        setRealTimeMode(false);
+    }
     else if (aCmd==":setCoMPerturbationForce")
     {
       setCoMPerturbationForce(strm);
@@ -1407,24 +1493,20 @@ namespace PatternGeneratorJRL {
    ZMPPosition &ZMPRefPos,
    COMPosition &COMRefPos)
   {
-    Eigen::VectorXd  CurrentConfiguration;
-    Eigen::VectorXd  CurrentVelocity;
-    Eigen::VectorXd  CurrentAcceleration;
-    Eigen::VectorXd ZMPTarget;
     COMState aCOMRefState;
 
-    m_Running = RunOneStepOfTheControlLoop(CurrentConfiguration,
-                                           CurrentVelocity,
-                                           CurrentAcceleration,
-                                           ZMPTarget,
+    m_Running = RunOneStepOfTheControlLoop(m_RTConfiguration,
+                                           m_RTVelocity,
+                                           m_RTAcceleration,
+                                           m_RTZMPTarget,
                                            aCOMRefState,
                                            LeftFootPosition,
                                            RightFootPosition);
 
     COMRefPos = aCOMRefState;
     bzero(&ZMPRefPos,sizeof(ZMPPosition));
-    ZMPRefPos.px = ZMPTarget(0);
-    ZMPRefPos.py = ZMPTarget(1);
+    ZMPRefPos.px = m_RTZMPTarget(0);
+    ZMPRefPos.py = m_RTZMPTarget(1);
     return m_Running;
   }
 
@@ -1461,6 +1543,9 @@ namespace PatternGeneratorJRL {
    FootAbsolutePosition &LeftFootPosition,
    FootAbsolutePosition &RightFootPosition )
   {
+    RealTimeSection aRealTimeSection(m_RealTimeMode);
+    ScopedLatency aCycleLatency(&m_LatencyProfile,STAGE_CONTROL_CYCLE);
+
     m_InternalClock+=m_SamplingPeriod;
 
     if ((!m_ShouldBeRunning) ||
@@ -1481,6 +1566,7 @@ namespace PatternGeneratorJRL {
 
     m_Running = true;
 
+    unsigned long long lZMPCoMBegin = m_LatencyProfile.Begin();
     if (m_StepStackHandler->IsOnLineSteppingOn())
     {
       ODEBUG("On Line Stepping: ON!");
@@ -1560,14 +1646,18 @@ namespace PatternGeneratorJRL {
                                    m_RightFootPositions[0]);
     }
 #endif
+    m_LatencyProfile.End(STAGE_ZMP_COM_GENERATION,lZMPCoMBegin);
 
-    m_GlobalStrategyManager->OneGlobalStepOfControl(LeftFootPosition,
-                                                    RightFootPosition,
-                                                    ZMPTarget,
-                                                    finalCOMState,
-                                                    CurrentConfiguration,
-                                                    CurrentVelocity,
-                                                    CurrentAcceleration);
+    {
+      ScopedLatency aIKLatency(&m_LatencyProfile,STAGE_IK);
+      m_GlobalStrategyManager->OneGlobalStepOfControl(LeftFootPosition,
+                                                      RightFootPosition,
+                                                      ZMPTarget,
+                                                      finalCOMState,
+                                                      CurrentConfiguration,
+                                                      CurrentVelocity,
+                                                      CurrentAcceleration);
+    }
 
     ODEBUG("finalCOMState: "  <<
            finalCOMState.x[0] << " " <<
@@ -1623,6 +1713,7 @@ namespace PatternGeneratorJRL {
     if (m_GlobalStrategyManager->EndOfMotion()==
 	GlobalStrategyManager::NEW_STEP_NEEDED)
     {
+      unsigned long long lStepStackBegin = m_LatencyProfile.Begin();
       ODEBUG("NEW STEP NEEDED" << m_InternalClock/m_SamplingPeriod
 	     << " Internal Clock :" << m_InternalClock);
       if (m_StepStackHandler->IsOnLineSteppingOn())
@@ -1749,7 +1840,7 @@ namespace PatternGeneratorJRL {
       }
 
       ODEBUG4("*** TAG *** " , "DebugDataIK.dat");
-
+      m_LatencyProfile.End(STAGE_STEP_STACK,lStepStackBegin);
     }
 
     // Update the absolute position of the robot.
@@ -1851,6 +1942,33 @@ namespace PatternGeneratorJRL {
     }
   }
 
+  void PatternGeneratorInterfacePrivate::PreallocateRealTimeBuffers()
+  {
+    // The strategies write directly in the vectors given to
+    // RunOneStepOfTheControlLoop: they have to be sized
+    // to the robot model beforehand.
+    Eigen::Index lNq = m_PinocchioRobot->currentConfiguration().size();
+    Eigen::Index lNv = m_PinocchioRobot->currentVelocity().size();
+
+    if (m_RTConfiguration.size()!=lNq)
+      m_RTConfiguration.setZero(lNq);
+    if (m_RTVelocity.size()!=lNv)
+      m_RTVelocity.setZero(lNv);
+    if (m_RTAcceleration.size()!=lNv)
+      m_RTAcceleration.setZero(lNv);
+    if (m_RTZMPTarget.size()!=3)
+      m_RTZMPTarget.setZero(3);
+
+    // The buffers hold at most the preview window plus the samples
+    // added by one call to OnLine. Once reserved they slide
+    // without any allocation.
+    unsigned int lBufferSize = 4*(m_NL+1);
+    m_ZMPPositions.reserve(lBufferSize);
+    m_COMBuffer.reserve(lBufferSize);
+    m_LeftFootPositions.reserve(lBufferSize);
+    m_RightFootPositions.reserve(lBufferSize);
+  }
+
   void PatternGeneratorInterfacePrivate::ExpandCOMPositionsQueues(int aNumber)
   {
     COMState aCOMPos;
@@ -2062,6 +2180,261 @@ namespace PatternGeneratorJRL {
 #endif
   }
 
+  PatternGeneratorInterfacePrivate::Snapshot_t::Snapshot_t():
+    Used(false),
+    AlgorithmforZMPCOM(0),
+    Generator(0),
+    GeneratorState(0)
+  {
+  }
+
+  PatternGeneratorInterfacePrivate::Snapshot_t::~Snapshot_t()
+  {
+    if (GeneratorState!=0)
+      delete GeneratorState;
+  }
+
+  ZMPRefTrajectoryGeneration * PatternGeneratorInterfacePrivate::
+  ActiveZMPRefTrajectoryGeneration()
+  {
+    if (m_AlgorithmforZMPCOM==ZMPCOM_HERDT_2010)
+      return m_ZMPVRQP;
+#if USE_QUADPROG
+    if (m_AlgorithmforZMPCOM==ZMPCOM_NAVEAU_2015)
+      return m_ZMPVRSQP;
+#endif
+    return 0;
+  }
+
+  SnapshotHandle PatternGeneratorInterfacePrivate::Snapshot()
+  {
+    ZMPRefTrajectoryGeneration * aGenerator =
+      ActiveZMPRefTrajectoryGeneration();
+    if (aGenerator==0)
+      return -1;
+
+    // Reuse a released slot if any.
+    SnapshotHandle aHandle=-1;
+    for(unsigned int i=0;i<m_Snapshots.size();i++)
+      if (!m_Snapshots[i]->Used)
+      {
+        aHandle = i;
+        break;
+      }
+    if (aHandle<0)
+    {
+      aHandle = (SnapshotHandle)m_Snapshots.size();
+      m_Snapshots.push_back(new Snapshot_t());
+    }
+    Snapshot_t & aSnapshot = *m_Snapshots[aHandle];
+
+    if (aSnapshot.Generator!=aGenerator)
+    {
+      if (aSnapshot.GeneratorState!=0)
+        delete aSnapshot.GeneratorState;
+      aSnapshot.GeneratorState = aGenerator->CreateState();
+      aSnapshot.Generator = aGenerator;
+    }
+    if ((aSnapshot.GeneratorState==0) ||
+        (!aGenerator->SaveState(*aSnapshot.GeneratorState)))
+    {
+      ODEBUG("The generator state can not be captured.");
+      return -1;
+    }
+
+    aSnapshot.AlgorithmforZMPCOM = m_AlgorithmforZMPCOM;
+
+    aSnapshot.ZMPPositions = m_ZMPPositions;
+    aSnapshot.FootAbsolutePositions = m_FootAbsolutePositions;
+    aSnapshot.LeftFootPositions = m_LeftFootPositions;
+    aSnapshot.RightFootPositions = m_RightFootPositions;
+    aSnapshot.COMBuffer = m_COMBuffer;
+
+    aSnapshot.InternalClock = m_InternalClock;
+    aSnapshot.count = m_count;
+    aSnapshot.ShouldBeRunning = m_ShouldBeRunning;
+    aSnapshot.Running = m_Running;
+    aSnapshot.NewStep = m_NewStep;
+    aSnapshot.NewStepX = m_NewStepX;
+    aSnapshot.NewStepY = m_NewStepY;
+    aSnapshot.NewStepZ = m_NewStepZ;
+    aSnapshot.NewTheta = m_NewTheta;
+
+    aSnapshot.AbsTheta = m_AbsTheta;
+    aSnapshot.AbsMotionTheta = m_AbsMotionTheta;
+    aSnapshot.MotionAbsPos = m_MotionAbsPos;
+    aSnapshot.MotionAbsOrientation = m_MotionAbsOrientation;
+    aSnapshot.WaistAbsPos = m_WaistAbsPos;
+    aSnapshot.WaistRelativePos = m_WaistRelativePos;
+    aSnapshot.AbsLinearVelocity = m_AbsLinearVelocity;
+    aSnapshot.AbsAngularVelocity = m_AbsAngularVelocity;
+    aSnapshot.AbsLinearAcc = m_AbsLinearAcc;
+    aSnapshot.KeepLastCorrectSupportFoot = m_KeepLastCorrectSupportFoot;
+    aSnapshot.CurrentWaistState = m_CurrentWaistState;
+    aSnapshot.CurrentActuatedJointValues = m_CurrentActuatedJointValues;
+    aSnapshot.ZMPInitialPoint = m_ZMPInitialPoint;
+    aSnapshot.ZMPInitialPointSet = m_ZMPInitialPointSet;
+
+    m_StepStackHandler->GetState(aSnapshot.StepStack);
+    aSnapshot.NbOfHitBottom = m_CoMAndFootOnlyStrategy->GetNbOfHitBottom();
+
+    aSnapshot.Used = true;
+    return aHandle;
+  }
+
+  bool PatternGeneratorInterfacePrivate::Restore(SnapshotHandle aHandle)
+  {
+    if ((aHandle<0) || (aHandle>=(SnapshotHandle)m_Snapshots.size()) ||
+        (!m_Snapshots[aHandle]->Used))
+      return false;
+
+    const Snapshot_t & aSnapshot = *m_Snapshots[aHandle];
+    if ((aSnapshot.AlgorithmforZMPCOM!=m_AlgorithmforZMPCOM) ||
+        (aSnapshot.Generator!=ActiveZMPRefTrajectoryGeneration()))
+      return false;
+
+    aSnapshot.Generator->RestoreState(*aSnapshot.GeneratorState);
+
+    m_ZMPPositions = aSnapshot.ZMPPositions;
+    m_FootAbsolutePositions = aSnapshot.FootAbsolutePositions;
+    m_LeftFootPositions = aSnapshot.LeftFootPositions;
+    m_RightFootPositions = aSnapshot.RightFootPositions;
+    m_COMBuffer = aSnapshot.COMBuffer;
+
+    m_InternalClock = aSnapshot.InternalClock;
+    m_count = aSnapshot.count;
+    m_ShouldBeRunning = aSnapshot.ShouldBeRunning;
+    m_Running = aSnapshot.Running;
+    m_NewStep = aSnapshot.NewStep;
+    m_NewStepX = aSnapshot.NewStepX;
+    m_NewStepY = aSnapshot.NewStepY;
+    m_NewStepZ = aSnapshot.NewStepZ;
+    m_NewTheta = aSnapshot.NewTheta;
+
+    m_AbsTheta = aSnapshot.AbsTheta;
+    m_AbsMotionTheta = aSnapshot.AbsMotionTheta;
+    m_MotionAbsPos = aSnapshot.MotionAbsPos;
+    m_MotionAbsOrientation = aSnapshot.MotionAbsOrientation;
+    m_WaistAbsPos = aSnapshot.WaistAbsPos;
+    m_WaistRelativePos = aSnapshot.WaistRelativePos;
+    m_AbsLinearVelocity = aSnapshot.AbsLinearVelocity;
+    m_AbsAngularVelocity = aSnapshot.AbsAngularVelocity;
+    m_AbsLinearAcc = aSnapshot.AbsLinearAcc;
+    m_KeepLastCorrectSupportFoot = aSnapshot.KeepLastCorrectSupportFoot;
+    m_CurrentWaistState = aSnapshot.CurrentWaistState;
+    m_CurrentActuatedJointValues = aSnapshot.CurrentActuatedJointValues;
+    m_ZMPInitialPoint = aSnapshot.ZMPInitialPoint;
+    m_ZMPInitialPointSet = aSnapshot.ZMPInitialPointSet;
+
+    m_StepStackHandler->SetState(aSnapshot.StepStack);
+    m_CoMAndFootOnlyStrategy->SetNbOfHitBottom(aSnapshot.NbOfHitBottom);
+
+    return true;
+  }
+
+  void PatternGeneratorInterfacePrivate::
+  ReleaseSnapshot(SnapshotHandle aHandle)
+  {
+    if ((aHandle>=0) && (aHandle<(SnapshotHandle)m_Snapshots.size()))
+      m_Snapshots[aHandle]->Used = false;
+  }
+
+  /*! Copy the first rows of a foot trajectory into the channels. */
+  static void FillFootChannels(const RingBuffer<FootAbsolutePosition> & aBuffer,
+                               unsigned int NbOfSamples,
+                               TrajectoryWindow::Channels & aChannels)
+  {
+    for(unsigned int i=0;i<NbOfSamples;i++)
+    {
+      const FootAbsolutePosition & aFAP = aBuffer[i];
+      aChannels(i,TrajectoryWindow::X) = aFAP.x;
+      aChannels(i,TrajectoryWindow::DX) = aFAP.dx;
+      aChannels(i,TrajectoryWindow::DDX) = aFAP.ddx;
+      aChannels(i,TrajectoryWindow::Y) = aFAP.y;
+      aChannels(i,TrajectoryWindow::DY) = aFAP.dy;
+      aChannels(i,TrajectoryWindow::DDY) = aFAP.ddy;
+      aChannels(i,TrajectoryWindow::Z) = aFAP.z;
+      aChannels(i,TrajectoryWindow::DZ) = aFAP.dz;
+      aChannels(i,TrajectoryWindow::DDZ) = aFAP.ddz;
+      aChannels(i,TrajectoryWindow::YAW) = aFAP.theta;
+      aChannels(i,TrajectoryWindow::DYAW) = aFAP.dtheta;
+      aChannels(i,TrajectoryWindow::DDYAW) = aFAP.ddtheta;
+    }
+  }
+
+  unsigned int PatternGeneratorInterfacePrivate::
+  GetTrajectoryWindow(unsigned int NbOfSamples,
+                      TrajectoryWindow & aWindow) const
+  {
+    unsigned int lNbOfSamples = NbOfSamples;
+    lNbOfSamples = std::min(lNbOfSamples,(unsigned int)m_ZMPPositions.size());
+    lNbOfSamples = std::min(lNbOfSamples,(unsigned int)m_COMBuffer.size());
+    lNbOfSamples = std::min(lNbOfSamples,
+                            (unsigned int)m_LeftFootPositions.size());
+    lNbOfSamples = std::min(lNbOfSamples,
+                            (unsigned int)m_RightFootPositions.size());
+
+    // No allocation when the size does not change.
+    aWindow.Time.resize(lNbOfSamples);
+    aWindow.ZMP.resize(lNbOfSamples,TrajectoryWindow::NB_OF_ZMP_CHANNELS);
+    aWindow.CoM.resize(lNbOfSamples,TrajectoryWindow::NB_OF_CHANNELS);
+    aWindow.LeftFoot.resize(lNbOfSamples,TrajectoryWindow::NB_OF_CHANNELS);
+    aWindow.RightFoot.resize(lNbOfSamples,TrajectoryWindow::NB_OF_CHANNELS);
+
+    for(unsigned int i=0;i<lNbOfSamples;i++)
+    {
+      aWindow.Time(i) = m_LeftFootPositions[i].time;
+
+      const ZMPPosition & aZMP = m_ZMPPositions[i];
+      aWindow.ZMP(i,TrajectoryWindow::ZMP_X) = aZMP.px;
+      aWindow.ZMP(i,TrajectoryWindow::ZMP_Y) = aZMP.py;
+      aWindow.ZMP(i,TrajectoryWindow::ZMP_Z) = aZMP.pz;
+
+      const COMState & aCOM = m_COMBuffer[i];
+      for(unsigned int j=0;j<3;j++)
+      {
+        aWindow.CoM(i,TrajectoryWindow::X+j) = aCOM.x[j];
+        aWindow.CoM(i,TrajectoryWindow::Y+j) = aCOM.y[j];
+        aWindow.CoM(i,TrajectoryWindow::Z+j) = aCOM.z[j];
+        aWindow.CoM(i,TrajectoryWindow::YAW+j) = aCOM.yaw[j];
+      }
+    }
+    FillFootChannels(m_LeftFootPositions,lNbOfSamples,aWindow.LeftFoot);
+    FillFootChannels(m_RightFootPositions,lNbOfSamples,aWindow.RightFoot);
+
+    return lNbOfSamples;
+  }
+
+  void PatternGeneratorInterfacePrivate::
+  GetStageLatency(ControlCycleStage aStage,
+                  StageLatency & aLatency) const
+  {
+    m_LatencyProfile.Stage(aStage).Statistics(aLatency);
+  }
+
+  void PatternGeneratorInterfacePrivate::ResetStageLatencies()
+  {
+    m_LatencyProfile.Reset();
+  }
+
+  bool PatternGeneratorInterfacePrivate::
+  GetPlannerStatistics(PlannerStatistics & aStatistics) const
+  {
+    if (m_AlgorithmforZMPCOM!=ZMPCOM_NAVEAU_2015)
+      return false;
+    m_ZMPVRSQP->GetPlannerStatistics(aStatistics);
+    return true;
+  }
+
+  bool PatternGeneratorInterfacePrivate::
+  GetSQPSolveStatus(SQPSolveStatus & aStatus) const
+  {
+    if (m_AlgorithmforZMPCOM!=ZMPCOM_NAVEAU_2015)
+      return false;
+    m_ZMPVRSQP->GetSQPSolveStatus(aStatus);
+    return true;
+  }
+
   int PatternGeneratorInterfacePrivate::
   ChangeOnLineStep
   (double time,
@@ -142,7 +142,7 @@ COMState LinearizedInvertedPendulum2D::GetState()
   return aCoM ;
 }
 
-void LinearizedInvertedPendulum2D::setState(com_t aCoM)
+void LinearizedInvertedPendulum2D::setState(const com_t & aCoM)
 {
   m_CoM = aCoM ;
 }
@@ -181,8 +181,8 @@ int LinearizedInvertedPendulum2D::InitializeSystem()
 
 
 
-int LinearizedInvertedPendulum2D::Interpolation(deque<COMState> &COMStates,
-						deque<ZMPPosition> &ZMPRefPositions,
+int LinearizedInvertedPendulum2D::Interpolation(RingBuffer<COMState> &COMStates,
+						RingBuffer<ZMPPosition> &ZMPRefPositions,
 						int CurrentPosition,
 						double CX, double CY)
 {
@@ -256,10 +256,10 @@ int LinearizedInvertedPendulum2D::Interpolation(deque<COMState> &COMStates,
 }
 
 
-com_t LinearizedInvertedPendulum2D::OneIteration(double ux, double uy)
+const com_t & LinearizedInvertedPendulum2D::OneIteration(double ux, double uy)
 {
-  Eigen::VectorXd Bux(3);
-  Eigen::VectorXd Buy(3);
+  Eigen::Vector3d Bux;
+  Eigen::Vector3d Buy;
 
   Bux[0] = ux*m_B(0,0);
   Bux[1] = ux*m_B(1,0);
@@ -270,10 +270,10 @@ com_t LinearizedInvertedPendulum2D::OneIteration(double ux, double uy)
   Buy[2] = uy*m_B(2,0);
 
   // Simulate the dynamical system
-  m_CoM.x = m_A*m_CoM.x;
-  m_CoM.x = m_CoM.x + Bux;
-  m_CoM.y = m_A*m_CoM.y;
-  m_CoM.y = m_CoM.y + Buy;
+  m_NextState.noalias() = m_A*m_CoM.x;
+  m_CoM.x = m_NextState + Bux;
+  m_NextState.noalias() = m_A*m_CoM.y;
+  m_CoM.y = m_NextState + Buy;
 
   // Modif. from Dimitar: Initially a mistake regarding the ordering.
   ODEBUG4( m_xk[0] << " " << m_xk[1] << " " << m_xk[2] << " " <<
@@ -34,6 +34,7 @@
 /*! STL includes */
 #include <deque>
 
+#include <RingBuffer.hh>
 /*! Framework includes */
 
 #include <jrl/walkgen/pgtypes.hh>
@@ -66,8 +67,8 @@ namespace PatternGeneratorJRL
       \param[in]: CX: command parameter in the forward direction.
       \param[in]: CY: command parameter in the perpendicular direction.
     */
-    int Interpolation(std::deque<COMState> &COMStates,
-		      std::deque<ZMPPosition> &ZMPRefPositions,
+    int Interpolation(RingBuffer<COMState> &COMStates,
+		      RingBuffer<ZMPPosition> &ZMPRefPositions,
 		      int CurrentPosition,
 		      double CX, double CY);
 
@@ -77,7 +78,7 @@ namespace PatternGeneratorJRL
       \param[in] CY: control value in the left-right direction.
       \return 0 if the object has been properly initialized -1, otherwise.
     */
-    com_t OneIteration(double CX, double CY);
+    const com_t & OneIteration(double CX, double CY);
 
   private:
 
@@ -113,6 +114,10 @@ namespace PatternGeneratorJRL
 
     com_t m_CoM;
 
+    /* ! \brief Product of m_A by the state, kept to simulate the
+       system without allocation. */
+    Eigen::Vector3d m_NextState;
+
     /* ! \brief Vector of ZMP  */
     Eigen::VectorXd m_zk;
 
@@ -142,22 +147,22 @@ namespace PatternGeneratorJRL
     void SetRobotControlPeriod(const double &);
 
     /// \brief Accessor
-    inline const com_t operator ()() const
+    inline const com_t & operator ()() const
     {return m_CoM;};
 
     /// \brief Accessor
-    inline void operator ()( com_t CoM )
+    inline void operator ()( const com_t & CoM )
     {m_CoM = CoM;};
 
     /*! Get state. */
     void GetState(Eigen::VectorXd &lxk);
     COMState GetState();
 
-    inline com_t getState()
+    inline const com_t & getState() const
     {return m_CoM ;}
 
     /*! Set state. */
-    void setState(com_t aCoM);
+    void setState(const com_t & aCoM);
     void setState(COMState &aCoM);
     /*! @} */
 
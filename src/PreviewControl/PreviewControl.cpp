@@ -34,6 +34,7 @@
 #include <iomanip> // !!!!!! manip pour debug a jareter !!!!!!!!!
 
 #include <PreviewControl/PreviewControl.hh>
+#include <PreviewControl/PreviewGainsCache.hh>
 
 using namespace::PatternGeneratorJRL;
 
@@ -58,14 +59,18 @@ PreviewControl::PreviewControl(SimplePluginManager *lSPM,
   m_Kx.resize(1,3);
   m_Ks = 0;
 
+  m_ScheduledZcMin = m_ScheduledZcStep = 0.0;
+  m_ScheduledSamplingPeriod = m_ScheduledPreviewControlTime = 0.0;
+
 
   ODEBUG("Identification: " << this);
-  std::string aMethodName[3] =
+  std::string aMethodName[4] =
     {":samplingperiod",
      ":previewcontroltime",
-     ":comheight"};
+     ":comheight",
+     ":previewgainscheduling"};
 
-  for(int i=0;i<3;i++)
+  for(int i=0;i<4;i++)
     {
       if (!RegisterMethod(aMethodName[i]))
 	{
@@ -134,11 +139,94 @@ void PreviewControl::SetHeightOfCoM(double lHeightOfCom)
 
   m_Zc = lHeightOfCom;
 
+  if (InterpolateGains())
+    return;
+
   if (m_AutoComputeWeights)
     ComputeOptimalWeights(m_DefaultWeightComputationMode);
 
 }
 
+bool PreviewControl::ScheduleGains(double ZcMin, double ZcMax,
+				   unsigned int NbOfHeights,
+				   unsigned int mode)
+{
+  StopGainScheduling();
+
+  if ((m_SamplingPeriod==0.0) || (m_PreviewControlTime==0.0) ||
+      (NbOfHeights<2) || (ZcMax<=ZcMin))
+    return false;
+
+  double lZc = m_Zc;
+  Eigen::MatrixXd lScheduledF;
+  Eigen::Matrix<double,4,Eigen::Dynamic> lScheduledK(4,NbOfHeights);
+  double lStep = (ZcMax-ZcMin)/(NbOfHeights-1);
+  for(unsigned int i=0;i<NbOfHeights;i++)
+    {
+      m_Zc = ZcMin + i*lStep;
+      ComputeOptimalWeights(mode);
+      if (i==0)
+	lScheduledF.resize(m_F.rows(),NbOfHeights);
+      lScheduledF.col(i) = m_F.col(0);
+      lScheduledK(0,i) = m_Ks;
+      for(unsigned int j=0;j<3;j++)
+	lScheduledK(j+1,i) = m_Kx(0,j);
+    }
+  ODEBUG("Gains scheduled on " << NbOfHeights << " heights in ["
+	 << ZcMin << "," << ZcMax << "]");
+
+  m_ScheduledZcMin = ZcMin;
+  m_ScheduledZcStep = lStep;
+  m_ScheduledSamplingPeriod = m_SamplingPeriod;
+  m_ScheduledPreviewControlTime = m_PreviewControlTime;
+  m_ScheduledF.swap(lScheduledF);
+  m_ScheduledK.swap(lScheduledK);
+
+  // Back to the gains of the current height.
+  m_Zc = lZc;
+  if (!InterpolateGains())
+    ComputeOptimalWeights(mode);
+  return true;
+}
+
+void PreviewControl::StopGainScheduling()
+{
+  m_ScheduledF.resize(0,0);
+  m_ScheduledK.resize(4,0);
+}
+
+bool PreviewControl::InterpolateGains()
+{
+  if (!IsGainScheduled() ||
+      (m_SamplingPeriod!=m_ScheduledSamplingPeriod) ||
+      (m_PreviewControlTime!=m_ScheduledPreviewControlTime))
+    return false;
+
+  unsigned int lLast = (unsigned int)m_ScheduledF.cols()-1;
+  double s = (m_Zc-m_ScheduledZcMin)/m_ScheduledZcStep;
+  // Tolerance for the heights of the grid.
+  if ((s<-1e-9) || (s>lLast+1e-9))
+    return false;
+
+  unsigned int i = s<=0.0 ? 0 : (unsigned int)s;
+  if (i>=lLast)
+    i = lLast-1;
+  double a = s-i;
+
+  m_F.noalias() = (1.0-a)*m_ScheduledF.col(i) + a*m_ScheduledF.col(i+1);
+  Eigen::Vector4d lK = (1.0-a)*m_ScheduledK.col(i) + a*m_ScheduledK.col(i+1);
+  m_Ks = lK(0);
+  for(unsigned int j=0;j<3;j++)
+    m_Kx(0,j) = lK(j+1);
+
+  // Only C depends on the height of the CoM.
+  m_C(0,2) = -m_Zc/9.81;
+
+  m_SizeOfPreviewWindow = (unsigned int)m_F.rows();
+  m_Coherent = true;
+  return true;
+}
+
 bool PreviewControl::IsCoherent()
 {
   return m_Coherent;
@@ -204,6 +292,8 @@ void PreviewControl::ComputeOptimalWeights(unsigned int mode)
 {
   /*! \brief Solver to compute optimal weights */
   OptimalControllerSolver *anOCS;
+  /*! \brief Gains already computed for the same parameters. */
+  PreviewGainsCache & aGainsCache = PreviewGainsCache::Instance();
 
   double T = m_SamplingPeriod;
   m_A(0,0) = 1.0; m_A(0,1) =   T; m_A(0,2) = T*T/2.0;
@@ -271,41 +361,50 @@ void PreviewControl::ComputeOptimalWeights(unsigned int mode)
       ODEBUG("cx:" << cx);
       ODEBUG("Q:" << Q);
       ODEBUG("R:" << R);
-      anOCS = new PatternGeneratorJRL::
-	OptimalControllerSolver(Ax,bx,cx,Q,R,Nl);
+      PreviewGainsKey aKey(T,m_Zc,Q,R,Nl,mode);
+      if (!aGainsCache.Find(aKey,lK,m_F))
+	{
+	  anOCS = new PatternGeneratorJRL::
+	    OptimalControllerSolver(Ax,bx,cx,Q,R,Nl);
+
+	  anOCS->ComputeWeights(OptimalControllerSolver::MODE_WITHOUT_INITIALPOS);
 
-      anOCS->ComputeWeights(OptimalControllerSolver::MODE_WITHOUT_INITIALPOS);
+	  anOCS->GetF(m_F);
 
-      anOCS->GetF(m_F);
+	  anOCS->GetK(lK);
 
-      anOCS->GetK(lK);
+	  delete anOCS;
+	  aGainsCache.Insert(aKey,lK,m_F);
+	}
 
       m_Ks = lK(0,0);
       for (int i=0;i<3;i++)
         m_Kx(0,i) = lK(0,i+1);
-
-      delete anOCS;
     }
   else if (mode==OptimalControllerSolver::MODE_WITH_INITIALPOS )
     {
       Q = 1.0;
       R = 1e-5;
       ODEBUG("COMPUTATION WITH INITIALPOS !");
-      anOCS = new PatternGeneratorJRL::OptimalControllerSolver(m_A,m_B,m_C,Q,R,Nl);
+      PreviewGainsKey aKey(T,m_Zc,Q,R,Nl,mode);
+      if (!aGainsCache.Find(aKey,lK,m_F))
+	{
+	  anOCS = new PatternGeneratorJRL::OptimalControllerSolver(m_A,m_B,m_C,Q,R,Nl);
 
-      anOCS->ComputeWeights(PatternGeneratorJRL::OptimalControllerSolver::MODE_WITH_INITIALPOS);
+	  anOCS->ComputeWeights(PatternGeneratorJRL::OptimalControllerSolver::MODE_WITH_INITIALPOS);
 
-      anOCS->GetF(m_F);
+	  anOCS->GetF(m_F);
 
-      anOCS->GetK(lK);
+	  anOCS->GetK(lK);
+
+	  delete anOCS;
+	  aGainsCache.Insert(aKey,lK,m_F);
+	}
 
       m_Ks = lK(0,0);
 
       for (int i=0;i<3;i++)
         m_Kx(0,i) = lK(0,i);
-
-
-      delete anOCS;
     }
 
   ODEBUG("Nl:" << Nl);
@@ -327,56 +426,153 @@ void PreviewControl::ComputeOptimalWeights(unsigned int mode)
   m_Coherent = true;
 }
 
+void PreviewControl::
+FillPreviewWindow
+(const PatternGeneratorJRL::RingBuffer<ZMPPosition> & ZMPPositions,
+ unsigned long int lindex,
+ unsigned long int Size,
+ PreviewWindow & ZMPWindow)
+{
+  if (ZMPPositions.size()<lindex+Size)
+    {
+      LTHROW("ZMPPositions.size()<lindex+Size:" );
+    }
+
+  if ((unsigned long int)ZMPWindow.rows()!=Size)
+    ZMPWindow.resize(Size,2);
+
+  for(unsigned long int i=0;i<Size;i++)
+    {
+      const ZMPPosition & aZMP = ZMPPositions[lindex+i];
+      ZMPWindow(i,0) = aZMP.px;
+      ZMPWindow(i,1) = aZMP.py;
+    }
+}
+
+void PreviewControl::
+OneStepOfPreview
+(Eigen::Matrix<double,3,2> & X,
+ Eigen::Matrix<double,1,2> & S,
+ const PreviewWindow & ZMPWindow,
+ unsigned long int lindex,
+ Eigen::Matrix<double,1,2> & ZMP,
+ bool Simulation)
+{
+  // Commands along x and y.
+  Eigen::Matrix<double,1,2> U;
+  U.noalias() = m_F.col(0).transpose() *
+    ZMPWindow.middleRows(lindex,m_SizeOfPreviewWindow);
+  U.noalias() -= m_Kx.leftCols<3>() * X;
+  U += m_Ks * S;
+
+  Eigen::Matrix<double,3,2> lX;
+  lX.noalias() = m_A.topLeftCorner<3,3>() * X;
+  lX.noalias() += m_B.topRows<3>() * U;
+  X = lX;
+
+  ZMP.noalias() = m_C.leftCols<3>() * X;
+
+  if (Simulation)
+    S += ZMPWindow.row(lindex) - ZMP;
+}
+
 int PreviewControl::
 OneIterationOfPreview
 (Eigen::MatrixXd &x,
  Eigen::MatrixXd& y,
  double & sxzmp, double & syzmp,
- deque<PatternGeneratorJRL::ZMPPosition> & ZMPPositions,
+ PatternGeneratorJRL::RingBuffer<ZMPPosition> & ZMPPositions,
  unsigned long int lindex,
  double & zmpx2, double & zmpy2,
  bool Simulation)
 {
+  if(ZMPPositions.size()<m_SizeOfPreviewWindow)
+    {
+      LTHROW("ZMPPositions.size()<m_SizeOfPreviewWindow:" );
+    }
 
-  double ux=0.0, uy=0.0;
-
-  Eigen::Matrix<double,1,1> r;
+  FillPreviewWindow(ZMPPositions,lindex,m_SizeOfPreviewWindow,m_Window);
 
-  // Compute the command.
-  r = m_Kx * x;
-  ux = - r(0,0) + m_Ks * sxzmp ;
+  return OneIterationOfPreview(x,y,sxzmp,syzmp,m_Window,0,
+                               zmpx2,zmpy2,Simulation);
+}
 
-  if(ZMPPositions.size()<m_SizeOfPreviewWindow)
+int PreviewControl::
+OneIterationOfPreview
+(Eigen::MatrixXd &x,
+ Eigen::MatrixXd& y,
+ double & sxzmp, double & syzmp,
+ const PreviewWindow & ZMPWindow,
+ unsigned long int lindex,
+ double & zmpx2, double & zmpy2,
+ bool Simulation)
+{
+  if((unsigned long int)ZMPWindow.rows()<lindex+m_SizeOfPreviewWindow)
     {
-      LTHROW("ZMPPositions.size()<m_SizeOfPreviewWindow:" );
+      LTHROW("ZMPWindow.rows()<lindex+m_SizeOfPreviewWindow:" );
     }
 
-  for(unsigned int i=0;i<m_SizeOfPreviewWindow;i++)
-    ux += m_F(i,0)* ZMPPositions[lindex+i].px;
+  Eigen::Matrix<double,3,2> X;
+  X.col(0) = x.col(0);
+  X.col(1) = y.col(0);
+  Eigen::Matrix<double,1,2> S(sxzmp,syzmp), ZMP;
 
-  r = m_Kx * y;
-  uy = - r(0,0) + m_Ks * syzmp;
+  OneStepOfPreview(X,S,ZMPWindow,lindex,ZMP,Simulation);
 
-  for(unsigned int i=0;i<m_SizeOfPreviewWindow;i++)
-    uy += m_F(i,0)* ZMPPositions[lindex+i].py;
+  x.col(0) = X.col(0);
+  y.col(0) = X.col(1);
+  sxzmp = S(0); syzmp = S(1);
+  zmpx2 = ZMP(0); zmpy2 = ZMP(1);
 
-  x = m_A*x + ux * m_B;
-  y = m_A*y + uy * m_B;
+  return 0;
+}
 
-  zmpx2 = 0.0;
-  for(unsigned int i=0;i<x.rows();i++)
-    zmpx2 += m_C(0,i)*x(i,0);
-  zmpy2 = 0.0;
-  for(unsigned int i=0;i<y.rows();i++)
-    zmpy2 += m_C(0,i)*y(i,0);
+int PreviewControl::
+IterationsOfPreview
+(Eigen::MatrixXd &x,
+ Eigen::MatrixXd& y,
+ double & sxzmp, double & syzmp,
+ const PreviewWindow & ZMPWindow,
+ unsigned long int lindex,
+ unsigned long int NbOfIterations,
+ PatternGeneratorJRL::RingBuffer<COMState> & COMStates,
+ double & zmpx2, double & zmpy2,
+ bool Simulation)
+{
+  if (NbOfIterations==0)
+    return 0;
 
-  if (Simulation)
+  if((unsigned long int)ZMPWindow.rows()<
+     lindex+NbOfIterations-1+m_SizeOfPreviewWindow)
+    {
+      LTHROW("ZMPWindow.rows()<lindex+NbOfIterations-1+m_SizeOfPreviewWindow:" );
+    }
+  if(COMStates.size()<NbOfIterations)
     {
-      sxzmp += (ZMPPositions[lindex].px - zmpx2);
-      syzmp += (ZMPPositions[lindex].py - zmpy2);
+      LTHROW("COMStates.size()<NbOfIterations:" );
     }
 
+  Eigen::Matrix<double,3,2> X;
+  X.col(0) = x.col(0);
+  X.col(1) = y.col(0);
+  Eigen::Matrix<double,1,2> S(sxzmp,syzmp), ZMP;
+
+  for(unsigned long int i=0;i<NbOfIterations;i++)
+    {
+      OneStepOfPreview(X,S,ZMPWindow,lindex+i,ZMP,Simulation);
+
+      COMState & aCOMState = COMStates[i];
+      for(unsigned int j=0;j<3;j++)
+        {
+          aCOMState.x[j] = X(j,0);
+          aCOMState.y[j] = X(j,1);
+        }
+    }
 
+  x.col(0) = X.col(0);
+  y.col(0) = X.col(1);
+  sxzmp = S(0); syzmp = S(1);
+  zmpx2 = ZMP(0); zmpy2 = ZMP(1);
 
   return 0;
 }
@@ -570,4 +766,24 @@ CallMethod
 	      (OptimalControllerSolver::MODE_WITHOUT_INITIALPOS);
 	}
     }
+  else if (Method==":previewgainscheduling")
+    {
+      // :previewgainscheduling ZcMin ZcMax NbOfHeights, or off
+      std::string aws;
+      strm >> aws;
+      if (aws=="off")
+	StopGainScheduling();
+      else
+	{
+	  std::istringstream lstrm(aws);
+	  double ZcMin=0.0, ZcMax=0.0;
+	  unsigned int NbOfHeights=0;
+	  lstrm >> ZcMin;
+	  strm >> ZcMax >> NbOfHeights;
+	  if (!ScheduleGains(ZcMin,ZcMax,NbOfHeights,
+			     m_DefaultWeightComputationMode))
+	    std::cerr << "PreviewControl - Unable to schedule the gains"
+		      << std::endl;
+	}
+    }
 }
@@ -32,6 +32,7 @@
 #include <iostream>
 #include <string>
 #include <deque>
+#include <RingBuffer.hh>
 #include <vector>
 
 using namespace::std;
@@ -52,7 +53,12 @@ namespace PatternGeneratorJRL
   class  PreviewControl : public SimplePlugin
     {
     public:
-      
+
+      /*! \brief ZMP reference stored as two contiguous columns, x then y.
+	The preview sums along both axes are then a single product
+	with the window of gains F. */
+      typedef Eigen::Matrix<double,Eigen::Dynamic,2> PreviewWindow;
+
       /*! Constructor */
       PreviewControl(SimplePluginManager *lSPM,
 		     unsigned int defaultMode = OptimalControllerSolver::MODE_WITH_INITIALPOS,
@@ -71,12 +77,48 @@ namespace PatternGeneratorJRL
       int OneIterationOfPreview(Eigen::MatrixXd &x, 
 				Eigen::MatrixXd &y,
 				double & sxzmp, double & syzmp,
-				deque<PatternGeneratorJRL::ZMPPosition> & ZMPPositions,
+				PatternGeneratorJRL::RingBuffer<ZMPPosition> & ZMPPositions,
 				unsigned long int lindex,
 				double & zmpx2, double & zmpy2,
 				bool Simulation);
 
 
+      /*! \brief One iteration of the preview control on a contiguous window.
+	\param [in] ZMPWindow: ZMP reference positions, with at least
+	lindex + SizeOfPreviewWindow() rows.
+	The other parameters are the ones of the ring buffer version.
+       */
+      int OneIterationOfPreview(Eigen::MatrixXd &x,
+				Eigen::MatrixXd &y,
+				double & sxzmp, double & syzmp,
+				const PreviewWindow & ZMPWindow,
+				unsigned long int lindex,
+				double & zmpx2, double & zmpy2,
+				bool Simulation);
+
+      /*! \brief NbOfIterations iterations of the preview control
+	starting at lindex in ZMPWindow.
+	The state of the CoM after the i-th iteration is stored
+	in COMStates[i], zmpx2 and zmpy2 are the ZMP of the last one.
+       */
+      int IterationsOfPreview(Eigen::MatrixXd &x,
+			      Eigen::MatrixXd &y,
+			      double & sxzmp, double & syzmp,
+			      const PreviewWindow & ZMPWindow,
+			      unsigned long int lindex,
+			      unsigned long int NbOfIterations,
+			      PatternGeneratorJRL::RingBuffer<COMState> & COMStates,
+			      double & zmpx2, double & zmpy2,
+			      bool Simulation);
+
+      /*! \brief Copy Size ZMP reference positions of ZMPPositions,
+	starting at lindex, in ZMPWindow. */
+      static void FillPreviewWindow
+      (const PatternGeneratorJRL::RingBuffer<ZMPPosition> & ZMPPositions,
+       unsigned long int lindex,
+       unsigned long int Size,
+       PreviewWindow & ZMPWindow);
+
       /*! \brief One iteration of the preview control along one axis (using queues)*/
       int OneIterationOfPreview1D(Eigen::MatrixXd &x, 
 				  double & sxzmp,
@@ -112,6 +154,10 @@ namespace PatternGeneratorJRL
       /*! Getter for the height position of the CoM. */
       double GetHeightOfCoM() const;
 
+      /*! Getter for the number of samples of the preview window. */
+      inline long unsigned int SizeOfPreviewWindow() const
+      { return m_SizeOfPreviewWindow; }
+
       /*! \brief Setter for the sampling period. */
       void SetSamplingPeriod(double lSamplingPeriod);
 	
@@ -131,6 +177,29 @@ namespace PatternGeneratorJRL
        */
       void ComputeOptimalWeights(unsigned int mode);
 
+      /*! \name Gain scheduling on the height of the CoM.
+	@{
+      */
+      /*! \brief Compute the gains for NbOfHeights heights of the CoM
+	evenly spaced in [ZcMin,ZcMax]. Afterwards, and as long as the
+	sampling period and the preview control time do not change,
+	SetHeightOfCoM interpolates these gains for any height of the
+	interval instead of solving the Riccati equation.
+	\return false if the sampling period or the preview control time
+	is not set, or if the grid has less than two heights.
+       */
+      bool ScheduleGains(double ZcMin, double ZcMax,
+			 unsigned int NbOfHeights,
+			 unsigned int mode);
+
+      /*! \brief Solve the Riccati equation for each height again. */
+      void StopGainScheduling();
+
+      /*! \brief Indicates if the gains are interpolated on a grid. */
+      inline bool IsGainScheduled() const
+      { return m_ScheduledF.cols()>1; }
+      /*! @} */
+
       /*! \brief Overloading of << operator. */
       void print();
 
@@ -139,6 +208,20 @@ namespace PatternGeneratorJRL
 			      std::istringstream &astrm); 
     private:
 
+      /*! \brief One iteration on the state of the CoM along x and y
+	(first and second column of X), S holds the summed errors. */
+      void OneStepOfPreview(Eigen::Matrix<double,3,2> & X,
+			    Eigen::Matrix<double,1,2> & S,
+			    const PreviewWindow & ZMPWindow,
+			    unsigned long int lindex,
+			    Eigen::Matrix<double,1,2> & ZMP,
+			    bool Simulation);
+
+      /*! \brief Interpolate the scheduled gains for m_Zc.
+	Returns false if m_Zc is outside the grid
+	or if the grid is not valid anymore. */
+      bool InterpolateGains();
+
       /*! \brief Matrices for preview control. */
       Eigen::MatrixXd m_A;
       Eigen::MatrixXd m_B;
@@ -179,6 +262,23 @@ namespace PatternGeneratorJRL
 
       /*! \brief Default Mode. */
       unsigned int m_DefaultWeightComputationMode;
+
+      /*! \brief Window used by the ring buffer version
+	of OneIterationOfPreview. */
+      PreviewWindow m_Window;
+
+      /*! \name Gain scheduling.
+	@{ */
+      /*! \brief First height of the grid and step between two heights. */
+      double m_ScheduledZcMin, m_ScheduledZcStep;
+      /*! \brief Sampling period and preview control time of the grid. */
+      double m_ScheduledSamplingPeriod, m_ScheduledPreviewControlTime;
+      /*! \brief Gains F at each height of the grid, one column per height. */
+      Eigen::MatrixXd m_ScheduledF;
+      /*! \brief Ks then Kx at each height of the grid,
+	one column per height. */
+      Eigen::Matrix<double,4,Eigen::Dynamic> m_ScheduledK;
+      /*! @} */
     };
 }
 #include <ZMPRefTrajectoryGeneration/ZMPDiscretization.hh>
@@ -0,0 +1,450 @@
+/*
+ * Copyright 2019,
+ *
+ * Olivier Stasse
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+/*! \file PreviewGainsCache.cpp
+    \brief Cache of the gains of the preview control, in memory and on disk.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef WIN32
+# include <process.h>
+# define getpid _getpid
+#else
+# include <unistd.h>
+#endif /* WIN32 */
+
+#include <fstream>
+#include <list>
+#include <map>
+#include <sstream>
+
+#include <boost/thread/mutex.hpp>
+
+#include <PreviewControl/PreviewGainsCache.hh>
+
+#include <Debug.hh>
+
+using namespace std;
+using namespace PatternGeneratorJRL;
+
+namespace
+{
+  const char GAINS_CACHE_MAGIC[8] = { 'J','R','L','G','A','I','N','S' };
+  const unsigned int GAINS_CACHE_VERSION = 1;
+
+  /* Upper bound on the sizes read from a file. */
+  const unsigned int GAINS_CACHE_MAX_SIZE = 100000;
+
+  void HashBytes(unsigned long long int &aHash,
+                 const void *Data, size_t Size)
+  {
+    const unsigned char *lBytes = (const unsigned char *)Data;
+    for(size_t i=0;i<Size;i++)
+      {
+        aHash ^= lBytes[i];
+        aHash *= 1099511628211ULL;
+      }
+  }
+
+  void WriteKey(ofstream &aFile, const PreviewGainsKey &aKey)
+  {
+    aFile.write((const char *)&aKey.T,sizeof(aKey.T));
+    aFile.write((const char *)&aKey.Zc,sizeof(aKey.Zc));
+    aFile.write((const char *)&aKey.Q,sizeof(aKey.Q));
+    aFile.write((const char *)&aKey.R,sizeof(aKey.R));
+    aFile.write((const char *)&aKey.NL,sizeof(aKey.NL));
+    aFile.write((const char *)&aKey.Mode,sizeof(aKey.Mode));
+  }
+
+  bool ReadKey(ifstream &aFile, PreviewGainsKey &aKey)
+  {
+    aFile.read((char *)&aKey.T,sizeof(aKey.T));
+    aFile.read((char *)&aKey.Zc,sizeof(aKey.Zc));
+    aFile.read((char *)&aKey.Q,sizeof(aKey.Q));
+    aFile.read((char *)&aKey.R,sizeof(aKey.R));
+    aFile.read((char *)&aKey.NL,sizeof(aKey.NL));
+    aFile.read((char *)&aKey.Mode,sizeof(aKey.Mode));
+    return (bool)aFile;
+  }
+
+  void WriteMatrix(ofstream &aFile, const Eigen::MatrixXd &M)
+  {
+    unsigned int lSize[2] = { (unsigned int)M.rows(), (unsigned int)M.cols() };
+    aFile.write((const char *)lSize,sizeof(lSize));
+    aFile.write((const char *)M.data(),M.size()*sizeof(double));
+  }
+
+  bool ReadMatrix(ifstream &aFile, Eigen::MatrixXd &M)
+  {
+    unsigned int lSize[2];
+    if (!aFile.read((char *)lSize,sizeof(lSize)) ||
+        lSize[0]>GAINS_CACHE_MAX_SIZE || lSize[1]>GAINS_CACHE_MAX_SIZE)
+      return false;
+    M.resize(lSize[0],lSize[1]);
+    return (bool)aFile.read((char *)M.data(),M.size()*sizeof(double));
+  }
+
+  /* Number of keys kept in memory by default. */
+  const unsigned int GAINS_CACHE_CAPACITY = 64;
+
+  struct PreviewGains
+  {
+    PreviewGainsKey Key;
+    Eigen::MatrixXd K, F;
+  };
+  typedef std::list<PreviewGains> GainsList_t;
+}
+
+struct PreviewGainsCache::Private
+{
+  /*! \brief Serializes the preview controls of several threads. */
+  mutable boost::mutex Mutex;
+  /*! \brief Most recently used first. */
+  GainsList_t Gains;
+  std::map<PreviewGainsKey,GainsList_t::iterator> Index;
+  unsigned int Capacity;
+  /*! \brief Gains inserted and not written yet. */
+  GainsList_t Pending;
+  std::string Directory;
+  unsigned long int NbOfMemoryHits, NbOfDiskHits, NbOfMisses;
+
+  /*! \brief Store someGains as the most recently used,
+    dropping the least recently used ones beyond the capacity. */
+  void Store(const PreviewGains &someGains);
+  /*! \brief Drop the least recently used gains beyond aCapacity. */
+  void Shrink(unsigned int aCapacity);
+
+  /*! \brief Read the file of aKey in aDirectory,
+    false if there is no valid one. */
+  static bool Read(const std::string &aDirectory,
+                   const PreviewGainsKey &aKey, PreviewGains &someGains);
+  /*! \brief Write the file of someGains in aDirectory, false on failure. */
+  static bool Write(const std::string &aDirectory,
+                    const PreviewGains &someGains);
+};
+
+void PreviewGainsCache::Private::Shrink(unsigned int aCapacity)
+{
+  while(Index.size()>aCapacity)
+    {
+      Index.erase(Gains.back().Key);
+      Gains.pop_back();
+    }
+}
+
+void PreviewGainsCache::Private::Store(const PreviewGains &someGains)
+{
+  std::map<PreviewGainsKey,GainsList_t::iterator>::iterator it =
+    Index.find(someGains.Key);
+  if (it!=Index.end())
+    {
+      Gains.splice(Gains.begin(),Gains,it->second);
+      Gains.front() = someGains;
+      return;
+    }
+  Shrink(Capacity-1);
+  Gains.push_front(someGains);
+  Index[someGains.Key] = Gains.begin();
+}
+
+PreviewGainsKey::PreviewGainsKey():
+  T(0.0), Zc(0.0), Q(0.0), R(0.0), NL(0), Mode(0)
+{}
+
+PreviewGainsKey::PreviewGainsKey(double lT, double lZc,
+                                 double lQ, double lR,
+                                 int lNL, unsigned int lMode):
+  T(lT), Zc(lZc), Q(lQ), R(lR), NL(lNL), Mode(lMode)
+{}
+
+bool PreviewGainsKey::operator<(const PreviewGainsKey &aKey) const
+{
+  if (T!=aKey.T)
+    return T<aKey.T;
+  if (Zc!=aKey.Zc)
+    return Zc<aKey.Zc;
+  if (Q!=aKey.Q)
+    return Q<aKey.Q;
+  if (R!=aKey.R)
+    return R<aKey.R;
+  if (NL!=aKey.NL)
+    return NL<aKey.NL;
+  return Mode<aKey.Mode;
+}
+
+bool PreviewGainsKey::operator==(const PreviewGainsKey &aKey) const
+{
+  return (T==aKey.T) && (Zc==aKey.Zc) && (Q==aKey.Q) && (R==aKey.R) &&
+    (NL==aKey.NL) && (Mode==aKey.Mode);
+}
+
+unsigned long long int PreviewGainsKey::Hash() const
+{
+  // FNV-1a on the values, field by field to skip the padding.
+  unsigned long long int r = 14695981039346656037ULL;
+  HashBytes(r,&T,sizeof(T));
+  HashBytes(r,&Zc,sizeof(Zc));
+  HashBytes(r,&Q,sizeof(Q));
+  HashBytes(r,&R,sizeof(R));
+  HashBytes(r,&NL,sizeof(NL));
+  HashBytes(r,&Mode,sizeof(Mode));
+  return r;
+}
+
+bool PreviewGainsCache::Private::Read(const std::string &aDirectory,
+                                      const PreviewGainsKey &aKey,
+                                      PreviewGains &someGains)
+{
+  ifstream aFile(FileName(aDirectory,aKey).c_str(),
+                 ifstream::in | ifstream::binary);
+  if (!aFile.is_open())
+    return false;
+
+  char lMagic[sizeof(GAINS_CACHE_MAGIC)];
+  unsigned int lVersion = 0;
+  PreviewGainsKey lKey;
+  aFile.read(lMagic,sizeof(lMagic));
+  aFile.read((char *)&lVersion,sizeof(lVersion));
+  if (!aFile || memcmp(lMagic,GAINS_CACHE_MAGIC,sizeof(lMagic))!=0
+      || lVersion!=GAINS_CACHE_VERSION)
+    return false;
+  // Different keys may have the same hash.
+  if (!ReadKey(aFile,lKey) || !(lKey==aKey))
+    return false;
+  someGains.Key = aKey;
+  return ReadMatrix(aFile,someGains.K) && ReadMatrix(aFile,someGains.F);
+}
+
+bool PreviewGainsCache::Private::Write(const std::string &aDirectory,
+                                       const PreviewGains &someGains)
+{
+  string lFileName = FileName(aDirectory,someGains.Key);
+  ostringstream lTemporaryName;
+  lTemporaryName << lFileName << "." << getpid() << ".tmp";
+
+  {
+    ofstream aFile(lTemporaryName.str().c_str(),
+                   ofstream::out | ofstream::binary);
+    if (!aFile.is_open())
+      return false;
+    aFile.write(GAINS_CACHE_MAGIC,sizeof(GAINS_CACHE_MAGIC));
+    aFile.write((const char *)&GAINS_CACHE_VERSION,
+                sizeof(GAINS_CACHE_VERSION));
+    WriteKey(aFile,someGains.Key);
+    WriteMatrix(aFile,someGains.K);
+    WriteMatrix(aFile,someGains.F);
+    if (!aFile.good())
+      {
+        aFile.close();
+        remove(lTemporaryName.str().c_str());
+        return false;
+      }
+  }
+
+  // The readers see either no file or a complete one.
+#ifdef WIN32
+  remove(lFileName.c_str());
+#endif /* WIN32 */
+  if (rename(lTemporaryName.str().c_str(),lFileName.c_str())!=0)
+    {
+      remove(lTemporaryName.str().c_str());
+      return false;
+    }
+  return true;
+}
+
+PreviewGainsCache & PreviewGainsCache::Instance()
+{
+  static PreviewGainsCache aCache;
+  return aCache;
+}
+
+PreviewGainsCache::PreviewGainsCache()
+{
+  m_Private = new Private;
+  m_Private->NbOfMemoryHits = 0;
+  m_Private->NbOfDiskHits = 0;
+  m_Private->NbOfMisses = 0;
+  m_Private->Capacity = GAINS_CACHE_CAPACITY;
+
+  const char * lDirectory = getenv("JRL_WALKGEN_GAINS_CACHE");
+  if (lDirectory!=0)
+    m_Private->Directory = lDirectory;
+}
+
+PreviewGainsCache::~PreviewGainsCache()
+{
+  Flush();
+  delete m_Private;
+}
+
+bool PreviewGainsCache::Find(const PreviewGainsKey &aKey,
+                             Eigen::MatrixXd &K, Eigen::MatrixXd &F)
+{
+  boost::mutex::scoped_lock lock(m_Private->Mutex);
+
+  std::map<PreviewGainsKey,GainsList_t::iterator>::iterator it =
+    m_Private->Index.find(aKey);
+  if (it!=m_Private->Index.end())
+    {
+      m_Private->NbOfMemoryHits++;
+      m_Private->Gains.splice(m_Private->Gains.begin(),
+                              m_Private->Gains,it->second);
+      K = m_Private->Gains.front().K;
+      F = m_Private->Gains.front().F;
+      return true;
+    }
+
+  // Dropped from memory before being written.
+  for(GainsList_t::const_iterator itPending=m_Private->Pending.begin();
+      itPending!=m_Private->Pending.end();itPending++)
+    if (itPending->Key==aKey)
+      {
+        m_Private->NbOfMemoryHits++;
+        m_Private->Store(*itPending);
+        K = itPending->K;
+        F = itPending->F;
+        return true;
+      }
+
+  PreviewGains someGains;
+  if (!m_Private->Directory.empty() &&
+      Private::Read(m_Private->Directory,aKey,someGains))
+    {
+      ODEBUG("Gains read from " << FileName(m_Private->Directory,aKey));
+      m_Private->NbOfDiskHits++;
+      m_Private->Store(someGains);
+      K = someGains.K;
+      F = someGains.F;
+      return true;
+    }
+
+  m_Private->NbOfMisses++;
+  return false;
+}
+
+void PreviewGainsCache::Insert(const PreviewGainsKey &aKey,
+                               const Eigen::MatrixXd &K,
+                               const Eigen::MatrixXd &F)
+{
+  PreviewGains someGains;
+  someGains.Key = aKey;
+  someGains.K = K;
+  someGains.F = F;
+
+  boost::mutex::scoped_lock lock(m_Private->Mutex);
+  m_Private->Store(someGains);
+  if (!m_Private->Directory.empty())
+    m_Private->Pending.push_back(someGains);
+}
+
+unsigned int PreviewGainsCache::Flush()
+{
+  GainsList_t lPending;
+  string lDirectory;
+  {
+    boost::mutex::scoped_lock lock(m_Private->Mutex);
+    lPending.swap(m_Private->Pending);
+    lDirectory = m_Private->Directory;
+  }
+  if (lDirectory.empty())
+    return 0;
+
+  unsigned int lNbOfFailures = 0;
+  for(GainsList_t::const_iterator it=lPending.begin();
+      it!=lPending.end();it++)
+    if (!Private::Write(lDirectory,*it))
+      {
+        std::cerr << "PreviewGainsCache - Unable to write "
+                  << FileName(lDirectory,it->Key) << std::endl;
+        lNbOfFailures++;
+      }
+  return lNbOfFailures;
+}
+
+void PreviewGainsCache::SetDirectory(const std::string &aDirectory)
+{
+  Flush();
+  boost::mutex::scoped_lock lock(m_Private->Mutex);
+  m_Private->Directory = aDirectory;
+}
+
+void PreviewGainsCache::SetCapacity(unsigned int aCapacity)
+{
+  boost::mutex::scoped_lock lock(m_Private->Mutex);
+  m_Private->Capacity = aCapacity>0 ? aCapacity : 1;
+  m_Private->Shrink(m_Private->Capacity);
+}
+
+unsigned int PreviewGainsCache::Capacity() const
+{
+  boost::mutex::scoped_lock lock(m_Private->Mutex);
+  return m_Private->Capacity;
+}
+
+unsigned int PreviewGainsCache::NbOfEntries() const
+{
+  boost::mutex::scoped_lock lock(m_Private->Mutex);
+  return (unsigned int)m_Private->Index.size();
+}
+
+std::string PreviewGainsCache::Directory() const
+{
+  boost::mutex::scoped_lock lock(m_Private->Mutex);
+  return m_Private->Directory;
+}
+
+void PreviewGainsCache::Clear()
+{
+  boost::mutex::scoped_lock lock(m_Private->Mutex);
+  m_Private->Gains.clear();
+  m_Private->Index.clear();
+}
+
+unsigned long int PreviewGainsCache::NbOfMemoryHits() const
+{
+  boost::mutex::scoped_lock lock(m_Private->Mutex);
+  return m_Private->NbOfMemoryHits;
+}
+
+unsigned long int PreviewGainsCache::NbOfDiskHits() const
+{
+  boost::mutex::scoped_lock lock(m_Private->Mutex);
+  return m_Private->NbOfDiskHits;
+}
+
+unsigned long int PreviewGainsCache::NbOfMisses() const
+{
+  boost::mutex::scoped_lock lock(m_Private->Mutex);
+  return m_Private->NbOfMisses;
+}
+
+std::string PreviewGainsCache::FileName(const std::string &aDirectory,
+                                        const PreviewGainsKey &aKey)
+{
+  char lHash[17];
+  sprintf(lHash,"%016llx",aKey.Hash());
+  return aDirectory + "/" + lHash + ".gains";
+}
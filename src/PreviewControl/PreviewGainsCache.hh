@@ -0,0 +1,137 @@
+/*
+ * Copyright 2019,
+ *
+ * Olivier Stasse
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+/*! \file PreviewGainsCache.hh
+    \brief Cache of the gains of the preview control, in memory and on disk.
+*/
+#ifndef _PREVIEW_GAINS_CACHE_H_
+# define _PREVIEW_GAINS_CACHE_H_
+
+#include <string>
+
+#include <Eigen/Dense>
+
+namespace PatternGeneratorJRL
+{
+  /*! \brief Everything the gains of the preview control depend on. */
+  struct PreviewGainsKey
+  {
+    /*! \brief Sampling period. */
+    double T;
+    /*! \brief Height of the CoM. */
+    double Zc;
+    /*! \brief Weights of the ZMP error and of the jerk. */
+    double Q, R;
+    /*! \brief Number of samples of the preview window. */
+    int NL;
+    /*! \brief Mode of OptimalControllerSolver::ComputeWeights. */
+    unsigned int Mode;
+
+    PreviewGainsKey();
+    PreviewGainsKey(double T, double Zc, double Q, double R,
+                    int NL, unsigned int Mode);
+
+    bool operator<(const PreviewGainsKey &aKey) const;
+    bool operator==(const PreviewGainsKey &aKey) const;
+
+    /*! \brief Hash of the key, names the file of the gains. */
+    unsigned long long int Hash() const;
+  };
+
+  /*! \brief Process-wide cache of the gains K and F computed by
+    OptimalControllerSolver.
+
+    Solving the Riccati equation is done once per key and per process:
+    the gains are kept in memory and shared by all the preview controls.
+    At most Capacity() keys are kept, the least recently used one is
+    dropped to store a new one.
+
+    If a directory is set, either by SetDirectory() or by the environment
+    variable JRL_WALKGEN_GAINS_CACHE, the gains are also written in one
+    file per key, named after the hash of the key, and read back by the
+    next processes. Insert() does not write: the files are written by
+    Flush(), which is called when the directory changes and at the end
+    of the process. Each file holds its key, which is checked when it is
+    read, and is written under a temporary name then renamed, so that
+    several processes can share the directory.
+
+    The cache can be used by several threads, a lock serializes them.
+  */
+  class PreviewGainsCache
+  {
+  public:
+    /*! \brief The cache shared by all the preview controls. */
+    static PreviewGainsCache & Instance();
+
+    ~PreviewGainsCache();
+
+    /*! \brief Gains of aKey, looked for in memory then on disk.
+      @return false if they have to be computed. */
+    bool Find(const PreviewGainsKey &aKey,
+              Eigen::MatrixXd &K, Eigen::MatrixXd &F);
+
+    /*! \brief Store the gains of aKey in memory. If a directory
+      is set, they are written by the next Flush(). */
+    void Insert(const PreviewGainsKey &aKey,
+                const Eigen::MatrixXd &K, const Eigen::MatrixXd &F);
+
+    /*! \brief Write the gains inserted since the last call in the
+      directory. The lock is not held while writing.
+      @return the number of files which could not be written. */
+    unsigned int Flush();
+
+    /*! \brief Directory of the gain files, empty to keep
+      the gains in memory only. The pending gains are written
+      in the previous directory first. */
+    void SetDirectory(const std::string &aDirectory);
+    std::string Directory() const;
+
+    /*! \brief Number of keys kept in memory, at least 1. */
+    void SetCapacity(unsigned int aCapacity);
+    unsigned int Capacity() const;
+    unsigned int NbOfEntries() const;
+
+    /*! \brief Drop the gains kept in memory. The files, and the
+      gains still to be written, are kept. */
+    void Clear();
+
+    /*! \name Statistics since the start of the process.
+      @{ */
+    unsigned long int NbOfMemoryHits() const;
+    unsigned long int NbOfDiskHits() const;
+    unsigned long int NbOfMisses() const;
+    /*! @} */
+
+    /*! \brief File of the gains of aKey in aDirectory. */
+    static std::string FileName(const std::string &aDirectory,
+                                const PreviewGainsKey &aKey);
+
+  protected:
+    PreviewGainsCache();
+
+    /*! \brief Members hiding the containers and the threading types. */
+    struct Private;
+    Private * m_Private;
+  };
+}
+#endif /* _PREVIEW_GAINS_CACHE_H_ */
@@ -505,10 +505,10 @@ SetPreviewControl(PreviewControl *aPC)
 
  int ZMPPreviewControlWithMultiBodyZMP::
  Setup
- (deque<ZMPPosition> &ZMPRefPositions,
-  deque<COMState> &COMStates,
-  deque<FootAbsolutePosition> &LeftFootPositions,
-  deque<FootAbsolutePosition> &RightFootPositions)
+ (RingBuffer<ZMPPosition> &ZMPRefPositions,
+  RingBuffer<COMState> &COMStates,
+  RingBuffer<FootAbsolutePosition> &LeftFootPositions,
+  RingBuffer<FootAbsolutePosition> &RightFootPositions)
  {
    m_NumberOfIterations = 0;
    Eigen::VectorXd CurrentConfiguration = m_PinocchioRobot->currentConfiguration();
@@ -536,10 +536,10 @@ SetPreviewControl(PreviewControl *aPC)
 
  int ZMPPreviewControlWithMultiBodyZMP::
  SetupFirstPhase
- (deque<ZMPPosition> &ZMPRefPositions,
-  deque<COMState> &, //COMStates,
-  deque<FootAbsolutePosition> &LeftFootPositions,
-  deque<FootAbsolutePosition> &RightFootPositions)
+ (RingBuffer<ZMPPosition> &ZMPRefPositions,
+  RingBuffer<COMState> &, //COMStates,
+  RingBuffer<FootAbsolutePosition> &LeftFootPositions,
+  RingBuffer<FootAbsolutePosition> &RightFootPositions)
  {
    ODEBUG6("Beginning of Setup 0 ","DebugData.txt");
    ODEBUG("Setup");
@@ -616,10 +616,10 @@ SetPreviewControl(PreviewControl *aPC)
 
  int ZMPPreviewControlWithMultiBodyZMP::
  SetupIterativePhase
- (deque<ZMPPosition> &ZMPRefPositions,
-  deque<COMState> &COMStates,
-  deque<FootAbsolutePosition> &LeftFootPositions,
-  deque<FootAbsolutePosition> &RightFootPositions,
+ (RingBuffer<ZMPPosition> &ZMPRefPositions,
+  RingBuffer<COMState> &COMStates,
+  RingBuffer<FootAbsolutePosition> &LeftFootPositions,
+  RingBuffer<FootAbsolutePosition> &RightFootPositions,
   Eigen::VectorXd & CurrentConfiguration,
   Eigen::VectorXd & CurrentVelocity,
   Eigen::VectorXd & CurrentAcceleration,
@@ -673,12 +673,12 @@ SetPreviewControl(PreviewControl *aPC)
  }
  void ZMPPreviewControlWithMultiBodyZMP::
  CreateExtraCOMBuffer
- (deque<COMState> &m_ExtraCOMBuffer,
-  deque<ZMPPosition> &m_ExtraZMPBuffer,
-  deque<ZMPPosition> &m_ExtraZMPRefBuffer)
+ (RingBuffer<COMState> &m_ExtraCOMBuffer,
+  RingBuffer<ZMPPosition> &m_ExtraZMPBuffer,
+  RingBuffer<ZMPPosition> &m_ExtraZMPRefBuffer)
 
  {
-   deque<ZMPPosition> aFIFOZMPRefPositions;
+   RingBuffer<ZMPPosition> aFIFOZMPRefPositions;
    Eigen::MatrixXd aPC1x;
    Eigen::MatrixXd aPC1y;
    double aSxzmp, aSyzmp;
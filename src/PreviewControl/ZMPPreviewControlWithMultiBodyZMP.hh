@@ -34,6 +34,7 @@
 
 #include <deque>
 
+#include <RingBuffer.hh>
 #include <jrl/walkgen/pgtypes.hh>
 #include <SimplePlugin.hh>
 #include <PreviewControl/PreviewControl.hh>
@@ -101,19 +102,19 @@ namespace PatternGeneratorJRL
       //@}
       
       /*! Fifo for the ZMP ref. */
-      deque<ZMPPosition> m_FIFOZMPRefPositions;
+      RingBuffer<ZMPPosition> m_FIFOZMPRefPositions;
       
       /*! Fifo for the ZMP ref. */
-      deque<ZMPPosition> m_FIFODeltaZMPPositions;
+      RingBuffer<ZMPPosition> m_FIFODeltaZMPPositions;
 
       /*! Fifo for the COM reference. */
-      deque<COMState> m_FIFOCOMStates;
+      RingBuffer<COMState> m_FIFOCOMStates;
 
       /*! Fifo for the positionning of the left foot. */
-      deque<FootAbsolutePosition> m_FIFOLeftFootPosition;
+      RingBuffer<FootAbsolutePosition> m_FIFOLeftFootPosition;
       
       /*! Fifo for the positionning of the right foot. */
-      deque<FootAbsolutePosition> m_FIFORightFootPosition;
+      RingBuffer<FootAbsolutePosition> m_FIFORightFootPosition;
 
       /*! Error on preview control for the cart model. */
       double m_sxzmp, m_syzmp;
@@ -133,7 +134,7 @@ namespace PatternGeneratorJRL
       bool m_StartingNewSequence;
 
       /*! Keep the ZMP reference. */
-      deque<ZMPPosition> m_FIFOTmpZMPPosition;
+      RingBuffer<ZMPPosition> m_FIFOTmpZMPPosition;
 	
       /*!extra COMState buffer calculated to give to the stepover planner  */
       std::vector<COMState> m_ExtraCOMBuffer;
@@ -350,10 +351,10 @@ namespace PatternGeneratorJRL
 	@param[in] RightFootPositions: idem than the previous one but for the 
 	right foot.
        */
-      int Setup(deque<ZMPPosition> &ZMPRefPositions,
-		deque<COMState> &COMStates,
-		deque<FootAbsolutePosition> &LeftFootPositions,
-		deque<FootAbsolutePosition> &RightFootPositions);
+      int Setup(RingBuffer<ZMPPosition> &ZMPRefPositions,
+		RingBuffer<COMState> &COMStates,
+		RingBuffer<FootAbsolutePosition> &LeftFootPositions,
+		RingBuffer<FootAbsolutePosition> &RightFootPositions);
 
       /*! Method to perform the First Phase. It initializes properly the internal fields
 	of ZMPPreviewControlWithMultiBodyZMP for the setup phase.
@@ -367,10 +368,10 @@ namespace PatternGeneratorJRL
 	@param[in] RightFootPositions: idem than the previous one but for the 
 	right foot.
       */
-      int SetupFirstPhase(deque<ZMPPosition> &ZMPRefPositions,
-			  deque<COMState> &COMStates,
-			  deque<FootAbsolutePosition> &LeftFootPositions,
-			  deque<FootAbsolutePosition> &RightFootPositions);
+      int SetupFirstPhase(RingBuffer<ZMPPosition> &ZMPRefPositions,
+			  RingBuffer<COMState> &COMStates,
+			  RingBuffer<FootAbsolutePosition> &LeftFootPositions,
+			  RingBuffer<FootAbsolutePosition> &RightFootPositions);
 
 
       /*! Method to call while feeding the 2 preview windows.
@@ -394,10 +395,10 @@ namespace PatternGeneratorJRL
 	feet position instance.
 	@param[in] localindex: Value of the index which goes from 0 to 2 * m_NL.
       */
-      int SetupIterativePhase(deque<ZMPPosition> &ZMPRefPositions,
-			      deque<COMState> &COMStates,
-			      deque<FootAbsolutePosition> &LeftFootPositions,
-			      deque<FootAbsolutePosition> &RightFootPositions,
+      int SetupIterativePhase(RingBuffer<ZMPPosition> &ZMPRefPositions,
+			      RingBuffer<COMState> &COMStates,
+			      RingBuffer<FootAbsolutePosition> &LeftFootPositions,
+			      RingBuffer<FootAbsolutePosition> &RightFootPositions,
 			      Eigen::VectorXd &CurrentConfiguration,
 			      Eigen::VectorXd & CurrentVelocity,
 			      Eigen::VectorXd & CurrentAcceleration,
@@ -412,9 +413,9 @@ namespace PatternGeneratorJRL
 	first preview control).
 	@param[out] ExtraZMPRefBuffer: Extra FIFO for the ZMP ref positions.
       */
-      void CreateExtraCOMBuffer(deque<COMState> &ExtraCOMBuffer,
-				deque<ZMPPosition> &ExtraZMPBuffer,
-				deque<ZMPPosition> &ExtraZMPRefBuffer);
+      void CreateExtraCOMBuffer(RingBuffer<COMState> &ExtraCOMBuffer,
+				RingBuffer<ZMPPosition> &ExtraZMPBuffer,
+				RingBuffer<ZMPPosition> &ExtraZMPRefBuffer);
       
       /*! Evaluate Starting CoM for a given position.
 	@param[in] BodyAnglesInit: The state vector used to compute the CoM.
@@ -152,7 +152,7 @@ RigidBodySystem::initialize_trajectories()
   // Fixed support states:
   // ---------------------
   SupportTrajectory_deq_.resize(40);
-  std::deque<support_state_t>::iterator ST_it =
+  RingBuffer<support_state_t>::iterator ST_it =
     SupportTrajectory_deq_.begin();
   ST_it->X = 0.257792; ST_it->Y = -0.105; ST_it++;
   ST_it->X = 0.257792; ST_it->Y = -0.105; ST_it++;
@@ -175,7 +175,7 @@ RigidBodySystem::initialize_trajectories()
 int
 RigidBodySystem::
 precompute_trajectories
-( const deque<support_state_t> & SupportStates_deq )
+( const RingBuffer<support_state_t> & SupportStates_deq )
 {
 
   // Precompute vertical foot trajectories
@@ -184,7 +184,7 @@ precompute_trajectories
   Eigen::Vector3d LocalAnklePosition;
   LocalAnklePosition = PR_->leftFoot()->anklePosition ;
 
-  deque<support_state_t>::const_iterator SS_it
+  RingBuffer<support_state_t>::const_iterator SS_it
     = SupportStates_deq.begin();
   SS_it++;//First support phase is current support phase
   deque<rigid_body_state_t>::iterator
@@ -244,9 +244,9 @@ precompute_trajectories
 
 
 int
-RigidBodySystem::update( const std::deque<support_state_t> & SupportStates_deq,
-    const std::deque<FootAbsolutePosition> & LeftFootTraj_deq,
-    const std::deque<FootAbsolutePosition> & RightFootTraj_deq )
+RigidBodySystem::update( const RingBuffer<support_state_t> & SupportStates_deq,
+    const RingBuffer<FootAbsolutePosition> & LeftFootTraj_deq,
+    const RingBuffer<FootAbsolutePosition> & RightFootTraj_deq )
 {
 
   unsigned nbStepsPreviewed = SupportStates_deq.back().StepNumber;
@@ -477,7 +477,7 @@ RigidBodySystem::compute_dyn_cjerk( linear_dynamics_t & Dynamics )
 
 
 int
-RigidBodySystem::compute_foot_zero_dynamics( const std::deque<support_state_t> & SupportStates_deq,
+RigidBodySystem::compute_foot_zero_dynamics( const RingBuffer<support_state_t> & SupportStates_deq,
     linear_dynamics_t & LeftFootDynamics, linear_dynamics_t & RightFootDynamics )
 {
 
@@ -502,7 +502,7 @@ RigidBodySystem::compute_foot_zero_dynamics( const std::deque<support_state_t> &
   linear_dynamics_t * FFDynamics;
   double Spbar[3]={0.0,0.0,0.0};//, Sabar[3];
   double Upbar[2]={0.0,0.0};//, Uabar[2];
-  std::deque<support_state_t>::const_iterator SS_it =
+  RingBuffer<support_state_t>::const_iterator SS_it =
       SupportStates_deq.begin();
   SS_it++;
   for(unsigned int i=0;i<N_;i++)
@@ -603,7 +603,7 @@ RigidBodySystem::compute_foot_zero_dynamics( const std::deque<support_state_t> &
 
 
 int
-RigidBodySystem::compute_foot_pol_dynamics( const std::deque<support_state_t> & SupportStates_deq,
+RigidBodySystem::compute_foot_pol_dynamics( const RingBuffer<support_state_t> & SupportStates_deq,
     linear_dynamics_t & LeftFootDynamics, linear_dynamics_t & RightFootDynamics )
 {
 
@@ -628,7 +628,7 @@ RigidBodySystem::compute_foot_pol_dynamics( const std::deque<support_state_t> &
   linear_dynamics_t * FFDynamics;
   double Spbar[3], Sabar[3];
   double Upbar[2], Uabar[2];
-  std::deque<support_state_t>::const_iterator SS_it =
+  RingBuffer<support_state_t>::const_iterator SS_it =
       SupportStates_deq.begin();
   SS_it++;
   for(unsigned int i=0;i<N_;i++)
@@ -750,7 +750,7 @@ RigidBodySystem::compute_foot_pol_dynamics( const std::deque<support_state_t> &
 
 
 //int
-//RigidBodySystem::compute_foot_cjerk_dynamics( const std::deque<support_state_t> & SupportStates_deq,
+//RigidBodySystem::compute_foot_cjerk_dynamics( const RingBuffer<support_state_t> & SupportStates_deq,
 //    linear_dynamics_t & LeftFootDynamics, linear_dynamics_t & RightFootDynamics )
 //{
 //
@@ -775,7 +775,7 @@ RigidBodySystem::compute_foot_pol_dynamics( const std::deque<support_state_t> &
 //  double Spbar[3], Sabar[3];
 //  double Upbar[2], Uabar[2];
 //  unsigned int SwitchInstant = 0;
-//  std::deque<support_state_t>::const_iterator SS_it =
+//  RingBuffer<support_state_t>::const_iterator SS_it =
 //      SupportStates_deq.begin();
 //  SS_it++;
 //  for(unsigned int i=0;i<N_;i++)
@@ -899,8 +899,8 @@ RigidBodySystem::compute_foot_pol_dynamics( const std::deque<support_state_t> &
 
 int
 RigidBodySystem::generate_trajectories( double Time, const solution_t & Solution,
-    const std::deque<support_state_t> & PrwSupportStates_deq, const std::deque<double> & PreviewedSupportAngles_deq,
-    std::deque<FootAbsolutePosition> & LeftFootTraj_deq, std::deque<FootAbsolutePosition> & RightFootTraj_deq )
+    const RingBuffer<support_state_t> & PrwSupportStates_deq, const RingBuffer<double> & PreviewedSupportAngles_deq,
+    RingBuffer<FootAbsolutePosition> & LeftFootTraj_deq, RingBuffer<FootAbsolutePosition> & RightFootTraj_deq )
 {
 
   OFTG_->interpolate_feet_positions(Time, PrwSupportStates_deq,
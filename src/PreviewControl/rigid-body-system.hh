@@ -59,10 +59,10 @@ namespace PatternGeneratorJRL
     ///
     /// \return 0
     int interpolate( solution_t Result,
-        std::deque<ZMPPosition> & FinalZMPTraj_deq,
-        std::deque<COMState> & FinalCOMTraj_deq,
-        std::deque<FootAbsolutePosition> &FinalLeftFootTraj_deq,
-        std::deque<FootAbsolutePosition> &FinalRightFootTraj_deq );
+        RingBuffer<ZMPPosition> & FinalZMPTraj_deq,
+        RingBuffer<COMState> & FinalCOMTraj_deq,
+        RingBuffer<FootAbsolutePosition> &FinalLeftFootTraj_deq,
+        RingBuffer<FootAbsolutePosition> &FinalRightFootTraj_deq );
 
     /// \brief Update feet matrices
     ///
@@ -71,9 +71,9 @@ namespace PatternGeneratorJRL
     /// \param[in] RightFootTraj_deq Final foot trajectory (right foot)
     ///
     /// \return 0
-    int update( const std::deque<support_state_t> & SupportStates_deq,
-        const std::deque<FootAbsolutePosition> & LeftFootTraj_deq,
-        const std::deque<FootAbsolutePosition> & RightFootTraj_deq );
+    int update( const RingBuffer<support_state_t> & SupportStates_deq,
+        const RingBuffer<FootAbsolutePosition> & LeftFootTraj_deq,
+        const RingBuffer<FootAbsolutePosition> & RightFootTraj_deq );
 
     /// \brief Initialize dynamics of the body center
     /// Suppose a piecewise constant jerk
@@ -93,8 +93,8 @@ namespace PatternGeneratorJRL
     ///
     /// return 0
     int generate_trajectories( double time, const solution_t & Result,
-        const std::deque<support_state_t> & SupportStates_deq, const std::deque<double> & PreviewedSupportAngles_deq,
-              std::deque<FootAbsolutePosition> & LeftFootTraj_deq, std::deque<FootAbsolutePosition> & RightFootTraj_deq);
+        const RingBuffer<support_state_t> & SupportStates_deq, const RingBuffer<double> & PreviewedSupportAngles_deq,
+              RingBuffer<FootAbsolutePosition> & LeftFootTraj_deq, RingBuffer<FootAbsolutePosition> & RightFootTraj_deq);
 
     /// \name Accessors and mutators
     /// \{
@@ -152,7 +152,7 @@ namespace PatternGeneratorJRL
     inline void multiBody( bool multiBody )
     { multiBody_ = multiBody; }
 
-    std::deque<support_state_t> & SupportTrajectory()
+    RingBuffer<support_state_t> & SupportTrajectory()
     { return SupportTrajectory_deq_; }
     /// \}
 
@@ -183,7 +183,7 @@ namespace PatternGeneratorJRL
     /// \param[out] RightFootDynamics
     ///
     /// return 0
-    int compute_foot_zero_dynamics( const std::deque<support_state_t> & SupportStates_deq,
+    int compute_foot_zero_dynamics( const RingBuffer<support_state_t> & SupportStates_deq,
         linear_dynamics_t & LeftFootDynamics, linear_dynamics_t & RightFootDynamics);
 
     /// \brief Compute foot dynamics based on polynomial interpolation
@@ -193,7 +193,7 @@ namespace PatternGeneratorJRL
     /// \param[out] RightFootDynamics
     ///
     /// return 0
-    int compute_foot_pol_dynamics( const std::deque<support_state_t> & SupportStates_deq,
+    int compute_foot_pol_dynamics( const RingBuffer<support_state_t> & SupportStates_deq,
         linear_dynamics_t & LeftFootDynamics, linear_dynamics_t & RightFootDynamics);
 
     /// \brief Compute foot dynamics based on "piecewise constant jerk" splines
@@ -203,7 +203,7 @@ namespace PatternGeneratorJRL
     /// \param[out] RightFootDynamics
     ///
     /// return 0
-    int compute_foot_cjerk_dynamics( const std::deque<support_state_t> & SupportStates_deq,
+    int compute_foot_cjerk_dynamics( const RingBuffer<support_state_t> & SupportStates_deq,
         linear_dynamics_t & LeftFootDynamics, linear_dynamics_t & RightFootDynamics);
 
     /// \brief Initialize static trajectories
@@ -211,7 +211,7 @@ namespace PatternGeneratorJRL
 
     /// \brief Compute predefined trajectories
     /// \param[in] SupportStates_deq Previewed support states
-    int precompute_trajectories( const std::deque<support_state_t> & SupportStates_deq );
+    int precompute_trajectories( const RingBuffer<support_state_t> & SupportStates_deq );
 
     /// \brief Compute a row of the dynamic matrices Sp and Sa
     /// \param[out] Spbar
@@ -257,7 +257,7 @@ namespace PatternGeneratorJRL
     std::deque<rigid_body_state_t> FlyingFootTrajectory_deq_;
 
     /// \brief Support states
-    std::deque<support_state_t> SupportTrajectory_deq_;
+    RingBuffer<support_state_t> SupportTrajectory_deq_;
     // \}
 
     /// \brief Ground reaction force for the whole preview window
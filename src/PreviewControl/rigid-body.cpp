@@ -65,8 +65,8 @@ int RigidBody::initialize()
 
 // TODO: RigidBody::interpolate RigidBody::increment_state
 //int
-//RigidBody::interpolate(deque<COMState> &COMStates,
-//						deque<ZMPPosition> &ZMPRefPositions,
+//RigidBody::interpolate(RingBuffer<COMState> &COMStates,
+//						RingBuffer<ZMPPosition> &ZMPRefPositions,
 //						int CurrentPosition,
 //						double CX, double CY)
 //{
@@ -28,6 +28,7 @@
 
 
 #include <deque>
+#include <RingBuffer.hh>
 #include <jrl/walkgen/pgtypes.hh>
 #include <privatepgtypes.hh>
 
@@ -100,8 +101,8 @@ namespace PatternGeneratorJRL
     ~RigidBody();
 
     /// \brief Interpolate
-    int interpolate(std::deque<COMState> &COMStates,
-        std::deque<ZMPPosition> &ZMPRefPositions,
+    int interpolate(RingBuffer<COMState> &COMStates,
+        RingBuffer<ZMPPosition> &ZMPRefPositions,
         int CurrentPosition,
         double CX, double CY);
 
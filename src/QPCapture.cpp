@@ -0,0 +1,229 @@
+/*
+ * Copyright 2019,
+ *
+ * Olivier Stasse
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+
+/*! \file QPCapture.cpp
+    \brief Binary capture of the quadratic problems solved by the
+    generators.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <fstream>
+#include <iostream>
+
+#include <boost/thread/mutex.hpp>
+
+#include <QPCapture.hh>
+
+#include <Debug.hh>
+
+using namespace std;
+using namespace PatternGeneratorJRL;
+
+namespace
+{
+  const char QP_CAPTURE_MAGIC[8] = { 'J','R','L','Q','P','C','A','P' };
+  const unsigned int QP_CAPTURE_VERSION = 1;
+
+  /* Upper bound on the sizes read from a file. */
+  const int QP_CAPTURE_MAX_SIZE = 100000;
+
+  /* Bound written when the solver has none. */
+  const double QP_CAPTURE_NO_BOUND = 1e10;
+
+  template <typename T>
+  bool ReadArray(istream &aStream, vector<T> &anArray, unsigned int lSize)
+  {
+    anArray.resize(lSize);
+    if (lSize==0)
+      return true;
+    return (bool)aStream.read((char *)&anArray[0],lSize*sizeof(T));
+  }
+
+  template <typename T>
+  void WriteValue(ofstream &aStream, const T &aValue)
+  {
+    aStream.write((const char *)&aValue,sizeof(T));
+  }
+}
+
+struct QPCapture::Private
+{
+  /*! \brief Serializes the solvers of several threads. */
+  boost::mutex Mutex;
+  std::ofstream File;
+  /*! \brief Buffer to write the bounds and the compact DU. */
+  std::vector<double> Buffer;
+};
+
+void QPCaptureProblem::Hessian(vector<double> &aQ) const
+{
+  if (!IdentityHessian)
+    {
+      aQ = Q;
+      return;
+    }
+  aQ.assign(n*n,0.0);
+  for(int i=0;i<n;i++)
+    aQ[i+n*i] = 1.0;
+}
+
+QPCapture & QPCapture::Instance()
+{
+  static QPCapture aCapture;
+  return aCapture;
+}
+
+QPCapture::QPCapture():
+  m_Running(false),
+  m_NbOfRecords(0)
+{
+  m_Private = new Private;
+
+  const char * lFileName = getenv("JRL_WALKGEN_QP_CAPTURE");
+  if ((lFileName!=0) && (lFileName[0]!=0))
+    if (!Start(lFileName))
+      std::cerr << "Unable to create the QP capture "
+                << lFileName << std::endl;
+}
+
+QPCapture::~QPCapture()
+{
+  Stop();
+  delete m_Private;
+}
+
+bool QPCapture::Start(const string & FileName)
+{
+  Stop();
+  boost::mutex::scoped_lock lock(m_Private->Mutex);
+  m_Private->File.open(FileName.c_str(),ofstream::out | ofstream::binary);
+  if (!m_Private->File.is_open())
+    return false;
+
+  m_Private->File.write(QP_CAPTURE_MAGIC,sizeof(QP_CAPTURE_MAGIC));
+  WriteValue(m_Private->File,QP_CAPTURE_VERSION);
+  m_NbOfRecords.store(0);
+  m_Running.store(true);
+  return true;
+}
+
+void QPCapture::Stop()
+{
+  boost::mutex::scoped_lock lock(m_Private->Mutex);
+  m_Running.store(false);
+  if (m_Private->File.is_open())
+    m_Private->File.close();
+}
+
+void QPCapture::Record(unsigned int Source, double Time,
+                       int n, int m, int me,
+                       const double *Q, const double *D,
+                       const double *DU, int ldDU, const double *DS,
+                       const double *XL, const double *XU,
+                       const double *X, int Fail)
+{
+  if (!IsRunning())
+    return;
+
+  boost::mutex::scoped_lock lock(m_Private->Mutex);
+  ofstream & aFile = m_Private->File;
+  if (!aFile.is_open())
+    return;
+
+  unsigned int lIdentityHessian = (Q==0) ? 1 : 0;
+  WriteValue(aFile,Source);
+  WriteValue(aFile,Time);
+  WriteValue(aFile,n);
+  WriteValue(aFile,m);
+  WriteValue(aFile,me);
+  WriteValue(aFile,lIdentityHessian);
+  if (Q!=0)
+    aFile.write((const char *)Q,n*n*sizeof(double));
+  aFile.write((const char *)D,n*sizeof(double));
+
+  // DU is stored without its padding rows.
+  vector<double> & lBuffer = m_Private->Buffer;
+  lBuffer.resize(m*n > 2*n ? m*n : 2*n);
+  for(int j=0;j<n;j++)
+    for(int i=0;i<m;i++)
+      lBuffer[i+m*j] = DU[i+ldDU*j];
+  aFile.write((const char *)&lBuffer[0],m*n*sizeof(double));
+  aFile.write((const char *)DS,m*sizeof(double));
+
+  for(int i=0;i<n;i++)
+    {
+      lBuffer[i] = (XL!=0) ? XL[i] : -QP_CAPTURE_NO_BOUND;
+      lBuffer[i+n] = (XU!=0) ? XU[i] : QP_CAPTURE_NO_BOUND;
+    }
+  aFile.write((const char *)&lBuffer[0],2*n*sizeof(double));
+  aFile.write((const char *)X,n*sizeof(double));
+  WriteValue(aFile,Fail);
+  m_NbOfRecords++;
+}
+
+bool QPCapture::ReadHeader(istream &aStream)
+{
+  char lMagic[sizeof(QP_CAPTURE_MAGIC)];
+  unsigned int lVersion=0;
+  if (!aStream.read(lMagic,sizeof(lMagic)) ||
+      (memcmp(lMagic,QP_CAPTURE_MAGIC,sizeof(lMagic))!=0))
+    return false;
+  if (!aStream.read((char *)&lVersion,sizeof(lVersion)) ||
+      (lVersion!=QP_CAPTURE_VERSION))
+    return false;
+  return true;
+}
+
+bool QPCapture::ReadProblem(istream &aStream, QPCaptureProblem &aProblem)
+{
+  unsigned int lIdentityHessian=0;
+  if (!aStream.read((char *)&aProblem.Source,sizeof(aProblem.Source)))
+    return false;
+  aStream.read((char *)&aProblem.Time,sizeof(aProblem.Time));
+  aStream.read((char *)&aProblem.n,sizeof(aProblem.n));
+  aStream.read((char *)&aProblem.m,sizeof(aProblem.m));
+  aStream.read((char *)&aProblem.me,sizeof(aProblem.me));
+  aStream.read((char *)&lIdentityHessian,sizeof(lIdentityHessian));
+  if (!aStream)
+    return false;
+
+  int n = aProblem.n, m = aProblem.m;
+  if ((n<=0) || (n>QP_CAPTURE_MAX_SIZE) ||
+      (m<0) || (m>QP_CAPTURE_MAX_SIZE) ||
+      (aProblem.me<0) || (aProblem.me>m))
+    return false;
+
+  aProblem.IdentityHessian = (lIdentityHessian!=0);
+  if (!ReadArray(aStream,aProblem.Q,aProblem.IdentityHessian ? 0 : n*n) ||
+      !ReadArray(aStream,aProblem.D,n) ||
+      !ReadArray(aStream,aProblem.DU,m*n) ||
+      !ReadArray(aStream,aProblem.DS,m) ||
+      !ReadArray(aStream,aProblem.XL,n) ||
+      !ReadArray(aStream,aProblem.XU,n) ||
+      !ReadArray(aStream,aProblem.X,n))
+    return false;
+  return (bool)aStream.read((char *)&aProblem.Fail,sizeof(aProblem.Fail));
+}
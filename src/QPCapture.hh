@@ -0,0 +1,147 @@
+/*
+ * Copyright 2019,
+ *
+ * Olivier Stasse
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+
+/*! \file QPCapture.hh
+    \brief Binary capture of the quadratic problems solved by the
+    generators, to replay them off-line.
+*/
+#ifndef _HWPG_QP_CAPTURE_H_
+# define _HWPG_QP_CAPTURE_H_
+
+#include <istream>
+#include <string>
+#include <vector>
+
+#include <boost/atomic.hpp>
+
+namespace PatternGeneratorJRL
+{
+  /*! \brief Solver call which produced a captured problem. */
+  enum QPCaptureSource
+  {
+    /*! QPProblem::solve (Herdt 2010 and its variants). */
+    QP_CAPTURE_QPPROBLEM=0,
+    /*! QP of one SQP iteration of NMPCgenerator (Naveau 2015). */
+    QP_CAPTURE_NMPC=1,
+    /*! ZMPConstrainedQPFastFormulation (Dimitrov 2008), solved by QLD
+      or by the PLDP solver. The PLDP problems have an identity Hessian. */
+    QP_CAPTURE_DIMITROV=2,
+    /*! ZMPQPWithConstraint (Wieber 2006). */
+    QP_CAPTURE_WIEBER=3
+  };
+
+  /*! \brief One captured problem, with the layout of QLD:
+    \f$ \min \frac{1}{2} x^T Q x + D^T x \f$ such that
+    \f$ DU_i x + DS_i = 0 \f$ for the first me rows,
+    \f$ DU_i x + DS_i \geq 0 \f$ for the others, and
+    \f$ XL \leq x \leq XU \f$. */
+  struct QPCaptureProblem
+  {
+    unsigned int Source;
+    double Time;
+    int n, m, me;
+    /*! \brief Q is the identity and is not stored. */
+    bool IdentityHessian;
+    /*! \brief Column major, \f$ n \times n \f$. */
+    std::vector<double> Q;
+    std::vector<double> D;
+    /*! \brief Column major, \f$ m \times n \f$. */
+    std::vector<double> DU;
+    std::vector<double> DS;
+    std::vector<double> XL, XU;
+    /*! \brief Solution found during the capture and the report of
+      the solver (0 on success). */
+    std::vector<double> X;
+    int Fail;
+
+    /*! \brief Hessian as a dense matrix, identity included. */
+    void Hessian(std::vector<double> &aQ) const;
+  };
+
+  /*! \brief Process-wide recorder of the problems solved by the
+    generators.
+
+    The QP solvers call Record() after each solve. Nothing is done but
+    reading a flag unless the capture is started, either by Start() or
+    by setting the environment variable JRL_WALKGEN_QP_CAPTURE to the
+    name of the file before the first problem is solved. The latter
+    records any test run without changing it.
+
+    The file holds a header, then one record per problem as described
+    by QPCaptureProblem. The solvers of several threads can record in
+    the same file, a lock serializes them.
+  */
+  class QPCapture
+  {
+  public:
+    /*! \brief The capture shared by all the solvers. */
+    static QPCapture & Instance();
+
+    ~QPCapture();
+
+    /*! \brief Create FileName and start recording.
+      Returns false if the file cannot be created. */
+    bool Start(const std::string & FileName);
+
+    /*! \brief Stop recording and close the file. */
+    void Stop();
+
+    inline bool IsRunning() const
+    { return m_Running.load(boost::memory_order_relaxed); }
+
+    /*! \brief Append a problem with the arrays of QLD.
+      DU has a leading dimension of ldDU. Q may be null for the
+      identity, XL and XU may be null when there is no bound. */
+    void Record(unsigned int Source, double Time,
+                int n, int m, int me,
+                const double *Q, const double *D,
+                const double *DU, int ldDU, const double *DS,
+                const double *XL, const double *XU,
+                const double *X, int Fail);
+
+    /*! \brief Number of problems recorded since Start(). */
+    inline unsigned long int NbOfRecords() const
+    { return m_NbOfRecords.load(); }
+
+    /*! \brief Check the header of a capture.
+      @return false if the stream is not a capture. */
+    static bool ReadHeader(std::istream &aStream);
+
+    /*! \brief Read the next problem of a capture.
+      @return false at the end of the stream. */
+    static bool ReadProblem(std::istream &aStream,
+                            QPCaptureProblem &aProblem);
+
+  protected:
+    QPCapture();
+
+    boost::atomic<bool> m_Running;
+    boost::atomic<unsigned long int> m_NbOfRecords;
+
+    /*! \brief Members hiding the threading types. */
+    struct Private;
+    Private * m_Private;
+  };
+}
+#endif /* _HWPG_QP_CAPTURE_H_ */
@@ -0,0 +1,294 @@
+/*
+ * Copyright 2019,
+ *
+ * Olivier Stasse
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+
+/*! \file RingBuffer.hh
+    \brief Contiguous circular buffer used for the trajectory buffers.
+*/
+#ifndef _HWPG_RING_BUFFER_H_
+# define _HWPG_RING_BUFFER_H_
+
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <vector>
+
+namespace PatternGeneratorJRL
+{
+  /*! \brief Circular buffer with the interface of std::deque
+    used by the pattern generator.
+
+    The elements are stored in a single contiguous block whose
+    size is a power of two. Pushing at one end and popping at the other
+    end only moves indexes: once the capacity is large enough
+    (see reserve()) the buffer does not allocate anymore.
+    If the capacity is exceeded, the storage is doubled and
+    the elements are copied, so that the behavior of std::deque
+    is kept.
+
+    The elements are not destroyed when they are popped,
+    they are overwritten by the next push. T has to be
+    default constructible and copyable.
+  */
+  template <typename T>
+  class RingBuffer
+  {
+  public:
+    typedef T value_type;
+    typedef T & reference;
+    typedef const T & const_reference;
+    typedef T * pointer;
+    typedef const T * const_pointer;
+    typedef std::size_t size_type;
+    typedef std::ptrdiff_t difference_type;
+
+    /*! \brief Random access iterator on the logical sequence. */
+    template <typename Buffer, typename Value>
+    class Iterator
+    {
+    public:
+      typedef std::random_access_iterator_tag iterator_category;
+      typedef T value_type;
+      typedef std::ptrdiff_t difference_type;
+      typedef Value * pointer;
+      typedef Value & reference;
+
+      Iterator(): m_Buffer(0), m_Index(0) {}
+      Iterator(Buffer * aBuffer, size_type anIndex):
+        m_Buffer(aBuffer), m_Index(anIndex) {}
+
+      /*! Conversion from iterator to const_iterator. */
+      template <typename OtherBuffer, typename OtherValue>
+      Iterator(const Iterator<OtherBuffer,OtherValue> & other):
+        m_Buffer(other.m_Buffer), m_Index(other.m_Index) {}
+
+      reference operator*() const
+      { return (*m_Buffer)[m_Index]; }
+      pointer operator->() const
+      { return &(*m_Buffer)[m_Index]; }
+      reference operator[](difference_type n) const
+      { return (*m_Buffer)[m_Index+n]; }
+
+      Iterator & operator++() { m_Index++; return *this; }
+      Iterator & operator--() { m_Index--; return *this; }
+      Iterator operator++(int)
+      { Iterator r(*this); m_Index++; return r; }
+      Iterator operator--(int)
+      { Iterator r(*this); m_Index--; return r; }
+      Iterator & operator+=(difference_type n)
+      { m_Index+=n; return *this; }
+      Iterator & operator-=(difference_type n)
+      { m_Index-=n; return *this; }
+      Iterator operator+(difference_type n) const
+      { return Iterator(m_Buffer,m_Index+n); }
+      Iterator operator-(difference_type n) const
+      { return Iterator(m_Buffer,m_Index-n); }
+      friend Iterator operator+(difference_type n, const Iterator & it)
+      { return it+n; }
+      difference_type operator-(const Iterator & other) const
+      { return (difference_type)m_Index - (difference_type)other.m_Index; }
+
+      bool operator==(const Iterator & other) const
+      { return m_Index==other.m_Index; }
+      bool operator!=(const Iterator & other) const
+      { return m_Index!=other.m_Index; }
+      bool operator<(const Iterator & other) const
+      { return m_Index<other.m_Index; }
+      bool operator>(const Iterator & other) const
+      { return m_Index>other.m_Index; }
+      bool operator<=(const Iterator & other) const
+      { return m_Index<=other.m_Index; }
+      bool operator>=(const Iterator & other) const
+      { return m_Index>=other.m_Index; }
+
+      Buffer * m_Buffer;
+      size_type m_Index;
+    };
+
+    typedef Iterator<RingBuffer,T> iterator;
+    typedef Iterator<const RingBuffer,const T> const_iterator;
+
+    RingBuffer():
+      m_Head(0), m_Size(0), m_Mask(0)
+    {}
+
+    explicit RingBuffer(size_type n, const T & value = T()):
+      m_Head(0), m_Size(0), m_Mask(0)
+    {
+      resize(n,value);
+    }
+
+    RingBuffer(const RingBuffer & other):
+      m_Head(0), m_Size(0), m_Mask(0)
+    {
+      *this = other;
+    }
+
+    /*! \brief Copy the elements of other.
+      No allocation if the capacity is large enough. */
+    RingBuffer & operator=(const RingBuffer & other)
+    {
+      if (this==&other)
+        return *this;
+      reserve(other.m_Size);
+      for(size_type i=0;i<other.m_Size;i++)
+        m_Data[i] = other[i];
+      m_Head = 0;
+      m_Size = other.m_Size;
+      return *this;
+    }
+
+    /*! \name Element access.
+      @{ */
+    reference operator[](size_type i)
+    {
+      assert(i<m_Size);
+      return m_Data[(m_Head+i) & m_Mask];
+    }
+    const_reference operator[](size_type i) const
+    {
+      assert(i<m_Size);
+      return m_Data[(m_Head+i) & m_Mask];
+    }
+    reference front() { return (*this)[0]; }
+    const_reference front() const { return (*this)[0]; }
+    reference back() { return (*this)[m_Size-1]; }
+    const_reference back() const { return (*this)[m_Size-1]; }
+    /*! @} */
+
+    /*! \name Iterators.
+      @{ */
+    iterator begin() { return iterator(this,0); }
+    iterator end() { return iterator(this,m_Size); }
+    const_iterator begin() const { return const_iterator(this,0); }
+    const_iterator end() const { return const_iterator(this,m_Size); }
+    /*! @} */
+
+    /*! \name Capacity.
+      @{ */
+    size_type size() const { return m_Size; }
+    bool empty() const { return m_Size==0; }
+    size_type capacity() const { return m_Data.size(); }
+
+    /*! \brief Make sure that n elements can be stored
+      without any allocation. */
+    void reserve(size_type n)
+    {
+      if (n<=m_Data.size())
+        return;
+      size_type lCapacity = m_Data.empty() ? 16 : m_Data.size();
+      while(lCapacity<n)
+        lCapacity*=2;
+
+      std::vector<T> lData(lCapacity);
+      for(size_type i=0;i<m_Size;i++)
+        lData[i] = (*this)[i];
+      m_Data.swap(lData);
+      m_Head = 0;
+      m_Mask = lCapacity-1;
+    }
+    /*! @} */
+
+    /*! \name Modifiers.
+      @{ */
+    void clear()
+    {
+      m_Head = 0;
+      m_Size = 0;
+    }
+
+    void push_back(const T & value)
+    {
+      if (m_Size==m_Data.size())
+        reserve(m_Size+1);
+      m_Data[(m_Head+m_Size) & m_Mask] = value;
+      m_Size++;
+    }
+
+    void push_front(const T & value)
+    {
+      if (m_Size==m_Data.size())
+        reserve(m_Size+1);
+      m_Head = (m_Head-1) & m_Mask;
+      m_Data[m_Head] = value;
+      m_Size++;
+    }
+
+    void pop_front()
+    {
+      assert(m_Size>0);
+      m_Head = (m_Head+1) & m_Mask;
+      m_Size--;
+    }
+
+    void pop_back()
+    {
+      assert(m_Size>0);
+      m_Size--;
+    }
+
+    /*! \brief Same semantic than std::deque::resize:
+      the new elements are copies of value. */
+    void resize(size_type n, const T & value = T())
+    {
+      reserve(n);
+      for(size_type i=m_Size;i<n;i++)
+        m_Data[(m_Head+i) & m_Mask] = value;
+      m_Size = n;
+    }
+
+    /*! \brief Remove the elements in [first,last). */
+    iterator erase(iterator first, iterator last)
+    {
+      size_type lFirst = first.m_Index;
+      size_type lNb = last.m_Index - first.m_Index;
+      if (lFirst==0)
+      {
+        m_Head = (m_Head+lNb) & m_Mask;
+        m_Size -= lNb;
+        return begin();
+      }
+      for(size_type i=lFirst;i+lNb<m_Size;i++)
+        (*this)[i] = (*this)[i+lNb];
+      m_Size -= lNb;
+      return iterator(this,lFirst);
+    }
+
+    iterator erase(iterator position)
+    {
+      return erase(position,position+1);
+    }
+    /*! @} */
+
+  protected:
+    /*! Storage, its size is the capacity. */
+    std::vector<T> m_Data;
+    /*! Index of the first element in m_Data. */
+    size_type m_Head;
+    /*! Number of elements. */
+    size_type m_Size;
+    /*! Capacity minus one, the capacity being a power of two. */
+    size_type m_Mask;
+  };
+}
+#endif /* _HWPG_RING_BUFFER_H_ */
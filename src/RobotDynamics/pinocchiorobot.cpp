@@ -473,6 +473,22 @@ computeInverseDynamics
 (Eigen::VectorXd & q,
  Eigen::VectorXd & v,
  Eigen::VectorXd & a)
+{
+  toPinocchioState(q,v,a,m_quat,m_rot,m_q,m_v,m_a);
+  // performing the inverse dynamics
+  m_tau = pinocchio::rnea(*m_robotModel,*m_robotData,m_q,m_v,m_a);
+}
+
+void PinocchioRobot::
+toPinocchioState
+(const Eigen::VectorXd & q,
+ const Eigen::VectorXd & v,
+ const Eigen::VectorXd & a,
+ Eigen::Quaterniond & quat,
+ Eigen::Matrix3d & rot,
+ Eigen::VectorXd & qp,
+ Eigen::VectorXd & vp,
+ Eigen::VectorXd & ap) const
 {
   //  for(unsigned i=0;i<3;++i)
   //  {
@@ -483,38 +499,64 @@ computeInverseDynamics
   //  RPYToSpatialFreeFlyer(m_rpy,m_drpy,m_ddrpy,
   //                        m_quat,m_omega,m_domega);
   // euler to quaternion :
-  m_quat = Eigen::Quaterniond(
-			      Eigen::AngleAxisd(q(5), Eigen::Vector3d::UnitZ()) *
-			      Eigen::AngleAxisd(q(4), Eigen::Vector3d::UnitY()) *
-			      Eigen::AngleAxisd(q(3), Eigen::Vector3d::UnitX()) ) ;
+  quat = Eigen::Quaterniond(
+			    Eigen::AngleAxisd(q(5), Eigen::Vector3d::UnitZ()) *
+			    Eigen::AngleAxisd(q(4), Eigen::Vector3d::UnitY()) *
+			    Eigen::AngleAxisd(q(3), Eigen::Vector3d::UnitX()) ) ;
   for(unsigned i=0; i<3 ; ++i)
     {
-      m_q(i) = q(i);
-      m_v(i) = v(i);
-      m_a(i) = a(i);
+      qp(i) = q(i);
+      vp(i) = v(i);
+      ap(i) = a(i);
     }
-  m_rot = m_quat.toRotationMatrix().transpose() ;
-  m_v.segment<3>(0) = m_rot * m_v.segment<3>(0) ;
-  m_a.segment<3>(0) = m_rot * m_a.segment<3>(0) ;
+  rot = quat.toRotationMatrix().transpose() ;
+  vp.segment<3>(0) = rot * vp.segment<3>(0) ;
+  ap.segment<3>(0) = rot * ap.segment<3>(0) ;
 
-  // fill up m_q following the pinocchio standard : [pos quarternion DoFs]
-  m_q(3) = m_quat.x() ;
-  m_q(4) = m_quat.y() ;
-  m_q(5) = m_quat.z() ;
-  m_q(6) = m_quat.w() ;
+  // fill up qp following the pinocchio standard : [pos quarternion DoFs]
+  qp(3) = quat.x() ;
+  qp(4) = quat.y() ;
+  qp(5) = quat.z() ;
+  qp(6) = quat.w() ;
 
   // fill up the velocity and acceleration vectors
-  //m_v.segment<3>(3) = m_omega ;
-  //m_a.segment<3>(3) = m_domega ;
+  //vp.segment<3>(3) = m_omega ;
+  //ap.segment<3>(3) = m_domega ;
 
   for(int i=6; i<m_robotModel->nv-6 ; ++i)
     {
-      m_q(1+i) = q(i);
-      m_v(i)   = v(i);
-      m_a(i)   = a(i);
+      qp(1+i) = q(i);
+      vp(i)   = v(i);
+      ap(i)   = a(i);
     }
-  // performing the inverse dynamics
-  m_tau = pinocchio::rnea(*m_robotModel,*m_robotData,m_q,m_v,m_a);
+}
+
+void PinocchioRobot::
+zeroMomentumPoint
+(const Eigen::VectorXd & q,
+ const Eigen::VectorXd & v,
+ const Eigen::VectorXd & a,
+ pinocchio::Data & aData,
+ Eigen::VectorXd & qp,
+ Eigen::VectorXd & vp,
+ Eigen::VectorXd & ap,
+ Eigen::Vector3d & zmp) const
+{
+  // Same state as computeInverseDynamics: the entries which are not
+  // set by toPinocchioState are the ones of the robot.
+  qp = m_q ;
+  vp = m_v ;
+  ap = m_a ;
+  Eigen::Quaterniond lQuat ;
+  Eigen::Matrix3d lRot ;
+  toPinocchioState(q,v,a,lQuat,lRot,qp,vp,ap);
+
+  pinocchio::rnea(*m_robotModel,aData,qp,vp,ap);
+
+  pinocchio::Force lExternalForces = aData.liMi[1].act(aData.f[1]);
+  zmp(0) = -lExternalForces.angular()(1)/lExternalForces.linear()(2) ;
+  zmp(1) =  lExternalForces.angular()(0)/lExternalForces.linear()(2) ;
+  zmp(2) = 0.0 ;
 }
 
 std::vector<pinocchio::JointIndex>
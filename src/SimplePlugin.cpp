@@ -40,6 +40,35 @@ bool SimplePlugin::RegisterMethod(string &MethodName)
   return r;
 }
 
+bool SimplePlugin::RegisterMethod(string &MethodName, int MethodId)
+{
+  m_MethodIds[MethodName] = MethodId;
+  return RegisterMethod(MethodName);
+}
+
+int SimplePlugin::MethodId(const string &MethodName) const
+{
+  map<string,int>::const_iterator it = m_MethodIds.find(MethodName);
+  if (it==m_MethodIds.end())
+    return -1;
+  return it->second;
+}
+
+bool SimplePlugin::CallTypedMethod(int ,
+                                   const CommandArguments & )
+{
+  return false;
+}
+
+void SimplePlugin::ReadArguments(istringstream &strm,
+                                 CommandArguments &Arguments)
+{
+  double aValue;
+  while((Arguments.size()<CommandArguments::MAX_NB_OF_ARGUMENTS) &&
+        (strm >> aValue))
+    Arguments.push_back(aValue);
+}
+
 SimplePlugin::~SimplePlugin()
 {
   if (m_SimplePluginManager!=0)
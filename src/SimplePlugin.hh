@@ -30,9 +30,12 @@
 #ifndef _PGI_SIMPLE_PLUGIN_H_
 #define _PGI_SIMPLE_PLUGIN_H_
 
+#include <map>
 #include <string>
 #include <sstream>
 
+#include <jrl/walkgen/pgtypes.hh>
+
 
 namespace PatternGeneratorJRL
 {
@@ -49,6 +52,10 @@ namespace PatternGeneratorJRL
   private:
     SimplePluginManager * m_SimplePluginManager;
     friend class SimplePluginManager;
+
+    /*! Identifiers given to the methods registered with a typed
+      implementation. */
+    std::map<std::string, int> m_MethodIds;
     
   public:
     
@@ -62,10 +69,32 @@ namespace PatternGeneratorJRL
     /*! \name Register the method for which this object can be called
       by a higher parser. */
     bool RegisterMethod(std::string &MethodName);
-    
+
+    /*! \brief Register a method which is also implemented by
+      CallTypedMethod() with the identifier MethodId (positive or null). */
+    bool RegisterMethod(std::string &MethodName, int MethodId);
+
+    /*! \brief Identifier given to MethodName when it was registered,
+      -1 if it has no typed implementation. */
+    int MethodId(const std::string &MethodName) const;
+
     /*! \name Virtual method to redispatch the method. */
     virtual void CallMethod(std::string &Method, std::istringstream & astrm) = 0;
+
+    /*! \brief Virtual method to redispatch a method resolved beforehand,
+      without any parsing.
+      Returns false if the method has no typed implementation, in which
+      case the plugin manager falls back on CallMethod(). */
+    virtual bool CallTypedMethod(int MethodId,
+                                 const CommandArguments & Arguments);
     
+    /*! \brief Read numerical arguments from a string command
+      until the end of the stream or a non numerical value.
+      Used by the string interface to forward a command to
+      CallTypedMethod(). */
+    static void ReadArguments(std::istringstream &strm,
+                              CommandArguments &Arguments);
+
     /*! \name Get the simple plugin manager */
     SimplePluginManager * getSimplePluginManager() const
       { return m_SimplePluginManager; } 
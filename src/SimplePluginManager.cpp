@@ -40,7 +40,8 @@ using namespace std;
 
 using namespace PatternGeneratorJRL;
 
-SimplePluginManager::SimplePluginManager()
+SimplePluginManager::SimplePluginManager():
+  m_ResolvedCommandsOutdated(false)
 {
   RESETDEBUG5("PgDebug.txt");
 }
@@ -78,7 +79,7 @@ void SimplePluginManager::UnregisterPlugin(SimplePlugin* aSimplePlugin)
       else 
 	it_SP++;
     }
-  
+  m_ResolvedCommandsOutdated = true;
 }
 
 void SimplePluginManager::Print( )
@@ -103,6 +104,7 @@ bool SimplePluginManager::RegisterMethod(string &MethodName, SimplePlugin *aSP)
      how is handle the memory towards MethodName.c_str() */
 
   m_SimplePlugins.insert(pair < string, SimplePlugin * > (MethodName,aSP));
+  m_ResolvedCommandsOutdated = true;
 
   ODEBUG5("Registered method " << MethodName <<
 	  " for plugin " << aSP << endl,"PgDebug.txt");
@@ -167,3 +169,78 @@ bool SimplePluginManager::CallMethod(string &MethodName, istringstream &istrm)
   return FoundAPlugin;
   
 }
+
+void SimplePluginManager::ResolvePlugins(ResolvedCommand & aCommand)
+{
+  pair <std::multimap<std::string, SimplePlugin * , ltstr>::iterator,
+    std::multimap<std::string, SimplePlugin * , ltstr>::iterator >
+    RangeOfPlugins  = m_SimplePlugins.equal_range(aCommand.Name);
+
+  aCommand.Plugins.clear();
+  aCommand.MethodIds.clear();
+  for (std::multimap<std::string, SimplePlugin * , ltstr>::iterator
+         CurrentPlugin = RangeOfPlugins.first;
+       CurrentPlugin != RangeOfPlugins.second;
+       ++CurrentPlugin)
+    {
+      SimplePlugin * aSP = CurrentPlugin->second;
+      if (aSP==0)
+	continue;
+      aCommand.Plugins.push_back(aSP);
+      aCommand.MethodIds.push_back(aSP->MethodId(aCommand.Name));
+    }
+}
+
+void SimplePluginManager::UpdateResolvedCommands()
+{
+  for(unsigned int i=0;i<m_ResolvedCommands.size();i++)
+    ResolvePlugins(m_ResolvedCommands[i]);
+  m_ResolvedCommandsOutdated = false;
+}
+
+CommandHandle SimplePluginManager::ResolveCommand(const string &MethodName)
+{
+  if (m_SimplePlugins.find(MethodName)==m_SimplePlugins.end())
+    return -1;
+
+  for(unsigned int i=0;i<m_ResolvedCommands.size();i++)
+    if (m_ResolvedCommands[i].Name==MethodName)
+      return (CommandHandle)i;
+
+  ResolvedCommand aCommand;
+  aCommand.Name = MethodName;
+  ResolvePlugins(aCommand);
+  m_ResolvedCommands.push_back(aCommand);
+
+  ODEBUG5("Resolved method " << MethodName << " to handle "
+	  << m_ResolvedCommands.size()-1,"PgDebug.txt");
+  return (CommandHandle)(m_ResolvedCommands.size()-1);
+}
+
+/*! \name Call a resolved method. */
+bool SimplePluginManager::CallMethod(CommandHandle aHandle,
+				     const CommandArguments &Arguments)
+{
+  if ((aHandle<0) || ((unsigned int)aHandle>=m_ResolvedCommands.size()))
+    return false;
+
+  if (m_ResolvedCommandsOutdated)
+    UpdateResolvedCommands();
+
+  ResolvedCommand & aCommand = m_ResolvedCommands[aHandle];
+  for(unsigned int i=0;i<aCommand.Plugins.size();i++)
+    {
+      SimplePlugin * aSP = aCommand.Plugins[i];
+      if ((aCommand.MethodIds[i]>=0) &&
+	  (aSP->CallTypedMethod(aCommand.MethodIds[i],Arguments)))
+	continue;
+
+      // Fall back on the string interface.
+      ostringstream oss;
+      oss.precision(17);
+      oss << Arguments;
+      istringstream iss(oss.str());
+      aSP->CallMethod(aCommand.Name,iss);
+    }
+  return !aCommand.Plugins.empty();
+}
@@ -33,10 +33,14 @@
 #include <string.h>
 
 #include <map>
+#include <vector>
 #include <iostream>
 #include <string>
 #include <sstream>
 
+#include <jrl/walkgen/pgtypes.hh>
+#include <LatencyHistogram.hh>
+
 
 
 namespace PatternGeneratorJRL
@@ -68,6 +72,31 @@ namespace PatternGeneratorJRL
     /*! Set of plugins sorted by names */
     std::multimap<std::string, SimplePlugin *, ltstr>  m_SimplePlugins;
 
+    /*! Plugins and method identifiers found for a resolved command. */
+    struct ResolvedCommand
+    {
+      std::string Name;
+      std::vector<SimplePlugin *> Plugins;
+      std::vector<int> MethodIds;
+    };
+
+    /*! Commands resolved so far, indexed by their handle. */
+    std::vector<ResolvedCommand> m_ResolvedCommands;
+
+    /*! True if plugins have been registered or unregistered since
+      the commands have been resolved. */
+    bool m_ResolvedCommandsOutdated;
+
+    /*! Look again for the plugins of all the resolved commands. */
+    void UpdateResolvedCommands();
+
+    /*! Look for the plugins of one command. */
+    void ResolvePlugins(ResolvedCommand & aCommand);
+
+    /*! Latency of the stages of the control cycle, fed by
+      the objects managed by this one. */
+    LatencyProfile m_LatencyProfile;
+
   public: 
     
     /*! \brief Pointer towards the PGI which is handling this object. */
@@ -88,8 +117,25 @@ namespace PatternGeneratorJRL
     /*! \name Call the method from the Method name. */
     bool CallMethod(std::string &MethodName, std::istringstream &istrm);
 
+    /*! \brief Resolve the method name once for all.
+      The handle stays valid when plugins are registered or unregistered.
+      Returns -1 if no plugin has registered the method. */
+    CommandHandle ResolveCommand(const std::string &MethodName);
+
+    /*! \brief Call a resolved method with typed arguments.
+      The plugins which do not implement the method in
+      SimplePlugin::CallTypedMethod() receive the arguments through
+      the string interface.
+      Returns false if the handle is invalid or no plugin handles it. */
+    bool CallMethod(CommandHandle aHandle,
+                    const CommandArguments &Arguments);
+
     /*! \name Operator to display in cout. */
     void Print();
+
+    /*! \brief Latency of the stages of the control cycle. */
+    LatencyProfile * GetLatencyProfile()
+      { return &m_LatencyProfile; }
     
   };
 }
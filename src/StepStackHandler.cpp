@@ -33,6 +33,7 @@
 #define rad2deg(x) x*180.0/M_PI
 
 #include <Debug.hh>
+#include <TraceRecorder.hh>
 #include <StepStackHandler.hh>
 
 using namespace::PatternGeneratorJRL;
@@ -97,6 +98,28 @@ std::size_t StepStackHandler::ReturnStackSize()
   return m_RelativeFootPositions.size();
 }
 
+void StepStackHandler::GetState(StepStackHandlerState &aState) const
+{
+  aState.RelativeFootPositions = m_RelativeFootPositions;
+  aState.KeepLastCorrectSupportFoot = m_KeepLastCorrectSupportFoot;
+  aState.WalkMode = m_WalkMode;
+  aState.SingleSupportTime = m_SingleSupportTime;
+  aState.DoubleSupportTime = m_DoubleSupportTime;
+  aState.OnLineSteps = m_OnLineSteps;
+  aState.TransitionFinishOnLine = m_TransitionFinishOnLine;
+}
+
+void StepStackHandler::SetState(const StepStackHandlerState &aState)
+{
+  m_RelativeFootPositions = aState.RelativeFootPositions;
+  m_KeepLastCorrectSupportFoot = aState.KeepLastCorrectSupportFoot;
+  m_WalkMode = aState.WalkMode;
+  m_SingleSupportTime = aState.SingleSupportTime;
+  m_DoubleSupportTime = aState.DoubleSupportTime;
+  m_OnLineSteps = aState.OnLineSteps;
+  m_TransitionFinishOnLine = aState.TransitionFinishOnLine;
+}
+
 void StepStackHandler::
 CopyRelativeFootPosition
 (deque<RelativeFootPosition> &lRelativeFootPositions,
@@ -560,16 +583,8 @@ CreateArcCenteredInStepStack
   OmegaStep = StepMax/R;
   LastOmegaStep = OmegaTotal - OmegaStep*NumberOfStep;
 
-#if 0
-  ofstream DebugFile;
-  DebugFile.open("/tmp/output.txt",ofstream::out);
-  DebugFile << NumberOfStep << " "
-	    << OmegaStep << " "
-	    << LastOmegaStep<< " "
-	    << arc_deg<< " "
-	    << endl;
-  DebugFile.close();
-#endif
+  OTRACE(NumberOfStep << " " << OmegaStep << " "
+         << LastOmegaStep << " " << arc_deg,"output.txt");
 
   cosOmegaStep = cos(OmegaStep);
   sinOmegaStep = sin(OmegaStep);
@@ -585,14 +600,8 @@ CreateArcCenteredInStepStack
       aFootPosition.DStime = m_DoubleSupportTime;
 
       m_RelativeFootPositions.push_back(aFootPosition);
-#if 0
-      DebugFile.open("/tmp/output.txt",ofstream::app);
-      DebugFile << aFootPosition.sx<< " "
-		<< aFootPosition.sy<< " "
-		<< aFootPosition.theta<< " "
-		<< endl;
-      DebugFile.close();
-#endif
+      OTRACE(aFootPosition.sx << " " << aFootPosition.sy << " "
+             << aFootPosition.theta,"output.txt");
 
       SupportFoot=-SupportFoot;
     }
@@ -646,12 +655,7 @@ CreateArcCenteredInStepStack
   MFNSF(1,2)=S;
   MSupportFoot=MFSF;
   Mtmp(1,2) = 0.19;
-#if 0
-  DebugFile.open("/tmp/outputNL.txt",ofstream::app);
-  DebugFile << MSupportFoot(0,2) << " "
-	    << MSupportFoot(1,2) << endl;
-  DebugFile.close();
-#endif
+  OTRACE(MSupportFoot(0,2) << " " << MSupportFoot(1,2),"outputNL.txt");
   ODEBUG("MSupportFoot  "<< endl << MSupportFoot );
   ODEBUG( "Romegastep " << endl << Romegastep );
   for(int i=0;i<NumberOfStep;i++)
@@ -690,20 +694,9 @@ CreateArcCenteredInStepStack
       m_RelativeFootPositions.push_back(aFootPosition);
       MSupportFoot=Romega+MFNSF;
 
-#if 0
-      DebugFile.open("/tmp/outputL.txt",ofstream::app);
-      DebugFile << MSupportFoot(0,2) << " "
-		<< MSupportFoot(1,2) << " "
-		<< endl;
-      DebugFile.close();
-
-      DebugFile.open("/tmp/output.txt",ofstream::app);
-      DebugFile << aFootPosition.sx<< " "
-		<< aFootPosition.sy<< " "
-		<< aFootPosition.theta<< " "
-		<< endl;
-      DebugFile.close();
-#endif
+      OTRACE(MSupportFoot(0,2) << " " << MSupportFoot(1,2),"outputL.txt");
+      OTRACE(aFootPosition.sx << " " << aFootPosition.sy << " "
+             << aFootPosition.theta,"output.txt");
       aFootPosition.sx = 0;
       aFootPosition.sy = SupportFoot*0.19;
       aFootPosition.theta = 0;
@@ -711,14 +704,8 @@ CreateArcCenteredInStepStack
       aFootPosition.DStime = m_DoubleSupportTime;
 
       m_RelativeFootPositions.push_back(aFootPosition);
-#if 0
-      DebugFile.open("/tmp/output.txt",ofstream::app);
-      DebugFile << aFootPosition.sx<< " "
-		<< aFootPosition.sy<< " "
-		<< aFootPosition.theta<< " "
-		<< endl;
-      DebugFile.close();
-#endif
+      OTRACE(aFootPosition.sx << " " << aFootPosition.sy << " "
+             << aFootPosition.theta,"output.txt");
       /*
 	for(int li=0;li<2;li++)
 	for(int lj=0;lj<2;lj++)
@@ -728,12 +715,7 @@ CreateArcCenteredInStepStack
       */
       MSupportFoot =  MSupportFoot*Mtmp;
 
-#if 0
-      DebugFile.open("/tmp/outputNL.txt",ofstream::app);
-      DebugFile << MSupportFoot(0,2) << " "
-		<< MSupportFoot(1,2) << endl;
-      DebugFile.close();
-#endif
+      OTRACE(MSupportFoot(0,2) << " " << MSupportFoot(1,2),"outputNL.txt");
 
     }
 
@@ -783,20 +765,9 @@ CreateArcCenteredInStepStack
       m_RelativeFootPositions.push_back(aFootPosition);
       MSupportFoot=Romega+MFNSF;
 
-#if 0
-      DebugFile.open("/tmp/outputL.txt",ofstream::app);
-      DebugFile << MSupportFoot(0,2) << " "
-		<< MSupportFoot(1,2) << " "
-		<< endl;
-      DebugFile.close();
-
-      DebugFile.open("/tmp/output.txt",ofstream::app);
-      DebugFile << aFootPosition.sx<< " "
-		<< aFootPosition.sy<< " "
-		<< aFootPosition.theta<< " "
-		<< endl;
-      DebugFile.close();
-#endif
+      OTRACE(MSupportFoot(0,2) << " " << MSupportFoot(1,2),"outputL.txt");
+      OTRACE(aFootPosition.sx << " " << aFootPosition.sy << " "
+             << aFootPosition.theta,"output.txt");
       aFootPosition.sx = 0;
       aFootPosition.sy = SupportFoot*0.19;
       aFootPosition.theta = 0;
@@ -805,22 +776,11 @@ CreateArcCenteredInStepStack
 
       m_RelativeFootPositions.push_back(aFootPosition);
 
-#if 0
-      DebugFile.open("/tmp/output.txt",ofstream::app);
-      DebugFile << aFootPosition.sx<< " "
-		<< aFootPosition.sy<< " "
-		<< aFootPosition.theta<< " "
-		<< endl;
-      DebugFile.close();
-#endif
+      OTRACE(aFootPosition.sx << " " << aFootPosition.sy << " "
+             << aFootPosition.theta,"output.txt");
       MSupportFoot = MSupportFoot*Mtmp;
 
-#if 0
-      DebugFile.open("/tmp/outputNL.txt",ofstream::app);
-      DebugFile << MSupportFoot(0,2) << " "
-		<< MSupportFoot(1,2) << endl;
-      DebugFile.close();
-#endif
+      OTRACE(MSupportFoot(0,2) << " " << MSupportFoot(1,2),"outputNL.txt");
 
 
     }
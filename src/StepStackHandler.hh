@@ -41,6 +41,19 @@ namespace PatternGeneratorJRL
 {
   class StepOverPlanner;
 
+  /*! \brief Part of StepStackHandler which evolves while walking,
+    see StepStackHandler::GetState(). */
+  struct StepStackHandlerState_s
+  {
+    std::deque<RelativeFootPosition> RelativeFootPositions;
+    int KeepLastCorrectSupportFoot;
+    int WalkMode;
+    double SingleSupportTime, DoubleSupportTime;
+    bool OnLineSteps;
+    bool TransitionFinishOnLine;
+  };
+  typedef struct StepStackHandlerState_s StepStackHandlerState;
+
   /*! @ingroup pgjrl
     This class is in charge of handling the stack of footprints.
     There is two modes currently:
@@ -164,6 +177,16 @@ namespace PatternGeneratorJRL
 
     /*! @} */
 
+    /*! \name Snapshot of the stack.
+      @{
+     */
+    /*! \brief Copy the stack and the stepping mode into aState. */
+    void GetState(StepStackHandlerState &aState) const;
+
+    /*! \brief Put back the stack and the stepping mode stored in aState. */
+    void SetState(const StepStackHandlerState &aState);
+    /*! @} */
+
     /*! \name High level methods to create stack of steps for large motion.
       @{
      */
@@ -0,0 +1,341 @@
+/*
+ * Copyright 2019,
+ *
+ * Olivier Stasse
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+
+/*! \file TraceRecorder.cpp
+    \brief Binary recording of debug data from the control loop.
+*/
+
+#include <string.h>
+
+#include <fstream>
+#include <map>
+
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/tss.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+
+#include <TraceRecorder.hh>
+
+#include <Debug.hh>
+
+using namespace std;
+using namespace PatternGeneratorJRL;
+
+namespace
+{
+  const char TRACE_MAGIC[8] = { 'J','R','L','T','R','A','C','E' };
+  const unsigned int TRACE_VERSION = 1;
+  /* Channel field of a record declaring the name of a channel. */
+  const unsigned int TRACE_DECLARATION = 0xFFFFFFFF;
+}
+
+namespace PatternGeneratorJRL
+{
+  /*! \brief Single producer, single consumer ring of records.
+    The producer is the thread owning the ring, the consumer is
+    the writer thread. */
+  class TraceRing
+  {
+  public:
+    enum { SIZE=1024 };
+
+    TraceRing():
+      Head(0), Tail(0), Released(false)
+    {}
+
+    TraceRecord Records[SIZE];
+    /*! \brief Number of records pushed, written by the producer. */
+    boost::atomic<unsigned long int> Head;
+    /*! \brief Number of records drained, written by the consumer. */
+    boost::atomic<unsigned long int> Tail;
+    /*! \brief Set when the producer thread exits. */
+    boost::atomic<bool> Released;
+  };
+}
+
+struct TraceRecorder::Private
+{
+  Private():
+    LocalRing(&TraceRecorder::ReleaseRing),
+    NbOfChannelsInFile(0),
+    Writer(0)
+  {}
+
+  /*! \brief Protects Rings and Channels, never taken by
+    Write() once the ring of the thread exists. */
+  boost::mutex Mutex;
+  std::vector<TraceRing *> Rings;
+  std::vector<std::string> Channels;
+  boost::thread_specific_ptr<TraceRing> LocalRing;
+
+  unsigned int NbOfChannelsInFile;
+  std::ofstream File;
+  boost::thread * Writer;
+  boost::atomic<bool> StopRequested;
+};
+
+TraceRecorder & TraceRecorder::Instance()
+{
+  static TraceRecorder aRecorder;
+  return aRecorder;
+}
+
+TraceRecorder::TraceRecorder():
+  m_Running(false),
+  m_NbOfDropped(0),
+  m_NbOfWritten(0)
+{
+  m_Private = new Private;
+  m_Private->StopRequested.store(false);
+}
+
+TraceRecorder::~TraceRecorder()
+{
+  Stop();
+  // The other threads are gone, only the ring of this one is left
+  // in the thread specific pointer.
+  m_Private->LocalRing.release();
+  for(unsigned int i=0;i<m_Private->Rings.size();i++)
+    delete m_Private->Rings[i];
+  delete m_Private;
+}
+
+bool TraceRecorder::Start(const std::string & FileName)
+{
+  if (m_Private->Writer!=0)
+    return false;
+
+  m_Private->File.open(FileName.c_str(),ofstream::out | ofstream::binary);
+  if (!m_Private->File.is_open())
+    return false;
+  m_Private->File.write(TRACE_MAGIC,sizeof(TRACE_MAGIC));
+  m_Private->File.write((const char *)&TRACE_VERSION,sizeof(TRACE_VERSION));
+
+  {
+    boost::lock_guard<boost::mutex> lock(m_Private->Mutex);
+    // Drop what has been pushed after the previous recording stopped.
+    for(unsigned int i=0;i<m_Private->Rings.size();i++)
+      m_Private->Rings[i]->Tail.store(m_Private->Rings[i]->Head.load());
+    m_Private->NbOfChannelsInFile = 0;
+  }
+  m_NbOfDropped.store(0);
+  m_NbOfWritten.store(0);
+
+  m_Private->StopRequested.store(false);
+  m_Private->Writer = new boost::thread(&TraceRecorder::Run,this);
+  m_Running.store(true);
+  return true;
+}
+
+void TraceRecorder::Stop()
+{
+  if (m_Private->Writer==0)
+    return;
+  m_Running.store(false);
+  m_Private->StopRequested.store(true);
+  m_Private->Writer->join();
+  delete m_Private->Writer;
+  m_Private->Writer = 0;
+
+  Drain();
+  m_Private->File.close();
+  ODEBUG("Trace stopped: " << m_NbOfWritten.load() << " records written, "
+         << m_NbOfDropped.load() << " dropped");
+}
+
+unsigned int TraceRecorder::Channel(const std::string & Name)
+{
+  boost::lock_guard<boost::mutex> lock(m_Private->Mutex);
+  for(unsigned int i=0;i<m_Private->Channels.size();i++)
+    if (m_Private->Channels[i]==Name)
+      return i;
+  m_Private->Channels.push_back(Name);
+  return (unsigned int)m_Private->Channels.size()-1;
+}
+
+TraceRing * TraceRecorder::LocalRing()
+{
+  TraceRing * lRing = m_Private->LocalRing.get();
+  if (lRing==0)
+  {
+    lRing = new TraceRing;
+    boost::lock_guard<boost::mutex> lock(m_Private->Mutex);
+    m_Private->Rings.push_back(lRing);
+    m_Private->LocalRing.reset(lRing);
+  }
+  return lRing;
+}
+
+void TraceRecorder::ReleaseRing(TraceRing * aRing)
+{
+  // The writer deletes the ring once it is empty.
+  aRing->Released.store(true,boost::memory_order_release);
+}
+
+void TraceRecorder::Write(unsigned int aChannel,
+                          const double * Values,
+                          unsigned int NbOfValues,
+                          bool Continued)
+{
+  if (!IsRunning())
+    return;
+
+  TraceRing * lRing = LocalRing();
+  unsigned long int lHead = lRing->Head.load(boost::memory_order_relaxed);
+  if (lHead - lRing->Tail.load(boost::memory_order_acquire)
+      >= TraceRing::SIZE)
+  {
+    m_NbOfDropped.fetch_add(1,boost::memory_order_relaxed);
+    return;
+  }
+
+  if (NbOfValues>TRACE_MAX_VALUES)
+    NbOfValues = TRACE_MAX_VALUES;
+  TraceRecord & aRecord = lRing->Records[lHead % TraceRing::SIZE];
+  aRecord.Channel = aChannel;
+  aRecord.NbOfValues = Continued ?
+    (NbOfValues | TRACE_CONTINUED) : NbOfValues;
+  memcpy(aRecord.Values,Values,NbOfValues*sizeof(double));
+  lRing->Head.store(lHead+1,boost::memory_order_release);
+}
+
+void TraceRecorder::Run()
+{
+  while(!m_Private->StopRequested.load())
+  {
+    Drain();
+    boost::this_thread::sleep(boost::posix_time::milliseconds(1));
+  }
+}
+
+void TraceRecorder::Drain()
+{
+  // Channel() takes the same lock, so all the channels used by
+  // the records drained below are declared before them.
+  boost::lock_guard<boost::mutex> lock(m_Private->Mutex);
+  std::ofstream & aFile = m_Private->File;
+
+  for(unsigned int i=m_Private->NbOfChannelsInFile;
+      i<m_Private->Channels.size();i++)
+  {
+    const std::string & aName = m_Private->Channels[i];
+    unsigned int lLength = (unsigned int)aName.size();
+    aFile.write((const char *)&TRACE_DECLARATION,sizeof(unsigned int));
+    aFile.write((const char *)&i,sizeof(unsigned int));
+    aFile.write((const char *)&lLength,sizeof(unsigned int));
+    aFile.write(aName.data(),lLength);
+  }
+  m_Private->NbOfChannelsInFile = (unsigned int)m_Private->Channels.size();
+
+  unsigned long int lNbOfWritten=0;
+  std::vector<TraceRing *> & Rings = m_Private->Rings;
+  for(unsigned int i=0;i<Rings.size();)
+  {
+    TraceRing * aRing = Rings[i];
+    // Read before draining: once set, nothing is pushed anymore.
+    bool lReleased = aRing->Released.load(boost::memory_order_acquire);
+
+    unsigned long int lTail = aRing->Tail.load(boost::memory_order_relaxed);
+    unsigned long int lHead = aRing->Head.load(boost::memory_order_acquire);
+    for(;lTail!=lHead;lTail++)
+    {
+      const TraceRecord & aRecord = aRing->Records[lTail % TraceRing::SIZE];
+      aFile.write((const char *)&aRecord.Channel,2*sizeof(unsigned int));
+      aFile.write((const char *)aRecord.Values,
+                  (aRecord.NbOfValues & ~TRACE_CONTINUED)*sizeof(double));
+      lNbOfWritten++;
+    }
+    aRing->Tail.store(lTail,boost::memory_order_release);
+
+    if (lReleased)
+    {
+      delete aRing;
+      Rings.erase(Rings.begin()+i);
+    }
+    else
+      i++;
+  }
+  aFile.flush();
+  m_NbOfWritten.fetch_add(lNbOfWritten);
+}
+
+int TraceRecorder::ConvertToDat(const std::string & TraceFile,
+                                const std::string & Directory)
+{
+  ifstream aTrace(TraceFile.c_str(),ifstream::in | ifstream::binary);
+  char lMagic[sizeof(TRACE_MAGIC)];
+  unsigned int lVersion=0;
+  aTrace.read(lMagic,sizeof(lMagic));
+  aTrace.read((char *)&lVersion,sizeof(lVersion));
+  if (!aTrace || memcmp(lMagic,TRACE_MAGIC,sizeof(lMagic))!=0
+      || lVersion!=TRACE_VERSION)
+    return -1;
+
+  std::map<unsigned int, ofstream *> lDatFiles;
+  double lValues[TRACE_MAX_VALUES];
+  unsigned int lHeader[2];
+  while(aTrace.read((char *)lHeader,sizeof(lHeader)))
+  {
+    if (lHeader[0]==TRACE_DECLARATION)
+    {
+      unsigned int lLength=0;
+      aTrace.read((char *)&lLength,sizeof(lLength));
+      std::string aName(lLength,' ');
+      if (lLength>0)
+        aTrace.read(&aName[0],lLength);
+      ofstream * aDatFile = new ofstream;
+      aDatFile->open((Directory+"/"+aName).c_str(),ofstream::out);
+      aDatFile->precision(10);
+      delete lDatFiles[lHeader[1]];
+      lDatFiles[lHeader[1]] = aDatFile;
+      continue;
+    }
+
+    bool lContinued = (lHeader[1] & TRACE_CONTINUED)!=0;
+    unsigned int lNbOfValues = lHeader[1] & ~TRACE_CONTINUED;
+    if (lNbOfValues>TRACE_MAX_VALUES)
+      break;
+    aTrace.read((char *)lValues,lNbOfValues*sizeof(double));
+
+    std::map<unsigned int, ofstream *>::iterator it =
+      lDatFiles.find(lHeader[0]);
+    if (it==lDatFiles.end())
+      continue;
+    ofstream & aDatFile = *it->second;
+    for(unsigned int i=0;i<lNbOfValues;i++)
+    {
+      if (i>0)
+        aDatFile << " ";
+      aDatFile << lValues[i];
+    }
+    aDatFile << (lContinued ? " " : "\n");
+  }
+
+  int lNbOfFiles = (int)lDatFiles.size();
+  for(std::map<unsigned int, ofstream *>::iterator it=lDatFiles.begin();
+      it!=lDatFiles.end();it++)
+    delete it->second;
+  return lNbOfFiles;
+}
@@ -0,0 +1,211 @@
+/*
+ * Copyright 2019,
+ *
+ * Olivier Stasse
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+
+/*! \file TraceRecorder.hh
+    \brief Binary recording of debug data from the control loop.
+*/
+#ifndef _HWPG_TRACE_RECORDER_H_
+# define _HWPG_TRACE_RECORDER_H_
+
+#include <string>
+#include <vector>
+
+#include <boost/atomic.hpp>
+
+namespace PatternGeneratorJRL
+{
+  /*! \brief Maximal number of values of one trace record. */
+  enum { TRACE_MAX_VALUES=32 };
+
+  /*! \brief Flag set in the number of values of a record which
+    is followed by the next part of the same line. */
+  const unsigned int TRACE_CONTINUED = 0x80000000;
+
+  /*! \brief Fixed-size record, stored as is in the rings. */
+  struct TraceRecord
+  {
+    unsigned int Channel;
+    /*! \brief Number of values, with TRACE_CONTINUED if the
+      line goes on in the next record of the channel. */
+    unsigned int NbOfValues;
+    double Values[TRACE_MAX_VALUES];
+  };
+
+  class TraceRing;
+
+  /*! \brief Process-wide recorder of binary traces.
+
+    Each thread writing a record gets its own ring of fixed-size
+    records: pushing a record copies at most TRACE_MAX_VALUES doubles
+    and publishes it with an atomic store, without lock nor memory
+    allocation. A background thread drains the rings into a compact
+    binary file. When a ring is full the record is dropped and counted,
+    the control loop never waits for the disk.
+
+    A channel stands for one of the former text files: its name is the
+    name of the .dat file rebuilt by ConvertToDat(), one line per record
+    with the values separated by spaces, as the gnuplot scripts of
+    src/gnufiles expect.
+
+    When the recorder is not started, Write() only reads a flag.
+    Lines longer than TRACE_MAX_VALUES are split in several records;
+    if one of them is dropped the line is merged with the next one.
+  */
+  class TraceRecorder
+  {
+  public:
+    /*! \brief The recorder shared by all the threads. */
+    static TraceRecorder & Instance();
+
+    ~TraceRecorder();
+
+    /*! \brief Open FileName and start the writer thread.
+      Returns false if the file cannot be opened. */
+    bool Start(const std::string & FileName);
+
+    /*! \brief Write the pending records, stop the writer thread
+      and close the file. */
+    void Stop();
+
+    inline bool IsRunning() const
+    { return m_Running.load(boost::memory_order_relaxed); }
+
+    /*! \brief Identifier of the channel named Name, created if needed.
+      Takes a lock: call it once and keep the result. */
+    unsigned int Channel(const std::string & Name);
+
+    /*! \brief Record NbOfValues values on a channel from the
+      calling thread. The values beyond TRACE_MAX_VALUES are lost.
+      With Continued, the next record of the channel written by this
+      thread ends the same line. */
+    void Write(unsigned int aChannel,
+               const double * Values,
+               unsigned int NbOfValues,
+               bool Continued=false);
+
+    /*! \brief Number of records dropped because a ring was full. */
+    inline unsigned long int NbOfDropped() const
+    { return m_NbOfDropped.load(); }
+
+    /*! \brief Number of records written in the file. */
+    inline unsigned long int NbOfWritten() const
+    { return m_NbOfWritten.load(); }
+
+    /*! \brief Rebuild one .dat file per channel of the binary
+      trace TraceFile in Directory. Returns the number of files
+      written, or -1 if TraceFile is not a trace. */
+    static int ConvertToDat(const std::string & TraceFile,
+                            const std::string & Directory);
+
+  protected:
+    TraceRecorder();
+
+    /*! \brief Ring of the calling thread. */
+    TraceRing * LocalRing();
+
+    /*! \brief Loop of the writer thread. */
+    void Run();
+
+    /*! \brief Write the records and the channels which are
+      not in the file yet. Called by the writer thread only. */
+    void Drain();
+
+    static void ReleaseRing(TraceRing * aRing);
+
+    boost::atomic<bool> m_Running;
+    boost::atomic<unsigned long int> m_NbOfDropped;
+    boost::atomic<unsigned long int> m_NbOfWritten;
+
+    /*! \brief Members hiding the threading and file types. */
+    struct Private;
+    Private * m_Private;
+  };
+
+  /*! \brief Gather the values of a line with the stream syntax
+    of the ODEBUG macros: numbers are kept, strings (separators)
+    are ignored. The line is written when the entry is destroyed,
+    split in several records if it is longer than TRACE_MAX_VALUES. */
+  class TraceEntry
+  {
+  public:
+    explicit inline TraceEntry(unsigned int aChannel):
+      m_Channel(aChannel), m_NbOfValues(0)
+    {}
+
+    inline ~TraceEntry()
+    {
+      TraceRecorder::Instance().Write(m_Channel,m_Values,m_NbOfValues);
+    }
+
+    inline TraceEntry & operator<<(double Value)
+    {
+      if (m_NbOfValues==TRACE_MAX_VALUES)
+      {
+        TraceRecorder::Instance().Write(m_Channel,m_Values,
+                                        m_NbOfValues,true);
+        m_NbOfValues = 0;
+      }
+      m_Values[m_NbOfValues++] = Value;
+      return *this;
+    }
+
+    inline TraceEntry & operator<<(int Value)
+    { return *this << (double)Value; }
+    inline TraceEntry & operator<<(unsigned int Value)
+    { return *this << (double)Value; }
+    inline TraceEntry & operator<<(long int Value)
+    { return *this << (double)Value; }
+    inline TraceEntry & operator<<(unsigned long int Value)
+    { return *this << (double)Value; }
+    inline TraceEntry & operator<<(bool Value)
+    { return *this << (Value ? 1.0 : 0.0); }
+
+    inline TraceEntry & operator<<(const char *)
+    { return *this; }
+    inline TraceEntry & operator<<(char)
+    { return *this; }
+    inline TraceEntry & operator<<(const std::string &)
+    { return *this; }
+
+  private:
+    unsigned int m_Channel;
+    unsigned int m_NbOfValues;
+    double m_Values[TRACE_MAX_VALUES];
+  };
+}
+
+/*! \brief Record the numbers of the stream expression x on the
+  channel named y, which has to be a constant string.
+  Nothing is evaluated when the recorder is not started. */
+#define OTRACE(x,y) {                                                   \
+    PatternGeneratorJRL::TraceRecorder & lTraceRecorder =               \
+      PatternGeneratorJRL::TraceRecorder::Instance();                   \
+    if (lTraceRecorder.IsRunning())                                     \
+      {                                                                 \
+        static unsigned int lTraceChannel = lTraceRecorder.Channel(y);  \
+        PatternGeneratorJRL::TraceEntry(lTraceChannel) << x;            \
+      }                                                                 \
+  }
+
+#endif /* _HWPG_TRACE_RECORDER_H_ */
@@ -0,0 +1,57 @@
+/*
+ * Copyright 2019,
+ *
+ * Olivier Stasse
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+
+/*! \file TraceToDat.cpp
+    \brief Convert a binary trace into the .dat files
+    read by the gnuplot scripts.
+*/
+
+#include <iostream>
+
+#include <TraceRecorder.hh>
+
+using namespace std;
+using namespace PatternGeneratorJRL;
+
+int main(int argc, char *argv[])
+{
+  if (argc<2)
+  {
+    cerr << "Usage: " << argv[0] << " trace-file [output-directory]" << endl;
+    return -1;
+  }
+
+  string lDirectory(".");
+  if (argc>2)
+    lDirectory = argv[2];
+
+  int lNbOfFiles = TraceRecorder::ConvertToDat(argv[1],lDirectory);
+  if (lNbOfFiles<0)
+  {
+    cerr << argv[1] << " is not a trace file." << endl;
+    return -1;
+  }
+  cout << lNbOfFiles << " files written in " << lDirectory << endl;
+  return 0;
+}
@@ -0,0 +1,107 @@
+/*
+ * Copyright 2019,
+ *
+ * Olivier Stasse
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+
+/*! \file TripleBuffer.hh
+    \brief Lock-free exchange of the last value between two threads.
+*/
+#ifndef _HWPG_TRIPLE_BUFFER_H_
+# define _HWPG_TRIPLE_BUFFER_H_
+
+#include <boost/atomic.hpp>
+
+namespace PatternGeneratorJRL
+{
+  /*! \brief Single producer, single consumer exchange of the latest value.
+
+    Three slots are used: one owned by the writer, one owned by the
+    reader, and one in the middle which holds the last published value.
+    Publishing and fetching only swap indexes with an atomic exchange,
+    so none of the two threads can block the other.
+    A value which is not fetched before the next publication is dropped.
+
+    The slots are allocated once, the values are copied in place
+    by the writer and read in place by the reader.
+  */
+  template <typename T>
+  class TripleBuffer
+  {
+  public:
+    TripleBuffer():
+      m_Write(0), m_Middle(1), m_Read(2)
+    {}
+
+    /*! \name Writer side.
+      @{ */
+    /*! \brief Slot to fill before calling Publish(). */
+    T & WriteSlot()
+    { return m_Slots[m_Write]; }
+
+    /*! \brief Make the content of WriteSlot() available to the reader. */
+    void Publish()
+    {
+      m_Write = m_Middle.exchange(m_Write | FRESH,
+                                  boost::memory_order_acq_rel) & INDEX;
+    }
+    /*! @} */
+
+    /*! \name Reader side.
+      @{ */
+    /*! \brief Take the last published value if there is a new one.
+      Returns true if ReadSlot() has been updated. */
+    bool Fetch()
+    {
+      if ((m_Middle.load(boost::memory_order_acquire) & FRESH)==0)
+        return false;
+      m_Read = m_Middle.exchange(m_Read,
+                                 boost::memory_order_acq_rel) & INDEX;
+      return true;
+    }
+
+    /*! \brief Returns true if a value has been published
+      and not fetched yet. */
+    bool HasNewValue() const
+    { return (m_Middle.load(boost::memory_order_acquire) & FRESH)!=0; }
+
+    /*! \brief Last fetched value. */
+    T & ReadSlot()
+    { return m_Slots[m_Read]; }
+    /*! @} */
+
+    /*! \brief Drop the published value. Not thread-safe, both sides
+      have to be idle. */
+    void Reset()
+    {
+      m_Middle.store(m_Middle.load() & INDEX);
+    }
+
+  protected:
+    enum { INDEX=3, FRESH=4 };
+
+    T m_Slots[3];
+    unsigned int m_Write;
+    boost::atomic<unsigned int> m_Middle;
+    unsigned int m_Read;
+  };
+}
+#endif /* _HWPG_TRIPLE_BUFFER_H_ */
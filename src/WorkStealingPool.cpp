@@ -0,0 +1,178 @@
+/*
+ * Copyright 2019,
+ *
+ * Olivier Stasse
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+/*! \file WorkStealingPool.cpp
+  \brief Pool of threads balancing their tasks by work stealing.
+*/
+#include <iostream>
+#include <exception>
+
+#include <boost/bind/bind.hpp>
+
+#include <WorkStealingPool.hh>
+
+#include <Debug.hh>
+
+using namespace std;
+using namespace PatternGeneratorJRL;
+
+WorkStealingPool::WorkStealingPool(unsigned int NbOfWorkers):
+  m_NbOfQueuedTasks(0),
+  m_NbOfPendingTasks(0),
+  m_NextWorker(0),
+  m_Stop(false),
+  m_NbOfSteals(0),
+  m_NbOfFailedTasks(0)
+{
+  if (NbOfWorkers==0)
+    NbOfWorkers = boost::thread::hardware_concurrency();
+  if (NbOfWorkers==0)
+    NbOfWorkers = 1;
+
+  m_Workers.resize(NbOfWorkers);
+  for(unsigned int i=0;i<NbOfWorkers;i++)
+    {
+      m_Workers[i] = new Worker();
+      m_Workers[i]->Tasks.reserve(16);
+    }
+  for(unsigned int i=0;i<NbOfWorkers;i++)
+    m_Threads.create_thread(boost::bind(&WorkStealingPool::Run,this,i));
+}
+
+WorkStealingPool::~WorkStealingPool()
+{
+  Wait();
+  {
+    boost::lock_guard<boost::mutex> lock(m_Mutex);
+    m_Stop = true;
+  }
+  m_TaskQueued.notify_all();
+  m_Threads.join_all();
+
+  for(unsigned int i=0;i<m_Workers.size();i++)
+    delete m_Workers[i];
+}
+
+void WorkStealingPool::Submit(const Task & aTask)
+{
+  unsigned int lWorkerId;
+  {
+    boost::lock_guard<boost::mutex> lock(m_Mutex);
+    lWorkerId = m_NextWorker;
+    m_NextWorker = (m_NextWorker+1)%m_Workers.size();
+  }
+  Submit(aTask,lWorkerId);
+}
+
+void WorkStealingPool::Submit(const Task & aTask, unsigned int WorkerId)
+{
+  // The counters are updated first so that they never
+  // underflow when the task is taken right away.
+  {
+    boost::lock_guard<boost::mutex> lock(m_Mutex);
+    m_NbOfQueuedTasks++;
+    m_NbOfPendingTasks++;
+  }
+  Worker & aWorker = *m_Workers[WorkerId%m_Workers.size()];
+  {
+    boost::lock_guard<boost::mutex> lock(aWorker.Mutex);
+    aWorker.Tasks.push_back(aTask);
+  }
+  m_TaskQueued.notify_all();
+}
+
+void WorkStealingPool::Wait()
+{
+  boost::unique_lock<boost::mutex> lock(m_Mutex);
+  while(m_NbOfPendingTasks>0)
+    m_AllDone.wait(lock);
+}
+
+bool WorkStealingPool::PopTask(unsigned int WorkerId, Task & aTask)
+{
+  Worker & aWorker = *m_Workers[WorkerId];
+  boost::lock_guard<boost::mutex> lock(aWorker.Mutex);
+  if (aWorker.Tasks.empty())
+    return false;
+  aTask.swap(aWorker.Tasks.back());
+  aWorker.Tasks.pop_back();
+  return true;
+}
+
+bool WorkStealingPool::StealTask(unsigned int WorkerId, Task & aTask)
+{
+  for(unsigned int i=1;i<m_Workers.size();i++)
+  {
+    Worker & aVictim = *m_Workers[(WorkerId+i)%m_Workers.size()];
+    boost::lock_guard<boost::mutex> lock(aVictim.Mutex);
+    if (aVictim.Tasks.empty())
+      continue;
+    aTask.swap(aVictim.Tasks.front());
+    aVictim.Tasks.pop_front();
+    m_NbOfSteals++;
+    return true;
+  }
+  return false;
+}
+
+void WorkStealingPool::Run(unsigned int WorkerId)
+{
+  Task aTask;
+  while(true)
+  {
+    if (PopTask(WorkerId,aTask) || StealTask(WorkerId,aTask))
+    {
+      {
+        boost::lock_guard<boost::mutex> lock(m_Mutex);
+        m_NbOfQueuedTasks--;
+      }
+      try
+      {
+        aTask(WorkerId);
+      }
+      catch(std::exception & e)
+      {
+        m_NbOfFailedTasks++;
+        cerr << "WorkStealingPool: task failed: " << e.what() << endl;
+      }
+      catch(...)
+      {
+        m_NbOfFailedTasks++;
+        cerr << "WorkStealingPool: task failed" << endl;
+      }
+      aTask.clear();
+
+      boost::lock_guard<boost::mutex> lock(m_Mutex);
+      if (--m_NbOfPendingTasks==0)
+        m_AllDone.notify_all();
+      continue;
+    }
+
+    // No task left anywhere: sleep until one is queued.
+    boost::unique_lock<boost::mutex> lock(m_Mutex);
+    while((m_NbOfQueuedTasks==0) && !m_Stop)
+      m_TaskQueued.wait(lock);
+    if (m_Stop && (m_NbOfQueuedTasks==0))
+      return;
+  }
+}
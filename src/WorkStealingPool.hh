@@ -0,0 +1,117 @@
+/*
+ * Copyright 2019,
+ *
+ * Olivier Stasse
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+
+/*! \file WorkStealingPool.hh
+    \brief Pool of threads balancing their tasks by work stealing.
+*/
+#ifndef _HWPG_WORK_STEALING_POOL_H_
+# define _HWPG_WORK_STEALING_POOL_H_
+
+#include <vector>
+
+#include <boost/atomic.hpp>
+#include <boost/function.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+
+#include <RingBuffer.hh>
+
+namespace PatternGeneratorJRL
+{
+  /*! \brief Fixed set of worker threads with one task queue per worker.
+
+    A worker takes its own tasks from the back of its queue, and when
+    it runs out of work steals the oldest task from the front of
+    the queue of another worker. Tasks of uneven durations are thus
+    balanced without a central queue.
+
+    A task receives the index of the worker running it, which allows
+    to keep data per worker (for instance one pattern generator per
+    thread) without any locking.
+  */
+  class WorkStealingPool
+  {
+  public:
+    typedef boost::function<void (unsigned int WorkerId)> Task;
+
+    /*! \brief Start NbOfWorkers threads. With 0, one thread
+      per hardware thread is started. */
+    explicit WorkStealingPool(unsigned int NbOfWorkers=0);
+
+    /*! \brief Wait for the pending tasks and stop the threads. */
+    ~WorkStealingPool();
+
+    inline unsigned int NbOfWorkers() const
+    { return (unsigned int)m_Workers.size(); }
+
+    /*! \brief Queue a task, the workers are chosen in turn. */
+    void Submit(const Task & aTask);
+
+    /*! \brief Queue a task on the queue of a given worker. */
+    void Submit(const Task & aTask, unsigned int WorkerId);
+
+    /*! \brief Wait until all the submitted tasks are done. */
+    void Wait();
+
+    /*! \brief Number of tasks run by another worker than the one
+      they were queued on. */
+    inline unsigned long int NbOfSteals() const
+    { return m_NbOfSteals.load(); }
+
+    /*! \brief Number of tasks which threw an exception. */
+    inline unsigned long int NbOfFailedTasks() const
+    { return m_NbOfFailedTasks.load(); }
+
+  protected:
+    /*! The queue is a ring, which does not allocate
+      once it has grown to the largest number of tasks. */
+    struct Worker
+    {
+      boost::mutex Mutex;
+      RingBuffer<Task> Tasks;
+    };
+
+    void Run(unsigned int WorkerId);
+    bool PopTask(unsigned int WorkerId, Task & aTask);
+    bool StealTask(unsigned int WorkerId, Task & aTask);
+
+    std::vector<Worker *> m_Workers;
+    boost::thread_group m_Threads;
+
+    /*! Protects the counters below and the stop flag. */
+    boost::mutex m_Mutex;
+    boost::condition_variable m_TaskQueued, m_AllDone;
+    unsigned long int m_NbOfQueuedTasks, m_NbOfPendingTasks;
+    unsigned int m_NextWorker;
+    bool m_Stop;
+
+    boost::atomic<unsigned long int> m_NbOfSteals, m_NbOfFailedTasks;
+
+  private:
+    WorkStealingPool(const WorkStealingPool &);
+    WorkStealingPool & operator=(const WorkStealingPool &);
+  };
+}
+#endif /* _HWPG_WORK_STEALING_POOL_H_ */
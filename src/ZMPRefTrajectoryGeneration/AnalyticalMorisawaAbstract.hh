@@ -101,11 +101,11 @@ namespace PatternGeneratorJRL
 	@param[in] InitRightFootAbsolutePosition: The absolute position of the right foot.
 
       */
-      virtual void GetZMPDiscretization(deque<ZMPPosition> & ZMPPositions,
-					deque<COMState> & CoMStates,
+      virtual void GetZMPDiscretization(RingBuffer<ZMPPosition> & ZMPPositions,
+					RingBuffer<COMState> & CoMStates,
 					deque<RelativeFootPosition> &RelativeFootPositions,
-					deque<FootAbsolutePosition> &LeftFootAbsolutePositions,
-					deque<FootAbsolutePosition> &RightFootAbsolutePositions,
+					RingBuffer<FootAbsolutePosition> &LeftFootAbsolutePositions,
+					RingBuffer<FootAbsolutePosition> &RightFootAbsolutePositions,
 					double Xmax,
 					COMState & lStartingCOMState,
 					Eigen::Vector3d &lStartingZMPPosition,
@@ -122,10 +122,10 @@ namespace PatternGeneratorJRL
 	Returns the number of steps which has been completely put inside
 	the queue of ZMP, and foot positions.
       */
-      virtual std::size_t InitOnLine(deque<ZMPPosition> & FinalZMPPositions,
-				     deque<COMState> & CoMStates,
-				     deque<FootAbsolutePosition> & FinalLeftFootAbsolutePositions,
-				     deque<FootAbsolutePosition> & FinalRightFootAbsolutePositions,
+      virtual std::size_t InitOnLine(RingBuffer<ZMPPosition> & FinalZMPPositions,
+				     RingBuffer<COMState> & CoMStates,
+				     RingBuffer<FootAbsolutePosition> & FinalLeftFootAbsolutePositions,
+				     RingBuffer<FootAbsolutePosition> & FinalRightFootAbsolutePositions,
 				     FootAbsolutePosition & InitLeftFootAbsolutePosition,
 				     FootAbsolutePosition & InitRightFootAbsolutePosition,
 				     deque<RelativeFootPosition> &RelativeFootPositions,
@@ -134,17 +134,17 @@ namespace PatternGeneratorJRL
 
       /* ! \brief Method to update the stacks on-line */
       virtual void OnLine(double time,
-			  deque<ZMPPosition> & FinalZMPPositions,
-			  deque<COMState> & CoMStates,
-			  deque<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
-			  deque<FootAbsolutePosition> &FinalRightFootAbsolutePositions)=0;
+			  RingBuffer<ZMPPosition> & FinalZMPPositions,
+			  RingBuffer<COMState> & CoMStates,
+			  RingBuffer<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
+			  RingBuffer<FootAbsolutePosition> &FinalRightFootAbsolutePositions)=0;
 
       /* ! Methods to update the stack on-line by inserting a new foot position. */
       virtual void OnLineAddFoot(RelativeFootPosition & NewRelativeFootPosition,
-				 deque<ZMPPosition> & FinalZMPPositions,
-				 deque<COMState> & CoMStates,
-				 deque<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
-				 deque<FootAbsolutePosition> &FinalRightFootAbsolutePositions,
+				 RingBuffer<ZMPPosition> & FinalZMPPositions,
+				 RingBuffer<COMState> & CoMStates,
+				 RingBuffer<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
+				 RingBuffer<FootAbsolutePosition> &FinalRightFootAbsolutePositions,
 				 bool EndSequence)=0;
 
       /* ! \brief Method to change on line the landing position of a foot.
@@ -152,10 +152,10 @@ namespace PatternGeneratorJRL
       */
       virtual int OnLineFootChange(double time,
 				   FootAbsolutePosition &aFootAbsolutePosition,
-				   deque<ZMPPosition> & FinalZMPPositions,
-				   deque<COMState> & CoMStates,
-				   deque<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
-				   deque<FootAbsolutePosition> &FinalRightFootAbsolutePositions,
+				   RingBuffer<ZMPPosition> & FinalZMPPositions,
+				   RingBuffer<COMState> & CoMStates,
+				   RingBuffer<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
+				   RingBuffer<FootAbsolutePosition> &FinalRightFootAbsolutePositions,
 				   StepStackHandler *aStepStackHandler)=0;
 
       /*! \brief Method to stop walking.
@@ -164,10 +164,10 @@ namespace PatternGeneratorJRL
 	@param[out] LeftFootAbsolutePositions: The queue of left foot absolute positions.
 	@param[out] RightFootAbsolutePositions: The queue of right foot absolute positions.
       */
-      virtual void EndPhaseOfTheWalking(deque<ZMPPosition> &ZMPPositions,
-				deque<COMState> &FinalCOMStates,
-				deque<FootAbsolutePosition> &LeftFootAbsolutePositions,
-				deque<FootAbsolutePosition> &RightFootAbsolutePositions)=0;
+      virtual void EndPhaseOfTheWalking(RingBuffer<ZMPPosition> &ZMPPositions,
+				RingBuffer<COMState> &FinalCOMStates,
+				RingBuffer<FootAbsolutePosition> &LeftFootAbsolutePositions,
+				RingBuffer<FootAbsolutePosition> &RightFootAbsolutePositions)=0;
 
 
 
@@ -524,11 +524,11 @@ computing the analytical trajectories. */
 
   }
 
-  void AnalyticalMorisawaCompact::GetZMPDiscretization(deque<ZMPPosition> & ZMPPositions,
-                                                       deque<COMState> & COMStates,
+  void AnalyticalMorisawaCompact::GetZMPDiscretization(RingBuffer<ZMPPosition> & ZMPPositions,
+                                                       RingBuffer<COMState> & COMStates,
                                                        deque<RelativeFootPosition> &RelativeFootPositions,
-                                                       deque<FootAbsolutePosition> &LeftFootAbsolutePositions,
-                                                       deque<FootAbsolutePosition> &RightFootAbsolutePositions,
+                                                       RingBuffer<FootAbsolutePosition> &LeftFootAbsolutePositions,
+                                                       RingBuffer<FootAbsolutePosition> &RightFootAbsolutePositions,
                                                        double ,
                                                        COMState & lStartingCOMState,
                                                        Eigen::Vector3d & ,
@@ -686,7 +686,7 @@ computing the analytical trajectories. */
         }
 
         // Filter the trajectory
-        deque<COMState> outputDeltaCOMTraj_deq (n) ;
+        RingBuffer<COMState> outputDeltaCOMTraj_deq (n) ;
         m_kajitaDynamicFilter->OffLinefilter(
                     COMStates,
                     ZMPPositions,
@@ -732,10 +732,10 @@ computing the analytical trajectories. */
     }
   }
 
-  std::size_t AnalyticalMorisawaCompact::InitOnLine(deque<ZMPPosition> & FinalZMPPositions,
-						    deque<COMState> & FinalCoMPositions,
-						    deque<FootAbsolutePosition> & FinalLeftFootAbsolutePositions,
-						    deque<FootAbsolutePosition> & FinalRightFootAbsolutePositions,
+  std::size_t AnalyticalMorisawaCompact::InitOnLine(RingBuffer<ZMPPosition> & FinalZMPPositions,
+						    RingBuffer<COMState> & FinalCoMPositions,
+						    RingBuffer<FootAbsolutePosition> & FinalLeftFootAbsolutePositions,
+						    RingBuffer<FootAbsolutePosition> & FinalRightFootAbsolutePositions,
 						    FootAbsolutePosition & InitLeftFootAbsolutePosition,
 						    FootAbsolutePosition & InitRightFootAbsolutePosition,
 						    deque<RelativeFootPosition> &RelativeFootPositions,
@@ -851,10 +851,10 @@ computing the analytical trajectories. */
 
 
   void AnalyticalMorisawaCompact::OnLine(double time,
-                                           deque<ZMPPosition> & FinalZMPPositions,
-                                           deque<COMState> & FinalCOMStates,
-                                           deque<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
-                                           deque<FootAbsolutePosition> &FinalRightFootAbsolutePositions)
+                                           RingBuffer<ZMPPosition> & FinalZMPPositions,
+                                           RingBuffer<COMState> & FinalCOMStates,
+                                           RingBuffer<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
+                                           RingBuffer<FootAbsolutePosition> &FinalRightFootAbsolutePositions)
     {
       unsigned int lIndexInterval;
       if (time<m_UpperTimeLimitToUpdateStacks)
@@ -934,10 +934,10 @@ computing the analytical trajectories. */
         }
     }
 //  void AnalyticalMorisawaCompact::OnLine(double time,
-//                                         deque<ZMPPosition> & FinalZMPPositions,
-//                                         deque<COMState> & FinalCOMStates,
-//                                         deque<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
-//                                         deque<FootAbsolutePosition> &FinalRightFootAbsolutePositions)
+//                                         RingBuffer<ZMPPosition> & FinalZMPPositions,
+//                                         RingBuffer<COMState> & FinalCOMStates,
+//                                         RingBuffer<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
+//                                         RingBuffer<FootAbsolutePosition> &FinalRightFootAbsolutePositions)
 //  {
 //    unsigned int lIndexInterval;
 //    if (time<m_UpperTimeLimitToUpdateStacks)
@@ -1022,10 +1022,10 @@ computing the analytical trajectories. */
 //  }
 
   void AnalyticalMorisawaCompact::OnLineAddFoot(RelativeFootPosition & NewRelativeFootPosition,
-                                                deque<ZMPPosition> & FinalZMPPositions,
-                                                deque<COMState> & FinalCoMPositions,
-                                                deque<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
-                                                deque<FootAbsolutePosition> &FinalRightFootAbsolutePositions,
+                                                RingBuffer<ZMPPosition> & FinalZMPPositions,
+                                                RingBuffer<COMState> & FinalCoMPositions,
+                                                RingBuffer<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
+                                                RingBuffer<FootAbsolutePosition> &FinalRightFootAbsolutePositions,
                                                 bool )
   {
     ODEBUG("****************** Begin OnLineAddFoot **************************");
@@ -1050,7 +1050,7 @@ a shift is done to chose the earliest double support interval. */
     m_RelativeFootPositions.pop_front();
     m_RelativeFootPositions.push_back(NewRelativeFootPosition);
 
-    deque<FootAbsolutePosition> aQAFP;
+    RingBuffer<FootAbsolutePosition> aQAFP;
 
     m_FeetTrajectoryGenerator->ComputeAbsoluteStepsFromRelativeSteps(m_RelativeFootPositions,
                                                                      FinalLeftFootAbsolutePositions[0],
@@ -1703,7 +1703,7 @@ We have to remove one, because there is still the last foot added.
         /*! Remove the first step still in the stack. */
         lRelativeFootPositions.pop_front();
 
-        deque<FootAbsolutePosition> lAbsoluteSupportFootPositions;
+        RingBuffer<FootAbsolutePosition> lAbsoluteSupportFootPositions;
         int lLastIndex = (int)(m_AbsoluteSupportFootPositions.size()-1);
         m_FeetTrajectoryGenerator->ComputeAbsoluteStepsFromRelativeSteps(lRelativeFootPositions,
                                                                          m_AbsoluteSupportFootPositions[lLastIndex],
@@ -2170,13 +2170,13 @@ to filter. */
 
   int AnalyticalMorisawaCompact::OnLineFootChange(double time,
                                                   FootAbsolutePosition &aFootAbsolutePosition,
-                                                  deque<ZMPPosition> & ZMPPositions,
-                                                  deque<COMState> & CoMPositions,
-                                                  deque<FootAbsolutePosition> &LeftFootAbsolutePositions,
-                                                  deque<FootAbsolutePosition> &RightFootAbsolutePositions,
+                                                  RingBuffer<ZMPPosition> & ZMPPositions,
+                                                  RingBuffer<COMState> & CoMPositions,
+                                                  RingBuffer<FootAbsolutePosition> &LeftFootAbsolutePositions,
+                                                  RingBuffer<FootAbsolutePosition> &RightFootAbsolutePositions,
                                                   StepStackHandler *aStepStackHandler)
   {
-    deque<FootAbsolutePosition> NewFeetAbsolutePosition;
+    RingBuffer<FootAbsolutePosition> NewFeetAbsolutePosition;
     NewFeetAbsolutePosition.push_back(aFootAbsolutePosition);
     return OnLineFootChanges(time,
                              NewFeetAbsolutePosition,
@@ -2189,11 +2189,11 @@ to filter. */
   }
 
   int AnalyticalMorisawaCompact::OnLineFootChanges(double time,
-                                                   deque<FootAbsolutePosition> &aFootAbsolutePosition,
-                                                   deque<ZMPPosition> & ZMPPositions,
-                                                   deque<COMState> & CoMPositions,
-                                                   deque<FootAbsolutePosition> &LeftFootAbsolutePositions,
-                                                   deque<FootAbsolutePosition> &RightFootAbsolutePositions,
+                                                   RingBuffer<FootAbsolutePosition> &aFootAbsolutePosition,
+                                                   RingBuffer<ZMPPosition> & ZMPPositions,
+                                                   RingBuffer<COMState> & CoMPositions,
+                                                   RingBuffer<FootAbsolutePosition> &LeftFootAbsolutePositions,
+                                                   RingBuffer<FootAbsolutePosition> &RightFootAbsolutePositions,
                                                    StepStackHandler *aStepStackHandler)
   {
 
@@ -2246,7 +2246,7 @@ a shift is done to chose the earliest double support interval. */
     /* Backup data structures */
     FootAbsolutePosition BackUpm_AbsoluteCurrentSupportFootPosition =
         m_AbsoluteCurrentSupportFootPosition;
-    deque<FootAbsolutePosition> BackUpm_AbsoluteSupportFootPositions =
+    RingBuffer<FootAbsolutePosition> BackUpm_AbsoluteSupportFootPositions =
         m_AbsoluteSupportFootPositions;
     deque<RelativeFootPosition> BackUpm_RelativeFootPositions =
         m_RelativeFootPositions;
@@ -2307,7 +2307,7 @@ a shift is done to chose the earliest double support interval. */
             aFootAbsolutePosition[i].theta;
       }
 
-      deque<FootAbsolutePosition> lAbsoluteSupportFootPositions;
+      RingBuffer<FootAbsolutePosition> lAbsoluteSupportFootPositions;
       m_FeetTrajectoryGenerator->ComputeAbsoluteStepsFromRelativeSteps(m_RelativeFootPositions,
                                                                        LeftFootAbsolutePositions[0],
                                                                        RightFootAbsolutePositions[0],
@@ -2390,10 +2390,10 @@ new step has to be generate.
     return r;
   }
 
-  void AnalyticalMorisawaCompact::EndPhaseOfTheWalking(deque<ZMPPosition> &FinalZMPPositions,
-                                                       deque<COMState> &FinalCoMPositions,
-                                                       deque<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
-                                                       deque<FootAbsolutePosition> &FinalRightFootAbsolutePositions)
+  void AnalyticalMorisawaCompact::EndPhaseOfTheWalking(RingBuffer<ZMPPosition> &FinalZMPPositions,
+                                                       RingBuffer<COMState> &FinalCoMPositions,
+                                                       RingBuffer<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
+                                                       RingBuffer<FootAbsolutePosition> &FinalRightFootAbsolutePositions)
   {
 
     m_OnLineMode = true;
@@ -2543,10 +2543,10 @@ new step has to be generate.
   void AnalyticalMorisawaCompact::FillQueues(double samplingPeriod,
                                              double StartingTime,
                                              double EndTime,
-                                             deque<ZMPPosition> & FinalZMPPositions,
-                                             deque<COMState> & FinalCoMPositions,
-                                             deque<FootAbsolutePosition> & FinalLeftFootAbsolutePositions,
-                                             deque<FootAbsolutePosition> & FinalRightFootAbsolutePositions)
+                                             RingBuffer<ZMPPosition> & FinalZMPPositions,
+                                             RingBuffer<COMState> & FinalCoMPositions,
+                                             RingBuffer<FootAbsolutePosition> & FinalLeftFootAbsolutePositions,
+                                             RingBuffer<FootAbsolutePosition> & FinalRightFootAbsolutePositions)
   {
     unsigned int lIndexInterval,lPrevIndexInterval;
     m_AnalyticalZMPCoGTrajectoryX->GetIntervalIndexFromTime(m_AbsoluteTimeReference,lIndexInterval);
@@ -2673,7 +2673,7 @@ new step has to be generate.
     //CoM.z[0];
   }
 
-  void AnalyticalMorisawaCompact::ComputeCoMz(double t, unsigned int lIndexInterval, COMState &CoM, deque<COMState> & FinalCoMPositions)
+  void AnalyticalMorisawaCompact::ComputeCoMz(double t, unsigned int lIndexInterval, COMState &CoM, RingBuffer<COMState> & FinalCoMPositions)
   {
     double* CoMz = CoM.z ;
     double moving_time = m_RelativeFootPositions[0].SStime + m_RelativeFootPositions[0].DStime;
@@ -2920,10 +2920,10 @@ new step has to be generate.
 
   void AnalyticalMorisawaCompact::FillQueues(double StartingTime,
                                              double EndTime,
-                                             deque<ZMPPosition> & FinalZMPPositions,
-                                             deque<COMState> & FinalCoMPositions,
-                                             deque<FootAbsolutePosition> & FinalLeftFootAbsolutePositions,
-                                             deque<FootAbsolutePosition> & FinalRightFootAbsolutePositions)
+                                             RingBuffer<ZMPPosition> & FinalZMPPositions,
+                                             RingBuffer<COMState> & FinalCoMPositions,
+                                             RingBuffer<FootAbsolutePosition> & FinalLeftFootAbsolutePositions,
+                                             RingBuffer<FootAbsolutePosition> & FinalRightFootAbsolutePositions)
   {
     FillQueues(m_SamplingPeriod, StartingTime, EndTime, FinalZMPPositions,
                FinalCoMPositions, FinalLeftFootAbsolutePositions, FinalRightFootAbsolutePositions);
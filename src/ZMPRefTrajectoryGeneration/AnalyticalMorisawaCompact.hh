@@ -147,11 +147,11 @@ namespace PatternGeneratorJRL
 
 	@param[in] InitRightFootAbsolutePosition: The initial position of the right foot.
       */
-      void GetZMPDiscretization(deque<ZMPPosition> & ZMPPositions,
-				deque<COMState> & CoMStates,
+      void GetZMPDiscretization(RingBuffer<ZMPPosition> & ZMPPositions,
+				RingBuffer<COMState> & CoMStates,
 				deque<RelativeFootPosition> &RelativeFootPositions,
-				deque<FootAbsolutePosition> &LeftFootAbsolutePositions,
-				deque<FootAbsolutePosition> &RightFootAbsolutePositions,
+				RingBuffer<FootAbsolutePosition> &LeftFootAbsolutePositions,
+				RingBuffer<FootAbsolutePosition> &RightFootAbsolutePositions,
 				double Xmax,
 				COMState & lStartingCOMState,
 				Eigen::Vector3d &lStartingZMPPosition,
@@ -179,10 +179,10 @@ namespace PatternGeneratorJRL
 	@param[in] lStartingCOMState: The initial position of the CoM given as a 3D vector.
 	@param[in] lStartingZMPPosition: The initial position of the ZMP given as a 3D vector.
       */
-      std::size_t InitOnLine(deque<ZMPPosition> & FinalZMPPositions,
-			     deque<COMState> & CoMStates,
-			     deque<FootAbsolutePosition> & FinalLeftFootAbsolutePositions,
-			     deque<FootAbsolutePosition> & FinalRightFootAbsolutePositions,
+      std::size_t InitOnLine(RingBuffer<ZMPPosition> & FinalZMPPositions,
+			     RingBuffer<COMState> & CoMStates,
+			     RingBuffer<FootAbsolutePosition> & FinalLeftFootAbsolutePositions,
+			     RingBuffer<FootAbsolutePosition> & FinalRightFootAbsolutePositions,
 			     FootAbsolutePosition & InitLeftFootAbsolutePosition,
 			     FootAbsolutePosition & InitRightFootAbsolutePosition,
 			     deque<RelativeFootPosition> &RelativeFootPositions,
@@ -205,39 +205,39 @@ namespace PatternGeneratorJRL
 
        */
       void OnLineAddFoot(RelativeFootPosition & NewRelativeFootPosition,
-			 deque<ZMPPosition> & FinalZMPPositions,
-			 deque<COMState> & CoMStates,
-			 deque<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
-			 deque<FootAbsolutePosition> &FinalRightFootAbsolutePositions,
+			 RingBuffer<ZMPPosition> & FinalZMPPositions,
+			 RingBuffer<COMState> & CoMStates,
+			 RingBuffer<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
+			 RingBuffer<FootAbsolutePosition> &FinalRightFootAbsolutePositions,
 			 bool EndSequence);
 
       /* ! \brief Method to update the stacks on-line */
       void OnLine(double time,
-		  deque<ZMPPosition> & FinalZMPPositions,
-		  deque<COMState> & CoMStates,
-		  deque<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
-		  deque<FootAbsolutePosition> &FinalRightFootAbsolutePositions);
+		  RingBuffer<ZMPPosition> & FinalZMPPositions,
+		  RingBuffer<COMState> & CoMStates,
+		  RingBuffer<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
+		  RingBuffer<FootAbsolutePosition> &FinalRightFootAbsolutePositions);
 
       /* ! \brief Method to change on line the landing position of a foot.
 	 @return If the method failed it returns -1, 0 otherwise.
       */
       int OnLineFootChange(double time,
 			   FootAbsolutePosition &aFootPosition,
-			   deque<ZMPPosition> & FinalZMPPositions,
-			   deque<COMState> & CoMStates,
-			   deque<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
-			   deque<FootAbsolutePosition> &FinalRightFootAbsolutePositions,
+			   RingBuffer<ZMPPosition> & FinalZMPPositions,
+			   RingBuffer<COMState> & CoMStates,
+			   RingBuffer<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
+			   RingBuffer<FootAbsolutePosition> &FinalRightFootAbsolutePositions,
 			   StepStackHandler *aStepStackHandler=0);
 
       /* ! \brief Method to change on line the landing position of several feet.
 	 @return If the method failed it returns -1, 0 otherwise.
       */
       int OnLineFootChanges(double time,
-			    deque<FootAbsolutePosition> &FeetPosition,
-			    deque<ZMPPosition> & FinalZMPPositions,
-			    deque<COMState> & CoMStates,
-			    deque<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
-			    deque<FootAbsolutePosition> &FinalRightFootAbsolutePositions,
+			    RingBuffer<FootAbsolutePosition> &FeetPosition,
+			    RingBuffer<ZMPPosition> & FinalZMPPositions,
+			    RingBuffer<COMState> & CoMStates,
+			    RingBuffer<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
+			    RingBuffer<FootAbsolutePosition> &FinalRightFootAbsolutePositions,
 			    StepStackHandler *aStepStackHandler=0);
 
       /*! \brief Method to stop walking.
@@ -246,10 +246,10 @@ namespace PatternGeneratorJRL
 	@param[out] LeftFootAbsolutePositions: The queue of left foot absolute positions.
 	@param[out] RightFootAbsolutePositions: The queue of right foot absolute positions.
       */
-      void EndPhaseOfTheWalking(deque<ZMPPosition> &ZMPPositions,
-				deque<COMState> &FinalCOMStates,
-				deque<FootAbsolutePosition> &LeftFootAbsolutePositions,
-				deque<FootAbsolutePosition> &RightFootAbsolutePositions);
+      void EndPhaseOfTheWalking(RingBuffer<ZMPPosition> &ZMPPositions,
+				RingBuffer<COMState> &FinalCOMStates,
+				RingBuffer<FootAbsolutePosition> &LeftFootAbsolutePositions,
+				RingBuffer<FootAbsolutePosition> &RightFootAbsolutePositions);
 
 
 
@@ -554,10 +554,10 @@ namespace PatternGeneratorJRL
       */
       void FillQueues(double StartingTime,
 		      double EndTime,
-		      deque<ZMPPosition> & FinalZMPPositions,
-		      deque<COMState> & FinalCoMPositions,
-		      deque<FootAbsolutePosition> & FinalLeftFootAbsolutePositions,
-		      deque<FootAbsolutePosition> & FinalRightFootAbsolutePositions);
+		      RingBuffer<ZMPPosition> & FinalZMPPositions,
+		      RingBuffer<COMState> & FinalCoMPositions,
+		      RingBuffer<FootAbsolutePosition> & FinalLeftFootAbsolutePositions,
+		      RingBuffer<FootAbsolutePosition> & FinalRightFootAbsolutePositions);
 
       void ComputeZMPz(double t,
            ZMPPosition &ZMPz,
@@ -569,15 +569,15 @@ namespace PatternGeneratorJRL
       void ComputeCoMz(double t,
                        unsigned int lIndexInterval,
                        COMState &CoMz,
-                       deque<COMState> & FinalCoMPositions);
+                       RingBuffer<COMState> & FinalCoMPositions);
 
       void FillQueues(double samplingPeriod,
                       double StartingTime,
                       double EndTime,
-                      deque<ZMPPosition> & FinalZMPPositions,
-                      deque<COMState> & FinalCoMPositions,
-                      deque<FootAbsolutePosition> & FinalLeftFootAbsolutePositions,
-                      deque<FootAbsolutePosition> & FinalRightFootAbsolutePositions);
+                      RingBuffer<ZMPPosition> & FinalZMPPositions,
+                      RingBuffer<COMState> & FinalCoMPositions,
+                      RingBuffer<FootAbsolutePosition> & FinalLeftFootAbsolutePositions,
+                      RingBuffer<FootAbsolutePosition> & FinalRightFootAbsolutePositions);
 
       void ComputeOneElementOfTheQueue(unsigned int & lIndexInterval,
                                        unsigned int & lPrevIndexInterval,
@@ -625,7 +625,7 @@ namespace PatternGeneratorJRL
       deque<RelativeFootPosition> m_RelativeFootPositions;
 
       /*! \brief Stores the absolute support foot positions currently in the buffer */
-      deque<FootAbsolutePosition> m_AbsoluteSupportFootPositions;
+      RingBuffer<FootAbsolutePosition> m_AbsoluteSupportFootPositions;
 
       /*! \brief Store the currently realized support foot position.
 	\warning This field makes sense only direct ON-LINE mode.
@@ -663,16 +663,16 @@ namespace PatternGeneratorJRL
       FilteringAnalyticalTrajectoryByPreviewControl * m_FilterXaxisByPC, * m_FilterYaxisByPC;
       DynamicFilter * m_kajitaDynamicFilter ;
       // deque sampled at m_SamplingPeriod
-      deque<FootAbsolutePosition> ctrlLF_ ;
-      deque<FootAbsolutePosition> ctrlRF_ ;
-      deque<COMState>             ctrlCoM_ ;
-      deque<ZMPPosition>          ctrlZMP_ ;
+      RingBuffer<FootAbsolutePosition> ctrlLF_ ;
+      RingBuffer<FootAbsolutePosition> ctrlRF_ ;
+      RingBuffer<COMState>             ctrlCoM_ ;
+      RingBuffer<ZMPPosition>          ctrlZMP_ ;
       // deque sampled at interpolation time
-      deque<COMState>             intCoM_ ;
-      deque<FootAbsolutePosition> intLF_  ;
-      deque<FootAbsolutePosition> intRF_  ;
+      RingBuffer<COMState>             intCoM_ ;
+      RingBuffer<FootAbsolutePosition> intLF_  ;
+      RingBuffer<FootAbsolutePosition> intRF_  ;
       // output of the filter
-      deque<COMState>     outputDeltaCoM_ ;
+      RingBuffer<COMState>     outputDeltaCoM_ ;
       // size of the Dynamic Filter preview
       double DFpreviewWindowSize_ ;
 
@@ -1,4 +1,10 @@
+#define BOOST_BIND_GLOBAL_PLACEHOLDERS
+#include <boost/bind.hpp>
+
 #include "DynamicFilter.hh"
+#include "TraceRecorder.hh"
+#include "WorkStealingPool.hh"
+#include <Debug.hh>
 //#include "metapod/algos/rnea.hh"
 #include <iomanip>
 using namespace std;
@@ -18,6 +24,7 @@ DynamicFilter::DynamicFilter(
   previewWindowSize_   = 0.0 ;
   kajitaPCwindowSize_  = 0.0 ;
   CoMHeight_           = 0.0 ;
+  iterationDebug_      = 0 ;
 
   PR_ = aPR ;
 
@@ -40,6 +47,10 @@ DynamicFilter::DynamicFilter(
   aRightFootPosition_.resize(5);
   deltax_.resize(3,1);
   deltay_.resize(3,1);
+  legJacobian_.resize(6,6);
+  legTwist_.resize(6);
+  legRates_.resize(6);
+  legLU_ = Eigen::PartialPivLU<Eigen::MatrixXd>(6);
 
   comAndFootRealization_->SetPreviousConfigurationStage0(
         PR_->currentConfiguration());
@@ -62,10 +73,20 @@ DynamicFilter::DynamicFilter(
   walkingHeuristic_ = false ;
   useDynamicFilter_ = false ;
 
+  pool_ = 0 ;
+
+  lastHorizon_ = 0 ;
+  incrementalTolerance_ = 0.0 ;
+  nbOfReusedZMPMB_ = 0 ;
+  nbOfComputedZMPMB_ = 0 ;
+
   // Register method to handle
-  const unsigned int NbMethods = 1;
+  const unsigned int NbMethods = 4;
   const char *lMethodNames[NbMethods] =
-  {":useDynamicFilter"};
+  {":useDynamicFilter",
+   ":dynamicfilterworkers",
+   ":dynamicfilterincremental",
+   ":dynamicfilterhitrate"};
   for(unsigned int i=0;i<NbMethods;i++)
   {
     std::string aMethodName(lMethodNames[i]);
@@ -86,6 +107,32 @@ DynamicFilter::~DynamicFilter()
       delete comAndFootRealization_;
       comAndFootRealization_ = 0 ;
     }
+  deleteWorkers();
+}
+
+void DynamicFilter::deleteWorkers()
+{
+  if (pool_!=0){
+      delete pool_;
+      pool_ = 0 ;
+    }
+  for(unsigned int i=0;i<workers_.size();++i)
+    delete workers_[i].data ;
+  workers_.clear();
+}
+
+void DynamicFilter::setNbOfWorkers(unsigned int NbOfWorkers)
+{
+  if (NbOfWorkers==workers_.size())
+    return;
+  deleteWorkers();
+  if (NbOfWorkers==0)
+    return;
+
+  workers_.resize(NbOfWorkers);
+  for(unsigned int i=0;i<NbOfWorkers;++i)
+    workers_[i].data = PR_->newData();
+  pool_ = new WorkStealingPool(NbOfWorkers);
 }
 
 void DynamicFilter::CallMethod(string &Method, istringstream &strm)
@@ -99,12 +146,58 @@ void DynamicFilter::CallMethod(string &Method, istringstream &strm)
       strm >> useDynamicFilter;
       useDynamicFilter_ = useDynamicFilter=="true"? true:false ;
     }
+    else if (Method==":dynamicfilterworkers")
+    {
+      unsigned int NbOfWorkers=0;
+      strm >> NbOfWorkers;
+      setNbOfWorkers(NbOfWorkers);
+    }
+    else if (Method==":dynamicfilterincremental")
+    {
+      // Either "off" or the tolerance and the number of horizons kept.
+      string lTolerance;
+      strm >> lTolerance;
+      if (lTolerance=="off")
+        setIncremental(0.0,0);
+      else
+      {
+        unsigned int lDepth=1;
+        strm >> lDepth;
+        setIncremental(atof(lTolerance.c_str()),lDepth);
+      }
+    }
+    else if (Method==":dynamicfilterhitrate")
+    {
+      // Only the filters which have been used report.
+      if (nbOfReusedZMPMB_+nbOfComputedZMPMB_>0)
+        cout << "Dynamic filter: " << nbOfReusedZMPMB_ << " ZMPMBs reused, "
+             << nbOfComputedZMPMB_ << " computed ("
+             << 100.0*getIncrementalHitRate() << " %)" << endl;
+    }
+}
+
+void DynamicFilter::setIncremental(double Tolerance, unsigned int Depth)
+{
+  incrementalTolerance_ = Tolerance ;
+  horizons_.clear();
+  lastHorizon_ = 0 ;
+  if (Depth>0)
+    horizons_.resize(Depth+1);
+  resetIncrementalStatistics();
+}
+
+void DynamicFilter::invalidateHorizons()
+{
+  for(unsigned int i=0;i<horizons_.size();++i)
+    horizons_[i].CoM.clear();
 }
 
 void DynamicFilter::setRobotUpperPart(const Eigen::VectorXd & configuration,
                                       const Eigen::VectorXd & velocity,
                                       const Eigen::VectorXd & acceleration)
 {
+  // The upper part is used by all the postures of the horizons.
+  invalidateHorizons();
   for ( unsigned int i = 0 ; i < larmIdxq_.size() ; ++i )
     {
       upperPartConfiguration_(larmIdxq_[i])  =
@@ -135,6 +228,67 @@ void DynamicFilter::setRobotUpperPart(const Eigen::VectorXd & configuration,
   return ;
 }
 
+void DynamicFilter::getState(dynamic_filter_state_t & aState) const
+{
+  aState.deltax = deltax_ ;
+  aState.deltay = deltay_ ;
+  aState.sxzmp = sxzmp_ ;
+  aState.syzmp = syzmp_ ;
+  aState.upperPartConfiguration = upperPartConfiguration_ ;
+  aState.previousUpperPartConfiguration = previousUpperPartConfiguration_ ;
+  aState.upperPartVelocity = upperPartVelocity_ ;
+  aState.previousUpperPartVelocity = previousUpperPartVelocity_ ;
+  aState.upperPartAcceleration = upperPartAcceleration_ ;
+  aState.previousZMPMBConfiguration = previousZMPMBConfiguration_ ;
+  aState.previousZMPMBVelocity = previousZMPMBVelocity_ ;
+  aState.prevConfiguration[0] =
+      comAndFootRealization_->GetPreviousConfigurationStage0();
+  aState.prevConfiguration[1] =
+      comAndFootRealization_->GetPreviousConfigurationStage1();
+  aState.prevConfiguration[2] =
+      comAndFootRealization_->GetPreviousConfigurationStage2();
+  aState.prevVelocity[0] = comAndFootRealization_->GetPreviousVelocityStage0();
+  aState.prevVelocity[1] = comAndFootRealization_->GetPreviousVelocityStage1();
+  aState.prevVelocity[2] = comAndFootRealization_->GetPreviousVelocityStage2();
+  aState.ZMPMBConfiguration = ZMPMBConfiguration_ ;
+  aState.ZMPMBVelocity = ZMPMBVelocity_ ;
+  aState.ZMPMBAcceleration = ZMPMBAcceleration_ ;
+  aState.horizons = horizons_ ;
+  aState.lastHorizon = lastHorizon_ ;
+}
+
+void DynamicFilter::setState(const dynamic_filter_state_t & aState)
+{
+  deltax_ = aState.deltax ;
+  deltay_ = aState.deltay ;
+  sxzmp_ = aState.sxzmp ;
+  syzmp_ = aState.syzmp ;
+  upperPartConfiguration_ = aState.upperPartConfiguration ;
+  previousUpperPartConfiguration_ = aState.previousUpperPartConfiguration ;
+  upperPartVelocity_ = aState.upperPartVelocity ;
+  previousUpperPartVelocity_ = aState.previousUpperPartVelocity ;
+  upperPartAcceleration_ = aState.upperPartAcceleration ;
+  previousZMPMBConfiguration_ = aState.previousZMPMBConfiguration ;
+  previousZMPMBVelocity_ = aState.previousZMPMBVelocity ;
+  comAndFootRealization_->SetPreviousConfigurationStage0(aState.prevConfiguration[0]);
+  comAndFootRealization_->SetPreviousConfigurationStage1(aState.prevConfiguration[1]);
+  comAndFootRealization_->SetPreviousConfigurationStage2(aState.prevConfiguration[2]);
+  comAndFootRealization_->SetPreviousVelocityStage0(aState.prevVelocity[0]);
+  comAndFootRealization_->SetPreviousVelocityStage1(aState.prevVelocity[1]);
+  comAndFootRealization_->SetPreviousVelocityStage2(aState.prevVelocity[2]);
+  ZMPMBConfiguration_ = aState.ZMPMBConfiguration ;
+  ZMPMBVelocity_ = aState.ZMPMBVelocity ;
+  ZMPMBAcceleration_ = aState.ZMPMBAcceleration ;
+  // The horizons are restored unless setIncremental changed their number.
+  if (aState.horizons.size()==horizons_.size())
+  {
+    horizons_ = aState.horizons ;
+    lastHorizon_ = aState.lastHorizon ;
+  }
+  else
+    invalidateHorizons();
+}
+
 /// \brief Initialise all objects, to be called just after the constructor
 /// the filter takes a subsampled previewWindow,
 /// interpolate it and use the kajita preview control on it
@@ -220,18 +374,22 @@ void DynamicFilter::init(
   comAndFootRealization_->leftArmIndexinVelocity(larmIdxv_);
   comAndFootRealization_->rightArmIndexinVelocity(rarmIdxv_);
   comAndFootRealization_->chestIndexinVelocity(chestIdxv_);
+
+  InitializeLegChain(PR_->leftFoot()->associatedAnkle,llegChain_,llegAxes_);
+  InitializeLegChain(PR_->rightFoot()->associatedAnkle,rlegChain_,rlegAxes_);
+  invalidateHorizons();
   return ;
 }
 
 int DynamicFilter::OffLinefilter(
-    const deque<COMState> &inputCOMTraj_deq_,
-    const deque<ZMPPosition> &inputZMPTraj_deq_,
-    const deque<FootAbsolutePosition> &inputLeftFootTraj_deq_,
-    const deque<FootAbsolutePosition> &inputRightFootTraj_deq_,
+    const RingBuffer<COMState> &inputCOMTraj_deq_,
+    const RingBuffer<ZMPPosition> &inputZMPTraj_deq_,
+    const RingBuffer<FootAbsolutePosition> &inputLeftFootTraj_deq_,
+    const RingBuffer<FootAbsolutePosition> &inputRightFootTraj_deq_,
     const vector< Eigen::VectorXd > & UpperPart_q,
     const vector< Eigen::VectorXd > & UpperPart_dq,
     const vector< Eigen::VectorXd > & UpperPart_ddq,
-    deque<COMState> & outputDeltaCOMTraj_deq)
+    RingBuffer<COMState> & outputDeltaCOMTraj_deq)
 {
   unsigned int N = (unsigned int)inputCOMTraj_deq_.size() ;
   deltaZMP_deq_.resize(N);
@@ -265,16 +423,30 @@ int DynamicFilter::OffLinefilter(
 }
 
 int DynamicFilter::OnLinefilter(
-    const deque<COMState> & inputCOMTraj_deq_,
-    const deque<ZMPPosition> & inputZMPTraj_deq_,
-    const deque<FootAbsolutePosition> & inputLeftFootTraj_deq_,
-    const deque<FootAbsolutePosition> & inputRightFootTraj_deq_,
-    deque<COMState> & outputDeltaCOMTraj_deq_)
+    const RingBuffer<COMState> & inputCOMTraj_deq_,
+    const RingBuffer<ZMPPosition> & inputZMPTraj_deq_,
+    const RingBuffer<FootAbsolutePosition> & inputLeftFootTraj_deq_,
+    const RingBuffer<FootAbsolutePosition> & inputRightFootTraj_deq_,
+    RingBuffer<COMState> & outputDeltaCOMTraj_deq_)
 {
   unsigned int N = (unsigned int)inputRightFootTraj_deq_.size() ;
   int inc = (int)round(interpolationPeriod_/controlPeriod_) ;
   unsigned int N1 = (unsigned int)((ZMPMB_vec_.size()-1)*inc +1 );
-  if(useDynamicFilter_)
+  if(useDynamicFilter_ && isIncremental())
+  {
+    ComputeZMPMBIncremental(inputCOMTraj_deq_,
+                            inputLeftFootTraj_deq_,
+                            inputRightFootTraj_deq_,
+                            N);
+  }
+  else if(useDynamicFilter_ && pool_!=0)
+  {
+    ComputeZMPMBInParallel(inputCOMTraj_deq_,
+                           inputLeftFootTraj_deq_,
+                           inputRightFootTraj_deq_,
+                           N);
+  }
+  else if(useDynamicFilter_)
   {
     for(unsigned int i = 0 ; i < N ; ++i)
     {
@@ -291,6 +463,9 @@ int DynamicFilter::OnLinefilter(
 //           << ZMPMBAcceleration_(4) << " "
 //           << ZMPMBAcceleration_(5) << endl ;
     }
+  }
+  if(useDynamicFilter_)
+  {
     ZMPMB_vec_[0][0]=inputZMPTraj_deq_[0].px;
     ZMPMB_vec_[0][1]=inputZMPTraj_deq_[0].py;
     ZMPMB_vec_[0][2]=0.0;
@@ -328,11 +503,16 @@ int DynamicFilter::OnLinefilter(
       for(unsigned int i = 0 ; i < N ; ++i)
         zmpmb_i_[i*inc] = ZMPMB_vec_[i] ;
 
-      vector<vector<double> > dZMPMB_vec (N,vector<double>(2,0.0)) ;
+      // The rows only grow: they are kept between two cycles.
+      if (dZMPMB_vec_.size()<N)
+        dZMPMB_vec_.resize(N,vector<double>(2,0.0)) ;
+      vector<vector<double> > & dZMPMB_vec = dZMPMB_vec_ ;
       dZMPMB_vec[0][0] = (ZMPMB_vec_[1][0]  -ZMPMB_vec_[0][0]  )/inc;
       dZMPMB_vec[0][1] = (ZMPMB_vec_[1][1]  -ZMPMB_vec_[0][1]  )/inc;
       dZMPMB_vec[N-1][0] = (ZMPMB_vec_[N-1][0]-ZMPMB_vec_[N-2][0])/inc;
       dZMPMB_vec[N-1][1] = (ZMPMB_vec_[N-1][1]-ZMPMB_vec_[N-2][1])/inc;
+      dZMPMB_vec[N-2][0] = 0.0 ;
+      dZMPMB_vec[N-2][1] = 0.0 ;
       for(unsigned i=1 ; i<N-2  ; ++i)
       {
         dZMPMB_vec[i][0] = (ZMPMB_vec_[i+1][0]-ZMPMB_vec_[i-1][0])/(2*inc);
@@ -466,9 +646,137 @@ void DynamicFilter::InverseKinematics(
     velocity(chestIdxv_[i])      = upperPartVelocity_(chestIdxv_[i]);
     acceleration(chestIdxv_[i])  = upperPartAcceleration_(chestIdxv_[i]);
   }
+
+  // The legs follow the feet exactly: replace the finite differences
+  // of the inverse kinematics by the rates of the feet trajectories.
+  if (llegChain_.size()==llegIdxv_.size() &&
+      rlegChain_.size()==rlegIdxv_.size() &&
+      !llegChain_.empty() && !rlegChain_.empty())
+  {
+    PR_->computeForwardKinematics(configuration);
+    LegRates(inputLeftFoot,llegChain_,llegAxes_,llegIdxv_,
+             velocity,acceleration);
+    LegRates(inputRightFoot,rlegChain_,rlegAxes_,rlegIdxv_,
+             velocity,acceleration);
+  }
   return;
 }
 
+void DynamicFilter::InitializeLegChain(
+    pinocchio::JointIndex anAnkle,
+    std::vector<pinocchio::JointIndex> & aChain,
+    std::vector<Eigen::Vector3d> & someAxes)
+{
+  aChain.clear();
+  someAxes.clear();
+  if (anAnkle==0)
+    return;
+
+  // Remove the free flyer, as for the indexes of the legs.
+  aChain = PR_->jointsBetween(PR_->waist(),anAnkle);
+  if (!aChain.empty())
+    aChain.erase(aChain.begin());
+
+  for(unsigned int i=0;i<aChain.size();++i)
+  {
+    std::string aShortName = PR_->Model()->joints[aChain[i]].shortname();
+    if (aShortName=="JointModelRX")
+      someAxes.push_back(Eigen::Vector3d::UnitX());
+    else if (aShortName=="JointModelRY")
+      someAxes.push_back(Eigen::Vector3d::UnitY());
+    else if (aShortName=="JointModelRZ")
+      someAxes.push_back(Eigen::Vector3d::UnitZ());
+    else
+      break;
+  }
+  if (aChain.size()!=6 || someAxes.size()!=aChain.size())
+  {
+    ODEBUG("Leg ending at joint " << anAnkle << " not handled: "
+           "finite differences for its joint rates");
+    aChain.clear();
+    someAxes.clear();
+  }
+}
+
+void DynamicFilter::LegRates(
+    const FootAbsolutePosition & aFoot,
+    const std::vector<pinocchio::JointIndex> & aChain,
+    const std::vector<Eigen::Vector3d> & someAxes,
+    const std::vector<int> & aLegIdxv,
+    Eigen::VectorXd & velocity,
+    Eigen::VectorXd & acceleration)
+{
+  const pinocchio::Data & aData = *PR_->Data();
+  const double ToRad = M_PI/180.0;
+
+  // Motion of the waist as seen by the inverse dynamics: the angular
+  // part is expressed in the waist frame, and the linear acceleration
+  // is the spatial one.
+  const Eigen::Matrix3d Rw = aData.oMi[PR_->waist()].rotation();
+  const Eigen::Vector3d pw = aData.oMi[PR_->waist()].translation();
+  const Eigen::Vector3d vw = velocity.segment<3>(0);
+  const Eigen::Vector3d ww = Rw*velocity.segment<3>(3);
+  const Eigen::Vector3d dww = Rw*acceleration.segment<3>(3);
+  const Eigen::Vector3d aw = acceleration.segment<3>(0) + ww.cross(vw);
+
+  // Twist of the ankle: the foot turns of theta around z
+  // then of omega around the rotated y axis.
+  const Eigen::Vector3d pa = aData.oMi[aChain.back()].translation();
+  double c = cos(aFoot.theta*ToRad), s = sin(aFoot.theta*ToRad);
+  const Eigen::Vector3d ey(-s,c,0.0);
+  const Eigen::Vector3d ez = Eigen::Vector3d::UnitZ();
+  const Eigen::Vector3d wf = aFoot.dtheta*ToRad*ez + aFoot.domega*ToRad*ey;
+  const Eigen::Vector3d dwf = aFoot.ddtheta*ToRad*ez
+    + aFoot.ddomega*ToRad*ey
+    + aFoot.dtheta*ToRad*ez.cross(aFoot.domega*ToRad*ey);
+  const Eigen::Vector3d r = pa - Eigen::Vector3d(aFoot.x,aFoot.y,aFoot.z);
+  const Eigen::Vector3d va = Eigen::Vector3d(aFoot.dx,aFoot.dy,aFoot.dz)
+    + wf.cross(r);
+  const Eigen::Vector3d aa = Eigen::Vector3d(aFoot.ddx,aFoot.ddy,aFoot.ddz)
+    + dwf.cross(r) + wf.cross(wf.cross(r));
+
+  // Geometric jacobian of the leg at the ankle.
+  for(unsigned int k=0;k<aChain.size();++k)
+  {
+    const Eigen::Vector3d zk = aData.oMi[aChain[k]].rotation()*someAxes[k];
+    const Eigen::Vector3d pk = aData.oMi[aChain[k]].translation();
+    legJacobian_.block<3,1>(0,k) = zk.cross(pa-pk);
+    legJacobian_.block<3,1>(3,k) = zk;
+  }
+  legLU_.compute(legJacobian_);
+  if (fabs(legLU_.determinant())<1e-8)
+  {
+    ODEBUG("Singular leg jacobian: finite differences kept");
+    return;
+  }
+
+  legTwist_.segment<3>(0) = va - vw - ww.cross(pa-pw);
+  legTwist_.segment<3>(3) = wf - ww;
+  legRates_ = legLU_.solve(legTwist_);
+  for(unsigned int k=0;k<aLegIdxv.size();++k)
+    velocity(aLegIdxv[k]) = legRates_(k);
+
+  // Acceleration of the ankle for null joint accelerations,
+  // from the waist down to the ankle.
+  Eigen::Vector3d w = ww, dw = dww, a = aw, p = pw;
+  for(unsigned int k=0;k<aChain.size();++k)
+  {
+    const Eigen::Vector3d zk = legJacobian_.block<3,1>(3,k);
+    const Eigen::Vector3d pk = aData.oMi[aChain[k]].translation();
+    a += dw.cross(pk-p) + w.cross(w.cross(pk-p));
+    p = pk;
+    dw += w.cross(zk*legRates_(k));
+    w += zk*legRates_(k);
+  }
+  a += dw.cross(pa-p) + w.cross(w.cross(pa-p));
+
+  legTwist_.segment<3>(0) = aa - a;
+  legTwist_.segment<3>(3) = dwf - dw;
+  legRates_ = legLU_.solve(legTwist_);
+  for(unsigned int k=0;k<aLegIdxv.size();++k)
+    acceleration(aLegIdxv[k]) = legRates_(k);
+}
+
 void DynamicFilter::stage0INstage1()
 {
   comAndFootRealization_->SetPreviousConfigurationStage1(
@@ -502,9 +810,269 @@ void DynamicFilter::ComputeZMPMB(double samplingPeriod,
   return ;
 }
 
+void DynamicFilter::ComputeZMPMBInParallel(
+    const RingBuffer<COMState> & inputCOMTraj_deq_,
+    const RingBuffer<FootAbsolutePosition> & inputLeftFootTraj_deq_,
+    const RingBuffer<FootAbsolutePosition> & inputRightFootTraj_deq_,
+    unsigned int N)
+{
+  configurations_.resize(N);
+  velocities_.resize(N);
+  accelerations_.resize(N);
+  for(unsigned int i = 0 ; i < N ; ++i)
+  {
+    SeedPosture(i);
+    InverseKinematics(inputCOMTraj_deq_[i],
+                      inputLeftFootTraj_deq_[i],
+                      inputRightFootTraj_deq_[i],
+                      configurations_[i], velocities_[i], accelerations_[i],
+                      interpolationPeriod_, stage1_, i) ;
+  }
+
+  pending_.clear();
+  for(unsigned int i = 1 ; i < N ; ++i)
+    pending_.push_back(i);
+  ComputePendingZMPMB();
+
+  // Same state as after the sequential loop.
+  if (N>0)
+  {
+    ZMPMBConfiguration_ = configurations_[N-1] ;
+    ZMPMBVelocity_      = velocities_[N-1] ;
+    ZMPMBAcceleration_  = accelerations_[N-1] ;
+  }
+}
+
+void DynamicFilter::SeedPosture(unsigned int i)
+{
+  // The inverse kinematics does not set all the joints: the other ones
+  // keep the values of the previous posture, as in the sequential loop
+  // which always uses ZMPMBConfiguration_.
+  if (i==0)
+  {
+    configurations_[0] = ZMPMBConfiguration_ ;
+    velocities_[0]     = ZMPMBVelocity_ ;
+    accelerations_[0]  = ZMPMBAcceleration_ ;
+  }
+  else
+  {
+    configurations_[i] = configurations_[i-1] ;
+    velocities_[i]     = velocities_[i-1] ;
+    accelerations_[i]  = accelerations_[i-1] ;
+  }
+}
+
+void DynamicFilter::ComputePendingZMPMB()
+{
+  unsigned int N = (unsigned int)pending_.size();
+  // A few chunks per worker, so that the faster ones can steal the rest.
+  unsigned int NbOfChunks = 4*(unsigned int)workers_.size();
+  unsigned int ChunkSize = (N+NbOfChunks-1)/NbOfChunks;
+  if (ChunkSize==0)
+    ChunkSize=1;
+  for(unsigned int begin = 0 ; begin < N ; begin += ChunkSize)
+  {
+    unsigned int end = std::min(begin+ChunkSize,N);
+    pool_->Submit(boost::bind(&DynamicFilter::ComputeZMPMBRange,
+                              this,begin,end,_1));
+  }
+  pool_->Wait();
+}
+
+void DynamicFilter::ComputeZMPMBRange(unsigned int begin, unsigned int end,
+                                      unsigned int WorkerId)
+{
+  zmpmb_worker_t & aWorker = workers_[WorkerId] ;
+  for(unsigned int k = begin ; k < end ; ++k)
+  {
+    unsigned int i = pending_[k] ;
+    PR_->zeroMomentumPoint(configurations_[i],
+                           velocities_[i],
+                           accelerations_[i],
+                           *aWorker.data,
+                           aWorker.q, aWorker.v, aWorker.a,
+                           ZMPMB_vec_[i]);
+  }
+}
+
+namespace
+{
+  bool SameCoMState(const COMState & a, const COMState & b,
+                    double Tolerance)
+  {
+    for(unsigned int k=0;k<3;++k)
+      if (fabs(a.x[k]-b.x[k])>Tolerance ||
+          fabs(a.y[k]-b.y[k])>Tolerance ||
+          fabs(a.z[k]-b.z[k])>Tolerance ||
+          fabs(a.roll[k]-b.roll[k])>Tolerance ||
+          fabs(a.pitch[k]-b.pitch[k])>Tolerance ||
+          fabs(a.yaw[k]-b.yaw[k])>Tolerance)
+        return false;
+    return true;
+  }
+
+  bool SameFoot(const FootAbsolutePosition & a,
+                const FootAbsolutePosition & b,
+                double Tolerance)
+  {
+    return fabs(a.x-b.x)<=Tolerance &&
+      fabs(a.y-b.y)<=Tolerance &&
+      fabs(a.z-b.z)<=Tolerance &&
+      fabs(a.theta-b.theta)<=Tolerance &&
+      fabs(a.omega-b.omega)<=Tolerance;
+  }
+}
+
+void DynamicFilter::ComputeZMPMBIncremental(
+    const RingBuffer<COMState> & inputCOMTraj_deq_,
+    const RingBuffer<FootAbsolutePosition> & inputLeftFootTraj_deq_,
+    const RingBuffer<FootAbsolutePosition> & inputRightFootTraj_deq_,
+    unsigned int N)
+{
+  if (N==0)
+    return;
+  const double lTol = incrementalTolerance_ ;
+  unsigned int NbOfHorizons = (unsigned int)horizons_.size();
+  unsigned int lWrite = (lastHorizon_+1)%NbOfHorizons ;
+
+  // Most recent horizon containing the first two samples, and the
+  // index of the first one in it. Between two calls the horizon is
+  // usually the previous one shifted by a few samples.
+  const zmpmb_horizon_t * lRef = 0 ;
+  unsigned int lShift = 0 ;
+  for(unsigned int k = 0 ; k+1 < NbOfHorizons && lRef==0 ; ++k)
+  {
+    const zmpmb_horizon_t & aHorizon =
+      horizons_[(lastHorizon_+NbOfHorizons-k)%NbOfHorizons] ;
+    unsigned int lSize = (unsigned int)aHorizon.CoM.size();
+    for(unsigned int s = 0 ; s < lSize ; ++s)
+    {
+      if (!SameCoMState(inputCOMTraj_deq_[0],aHorizon.CoM[s],lTol) ||
+          !SameFoot(inputLeftFootTraj_deq_[0],aHorizon.LeftFoot[s],lTol) ||
+          !SameFoot(inputRightFootTraj_deq_[0],aHorizon.RightFoot[s],lTol))
+        continue;
+      if (N>1 &&
+          (s+1>=lSize ||
+           !SameCoMState(inputCOMTraj_deq_[1],aHorizon.CoM[s+1],lTol) ||
+           !SameFoot(inputLeftFootTraj_deq_[1],aHorizon.LeftFoot[s+1],lTol) ||
+           !SameFoot(inputRightFootTraj_deq_[1],aHorizon.RightFoot[s+1],lTol)))
+        continue;
+      lRef = &aHorizon ;
+      lShift = s ;
+      break;
+    }
+  }
+
+  configurations_.resize(N);
+  velocities_.resize(N);
+  accelerations_.resize(N);
+  pending_.clear();
+
+  bool lPreviousReused = false ;
+  unsigned int lNbOfMatches = 0 ;
+  for(unsigned int i = 0 ; i < N ; ++i)
+  {
+    unsigned int j = i+lShift ;
+    bool lMatch = lRef!=0 && j<lRef->CoM.size() &&
+      SameCoMState(inputCOMTraj_deq_[i],lRef->CoM[j],lTol) &&
+      SameFoot(inputLeftFootTraj_deq_[i],lRef->LeftFoot[j],lTol) &&
+      SameFoot(inputRightFootTraj_deq_[i],lRef->RightFoot[j],lTol);
+    lNbOfMatches = lMatch ? lNbOfMatches+1 : 0 ;
+
+    // The velocity and the acceleration are finite differences on the
+    // two previous postures, and are zero for the first two iterations.
+    bool lReused = lNbOfMatches >= std::min(i+1,3u) &&
+      (i>=2 || lShift==0) ;
+    if (lReused)
+    {
+      configurations_[i] = lRef->configurations[j] ;
+      velocities_[i]     = lRef->velocities[j] ;
+      accelerations_[i]  = lRef->accelerations[j] ;
+      ZMPMB_vec_[i]      = lRef->ZMPMB[j] ;
+      if (i>0)
+        ++nbOfReusedZMPMB_ ;
+    }
+    else
+    {
+      if (lPreviousReused)
+      {
+        comAndFootRealization_->
+          SetPreviousConfigurationStage1(configurations_[i-1]);
+        comAndFootRealization_->
+          SetPreviousVelocityStage1(velocities_[i-1]);
+      }
+      SeedPosture(i);
+      InverseKinematics(inputCOMTraj_deq_[i],
+                        inputLeftFootTraj_deq_[i],
+                        inputRightFootTraj_deq_[i],
+                        configurations_[i], velocities_[i], accelerations_[i],
+                        interpolationPeriod_, stage1_, i) ;
+      if (i>0)
+      {
+        ++nbOfComputedZMPMB_ ;
+        if (pool_!=0)
+          pending_.push_back(i);
+        else
+        {
+          PR_->computeInverseDynamics(configurations_[i],
+                                      velocities_[i],
+                                      accelerations_[i]);
+          PR_->zeroMomentumPoint(ZMPMB_vec_[i]);
+        }
+      }
+    }
+    lPreviousReused = lReused ;
+  }
+
+  // Same state of the inverse kinematics as after the sequential loop.
+  if (lPreviousReused)
+  {
+    if (N>1)
+    {
+      comAndFootRealization_->
+        SetPreviousConfigurationStage1(configurations_[N-2]);
+      comAndFootRealization_->
+        SetPreviousVelocityStage1(velocities_[N-2]);
+    }
+    SeedPosture(N-1);
+    InverseKinematics(inputCOMTraj_deq_[N-1],
+                      inputLeftFootTraj_deq_[N-1],
+                      inputRightFootTraj_deq_[N-1],
+                      configurations_[N-1],
+                      velocities_[N-1],
+                      accelerations_[N-1],
+                      interpolationPeriod_, stage1_, N-1) ;
+  }
+
+  if (!pending_.empty())
+    ComputePendingZMPMB();
+
+  ZMPMBConfiguration_ = configurations_[N-1] ;
+  ZMPMBVelocity_      = velocities_[N-1] ;
+  ZMPMBAcceleration_  = accelerations_[N-1] ;
+
+  // Keep this horizon in place of the oldest one.
+  zmpmb_horizon_t & aHorizon = horizons_[lWrite] ;
+  aHorizon.CoM.resize(N);
+  aHorizon.LeftFoot.resize(N);
+  aHorizon.RightFoot.resize(N);
+  aHorizon.ZMPMB.resize(N);
+  for(unsigned int i = 0 ; i < N ; ++i)
+  {
+    aHorizon.CoM[i]       = inputCOMTraj_deq_[i] ;
+    aHorizon.LeftFoot[i]  = inputLeftFootTraj_deq_[i] ;
+    aHorizon.RightFoot[i] = inputRightFootTraj_deq_[i] ;
+    aHorizon.ZMPMB[i]     = ZMPMB_vec_[i] ;
+  }
+  aHorizon.configurations.swap(configurations_);
+  aHorizon.velocities.swap(velocities_);
+  aHorizon.accelerations.swap(accelerations_);
+  lastHorizon_ = lWrite ;
+}
+
 int DynamicFilter::OptimalControl(
-    deque<ZMPPosition> & inputdeltaZMP_deq,
-    deque<COMState> & outputDeltaCOMTraj_deq_)
+    RingBuffer<ZMPPosition> & inputdeltaZMP_deq,
+    RingBuffer<COMState> & outputDeltaCOMTraj_deq_)
 {
   assert(PC_->IsCoherent());
   std::size_t Nctrl = (int)round(controlWindowSize_/controlPeriod_) ;
@@ -518,19 +1086,16 @@ int DynamicFilter::OptimalControl(
   //    deltax_(i,0)=0.0;
   //    deltay_(i,0)=0.0;
   //  }
-  for (std::size_t i = 0 ; i < Nctrl ; ++i )
-  {
-    PC_->OneIterationOfPreview(deltax_,deltay_,
-                               sxzmp_[0],syzmp_[0],
-                               inputdeltaZMP_deq,i,
-                               deltaZMPx, deltaZMPy,
-			       false);
-    for(int j=0;j<3;++j)
-    {
-      outputDeltaCOMTraj_deq_[i].x[j] = deltax_(j,0);
-      outputDeltaCOMTraj_deq_[i].y[j] = deltay_(j,0);
-    }
-  }
+  // The window is copied once and shared by all the iterations.
+  PreviewControl::FillPreviewWindow(inputdeltaZMP_deq,0,
+                                    inputdeltaZMP_deq.size(),
+                                    deltaZMPWindow_);
+  PC_->IterationsOfPreview(deltax_,deltay_,
+                           sxzmp_[0],syzmp_[0],
+                           deltaZMPWindow_,0,Nctrl,
+                           outputDeltaCOMTraj_deq_,
+                           deltaZMPx, deltaZMPy,
+                           false);
   // test to verify if the Kajita PC diverged
   for (std::size_t i = 0 ; i < Nctrl ; ++i)
     {
@@ -726,16 +1291,25 @@ int DynamicFilter::OptimalControl(
 //  return ;
 //}
 
-void DynamicFilter::Debug(const deque<COMState> & ctrlCoMState,
-                          const deque<FootAbsolutePosition> & ctrlLeftFoot,
-                          const deque<FootAbsolutePosition> & ctrlRightFoot,
-                          const deque<COMState> & inputCOMTraj_deq_,
-                          const deque<ZMPPosition> inputZMPTraj_deq_,
-                          const deque<FootAbsolutePosition> & inputLeftFootTraj_deq_,
-                          const deque<FootAbsolutePosition> & inputRightFootTraj_deq_,
-                          const deque<COMState> & outputDeltaCOMTraj_deq_)
+void DynamicFilter::Debug(const RingBuffer<COMState> & ctrlCoMState,
+                          const RingBuffer<FootAbsolutePosition> & ctrlLeftFoot,
+                          const RingBuffer<FootAbsolutePosition> & ctrlRightFoot,
+                          const RingBuffer<COMState> & inputCOMTraj_deq_,
+                          const RingBuffer<ZMPPosition> inputZMPTraj_deq_,
+                          const RingBuffer<FootAbsolutePosition> & inputLeftFootTraj_deq_,
+                          const RingBuffer<FootAbsolutePosition> & inputRightFootTraj_deq_,
+                          const RingBuffer<COMState> & outputDeltaCOMTraj_deq_)
 {
-  deque<COMState> CoM_tmp = ctrlCoMState ;
+  // The rows are recorded by the trace recorder, TraceToDat rebuilds
+  // the text files from its output.
+  TraceRecorder & aRecorder = TraceRecorder::Instance();
+  if (!aRecorder.IsRunning())
+  {
+    iterationDebug_++;
+    return ;
+  }
+
+  RingBuffer<COMState> CoM_tmp = ctrlCoMState ;
   int Nctrl = (int)round(controlWindowSize_/controlPeriod_) ;
 
   for (int i = 0 ; i < Nctrl ; ++i)
@@ -777,25 +1351,18 @@ void DynamicFilter::Debug(const deque<COMState> & ctrlCoMState,
   }
 
   int inc = (int)round(interpolationPeriod_/controlPeriod_) ;
-  ofstream aof;
-  string aFileName;
-  static int iteration_zmp = 0 ;
-  ostringstream oss(std::ostringstream::ate);
-  oss.str("/tmp/zmpmb_herdt.txt");
-  aFileName = oss.str();
-  if ( iteration_zmp == 0 )
-  {
-    aof.open(aFileName.c_str(),ofstream::out);
-    aof.close();
-  }
+  static unsigned int lZMPMBChannel = aRecorder.Channel("zmpmb_herdt.txt");
+  static unsigned int lZMPMBCorrChannel =
+    aRecorder.Channel("zmpmb_corr_herdt.txt");
+  // The buffers of all the iterations share one channel,
+  // each row starts with the iteration number.
+  static unsigned int lBufferChannel = aRecorder.Channel("buffer.txt");
 
-  aof.open(aFileName.c_str(),ofstream::app);
-  aof.precision(8);
-  aof.setf(ios::scientific, ios::floatfield);
   int NbI = (int)round(controlWindowSize_/interpolationPeriod_) ;
   for (int i = 0 ; i < NbI ; ++i)
   {
-    aof << (iteration_zmp+i)*interpolationPeriod_ << " " ;       // 1
+    TraceEntry aof(lZMPMBChannel);
+    aof << (iterationDebug_+i)*interpolationPeriod_ << " " ;       // 1
 
     aof << inputZMPTraj_deq_[i*inc].px << " " ;       // 1
     aof << inputZMPTraj_deq_[i*inc].py << " " ;       // 2
@@ -871,22 +1438,11 @@ void DynamicFilter::Debug(const deque<COMState> & ctrlCoMState,
     //119
     for (unsigned int k = 0 ; k < acc[it_subsample].size() ; ++k)
       aof << acc[it_subsample](k) << " " ;
-
-    aof << endl ;
   }
-  aof.close();
 
-  aFileName = "/tmp/zmpmb_corr_herdt.txt" ;
-  if ( iteration_zmp == 0 )
-  {
-    aof.open(aFileName.c_str(),ofstream::out);
-    aof.close();
-  }
-  aof.open(aFileName.c_str(),ofstream::app);
-  aof.precision(8);
-  aof.setf(ios::scientific, ios::floatfield);
   for (int i = 0 ; i < Nctrl ; ++i)
   {
+    TraceEntry aof(lZMPMBCorrChannel);
     aof << zmpmb_corr[i][0] << " " ;                    // 1
     aof << zmpmb_corr[i][1] << " " ;                    // 2
     aof << outputDeltaCOMTraj_deq_[i].x[0] << " "  ;    // 3
@@ -907,22 +1463,12 @@ void DynamicFilter::Debug(const deque<COMState> & ctrlCoMState,
       aof << vel[i][j] << " " ;
     for(unsigned j=0 ; j<acc[i].size() ; ++j)// 15+nq
       aof << acc[i][j] << " " ;                        //
-    aof << endl ;
   }
-  aof.close();
-
-  oss.str("/tmp/buffer_");
-  oss << setfill('0') << setw(3) << iteration_zmp << ".txt" ;
-  aFileName = oss.str();
-  aof.open(aFileName.c_str(),ofstream::out);
-  aof.close();
 
-  aof.open(aFileName.c_str(),ofstream::app);
-  aof.precision(8);
-  aof.setf(ios::scientific, ios::floatfield);
-  //for (int i = 0 ; i < zmpmb_i_.size() ; ++i)
   for (int i = 0 ; i < (int)zmpmb_i_.size() ; ++i)
   {
+    TraceEntry aof(lBufferChannel);
+    aof << iterationDebug_ << " " ; // iteration
     aof << i << " " ; // 0
     aof << inputZMPTraj_deq_[i].px << " " ;           // 1
     aof << inputZMPTraj_deq_[i].py << " " ;           // 2
@@ -980,9 +1526,7 @@ void DynamicFilter::Debug(const deque<COMState> & ctrlCoMState,
 
     aof << deltaZMP_deq_[i].px << " " ;    // 41
     aof << deltaZMP_deq_[i].py << " " ;    // 42
-    aof << endl ;
   }
-  aof.close();
-  iteration_zmp++;
+  iterationDebug_++;
   return ;
 }
@@ -34,6 +34,36 @@ ground plan taking into account the whole body motion */
 
 namespace PatternGeneratorJRL
 {
+  class WorkStealingPool;
+
+  /// \brief Inputs and results of one call to OnLinefilter,
+  /// kept by the incremental mode.
+  struct zmpmb_horizon_t
+  {
+    vector< COMState > CoM ;
+    vector< FootAbsolutePosition > LeftFoot, RightFoot ;
+    vector< Eigen::VectorXd > configurations ;
+    vector< Eigen::VectorXd > velocities ;
+    vector< Eigen::VectorXd > accelerations ;
+    vector< Eigen::Vector3d > ZMPMB ;
+  };
+
+  /// \brief Part of the dynamic filter kept from one call to the next,
+  /// including the previous postures of its inverse kinematics and
+  /// the horizons of the incremental mode.
+  struct dynamic_filter_state_t
+  {
+    Eigen::MatrixXd deltax, deltay ;
+    vector<double> sxzmp, syzmp ;
+    Eigen::VectorXd upperPartConfiguration, previousUpperPartConfiguration ;
+    Eigen::VectorXd upperPartVelocity, previousUpperPartVelocity ;
+    Eigen::VectorXd upperPartAcceleration ;
+    Eigen::VectorXd previousZMPMBConfiguration, previousZMPMBVelocity ;
+    Eigen::VectorXd prevConfiguration[3], prevVelocity[3] ;
+    Eigen::VectorXd ZMPMBConfiguration, ZMPMBVelocity, ZMPMBAcceleration ;
+    vector< zmpmb_horizon_t > horizons ;
+    unsigned int lastHorizon ;
+  };
 
   class DynamicFilter : SimplePlugin
   {
@@ -46,20 +76,20 @@ namespace PatternGeneratorJRL
     ~DynamicFilter();
     /// \brief
     int OffLinefilter(
-        const deque<COMState> & inputCOMTraj_deq_,
-        const deque<ZMPPosition> & inputZMPTraj_deq_,
-        const deque<FootAbsolutePosition> & inputLeftFootTraj_deq_,
-        const deque<FootAbsolutePosition> & inputRightFootTraj_deq_,
+        const RingBuffer<COMState> & inputCOMTraj_deq_,
+        const RingBuffer<ZMPPosition> & inputZMPTraj_deq_,
+        const RingBuffer<FootAbsolutePosition> & inputLeftFootTraj_deq_,
+        const RingBuffer<FootAbsolutePosition> & inputRightFootTraj_deq_,
         const vector<Eigen::VectorXd > &UpperPart_q,
         const vector<Eigen::VectorXd > &UpperPart_dq,
         const vector<Eigen::VectorXd > &UpperPart_ddq,
-        deque<COMState> & outputDeltaCOMTraj_deq_);
+        RingBuffer<COMState> & outputDeltaCOMTraj_deq_);
 
-    int OnLinefilter(const deque<COMState> & inputCOMTraj_deq_,
-        const deque<ZMPPosition> & inputZMPTraj_deq_,
-        const deque<FootAbsolutePosition> & inputLeftFootTraj_deq_,
-        const deque<FootAbsolutePosition> & inputRightFootTraj_deq_,
-        deque<COMState> & outputDeltaCOMTraj_deq_);
+    int OnLinefilter(const RingBuffer<COMState> & inputCOMTraj_deq_,
+        const RingBuffer<ZMPPosition> & inputZMPTraj_deq_,
+        const RingBuffer<FootAbsolutePosition> & inputLeftFootTraj_deq_,
+        const RingBuffer<FootAbsolutePosition> & inputRightFootTraj_deq_,
+        RingBuffer<COMState> & outputDeltaCOMTraj_deq_);
 
     void init(
         double controlPeriod,
@@ -93,9 +123,37 @@ namespace PatternGeneratorJRL
 
     void stage0INstage1();
 
+    /// \brief Number of threads computing the ZMPMBs of the preview
+    /// window in OnLinefilter. With 0 (default) they are computed
+    /// sequentially by the calling thread.
+    void setNbOfWorkers(unsigned int NbOfWorkers);
+    inline unsigned int getNbOfWorkers() const
+    { return (unsigned int)workers_.size(); }
+
+    /// \brief Incremental mode of OnLinefilter: the ZMPMBs of the
+    /// samples whose CoM and feet are the ones of a sample of the
+    /// Depth previous calls, within Tolerance, are reused.
+    /// Depth 0 (default) disables the mode.
+    void setIncremental(double Tolerance, unsigned int Depth);
+    inline bool isIncremental() const
+    { return !horizons_.empty(); }
+
+    /// \brief Number of ZMPMBs reused and computed in incremental mode.
+    inline unsigned long int NbOfReusedZMPMB() const
+    { return nbOfReusedZMPMB_; }
+    inline unsigned long int NbOfComputedZMPMB() const
+    { return nbOfComputedZMPMB_; }
+    /// \brief Ratio of the ZMPMBs reused in incremental mode.
+    inline double getIncrementalHitRate() const
+    { return (nbOfReusedZMPMB_+nbOfComputedZMPMB_==0) ? 0.0 :
+        (double)nbOfReusedZMPMB_/
+        (double)(nbOfReusedZMPMB_+nbOfComputedZMPMB_); }
+    inline void resetIncrementalStatistics()
+    { nbOfReusedZMPMB_ = nbOfComputedZMPMB_ = 0; }
+
     /// \brief Preview control on the ZMPMBs computed
-    int OptimalControl(deque<ZMPPosition> &inputdeltaZMP_deq,
-        deque<COMState> & outputDeltaCOMTraj_deq_);
+    int OptimalControl(RingBuffer<ZMPPosition> &inputdeltaZMP_deq,
+        RingBuffer<COMState> & outputDeltaCOMTraj_deq_);
 
     /// \brief compute the zmpmb from articulated pos vel and acc
     int zmpmb(Eigen::VectorXd& configuration,
@@ -107,6 +165,63 @@ namespace PatternGeneratorJRL
 
   private: // Private methods
 
+    /// \brief ZMPMBs of the preview window computed by the workers.
+    /// The inverse kinematics is done sequentially first because its
+    /// finite differences depend on the previous posture, then the
+    /// inverse dynamics of each posture is shared among the workers.
+    void ComputeZMPMBInParallel(
+        const RingBuffer<COMState> & inputCOMTraj_deq_,
+        const RingBuffer<FootAbsolutePosition> & inputLeftFootTraj_deq_,
+        const RingBuffer<FootAbsolutePosition> & inputRightFootTraj_deq_,
+        unsigned int N);
+
+    /// \brief ZMPMBs of the preview window in incremental mode.
+    /// The samples which are not reused are computed as in the
+    /// sequential loop, or by the workers if there are some.
+    void ComputeZMPMBIncremental(
+        const RingBuffer<COMState> & inputCOMTraj_deq_,
+        const RingBuffer<FootAbsolutePosition> & inputLeftFootTraj_deq_,
+        const RingBuffer<FootAbsolutePosition> & inputRightFootTraj_deq_,
+        unsigned int N);
+
+    /// \brief Initial value of the posture i before its inverse
+    /// kinematics, the same as in the sequential loop.
+    void SeedPosture(unsigned int i);
+
+    /// \brief Share the ZMPMBs of the postures in pending_
+    /// among the workers, and wait for them.
+    void ComputePendingZMPMB();
+
+    /// \brief Task of the workers: ZMPMBs of the postures
+    /// pending_[begin] to pending_[end-1].
+    void ComputeZMPMBRange(unsigned int begin, unsigned int end,
+                           unsigned int WorkerId);
+
+    /// \brief Drop the horizons kept by the incremental mode.
+    void invalidateHorizons();
+
+    /// \brief Joints from the hip to the ankle and their axes
+    /// in the joint frames. The chain is left empty when it is not
+    /// made of six revolute joints about the X, Y or Z axis.
+    void InitializeLegChain(pinocchio::JointIndex anAnkle,
+                            std::vector<pinocchio::JointIndex> & aChain,
+                            std::vector<Eigen::Vector3d> & someAxes);
+
+    /// \brief Velocities and accelerations of the joints of one leg
+    /// such that the ankle follows aFoot, given the motion of the waist
+    /// in velocity and acceleration. They are the solutions of
+    /// J dq = V - Vwaist and J ddq = A - dJ dq with J the geometric
+    /// jacobian of the leg at the posture of the last forward kinematics.
+    /// The values of the finite differences are kept if J is singular.
+    void LegRates(const FootAbsolutePosition & aFoot,
+                  const std::vector<pinocchio::JointIndex> & aChain,
+                  const std::vector<Eigen::Vector3d> & someAxes,
+                  const std::vector<int> & aLegIdxv,
+                  Eigen::VectorXd & velocity,
+                  Eigen::VectorXd & acceleration);
+
+    void deleteWorkers();
+
     //void computeWaist(const FootAbsolutePosition & inputLeftFoot) ;
 
     // -------------------------------------------------------------------
@@ -142,6 +257,10 @@ namespace PatternGeneratorJRL
     inline deque< Eigen::Vector3d > zmpmb()
     { return ZMPMB_vec_ ; }
 
+    /// \brief Snapshot of the state
+    void getState(dynamic_filter_state_t & aState) const;
+    void setState(const dynamic_filter_state_t & aState);
+
   private: // Private members
 
     /// \brief Time variables
@@ -209,6 +328,16 @@ namespace PatternGeneratorJRL
       /*! \brief For the chest. */
       std::vector<int> chestIdxv_;
 
+      /*! \brief Joints of the legs from the hip to the ankle,
+        and their axes, for the analytic joint rates. */
+      std::vector<pinocchio::JointIndex> llegChain_, rlegChain_ ;
+      std::vector<Eigen::Vector3d> llegAxes_, rlegAxes_ ;
+      /*! \brief Jacobian of a leg, twist of its ankle and its joint rates.
+        Sized at construction so that the solve does not allocate. */
+      Eigen::MatrixXd legJacobian_ ;
+      Eigen::VectorXd legTwist_, legRates_ ;
+      Eigen::PartialPivLU<Eigen::MatrixXd> legLU_ ;
+
       bool walkingHeuristic_ ;
       bool useDynamicFilter_ ;
 
@@ -222,8 +351,36 @@ namespace PatternGeneratorJRL
       deque< Eigen::Vector3d > ZMPMB_vec_ ;
       /// sampled at control sampling period
       deque< Eigen::Vector3d > zmpmb_i_ ;
+      /// derivative of the ZMP multibody, used to interpolate it
+      vector< vector<double> > dZMPMB_vec_ ;
+
+      /// \brief Postures of the preview window, used when the
+      /// ZMPMBs are computed by the workers.
+      vector< Eigen::VectorXd > configurations_ ;
+      vector< Eigen::VectorXd > velocities_ ;
+      vector< Eigen::VectorXd > accelerations_ ;
+
+      /// \brief Data owned by one worker: the pinocchio data
+      /// and the buffers of the inverse dynamics.
+      struct zmpmb_worker_t
+      {
+        pinocchio::Data * data ;
+        Eigen::VectorXd q, v, a ;
+      };
+      vector< zmpmb_worker_t > workers_ ;
+      WorkStealingPool * pool_ ;
+      /// \brief Indexes of the postures whose ZMPMBs
+      /// are computed by the workers.
+      vector< unsigned int > pending_ ;
+
+      /// \brief Depth+1 horizons used as a ring, the last one
+      /// is horizons_[lastHorizon_]. Empty if the mode is disabled.
+      vector< zmpmb_horizon_t > horizons_ ;
+      unsigned int lastHorizon_ ;
+      double incrementalTolerance_ ;
+      unsigned long int nbOfReusedZMPMB_, nbOfComputedZMPMB_ ;
       /// sampled at control sampling period
-      std::deque<ZMPPosition> deltaZMP_deq_ ;
+      RingBuffer<ZMPPosition> deltaZMP_deq_ ;
 
     /// \brief Optimal Control variables
     /// --------------------------------
@@ -231,6 +388,8 @@ namespace PatternGeneratorJRL
       PreviewControl *PC_;
       /// \brief data needed by the preview control algorithm
       vector<double> sxzmp_ , syzmp_ ;
+      /// \brief deltaZMP_deq_ stored contiguously for the preview control
+      PreviewControl::PreviewWindow deltaZMPWindow_ ;
       vector<double> deltaZMPx_, deltaZMPy_ ;
       double CoMHeight_ ;
 
@@ -247,18 +406,21 @@ namespace PatternGeneratorJRL
 
       const unsigned int MODE_PC_;
 
+      /// \brief Number of calls to Debug().
+      int iterationDebug_ ;
+
     public : // debug functions      
       // to use the vector of eigen used by metapod
       //EIGEN_MAKE_ALIGNED_OPERATOR_NEW
 
-      void Debug(const deque<COMState> & ctrlCoMState,
-                 const deque<FootAbsolutePosition> & ctrlLeftFoot,
-                 const deque<FootAbsolutePosition> & ctrlRightFoot,
-                 const deque<COMState> & inputCOMTraj_deq_,
-                 const deque<ZMPPosition> inputZMPTraj_deq_,
-                 const deque<FootAbsolutePosition> & inputLeftFootTraj_deq_,
-                 const deque<FootAbsolutePosition> & inputRightFootTraj_deq_,
-                 const deque<COMState> &outputDeltaCOMTraj_deq_);
+      void Debug(const RingBuffer<COMState> & ctrlCoMState,
+                 const RingBuffer<FootAbsolutePosition> & ctrlLeftFoot,
+                 const RingBuffer<FootAbsolutePosition> & ctrlRightFoot,
+                 const RingBuffer<COMState> & inputCOMTraj_deq_,
+                 const RingBuffer<ZMPPosition> inputZMPTraj_deq_,
+                 const RingBuffer<FootAbsolutePosition> & inputLeftFootTraj_deq_,
+                 const RingBuffer<FootAbsolutePosition> & inputRightFootTraj_deq_,
+                 const RingBuffer<COMState> &outputDeltaCOMTraj_deq_);
   };
 
 }
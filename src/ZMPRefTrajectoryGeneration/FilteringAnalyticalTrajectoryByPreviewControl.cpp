@@ -39,6 +39,7 @@ FilteringAnalyticalTrajectoryByPreviewControl::FilteringAnalyticalTrajectoryByPr
   m_Duration  = 0.0;
   m_SamplingPeriod = 0.0;
   m_Tsingle = 0.0;
+  m_NbOfModifs = 0;
 
   m_AnalyticalZMPCOGTrajectory = 0;
   m_PreviewControl = 0;
@@ -141,9 +142,8 @@ bool FilteringAnalyticalTrajectoryByPreviewControl::FillInWholeBuffer(double Fir
   if (0)
     {
       ofstream aof;
-      static unsigned int nbofmodifs = 0;
       char Buffer[1024];
-      sprintf(Buffer,"Diff_%05d.dat",nbofmodifs++);
+      sprintf(Buffer,"Diff_%05d.dat",m_NbOfModifs++);
       aof.open(Buffer,ofstream::out);
     }
   // On the interval of the newly changed first foot. 
@@ -112,6 +112,9 @@ namespace PatternGeneratorJRL
     /*! \brief Current ZMP value of the preview control. */
     double m_ZMPPCValue;
 
+    /*! \brief Number of dumped modifications (debugging). */
+    unsigned int m_NbOfModifs;
+
     /*! \brief Resizing the data buffer depending of the sampling period and
       preview control time. */
     void Resize();
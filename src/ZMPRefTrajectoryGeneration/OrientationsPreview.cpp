@@ -89,17 +89,37 @@ OrientationsPreview::OrientationsPreview(PinocchioRobot *aPR)
 OrientationsPreview::~OrientationsPreview() {
 }
 
+void OrientationsPreview::getState(orientations_preview_state_t & aState) const
+{
+  aState.TrunkState = TrunkState_ ;
+  aState.TrunkStateT = TrunkStateT_ ;
+  aState.signRotVelTrunk = signRotVelTrunk_ ;
+  aState.signRotAccTrunk = signRotAccTrunk_ ;
+  aState.SupportTimePassed = SupportTimePassed_ ;
+  aState.LastFirstPvwSol = LastFirstPvwSol_ ;
+}
+
+void OrientationsPreview::setState(const orientations_preview_state_t & aState)
+{
+  TrunkState_ = aState.TrunkState ;
+  TrunkStateT_ = aState.TrunkStateT ;
+  signRotVelTrunk_ = aState.signRotVelTrunk ;
+  signRotAccTrunk_ = aState.signRotAccTrunk ;
+  SupportTimePassed_ = aState.SupportTimePassed ;
+  LastFirstPvwSol_ = aState.LastFirstPvwSol ;
+}
+
 void OrientationsPreview::preview_orientations(double Time,
                                               const reference_t & Ref,
                                               double StepDuration,
-                                              const std::deque<FootAbsolutePosition> & LeftFootPositions_deq,
-                                              const std::deque<FootAbsolutePosition> & RightFootPositions_deq,
+                                              const RingBuffer<FootAbsolutePosition> & LeftFootPositions_deq,
+                                              const RingBuffer<FootAbsolutePosition> & RightFootPositions_deq,
                                               solution_t & Solution)
 {
 
-  const deque<support_state_t> & PrwSupportStates_deq = Solution.SupportStates_deq;
-  std::deque<double> & PreviewedSupportAngles_deq = Solution.SupportOrientations_deq;
-  std::deque<double> & PreviewedTrunkOrientations_deq = Solution.TrunkOrientations_deq;
+  const RingBuffer<support_state_t> & PrwSupportStates_deq = Solution.SupportStates_deq;
+  RingBuffer<double> & PreviewedSupportAngles_deq = Solution.SupportOrientations_deq;
+  RingBuffer<double> & PreviewedTrunkOrientations_deq = Solution.TrunkOrientations_deq;
 
   support_state_t CurrentSupport = PrwSupportStates_deq.front();
 
@@ -121,7 +141,7 @@ void OrientationsPreview::preview_orientations(double Time,
   signRotVelTrunk_ = (TrunkStateT_.yaw[1] < 0.0)?-1.0:1.0;
 
   // compute the number of iteration before landing on the first previewed step
-  std::deque<support_state_t>::const_iterator SPTraj_it = Solution.SupportStates_deq.begin();
+  RingBuffer<support_state_t>::const_iterator SPTraj_it = Solution.SupportStates_deq.begin();
   int ItBeforeLanding = 0 ;
   while(SPTraj_it!=Solution.SupportStates_deq.end())
   {
@@ -281,7 +301,7 @@ void OrientationsPreview::preview_orientations(double Time,
     PreviewedTrunkOrientations_deq.push_back(TrunkStateT_.yaw[0]+TrunkStateT_.yaw[1]*T_);
   }
 
-  std::deque<support_state_t>::iterator prwSS_it = Solution.SupportStates_deq.begin();
+  RingBuffer<support_state_t>::iterator prwSS_it = Solution.SupportStates_deq.begin();
   double supportAngle = prwSS_it->Yaw;
   prwSS_it++;//Point at the first previewed instant
   for(unsigned i = 0; i<N_; i++ )
@@ -412,8 +432,8 @@ void OrientationsPreview::verify_velocity_hip_joint(double Time,
 
 void OrientationsPreview::interpolate_trunk_orientation(double Time, int CurrentIndex,
                                                         double NewSamplingPeriod,
-                                                        const deque<support_state_t> & PrwSupportStates_deq,
-                                                        deque<COMState> & FinalCOMTraj_deq)
+                                                        const RingBuffer<support_state_t> & PrwSupportStates_deq,
+                                                        RingBuffer<COMState> & FinalCOMTraj_deq)
 {
 
   support_state_t CurrentSupport = PrwSupportStates_deq.front();
@@ -447,7 +467,7 @@ void OrientationsPreview::interpolate_trunk_orientation(double Time, int Current
 }
 
 void OrientationsPreview::one_iteration(double Time,
-                                        const deque<support_state_t> & PrwSupportStates_deq)
+                                        const RingBuffer<support_state_t> & PrwSupportStates_deq)
 {
   support_state_t CurrentSupport = PrwSupportStates_deq.front();
 
@@ -35,6 +35,7 @@
 
 #include <deque>
 
+#include <RingBuffer.hh>
 #include <privatepgtypes.hh>
 #include <jrl/walkgen/pgtypes.hh>
 #include <Mathematics/PolynomeFoot.hh>
@@ -42,6 +43,16 @@
 
 namespace PatternGeneratorJRL
 {
+  /// \brief Part of OrientationsPreview kept from one preview to the next.
+  struct orientations_preview_state_t
+  {
+    COMState TrunkState ;
+    COMState TrunkStateT ;
+    double signRotVelTrunk, signRotAccTrunk ;
+    double SupportTimePassed ;
+    double LastFirstPvwSol ;
+  };
+
   /// \brief The acceleration phase is fixed
   class OrientationsPreview {
 
@@ -72,8 +83,8 @@ namespace PatternGeneratorJRL
     void preview_orientations(double Time,
                               const reference_t & Ref,
                               double StepDuration,
-                              const std::deque<FootAbsolutePosition> & LeftFootPositions_deq,
-                              const std::deque<FootAbsolutePosition> & RightFootPositions_deq,
+                              const RingBuffer<FootAbsolutePosition> & LeftFootPositions_deq,
+                              const RingBuffer<FootAbsolutePosition> & RightFootPositions_deq,
                               solution_t & Solution);
 
     /// \brief Interpolate previewed orientation of the trunk
@@ -86,8 +97,8 @@ namespace PatternGeneratorJRL
     void interpolate_trunk_orientation(double Time,
                                        int CurrentIndex,
                                        double NewSamplingPeriod,
-                                       const std::deque<support_state_t> & PrwSupportStates_deq,
-                                       std::deque<COMState> & FinalCOMTraj_deq);
+                                       const RingBuffer<support_state_t> & PrwSupportStates_deq,
+                                       RingBuffer<COMState> & FinalCOMTraj_deq);
 
     /// \brief Compute the current state for the preview of the orientation
     ///
@@ -97,7 +108,7 @@ namespace PatternGeneratorJRL
     /// \param[in] PrwSupportStates_deq
     /// \param[out] FinalCOMTraj_deq
     void one_iteration(double Time,
-                       const std::deque<support_state_t> & PrwSupportStates_deq);
+                       const RingBuffer<support_state_t> & PrwSupportStates_deq);
 
 
     /// \name Accessors
@@ -124,6 +135,12 @@ namespace PatternGeneratorJRL
     { N_ = SamplingsPreviewed; };
     /// \}
 
+    /// \name Snapshot of the state
+    /// \{
+    void getState(orientations_preview_state_t & aState) const;
+    void setState(const orientations_preview_state_t & aState);
+    /// \}
+
     //
     // Private methods:
     //
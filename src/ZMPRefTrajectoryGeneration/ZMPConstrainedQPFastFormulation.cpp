@@ -39,11 +39,45 @@
 
 #include <Mathematics/qld.hh>
 #include <ZMPRefTrajectoryGeneration/ZMPConstrainedQPFastFormulation.hh>
+#include <QPCapture.hh>
+#include <TraceRecorder.hh>
 
 #include <Debug.hh>
 using namespace std;
 using namespace PatternGeneratorJRL;
 
+namespace
+{
+  typedef Eigen::Matrix<double,Eigen::Dynamic,Eigen::Dynamic,
+                        Eigen::RowMajor> RowMatrix_t;
+  typedef Eigen::Map<const RowMatrix_t> RowMap_t;
+  typedef Eigen::Map<const Eigen::VectorXd> VectorMap_t;
+
+  /*! Record each row of aMatrix as one line of aChannel. */
+  template <typename Derived>
+  void TraceRows(unsigned int aChannel,
+                 const Eigen::MatrixBase<Derived> & aMatrix)
+  {
+    for(unsigned int i=0;i<(unsigned int)aMatrix.rows();i++)
+      {
+        TraceEntry aof(aChannel);
+        for(unsigned int j=0;j<(unsigned int)aMatrix.cols();j++)
+          aof << (double)aMatrix(i,j);
+      }
+  }
+
+  /*! Record aVector as one line of aChannel starting with Time. */
+  template <typename Derived>
+  void TraceLine(unsigned int aChannel, double Time,
+                 const Eigen::MatrixBase<Derived> & aVector)
+  {
+    TraceEntry aof(aChannel);
+    aof << Time;
+    for(unsigned int i=0;i<(unsigned int)aVector.size();i++)
+      aof << (double)aVector(i);
+  }
+}
+
 ZMPConstrainedQPFastFormulation::ZMPConstrainedQPFastFormulation(SimplePluginManager *lSPM, 
 								 string DataFile,
 								 PinocchioRobot *aPR) :
@@ -53,6 +87,8 @@ ZMPConstrainedQPFastFormulation::ZMPConstrainedQPFastFormulation(SimplePluginMan
   m_Pu = 0;
   m_FullDebug = 0;
   m_FastFormulationMode = PLDP;
+  m_UseActiveSetCache = false;
+  m_SupportPatternKey = ActiveSetCache::EmptyKey;
 
   /*! Getting the ZMP reference from Kajita's heuristic. */
   m_ZMPD = new ZMPDiscretization(lSPM,DataFile,aPR);
@@ -64,10 +100,11 @@ ZMPConstrainedQPFastFormulation::ZMPConstrainedQPFastFormulation(SimplePluginMan
   m_FCALS = new FootConstraintsAsLinearSystem(lSPM,aPR);
 
   // Register method to handle
-  string aMethodName[1] = 
-    {":setdimitrovconstraint"};
+  string aMethodName[2] = 
+    {":setdimitrovconstraint",
+     ":dimitrovcapture"};
   
-  for(int i=0;i<1;i++)
+  for(int i=0;i<2;i++)
     {
       if (!RegisterMethod(aMethodName[i]))
 	{
@@ -81,6 +118,7 @@ ZMPConstrainedQPFastFormulation::ZMPConstrainedQPFastFormulation(SimplePluginMan
   //  m_QP_T = 0.02;
   m_QP_T = 0.1;
   m_QP_N = 16;
+  m_LocalTime = -m_QP_T;
 
   m_SamplingPeriod = 0.005;
 
@@ -102,7 +140,7 @@ ZMPConstrainedQPFastFormulation::ZMPConstrainedQPFastFormulation(SimplePluginMan
   m_SimilarConstraints.resize(8*m_QP_N);
 
   if (m_FastFormulationMode==PLDP)
-    m_PLDPSolver = new Optimization::Solver::PLDPSolver(m_QP_N,
+    m_PLDPSolver = new Optimization::Solver::PLDPSolverEigen(m_QP_N,
 							&m_iPu(0),
 							&m_Px(0),
 							m_Pu,
@@ -222,24 +260,13 @@ int ZMPConstrainedQPFastFormulation::InitializeMatrixPbConstants()
       m_Px(li,1) = (double)(1.0+li)*m_QP_T;
       m_Px(li,2) = (li+1.0)*(li+1.0)*m_QP_T*m_QP_T*0.5-m_ComHeight/9.81;
     }
-  if (m_FullDebug>2)
+  TraceRecorder & aRecorder = TraceRecorder::Instance();
+  if ((m_FullDebug>2) && (aRecorder.IsRunning()))
     {
-      ofstream aof;
-      aof.open("VPx.dat");
-      aof << m_VPx;
-      aof.close();
-      
-      aof.open("m_PPx.dat");
-      aof << m_PPx;
-      aof.close();
-      
-      aof.open("VPu.dat");
-      aof << m_VPu;
-      aof.close();
-      
-      aof.open("PPu.dat");
-      aof << m_PPu;
-      aof.close();
+      TraceRows(aRecorder.Channel("VPx.dat"),m_VPx);
+      TraceRows(aRecorder.Channel("m_PPx.dat"),m_PPx);
+      TraceRows(aRecorder.Channel("VPu.dat"),m_VPu);
+      TraceRows(aRecorder.Channel("PPu.dat"),m_PPu);
     }
 
   return 0;
@@ -337,42 +364,12 @@ int ZMPConstrainedQPFastFormulation::ValidationConstraints(double * & DPx,double
       
     }
 
-  if (m_FullDebug>2)
+  TraceRecorder & aRecorder = TraceRecorder::Instance();
+  if ((m_FullDebug>2) && (aRecorder.IsRunning()))
     {
-      ofstream aof;
-      aof.open("StorePx.dat",ofstream::out);
-      
-      for(unsigned int i=0;i<vnlStorePx.rows();i++)
-	{
-	  for(unsigned int j=0;j<vnlStorePx.cols();j++)
-	    {
-	      aof << vnlStorePx(i,j) << " ";
-	    }
-	  aof << endl;
-	}
-      aof.close();
-      
-      
-      char lBuffer[1024];
-      sprintf(lBuffer,"StoreX.dat");
-      aof.open(lBuffer,ofstream::out);
-      
-      for(unsigned int i=0;i<vnlStoreX.rows();i++)
-	{
-	  for(unsigned int j=0;j<vnlStoreX.cols();j++)
-	    {
-	      aof << vnlStoreX(i,j) << " ";
-	    }
-	  aof << endl;
-	}
-      aof.close();
-      
-      aof.open("Cnb.dat",ofstream::out);
-      for(unsigned int i=0;i<ConstraintNb.size();i++)
-	{
-	  aof << ConstraintNb[i]<<endl;
-	}
-      aof.close();
+      TraceRows(aRecorder.Channel("StorePx.dat"),vnlStorePx);
+      TraceRows(aRecorder.Channel("StoreX.dat"),vnlStoreX);
+      TraceRows(aRecorder.Channel("Cnb.dat"),ConstraintNb);
     }
   return 0;
 }
@@ -410,40 +407,15 @@ int ZMPConstrainedQPFastFormulation::BuildingConstantPartOfTheObjectiveFunctionQ
   anOCD.ComputeNormalCholeskyOnANormal();
   anOCD.ComputeInverseCholeskyNormal(1);
   
-  if (m_FullDebug>0)
+  TraceRecorder & aRecorder = TraceRecorder::Instance();
+  if ((m_FullDebug>0) && (aRecorder.IsRunning()))
     {
-      ofstream aof;
-      char Buffer[1024];
-      sprintf(Buffer,"localQ.dat");
-      aof.open(Buffer,ofstream::out);
-      for(unsigned int i=0;i<m_QP_N;i++)
-	{
-	  for(unsigned int j=0;j<m_QP_N;j++)
-	    aof << localQ[i*m_QP_N+j] << " ";
-	  aof<<endl;
-	}
-      aof.close(); 
-      
-      sprintf(Buffer,"localLQ.dat");
-      aof.open(Buffer,ofstream::out);
-      for(unsigned int i=0;i<m_QP_N;i++)
-	{
-	  for(unsigned int j=0;j<m_QP_N;j++)
-	    aof << localLQ[i*m_QP_N+j] << " ";
-	  aof << endl;
-	}
-      aof.close(); 
-
-      sprintf(Buffer,"localiLQ.dat");
-      aof.open(Buffer,ofstream::out);
-      for(unsigned int i=0;i<m_QP_N;i++)
-	{
-	  for(unsigned int j=0;j<m_QP_N;j++)
-	    aof << localiLQ[i*m_QP_N+j] << " ";
-	  aof << endl;
-	}
-      aof.close(); 
-
+      TraceRows(aRecorder.Channel("localQ.dat"),
+                RowMap_t(localQ,m_QP_N,m_QP_N));
+      TraceRows(aRecorder.Channel("localLQ.dat"),
+                RowMap_t(localLQ,m_QP_N,m_QP_N));
+      TraceRows(aRecorder.Channel("localiLQ.dat"),
+                RowMap_t(localiLQ,m_QP_N,m_QP_N));
     }  
 
   
@@ -474,30 +446,10 @@ int ZMPConstrainedQPFastFormulation::BuildingConstantPartOfTheObjectiveFunctionQ
   // New formulation (Dimitar08)
   m_OptC=m_iLQ*m_OptC;
 
-  if (m_FullDebug>0)
+  if ((m_FullDebug>0) && (aRecorder.IsRunning()))
     {  
-      ofstream aof;
-      char Buffer[1024];
-
-      sprintf(Buffer,"LQ.dat");
-      aof.open(Buffer,ofstream::out);
-      for(unsigned int i=0;i<2*m_QP_N;i++)
-	{
-	  for(unsigned int j=0;j<2*m_QP_N;j++)
-	    aof << m_LQ(i,j) << " ";
-	  aof << endl;
-	}
-      aof.close(); 
-      
-      sprintf(Buffer,"iLQ.dat");
-      aof.open(Buffer,ofstream::out);
-      for(unsigned int i=0;i<2*m_QP_N;i++)
-	{
-	  for(unsigned int j=0;j<2*m_QP_N;j++)
-	    aof << m_iLQ(i,j) << " ";
-	  aof << endl;
-	}
-      aof.close(); 
+      TraceRows(aRecorder.Channel("LQ.dat"),m_LQ);
+      TraceRows(aRecorder.Channel("iLQ.dat"),m_iLQ);
     }
   delete [] localQ;
   delete [] localLQ;
@@ -535,20 +487,10 @@ int ZMPConstrainedQPFastFormulation::BuildingConstantPartOfTheObjectiveFunction(
     m_Q[i*2*m_QP_N+i] = 1.0;
 
 
-  if (m_FullDebug>0)
-    {
-      ofstream aof;
-      char Buffer[1024];
-      sprintf(Buffer,"Q.dat");
-      aof.open(Buffer,ofstream::out);
-      for(unsigned int i=0;i<2*m_QP_N;i++)
-	{
-	  for(unsigned int j=0;j<2*m_QP_N;j++)
-	    aof << m_Q[i*m_QP_N*2+j] << " ";
-	  aof << endl;
-	}
-      aof.close(); 
-    }
+  TraceRecorder & aRecorder = TraceRecorder::Instance();
+  if ((m_FullDebug>0) && (aRecorder.IsRunning()))
+    TraceRows(aRecorder.Channel("Q.dat"),
+              RowMap_t(m_Q,2*m_QP_N,2*m_QP_N));
 
   /*! Compute constants of the linear part of the objective function. */
   lterm1 = m_PPu.transpose();
@@ -571,38 +513,10 @@ int ZMPConstrainedQPFastFormulation::BuildingConstantPartOfTheObjectiveFunction(
       BuildingConstantPartOfTheObjectiveFunctionQLD(OptA);
     }
 
-  if (m_FullDebug>0)
-  {
-    ofstream aof;
-    char Buffer[1024];
-    sprintf(Buffer,"OptB.dat");
-    aof.open(Buffer,ofstream::out);
-    for(unsigned int i=0;i<m_OptB.rows();i++)
-      {
-	for(unsigned int j=0;j<m_OptB.cols()-1;j++)
-	  aof << m_OptB(i,j) << " ";
-	aof << m_OptB(i,m_OptB.cols()-1);
-	aof << endl;
-      }
-    aof.close(); 
-    
-  }
-  
-  if (m_FullDebug>0)
+  if ((m_FullDebug>0) && (aRecorder.IsRunning()))
   {
-    ofstream aof;
-    char Buffer[1024];
-    sprintf(Buffer,"OptC.dat");
-    aof.open(Buffer,ofstream::out);
-    for(unsigned int i=0;i<m_OptC.rows();i++)
-      {
-	for(unsigned int j=0;j<m_OptC.cols()-1;j++)
-	  aof << m_OptC(i,j) << " ";
-	aof << m_OptC(i,m_OptC.cols()-1);
-	aof << endl;
-      }
-    aof.close(); 
-    
+    TraceRows(aRecorder.Channel("OptB.dat"),m_OptB);
+    TraceRows(aRecorder.Channel("OptC.dat"),m_OptC);
   }
 
   return 0;
@@ -674,40 +588,15 @@ int ZMPConstrainedQPFastFormulation::BuildingConstantPartOfConstraintMatrices()
 	}
     }
 
-  if (m_FullDebug>0)
+  TraceRecorder & aRecorder = TraceRecorder::Instance();
+  if ((m_FullDebug>0) && (aRecorder.IsRunning()))
     {
-      ofstream aof;
-      char Buffer[1024];
-      sprintf(Buffer,"PuCst.dat");
-      aof.open(Buffer,ofstream::out);
-      for(unsigned int i=0;i<m_QP_N;i++)
-	{
-	  for(unsigned int j=0;j<m_QP_N;j++)
-	    aof << m_Pu[j+i*m_QP_N] << " " ;
-	  aof << endl;
-	}
-      aof.close();
-
-      sprintf(Buffer,"tmpPuCst.dat");
-      aof.open(Buffer,ofstream::out);
-      for(unsigned int i=0;i<m_QP_N;i++)
-	{
-	  for(unsigned int j=0;j<m_QP_N;j++)
-	    aof << ptPu[j+i*m_QP_N] << " " ;
-	  aof << endl;
-	}
-      aof.close();
-
-      sprintf(Buffer,"tmpiLQ.dat");
-      aof.open(Buffer,ofstream::out);
-      for(unsigned int i=0;i<m_QP_N;i++)
-	{
-	  for(unsigned int j=0;j<m_QP_N;j++)
-	    aof << m_iLQ(i,j) << " " ;
-	  aof << endl;
-	}
-      aof.close();
-      
+      TraceRows(aRecorder.Channel("PuCst.dat"),
+                RowMap_t(m_Pu,m_QP_N,m_QP_N));
+      TraceRows(aRecorder.Channel("tmpPuCst.dat"),
+                RowMap_t(ptPu,m_QP_N,m_QP_N));
+      TraceRows(aRecorder.Channel("tmpiLQ.dat"),
+                m_iLQ.topLeftCorner(m_QP_N,m_QP_N));
     }
     
   delete [] lInterPu;
@@ -842,6 +731,7 @@ int ZMPConstrainedQPFastFormulation::BuildConstraintMatrices(double * & DPx,doub
   NextNumberOfRemovedConstraints = (unsigned int)((*LCI_it)->A.rows());
 
   IndexConstraint = 0;
+  m_SupportPatternKey = ActiveSetCache::EmptyKey;
   ODEBUG("Starting Matrix to build the constraints. ");
   ODEBUG((*LCI_it)->A );
   for(unsigned int i=0;i<N;i++)
@@ -855,6 +745,11 @@ int ZMPConstrainedQPFastFormulation::BuildConstraintMatrices(double * & DPx,doub
       ZMPRef[i] = (*LCI_it)->Center(0);
       ZMPRef[i+N] = (*LCI_it)->Center(1);
 
+      // DPu only depends on the polygon of each sample.
+      m_SupportPatternKey =
+	ActiveSetCache::combine(m_SupportPatternKey,(*LCI_it)->A.data(),
+				(unsigned int)(*LCI_it)->A.size());
+
 
       // For each constraint.
       for(unsigned j=0;j<(*LCI_it)->A.rows();j++)
@@ -918,98 +813,54 @@ int ZMPConstrainedQPFastFormulation::BuildConstraintMatrices(double * & DPx,doub
     }
   
   ODEBUG6("Index Constraint :"<< IndexConstraint,Buffer);
-  static double localtime = -m_QP_T;
-  localtime+=m_QP_T;
+  m_LocalTime+=m_QP_T;
 
-  ODEBUG("IndexConstraint:"<<IndexConstraint << " localTime :" << localtime);
+  ODEBUG("IndexConstraint:"<<IndexConstraint << " localTime :" << m_LocalTime);
 
   //  if (localtime>=1.96)
   if (0)
     {
-      ODEBUG("localtime: " <<localtime);
-      ofstream aof;
-
-      char Buffer[1024];
-      sprintf(Buffer,"DPu.dat");
-      aof.open(Buffer,ofstream::out);
-      for(unsigned int i=0;i<IndexConstraint;i++)
+      ODEBUG("localtime: " <<m_LocalTime);
+      TraceRecorder & aRecorder = TraceRecorder::Instance();
+      if (aRecorder.IsRunning())
 	{
-	  for(unsigned int j=0;j<2*N;j++)
-	    aof << DPu[j*(NbOfConstraints+1)+i] << " " ;
-	  aof << endl;
+	  // DPu is stored column by column, NbOfConstraints+1 per column.
+	  TraceRows(aRecorder.Channel("DPu.dat"),
+		    Eigen::Map<const Eigen::MatrixXd,0,Eigen::OuterStride<> >
+		    (DPu,IndexConstraint,2*N,
+		     Eigen::OuterStride<>(NbOfConstraints+1)));
+	  TraceLine(aRecorder.Channel("DPx.dat"),m_LocalTime,
+		    VectorMap_t(DPx,IndexConstraint));
+	  TraceLine(aRecorder.Channel("CZMPRef.dat"),m_LocalTime,ZMPRef);
+	  TraceRows(aRecorder.Channel("lD.dat"),lD);
+	  TraceLine(aRecorder.Channel("lb.dat"),m_LocalTime,
+		    lb.head(IndexConstraint));
 	}
-      aof.close();
-
-      sprintf(Buffer,"DPx.dat");
-      aof.open(Buffer,ofstream::out);
-      for(unsigned int j=0;j<IndexConstraint;j++)
-	aof << DPx[j] << " " ;
-      aof << endl;
-      aof.close();
-
-      sprintf(Buffer,"CZMPRef.dat");
-      aof.open(Buffer,ofstream::out);
-      for(unsigned int j=0;j<2*N;j++)
-	aof << ZMPRef[j] << " " ;
-      aof << endl;
-      aof.close();
-
-      sprintf(Buffer,"lD.dat");
-      aof.open(Buffer,ofstream::out);
-      ODEBUG(lD.rows() << " " << lD.cols() << " " );
-      for(unsigned int lj=0;lj<lD.rows();lj++)
-	{
-	  for(unsigned int k=0;k<lD.cols();k++)
-	    aof << lD(lj,k) << " " ;
-	  aof << endl;
-	}
-      aof.close();
-
-      sprintf(Buffer,"lb.dat");
-      aof.open(Buffer,ofstream::out);
-      for(unsigned int j=0;j<IndexConstraint;j++)
-	aof << lb(j) << " " ;
-      aof << endl;
-      aof.close();
-      
       //      exit(0);
     } 
 
   //  if (m_FullDebug>0)
   if (0)
     {
-      
-      ofstream aof;
-      char Buffer[1024];      
-      sprintf(Buffer,"PuCst_%f.dat",StartingTime);
-      aof.open(Buffer,ofstream::out);
-      for(unsigned int i=0;i<m_QP_N;i++)
-	{
-	  for(unsigned int j=0;j<m_QP_N;j++)
-	    aof << m_Pu[j+i*m_QP_N] << " " ;
-	  aof << endl;
-	}
-      aof.close();
-
-      sprintf(Buffer,"D_%f.dat",StartingTime);
-      aof.open(Buffer,ofstream::out);
-      for(unsigned int i=0;i<2*m_QP_N;i++)
+      // One record per window, starting with StartingTime.
+      TraceRecorder & aRecorder = TraceRecorder::Instance();
+      if (aRecorder.IsRunning())
 	{
-	  for(unsigned int j=0;j<NbOfConstraints;j++)
-	    aof << lD(i,j) << " " ;
-	  aof << endl;
-	}
-      aof.close();
-
-      if (0)
-	{
-	  sprintf(Buffer,"DPX_%f.dat", StartingTime);
-	  aof.open(Buffer,ofstream::out);
-	  for(unsigned int i=0;i<IndexConstraint;i++)
+	  static unsigned int lPuChannel = aRecorder.Channel("PuCst_t.dat");
+	  static unsigned int lDChannel = aRecorder.Channel("CstD_t.dat");
+	  TraceLine(lPuChannel,StartingTime,
+		    VectorMap_t(m_Pu,m_QP_N*m_QP_N));
+	  for(unsigned int i=0;i<2*m_QP_N;i++)
+	    TraceLine(lDChannel,StartingTime,
+		      lD.row(i).head(NbOfConstraints));
+
+	  if (0)
 	    {
-	      aof << DPx[i] << endl ;
+	      static unsigned int lDPxChannel =
+		aRecorder.Channel("DPX_t.dat");
+	      TraceLine(lDPxChannel,StartingTime,
+			VectorMap_t(DPx,IndexConstraint));
 	    }
-	  aof.close();
 	}
     }
 
@@ -1088,12 +939,12 @@ int ZMPConstrainedQPFastFormulation::DumpProblem(double * Q,
   aof.close();
   return 0;
 }
-int ZMPConstrainedQPFastFormulation::BuildZMPTrajectoryFromFootTrajectory(deque<FootAbsolutePosition> 
+int ZMPConstrainedQPFastFormulation::BuildZMPTrajectoryFromFootTrajectory(RingBuffer<FootAbsolutePosition> 
 									  &LeftFootAbsolutePositions,
-									  deque<FootAbsolutePosition> 
+									  RingBuffer<FootAbsolutePosition> 
 									  &RightFootAbsolutePositions,
-									  deque<ZMPPosition> &ZMPRefPositions,
-									  deque<COMState> &COMStates,
+									  RingBuffer<ZMPPosition> &ZMPRefPositions,
+									  RingBuffer<COMState> &COMStates,
 									  double ConstraintOnX,
 									  double ConstraintOnY,
 									  double T,
@@ -1108,6 +959,7 @@ int ZMPConstrainedQPFastFormulation::BuildZMPTrajectoryFromFootTrajectory(deque<
   Eigen::VectorXd OptD(2*N);
 
   int CriteriaToMaximize=1;
+  TraceRecorder & aRecorder = TraceRecorder::Instance();
 
 
   RESETDEBUG4("DebugInterpol.dat");
@@ -1229,17 +1081,11 @@ int ZMPConstrainedQPFastFormulation::BuildZMPTrajectoryFromFootTrajectory(deque<
       // Prepare D.
       //      PrepareZMPRef(ZMPRef,StartingTime,QueueOfLConstraintInequalities);
       
-      if (m_FullDebug>2)
+      // One record per window, starting with StartingTime.
+      if ((m_FullDebug>2) && (aRecorder.IsRunning()))
 	{
-	  ofstream aof;
-	  char Buffer[1024];
-	  sprintf(Buffer,"ZMPRef_%f.dat",StartingTime);
-	  aof.open(Buffer,ofstream::out);
-	  for(unsigned int i=0;i<2*N;i++)
-	    {
-	      aof << ZMPRef[i] << endl;
-	    }
-	  aof.close(); 
+	  static unsigned int lChannel = aRecorder.Channel("ZMPRef_t.dat");
+	  TraceLine(lChannel,StartingTime,ZMPRef);
 	}  
 
       if (CriteriaToMaximize==1)
@@ -1252,17 +1098,10 @@ int ZMPConstrainedQPFastFormulation::BuildZMPTrajectoryFromFootTrajectory(deque<
 	  for(unsigned int i=0;i<2*N;i++)
 	    D[i] = OptD[i];
 
-	  if (m_FullDebug>0)
+	  if ((m_FullDebug>0) && (aRecorder.IsRunning()))
 	    {
-	      ofstream aof;
-	      char Buffer[1024];
-	      sprintf(Buffer,"D_%f.dat",StartingTime);
-	      aof.open(Buffer,ofstream::out);
-	      for(unsigned int i=0;i<2*N;i++)
-		{
-		  aof << OptD[i] << endl;
-		}
-	      aof.close(); 
+	      static unsigned int lChannel = aRecorder.Channel("D_t.dat");
+	      TraceLine(lChannel,StartingTime,OptD);
 	    }
 
 	}
@@ -1289,8 +1128,24 @@ int ZMPConstrainedQPFastFormulation::BuildZMPTrajectoryFromFootTrajectory(deque<
       //      DumpProblem(m_Q, D, DPu, m, DPx,XL,XU,StartingTime);
 		  
 		
-      if ((m_FastFormulationMode==QLDANDLQ)||
-	  (m_FastFormulationMode==QLD))
+      // In QLDANDLQ mode m_Q is a factor of the Hessian,
+      // in PLDP mode the Hessian is the identity.
+      bool lCacheHit = false;
+      if ((m_UseActiveSetCache) && (m_FastFormulationMode!=QLDANDLQ))
+	lCacheHit = m_ActiveSetCache.solve(m_SupportPatternKey,n,m,me,
+					   (m_FastFormulationMode==PLDP) ? 0 : m_Q,
+					   D,DPu,mmax,DPx,XL,XU,X);
+      if (lCacheHit)
+	{
+	  ifail = 0;
+	  // The next problem given to the PLDP solver drops the rows of
+	  // the windows solved by the cache. Its previous solution is
+	  // outdated, so the initial solution is computed again.
+	  NumberOfRemovedConstraints += NextNumberOfRemovedConstraints;
+	  StartingSequence = true;
+	}
+      else if ((m_FastFormulationMode==QLDANDLQ)||
+	       (m_FastFormulationMode==QLD))
 	{
 	  struct timeval lbegin,lend;
 	  gettimeofday(&lbegin,0);
@@ -1331,6 +1186,12 @@ int ZMPConstrainedQPFastFormulation::BuildZMPTrajectoryFromFootTrajectory(deque<
 					   m_SimilarConstraints,
 					   NumberOfRemovedConstraints,
 					   StartingSequence);
+	  m_PLDPCapture.Record(StartingTime,D,
+			       (unsigned int)m,DPu,DPx,
+			       &ZMPRef(0),&xk(0),
+			       m_SimilarConstraints,
+			       NumberOfRemovedConstraints,
+			       StartingSequence,X);
 	  StartingSequence = false;
 	  NumberOfRemovedConstraints = NextNumberOfRemovedConstraints;
 	  gettimeofday(&lend,0);
@@ -1339,6 +1200,20 @@ int ZMPConstrainedQPFastFormulation::BuildZMPTrajectoryFromFootTrajectory(deque<
 	  
 	  ODEBUG6(ldt,"dtPLDP.dat");
 	}
+
+      if ((m_UseActiveSetCache) && (!lCacheHit) && (ifail==0) &&
+	  (m_FastFormulationMode!=QLDANDLQ))
+	m_ActiveSetCache.store(m_SupportPatternKey,n,m,me,
+			       (m_FastFormulationMode==PLDP) ? 0 : m_Q,
+			       DPu,mmax,DPx,XL,XU,X);
+
+      // In QLDANDLQ mode QLD is given a factor instead of the Hessian:
+      // these problems are not recorded.
+      QPCapture & aCapture = QPCapture::Instance();
+      if ((aCapture.IsRunning()) && (m_FastFormulationMode!=QLDANDLQ))
+	aCapture.Record(QP_CAPTURE_DIMITROV,StartingTime,n,m,me,
+			(m_FastFormulationMode==PLDP) ? 0 : m_Q,
+			D,DPu,mmax,DPx,XL,XU,X,ifail);
       
       if (ifail!=0)
 	{
@@ -1408,17 +1283,10 @@ int ZMPConstrainedQPFastFormulation::BuildZMPTrajectoryFromFootTrajectory(deque<
 	    }
 	}
       
-      if (m_FullDebug>2)
+      if ((m_FullDebug>2) && (aRecorder.IsRunning()))
       {
-	ofstream aof;
-	char Buffer[1024];
-	sprintf(Buffer,"X_%f.dat",StartingTime);
-	aof.open(Buffer,ofstream::out);
-	for(unsigned int i=0;i<2*N;i++)
-	  {
-	    aof << X[i] << endl;
-	  }
-	aof.close(); 
+	static unsigned int lChannel = aRecorder.Channel("X_t.dat");
+	TraceLine(lChannel,StartingTime,VectorMap_t(X,2*N));
       }
 
 
@@ -1458,11 +1326,11 @@ int ZMPConstrainedQPFastFormulation::BuildZMPTrajectoryFromFootTrajectory(deque<
 }
 
 
-void ZMPConstrainedQPFastFormulation::GetZMPDiscretization(deque<ZMPPosition> & ZMPPositions,
-							   deque<COMState> & COMStates,
+void ZMPConstrainedQPFastFormulation::GetZMPDiscretization(RingBuffer<ZMPPosition> & ZMPPositions,
+							   RingBuffer<COMState> & COMStates,
 							   deque<RelativeFootPosition> &RelativeFootPositions,
-							   deque<FootAbsolutePosition> &LeftFootAbsolutePositions,
-							   deque<FootAbsolutePosition> &RightFootAbsolutePositions,
+							   RingBuffer<FootAbsolutePosition> &LeftFootAbsolutePositions,
+							   RingBuffer<FootAbsolutePosition> &RightFootAbsolutePositions,
 							   double Xmax,
 							   COMState & lStartingCOMState,
 							   Eigen::Vector3d & lStartingZMPPosition,
@@ -1493,16 +1361,15 @@ void ZMPConstrainedQPFastFormulation::GetZMPDiscretization(deque<ZMPPosition> &
 				       m_ConstraintOnY,
 				       m_QP_T,
 				       m_QP_N);
-  if (m_FullDebug>0)
+  TraceRecorder & aRecorder = TraceRecorder::Instance();
+  if ((m_FullDebug>0) && (aRecorder.IsRunning()))
     {
-      ofstream aof;
-      aof.open("DebugDimitrovZMP.dat",ofstream::out);
+      unsigned int lChannel = aRecorder.Channel("DebugDimitrovZMP.dat");
       for(unsigned int i=0;i<ZMPPositions.size();i++)
 	{
-	  aof << ZMPPositions[i].px << " " << ZMPPositions[i].py << endl;
+	  TraceEntry aof(lChannel);
+	  aof << ZMPPositions[i].px << " " << ZMPPositions[i].py;
 	}
-      aof.close();
-      
     }
   
 }
@@ -1530,16 +1397,36 @@ void ZMPConstrainedQPFastFormulation::CallMethod(std::string & Method, std::istr
 	  strm >> m_QP_N;
 	  cout << "Preview window for the QP " << m_QP_N << endl;
 	}
+      else if (PBWCmd=="cache")
+	{
+	  string aMode;
+	  strm >> aMode;
+	  m_UseActiveSetCache = (aMode=="on");
+	  m_ActiveSetCache.clear();
+	}
+    }
+  else if (Method==":dimitrovcapture")
+    {
+      // Record the problems given to the PLDP solver in a file,
+      // "off" stops the recording.
+      string FileName;
+      strm >> FileName;
+      if ((FileName=="off") || (FileName.empty()))
+	m_PLDPCapture.Close();
+      else if (m_PLDPCapture.Open(FileName,m_QP_N,
+				  m_iPu.data(),m_Px.data(),
+				  m_Pu,m_iLQ.data())<0)
+	std::cerr << "Unable to create " << FileName << std::endl;
     }
 
   ZMPRefTrajectoryGeneration::CallMethod(Method,strm);
 }
 
 
-std::size_t ZMPConstrainedQPFastFormulation::InitOnLine(deque<ZMPPosition> &,          // FinalZMPPositions,
-							deque<COMState> &,             // FinalCOMStates,
-							deque<FootAbsolutePosition> &, // FinalLeftFootAbsolutePositions,
-							deque<FootAbsolutePosition> &, // FinalRightFootAbsolutePositions,
+std::size_t ZMPConstrainedQPFastFormulation::InitOnLine(RingBuffer<ZMPPosition> &,          // FinalZMPPositions,
+							RingBuffer<COMState> &,             // FinalCOMStates,
+							RingBuffer<FootAbsolutePosition> &, // FinalLeftFootAbsolutePositions,
+							RingBuffer<FootAbsolutePosition> &, // FinalRightFootAbsolutePositions,
 							FootAbsolutePosition & ,       // InitLeftFootAbsolutePosition,
 							FootAbsolutePosition & ,       // InitRightFootAbsolutePosition,
 							deque<RelativeFootPosition> &, // RelativeFootPositions,
@@ -1551,40 +1438,40 @@ std::size_t ZMPConstrainedQPFastFormulation::InitOnLine(deque<ZMPPosition> &,
 }
 
 void ZMPConstrainedQPFastFormulation::OnLineAddFoot(RelativeFootPosition & ,         // NewRelativeFootPosition,
-						    deque<ZMPPosition> & ,           // FinalZMPPositions,	
-						    deque<COMState> & ,              // FinalCOMStates,
-						    deque<FootAbsolutePosition> &,   // FinalLeftFootAbsolutePositions,
-						    deque<FootAbsolutePosition> &,   // FinalRightFootAbsolutePositions,
+						    RingBuffer<ZMPPosition> & ,           // FinalZMPPositions,	
+						    RingBuffer<COMState> & ,              // FinalCOMStates,
+						    RingBuffer<FootAbsolutePosition> &,   // FinalLeftFootAbsolutePositions,
+						    RingBuffer<FootAbsolutePosition> &,   // FinalRightFootAbsolutePositions,
 						    bool )                           // EndSequence)
 {
   cout << "To be implemented" << endl;
 }
 
 void ZMPConstrainedQPFastFormulation::OnLine(double ,                                // time,
-					     deque<ZMPPosition> & ,                  // FinalZMPPositions,				     
-					     deque<COMState> & ,                     // FinalCOMStates,
-					     deque<FootAbsolutePosition> &,          // FinalLeftFootAbsolutePositions,
-					     deque<FootAbsolutePosition> & )         // FinalRightFootAbsolutePositions)
+					     RingBuffer<ZMPPosition> & ,                  // FinalZMPPositions,				     
+					     RingBuffer<COMState> & ,                     // FinalCOMStates,
+					     RingBuffer<FootAbsolutePosition> &,          // FinalLeftFootAbsolutePositions,
+					     RingBuffer<FootAbsolutePosition> & )         // FinalRightFootAbsolutePositions)
 {
   cout << "To be implemented" << endl;
 }
 
 int ZMPConstrainedQPFastFormulation::OnLineFootChange(double ,                       // time,
 						      FootAbsolutePosition & ,       // aFootAbsolutePosition,
-						      deque<ZMPPosition> & ,         // FinalZMPPositions,			     
-						      deque<COMState> & ,            // CoMPositions,
-						      deque<FootAbsolutePosition> &, // FinalLeftFootAbsolutePositions,
-						      deque<FootAbsolutePosition> &, // FinalRightFootAbsolutePositions,
+						      RingBuffer<ZMPPosition> & ,         // FinalZMPPositions,			     
+						      RingBuffer<COMState> & ,            // CoMPositions,
+						      RingBuffer<FootAbsolutePosition> &, // FinalLeftFootAbsolutePositions,
+						      RingBuffer<FootAbsolutePosition> &, // FinalRightFootAbsolutePositions,
 						      StepStackHandler  *)           // aStepStackHandler)
 {
   cout << "To be implemented" << endl;
   return -1;
 }
 
-void ZMPConstrainedQPFastFormulation::EndPhaseOfTheWalking(deque<ZMPPosition> &,           // ZMPPositions,
-							   deque<COMState> &,              // FinalCOMStates,
-							   deque<FootAbsolutePosition> &,  // LeftFootAbsolutePositions,
-							   deque<FootAbsolutePosition> & ) // RightFootAbsolutePositions)
+void ZMPConstrainedQPFastFormulation::EndPhaseOfTheWalking(RingBuffer<ZMPPosition> &,           // ZMPPositions,
+							   RingBuffer<COMState> &,              // FinalCOMStates,
+							   RingBuffer<FootAbsolutePosition> &,  // LeftFootAbsolutePositions,
+							   RingBuffer<FootAbsolutePosition> & ) // RightFootAbsolutePositions)
 {
   
 }
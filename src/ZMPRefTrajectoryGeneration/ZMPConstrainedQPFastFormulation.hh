@@ -33,7 +33,9 @@
 #include <PreviewControl/LinearizedInvertedPendulum2D.hh>
 #include <Mathematics/FootConstraintsAsLinearSystem.hh>
 #include <Mathematics/OptCholesky.hh>
-#include <Mathematics/PLDPSolver.hh>
+#include <Mathematics/PLDPSolverEigen.hh>
+#include <Mathematics/PLDPCapture.hh>
+#include <Mathematics/active-set-cache.hh>
 #include <ZMPRefTrajectoryGeneration/ZMPRefTrajectoryGeneration.hh>
 
 namespace PatternGeneratorJRL
@@ -85,11 +87,11 @@ namespace PatternGeneratorJRL
 
 	  
 	   */
-    void GetZMPDiscretization(deque<ZMPPosition> & ZMPPositions,
-			      deque<COMState> & CoMStates,
+    void GetZMPDiscretization(RingBuffer<ZMPPosition> & ZMPPositions,
+			      RingBuffer<COMState> & CoMStates,
 			      deque<RelativeFootPosition> &RelativeFootPositions,
-			      deque<FootAbsolutePosition> &LeftFootAbsolutePositions,
-			      deque<FootAbsolutePosition> &RightFootAbsolutePositions,
+			      RingBuffer<FootAbsolutePosition> &LeftFootAbsolutePositions,
+			      RingBuffer<FootAbsolutePosition> &RightFootAbsolutePositions,
 			      double Xmax,
 			      COMState & lStartingCOMState,
 			      Eigen::Vector3d & lStartingZMPPosition,
@@ -98,10 +100,10 @@ namespace PatternGeneratorJRL
 
     /*! This method is a new way of computing the ZMP trajectory from
       foot trajectory. */
-    int BuildZMPTrajectoryFromFootTrajectory(deque<FootAbsolutePosition> &LeftFootAbsolutePositions,
-					     deque<FootAbsolutePosition> &RightFootAbsolutePositions,
-					     deque<ZMPPosition> &ZMPRefPositions,		       
-					     deque<COMState> &COMStates,
+    int BuildZMPTrajectoryFromFootTrajectory(RingBuffer<FootAbsolutePosition> &LeftFootAbsolutePositions,
+					     RingBuffer<FootAbsolutePosition> &RightFootAbsolutePositions,
+					     RingBuffer<ZMPPosition> &ZMPRefPositions,		       
+					     RingBuffer<COMState> &COMStates,
 					     double ConstraintOnX,
 					     double ConstraintOnY,
 					     double T,
@@ -179,10 +181,10 @@ namespace PatternGeneratorJRL
       Returns the number of steps which has been completely put inside 
       the queue of ZMP, and foot positions.
     */
-    std::size_t InitOnLine(deque<ZMPPosition> & FinalZMPPositions,
-			   deque<COMState> & CoMStates,		   
-			   deque<FootAbsolutePosition> & FinalLeftFootAbsolutePositions,
-			   deque<FootAbsolutePosition> & FinalRightFootAbsolutePositions,
+    std::size_t InitOnLine(RingBuffer<ZMPPosition> & FinalZMPPositions,
+			   RingBuffer<COMState> & CoMStates,		   
+			   RingBuffer<FootAbsolutePosition> & FinalLeftFootAbsolutePositions,
+			   RingBuffer<FootAbsolutePosition> & FinalRightFootAbsolutePositions,
 			   FootAbsolutePosition & InitLeftFootAbsolutePosition,
 			   FootAbsolutePosition & InitRightFootAbsolutePosition,
 			   deque<RelativeFootPosition> &RelativeFootPositions,
@@ -191,28 +193,28 @@ namespace PatternGeneratorJRL
     
     /* ! Methods to update the stack on-line by inserting a new foot position. */
     void OnLineAddFoot(RelativeFootPosition & NewRelativeFootPosition,
-		       deque<ZMPPosition> & FinalZMPPositions,		
-		       deque<COMState> & CoMStates,			     
-		       deque<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
-		       deque<FootAbsolutePosition> &FinalRightFootAbsolutePositions,
+		       RingBuffer<ZMPPosition> & FinalZMPPositions,		
+		       RingBuffer<COMState> & CoMStates,			     
+		       RingBuffer<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
+		       RingBuffer<FootAbsolutePosition> &FinalRightFootAbsolutePositions,
 		       bool EndSequence);
 
     /* ! \brief Method to update the stacks on-line */
     void OnLine(double time,
-		deque<ZMPPosition> & FinalZMPPositions,		
-		deque<COMState> & CoMStates,			     
-		deque<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
-		deque<FootAbsolutePosition> &FinalRightFootAbsolutePositions);
+		RingBuffer<ZMPPosition> & FinalZMPPositions,		
+		RingBuffer<COMState> & CoMStates,			     
+		RingBuffer<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
+		RingBuffer<FootAbsolutePosition> &FinalRightFootAbsolutePositions);
 
     /* ! \brief Method to change on line the landing position of a foot.
        @return If the method failed it returns -1, 0 otherwise.
     */
     int OnLineFootChange(double time,
 			 FootAbsolutePosition &aFootAbsolutePosition,
-			 deque<ZMPPosition> & FinalZMPPositions,			     
-			 deque<COMState> & CoMStates,
-			 deque<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
-			 deque<FootAbsolutePosition> &FinalRightFootAbsolutePositions,
+			 RingBuffer<ZMPPosition> & FinalZMPPositions,			     
+			 RingBuffer<COMState> & CoMStates,
+			 RingBuffer<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
+			 RingBuffer<FootAbsolutePosition> &FinalRightFootAbsolutePositions,
 			 StepStackHandler * aStepStackHandler=0);
 
     /*! \brief Method to stop walking.
@@ -221,10 +223,10 @@ namespace PatternGeneratorJRL
       @param[out] LeftFootAbsolutePositions: The queue of left foot absolute positions.
       @param[out] RightFootAbsolutePositions: The queue of right foot absolute positions.
     */
-    void EndPhaseOfTheWalking(deque<ZMPPosition> &ZMPPositions,
-			      deque<COMState> &FinalCOMStates,
-			      deque<FootAbsolutePosition> &LeftFootAbsolutePositions,
-			      deque<FootAbsolutePosition> &RightFootAbsolutePositions);
+    void EndPhaseOfTheWalking(RingBuffer<ZMPPosition> &ZMPPositions,
+			      RingBuffer<COMState> &FinalCOMStates,
+			      RingBuffer<FootAbsolutePosition> &LeftFootAbsolutePositions,
+			      RingBuffer<FootAbsolutePosition> &RightFootAbsolutePositions);
 
     
     int ValidationConstraints(double * & DPx,double * &DPu,
@@ -286,6 +288,9 @@ namespace PatternGeneratorJRL
 
     /*! Sampling of the QP. */
     double m_QP_T;
+
+    /*! Time of the last call to BuildConstraintMatrices (debugging). */
+    double m_LocalTime;
     
     /*! Preview window */
     unsigned int m_QP_N;
@@ -332,11 +337,12 @@ namespace PatternGeneratorJRL
     /* Constant parts of the linear constraints. */
     double * m_Pu;
 
-    /* Constant parts of the linear constraints. */
-    Eigen::MatrixXd m_iPu;
+    /* Constant parts of the linear constraints.
+       Row major as the PLDP solver reads the arrays by rows. */
+    Eigen::Matrix<double,Eigen::Dynamic,Eigen::Dynamic,Eigen::RowMajor> m_iPu;
 
-    /* Constant parts of the dynamical system. */
-    Eigen::MatrixXd m_Px;
+    /* Constant parts of the dynamical system. Row major, see m_iPu. */
+    Eigen::Matrix<double,Eigen::Dynamic,Eigen::Dynamic,Eigen::RowMajor> m_Px;
 
     /*! \brief Debugging variable: dump everything is set to 1 */
     unsigned int m_FullDebug;
@@ -345,9 +351,25 @@ namespace PatternGeneratorJRL
     unsigned int m_FastFormulationMode;
     
     /*! Primal Least square Distance Problem solver */
-    Optimization::Solver::PLDPSolver * m_PLDPSolver;
+    Optimization::Solver::PLDPSolverEigen * m_PLDPSolver;
+
+    /*! Capture of the problems given to m_PLDPSolver,
+      see :dimitrovcapture. */
+    Optimization::Solver::PLDPCapture m_PLDPCapture;
 
     /*! @} */
+
+    /*! \name Explicit solution by support pattern, in the QLD and PLDP
+      modes (:setdimitrovconstraint cache on|off)
+      @{ */
+    bool m_UseActiveSetCache;
+    /*! Optimal active sets of the previous windows, the solver is
+      called only when none of them applies. */
+    ActiveSetCache m_ActiveSetCache;
+    /*! Key of the support polygons over the window,
+      computed by BuildConstraintMatrices. */
+    unsigned long long m_SupportPatternKey;
+    /*! @} */
     
     int DumpProblem(double * Q,
 		    double * D, 
@@ -142,11 +142,11 @@ ZMPDiscretization::~ZMPDiscretization()
 
 void ZMPDiscretization::
 GetZMPDiscretization
-(deque<ZMPPosition> & FinalZMPPositions,
- deque<COMState> & FinalCOMStates,
+(RingBuffer<ZMPPosition> & FinalZMPPositions,
+ RingBuffer<COMState> & FinalCOMStates,
  deque<RelativeFootPosition> &RelativeFootPositions,
- deque<FootAbsolutePosition> &LeftFootAbsolutePositions,
- deque<FootAbsolutePosition> &RightFootAbsolutePositions,
+ RingBuffer<FootAbsolutePosition> &LeftFootAbsolutePositions,
+ RingBuffer<FootAbsolutePosition> &RightFootAbsolutePositions,
  double , //Xmax,
  COMState & lStartingCOMState,
  Eigen::Vector3d & lStartingZMPPosition,
@@ -175,7 +175,7 @@ GetZMPDiscretization
 }
 
 void ZMPDiscretization::DumpFootAbsolutePosition(string aFileName,
-						 deque<FootAbsolutePosition> &aFootAbsolutePositions)
+						 RingBuffer<FootAbsolutePosition> &aFootAbsolutePositions)
 {
   ofstream aof;
   aof.open(aFileName.c_str(),ofstream::out);
@@ -212,8 +212,8 @@ void ZMPDiscretization::ResetADataFile(string &DataFile)
     }
 }
 void ZMPDiscretization::DumpDataFiles(string ZMPFileName, string FootFileName,
-				      deque<ZMPPosition> & ZMPPositions,
-				      deque<FootAbsolutePosition> & SupportFootAbsolutePositions)
+				      RingBuffer<ZMPPosition> & ZMPPositions,
+				      RingBuffer<FootAbsolutePosition> & SupportFootAbsolutePositions)
 {
   ofstream aof;
   aof.open(ZMPFileName.c_str(),ofstream::out);
@@ -263,8 +263,8 @@ void ZMPDiscretization::InitializeFilter()
 
 }
 
-void ZMPDiscretization::FilterZMPRef(deque<ZMPPosition> &ZMPPositionsX,
-				     deque<ZMPPosition> &ZMPPositionsY)
+void ZMPDiscretization::FilterZMPRef(RingBuffer<ZMPPosition> &ZMPPositionsX,
+				     RingBuffer<ZMPPosition> &ZMPPositionsY)
 {
   int n=0;
   double T=0.050; // Arbritraty fixed from Kajita's San matlab files.
@@ -320,10 +320,10 @@ void ZMPDiscretization::SetZMPShift(vector<double> &ZMPShift)
 /* Initialiazation of the on-line stacks. */
 std::size_t ZMPDiscretization::
 InitOnLine
-(deque<ZMPPosition> & FinalZMPPositions,
- deque<COMState> & FinalCoMStates,
- deque<FootAbsolutePosition> &LeftFootAbsolutePositions,
- deque<FootAbsolutePosition> &RightFootAbsolutePositions,
+(RingBuffer<ZMPPosition> & FinalZMPPositions,
+ RingBuffer<COMState> & FinalCoMStates,
+ RingBuffer<FootAbsolutePosition> &LeftFootAbsolutePositions,
+ RingBuffer<FootAbsolutePosition> &RightFootAbsolutePositions,
  FootAbsolutePosition & InitLeftFootAbsolutePosition,
  FootAbsolutePosition & InitRightFootAbsolutePosition,
  deque<RelativeFootPosition> &RelativeFootPositions,
@@ -396,7 +396,7 @@ InitOnLine
   }
 
   ODEBUG(AddArraySize);
-  deque<ZMPPosition> ZMPPositions;
+  RingBuffer<ZMPPosition> ZMPPositions;
   ZMPPositions.resize(AddArraySize);
   FinalCoMStates.resize(AddArraySize);
   LeftFootAbsolutePositions.resize(AddArraySize);
@@ -564,10 +564,10 @@ void ZMPDiscretization::UpdateCurrentSupportFootPosition(RelativeFootPosition aR
 
 void ZMPDiscretization::OnLine
 (double, // time,
- deque<ZMPPosition> & ,// FinalZMPPositions,
- deque<COMState> & , //FinalCOMStates,
- deque<FootAbsolutePosition> &,//FinalLeftFootAbsolutePositions,
- deque<FootAbsolutePosition> &)//FinalRightFootAbsolutePositions)
+ RingBuffer<ZMPPosition> & ,// FinalZMPPositions,
+ RingBuffer<COMState> & , //FinalCOMStates,
+ RingBuffer<FootAbsolutePosition> &,//FinalLeftFootAbsolutePositions,
+ RingBuffer<FootAbsolutePosition> &)//FinalRightFootAbsolutePositions)
 {
   /* Does nothing... */
 }
@@ -577,15 +577,15 @@ void ZMPDiscretization::OnLine
    state of the relative steps stack. */
 void ZMPDiscretization::OnLineAddFoot
 (RelativeFootPosition & NewRelativeFootPosition,
- deque<ZMPPosition> & FinalZMPPositions,
- deque<COMState> & FinalCOMStates,
- deque<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
- deque<FootAbsolutePosition> &FinalRightFootAbsolutePositions,
+ RingBuffer<ZMPPosition> & FinalZMPPositions,
+ RingBuffer<COMState> & FinalCOMStates,
+ RingBuffer<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
+ RingBuffer<FootAbsolutePosition> &FinalRightFootAbsolutePositions,
  bool EndSequence)
 {
-  deque<ZMPPosition> ZMPPositions;
-  deque<FootAbsolutePosition> LeftFootAbsolutePositions;
-  deque<FootAbsolutePosition> RightFootAbsolutePositions;
+  RingBuffer<ZMPPosition> ZMPPositions;
+  RingBuffer<FootAbsolutePosition> LeftFootAbsolutePositions;
+  RingBuffer<FootAbsolutePosition> RightFootAbsolutePositions;
   FootAbsolutePosition CurrentLeftFootAbsPos, CurrentRightFootAbsPos;
   double CurrentAbsZMPTheta=0;
 
@@ -1024,8 +1024,8 @@ void ZMPDiscretization::OnLineAddFoot
 
 }
 
-void ZMPDiscretization::DumpReferences(deque<ZMPPosition> & FinalZMPPositions,
-				       deque<ZMPPosition> & ZMPPositions)
+void ZMPDiscretization::DumpReferences(RingBuffer<ZMPPosition> & FinalZMPPositions,
+				       RingBuffer<ZMPPosition> & ZMPPositions)
 {
 
 
@@ -1047,8 +1047,8 @@ void ZMPDiscretization::DumpReferences(deque<ZMPPosition> & FinalZMPPositions,
 
 }
 
-void ZMPDiscretization::FilterOutValues(deque<ZMPPosition> &ZMPPositions,
-					deque<ZMPPosition> &FinalZMPPositions,
+void ZMPDiscretization::FilterOutValues(RingBuffer<ZMPPosition> &ZMPPositions,
+					RingBuffer<ZMPPosition> &FinalZMPPositions,
 					bool InitStep)
 {
   unsigned int lshift=2;
@@ -1115,10 +1115,10 @@ void ZMPDiscretization::FilterOutValues(deque<ZMPPosition> &ZMPPositions,
 
 int ZMPDiscretization::OnLineFootChange(double ,//time,
 					FootAbsolutePosition & ,//aFootAbsolutePosition,
-					deque<ZMPPosition> & ,//FinalZMPPositions,
-					deque<COMState> & ,//CoMStates,
-					deque<FootAbsolutePosition> & ,//FinalLeftFootAbsolutePositions,
-					deque<FootAbsolutePosition> & ,//FinalRightFootAbsolutePositions,
+					RingBuffer<ZMPPosition> & ,//FinalZMPPositions,
+					RingBuffer<COMState> & ,//CoMStates,
+					RingBuffer<FootAbsolutePosition> & ,//FinalLeftFootAbsolutePositions,
+					RingBuffer<FootAbsolutePosition> & ,//FinalRightFootAbsolutePositions,
 					StepStackHandler * )//aStepStackHandler)
 {
   return -1;
@@ -1131,13 +1131,13 @@ int ZMPDiscretization::ReturnOptimalTimeToRegenerateAStep()
   return 2*r;
 }
 
-void ZMPDiscretization::EndPhaseOfTheWalking(  deque<ZMPPosition> &FinalZMPPositions,
-					       deque<COMState> &FinalCOMStates,
-					       deque<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
-					       deque<FootAbsolutePosition> &FinalRightFootAbsolutePositions)
+void ZMPDiscretization::EndPhaseOfTheWalking(  RingBuffer<ZMPPosition> &FinalZMPPositions,
+					       RingBuffer<COMState> &FinalCOMStates,
+					       RingBuffer<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
+					       RingBuffer<FootAbsolutePosition> &FinalRightFootAbsolutePositions)
 
 {
-  deque<ZMPPosition> ZMPPositions;
+  RingBuffer<ZMPPosition> ZMPPositions;
   FootAbsolutePosition LeftFootAbsolutePosition;
   FootAbsolutePosition RightFootAbsolutePosition;
 
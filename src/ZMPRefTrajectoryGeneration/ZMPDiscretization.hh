@@ -38,6 +38,7 @@
 
 /*! System includes */
 #include <deque>
+#include <RingBuffer.hh>
 #include <string>
 
 using namespace::std;
@@ -130,11 +131,11 @@ namespace PatternGeneratorJRL
 	  @param[in] InitRightFootAbsolutePosition: The initial position of the right foot.
 
 	   */
-      void GetZMPDiscretization(deque<ZMPPosition> & ZMPPositions,
-				deque<COMState> & CoMStates,
+      void GetZMPDiscretization(RingBuffer<ZMPPosition> & ZMPPositions,
+				RingBuffer<COMState> & CoMStates,
 				deque<RelativeFootPosition> &RelativeFootPositions,
-				deque<FootAbsolutePosition> &LeftFootAbsolutePositions,
-				deque<FootAbsolutePosition> &RightFootAbsolutePositions,
+				RingBuffer<FootAbsolutePosition> &LeftFootAbsolutePositions,
+				RingBuffer<FootAbsolutePosition> &RightFootAbsolutePositions,
 				double Xmax,
 				COMState & lStartingCOMState,
 				Eigen::Vector3d & lStartingZMPPosition,
@@ -143,22 +144,22 @@ namespace PatternGeneratorJRL
 
       /*! Dump data files. */
       void DumpDataFiles(string ZMPFileName, string FootFileName,			       
-			 deque<ZMPPosition> &ZMPPositions,
-			 deque<FootAbsolutePosition> &FootAbsolutePositions);
+			 RingBuffer<ZMPPosition> &ZMPPositions,
+			 RingBuffer<FootAbsolutePosition> &FootAbsolutePositions);
 
       void DumpFootAbsolutePosition(string aFileName,
-				    deque<FootAbsolutePosition> &aFootAbsolutePositions);
+				    RingBuffer<FootAbsolutePosition> &aFootAbsolutePositions);
 
       /** Update the value of the foot configuration according to the 
 	  current situation. */
-      void UpdateFootPosition(deque<FootAbsolutePosition> &SupportFootAbsolutePositions,
-			      deque<FootAbsolutePosition> &NoneSupportFootAbsolutePositions,
+      void UpdateFootPosition(RingBuffer<FootAbsolutePosition> &SupportFootAbsolutePositions,
+			      RingBuffer<FootAbsolutePosition> &NoneSupportFootAbsolutePositions,
 			      int index, int k, int indexinitial, double ModulationSupportTime,int StepType,
 			      int LeftOrRight);
 
       /*! IIR filtering of ZMP Position X put in ZMP Position Y. */
-      void FilterZMPRef(deque<ZMPPosition> &ZMPPositionsX,
-			deque<ZMPPosition> &ZMPPositionsY);
+      void FilterZMPRef(RingBuffer<ZMPPosition> &ZMPPositionsX,
+			RingBuffer<ZMPPosition> &ZMPPositionsY);
 
       /*! ZMP shift parameters to shift ZMP position during Single support with respect to the normal ankle position */
       void SetZMPShift(std::vector<double> &ZMPShift);
@@ -173,10 +174,10 @@ namespace PatternGeneratorJRL
 	Returns the number of steps which has been completely put inside 
 	the queue of ZMP, and foot positions.
        */
-      std::size_t InitOnLine(deque<ZMPPosition> & FinalZMPPositions,
-			     deque<COMState> & CoMStates,
-			     deque<FootAbsolutePosition> & FinalLeftFootAbsolutePositions,
-			     deque<FootAbsolutePosition> & FinalRightFootAbsolutePositions,
+      std::size_t InitOnLine(RingBuffer<ZMPPosition> & FinalZMPPositions,
+			     RingBuffer<COMState> & CoMStates,
+			     RingBuffer<FootAbsolutePosition> & FinalLeftFootAbsolutePositions,
+			     RingBuffer<FootAbsolutePosition> & FinalRightFootAbsolutePositions,
 			     FootAbsolutePosition & InitLeftFootAbsolutePosition,
 			     FootAbsolutePosition & InitRightFootAbsolutePosition,
 			     deque<RelativeFootPosition> &RelativeFootPositions,
@@ -185,17 +186,17 @@ namespace PatternGeneratorJRL
       
       /*! \brief  Methods to update the stacks on-line. */
       void OnLine(double time,
-		  deque<ZMPPosition> & FinalZMPPositions,					     
-		  deque<COMState> & CoMStates,
-		  deque<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
-		  deque<FootAbsolutePosition> &FinalRightFootAbsolutePositions);
+		  RingBuffer<ZMPPosition> & FinalZMPPositions,					     
+		  RingBuffer<COMState> & CoMStates,
+		  RingBuffer<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
+		  RingBuffer<FootAbsolutePosition> &FinalRightFootAbsolutePositions);
 
       /*! \brief  Methods to update the stack on-line by inserting a new foot position. */
       void OnLineAddFoot(RelativeFootPosition & NewRelativeFootPosition,
-			 deque<ZMPPosition> & FinalZMPPositions,					     
-			 deque<COMState> & CoMStates,
-			 deque<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
-			 deque<FootAbsolutePosition> &FinalRightFootAbsolutePositions,
+			 RingBuffer<ZMPPosition> & FinalZMPPositions,					     
+			 RingBuffer<COMState> & CoMStates,
+			 RingBuffer<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
+			 RingBuffer<FootAbsolutePosition> &FinalRightFootAbsolutePositions,
 			 bool EndSequence);
 
       /* ! \brief Method to change on line the landing position of a foot.
@@ -203,10 +204,10 @@ namespace PatternGeneratorJRL
       */
       int OnLineFootChange(double time,
 			   FootAbsolutePosition &aFootAbsolutePosition,
-			   deque<ZMPPosition> & FinalZMPPositions,			     
-			   deque<COMState> & CoMStates,
-			   deque<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
-			   deque<FootAbsolutePosition> &FinalRightFootAbsolutePositions,
+			   RingBuffer<ZMPPosition> & FinalZMPPositions,			     
+			   RingBuffer<COMState> & CoMStates,
+			   RingBuffer<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
+			   RingBuffer<FootAbsolutePosition> &FinalRightFootAbsolutePositions,
 			   StepStackHandler * aStepStackHandler=0);
 
       /*! \brief Return the time at which it is optimal to regenerate a step in online mode. 
@@ -217,14 +218,14 @@ namespace PatternGeneratorJRL
       void UpdateCurrentSupportFootPosition(RelativeFootPosition aRFP);
 
       /// End phase of the walking.
-      void EndPhaseOfTheWalking(  deque<ZMPPosition> &ZMPPositions,
-				  deque<COMState> &FinalCOMStates,
-				  deque<FootAbsolutePosition> &LeftFootAbsolutePositions,
-				  deque<FootAbsolutePosition> &RightFootAbsolutePositions);
+      void EndPhaseOfTheWalking(  RingBuffer<ZMPPosition> &ZMPPositions,
+				  RingBuffer<COMState> &FinalCOMStates,
+				  RingBuffer<FootAbsolutePosition> &LeftFootAbsolutePositions,
+				  RingBuffer<FootAbsolutePosition> &RightFootAbsolutePositions);
 
       /*! Filter out the ZMP values and put them at the back FinalZMPPositions. */
-      void FilterOutValues(deque<ZMPPosition> &ZMPPositions,
-			   deque<ZMPPosition> &FinalZMPPositions,
+      void FilterOutValues(RingBuffer<ZMPPosition> &ZMPPositions,
+			   RingBuffer<ZMPPosition> &FinalZMPPositions,
 			   bool InitPhase);
       
       /*! Set the ZMP neutral position in the global coordinates system */
@@ -250,8 +251,8 @@ namespace PatternGeneratorJRL
       void ResetADataFile(string &aDataFile);
 
       /*! \brief Dump references */
-      void DumpReferences(deque<ZMPPosition> &FinalZMPPositions,
-			  deque<ZMPPosition> &ZMPPositions);
+      void DumpReferences(RingBuffer<ZMPPosition> &FinalZMPPositions,
+			  RingBuffer<ZMPPosition> &ZMPPositions);
 
       /* ! ModulationSupportCoefficient coeeficient to wait a little before foot is of the ground */
       double m_ModulationSupportCoefficient;
@@ -42,6 +42,7 @@
 
 #include <Mathematics/qld.hh>
 #include <ZMPRefTrajectoryGeneration/ZMPQPWithConstraint.hh>
+#include <QPCapture.hh>
 
 
 using namespace std;
@@ -79,6 +80,10 @@ ZMPQPWithConstraint::ZMPQPWithConstraint(SimplePluginManager *lSPM,
 
   m_SamplingPeriod = 0.005;
 
+  m_QPSolver = QLD;
+  m_NbOfConstraintsOfFirstSample = 0;
+  m_UseActiveSetCache = false;
+  m_SupportPatternKey = ActiveSetCache::EmptyKey;
 }
 
 ZMPQPWithConstraint::~ZMPQPWithConstraint()
@@ -226,8 +231,8 @@ int ZMPQPWithConstraint::ComputeLinearSystem(vector<CH_Point> aVecOfPoints,
   return 0;
 }
 
-int ZMPQPWithConstraint::BuildLinearConstraintInequalities(deque<FootAbsolutePosition> &LeftFootAbsolutePositions,
-							 deque<FootAbsolutePosition> &RightFootAbsolutePositions,
+int ZMPQPWithConstraint::BuildLinearConstraintInequalities(RingBuffer<FootAbsolutePosition> &LeftFootAbsolutePositions,
+							 RingBuffer<FootAbsolutePosition> &RightFootAbsolutePositions,
 							 deque<LinearConstraintInequality_t *> &
 							 QueueOfLConstraintInequalities,
 							 double ConstraintOnX,
@@ -566,11 +571,14 @@ int ZMPQPWithConstraint::BuildMatricesPxPu(double * & Px,double * &Pu,
 	  break;
 	}
       IndexConstraint += (int)((*LCI_it)->A.rows());
+      if (i==0)
+	m_NbOfConstraintsOfFirstSample = IndexConstraint;
     }  
   NbOfConstraints = IndexConstraint;
 
   LCI_it = store_it;
   IndexConstraint = 0;
+  m_SupportPatternKey = ActiveSetCache::EmptyKey;
   ODEBUG("Starting Matrix to build the constraints. ");
   ODEBUG((*LCI_it)->A );
   for(unsigned int i=0;i<N;i++)
@@ -586,6 +594,11 @@ int ZMPQPWithConstraint::BuildMatricesPxPu(double * & Px,double * &Pu,
 	{
 	}
 
+      // Pu only depends on the polygon of each sample.
+      m_SupportPatternKey =
+	ActiveSetCache::combine(m_SupportPatternKey,(*LCI_it)->A.data(),
+				(unsigned int)(*LCI_it)->A.size());
+
       // For each constraint.
       for(unsigned j=0;j<(*LCI_it)->A.rows();j++)
 	{
@@ -653,10 +666,10 @@ int ZMPQPWithConstraint::BuildMatricesPxPu(double * & Px,double * &Pu,
   return 0;
 }
 
-int ZMPQPWithConstraint::BuildZMPTrajectoryFromFootTrajectory(deque<FootAbsolutePosition> &LeftFootAbsolutePositions,
-							      deque<FootAbsolutePosition> &RightFootAbsolutePositions,
-							      deque<ZMPPosition> &ZMPRefPositions,
-							      deque<COMState> &COMStates,
+int ZMPQPWithConstraint::BuildZMPTrajectoryFromFootTrajectory(RingBuffer<FootAbsolutePosition> &LeftFootAbsolutePositions,
+							      RingBuffer<FootAbsolutePosition> &RightFootAbsolutePositions,
+							      RingBuffer<ZMPPosition> &ZMPRefPositions,
+							      RingBuffer<COMState> &COMStates,
 							      double ConstraintOnX,
 							      double ConstraintOnY,
 							      double T,
@@ -668,7 +681,8 @@ int ZMPQPWithConstraint::BuildZMPTrajectoryFromFootTrajectory(deque<FootAbsolute
   //  unsigned int N = 100;
   //  double ComHeight=0.814;
   double ComHeight=0.80;
-  double *Px=0,*Pu=0;
+  AllocateQPWorkspaces(N);
+  double *Px=m_QPPx.data(),*Pu=m_QPPu.data();
   unsigned int NbOfConstraints=8*N; // Nb of constraints to be taken into account
   // for each iteration
   Eigen::VectorXd xk;Eigen::VectorXd Buk;Eigen::VectorXd zk;
@@ -795,26 +809,24 @@ int ZMPQPWithConstraint::BuildZMPTrajectoryFromFootTrajectory(deque<FootAbsolute
   int nmax = 2*N; // Size of the matrix to compute the cost function.
   int mnn = m+n+n;
 
-  double *C=new double[4*N*N]; // Objective function matrix
-  double *D=new double[2*N];   // Constant part of the objective function
-  double *XL=new double[2*N];  // Lower bound of the jerk.
-  double *XU=new double[2*N];  // Upper bound of the jerk.
-  double *X=new double[2*N];   // Solution of the system.
+  double *C=m_QPC.data(); // Objective function matrix
+  double *D=m_QPD.data();   // Constant part of the objective function
+  double *XL=m_QPXL.data();  // Lower bound of the jerk.
+  double *XU=m_QPXU.data();  // Upper bound of the jerk.
+  double *X=m_QPX.data();   // Solution of the system.
   double Eps=1e-8 ;
-  double *U = (double *)malloc( sizeof(double)*mnn); // Returns the Lagrange multipliers.;
+  double *U = m_QPU.data(); // Returns the Lagrange multipliers.;
 
-  // Initialization of the matrices
-  memset(C,0,4*N*N*sizeof(double));
-  for(unsigned int i=0;i<2*N;i++)
-    C[i*2*N+i] = 1.0;
-  
   int iout=0;
   int ifail;
   int iprint=1;
-  int lwar=3*nmax*nmax/2+ 10*nmax  + 2*mmax + 20000;;
-  double *war= (double *)malloc(sizeof(double)*lwar);
+  int lwar=(int)m_QPWar.size();
+  double *war= m_QPWar.data();
   int liwar = n; //
-  int *iwar = new int[liwar]; // The Cholesky decomposition is done internally.
+  int *iwar = m_QPIwar.data(); // The Cholesky decomposition is done internally.
+
+  // A new trajectory: the previous active set is meaningless.
+  m_ActiveSetQP.reset();
 
 
   for(int i=0;i<6;i++)
@@ -902,29 +914,13 @@ int ZMPQPWithConstraint::BuildZMPTrajectoryFromFootTrajectory(deque<FootAbsolute
 
   // pre computes the matrices needed for the optimization.
 
-  //  OptA = Id + alpha * VPu.Transpose() * VPu + beta * PPu.Transpose() * PPu;
-  Eigen::MatrixXd lterm1;
-  Eigen::MatrixXd tmp;
-
-  tmp = PPu.transpose();
-  lterm1=tmp+PPu;
-  //  lterm1=beta+tmp;
-
-  Eigen::MatrixXd lterm2;
-  tmp = VPu.transpose();
-  lterm2=tmp+VPu;
-  //lterm2=alpha+tmp;
-
-  OptA.resize(lterm1.rows(),
-	      lterm1.cols());
-  //OptA.setIdentity();
-  OptA = beta*lterm1 + alpha*lterm2;
+  // The products of the vnl version had been ported as sums,
+  // which made OptA indefinite.
+  OptA = Id + alpha * VPu.transpose() * VPu + beta * PPu.transpose() * PPu;
 
   if (CriteriaToMaximize==1)
     {
-      for(unsigned int i=0;i<2*N;i++)
-	for(unsigned int j=0;j<2*N;j++)
-	  C[j*2*N+i] = OptA(i,j);
+      m_QPC = OptA;
 
       if (0)
 	{
@@ -944,12 +940,7 @@ int ZMPQPWithConstraint::BuildZMPTrajectoryFromFootTrajectory(deque<FootAbsolute
 	}
     }
   
-  lterm1 = PPu.transpose();
-  lterm1=lterm1+PPx;
-  OptB = VPu.transpose();
-  tmp=OptB+VPx;
-  OptB = alpha*tmp;
-  OptB += beta * lterm1;
+  OptB = alpha * VPu.transpose() * VPx + beta * PPu.transpose() * PPx;
 
   if (0)
   {
@@ -1002,6 +993,10 @@ int ZMPQPWithConstraint::BuildZMPTrajectoryFromFootTrajectory(deque<FootAbsolute
       StartingTime+=T,li++)
     {
       gettimeofday(&start,0);
+      // The rows of the first sample of the previous window are dropped.
+      if (m_QPSolver==ACTIVESET)
+	m_ActiveSetQP.shift_working_set(m_NbOfConstraintsOfFirstSample);
+
       // Build the related matrices.
       BuildMatricesPxPu(Px,Pu,
 			N,T,
@@ -1042,10 +1037,7 @@ int ZMPQPWithConstraint::BuildZMPTrajectoryFromFootTrajectory(deque<FootAbsolute
 
       if (CriteriaToMaximize==1)
 	{
-	  Eigen::VectorXd lterm1v;
-	  lterm1v=OptC+ZMPRef;
-	  OptD=OptB+xk;
-	  OptD -= lterm1v;
+	  OptD = OptB*xk - OptC*ZMPRef;
 	  for(unsigned int i=0;i<2*N;i++)
 	    D[i] = OptD[i];
 
@@ -1089,13 +1081,37 @@ int ZMPQPWithConstraint::BuildZMPTrajectoryFromFootTrajectory(deque<FootAbsolute
 	    vnlStorePx(i,li) = Px[i];
 	}
 
-      iwar[0]=1;
       ODEBUG("m: " << m);
-      ql0001_(&m, &me, &mmax,&n, &nmax,&mnn,
-	      C, D, Pu,Px,XL,XU,
-	      X,U,&iout, &ifail, &iprint,
-	      war, &lwar,
-	      iwar, &liwar,&Eps);
+      bool lCacheHit = false;
+      if (m_UseActiveSetCache)
+	lCacheHit = m_ActiveSetCache.solve(m_SupportPatternKey,n,m,me,
+					   C,D,Pu,mmax,Px,XL,XU,X);
+      if (lCacheHit)
+	ifail = 0;
+      else if (m_QPSolver==ACTIVESET)
+	{
+	  // Pu has the layout of QLD: mmax rows.
+	  ifail = m_ActiveSetQP.solve(n,m,me,C,D,Pu,mmax,Px,XL,XU,X,U);
+	  ODEBUG("Active set QP: " << m_ActiveSetQP.NbIterations()
+		 << " iterations");
+	}
+      else
+	{
+	  iwar[0]=1;
+	  ql0001_(&m, &me, &mmax,&n, &nmax,&mnn,
+		  C, D, Pu,Px,XL,XU,
+		  X,U,&iout, &ifail, &iprint,
+		  war, &lwar,
+		  iwar, &liwar,&Eps);
+	}
+      if ((m_UseActiveSetCache) && (!lCacheHit) && (ifail==0))
+	m_ActiveSetCache.store(m_SupportPatternKey,n,m,me,
+			       C,Pu,mmax,Px,XL,XU,X);
+
+      QPCapture & aCapture = QPCapture::Instance();
+      if (aCapture.IsRunning())
+	aCapture.Record(QP_CAPTURE_WIEBER,StartingTime,n,m,me,
+			C,D,Pu,mmax,Px,XL,XU,X,ifail);
       if (ifail!=0)
 	{
 	  cout << "IFAIL: " << ifail << endl;
@@ -1239,7 +1255,7 @@ int ZMPQPWithConstraint::BuildZMPTrajectoryFromFootTrajectory(deque<FootAbsolute
       // Simulate the dynamical system
       xk = m_A*xk + Buk ;
       // Modif. from Dimitar: Initially a mistake regarding the ordering.
-      zk=m_C+xk;
+      zk=m_C*xk;
 
       ODEBUG4(xk[0] << " " << xk[1] << " " << xk[2] << " " <<
 	      xk[3] << " " << xk[4] << " " << xk[5] << " " <<
@@ -1303,14 +1319,6 @@ int ZMPQPWithConstraint::BuildZMPTrajectoryFromFootTrajectory(deque<FootAbsolute
   
   /*  cout << "Size of PX: " << vnlStorePx.rows() << " " 
       << vnlStorePx.cols() << " " << endl; */
-  delete C;
-  delete D;
-  delete XL;
-  delete XU;
-  delete X;
-  free(war);
-  free(U);
-  delete iwar;
   // Clean the queue of Linear Constraint Inequalities.
   deque<LinearConstraintInequality_t *>::iterator LCI_it;
   LCI_it = QueueOfLConstraintInequalities.begin();
@@ -1327,11 +1335,30 @@ int ZMPQPWithConstraint::BuildZMPTrajectoryFromFootTrajectory(deque<FootAbsolute
 }
 
 
-void ZMPQPWithConstraint::GetZMPDiscretization(deque<ZMPPosition> & ZMPPositions,
-					       deque<COMState> & COMStates,
+void ZMPQPWithConstraint::AllocateQPWorkspaces(unsigned int N)
+{
+  // At most 8 constraints per sample, see BuildMatricesPxPu.
+  unsigned int n = 2*N, mmax = 8*N+1;
+  if (m_QPC.rows()==(int)n)
+    return;
+
+  m_QPC.resize(n,n);
+  m_QPD.resize(n);
+  m_QPXL.resize(n);
+  m_QPXU.resize(n);
+  m_QPX.resize(n);
+  m_QPU.resize(mmax-1+2*n);
+  m_QPPx.resize(mmax);
+  m_QPPu.resize(mmax*n);
+  m_QPWar.resize(3*n*n/2+ 10*n  + 2*mmax + 20000);
+  m_QPIwar.resize(n);
+}
+
+void ZMPQPWithConstraint::GetZMPDiscretization(RingBuffer<ZMPPosition> & ZMPPositions,
+					       RingBuffer<COMState> & COMStates,
 					       deque<RelativeFootPosition> &RelativeFootPositions,
-					       deque<FootAbsolutePosition> &LeftFootAbsolutePositions,
-					       deque<FootAbsolutePosition> &RightFootAbsolutePositions,
+					       RingBuffer<FootAbsolutePosition> &LeftFootAbsolutePositions,
+					       RingBuffer<FootAbsolutePosition> &RightFootAbsolutePositions,
 					       double Xmax,
 					       COMState & lStartingCOMState,
 					       Eigen::Vector3d & lStartingZMPPosition,
@@ -1399,15 +1426,33 @@ void ZMPQPWithConstraint::CallMethod(std::string & Method, std::istringstream &s
 	  strm >> m_QP_N;
 	  cout << "Preview window for the QP " << m_QP_N << endl;
 	}
+      else if (PBWCmd=="solver")
+	{
+	  string aSolverName;
+	  strm >> aSolverName;
+	  if (aSolverName=="qld")
+	    m_QPSolver = QLD;
+	  else if (aSolverName=="activeset")
+	    m_QPSolver = ACTIVESET;
+	  else
+	    std::cerr << "Unknown QP solver " << aSolverName << std::endl;
+	}
+      else if (PBWCmd=="cache")
+	{
+	  string aMode;
+	  strm >> aMode;
+	  m_UseActiveSetCache = (aMode=="on");
+	  m_ActiveSetCache.clear();
+	}
     }
   ZMPRefTrajectoryGeneration::CallMethod(Method,strm);
 }
 
 
-std::size_t ZMPQPWithConstraint::InitOnLine(deque<ZMPPosition> & ,         // FinalZMPPositions,
-					    deque<COMState> & ,            // FinalCOMStates,
-					    deque<FootAbsolutePosition> & ,// FinalLeftFootAbsolutePositions,
-					    deque<FootAbsolutePosition> & ,// FinalRightFootAbsolutePositions,
+std::size_t ZMPQPWithConstraint::InitOnLine(RingBuffer<ZMPPosition> & ,         // FinalZMPPositions,
+					    RingBuffer<COMState> & ,            // FinalCOMStates,
+					    RingBuffer<FootAbsolutePosition> & ,// FinalLeftFootAbsolutePositions,
+					    RingBuffer<FootAbsolutePosition> & ,// FinalRightFootAbsolutePositions,
 					    FootAbsolutePosition & ,       // InitLeftFootAbsolutePosition,
 					    FootAbsolutePosition & ,       // InitRightFootAbsolutePosition,
 					    deque<RelativeFootPosition> &, // RelativeFootPositions,
@@ -1419,40 +1464,40 @@ std::size_t ZMPQPWithConstraint::InitOnLine(deque<ZMPPosition> & ,         // Fi
 }
 
 void ZMPQPWithConstraint::OnLineAddFoot(RelativeFootPosition & ,       // NewRelativeFootPosition,
-					deque<ZMPPosition> & ,         // FinalZMPPositions,	
-					deque<COMState> & ,            // FinalCOMStates,
-					deque<FootAbsolutePosition> &, // FinalLeftFootAbsolutePositions,
-					deque<FootAbsolutePosition> &, // FinalRightFootAbsolutePositions,
+					RingBuffer<ZMPPosition> & ,         // FinalZMPPositions,	
+					RingBuffer<COMState> & ,            // FinalCOMStates,
+					RingBuffer<FootAbsolutePosition> &, // FinalLeftFootAbsolutePositions,
+					RingBuffer<FootAbsolutePosition> &, // FinalRightFootAbsolutePositions,
 					bool )                         // EndSequence)
 {
   cout << "To be implemented" << endl;
 }
 
 void ZMPQPWithConstraint::OnLine(double ,                              // time,
-				 deque<ZMPPosition> & ,                // FinalZMPPositions,				     
-				 deque<COMState> & ,                   // FinalCOMStates,
-				 deque<FootAbsolutePosition> & ,       // FinalLeftFootAbsolutePositions,
-				 deque<FootAbsolutePosition> & )       // FinalRightFootAbsolutePositions)
+				 RingBuffer<ZMPPosition> & ,                // FinalZMPPositions,				     
+				 RingBuffer<COMState> & ,                   // FinalCOMStates,
+				 RingBuffer<FootAbsolutePosition> & ,       // FinalLeftFootAbsolutePositions,
+				 RingBuffer<FootAbsolutePosition> & )       // FinalRightFootAbsolutePositions)
 {
   cout << "To be implemented" << endl;
 }
 
 int ZMPQPWithConstraint::OnLineFootChange(double ,                        // time,
 					  FootAbsolutePosition & ,        // aFootAbsolutePosition,
-					  deque<ZMPPosition> & ,          // FinalZMPPositions,			     
-					  deque<COMState> & ,             // CoMStates,
-					  deque<FootAbsolutePosition> & , // FinalLeftFootAbsolutePositions,
-					  deque<FootAbsolutePosition> & , // FinalRightFootAbsolutePositions,
+					  RingBuffer<ZMPPosition> & ,          // FinalZMPPositions,			     
+					  RingBuffer<COMState> & ,             // CoMStates,
+					  RingBuffer<FootAbsolutePosition> & , // FinalLeftFootAbsolutePositions,
+					  RingBuffer<FootAbsolutePosition> & , // FinalRightFootAbsolutePositions,
 					  StepStackHandler  * )           // aStepStackHandler)
 {
   cout << "To be implemented" << endl;
   return -1;
 }
 
-void ZMPQPWithConstraint::EndPhaseOfTheWalking(deque<ZMPPosition> & ,          // ZMPPositions,
-					       deque<COMState> & ,             // FinalCOMStates,
-					       deque<FootAbsolutePosition> &,  // LeftFootAbsolutePositions,
-					       deque<FootAbsolutePosition> & ) // RightFootAbsolutePositions)
+void ZMPQPWithConstraint::EndPhaseOfTheWalking(RingBuffer<ZMPPosition> & ,          // ZMPPositions,
+					       RingBuffer<COMState> & ,             // FinalCOMStates,
+					       RingBuffer<FootAbsolutePosition> &,  // LeftFootAbsolutePositions,
+					       RingBuffer<FootAbsolutePosition> & ) // RightFootAbsolutePositions)
 {
   
 }
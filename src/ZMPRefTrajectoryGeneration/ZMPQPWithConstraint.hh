@@ -31,6 +31,8 @@
 
 
 #include <Mathematics/ConvexHull.hh>
+#include <Mathematics/active-set-qp.hh>
+#include <Mathematics/active-set-cache.hh>
 #include <ZMPRefTrajectoryGeneration/ZMPRefTrajectoryGeneration.hh>
 
 namespace PatternGeneratorJRL
@@ -50,8 +52,8 @@ namespace PatternGeneratorJRL
     /*! This method builds a set of linear constraint inequalities based
       on the foot trajectories given as an input.
       The result is a set Linear Constraint Inequalities. */
-    int BuildLinearConstraintInequalities(deque<FootAbsolutePosition> &LeftFootAbsolutePositions,
-					  deque<FootAbsolutePosition> &RightFootAbsolutePositions,
+    int BuildLinearConstraintInequalities(RingBuffer<FootAbsolutePosition> &LeftFootAbsolutePositions,
+					  RingBuffer<FootAbsolutePosition> &RightFootAbsolutePositions,
 					  deque<LinearConstraintInequality_t *> & QueueOfLConstraintInequalities,
 					  double ConstraintOnX,
 					  double ConstraintOnY);
@@ -89,11 +91,11 @@ namespace PatternGeneratorJRL
 
 	  
 	   */
-    void GetZMPDiscretization(deque<ZMPPosition> & ZMPPositions,
-			      deque<COMState> & CoMStates,
+    void GetZMPDiscretization(RingBuffer<ZMPPosition> & ZMPPositions,
+			      RingBuffer<COMState> & CoMStates,
 			      deque<RelativeFootPosition> &RelativeFootPositions,
-			      deque<FootAbsolutePosition> &LeftFootAbsolutePositions,
-			      deque<FootAbsolutePosition> &RightFootAbsolutePositions,
+			      RingBuffer<FootAbsolutePosition> &LeftFootAbsolutePositions,
+			      RingBuffer<FootAbsolutePosition> &RightFootAbsolutePositions,
 			      double Xmax,
 			      COMState & lStartingCOMState,
 			      Eigen::Vector3d & lStartingZMPPosition,
@@ -102,10 +104,10 @@ namespace PatternGeneratorJRL
 
     /*! This method is a new way of computing the ZMP trajectory from
       foot trajectory. */
-    int BuildZMPTrajectoryFromFootTrajectory(deque<FootAbsolutePosition> &LeftFootAbsolutePositions,
-					     deque<FootAbsolutePosition> &RightFootAbsolutePositions,
-					     deque<ZMPPosition> &ZMPRefPositions,		       
-					     deque<COMState> &COMStates,
+    int BuildZMPTrajectoryFromFootTrajectory(RingBuffer<FootAbsolutePosition> &LeftFootAbsolutePositions,
+					     RingBuffer<FootAbsolutePosition> &RightFootAbsolutePositions,
+					     RingBuffer<ZMPPosition> &ZMPRefPositions,		       
+					     RingBuffer<COMState> &COMStates,
 					     double ConstraintOnX,
 					     double ConstraintOnY,
 					     double T,
@@ -127,7 +129,7 @@ namespace PatternGeneratorJRL
 			    Eigen::MatrixXd &B);
 
     /*! This method get the COM buffer computed by the QP in off-line mode. */
-    void GetComBuffer(deque<COMState> &aCOMBuffer);
+    void GetComBuffer(RingBuffer<COMState> &aCOMBuffer);
 
     /*! Call method to handle the plugins. */
     void CallMethod(std::string &Method, std::istringstream &strm);
@@ -144,10 +146,10 @@ namespace PatternGeneratorJRL
       Returns the number of steps which has been completely put inside 
       the queue of ZMP, and foot positions.
     */
-    std::size_t InitOnLine(deque<ZMPPosition> & FinalZMPPositions,
-			   deque<COMState> & CoMStates,		   
-			   deque<FootAbsolutePosition> & FinalLeftFootAbsolutePositions,
-			   deque<FootAbsolutePosition> & FinalRightFootAbsolutePositions,
+    std::size_t InitOnLine(RingBuffer<ZMPPosition> & FinalZMPPositions,
+			   RingBuffer<COMState> & CoMStates,		   
+			   RingBuffer<FootAbsolutePosition> & FinalLeftFootAbsolutePositions,
+			   RingBuffer<FootAbsolutePosition> & FinalRightFootAbsolutePositions,
 			   FootAbsolutePosition & InitLeftFootAbsolutePosition,
 			   FootAbsolutePosition & InitRightFootAbsolutePosition,
 			   deque<RelativeFootPosition> &RelativeFootPositions,
@@ -156,28 +158,28 @@ namespace PatternGeneratorJRL
     
     /* ! Methods to update the stack on-line by inserting a new foot position. */
     void OnLineAddFoot(RelativeFootPosition & NewRelativeFootPosition,
-		       deque<ZMPPosition> & FinalZMPPositions,		
-		       deque<COMState> & CoMStates,			     
-		       deque<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
-		       deque<FootAbsolutePosition> &FinalRightFootAbsolutePositions,
+		       RingBuffer<ZMPPosition> & FinalZMPPositions,		
+		       RingBuffer<COMState> & CoMStates,			     
+		       RingBuffer<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
+		       RingBuffer<FootAbsolutePosition> &FinalRightFootAbsolutePositions,
 		       bool EndSequence);
 
     /* ! \brief Method to update the stacks on-line */
     void OnLine(double time,
-		deque<ZMPPosition> & FinalZMPPositions,		
-		deque<COMState> & CoMStates,			     
-		deque<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
-		deque<FootAbsolutePosition> &FinalRightFootAbsolutePositions);
+		RingBuffer<ZMPPosition> & FinalZMPPositions,		
+		RingBuffer<COMState> & CoMStates,			     
+		RingBuffer<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
+		RingBuffer<FootAbsolutePosition> &FinalRightFootAbsolutePositions);
 
     /* ! \brief Method to change on line the landing position of a foot.
        @return If the method failed it returns -1, 0 otherwise.
     */
     int OnLineFootChange(double time,
 			 FootAbsolutePosition &aFootAbsolutePosition,
-			 deque<ZMPPosition> & FinalZMPPositions,			     
-			 deque<COMState> & CoMStates,
-			 deque<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
-			 deque<FootAbsolutePosition> &FinalRightFootAbsolutePositions,
+			 RingBuffer<ZMPPosition> & FinalZMPPositions,			     
+			 RingBuffer<COMState> & CoMStates,
+			 RingBuffer<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
+			 RingBuffer<FootAbsolutePosition> &FinalRightFootAbsolutePositions,
 			 StepStackHandler * aStepStackHandler=0);
 
     /*! \brief Method to stop walking.
@@ -186,10 +188,10 @@ namespace PatternGeneratorJRL
       @param[out] LeftFootAbsolutePositions: The queue of left foot absolute positions.
       @param[out] RightFootAbsolutePositions: The queue of right foot absolute positions.
     */
-    void EndPhaseOfTheWalking(deque<ZMPPosition> &ZMPPositions,
-			      deque<COMState> &FinalCOMStates,
-			      deque<FootAbsolutePosition> &LeftFootAbsolutePositions,
-			      deque<FootAbsolutePosition> &RightFootAbsolutePositions);
+    void EndPhaseOfTheWalking(RingBuffer<ZMPPosition> &ZMPPositions,
+			      RingBuffer<COMState> &FinalCOMStates,
+			      RingBuffer<FootAbsolutePosition> &LeftFootAbsolutePositions,
+			      RingBuffer<FootAbsolutePosition> &RightFootAbsolutePositions);
 
 
     /*! \brief Return the time at which it is optimal to regenerate a step in online mode. 
@@ -226,6 +228,44 @@ namespace PatternGeneratorJRL
     /*! Preview window */
     unsigned int m_QP_N;
 
+    /*! \name Solver of the QP (:setpbwconstraint solver qld|activeset)
+      @{ */
+    static const unsigned int QLD=0;
+    static const unsigned int ACTIVESET=1;
+    unsigned int m_QPSolver;
+
+    /*! Dense active-set solver, hot started from one window to the next. */
+    ActiveSetQP m_ActiveSetQP;
+    /*! Number of constraints of the first sample of the window. */
+    unsigned int m_NbOfConstraintsOfFirstSample;
+    /*! @} */
+
+    /*! \name Explicit solution by support pattern
+      (:setpbwconstraint cache on|off)
+      @{ */
+    bool m_UseActiveSetCache;
+    /*! Optimal active sets of the previous windows, the solver is
+      called only when none of them applies. */
+    ActiveSetCache m_ActiveSetCache;
+    /*! Key of the support polygons over the window,
+      computed by BuildMatricesPxPu. */
+    unsigned long long m_SupportPatternKey;
+    /*! @} */
+
+    /*! \name Workspaces of the QP, allocated once for a preview window.
+      The arrays have the column major layout of QLD.
+      @{ */
+    /*! Allocate the workspaces for a preview window of N samples. */
+    void AllocateQPWorkspaces(unsigned int N);
+
+    Eigen::MatrixXd m_QPC;
+    Eigen::VectorXd m_QPD, m_QPXL, m_QPXU, m_QPX, m_QPU;
+    /*! Constant and linear parts of the constraints. */
+    Eigen::VectorXd m_QPPx, m_QPPu;
+    Eigen::VectorXd m_QPWar;
+    Eigen::VectorXi m_QPIwar;
+    /*! @} */
+
   };
 }
 
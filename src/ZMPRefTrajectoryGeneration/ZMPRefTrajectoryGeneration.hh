@@ -31,6 +31,7 @@
 
 
 #include <deque>
+#include <RingBuffer.hh>
 #include <string>
 //#define FULL_POLYNOME
 
@@ -42,6 +43,15 @@ namespace PatternGeneratorJRL
 {
   class StepStackHandler;
 
+  /*! \brief Copy of the internal state of a ZMP reference trajectory
+    generator, created by ZMPRefTrajectoryGeneration::CreateState().
+    Its content is only known by the generator which created it. */
+  class ZMPRefTrajectoryGenerationState
+  {
+  public:
+    virtual ~ZMPRefTrajectoryGenerationState() {}
+  };
+
   /*! This class defines an abstract interface to generate ZMP reference trajectory
    and its associate CoM trajectory.
 
@@ -204,11 +214,11 @@ namespace PatternGeneratorJRL
 
 
     */
-    virtual void GetZMPDiscretization(std::deque<ZMPPosition> & ZMPPositions,
-				      std::deque<COMState> & COMStates,
+    virtual void GetZMPDiscretization(RingBuffer<ZMPPosition> & ZMPPositions,
+				      RingBuffer<COMState> & COMStates,
 				      std::deque<RelativeFootPosition> &RelativeFootPositions,
-				      std::deque<FootAbsolutePosition> &LeftFootAbsolutePositions,
-				      std::deque<FootAbsolutePosition> &RightFootAbsolutePositions,
+				      RingBuffer<FootAbsolutePosition> &LeftFootAbsolutePositions,
+				      RingBuffer<FootAbsolutePosition> &RightFootAbsolutePositions,
 				      double Xmax,
 				      COMState & lStartingCOMState,
 				      Eigen::Vector3d & lStartingZMPPosition,
@@ -235,10 +245,10 @@ namespace PatternGeneratorJRL
       @param[in] lStartingCOMState: The initial position of the CoM given as a 3D vector.
       @param[in] lStartingZMPPosition: The initial position of the ZMP given as a 3D vector.
     */
-    virtual std::size_t InitOnLine(std::deque<ZMPPosition> & ZMPPositions,
-				   std::deque<COMState> & COMStates,
-				   std::deque<FootAbsolutePosition> & FinalLeftFootAbsolutePositions,
-				   std::deque<FootAbsolutePosition> & FinalRightFootAbsolutePositions,
+    virtual std::size_t InitOnLine(RingBuffer<ZMPPosition> & ZMPPositions,
+				   RingBuffer<COMState> & COMStates,
+				   RingBuffer<FootAbsolutePosition> & FinalLeftFootAbsolutePositions,
+				   RingBuffer<FootAbsolutePosition> & FinalRightFootAbsolutePositions,
 				   FootAbsolutePosition & InitLeftFootAbsolutePosition,
 				   FootAbsolutePosition & InitRightFootAbsolutePosition,
 				   std::deque<RelativeFootPosition> &RelativeFootPositions,
@@ -260,10 +270,10 @@ namespace PatternGeneratorJRL
        obtained from the new foot trajectories.
      */
     virtual void OnLineAddFoot(RelativeFootPosition & NewRelativeFootPosition,
-			       std::deque<ZMPPosition> & FinalZMPPositions,
-			       std::deque<COMState> & COMStates,
-			       std::deque<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
-			       std::deque<FootAbsolutePosition> &FinalRightFootAbsolutePositions,
+			       RingBuffer<ZMPPosition> & FinalZMPPositions,
+			       RingBuffer<COMState> & COMStates,
+			       RingBuffer<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
+			       RingBuffer<FootAbsolutePosition> &FinalRightFootAbsolutePositions,
 			       bool EndSequence) = 0;
 
     /* ! \brief Method to change to update on line the queues necessary of the system.
@@ -280,10 +290,10 @@ namespace PatternGeneratorJRL
        @return If the method failed it returns -1, 0 otherwise.
      */
     virtual void OnLine(double time,
-		       std::deque<ZMPPosition> & FinalZMPPositions,
-		       std::deque<COMState> & COMStates,
-		       std::deque<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
-		       std::deque<FootAbsolutePosition> &FinalRightFootAbsolutePositions)=0;
+		       RingBuffer<ZMPPosition> & FinalZMPPositions,
+		       RingBuffer<COMState> & COMStates,
+		       RingBuffer<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
+		       RingBuffer<FootAbsolutePosition> &FinalRightFootAbsolutePositions)=0;
 
     /*! \brief Method to stop walking.
       @param[out] ZMPPositions: The queue of ZMP reference positions.
@@ -291,10 +301,10 @@ namespace PatternGeneratorJRL
       @param[out] LeftFootAbsolutePositions: The queue of left foot absolute positions.
       @param[out] RightFootAbsolutePositions: The queue of right foot absolute positions.
      */
-    virtual void EndPhaseOfTheWalking(std::deque<ZMPPosition> &ZMPPositions,
-				      std::deque<COMState> &FinalCOMStates,
-				      std::deque<FootAbsolutePosition> &LeftFootAbsolutePositions,
-				      std::deque<FootAbsolutePosition> &RightFootAbsolutePositions)=0;
+    virtual void EndPhaseOfTheWalking(RingBuffer<ZMPPosition> &ZMPPositions,
+				      RingBuffer<COMState> &FinalCOMStates,
+				      RingBuffer<FootAbsolutePosition> &LeftFootAbsolutePositions,
+				      RingBuffer<FootAbsolutePosition> &RightFootAbsolutePositions)=0;
 
 
     /* ! \brief Method to change on line the landing position of a foot.
@@ -312,10 +322,10 @@ namespace PatternGeneratorJRL
      */
     virtual int OnLineFootChange(double time,
 				 FootAbsolutePosition &aFootAbsolutePosition,
-				 std::deque<ZMPPosition> & FinalZMPPositions,
-				 std::deque<COMState> & COMStates,
-				 std::deque<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
-				 std::deque<FootAbsolutePosition> &FinalRightFootAbsolutePositions,
+				 RingBuffer<ZMPPosition> & FinalZMPPositions,
+				 RingBuffer<COMState> & COMStates,
+				 RingBuffer<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
+				 RingBuffer<FootAbsolutePosition> &FinalRightFootAbsolutePositions,
 				 StepStackHandler * aStepStackHandler)=0;
 
 
@@ -351,6 +361,27 @@ namespace PatternGeneratorJRL
     bool GetOnLineMode();
     /*! @}  */
 
+    /*! \name Methods to capture and restore the state of the generator.
+      The generators which do not overload them do not support snapshots.
+      @{
+     */
+    /*! \brief Allocate an object able to store the state of the generator.
+      Returns 0 if snapshots are not supported. The object is meant to be
+      reused: once its buffers are sized, SaveState() does not allocate. */
+    virtual ZMPRefTrajectoryGenerationState * CreateState() const
+    { return 0; }
+
+    /*! \brief Copy the state of the generator into aState, which has been
+      created by CreateState(). Returns false if the state can not be
+      captured at this time. */
+    virtual bool SaveState(ZMPRefTrajectoryGenerationState & ) const
+    { return false; }
+
+    /*! \brief Put the generator back in the state stored in aState. */
+    virtual void RestoreState(const ZMPRefTrajectoryGenerationState & )
+    { }
+    /*! @}  */
+
 
 
   };
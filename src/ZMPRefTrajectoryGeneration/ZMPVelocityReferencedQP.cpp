@@ -72,8 +72,8 @@ ZMPVelocityReferencedQP::ZMPVelocityReferencedQP(SimplePluginManager *SPM,
                                                  string , PinocchioRobot *aPR ) :
 ZMPRefTrajectoryGeneration(SPM),
 Robot_(0),SupportFSM_(0),OrientPrw_(0),OrientPrw_DF_(0),
-VRQPGenerator_(0),IntermedData_(0),RFI_(0),Problem_(),
-Solution_(),OFTG_DF_(0),OFTG_control_(0),dynamicFilter_(0)
+VRQPGenerator_(0),IntermedData_(0),RFI_(0),Problem_(),Solver_(QLD),
+StageProblem_(),UseRiccati_(false),Solution_(),OFTG_DF_(0),OFTG_control_(0),dynamicFilter_(0)
 {
   // Save the reference to HDR
   PR_ = aPR ;
@@ -194,12 +194,14 @@ Solution_(),OFTG_DF_(0),OFTG_control_(0),dynamicFilter_(0)
   dynamicFilter_ = new DynamicFilter(SPM,PR_);
 
   // Register method to handle
-  const unsigned int NbMethods = 4;
+  const unsigned int NbMethods = 6;
   const char *lMethodNames[NbMethods] =
   {":previewcontroltime",
    ":numberstepsbeforestop",
    ":stoppg",
-   ":setfeetconstraint"};
+   ":setfeetconstraint",
+   ":qpsolver",
+   ":hessiancache"};
   RESETDEBUG5("PgDebug2.txt");
   ODEBUG5("Before registering methods for ZMPVelocityReferencedQP","PgDebug2.txt");
   for(unsigned int i=0;i<NbMethods;i++)
@@ -335,16 +337,59 @@ void ZMPVelocityReferencedQP::CallMethod(std::string & Method, std::istringstrea
   {
    RFI_->CallMethod(Method,strm);
   }
+  if (Method==":qpsolver")
+  {
+    std::string aSolverName;
+    strm >> aSolverName;
+    UseRiccati_ = false;
+    if (aSolverName=="qld")
+      Solver_ = QLD;
+    else if (aSolverName=="activeset")
+      Solver_ = ACTIVE_SET;
+    else if (aSolverName=="race")
+    {
+      Solver_ = RACE;
+      // The threads are not created in the control loop.
+      Problem_.race().start();
+    }
+    else if (aSolverName=="riccati")
+      UseRiccati_ = true;
+    else
+      std::cerr << "Unknown QP solver " << aSolverName << std::endl;
+  }
+  if (Method==":hessiancache")
+  {
+    // :hessiancache load|save FileName, or :hessiancache clear
+    std::string anAction, aFileName;
+    strm >> anAction;
+    HessianCache & aCache = VRQPGenerator_->Hessians();
+    if (anAction=="clear")
+      aCache.clear();
+    else if (anAction=="load")
+    {
+      strm >> aFileName;
+      if (aCache.load(aFileName)<0)
+        std::cerr << "Unable to load the Hessians from " << aFileName << std::endl;
+    }
+    else if (anAction=="save")
+    {
+      strm >> aFileName;
+      if (aCache.save(aFileName)<0)
+        std::cerr << "Unable to save the Hessians to " << aFileName << std::endl;
+    }
+    else
+      std::cerr << "Unknown action " << anAction << " for :hessiancache" << std::endl;
+  }
   ZMPRefTrajectoryGeneration::CallMethod(Method,strm);
 }
 
 std::size_t
 ZMPVelocityReferencedQP::
 InitOnLine
-(deque<ZMPPosition> & FinalZMPTraj_deq,
- deque<COMState> & FinalCoMPositions_deq,
- deque<FootAbsolutePosition> & FinalLeftFootTraj_deq,
- deque<FootAbsolutePosition> & FinalRightFootTraj_deq,
+(RingBuffer<ZMPPosition> & FinalZMPTraj_deq,
+ RingBuffer<COMState> & FinalCoMPositions_deq,
+ RingBuffer<FootAbsolutePosition> & FinalLeftFootTraj_deq,
+ RingBuffer<FootAbsolutePosition> & FinalRightFootTraj_deq,
  FootAbsolutePosition & InitLeftFootAbsolutePosition,
  FootAbsolutePosition & InitRightFootAbsolutePosition,
  deque<RelativeFootPosition> &, // RelativeFootPositions,
@@ -472,10 +517,10 @@ InitOnLine
 
 
 void ZMPVelocityReferencedQP::OnLine(double time,
-                                    deque<ZMPPosition> & FinalZMPTraj_deq,
-                                    deque<COMState> & FinalCOMTraj_deq,
-                                    deque<FootAbsolutePosition> & FinalLeftFootTraj_deq,
-                                    deque<FootAbsolutePosition> & FinalRightFootTraj_deq)
+                                    RingBuffer<ZMPPosition> & FinalZMPTraj_deq,
+                                    RingBuffer<COMState> & FinalCOMTraj_deq,
+                                    RingBuffer<FootAbsolutePosition> & FinalLeftFootTraj_deq,
+                                    RingBuffer<FootAbsolutePosition> & FinalRightFootTraj_deq)
 
 {
   // If on-line mode not activated we go out.
@@ -496,6 +541,9 @@ void ZMPVelocityReferencedQP::OnLine(double time,
   if(time + 0.00001 > UpperTimeLimitToUpdate_)
   {
 
+    LatencyProfile * aProfile = getSimplePluginManager()->GetLatencyProfile();
+    unsigned long long lBuildBegin = aProfile->Begin();
+
     // UPDATE INTERNAL DATA:
     // ---------------------
     Problem_.reset_variant();
@@ -531,22 +579,42 @@ void ZMPVelocityReferencedQP::OnLine(double time,
     VRQPGenerator_->compute_global_reference( Solution_ );
 
 
-    // BUILD VARIANT PART OF THE OBJECTIVE:
-    // ------------------------------------
-    VRQPGenerator_->update_problem( Problem_, Solution_.SupportStates_deq );
+    if (UseRiccati_)
+    {
+      // BUILD AND SOLVE THE STAGE-WISE PROBLEM:
+      // ---------------------------------------
+      VRQPGenerator_->build_stage_problem( StageProblem_, Solution_ );
+      aProfile->End(STAGE_QP_BUILD,lBuildBegin);
+      {
+        ScopedLatency aSolveLatency(aProfile,STAGE_QP_SOLVE);
+        Solution_.Fail = StageProblem_.solve();
+      }
+      VRQPGenerator_->stage_solution( StageProblem_, Solution_ );
+    }
+    else
+    {
+      // BUILD VARIANT PART OF THE OBJECTIVE:
+      // ------------------------------------
+      VRQPGenerator_->update_problem( Problem_, Solution_.SupportStates_deq );
 
 
-    // BUILD CONSTRAINTS:
-    // ------------------
-    VRQPGenerator_->build_constraints( Problem_, Solution_ );
+      // BUILD CONSTRAINTS:
+      // ------------------
+      VRQPGenerator_->build_constraints( Problem_, Solution_ );
+      aProfile->End(STAGE_QP_BUILD,lBuildBegin);
 
 
-    // SOLVE PROBLEM:
-    // --------------
-    Problem_.solve( QLD, Solution_, NONE );
-    if(Solution_.Fail>0)
-    {
-      Problem_.dump( time );
+      // SOLVE PROBLEM:
+      // --------------
+      {
+        ScopedLatency aSolveLatency(aProfile,STAGE_QP_SOLVE);
+        Problem_.Time( time );
+        Problem_.solve( Solver_, Solution_, NONE );
+      }
+      if(Solution_.Fail>0)
+      {
+        Problem_.dump( time );
+      }
     }
     VRQPGenerator_->LastFootSol(Solution_);
     //OrientPrw_->
@@ -566,12 +634,14 @@ void ZMPVelocityReferencedQP::OnLine(double time,
     InterpretSolutionVector();
 
     // INTERPOLATION
+    unsigned long long lInterpolationBegin = aProfile->Begin();
     FinalZMPTraj_deq.resize( NbSampleControl_ + CurrentIndex_ );
     FinalCOMTraj_deq.resize( NbSampleControl_ + CurrentIndex_ );
     ControlInterpolation( FinalCOMTraj_deq, FinalZMPTraj_deq, FinalLeftFootTraj_deq,
                           FinalRightFootTraj_deq, time) ;
 
     DynamicFilterInterpolation(time);
+    aProfile->End(STAGE_FOOT_TRAJECTORY,lInterpolationBegin);
 
     unsigned int IndexMax = (int)round((previewDuration_+QP_T_)  / InterpolationPeriod_ );
     ZMPTraj_deq_.resize(IndexMax);
@@ -591,10 +661,13 @@ void ZMPVelocityReferencedQP::OnLine(double time,
     }
 
 
-    dynamicFilter_->OnLinefilter(COMTraj_deq_,ZMPTraj_deq_ctrl_,
-                                 LeftFootTraj_deq_,
-                                 RightFootTraj_deq_,
-                                 deltaCOMTraj_deq_);
+    {
+      ScopedLatency aFilterLatency(aProfile,STAGE_DYNAMIC_FILTER);
+      dynamicFilter_->OnLinefilter(COMTraj_deq_,ZMPTraj_deq_ctrl_,
+                                   LeftFootTraj_deq_,
+                                   RightFootTraj_deq_,
+                                   deltaCOMTraj_deq_);
+    }
 //#define DEBUG
 #ifdef DEBUG
     dynamicFilter_->Debug(COMTraj_deq_ctrl_,
@@ -640,11 +713,136 @@ void ZMPVelocityReferencedQP::OnLine(double time,
   //----------"Real-time" loop---------
 }
 
+namespace PatternGeneratorJRL
+{
+  /// \brief Part of ZMPVelocityReferencedQP which evolves while walking.
+  struct ZMPVelocityReferencedQPState : public ZMPRefTrajectoryGenerationState
+  {
+    double CurrentTime ;
+    bool OnLineMode ;
+    reference_t VelRef, NewVelRef ;
+    bool PerturbationOccured, EndingPhase, Running ;
+    double TimeToStopOnLineMode, UpperTimeLimitToUpdate ;
+    Eigen::VectorXd PerturbationAcceleration ;
+    LinearizedInvertedPendulum2D LIPM, LIPM_subsampled, CoM ;
+    IntermedQPMat::state_variant_t IntermedState ;
+    orientations_preview_state_t OrientPrw, OrientPrw_DF ;
+    solution_t Solution, solution ;
+    RingBuffer<COMState> deltaCOMTraj_deq ;
+    RingBuffer<ZMPPosition> ZMPTraj_deq, ZMPTraj_deq_ctrl ;
+    RingBuffer<COMState> COMTraj_deq, COMTraj_deq_ctrl ;
+    RingBuffer<FootAbsolutePosition> LeftFootTraj_deq, RightFootTraj_deq ;
+    RingBuffer<FootAbsolutePosition> LeftFootTraj_deq_ctrl,
+      RightFootTraj_deq_ctrl ;
+    vector< vector<double> > FootPrw_vec ;
+    unsigned CurrentIndex ;
+    COMState InitStateLIPM, InitStateOrientPrw ;
+    COMState FinalCurrentStateOrientPrw, FinalPreviewStateOrientPrw ;
+    online_foot_trajectory_state_t OFTG_DF, OFTG_control ;
+    dynamic_filter_state_t DynamicFilter ;
+    double LastFootSolX, LastFootSolY ;
+  };
+}
+
+ZMPRefTrajectoryGenerationState * ZMPVelocityReferencedQP::CreateState() const
+{
+  return new ZMPVelocityReferencedQPState();
+}
+
+bool ZMPVelocityReferencedQP::SaveState(ZMPRefTrajectoryGenerationState & aState) const
+{
+  ZMPVelocityReferencedQPState & lState =
+      static_cast<ZMPVelocityReferencedQPState &>(aState);
+
+  lState.CurrentTime = m_CurrentTime ;
+  lState.OnLineMode = m_OnLineMode ;
+  lState.VelRef = VelRef_ ;
+  lState.NewVelRef = NewVelRef_ ;
+  lState.PerturbationOccured = PerturbationOccured_ ;
+  lState.EndingPhase = EndingPhase_ ;
+  lState.Running = Running_ ;
+  lState.TimeToStopOnLineMode = TimeToStopOnLineMode_ ;
+  lState.UpperTimeLimitToUpdate = UpperTimeLimitToUpdate_ ;
+  lState.PerturbationAcceleration = PerturbationAcceleration_ ;
+  lState.LIPM = LIPM_ ;
+  lState.LIPM_subsampled = LIPM_subsampled_ ;
+  lState.CoM = CoM_ ;
+  lState.IntermedState = IntermedData_->State() ;
+  OrientPrw_->getState(lState.OrientPrw) ;
+  OrientPrw_DF_->getState(lState.OrientPrw_DF) ;
+  lState.Solution = Solution_ ;
+  lState.solution = solution_ ;
+  lState.deltaCOMTraj_deq = deltaCOMTraj_deq_ ;
+  lState.ZMPTraj_deq = ZMPTraj_deq_ ;
+  lState.COMTraj_deq = COMTraj_deq_ ;
+  lState.LeftFootTraj_deq = LeftFootTraj_deq_ ;
+  lState.RightFootTraj_deq = RightFootTraj_deq_ ;
+  lState.ZMPTraj_deq_ctrl = ZMPTraj_deq_ctrl_ ;
+  lState.COMTraj_deq_ctrl = COMTraj_deq_ctrl_ ;
+  lState.LeftFootTraj_deq_ctrl = LeftFootTraj_deq_ctrl_ ;
+  lState.RightFootTraj_deq_ctrl = RightFootTraj_deq_ctrl_ ;
+  lState.FootPrw_vec = FootPrw_vec ;
+  lState.CurrentIndex = CurrentIndex_ ;
+  lState.InitStateLIPM = InitStateLIPM_ ;
+  lState.InitStateOrientPrw = InitStateOrientPrw_ ;
+  lState.FinalCurrentStateOrientPrw = FinalCurrentStateOrientPrw_ ;
+  lState.FinalPreviewStateOrientPrw = FinalPreviewStateOrientPrw_ ;
+  OFTG_DF_->getState(lState.OFTG_DF) ;
+  OFTG_control_->getState(lState.OFTG_control) ;
+  dynamicFilter_->getState(lState.DynamicFilter) ;
+  VRQPGenerator_->LastFootSol(lState.LastFootSolX, lState.LastFootSolY) ;
+  return true;
+}
+
+void ZMPVelocityReferencedQP::RestoreState(const ZMPRefTrajectoryGenerationState & aState)
+{
+  const ZMPVelocityReferencedQPState & lState =
+      static_cast<const ZMPVelocityReferencedQPState &>(aState);
+
+  m_CurrentTime = lState.CurrentTime ;
+  m_OnLineMode = lState.OnLineMode ;
+  VelRef_ = lState.VelRef ;
+  NewVelRef_ = lState.NewVelRef ;
+  PerturbationOccured_ = lState.PerturbationOccured ;
+  EndingPhase_ = lState.EndingPhase ;
+  Running_ = lState.Running ;
+  TimeToStopOnLineMode_ = lState.TimeToStopOnLineMode ;
+  UpperTimeLimitToUpdate_ = lState.UpperTimeLimitToUpdate ;
+  PerturbationAcceleration_ = lState.PerturbationAcceleration ;
+  LIPM_ = lState.LIPM ;
+  LIPM_subsampled_ = lState.LIPM_subsampled ;
+  CoM_ = lState.CoM ;
+  IntermedData_->State() = lState.IntermedState ;
+  OrientPrw_->setState(lState.OrientPrw) ;
+  OrientPrw_DF_->setState(lState.OrientPrw_DF) ;
+  Solution_ = lState.Solution ;
+  solution_ = lState.solution ;
+  deltaCOMTraj_deq_ = lState.deltaCOMTraj_deq ;
+  ZMPTraj_deq_ = lState.ZMPTraj_deq ;
+  COMTraj_deq_ = lState.COMTraj_deq ;
+  LeftFootTraj_deq_ = lState.LeftFootTraj_deq ;
+  RightFootTraj_deq_ = lState.RightFootTraj_deq ;
+  ZMPTraj_deq_ctrl_ = lState.ZMPTraj_deq_ctrl ;
+  COMTraj_deq_ctrl_ = lState.COMTraj_deq_ctrl ;
+  LeftFootTraj_deq_ctrl_ = lState.LeftFootTraj_deq_ctrl ;
+  RightFootTraj_deq_ctrl_ = lState.RightFootTraj_deq_ctrl ;
+  FootPrw_vec = lState.FootPrw_vec ;
+  CurrentIndex_ = lState.CurrentIndex ;
+  InitStateLIPM_ = lState.InitStateLIPM ;
+  InitStateOrientPrw_ = lState.InitStateOrientPrw ;
+  FinalCurrentStateOrientPrw_ = lState.FinalCurrentStateOrientPrw ;
+  FinalPreviewStateOrientPrw_ = lState.FinalPreviewStateOrientPrw ;
+  OFTG_DF_->setState(lState.OFTG_DF) ;
+  OFTG_control_->setState(lState.OFTG_control) ;
+  dynamicFilter_->setState(lState.DynamicFilter) ;
+  VRQPGenerator_->LastFootSol(lState.LastFootSolX, lState.LastFootSolY) ;
+}
+
 void ZMPVelocityReferencedQP::ControlInterpolation(
-    std::deque<COMState> & FinalCOMTraj_deq,                      // OUTPUT
-    std::deque<ZMPPosition> & FinalZMPTraj_deq,                   // OUTPUT
-    std::deque<FootAbsolutePosition> & FinalLeftFootTraj_deq,     // OUTPUT
-    std::deque<FootAbsolutePosition> & FinalRightFootTraj_deq,    // OUTPUT
+    RingBuffer<COMState> & FinalCOMTraj_deq,                      // OUTPUT
+    RingBuffer<ZMPPosition> & FinalZMPTraj_deq,                   // OUTPUT
+    RingBuffer<FootAbsolutePosition> & FinalLeftFootTraj_deq,     // OUTPUT
+    RingBuffer<FootAbsolutePosition> & FinalRightFootTraj_deq,    // OUTPUT
     double time)                                                  // INPUT
 {
   InitStateLIPM_ = LIPM_.GetState() ;
@@ -713,10 +911,10 @@ void ZMPVelocityReferencedQP::DynamicFilterInterpolation(double time)
 }
 
 void ZMPVelocityReferencedQP::CoMZMPInterpolation(
-    std::deque<ZMPPosition> & ZMPPositions,                    // OUTPUT
-    std::deque<COMState> & COMTraj_deq ,                       // OUTPUT
-    const std::deque<FootAbsolutePosition> & LeftFootTraj_deq, // INPUT
-    const std::deque<FootAbsolutePosition> & RightFootTraj_deq,// INPUT
+    RingBuffer<ZMPPosition> & ZMPPositions,                    // OUTPUT
+    RingBuffer<COMState> & COMTraj_deq ,                       // OUTPUT
+    const RingBuffer<FootAbsolutePosition> & LeftFootTraj_deq, // INPUT
+    const RingBuffer<FootAbsolutePosition> & RightFootTraj_deq,// INPUT
     const solution_t * aSolutionReference,                     // INPUT
     LinearizedInvertedPendulum2D * LIPM,                       // INPUT/OUTPUT
     const unsigned numberOfSample,                             // INPUT
@@ -755,12 +953,14 @@ void ZMPVelocityReferencedQP::InterpretSolutionVector()
     Vx = 0.2 ;
   if (Vy > 0.2 /*ms*/)
     Vy = 0.2 ;
-  std::deque<support_state_t> & SupportStates = solution_.SupportStates_deq ;
+  RingBuffer<support_state_t> & SupportStates = solution_.SupportStates_deq ;
   support_state_t & LastSupport = solution_.SupportStates_deq.back() ;
   support_state_t & FirstSupport = solution_.SupportStates_deq[1] ;
   support_state_t & CurrentSupport = solution_.SupportStates_deq.front() ;
   int nbSteps = LastSupport.StepNumber ;
-  FootPrw_vec.resize( nbSteps+2 , vector<double>(2,0.0) );
+  // The rows only grow: they are kept between two cycles.
+  if ( FootPrw_vec.size() < (unsigned int)nbSteps+2 )
+    FootPrw_vec.resize( nbSteps+2 , vector<double>(2,0.0) );
 
   // complete the previewed feet position
   FootPrw_vec[0][0] = FirstSupport.X ;
@@ -773,7 +973,7 @@ void ZMPVelocityReferencedQP::InterpretSolutionVector()
 
   // compute an additional previewed foot position
   {
-    int size_vec_sol = (int) FootPrw_vec.size();
+    int size_vec_sol = nbSteps+2;
 
     if ( nbSteps > 0 ){
       // center of the feet of the last preview double support phase :
@@ -817,11 +1017,11 @@ void ZMPVelocityReferencedQP::PrepareSolution()
 }
 
 // TODO: New parent class needed
-void ZMPVelocityReferencedQP::GetZMPDiscretization(deque<ZMPPosition> & ,
-                                                   deque<COMState> & ,
+void ZMPVelocityReferencedQP::GetZMPDiscretization(RingBuffer<ZMPPosition> & ,
+                                                   RingBuffer<COMState> & ,
                                                    deque<RelativeFootPosition> &,
-                                                   deque<FootAbsolutePosition> &,
-                                                   deque<FootAbsolutePosition> &,
+                                                   RingBuffer<FootAbsolutePosition> &,
+                                                   RingBuffer<FootAbsolutePosition> &,
                                                    double ,
                                                    COMState &,
                                                    Eigen::Vector3d &,
@@ -833,10 +1033,10 @@ void ZMPVelocityReferencedQP::GetZMPDiscretization(deque<ZMPPosition> & ,
 
 
 void ZMPVelocityReferencedQP::OnLineAddFoot(RelativeFootPosition & ,
-                                            deque<ZMPPosition> & ,
-                                            deque<COMState> & ,
-                                            deque<FootAbsolutePosition> &,
-                                            deque<FootAbsolutePosition> &,
+                                            RingBuffer<ZMPPosition> & ,
+                                            RingBuffer<COMState> & ,
+                                            RingBuffer<FootAbsolutePosition> &,
+                                            RingBuffer<FootAbsolutePosition> &,
                                             bool)
 {
   cout << "To be removed" << endl;
@@ -844,20 +1044,20 @@ void ZMPVelocityReferencedQP::OnLineAddFoot(RelativeFootPosition & ,
 
 int ZMPVelocityReferencedQP::OnLineFootChange(double ,
                                               FootAbsolutePosition &,
-                                              deque<ZMPPosition> & ,
-                                              deque<COMState> & ,
-                                              deque<FootAbsolutePosition> &,
-                                              deque<FootAbsolutePosition> &,
+                                              RingBuffer<ZMPPosition> & ,
+                                              RingBuffer<COMState> & ,
+                                              RingBuffer<FootAbsolutePosition> &,
+                                              RingBuffer<FootAbsolutePosition> &,
                                               StepStackHandler  *)
 {
   cout << "To be removed" << endl;
   return -1;
 }
 
-void ZMPVelocityReferencedQP::EndPhaseOfTheWalking(deque<ZMPPosition> &,
-                                                   deque<COMState> &,
-                                                   deque<FootAbsolutePosition> &,
-                                                   deque<FootAbsolutePosition> &)
+void ZMPVelocityReferencedQP::EndPhaseOfTheWalking(RingBuffer<ZMPPosition> &,
+                                                   RingBuffer<COMState> &,
+                                                   RingBuffer<FootAbsolutePosition> &,
+                                                   RingBuffer<FootAbsolutePosition> &)
 {
   cout << "To be removed" << endl;
 }
@@ -79,10 +79,10 @@ namespace PatternGeneratorJRL
       Returns the number of steps which has been completely put inside
       the queue of ZMP, and foot positions.
     */
-    std::size_t InitOnLine(deque<ZMPPosition> & FinalZMPPositions,
-			   deque<COMState> & FinalCoMPositions_deq,
-			   deque<FootAbsolutePosition> & FinalLeftFootTraj_deq,
-			   deque<FootAbsolutePosition> & FinalRightFootTraj_deq,
+    std::size_t InitOnLine(RingBuffer<ZMPPosition> & FinalZMPPositions,
+			   RingBuffer<COMState> & FinalCoMPositions_deq,
+			   RingBuffer<FootAbsolutePosition> & FinalLeftFootTraj_deq,
+			   RingBuffer<FootAbsolutePosition> & FinalRightFootTraj_deq,
 			   FootAbsolutePosition & InitLeftFootAbsolutePosition,
 			   FootAbsolutePosition & InitRightFootAbsolutePosition,
 			   deque<RelativeFootPosition> &RelativeFootPositions,
@@ -92,11 +92,17 @@ namespace PatternGeneratorJRL
 
     /// \brief Update the stacks on-line
     void OnLine(double time,
-                deque<ZMPPosition> & FinalZMPPositions,
-                deque<COMState> & FinalCOMTraj_deq,
-                deque<FootAbsolutePosition> &FinalLeftFootTraj_deq,
-                deque<FootAbsolutePosition> &FinalRightFootTraj_deq);
+                RingBuffer<ZMPPosition> & FinalZMPPositions,
+                RingBuffer<COMState> & FinalCOMTraj_deq,
+                RingBuffer<FootAbsolutePosition> &FinalLeftFootTraj_deq,
+                RingBuffer<FootAbsolutePosition> &FinalRightFootTraj_deq);
 
+    /// \name Snapshot of the state (see ZMPRefTrajectoryGeneration)
+    /// \{
+    ZMPRefTrajectoryGenerationState * CreateState() const;
+    bool SaveState(ZMPRefTrajectoryGenerationState & aState) const;
+    void RestoreState(const ZMPRefTrajectoryGenerationState & aState);
+    /// \}
 
     /// \name Accessors and mutators
     /// \{
@@ -214,6 +220,13 @@ namespace PatternGeneratorJRL
     /// \brief Final optimization problem
     QPProblem Problem_;
 
+    /// \brief Solver of the final problem (:qpsolver qld|activeset|race)
+    solver_e Solver_;
+
+    /// \brief Stage-wise form of the problem (:qpsolver riccati)
+    RiccatiQP StageProblem_;
+    bool UseRiccati_;
+
     /// \brief Previewed Solution
     solution_t Solution_;
 
@@ -224,17 +237,17 @@ namespace PatternGeneratorJRL
     PinocchioRobot * PR_ ;
 
     /// \brief Buffers for the Kajita's dynamic filter
-    deque<COMState> deltaCOMTraj_deq_ ;
+    RingBuffer<COMState> deltaCOMTraj_deq_ ;
 
-    deque<ZMPPosition> ZMPTraj_deq_ ;
-    deque<COMState> COMTraj_deq_ ;
-    deque<FootAbsolutePosition> LeftFootTraj_deq_ ;
-    deque<FootAbsolutePosition> RightFootTraj_deq_ ;
+    RingBuffer<ZMPPosition> ZMPTraj_deq_ ;
+    RingBuffer<COMState> COMTraj_deq_ ;
+    RingBuffer<FootAbsolutePosition> LeftFootTraj_deq_ ;
+    RingBuffer<FootAbsolutePosition> RightFootTraj_deq_ ;
 
-    deque<ZMPPosition> ZMPTraj_deq_ctrl_ ;
-    deque<COMState> COMTraj_deq_ctrl_ ;
-    deque<FootAbsolutePosition> LeftFootTraj_deq_ctrl_ ;
-    deque<FootAbsolutePosition> RightFootTraj_deq_ctrl_ ;
+    RingBuffer<ZMPPosition> ZMPTraj_deq_ctrl_ ;
+    RingBuffer<COMState> COMTraj_deq_ctrl_ ;
+    RingBuffer<FootAbsolutePosition> LeftFootTraj_deq_ctrl_ ;
+    RingBuffer<FootAbsolutePosition> RightFootTraj_deq_ctrl_ ;
 
     /// \brief used to predict the next step using the current solution
     /// allow the computation of the complete preview
@@ -283,11 +296,11 @@ namespace PatternGeneratorJRL
 
   public:
 
-    void GetZMPDiscretization(std::deque<ZMPPosition> & ZMPPositions,
-                              std::deque<COMState> & COMStates,
+    void GetZMPDiscretization(RingBuffer<ZMPPosition> & ZMPPositions,
+                              RingBuffer<COMState> & COMStates,
                               std::deque<RelativeFootPosition> &RelativeFootPositions,
-                              std::deque<FootAbsolutePosition> &LeftFootAbsolutePositions,
-                              std::deque<FootAbsolutePosition> &RightFootAbsolutePositions,
+                              RingBuffer<FootAbsolutePosition> &LeftFootAbsolutePositions,
+                              RingBuffer<FootAbsolutePosition> &RightFootAbsolutePositions,
                               double Xmax,
                               COMState & lStartingCOMState,
                               Eigen::Vector3d & lStartingZMPPosition,
@@ -295,33 +308,33 @@ namespace PatternGeneratorJRL
                               FootAbsolutePosition & InitRightFootAbsolutePosition);
 
     void OnLineAddFoot(RelativeFootPosition & NewRelativeFootPosition,
-                       std::deque<ZMPPosition> & FinalZMPPositions,
-                       std::deque<COMState> & COMStates,
-                       std::deque<FootAbsolutePosition> & FinalLeftFootTraj_deq,
-                       std::deque<FootAbsolutePosition> & FinalRightFootTraj_deq,
+                       RingBuffer<ZMPPosition> & FinalZMPPositions,
+                       RingBuffer<COMState> & COMStates,
+                       RingBuffer<FootAbsolutePosition> & FinalLeftFootTraj_deq,
+                       RingBuffer<FootAbsolutePosition> & FinalRightFootTraj_deq,
                        bool EndSequence);
 
     int OnLineFootChange(double time,
                          FootAbsolutePosition & aFootAbsolutePosition,
-                         deque<ZMPPosition> & FinalZMPPositions,
-                         deque<COMState> & CoMPositions,
-                         deque<FootAbsolutePosition> & FinalLeftFootTraj_deq,
-                         deque<FootAbsolutePosition> & FinalRightFootTraj_deq,
+                         RingBuffer<ZMPPosition> & FinalZMPPositions,
+                         RingBuffer<COMState> & CoMPositions,
+                         RingBuffer<FootAbsolutePosition> & FinalLeftFootTraj_deq,
+                         RingBuffer<FootAbsolutePosition> & FinalRightFootTraj_deq,
                          StepStackHandler * aStepStackHandler);
 
-    void EndPhaseOfTheWalking(deque<ZMPPosition> & ZMPPositions,
-                              deque<COMState> & FinalCOMTraj_deq,
-                              deque<FootAbsolutePosition> & LeftFootAbsolutePositions,
-                              deque<FootAbsolutePosition> & RightFootAbsolutePositions);
+    void EndPhaseOfTheWalking(RingBuffer<ZMPPosition> & ZMPPositions,
+                              RingBuffer<COMState> & FinalCOMTraj_deq,
+                              RingBuffer<FootAbsolutePosition> & LeftFootAbsolutePositions,
+                              RingBuffer<FootAbsolutePosition> & RightFootAbsolutePositions);
 
     int ReturnOptimalTimeToRegenerateAStep();
 
     /// \brief Interpolation form the com jerk the position of the com and the zmp corresponding to the kart table model
     void CoMZMPInterpolation(
-        std::deque<ZMPPosition> & ZMPPositions,                    	 // OUTPUT
-        std::deque<COMState> & COMTraj_deq ,                       	 // OUTPUT
-        const std::deque<FootAbsolutePosition> & LeftFootTraj_deq, 	// INPUT
-        const std::deque<FootAbsolutePosition> & RightFootTraj_deq,	// INPUT
+        RingBuffer<ZMPPosition> & ZMPPositions,                    	 // OUTPUT
+        RingBuffer<COMState> & COMTraj_deq ,                       	 // OUTPUT
+        const RingBuffer<FootAbsolutePosition> & LeftFootTraj_deq, 	// INPUT
+        const RingBuffer<FootAbsolutePosition> & RightFootTraj_deq,	// INPUT
         const solution_t * Solution,                               	// INPUT
         LinearizedInvertedPendulum2D * LIPM,                       	 // INPUT/OUTPUT
         const unsigned numberOfSample,                             	// INPUT
@@ -330,10 +343,10 @@ namespace PatternGeneratorJRL
 
     /// \brief Interpolate just enough data to pilot the robot (period of interpolation = QP_T_)
     void ControlInterpolation(
-        std::deque<COMState> & FinalCOMTraj_deq,                      // OUTPUT
-        std::deque<ZMPPosition> & FinalZMPTraj_deq,                   // OUTPUT
-        std::deque<FootAbsolutePosition> & FinalLeftFootTraj_deq,     // OUTPUT
-        std::deque<FootAbsolutePosition> & FinalRightFootTraj_deq,    // OUTPUT
+        RingBuffer<COMState> & FinalCOMTraj_deq,                      // OUTPUT
+        RingBuffer<ZMPPosition> & FinalZMPTraj_deq,                   // OUTPUT
+        RingBuffer<FootAbsolutePosition> & FinalLeftFootTraj_deq,     // OUTPUT
+        RingBuffer<FootAbsolutePosition> & FinalRightFootTraj_deq,    // OUTPUT
         double time);                                          			// INPUT
 
     /// \brief Interpolation everything on the whole preview
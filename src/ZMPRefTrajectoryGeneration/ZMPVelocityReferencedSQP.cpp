@@ -103,11 +103,17 @@ ZMPRefTrajectoryGeneration(SPM),OFTG_(NULL),dynamicFilter_(NULL),CurrentIndexUpp
 
   NMPCgenerator_ = new NMPCgenerator(SPM,PR_);
 
+  // The planner thread is only started in asynchronous mode.
+  AsyncPlanner_ = new NMPCAsyncPlanner(NMPCgenerator_);
+  AsyncPlanning_ = false ;
+  HasPlan_ = false ;
+  PlanAge_ = MaxPlanAge_ = 0.0 ;
+  NbOfPlans_ = NbOfMissedDeadlines_ = 0 ;
+
   dynamicFilter_ = new DynamicFilter(SPM,PR_);
 
   // Register method to handle
-  const unsigned int NbMethods = 8;
-  string aMethodName[NbMethods] =
+  string aMethodName[NB_OF_METHODS] =
   {":previewcontroltime",
    ":numberstepsbeforestop",
    ":stoppg",
@@ -115,12 +121,15 @@ ZMPRefTrajectoryGeneration(SPM),OFTG_(NULL),dynamicFilter_(NULL),CurrentIndexUpp
    ":addoneobstacle",
    ":updateoneobstacle",
    ":deleteallobstacles",
-   ":perturbationforce"
+   ":perturbationforce",
+   ":asyncplanning",
+   ":sqpsolvebudget",
+   ":sqpmaxiterations"
   };
 
-  for(unsigned int i=0;i<NbMethods;i++)
+  for(unsigned int i=0;i<NB_OF_METHODS;i++)
   {
-    if (!RegisterMethod(aMethodName[i]))
+    if (!RegisterMethod(aMethodName[i],i))
     {
       std::cerr << "Unable to register " << aMethodName << std::endl;
     }
@@ -151,6 +160,12 @@ ZMPRefTrajectoryGeneration(SPM),OFTG_(NULL),dynamicFilter_(NULL),CurrentIndexUpp
 
 ZMPVelocityReferencedSQP::~ZMPVelocityReferencedSQP()
 {
+  // The planner thread uses the generator.
+  if (AsyncPlanner_!=NULL)
+  {
+    delete AsyncPlanner_;
+    AsyncPlanner_ = NULL ;
+  }
   if (NMPCgenerator_!=NULL)
   {
     delete NMPCgenerator_;
@@ -196,51 +211,53 @@ void ZMPVelocityReferencedSQP::setCoMPerturbationForce(double x, double y)
 //
 //
 //-----------new functions--------------
-void ZMPVelocityReferencedSQP::CallMethod(std::string & Method, std::istringstream &strm)
+void ZMPVelocityReferencedSQP::AsyncPlanning(bool AsyncPlanning)
 {
-  if (Method==":previewcontroltime")
+  AsyncPlanning_ = AsyncPlanning ;
+  HasPlan_ = false ;
+  if (!AsyncPlanning_)
   {
-    strm >> m_PreviewControlTime;
+    AsyncPlanner_->stop();
+    NMPCgenerator_->latencyProfile
+      (getSimplePluginManager()->GetLatencyProfile());
   }
-  if (Method==":numberstepsbeforestop")
+  else
   {
-    support_state_t & CurrentSupport = NMPCgenerator_->currentSupport();
-    strm >> CurrentSupport.NbStepsLeft;
-    NMPCgenerator_->setNbStepsLeft(CurrentSupport.NbStepsLeft);
+    // The profile is fed by the control thread only.
+    NMPCgenerator_->latencyProfile(0);
+    if (m_OnLineMode)
+      AsyncPlanner_->start();
   }
-  if (Method==":stoppg")
+}
+
+void ZMPVelocityReferencedSQP::CallMethod(std::string & Method, std::istringstream &strm)
+{
+  if (Method==":asyncplanning")
   {
-    EndingPhase_ = true;
+    std::string lAsyncPlanning;
+    strm >> lAsyncPlanning;
+    if (lAsyncPlanning=="true")
+      AsyncPlanning(true);
+    else if (lAsyncPlanning=="false")
+      AsyncPlanning(false);
+    return;
   }
+
+  // The planner thread may be using the generator.
+  boost::unique_lock<boost::mutex> lock(AsyncPlanner_->generatorMutex(),
+                                        boost::defer_lock);
+  if (AsyncPlanner_->isRunning())
+    lock.lock();
+
   if(Method==":setfeetconstraint")
   {
     NMPCgenerator_->RFI()->CallMethod(Method,strm);
   }
-  if(Method==":addoneobstacle")
-  {
-    double x(0),y(0),r(0);
-    strm >> x;
-    strm >> y;
-    strm >> r;
-    NMPCgenerator_->addOneObstacle(x,y,r);
-  }
-  if(Method==":deleteallobstacles")
+  else if (SimplePlugin::MethodId(Method)>=0)
   {
-    NMPCgenerator_->deleteAllObstacles();
-  }
-  if(Method==":updateoneobstacle")
-  {
-    unsigned id(0);
-    double x(0),y(0),r(0);
-    strm >> id;
-    strm >> x;
-    strm >> y;
-    strm >> r;
-    NMPCgenerator_->updateOneObstacle(id,x,y,r);
-  }
-  if(Method==":perturbationforce")
-  {
-    setCoMPerturbationForce(strm);
+    CommandArguments lArguments;
+    ReadArguments(strm,lArguments);
+    ApplyTypedMethod(SimplePlugin::MethodId(Method),lArguments);
   }
 
   ZMPRefTrajectoryGeneration::CallMethod(Method,strm);
@@ -256,10 +273,110 @@ void ZMPVelocityReferencedSQP::CallMethod(std::string & Method, std::istringstre
   }
 }
 
-std::size_t ZMPVelocityReferencedSQP::InitOnLine(deque<ZMPPosition> & FinalZMPTraj_deq,
-						 deque<COMState> & FinalCoMPositions_deq,
-						 deque<FootAbsolutePosition> & FinalLeftFootTraj_deq,
-						 deque<FootAbsolutePosition> & FinalRightFootTraj_deq,
+void ZMPVelocityReferencedSQP::
+GetPlannerStatistics(PlannerStatistics & aStatistics) const
+{
+  aStatistics.Running = AsyncPlanning_ && AsyncPlanner_->isPlanning();
+  aStatistics.PlanAge = PlanAge_;
+  aStatistics.MaxPlanAge = MaxPlanAge_;
+  aStatistics.NbOfPlans = NbOfPlans_;
+  aStatistics.NbOfMissedDeadlines = NbOfMissedDeadlines_;
+}
+
+const nmpc_solve_status_t & ZMPVelocityReferencedSQP::SolveStatus()
+{
+  if (AsyncPlanning_)
+    return AsyncPlanner_->plan().Status;
+  return NMPCgenerator_->solveStatus();
+}
+
+void ZMPVelocityReferencedSQP::GetSQPSolveStatus(SQPSolveStatus & aStatus)
+{
+  const nmpc_solve_status_t & aSolveStatus = SolveStatus();
+  aStatus.NbOfIterations = aSolveStatus.NbOfIterations;
+  aStatus.Converged = aSolveStatus.Converged;
+  aStatus.DeadlineReached = aSolveStatus.DeadlineReached;
+  aStatus.QPFailed = aSolveStatus.QPFailed;
+  aStatus.Feasible = aSolveStatus.Feasible;
+  aStatus.ConstraintViolation = aSolveStatus.ConstraintViolation;
+  aStatus.Duration = aSolveStatus.Duration;
+  aStatus.MaxIterationDuration = 0.0;
+  for(unsigned int i=0;i<aSolveStatus.IterationDurations.size();i++)
+    if (aSolveStatus.IterationDurations[i]>aStatus.MaxIterationDuration)
+      aStatus.MaxIterationDuration = aSolveStatus.IterationDurations[i];
+}
+
+bool ZMPVelocityReferencedSQP::CallTypedMethod(int MethodId,
+                                               const CommandArguments &Arguments)
+{
+  if (MethodId==ASYNC_PLANNING)
+  {
+    if (Arguments.size()<1)
+      return false;
+    AsyncPlanning(Arguments[0]!=0.0);
+    return true;
+  }
+
+  boost::unique_lock<boost::mutex> lock(AsyncPlanner_->generatorMutex(),
+                                        boost::defer_lock);
+  if (AsyncPlanner_->isRunning())
+    lock.lock();
+
+  return ApplyTypedMethod(MethodId,Arguments);
+}
+
+bool ZMPVelocityReferencedSQP::ApplyTypedMethod(int MethodId,
+                                                const CommandArguments &Arguments)
+{
+  // Missing arguments are taken as zero.
+  double lArgs[CommandArguments::MAX_NB_OF_ARGUMENTS];
+  for(unsigned int i=0;i<CommandArguments::MAX_NB_OF_ARGUMENTS;i++)
+    lArgs[i] = (i<Arguments.size()) ? Arguments[i] : 0.0;
+
+  switch(MethodId)
+  {
+  case PREVIEW_CONTROL_TIME:
+    m_PreviewControlTime = lArgs[0];
+    break;
+  case NUMBER_STEPS_BEFORE_STOP:
+  {
+    support_state_t & CurrentSupport = NMPCgenerator_->currentSupport();
+    CurrentSupport.NbStepsLeft = (unsigned int)lArgs[0];
+    NMPCgenerator_->setNbStepsLeft(CurrentSupport.NbStepsLeft);
+    break;
+  }
+  case STOP_PG:
+    EndingPhase_ = true;
+    break;
+  case ADD_ONE_OBSTACLE:
+    NMPCgenerator_->addOneObstacle(lArgs[0],lArgs[1],lArgs[2]);
+    break;
+  case UPDATE_ONE_OBSTACLE:
+    NMPCgenerator_->updateOneObstacle((unsigned)lArgs[0],
+                                      lArgs[1],lArgs[2],lArgs[3]);
+    break;
+  case DELETE_ALL_OBSTACLES:
+    NMPCgenerator_->deleteAllObstacles();
+    break;
+  case PERTURBATION_FORCE:
+    setCoMPerturbationForce(lArgs[0],lArgs[1]);
+    break;
+  case SOLVE_BUDGET:
+    NMPCgenerator_->solveBudget(lArgs[0]);
+    break;
+  case MAX_SOLVER_ITERATIONS:
+    NMPCgenerator_->maxSolverIteration((unsigned)lArgs[0]);
+    break;
+  default:
+    return false;
+  }
+  return true;
+}
+
+std::size_t ZMPVelocityReferencedSQP::InitOnLine(RingBuffer<ZMPPosition> & FinalZMPTraj_deq,
+						 RingBuffer<COMState> & FinalCoMPositions_deq,
+						 RingBuffer<FootAbsolutePosition> & FinalLeftFootTraj_deq,
+						 RingBuffer<FootAbsolutePosition> & FinalRightFootTraj_deq,
 						 FootAbsolutePosition & InitLeftFootAbsolutePosition,
 						 FootAbsolutePosition & InitRightFootAbsolutePosition,
 						 deque<RelativeFootPosition> &, // RelativeFootPositions,
@@ -356,6 +473,7 @@ std::size_t ZMPVelocityReferencedSQP::InitOnLine(deque<ZMPPosition> & FinalZMPTr
 
   // INITIAL SOLVER:
   // ---------------
+  AsyncPlanner_->stop();
   NMPCgenerator_->T(SQP_T_);
   NMPCgenerator_->N(SQP_N_);
   NMPCgenerator_->T_step(StepPeriod_);
@@ -437,14 +555,20 @@ std::size_t ZMPVelocityReferencedSQP::InitOnLine(deque<ZMPPosition> & FinalZMPTr
   FootStepX_  .resize((long unsigned int)(NMPCgenerator_->nf()+1));
   FootStepY_  .resize((long unsigned int)(NMPCgenerator_->nf()+1));
   FootStepYaw_.resize((long unsigned int)(NMPCgenerator_->nf()+1));
+
+  HasPlan_ = false ;
+  PlanAge_ = MaxPlanAge_ = 0.0 ;
+  NbOfPlans_ = NbOfMissedDeadlines_ = 0 ;
+  if (AsyncPlanning_)
+    AsyncPlanner_->start();
   return 0;
 }
 
 void ZMPVelocityReferencedSQP::OnLine(double time,
-                                    deque<ZMPPosition> & FinalZMPTraj_deq,
-                                    deque<COMState> & FinalCOMTraj_deq,
-                                    deque<FootAbsolutePosition> & FinalLeftFootTraj_deq,
-                                    deque<FootAbsolutePosition> & FinalRightFootTraj_deq)
+                                    RingBuffer<ZMPPosition> & FinalZMPTraj_deq,
+                                    RingBuffer<COMState> & FinalCOMTraj_deq,
+                                    RingBuffer<FootAbsolutePosition> & FinalLeftFootTraj_deq,
+                                    RingBuffer<FootAbsolutePosition> & FinalRightFootTraj_deq)
 {
   // If on-line mode not activated we go out.
   if (!m_OnLineMode)
@@ -454,40 +578,52 @@ void ZMPVelocityReferencedSQP::OnLine(double time,
 
   // Test if the end of the online mode has been reached.
   if ((EndingPhase_) && (time>=TimeToStopOnLineMode_))
-  { m_OnLineMode = false; }
+  {
+    m_OnLineMode = false;
+    // Without waiting for the solve in progress,
+    // the thread is joined by the next start or stop.
+    AsyncPlanner_->requestStop();
+  }
 
   // UPDATE WALKING TRAJECTORIES:
   // ----------------------------
   if(time + 0.00001 > UpperTimeLimitToUpdate_)
   {
-    // UPDATE INTERNAL DATA:
-    // ---------------------
-    if(PerturbationOccured_ &&
-       NMPCgenerator_->currentSupport().NbStepsLeft>1 &&
-       NMPCgenerator_->SupportStates_deq().back().StepNumber >0)
+    if (AsyncPlanning_)
     {
-      initCOM_.x[2]+=PerturbationAcceleration_(2);
-      initCOM_.y[2]+=PerturbationAcceleration_(5);
-      itCOM_.x[2]+=PerturbationAcceleration_(2);
-      itCOM_.y[2]+=PerturbationAcceleration_(5);
-      PerturbationOccured_=false;
+      UpdateAsyncPlan(time);
     }
-    VelRef_=NewVelRef_;
+    else
+    {
+      // UPDATE INTERNAL DATA:
+      // ---------------------
+      if(PerturbationOccured_ &&
+         NMPCgenerator_->currentSupport().NbStepsLeft>1 &&
+         NMPCgenerator_->SupportStates_deq().back().StepNumber >0)
+      {
+        initCOM_.x[2]+=PerturbationAcceleration_(2);
+        initCOM_.y[2]+=PerturbationAcceleration_(5);
+        itCOM_.x[2]+=PerturbationAcceleration_(2);
+        itCOM_.y[2]+=PerturbationAcceleration_(5);
+        PerturbationOccured_=false;
+      }
+      VelRef_=NewVelRef_;
 
 //    struct timeval begin ;
 //    gettimeofday(&begin,0);
 
-    NMPCgenerator_->updateInitialCondition(
-        time,
-        initLeftFoot_ ,
-        initRightFoot_,
-        itCOM_,
-        //initCOM_,
-        VelRef_);
-
-    // SOLVE PROBLEM:
-    // --------------
-    NMPCgenerator_->solve();
+      NMPCgenerator_->updateInitialCondition(
+          time,
+          initLeftFoot_ ,
+          initRightFoot_,
+          itCOM_,
+          //initCOM_,
+          VelRef_);
+
+      // SOLVE PROBLEM:
+      // --------------
+      NMPCgenerator_->solve();
+    }
 
 //    static int warning=0;
 //    struct timeval end ;
@@ -527,7 +663,11 @@ void ZMPVelocityReferencedSQP::OnLine(double time,
     // INTERPOLATION
     // ------------------------
     // Compute the full trajectory in the preview window
-    FullTrajectoryInterpolation(time);
+    {
+      ScopedLatency aInterpolationLatency
+        (getSimplePluginManager()->GetLatencyProfile(),STAGE_FOOT_TRAJECTORY);
+      FullTrajectoryInterpolation(time);
+    }
 
     // Take only the data that are actually used by the robot
     FinalZMPTraj_deq.resize(NbSampleOutput_); FinalLeftFootTraj_deq .resize(NbSampleOutput_);
@@ -551,10 +691,14 @@ void ZMPVelocityReferencedSQP::OnLine(double time,
 //      dynamicFilter_->getComAndFootRealization()
 //          ->SetPreviousVelocityStage1(m_CurrentVelocity_);
 //    }
-    dynamicFilter_->OnLinefilter(COMTraj_deq_,ZMPTraj_deq_ctrl_,
-                                 LeftFootTraj_deq_,
-                                 RightFootTraj_deq_,
-                                 deltaCOMTraj_deq_);
+    {
+      ScopedLatency aFilterLatency
+        (getSimplePluginManager()->GetLatencyProfile(),STAGE_DYNAMIC_FILTER);
+      dynamicFilter_->OnLinefilter(COMTraj_deq_,ZMPTraj_deq_ctrl_,
+                                   LeftFootTraj_deq_,
+                                   RightFootTraj_deq_,
+                                   deltaCOMTraj_deq_);
+    }
 #ifdef DEBUG
     dynamicFilter_->Debug(COMTraj_deq_ctrl_,
                           LeftFootTraj_deq_ctrl_,
@@ -606,7 +750,238 @@ void ZMPVelocityReferencedSQP::OnLine(double time,
   //----------"Real-time" loop---------
 }
 
+namespace PatternGeneratorJRL
+{
+  /// \brief Part of ZMPVelocityReferencedSQP which evolves while walking.
+  struct ZMPVelocityReferencedSQPState : public ZMPRefTrajectoryGenerationState
+  {
+    double CurrentTime ;
+    bool OnLineMode ;
+    reference_t VelRef, NewVelRef ;
+    bool PerturbationOccured, EndingPhase, Running ;
+    double TimeToStopOnLineMode, UpperTimeLimitToUpdate ;
+    Eigen::VectorXd PerturbationAcceleration ;
+    LinearizedInvertedPendulum2D LIPM ;
+    unsigned CurrentIndex ;
+    solution_t solution ;
+    RingBuffer<COMState> deltaCOMTraj_deq ;
+    RingBuffer<ZMPPosition> ZMPTraj_deq, ZMPTraj_deq_ctrl ;
+    RingBuffer<COMState> COMTraj_deq, COMTraj_deq_ctrl ;
+    RingBuffer<FootAbsolutePosition> LeftFootTraj_deq, RightFootTraj_deq ;
+    RingBuffer<FootAbsolutePosition> LeftFootTraj_deq_ctrl,
+      RightFootTraj_deq_ctrl ;
+    std::vector<double> JerkX, JerkY ;
+    std::vector<double> FootStepX, FootStepY, FootStepYaw ;
+    Eigen::VectorXd CurrentConfiguration, CurrentVelocity,
+      CurrentAcceleration ;
+    ZMPPosition initZMP ;
+    COMState initCOM ;
+    FootAbsolutePosition initLeftFoot, initRightFoot ;
+    COMState itCOM ;
+    nmpc_state_t NMPC ;
+    online_foot_trajectory_state_t OFTG ;
+    dynamic_filter_state_t DynamicFilter ;
+  };
+}
+
+ZMPRefTrajectoryGenerationState * ZMPVelocityReferencedSQP::CreateState() const
+{
+  return new ZMPVelocityReferencedSQPState();
+}
+
+bool ZMPVelocityReferencedSQP::SaveState(ZMPRefTrajectoryGenerationState & aState) const
+{
+  // The planner thread owns the NMPC generator.
+  if (AsyncPlanning_)
+    return false;
+
+  ZMPVelocityReferencedSQPState & lState =
+      static_cast<ZMPVelocityReferencedSQPState &>(aState);
+
+  lState.CurrentTime = m_CurrentTime ;
+  lState.OnLineMode = m_OnLineMode ;
+  lState.VelRef = VelRef_ ;
+  lState.NewVelRef = NewVelRef_ ;
+  lState.PerturbationOccured = PerturbationOccured_ ;
+  lState.EndingPhase = EndingPhase_ ;
+  lState.Running = Running_ ;
+  lState.TimeToStopOnLineMode = TimeToStopOnLineMode_ ;
+  lState.UpperTimeLimitToUpdate = UpperTimeLimitToUpdate_ ;
+  lState.PerturbationAcceleration = PerturbationAcceleration_ ;
+  lState.LIPM = LIPM_ ;
+  lState.CurrentIndex = CurrentIndex_ ;
+  lState.solution = solution_ ;
+  lState.deltaCOMTraj_deq = deltaCOMTraj_deq_ ;
+  lState.ZMPTraj_deq = ZMPTraj_deq_ ;
+  lState.COMTraj_deq = COMTraj_deq_ ;
+  lState.LeftFootTraj_deq = LeftFootTraj_deq_ ;
+  lState.RightFootTraj_deq = RightFootTraj_deq_ ;
+  lState.ZMPTraj_deq_ctrl = ZMPTraj_deq_ctrl_ ;
+  lState.COMTraj_deq_ctrl = COMTraj_deq_ctrl_ ;
+  lState.LeftFootTraj_deq_ctrl = LeftFootTraj_deq_ctrl_ ;
+  lState.RightFootTraj_deq_ctrl = RightFootTraj_deq_ctrl_ ;
+  lState.JerkX = JerkX_ ;
+  lState.JerkY = JerkY_ ;
+  lState.FootStepX = FootStepX_ ;
+  lState.FootStepY = FootStepY_ ;
+  lState.FootStepYaw = FootStepYaw_ ;
+  lState.CurrentConfiguration = m_CurrentConfiguration_ ;
+  lState.CurrentVelocity = m_CurrentVelocity_ ;
+  lState.CurrentAcceleration = m_CurrentAcceleration_ ;
+  lState.initZMP = initZMP_ ;
+  lState.initCOM = initCOM_ ;
+  lState.initLeftFoot = initLeftFoot_ ;
+  lState.initRightFoot = initRightFoot_ ;
+  lState.itCOM = itCOM_ ;
+  NMPCgenerator_->getState(lState.NMPC) ;
+  OFTG_->getState(lState.OFTG) ;
+  dynamicFilter_->getState(lState.DynamicFilter) ;
+  return true;
+}
+
+void ZMPVelocityReferencedSQP::RestoreState(const ZMPRefTrajectoryGenerationState & aState)
+{
+  const ZMPVelocityReferencedSQPState & lState =
+      static_cast<const ZMPVelocityReferencedSQPState &>(aState);
+
+  // Plans computed from the current state are not valid anymore.
+  bool RestartPlanner = AsyncPlanner_->isRunning() ;
+  AsyncPlanner_->stop();
+  HasPlan_ = false ;
+
+  m_CurrentTime = lState.CurrentTime ;
+  m_OnLineMode = lState.OnLineMode ;
+  VelRef_ = lState.VelRef ;
+  NewVelRef_ = lState.NewVelRef ;
+  PerturbationOccured_ = lState.PerturbationOccured ;
+  EndingPhase_ = lState.EndingPhase ;
+  Running_ = lState.Running ;
+  TimeToStopOnLineMode_ = lState.TimeToStopOnLineMode ;
+  UpperTimeLimitToUpdate_ = lState.UpperTimeLimitToUpdate ;
+  PerturbationAcceleration_ = lState.PerturbationAcceleration ;
+  LIPM_ = lState.LIPM ;
+  CurrentIndex_ = lState.CurrentIndex ;
+  solution_ = lState.solution ;
+  deltaCOMTraj_deq_ = lState.deltaCOMTraj_deq ;
+  ZMPTraj_deq_ = lState.ZMPTraj_deq ;
+  COMTraj_deq_ = lState.COMTraj_deq ;
+  LeftFootTraj_deq_ = lState.LeftFootTraj_deq ;
+  RightFootTraj_deq_ = lState.RightFootTraj_deq ;
+  ZMPTraj_deq_ctrl_ = lState.ZMPTraj_deq_ctrl ;
+  COMTraj_deq_ctrl_ = lState.COMTraj_deq_ctrl ;
+  LeftFootTraj_deq_ctrl_ = lState.LeftFootTraj_deq_ctrl ;
+  RightFootTraj_deq_ctrl_ = lState.RightFootTraj_deq_ctrl ;
+  JerkX_ = lState.JerkX ;
+  JerkY_ = lState.JerkY ;
+  FootStepX_ = lState.FootStepX ;
+  FootStepY_ = lState.FootStepY ;
+  FootStepYaw_ = lState.FootStepYaw ;
+  m_CurrentConfiguration_ = lState.CurrentConfiguration ;
+  m_CurrentVelocity_ = lState.CurrentVelocity ;
+  m_CurrentAcceleration_ = lState.CurrentAcceleration ;
+  initZMP_ = lState.initZMP ;
+  initCOM_ = lState.initCOM ;
+  initLeftFoot_ = lState.initLeftFoot ;
+  initRightFoot_ = lState.initRightFoot ;
+  itCOM_ = lState.itCOM ;
+  NMPCgenerator_->setState(lState.NMPC) ;
+  OFTG_->setState(lState.OFTG) ;
+  dynamicFilter_->setState(lState.DynamicFilter) ;
+
+  if (RestartPlanner)
+    AsyncPlanner_->start();
+}
+
+void ZMPVelocityReferencedSQP::UpdateAsyncPlan(double time)
+{
+  if(PerturbationOccured_ && HasPlan_)
+  {
+    nmpc_plan_t & aPlan = AsyncPlanner_->plan();
+    if(aPlan.CurrentSupport.NbStepsLeft>1 &&
+       aPlan.SupportStates_deq.back().StepNumber >0)
+    {
+      initCOM_.x[2]+=PerturbationAcceleration_(2);
+      initCOM_.y[2]+=PerturbationAcceleration_(5);
+      itCOM_.x[2]+=PerturbationAcceleration_(2);
+      itCOM_.y[2]+=PerturbationAcceleration_(5);
+      PerturbationOccured_=false;
+    }
+  }
+  VelRef_=NewVelRef_;
+
+  // Send the current state to the planner thread.
+  nmpc_request_t & aRequest = AsyncPlanner_->requestSlot();
+  aRequest.time = time ;
+  aRequest.LeftFoot = initLeftFoot_ ;
+  aRequest.RightFoot = initRightFoot_ ;
+  aRequest.CoM = itCOM_ ;
+  aRequest.VelRef = VelRef_ ;
+  AsyncPlanner_->post();
+
+  // Take the last plan. The control thread waits only for
+  // the very first one so that the walk starts from a solution.
+  bool NewPlan = AsyncPlanner_->fetch();
+  if (!HasPlan_ && !NewPlan)
+  {
+    AsyncPlanner_->waitForPlan();
+    NewPlan = true;
+  }
+  HasPlan_ = true;
+  if (NewPlan)
+    NbOfPlans_++;
+
+  nmpc_plan_t & aPlan = AsyncPlanner_->plan();
+  PlanAge_ = time - aPlan.RequestTime ;
+  if (PlanAge_ > MaxPlanAge_)
+    MaxPlanAge_ = PlanAge_ ;
+
+  // Deadline: the solution has to be available before the end of the
+  // first sampling period of the previous plan. Otherwise the previous
+  // plan is followed, starting from its first sampling period which is
+  // not over. This only depends on the plan and on the time.
+  unsigned lShift = aPlan.Shift ;
+  if (!aPlan.shift(time, SQP_T_, previewSize_))
+  {
+    ODEBUG("The plan computed at " << aPlan.RequestTime
+           << " does not cover time " << time);
+  }
+  if (aPlan.Shift > lShift)
+    NbOfMissedDeadlines_++;
+}
+
 void ZMPVelocityReferencedSQP::FullTrajectoryInterpolation(double time)
+{
+  if (AsyncPlanning_)
+  {
+    nmpc_plan_t & aPlan = AsyncPlanner_->plan();
+    double Tfirst = aPlan.time + aPlan.Tfirst - time ;
+    if (Tfirst < m_SamplingPeriod)
+      Tfirst = m_SamplingPeriod ;
+    FullTrajectoryInterpolation(time, aPlan.JerkX, aPlan.JerkY,
+                                aPlan.FootStepX, aPlan.FootStepY,
+                                aPlan.FootStepYaw, aPlan.SupportStates_deq,
+                                Tfirst, aPlan.Shift==0);
+    return;
+  }
+
+  NMPCgenerator_->getSolution(JerkX_, JerkY_, FootStepX_,
+			      FootStepY_, FootStepYaw_);
+  FullTrajectoryInterpolation(time, JerkX_, JerkY_,
+                              FootStepX_, FootStepY_, FootStepYaw_,
+                              NMPCgenerator_->SupportStates_deq(),
+                              NMPCgenerator_->Tfirst(), true);
+}
+
+void ZMPVelocityReferencedSQP::FullTrajectoryInterpolation(
+    double time,
+    std::vector<double> &JerkX,
+    std::vector<double> &JerkY,
+    std::vector<double> &FootStepX,
+    std::vector<double> &FootStepY,
+    std::vector<double> &FootStepYaw,
+    const RingBuffer<support_state_t> & SupportStates_deq,
+    double Tfirst,
+    bool FirstStepNumberIsZero)
 {
   if(LeftFootTraj_deq_ctrl_.size() <
      CurrentIndex_ + previewSize_ * NbSampleControl_)
@@ -621,35 +996,32 @@ void ZMPVelocityReferencedSQP::FullTrajectoryInterpolation(double time)
                              + CurrentIndexUpperBound_,initRightFoot_);
   }
 
-  NMPCgenerator_->getSolution(JerkX_, JerkY_, FootStepX_,
-			      FootStepY_, FootStepYaw_);
-  const std::deque<support_state_t> & SupportStates_deq =
-    NMPCgenerator_->SupportStates_deq();
   LIPM_.setState(itCOM_);
 
-  CoMZMPInterpolation(JerkX_,JerkY_,&LIPM_,
+  CoMZMPInterpolation(JerkX,JerkY,&LIPM_,
 		      NbSampleControl_,0,
 		      CurrentIndex_,SupportStates_deq);
   itCOM_ = COMTraj_deq_ctrl_[NbSampleOutput_-1];
 
   support_state_t currentSupport = SupportStates_deq[0] ;
-  currentSupport.StepNumber=0;
+  if (FirstStepNumberIsZero)
+    currentSupport.StepNumber=0;
   OFTG_->interpolate_feet_positions(time, CurrentIndex_, currentSupport,
-                                  FootStepX_, FootStepY_, FootStepYaw_,
+                                  FootStepX, FootStepY, FootStepYaw,
                                   LeftFootTraj_deq_ctrl_, RightFootTraj_deq_ctrl_);
 
-  double currentTime = time + NMPCgenerator_->Tfirst();
+  double currentTime = time + Tfirst;
   double currentIndex = CurrentIndex_ +
-    (int)round(NMPCgenerator_->Tfirst()/m_SamplingPeriod);
+    (int)round(Tfirst/m_SamplingPeriod);
   for ( unsigned int i = 1 ; i<previewSize_ ; i++ )
   {
     LIPM_.setState(COMTraj_deq_ctrl_[currentIndex-1]);
-    CoMZMPInterpolation(JerkX_,JerkY_,&LIPM_,
+    CoMZMPInterpolation(JerkX,JerkY,&LIPM_,
 			NbSampleControl_,
 			i,currentIndex,SupportStates_deq);
     OFTG_->interpolate_feet_positions(currentTime, currentIndex,
                                       SupportStates_deq[i],
-                                      FootStepX_, FootStepY_, FootStepYaw_,
+                                      FootStepX, FootStepY, FootStepYaw,
                                       LeftFootTraj_deq_ctrl_, RightFootTraj_deq_ctrl_);
     currentTime  += SQP_T_;
     currentIndex += (int)round(SQP_T_/m_SamplingPeriod) ;
@@ -704,7 +1076,7 @@ void ZMPVelocityReferencedSQP::CoMZMPInterpolation(
     const unsigned numberOfSample,       // INPUT
     const int IterationNumber,           // INPUT
     const unsigned int currentIndex,     // INPUT
-    const std::deque<support_state_t> & SupportStates_deq )// INPUT
+    const RingBuffer<support_state_t> & SupportStates_deq )// INPUT
 {
   if(SupportStates_deq[0].Phase==DS && SupportStates_deq[0].NbStepsLeft == 0)
   {
@@ -730,11 +1102,11 @@ void ZMPVelocityReferencedSQP::CoMZMPInterpolation(
 }
 
 // TODO: New parent class needed
-void ZMPVelocityReferencedSQP::GetZMPDiscretization(deque<ZMPPosition> & ,
-                                                   deque<COMState> & ,
+void ZMPVelocityReferencedSQP::GetZMPDiscretization(RingBuffer<ZMPPosition> & ,
+                                                   RingBuffer<COMState> & ,
                                                    deque<RelativeFootPosition> &,
-                                                   deque<FootAbsolutePosition> &,
-                                                   deque<FootAbsolutePosition> &,
+                                                   RingBuffer<FootAbsolutePosition> &,
+                                                   RingBuffer<FootAbsolutePosition> &,
                                                    double ,
                                                    COMState &,
                                                    Eigen::Vector3d &,
@@ -746,10 +1118,10 @@ void ZMPVelocityReferencedSQP::GetZMPDiscretization(deque<ZMPPosition> & ,
 
 
 void ZMPVelocityReferencedSQP::OnLineAddFoot(RelativeFootPosition & ,
-                                            deque<ZMPPosition> & ,
-                                            deque<COMState> & ,
-                                            deque<FootAbsolutePosition> &,
-                                            deque<FootAbsolutePosition> &,
+                                            RingBuffer<ZMPPosition> & ,
+                                            RingBuffer<COMState> & ,
+                                            RingBuffer<FootAbsolutePosition> &,
+                                            RingBuffer<FootAbsolutePosition> &,
                                             bool)
 {
   cout << "To be removed" << endl;
@@ -757,20 +1129,20 @@ void ZMPVelocityReferencedSQP::OnLineAddFoot(RelativeFootPosition & ,
 
 int ZMPVelocityReferencedSQP::OnLineFootChange(double ,
                                               FootAbsolutePosition &,
-                                              deque<ZMPPosition> & ,
-                                              deque<COMState> & ,
-                                              deque<FootAbsolutePosition> &,
-                                              deque<FootAbsolutePosition> &,
+                                              RingBuffer<ZMPPosition> & ,
+                                              RingBuffer<COMState> & ,
+                                              RingBuffer<FootAbsolutePosition> &,
+                                              RingBuffer<FootAbsolutePosition> &,
                                               StepStackHandler  *)
 {
   cout << "To be removed" << endl;
   return -1;
 }
 
-void ZMPVelocityReferencedSQP::EndPhaseOfTheWalking(deque<ZMPPosition> &,
-                                                   deque<COMState> &,
-                                                   deque<FootAbsolutePosition> &,
-                                                   deque<FootAbsolutePosition> &)
+void ZMPVelocityReferencedSQP::EndPhaseOfTheWalking(RingBuffer<ZMPPosition> &,
+                                                   RingBuffer<COMState> &,
+                                                   RingBuffer<FootAbsolutePosition> &,
+                                                   RingBuffer<FootAbsolutePosition> &)
 {
   cout << "To be removed" << endl;
 }
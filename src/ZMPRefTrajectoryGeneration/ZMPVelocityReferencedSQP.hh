@@ -34,6 +34,7 @@
 #include <privatepgtypes.hh>
 #include <jrl/walkgen/pgtypes.hh>
 #include <ZMPRefTrajectoryGeneration/nmpc_generator.hh>
+#include <ZMPRefTrajectoryGeneration/nmpc_async_planner.hh>
 #include <ZMPRefTrajectoryGeneration/DynamicFilter.hh>
 
 //#include </home/mnaveau/devel/ros_unstable/src/jrl/jrl-walkgen/tests/ClockCPUTime.hh>
@@ -59,6 +60,10 @@ namespace PatternGeneratorJRL
     /// \brief Handle plugins (SimplePlugin interface)
     void CallMethod(std::string &Method, std::istringstream &strm);
 
+    /// \brief Handle the numerical commands without parsing
+    /// (SimplePlugin interface)
+    bool CallTypedMethod(int MethodId, const CommandArguments &Arguments);
+
     /*! \name Call method to handle on-line generation of ZMP reference trajectory.
       @{*/
 
@@ -72,10 +77,10 @@ namespace PatternGeneratorJRL
       Returns the number of steps which has been completely put inside
       the queue of ZMP, and foot positions.
     */
-    std::size_t InitOnLine(deque<ZMPPosition> & FinalZMPPositions,
-			   deque<COMState> & FinalCoMPositions_deq,
-			   deque<FootAbsolutePosition> & FinalLeftFootTraj_deq,
-			   deque<FootAbsolutePosition> & FinalRightFootTraj_deq,
+    std::size_t InitOnLine(RingBuffer<ZMPPosition> & FinalZMPPositions,
+			   RingBuffer<COMState> & FinalCoMPositions_deq,
+			   RingBuffer<FootAbsolutePosition> & FinalLeftFootTraj_deq,
+			   RingBuffer<FootAbsolutePosition> & FinalRightFootTraj_deq,
 			   FootAbsolutePosition & InitLeftFootAbsolutePosition,
 			   FootAbsolutePosition & InitRightFootAbsolutePosition,
 			   deque<RelativeFootPosition> &RelativeFootPositions,
@@ -125,11 +130,19 @@ namespace PatternGeneratorJRL
 
     /// \brief Update the stacks on-line
     void OnLine(double time,
-                deque<ZMPPosition> & FinalZMPPositions,
-                deque<COMState> & FinalCOMTraj_deq,
-                deque<FootAbsolutePosition> &FinalLeftFootTraj_deq,
-                deque<FootAbsolutePosition> &FinalRightFootTraj_deq);
-
+                RingBuffer<ZMPPosition> & FinalZMPPositions,
+                RingBuffer<COMState> & FinalCOMTraj_deq,
+                RingBuffer<FootAbsolutePosition> &FinalLeftFootTraj_deq,
+                RingBuffer<FootAbsolutePosition> &FinalRightFootTraj_deq);
+
+    /// \name Snapshot of the state (see ZMPRefTrajectoryGeneration)
+    /// The state can not be saved while the SQP is solved by the
+    /// planner thread.
+    /// \{
+    ZMPRefTrajectoryGenerationState * CreateState() const;
+    bool SaveState(ZMPRefTrajectoryGenerationState & aState) const;
+    void RestoreState(const ZMPRefTrajectoryGenerationState & aState);
+    /// \}
 
     /// \name Accessors and mutators
     /// \{
@@ -166,6 +179,38 @@ namespace PatternGeneratorJRL
     /// \brief Setter and getter for the ComAndZMPTrajectoryGeneration.
     inline ComAndFootRealization * getComAndFootRealization()
     { return dynamicFilter_->getComAndFootRealization();}
+
+    /// \brief Solve the SQP in a dedicated planner thread.
+    /// The plan used at an update is the last one published by the
+    /// planner, so it depends on the duration of the solves: the
+    /// trajectories are not reproducible from run to run.
+    void AsyncPlanning(bool AsyncPlanning);
+    inline bool AsyncPlanning() const
+    { return AsyncPlanning_; }
+
+    /// \brief Age (s) of the plan used at the last update,
+    /// i.e. the time elapsed since its initial condition.
+    inline double PlanAge() const
+    { return PlanAge_; }
+    /// \brief Maximum of PlanAge() since the last initialization.
+    inline double MaxPlanAge() const
+    { return MaxPlanAge_; }
+    /// \brief Number of plans received from the planner thread.
+    inline unsigned long int NbOfPlans() const
+    { return NbOfPlans_; }
+    /// \brief Number of updates for which no plan was available
+    /// before the end of the first sampling period of the previous one.
+    inline unsigned long int NbOfMissedDeadlines() const
+    { return NbOfMissedDeadlines_; }
+    /// \brief All the metrics above.
+    void GetPlannerStatistics(PlannerStatistics & aStatistics) const;
+
+    /// \brief Report of the last SQP solve: number of iterations,
+    /// feasibility, time budget reached, timings.
+    /// In asynchronous mode, report of the last plan received.
+    const nmpc_solve_status_t & SolveStatus();
+    /// \brief The report above, for the interface.
+    void GetSQPSolveStatus(SQPSolveStatus & aStatus);
     /// \}
 
     //
@@ -173,6 +218,26 @@ namespace PatternGeneratorJRL
     //
   private:
 
+    /// \brief Identifiers of the registered methods.
+    enum MethodIds_t
+    {
+      PREVIEW_CONTROL_TIME=0,
+      NUMBER_STEPS_BEFORE_STOP,
+      STOP_PG,
+      SET_FEET_CONSTRAINT,
+      ADD_ONE_OBSTACLE,
+      UPDATE_ONE_OBSTACLE,
+      DELETE_ALL_OBSTACLES,
+      PERTURBATION_FORCE,
+      ASYNC_PLANNING,
+      SOLVE_BUDGET,
+      MAX_SOLVER_ITERATIONS,
+      NB_OF_METHODS
+    };
+
+    /// \brief Apply a numerical command, the generator has to be
+    /// locked by the caller. Returns false if the method is not numerical.
+    bool ApplyTypedMethod(int MethodId, const CommandArguments &Arguments);
 
     /// \brief Standard polynomial trajectories for the feet.
     OnLineFootTrajectoryGeneration * OFTG_ ;
@@ -228,6 +293,17 @@ namespace PatternGeneratorJRL
     /// \brief Generator of QP problem
     NMPCgenerator * NMPCgenerator_;
 
+    /// \name Asynchronous planning
+    /// \{
+    /// \brief Planner thread running NMPCgenerator_
+    NMPCAsyncPlanner * AsyncPlanner_;
+    bool AsyncPlanning_;
+    /// \brief A plan has been received since the last initialization
+    bool HasPlan_;
+    double PlanAge_, MaxPlanAge_;
+    unsigned long int NbOfPlans_, NbOfMissedDeadlines_;
+    /// \}
+
     /// \brief Previewed Solution
     solution_t solution_;
 
@@ -236,17 +312,17 @@ namespace PatternGeneratorJRL
     double RobotMass_ ;
 
     /// \brief Buffers for the Kajita's dynamic filter
-    std::deque<COMState> deltaCOMTraj_deq_ ;
+    RingBuffer<COMState> deltaCOMTraj_deq_ ;
     // subsampled trajectory m_interpolationPeriod
-    std::deque<ZMPPosition> ZMPTraj_deq_ ;
-    std::deque<COMState> COMTraj_deq_ ;
-    std::deque<FootAbsolutePosition> LeftFootTraj_deq_ ;
-    std::deque<FootAbsolutePosition> RightFootTraj_deq_ ;
+    RingBuffer<ZMPPosition> ZMPTraj_deq_ ;
+    RingBuffer<COMState> COMTraj_deq_ ;
+    RingBuffer<FootAbsolutePosition> LeftFootTraj_deq_ ;
+    RingBuffer<FootAbsolutePosition> RightFootTraj_deq_ ;
     // full trajectory (m_samplingPeriod)
-    std::deque<ZMPPosition> ZMPTraj_deq_ctrl_ ;
-    std::deque<COMState> COMTraj_deq_ctrl_ ;
-    std::deque<FootAbsolutePosition> LeftFootTraj_deq_ctrl_ ;
-    std::deque<FootAbsolutePosition> RightFootTraj_deq_ctrl_ ;
+    RingBuffer<ZMPPosition> ZMPTraj_deq_ctrl_ ;
+    RingBuffer<COMState> COMTraj_deq_ctrl_ ;
+    RingBuffer<FootAbsolutePosition> LeftFootTraj_deq_ctrl_ ;
+    RingBuffer<FootAbsolutePosition> RightFootTraj_deq_ctrl_ ;
     // usefull deque to handle the solution of the nmpc
     std::vector<double> JerkX_ ;
     std::vector<double> JerkY_ ;
@@ -295,11 +371,11 @@ namespace PatternGeneratorJRL
 
   public:
 
-    void GetZMPDiscretization(std::deque<ZMPPosition> & ZMPPositions,
-                              std::deque<COMState> & COMStates,
+    void GetZMPDiscretization(RingBuffer<ZMPPosition> & ZMPPositions,
+                              RingBuffer<COMState> & COMStates,
                               std::deque<RelativeFootPosition> &RelativeFootPositions,
-                              std::deque<FootAbsolutePosition> &LeftFootAbsolutePositions,
-                              std::deque<FootAbsolutePosition> &RightFootAbsolutePositions,
+                              RingBuffer<FootAbsolutePosition> &LeftFootAbsolutePositions,
+                              RingBuffer<FootAbsolutePosition> &RightFootAbsolutePositions,
                               double Xmax,
                               COMState & lStartingCOMState,
                               Eigen::Vector3d & lStartingZMPPosition,
@@ -307,30 +383,45 @@ namespace PatternGeneratorJRL
                               FootAbsolutePosition & InitRightFootAbsolutePosition);
 
     void OnLineAddFoot(RelativeFootPosition & NewRelativeFootPosition,
-                       std::deque<ZMPPosition> & FinalZMPPositions,
-                       std::deque<COMState> & COMStates,
-                       std::deque<FootAbsolutePosition> & FinalLeftFootTraj_deq,
-                       std::deque<FootAbsolutePosition> & FinalRightFootTraj_deq,
+                       RingBuffer<ZMPPosition> & FinalZMPPositions,
+                       RingBuffer<COMState> & COMStates,
+                       RingBuffer<FootAbsolutePosition> & FinalLeftFootTraj_deq,
+                       RingBuffer<FootAbsolutePosition> & FinalRightFootTraj_deq,
                        bool EndSequence);
 
     int OnLineFootChange(double time,
                          FootAbsolutePosition & aFootAbsolutePosition,
-                         deque<ZMPPosition> & FinalZMPPositions,
-                         deque<COMState> & CoMPositions,
-                         deque<FootAbsolutePosition> & FinalLeftFootTraj_deq,
-                         deque<FootAbsolutePosition> & FinalRightFootTraj_deq,
+                         RingBuffer<ZMPPosition> & FinalZMPPositions,
+                         RingBuffer<COMState> & CoMPositions,
+                         RingBuffer<FootAbsolutePosition> & FinalLeftFootTraj_deq,
+                         RingBuffer<FootAbsolutePosition> & FinalRightFootTraj_deq,
                          StepStackHandler * aStepStackHandler);
 
-    void EndPhaseOfTheWalking(deque<ZMPPosition> & ZMPPositions,
-                              deque<COMState> & FinalCOMTraj_deq,
-                              deque<FootAbsolutePosition> & LeftFootAbsolutePositions,
-                              deque<FootAbsolutePosition> & RightFootAbsolutePositions);
+    void EndPhaseOfTheWalking(RingBuffer<ZMPPosition> & ZMPPositions,
+                              RingBuffer<COMState> & FinalCOMTraj_deq,
+                              RingBuffer<FootAbsolutePosition> & LeftFootAbsolutePositions,
+                              RingBuffer<FootAbsolutePosition> & RightFootAbsolutePositions);
 
     int ReturnOptimalTimeToRegenerateAStep();
 
     /// \brief Interpolate just enough data to pilot the robot (period of interpolation = QP_T_)
     /// uses
     void FullTrajectoryInterpolation(double time); // INPUT
+    /// \brief Same as above from a given solution of the SQP.
+    /// Tfirst is the time left in the first sampling period of the solution.
+    void FullTrajectoryInterpolation(
+        double time,                                         // INPUT
+        std::vector<double> &JerkX,                          // INPUT
+        std::vector<double> &JerkY,                          // INPUT
+        std::vector<double> &FootStepX,                      // INPUT
+        std::vector<double> &FootStepY,                      // INPUT
+        std::vector<double> &FootStepYaw,                    // INPUT
+        const RingBuffer<support_state_t> & SupportStates_deq, // INPUT
+        double Tfirst,                                       // INPUT
+        bool FirstStepNumberIsZero);                         // INPUT
+    /// \brief Send the initial condition to the planner thread
+    /// and get the plan to interpolate.
+    void UpdateAsyncPlan(double time);
     /// \brief Interpolation form the com jerk the position of the com and the zmp corresponding to the kart table model
     void CoMZMPInterpolation(
         std::vector<double> &JerkX,           // INPUT
@@ -339,7 +430,7 @@ namespace PatternGeneratorJRL
         const unsigned numberOfSample,       // INPUT
         const int IterationNumber,           // INPUT
         const unsigned int currentIndex,     // INPUT
-        const std::deque<support_state_t> & SupportStates_deq );// INPUT
+        const RingBuffer<support_state_t> & SupportStates_deq );// INPUT
   };
 }
 
@@ -70,9 +70,9 @@ GeneratorVelRef::Ponderation( double weight, objective_e type)
 
 void
 GeneratorVelRef::preview_support_states( double time, const SupportFSM * FSM,
-    const deque<FootAbsolutePosition> & FinalLeftFootTraj_deq,
-    const deque<FootAbsolutePosition> & FinalRightFootTraj_deq,
-    deque<support_state_t> & SupportStates_deq )
+    const RingBuffer<FootAbsolutePosition> & FinalLeftFootTraj_deq,
+    const RingBuffer<FootAbsolutePosition> & FinalRightFootTraj_deq,
+    RingBuffer<support_state_t> & SupportStates_deq )
 {
 
   const FootAbsolutePosition * FAP = NULL;
@@ -136,7 +136,7 @@ GeneratorVelRef::preview_support_states( double time, const SupportFSM * FSM,
 
 
 void
-GeneratorVelRef::generate_selection_matrices( const std::deque<support_state_t> & SupportStates_deq )
+GeneratorVelRef::generate_selection_matrices( const RingBuffer<support_state_t> & SupportStates_deq )
 {
 
   IntermedQPMat::state_variant_t & State = IntermedData_->State();
@@ -144,19 +144,19 @@ GeneratorVelRef::generate_selection_matrices( const std::deque<support_state_t>
 
   State.VcX.setZero();
   State.VcY.setZero();
-  State.V.resize(N_,NbPrwSteps);
+  StoragePool_.resize(State.V,N_,NbPrwSteps);
   State.V.setZero();
-  State.VT.resize(NbPrwSteps,N_);
+  StoragePool_.resize(State.VT,NbPrwSteps,N_);
   State.VT.setZero();
-  State.Vc_fX.resize(NbPrwSteps);
+  StoragePool_.resize(State.Vc_fX,NbPrwSteps);
   State.Vc_fX.setZero();
-  State.Vc_fY.resize(NbPrwSteps);
+  StoragePool_.resize(State.Vc_fY,NbPrwSteps);
   State.Vc_fY.setZero();
-  State.V_f.resize(NbPrwSteps,NbPrwSteps);
+  StoragePool_.resize(State.V_f,NbPrwSteps,NbPrwSteps);
   State.V_f.setZero();
 
 
-  std::deque<support_state_t>::const_iterator SS_it;
+  RingBuffer<support_state_t>::const_iterator SS_it;
   SS_it = SupportStates_deq.begin();//points at the cur. sup. st.
   ++SS_it;
   for(unsigned i=0;i<N_;i++)
@@ -190,7 +190,7 @@ GeneratorVelRef::generate_selection_matrices( const std::deque<support_state_t>
 
   State.VcshiftX.setZero();
   State.VcshiftY.setZero();
-  State.Vshift.resize(N_,NbPrwSteps);
+  StoragePool_.resize(State.Vshift,N_,NbPrwSteps);
   State.Vshift.setZero();
   SS_it = SupportStates_deq.begin();
   State.VcshiftX(0) = SS_it->X;
@@ -284,19 +284,18 @@ GeneratorVelRef::initialize_matrices( linear_inequality_t & Inequalities)
 
 void
 GeneratorVelRef::build_inequalities_cop(linear_inequality_t & Inequalities,
-    const std::deque<support_state_t> & SupportStates_deq) const
+    const RingBuffer<support_state_t> & SupportStates_deq)
 {
 
-  deque<support_state_t>::const_iterator prwSS_it = SupportStates_deq.begin();
+  RingBuffer<support_state_t>::const_iterator prwSS_it = SupportStates_deq.begin();
 
   const unsigned nbEdges = 4;
   const unsigned nbIneq = 4;
-  convex_hull_t CoPHull( nbEdges, nbIneq );
+  convex_hull_t & CoPHull = CoPHull_;
+  CoPHull.resize( nbEdges, nbIneq );
   RFI_->set_vertices( CoPHull, *prwSS_it, INEQ_COP );
 
   ++prwSS_it;//Point at the first previewed instant
-  Inequalities.D.X_mat.reserve(N_*nbEdges);
-  Inequalities.D.Y_mat.reserve(N_*nbEdges);
 
   for( unsigned i=0; i<N_; i++ )
     {
@@ -315,8 +314,8 @@ GeneratorVelRef::build_inequalities_cop(linear_inequality_t & Inequalities,
 //      cout << "linear system \n";
       for( unsigned j = 0; j < nbEdges; j++ )
         {
-          Inequalities.D.X_mat.insert( i*nbEdges+j, i)= CoPHull.A_vec[j] ;
-	  Inequalities.D.Y_mat.insert( i*nbEdges+j, i)= CoPHull.B_vec[j] ;
+          Inequalities.D.X_mat( i*nbEdges+j, i)= CoPHull.A_vec[j] ;
+	  Inequalities.D.Y_mat( i*nbEdges+j, i)= CoPHull.B_vec[j] ;
           Inequalities.Dc_vec( i*nbEdges+j ) = CoPHull.D_vec[j];
 //          cout << CoPHull.A_vec[j] << " " << CoPHull.B_vec[j] << " " << CoPHull.D_vec[j] << endl;
         }
@@ -329,21 +328,26 @@ GeneratorVelRef::build_inequalities_cop(linear_inequality_t & Inequalities,
 
 void
 GeneratorVelRef::build_inequalities_feet( linear_inequality_t & Inequalities,
-    const std::deque<support_state_t> & SupportStates_deq ) const
+    const RingBuffer<support_state_t> & SupportStates_deq )
 {
 
   // Arrays for the generated set of inequalities
   const unsigned nbEdges = 5;
   const unsigned nbIneq = 5;
-  convex_hull_t FeetHull( nbEdges, nbIneq );
+  convex_hull_t & FeetHull = FeetHull_;
+  FeetHull.resize( nbEdges, nbIneq );
 
   unsigned nbSteps = SupportStates_deq.back().StepNumber;
-  Inequalities.resize(nbEdges*nbSteps,nbSteps, false);
-
-  deque<support_state_t>::const_iterator prwSS_it = SupportStates_deq.begin();
+  StoragePool_.resize( Inequalities.D.X_mat, nbEdges*nbSteps, nbSteps );
+  StoragePool_.resize( Inequalities.D.Y_mat, nbEdges*nbSteps, nbSteps );
+  StoragePool_.resize( Inequalities.D.Z_mat, nbEdges*nbSteps, nbSteps );
+  StoragePool_.resize( Inequalities.Dc_vec, nbEdges*nbSteps );
+  Inequalities.D.X_mat.setZero();
+  Inequalities.D.Y_mat.setZero();
+  Inequalities.D.Z_mat.setZero();
+
+  RingBuffer<support_state_t>::const_iterator prwSS_it = SupportStates_deq.begin();
   prwSS_it++;//Point at the first previewed instant
-  Inequalities.D.X_mat.reserve(N_*nbEdges);
-  Inequalities.D.Y_mat.reserve(N_*nbEdges);  
   for( unsigned i=0; i<N_; i++ )
     {
       //foot positioning constraints
@@ -364,8 +368,8 @@ GeneratorVelRef::build_inequalities_feet( linear_inequality_t & Inequalities,
           //cout << "linear system \n";
           for( unsigned j = 0; j < nbEdges; j++ )
           {
-            Inequalities.D.X_mat.insert ((prwSS_it->StepNumber-1)*nbEdges+j, (prwSS_it->StepNumber-1))= FeetHull.A_vec[j] ;
-	    Inequalities.D.Y_mat.insert ((prwSS_it->StepNumber-1)*nbEdges+j, (prwSS_it->StepNumber-1))= FeetHull.B_vec[j] ;
+            Inequalities.D.X_mat((prwSS_it->StepNumber-1)*nbEdges+j, (prwSS_it->StepNumber-1))= FeetHull.A_vec[j] ;
+	    Inequalities.D.Y_mat((prwSS_it->StepNumber-1)*nbEdges+j, (prwSS_it->StepNumber-1))= FeetHull.B_vec[j] ;
             Inequalities.Dc_vec( (prwSS_it->StepNumber-1)*nbEdges+j ) = FeetHull.D_vec[j];
 //            cout << FeetHull.A_vec[j] << " " << FeetHull.B_vec[j] << " " << FeetHull.D_vec[j] << endl;
           }
@@ -379,10 +383,10 @@ GeneratorVelRef::build_inequalities_feet( linear_inequality_t & Inequalities,
 
 void
 GeneratorVelRef::build_inequalities_com(linear_inequality_t & Inequalities,
-    const std::deque<support_state_t> & SupportStates_deq) const
+    const RingBuffer<support_state_t> & SupportStates_deq) const
 {
 
-  deque<support_state_t>::const_iterator prwSS_it = SupportStates_deq.begin();
+  RingBuffer<support_state_t>::const_iterator prwSS_it = SupportStates_deq.begin();
 
   const unsigned nbEdges = 0;
   const unsigned nbIneq = 10;
@@ -391,7 +395,6 @@ GeneratorVelRef::build_inequalities_com(linear_inequality_t & Inequalities,
 
   ++prwSS_it;//Point at the first previewed instant
   unsigned nbIneqsSet = 0;
-  Inequalities.D.X_mat.reserve(N_*nbIneq);
   
   for( unsigned i=0; i<N_; ++i )
     {
@@ -401,9 +404,9 @@ GeneratorVelRef::build_inequalities_com(linear_inequality_t & Inequalities,
 
           for( unsigned j = 0; j < nbIneq; j++ )
             {
-              Inequalities.D.X_mat.insert( nbIneqsSet+j, i)= CoPHull.A_vec[j] ;
-	      Inequalities.D.Y_mat.insert( nbIneqsSet+j, i)= CoPHull.B_vec[j] ;
-	      Inequalities.D.Z_mat.insert( nbIneqsSet+j, 0)= CoPHull.C_vec[j] ;
+              Inequalities.D.X_mat( nbIneqsSet+j, i)= CoPHull.A_vec[j] ;
+	      Inequalities.D.Y_mat( nbIneqsSet+j, i)= CoPHull.B_vec[j] ;
+	      Inequalities.D.Z_mat( nbIneqsSet+j, 0)= CoPHull.C_vec[j] ;
               Inequalities.Dc_vec( i*nbEdges+j ) = CoPHull.D_vec[j];
             }
           nbIneqsSet+=nbIneq;
@@ -546,19 +549,19 @@ GeneratorVelRef::build_constraints_com( const linear_inequality_t & IneqCoM,
 
 
 void
-GeneratorVelRef::build_eq_constraints_feet( const std::deque<support_state_t> & SupportStates_deq,
+GeneratorVelRef::build_eq_constraints_feet( const RingBuffer<support_state_t> & SupportStates_deq,
     unsigned int NbStepsPreviewed, QPProblem & Pb )
 {
 
   if(SupportStates_deq.front().StateChanged)
     Robot_->SupportTrajectory().pop_front();
-  std::deque<support_state_t>::const_iterator SPTraj_it = Robot_->SupportTrajectory().begin();
+  RingBuffer<support_state_t>::const_iterator SPTraj_it = Robot_->SupportTrajectory().begin();
 
-  Eigen::MatrixXd EqualityMatrix;
-  Eigen::VectorXd EqualityVector;
+  Eigen::MatrixXd & EqualityMatrix = EqualityMatrix_;
+  Eigen::VectorXd & EqualityVector = EqualityVector_;
   EqualityMatrix.resize(2,2*NbStepsPreviewed);
   EqualityMatrix.setZero();
-  EqualityVector.resize(2, false);
+  EqualityVector.resize(2);
   EqualityVector.setZero();
   Pb.NbEqConstraints(2*NbStepsPreviewed);
   for(unsigned int i = 0; i< NbStepsPreviewed; i++)
@@ -574,9 +577,10 @@ GeneratorVelRef::build_eq_constraints_feet( const std::deque<support_state_t> &
 
 }
 
-void GeneratorVelRef::build_eq_constraints_limitPosFeet(const solution_t & Solution,QPProblem & Pb)
+bool
+GeneratorVelRef::first_step_fixed( const solution_t & Solution ) const
 {
-  std::deque<support_state_t>::const_iterator SPTraj_it = Solution.SupportStates_deq.begin();
+  RingBuffer<support_state_t>::const_iterator SPTraj_it = Solution.SupportStates_deq.begin();
   int ItBeforeLanding = 0 ;
   while(SPTraj_it!=Solution.SupportStates_deq.end())
   {
@@ -592,16 +596,22 @@ void GeneratorVelRef::build_eq_constraints_limitPosFeet(const solution_t & Solut
   }
   int ItBeforeLandingThresh = 2 ;
   unsigned NbStepsPreviewed = Solution.SupportStates_deq.back().StepNumber;
-  if( ItBeforeLanding <= ItBeforeLandingThresh && ItBeforeLanding > 0 && Solution.SupportStates_deq.front().Phase == SS
-      && Solution.SupportStates_deq.front().StateChanged != 1 && NbStepsPreviewed > 0 )
+  return ( ItBeforeLanding <= ItBeforeLandingThresh && ItBeforeLanding > 0 && Solution.SupportStates_deq.front().Phase == SS
+      && Solution.SupportStates_deq.front().StateChanged != 1 && NbStepsPreviewed > 0 );
+}
+
+void GeneratorVelRef::build_eq_constraints_limitPosFeet(const solution_t & Solution,QPProblem & Pb)
+{
+  unsigned NbStepsPreviewed = Solution.SupportStates_deq.back().StepNumber;
+  if( first_step_fixed( Solution ) )
   {
     unsigned int NbConstraints = Pb.NbConstraints();
-    Eigen::MatrixXd EqualityMatrix;
-    Eigen::VectorXd EqualityVector;
+    Eigen::MatrixXd & EqualityMatrix = EqualityMatrix_;
+    Eigen::VectorXd & EqualityVector = EqualityVector_;
 
-    EqualityMatrix.resize(2,2*N_+2*NbStepsPreviewed);
+    StoragePool_.resize(EqualityMatrix,2,2*N_+2*NbStepsPreviewed);
     EqualityMatrix.setZero();
-    EqualityVector.resize(2, false);
+    EqualityVector.resize(2);
     EqualityVector.setZero();
 
     EqualityMatrix(0,2*N_) =  1.0;                  EqualityVector(0) =  -LastFootSolX_ ;
@@ -659,34 +669,138 @@ void
 GeneratorVelRef::build_invariant_part( QPProblem & Pb )
 {
 
+  //Constant terms in the Hessian
+  const hessian_entry_t & Invariant = invariant_hessian();
+  Pb.add_term_to( MATRIX_Q, Invariant.Q, 0, 0                           );
+  Pb.add_term_to( MATRIX_Q, Invariant.Q, N_, N_                         );
+
+}
+
+
+void
+GeneratorVelRef::hessian_key( hessian_key_t & Key ) const
+{
+
+  Key.N = N_;
+  Key.T = Tprw_;
+  Key.CoMHeight = Robot_->CoMHeight();
+  Key.Weights[0] = IntermedData_->Objective( JERK_MIN ).weight;
+  Key.Weights[1] = IntermedData_->Objective( INSTANT_VELOCITY ).weight;
+  Key.Weights[2] = IntermedData_->Objective( COP_CENTERING ).weight;
+
+}
+
+
+const hessian_entry_t &
+GeneratorVelRef::invariant_hessian()
+{
+
+  hessian_key( InvariantKey_ );
+  InvariantKey_.Pattern.clear();
+  const hessian_entry_t * Entry = HessianCache_.find( InvariantKey_ );
+  if( Entry != 0 )
+    return *Entry;
+
   const RigidBody & CoM = Robot_->CoM();
 
-  //Constant terms in the Hessian
   // +a*U'*U
   const IntermedQPMat::objective_variant_t & Jerk = IntermedData_->Objective( JERK_MIN );
   const linear_dynamics_t & JerkDynamics = CoM.Dynamics( JERK );
   compute_term  ( MM_, Jerk.weight, JerkDynamics.UT, JerkDynamics.U     );
-  Pb.add_term_to( MATRIX_Q, MM_, 0, 0                                   );
-  Pb.add_term_to( MATRIX_Q, MM_, N_, N_                                 );
+  Eigen::MatrixXd Q = MM_;
 
   // +a*U'*U
   const IntermedQPMat::objective_variant_t & InstVel = IntermedData_->Objective( INSTANT_VELOCITY );
   const linear_dynamics_t & VelDynamics = CoM.Dynamics( VELOCITY );
   compute_term  ( MM_, InstVel.weight, VelDynamics.UT, VelDynamics.U    );
-  Pb.add_term_to( MATRIX_Q, MM_, 0, 0                                   );
-  Pb.add_term_to( MATRIX_Q, MM_, N_, N_                                 );
+  Q += MM_;
 
   // +a*U'*U
   const IntermedQPMat::objective_variant_t & COPCent = IntermedData_->Objective( COP_CENTERING );
   compute_term  ( MM_, COPCent.weight, Robot_->DynamicsCoPJerk().UT, Robot_->DynamicsCoPJerk().U        );
-  Pb.add_term_to( MATRIX_Q, MM_, 0, 0                                                                   );
-  Pb.add_term_to( MATRIX_Q, MM_, N_, N_                                                                 );
+  Q += MM_;
+
+  return HessianCache_.insert( InvariantKey_, Q );
+
+}
+
+
+const hessian_entry_t &
+GeneratorVelRef::pattern_hessian( const RingBuffer<support_state_t> & SupportStates_deq )
+{
+
+  hessian_key( PatternKey_ );
+  PatternKey_.Pattern.resize( N_ );
+  RingBuffer<support_state_t>::const_iterator SS_it = SupportStates_deq.begin();
+  for( unsigned i = 0; i < N_; i++ )
+    {
+      ++SS_it;
+      PatternKey_.Pattern[i] = SS_it->StepNumber;
+    }
+  const hessian_entry_t * Entry = HessianCache_.find( PatternKey_ );
+  if( Entry != 0 )
+    return *Entry;
+
+  unsigned nbStepsPreviewed = SupportStates_deq.back().StepNumber;
+  const IntermedQPMat::state_variant_t & State = IntermedData_->State();
+  const IntermedQPMat::objective_variant_t & COPCent = IntermedData_->Objective( COP_CENTERING );
+  const linear_dynamics_t & CoPDynamics = Robot_->DynamicsCoPJerk( );
+
+  Eigen::MatrixXd Q( N_+nbStepsPreviewed, N_+nbStepsPreviewed );
+  Q.topLeftCorner( N_, N_ ) = invariant_hessian().Q;
+  // -a*U'*V
+  compute_term  ( MM_, -COPCent.weight, CoPDynamics.UT, State.V         );
+  Q.topRightCorner( N_, nbStepsPreviewed ) = MM_;
+  // -a*V*U
+  compute_term  ( MM_, -COPCent.weight, State.VT, CoPDynamics.U         );
+  Q.bottomLeftCorner( nbStepsPreviewed, N_ ) = MM_;
+  //+a*V'*V
+  compute_term  ( MM_, COPCent.weight, State.VT, State.V                );
+  Q.bottomRightCorner( nbStepsPreviewed, nbStepsPreviewed ) = MM_;
+
+  return HessianCache_.insert( PatternKey_, Q );
 
 }
 
 
 void
-GeneratorVelRef::update_problem( QPProblem & Pb, const std::deque<support_state_t> & SupportStates_deq )
+GeneratorVelRef::set_hessian_factorization( const hessian_entry_t & Hessian,
+    unsigned int NbStepsPreviewed, QPProblem & Pb )
+{
+
+  if( Hessian.Rinv.size() == 0 )
+    return;
+
+  // The variables are (jerks x, jerks y, feet x, feet y):
+  // index i of the Hessian of one coordinate is i (x) or N+i (y)
+  // for a jerk, N+i (x) or N+NbStepsPreviewed+i (y) for a foot.
+  unsigned n = N_+NbStepsPreviewed;
+  StoragePool_.resize( FullQ_, 2*n, 2*n );
+  FullQ_.setZero();
+  StoragePool_.resize( FullJ0_, 2*n, 2*n );
+  FullJ0_.setZero();
+  for( unsigned Coord = 0; Coord < 2; Coord++ )
+    {
+      unsigned JerkOffset = Coord*N_;
+      unsigned FootOffset = 2*N_+Coord*NbStepsPreviewed;
+      for( unsigned j = 0; j < n; j++ )
+        {
+          unsigned Col = ( j < N_ ) ? JerkOffset+j : FootOffset+j-N_;
+          for( unsigned i = 0; i < n; i++ )
+            {
+              unsigned Row = ( i < N_ ) ? JerkOffset+i : FootOffset+i-N_;
+              FullQ_( Row, Col ) = Hessian.Q( i, j );
+              FullJ0_( Row, Col ) = Hessian.Rinv( i, j );
+            }
+        }
+    }
+  Pb.hessian_factorization( FullQ_, FullJ0_ );
+
+}
+
+
+void
+GeneratorVelRef::update_problem( QPProblem & Pb, const RingBuffer<support_state_t> & SupportStates_deq )
 {
 
   Pb.clear(VECTOR_D);
@@ -717,20 +831,25 @@ GeneratorVelRef::update_problem( QPProblem & Pb, const std::deque<support_state_
   const linear_dynamics_t & CoPDynamics = Robot_->DynamicsCoPJerk( );
   //  const linear_dynamics_t & LFCoP = Robot_->LeftFoot().Dynamics(COP);
   //  const linear_dynamics_t & RFCoP = Robot_->RightFoot().Dynamics(COP);
-  // Hessian
+  // Hessian, built once for each pattern of support phases
+  const hessian_entry_t & Hessian = pattern_hessian( SupportStates_deq );
   // -a*U'*V
-  compute_term  ( MM_, -COPCent.weight, CoPDynamics.UT, State.V         );
+  StoragePool_.resize( MM_, N_, nbStepsPreviewed );
+  MM_ = Hessian.Q.topRightCorner( N_, nbStepsPreviewed );
   Pb.add_term_to(  MATRIX_Q, MM_, 0, 2*N_                               );
   Pb.add_term_to(  MATRIX_Q, MM_, N_, 2*N_+nbStepsPreviewed             );
 
   // -a*V*U
-  compute_term  ( MM_, -COPCent.weight, State.VT, CoPDynamics.U                );
+  StoragePool_.resize( MM_, nbStepsPreviewed, N_ );
+  MM_ = Hessian.Q.bottomLeftCorner( nbStepsPreviewed, N_ );
   Pb.add_term_to( MATRIX_Q, MM_, 2*N_, 0                                       );
   Pb.add_term_to( MATRIX_Q, MM_, 2*N_+nbStepsPreviewed, N_                     );
   //+a*V'*V
-  compute_term  ( MM_, COPCent.weight, State.VT, State.V                       );
+  StoragePool_.resize( MM_, nbStepsPreviewed, nbStepsPreviewed );
+  MM_ = Hessian.Q.bottomRightCorner( nbStepsPreviewed, nbStepsPreviewed );
   Pb.add_term_to( MATRIX_Q, MM_, 2*N_, 2*N_                                    );
   Pb.add_term_to( MATRIX_Q, MM_, 2*N_+nbStepsPreviewed, 2*N_+nbStepsPreviewed  );
+  set_hessian_factorization( Hessian, nbStepsPreviewed, Pb );
 
   //Linear part
   // -a*V'*S*x
@@ -768,7 +887,7 @@ GeneratorVelRef::compute_warm_start( solution_t & Solution )
 
   // Compute initial ZMP and foot positions:
   // ---------------------------------------
-  deque<support_state_t>::iterator prwSS_it = Solution.SupportStates_deq.begin();
+  RingBuffer<support_state_t>::iterator prwSS_it = Solution.SupportStates_deq.begin();
   prwSS_it++;//Point at the first previewed support state
   unsigned int j = 0;
   for(unsigned int i=0; i<N_; i++)
@@ -820,41 +939,210 @@ GeneratorVelRef::compute_warm_start( solution_t & Solution )
 
 
 
+void
+GeneratorVelRef::build_stage_problem( RiccatiQP & Pb, const solution_t & Solution )
+{
+
+  const RingBuffer<support_state_t> & SupportStates_deq = Solution.SupportStates_deq;
+  const IntermedQPMat::state_variant_t & State = IntermedData_->State();
+  const double T = Robot_->SamplingPeriodSim();
+  const double hg = Robot_->CoMHeight()/9.81;
+  // Weight of the foot displacements outside of the step changes,
+  // which are not used by the problem.
+  const double FootRegularization = 1e-10;
+
+  const double JerkWeight = IntermedData_->Objective( JERK_MIN ).weight;
+  const double VelWeight = IntermedData_->Objective( INSTANT_VELOCITY ).weight;
+  const double CoPWeight = IntermedData_->Objective( COP_CENTERING ).weight;
+
+  Pb.resize( N_, 8, 4 );
+
+  Eigen::VectorXd & x0 = Pb.InitialState();
+  x0.segment(0,3) = State.CoM.x;
+  x0.segment(3,3) = State.CoM.y;
+  x0(6) = SupportStates_deq.front().X;
+  x0(7) = SupportStates_deq.front().Y;
+
+  const unsigned nbEdges = 4;
+  convex_hull_t & CoPHull = CoPHull_;
+  CoPHull.resize( nbEdges, nbEdges );
+  RFI_->set_vertices( CoPHull, SupportStates_deq.front(), INEQ_COP );
+  const unsigned nbFeetEdges = 5;
+  convex_hull_t & FeetHull = FeetHull_;
+  FeetHull.resize( nbFeetEdges, nbFeetEdges );
+  bool FirstStepFixed = first_step_fixed( Solution );
+
+  RingBuffer<support_state_t>::const_iterator prwSS_it = SupportStates_deq.begin();
+  for( unsigned k=0; k<N_; k++ )
+    {
+      const support_state_t & Current = *prwSS_it;
+      ++prwSS_it;
+      const support_state_t & Next = *prwSS_it;
+
+      // Transition from sample k to sample k+1:
+      // ---------------------------------------
+      RiccatiQP::stage_t & Stage = Pb.stage(k);
+      for( unsigned c=0; c<2; c++ )
+        {
+          Stage.A(3*c,3*c+1) = T; Stage.A(3*c,3*c+2) = T*T/2;
+          Stage.A(3*c+1,3*c+2) = T;
+          Stage.B(3*c,c) = T*T*T/6; Stage.B(3*c+1,c) = T*T/2;
+          Stage.B(3*c+2,c) = T;
+        }
+      Stage.R(0,0) = Stage.R(1,1) = JerkWeight;
+
+      if( Next.StepNumber>Current.StepNumber )
+        {
+          if( FirstStepFixed && Next.StepNumber==1 )
+            {
+              Stage.b(6) = LastFootSolX_-x0(6);
+              Stage.b(7) = LastFootSolY_-x0(7);
+            }
+          else
+            {
+              Stage.B(6,2) = Stage.B(7,3) = 1.0;
+              if( Next.StateChanged && Next.Phase != DS )
+                {
+                  // -D*p+dc > 0
+                  RFI_->set_vertices( FeetHull, Current, INEQ_FEET );
+                  RFI_->compute_linear_system( FeetHull, Next );
+                  Pb.NbInequalities( k, nbFeetEdges );
+                  for( unsigned j=0; j<nbFeetEdges; j++ )
+                    {
+                      Stage.D(j,2) = -FeetHull.A_vec[j];
+                      Stage.D(j,3) = -FeetHull.B_vec[j];
+                      Stage.d(j) = FeetHull.D_vec[j];
+                    }
+                }
+            }
+        }
+      if( Stage.B(6,2)==0.0 )
+        Stage.R(2,2) = Stage.R(3,3) = FootRegularization;
+
+      // Sample k+1:
+      // -----------
+      RiccatiQP::stage_t & NextStage = Pb.stage(k+1);
+      // Instant velocity
+      NextStage.Q(1,1) = NextStage.Q(4,4) = VelWeight;
+      NextStage.q(1) = -VelWeight*State.Ref.Global.X_vec(k);
+      NextStage.q(4) = -VelWeight*State.Ref.Global.Y_vec(k);
+      // CoP centering: a*(z-f)^2 with z = c-h/g*ddc
+      for( unsigned c=0; c<2; c++ )
+        {
+          unsigned Rows[3] = { 3*c, 3*c+2, 6+c };
+          double e[3] = { 1.0, -hg, -1.0 };
+          for( unsigned i=0; i<3; i++ )
+            for( unsigned j=0; j<3; j++ )
+              NextStage.Q(Rows[i],Rows[j]) += CoPWeight*e[i]*e[j];
+        }
+
+      // D*(f-z)+dc > 0
+      if( Next.StateChanged )
+        RFI_->set_vertices( CoPHull, Next, INEQ_COP );
+      RFI_->compute_linear_system( CoPHull, Next );
+      Pb.NbInequalities( k+1, nbEdges );
+      for( unsigned j=0; j<nbEdges; j++ )
+        {
+          NextStage.C(j,0) = -CoPHull.A_vec[j];
+          NextStage.C(j,2) = hg*CoPHull.A_vec[j];
+          NextStage.C(j,3) = -CoPHull.B_vec[j];
+          NextStage.C(j,5) = hg*CoPHull.B_vec[j];
+          NextStage.C(j,6) = CoPHull.A_vec[j];
+          NextStage.C(j,7) = CoPHull.B_vec[j];
+          NextStage.d(j) = CoPHull.D_vec[j];
+        }
+    }
+
+  // Same cost as the condensed problem:
+  // update_problem omits the gradient +a*U'*(S*x-Vc*fc) of the
+  // CoP centering with respect to the jerks, it is cancelled here.
+  const linear_dynamics_t & CoPDynamics = Robot_->DynamicsCoPJerk( );
+  MV2_.noalias() = CoPDynamics.S*State.CoM.x;
+  MV2_ -= State.VcX;
+  compute_term  ( MV_, -CoPWeight, CoPDynamics.UT, MV2_ );
+  for( unsigned k=0; k<N_; k++ )
+    Pb.stage(k).r(0) = MV_(k);
+  MV2_.noalias() = CoPDynamics.S*State.CoM.y;
+  MV2_ -= State.VcY;
+  compute_term  ( MV_, -CoPWeight, CoPDynamics.UT, MV2_ );
+  for( unsigned k=0; k<N_; k++ )
+    Pb.stage(k).r(1) = MV_(k);
+
+}
+
+
+void
+GeneratorVelRef::stage_solution( const RiccatiQP & Pb, solution_t & Solution ) const
+{
+
+  const RingBuffer<support_state_t> & SupportStates_deq = Solution.SupportStates_deq;
+  unsigned nbSteps = SupportStates_deq.back().StepNumber;
+  Solution.resize( 2*N_+2*nbSteps, 0 );
+
+  for( unsigned k=0; k<N_; k++ )
+    {
+      const RiccatiQP::stage_t & Stage = Pb.stage(k);
+      Solution.Solution_vec(k) = Stage.u(0);
+      Solution.Solution_vec(N_+k) = Stage.u(1);
+
+      // Position of the foot at the first sample of each step
+      unsigned Step = SupportStates_deq[k+1].StepNumber;
+      if( Step>SupportStates_deq[k].StepNumber )
+        {
+          const Eigen::VectorXd & x = Pb.stage(k+1).x;
+          Solution.Solution_vec(2*N_+Step-1) = x(6);
+          Solution.Solution_vec(2*N_+nbSteps+Step-1) = x(7);
+        }
+    }
+  Solution.NbIterations = Pb.NbIterations();
+
+}
+
+
+template <typename Matrix1, typename Matrix2>
 void
 GeneratorVelRef::compute_term(Eigen::MatrixXd &weightMM, double weight,
-    const Eigen::MatrixXd &M1, const Eigen::MatrixXd &M2)
+    const Eigen::MatrixBase<Matrix1> &M1, const Eigen::MatrixBase<Matrix2> &M2)
 {
-  weightMM = M1*M2;
+  StoragePool_.resize( weightMM, M1.rows(), M2.cols() );
+  weightMM.noalias() = M1*M2;
   weightMM *= weight;
 }
 
 
+template <typename Matrix>
 void
 GeneratorVelRef::compute_term(Eigen::VectorXd &weightMV, double weight,
-    const Eigen::MatrixXd &M, const Eigen::VectorXd &V)
+    const Eigen::MatrixBase<Matrix> &M, const Eigen::VectorXd &V)
 {
-  weightMV = M*V;
+  StoragePool_.resize( weightMV, M.rows() );
+  weightMV.noalias() = M*V;
   weightMV *= weight;
 }
 
 
+template <typename Matrix>
 void
 GeneratorVelRef::compute_term(Eigen::VectorXd &weightMV,
-    double weight, const Eigen::MatrixXd &M,
+    double weight, const Eigen::MatrixBase<Matrix> &M,
     const Eigen::VectorXd &V, double scalar)
 {
-  weightMV = M*V;
+  StoragePool_.resize( weightMV, M.rows() );
+  weightMV.noalias() = M*V;
   weightMV *= weight*scalar;
 }
 
 
+template <typename Matrix1, typename Matrix2>
 void
 GeneratorVelRef::compute_term(Eigen::VectorXd &weightMV,
-    double weight, const Eigen::MatrixXd &M1,
-    const Eigen::MatrixXd &M2, const Eigen::VectorXd &V2)
+    double weight, const Eigen::MatrixBase<Matrix1> &M1,
+    const Eigen::MatrixBase<Matrix2> &M2, const Eigen::VectorXd &V2)
 {
-  MV2_ = M2*V2;
-  weightMV = M1*MV2_;
+  StoragePool_.resize( MV2_, M2.rows() );
+  MV2_.noalias() = M2*V2;
+  StoragePool_.resize( weightMV, M1.rows() );
+  weightMV.noalias() = M1*MV2_;
   weightMV *= weight;
 }
 
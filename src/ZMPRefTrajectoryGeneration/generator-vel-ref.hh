@@ -33,6 +33,8 @@
 
 #include <jrl/walkgen/pinocchiorobot.hh>
 #include <ZMPRefTrajectoryGeneration/qp-problem.hh>
+#include <ZMPRefTrajectoryGeneration/hessian-cache.hh>
+#include <Mathematics/riccati-qp.hh>
 #include <PreviewControl/SupportFSM.hh>
 #include <PreviewControl/LinearizedInvertedPendulum2D.hh>
 #include <PreviewControl/rigid-body-system.hh>
@@ -41,6 +43,7 @@
 #include <Mathematics/relative-feet-inequalities.hh>
 
 #include <privatepgtypes.hh>
+#include <MatrixStoragePool.hh>
 #include <cmath>
 
 namespace PatternGeneratorJRL
@@ -70,8 +73,8 @@ namespace PatternGeneratorJRL
     /// \param[in] FinalRightFootTraj_deq
     /// \param[out] SupportStates_deq
     void preview_support_states( double Time, const SupportFSM * FSM,
-        const deque<FootAbsolutePosition> & FinalLeftFootTraj_deq, const deque<FootAbsolutePosition> & FinalRightFootTraj_deq,
-        deque<support_state_t> & SupportStates_deq );
+        const RingBuffer<FootAbsolutePosition> & FinalLeftFootTraj_deq, const RingBuffer<FootAbsolutePosition> & FinalRightFootTraj_deq,
+        RingBuffer<support_state_t> & SupportStates_deq );
 
     /// \brief Set the global reference from the local one and the orientation of the trunk frame
     /// for the whole preview window
@@ -98,13 +101,32 @@ namespace PatternGeneratorJRL
     ///
     /// \param[in] Pb
     /// \param[in] SupportStates_deq
-    void update_problem( QPProblem & Pb, const std::deque<support_state_t> & SupportStates_deq );
+    void update_problem( QPProblem & Pb, const RingBuffer<support_state_t> & SupportStates_deq );
 
     /// \brief Compute the initial solution vector for warm start
     ///
     /// \param[in] Solution
     void compute_warm_start( solution_t & Solution );
 
+    /// \brief Build the problem with the states kept as variables.
+    /// The state is (c_x, dc_x, ddc_x, c_y, dc_y, ddc_y, f_x, f_y) where f
+    /// is the support foot, the input is (dddc_x, dddc_y, p_x, p_y) where
+    /// p is the displacement of the support foot when a step starts.
+    /// The cost is the one of the condensed problem built by
+    /// update_problem, whose CoP centering term has no gradient
+    /// with respect to the jerks.
+    ///
+    /// \param[out] Pb
+    /// \param[in] Solution
+    void build_stage_problem( RiccatiQP & Pb, const solution_t & Solution );
+
+    /// \brief Set the solution vector of the condensed problem
+    /// (jerks and feet positions) from the solution of the stages.
+    ///
+    /// \param[in] Pb
+    /// \param[out] Solution
+    void stage_solution( const RiccatiQP & Pb, solution_t & Solution ) const;
+
     /// \name Accessors
     /// \{
     /// \brief Set the weights on an objective term
@@ -113,6 +135,11 @@ namespace PatternGeneratorJRL
     /// \param[in] Type Objective type
     void Ponderation(double weight, objective_e type );
 
+    /// \brief Hessians built for the previous horizons, weights
+    /// and support phases
+    inline HessianCache & Hessians()
+    { return HessianCache_; };
+
     inline void Reference(const reference_t & Ref)
     {  IntermedData_->Reference(Ref); };
     inline void SupportState(const support_state_t & SupportState)
@@ -133,6 +160,10 @@ namespace PatternGeneratorJRL
         LastFootSolY_ = 0.0 ;
       }
     }
+    inline void LastFootSol(double & X, double & Y) const
+    { X = LastFootSolX_; Y = LastFootSolY_; }
+    inline void LastFootSol(double X, double Y)
+    { LastFootSolX_ = X; LastFootSolY_ = Y; }
 
     /// \}
 
@@ -142,24 +173,28 @@ namespace PatternGeneratorJRL
     /// \param[out] Inequalities
     /// \param[in] SupportStates_deq
     void build_inequalities_feet(linear_inequality_t & Inequalities,
-        const std::deque<support_state_t> & SupportStates_deq) const;
+        const RingBuffer<support_state_t> & SupportStates_deq);
 
     //
     // Protected methods
     //
   protected:
 
+    /// \brief True if the next foot lands in less than three samples.
+    /// Its position is then fixed to the last solution.
+    bool first_step_fixed( const solution_t & Solution ) const;
+
     /// \brief Compute the selection matrices
     ///
     /// \param[in] SupportStates_deq
-    void generate_selection_matrices( const std::deque<support_state_t> & SupportStates_deq);
+    void generate_selection_matrices( const RingBuffer<support_state_t> & SupportStates_deq);
 
     /// \brief Generate a queue of inequalities with respect to the centers of the feet
     ///
     /// \param[out] Inequalities
     /// \param[in] SupportStates_deq
     void build_inequalities_cop(linear_inequality_t & Inequalities,
-        const std::deque<support_state_t> & SupportStates_deq) const;
+        const RingBuffer<support_state_t> & SupportStates_deq);
 
     /// \brief Generate a queue of inequality constraints on
     /// the feet positions with respect to previous foot positions
@@ -167,7 +202,7 @@ namespace PatternGeneratorJRL
     /// \param[out] Inequalities In matrix form
     /// \param[in] SupportStates_deq
     void build_inequalities_com(linear_inequality_t & Inequalities,
-        const std::deque<support_state_t> & SupportStates_deq) const;
+        const RingBuffer<support_state_t> & SupportStates_deq) const;
 
     /// \brief Compute CoP constraints corresponding to the set of inequalities
     ///
@@ -199,7 +234,7 @@ namespace PatternGeneratorJRL
     /// \param[in] SupportStates_deq
     /// \param[in] NbStepsPreviewed
     /// \param[out] Pb
-    void build_eq_constraints_feet( const std::deque<support_state_t> & SupportStates_deq,
+    void build_eq_constraints_feet( const RingBuffer<support_state_t> & SupportStates_deq,
         unsigned int NbStepsPreviewed, QPProblem & Pb );
 
     /// \brief Compute feet equality constraints to restrain the previewed foot position
@@ -213,31 +248,63 @@ namespace PatternGeneratorJRL
     /// \param[out] Inequalities
     void initialize_matrices( linear_inequality_t & Inequalities);
 
+    /// \brief Horizon, CoM height and weights of the current problem
+    ///
+    /// \param[out] Key
+    void hessian_key( hessian_key_t & Key ) const;
+
+    /// \brief Constant part of the Hessian of one coordinate,
+    /// taken from the cache or built
+    const hessian_entry_t & invariant_hessian();
+
+    /// \brief Hessian of one coordinate for the previewed support states,
+    /// taken from the cache or built
+    ///
+    /// \param[in] SupportStates_deq
+    const hessian_entry_t & pattern_hessian( const RingBuffer<support_state_t> & SupportStates_deq );
+
+    /// \brief Give the factorization of the Hessian to the solver
+    ///
+    /// \param[in] Hessian Hessian of one coordinate
+    /// \param[in] NbStepsPreviewed
+    /// \param[out] Pb
+    void set_hessian_factorization( const hessian_entry_t & Hessian,
+        unsigned int NbStepsPreviewed, QPProblem & Pb );
+
+    /// \name Scaled products
+    /// The matrices are templates so that the row-major dynamics
+    /// matrices are not copied into temporaries.
+    /// \{
     /// \brief Scaled product\f$ weight*M*M \f$
+    template <typename Matrix1, typename Matrix2>
     void compute_term(Eigen::MatrixXd&weightMM,
 		      double weight,
-		      const Eigen::MatrixXd&M1,
-		      const Eigen::MatrixXd&M2);
+		      const Eigen::MatrixBase<Matrix1>&M1,
+		      const Eigen::MatrixBase<Matrix2>&M2);
 
     /// \brief Scaled product \f$ weight*M*V \f$
+    template <typename Matrix>
     void compute_term(Eigen::VectorXd&weightMV,
 		      double weight,
-		      const Eigen::MatrixXd& M,
+		      const Eigen::MatrixBase<Matrix>& M,
 		      const Eigen::VectorXd& V);
 
     /// \brief Scaled product \f$ weight*M*V*scalar \f$
+    template <typename Matrix>
     void compute_term(Eigen::VectorXd &weightMV,
 		      double weight,
-		      const Eigen::MatrixXd& M,
+		      const Eigen::MatrixBase<Matrix>& M,
 		      const Eigen::VectorXd& V,
 		      const double scalar);
 
     /// \brief Scaled product \f$ weight*M*M*V \f$
+    template <typename Matrix1, typename Matrix2>
     void compute_term(Eigen::VectorXd &weightMV,
 		      double weight,
-		      const Eigen::MatrixXd &M1,
-		      const Eigen::MatrixXd&M2,
+		      const Eigen::MatrixBase<Matrix1> &M1,
+		      const Eigen::MatrixBase<Matrix2>&M2,
 		      const Eigen::VectorXd &V2);
+    /// \}
 
 
     //
@@ -260,6 +327,24 @@ namespace PatternGeneratorJRL
     Eigen::MatrixXd MM_;
     Eigen::VectorXd MV_;
     Eigen::VectorXd MV2_;
+    Eigen::MatrixXd EqualityMatrix_;
+    Eigen::VectorXd EqualityVector_;
+    /// \brief Storage of the matrices whose size depends on the
+    /// number of previewed steps
+    MatrixStoragePool StoragePool_;
+    /// \}
+
+    /// \name Convex hulls of the support polygons
+    /// \{
+    convex_hull_t CoPHull_, FeetHull_;
+    /// \}
+
+    /// \name Cached Hessians
+    /// \{
+    HessianCache HessianCache_;
+    hessian_key_t InvariantKey_, PatternKey_;
+    /// \brief Hessian of both coordinates and its factor
+    Eigen::MatrixXd FullQ_, FullJ0_;
     /// \}
 
 
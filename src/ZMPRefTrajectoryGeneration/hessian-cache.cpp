@@ -0,0 +1,241 @@
+/*
+ * Copyright 2019,
+ *
+ * Olivier Stasse
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+/*! \file hessian-cache.cpp
+  \brief Cache of the Hessians of the Herdt 2010 QP and of their factors. */
+
+#include <string.h>
+
+#include <fstream>
+
+#include <ZMPRefTrajectoryGeneration/hessian-cache.hh>
+
+#include <Debug.hh>
+
+using namespace std;
+using namespace PatternGeneratorJRL;
+
+namespace
+{
+  const char HESSIAN_CACHE_MAGIC[8] = { 'J','R','L','H','E','S','S','C' };
+  const unsigned int HESSIAN_CACHE_VERSION = 1;
+
+  void write_matrix( ofstream & aFile, const Eigen::MatrixXd & M )
+  {
+    unsigned int lSize[2] = { (unsigned int)M.rows(), (unsigned int)M.cols() };
+    aFile.write((const char *)lSize,sizeof(lSize));
+    aFile.write((const char *)M.data(),M.size()*sizeof(double));
+  }
+
+  bool read_matrix( ifstream & aFile, Eigen::MatrixXd & M )
+  {
+    unsigned int lSize[2];
+    if( !aFile.read((char *)lSize,sizeof(lSize)) ||
+        lSize[0] > 10000 || lSize[1] > 10000 )
+      return false;
+    M.resize(lSize[0],lSize[1]);
+    return (bool)aFile.read((char *)M.data(),M.size()*sizeof(double));
+  }
+}
+
+
+hessian_key_t::hessian_key_t()
+  : N(0)
+  , T(0.0)
+  , CoMHeight(0.0)
+{
+  Weights[0] = Weights[1] = Weights[2] = 0.0;
+}
+
+
+bool
+hessian_key_t::operator<( const hessian_key_t & Key ) const
+{
+  if( N != Key.N )
+    return N < Key.N;
+  if( T != Key.T )
+    return T < Key.T;
+  if( CoMHeight != Key.CoMHeight )
+    return CoMHeight < Key.CoMHeight;
+  for( unsigned int i = 0; i < 3; i++ )
+    if( Weights[i] != Key.Weights[i] )
+      return Weights[i] < Key.Weights[i];
+  return Pattern < Key.Pattern;
+}
+
+
+HessianCache::HessianCache( unsigned int Capacity )
+  : Capacity_( Capacity > 0 ? Capacity : 1 )
+  , Hits_(0)
+  , Misses_(0)
+{
+}
+
+
+void
+HessianCache::Capacity( unsigned int Capacity )
+{
+  Capacity_ = Capacity > 0 ? Capacity : 1;
+  while( Index_.size() > Capacity_ )
+    {
+      Index_.erase(Entries_.back().Key);
+      Entries_.pop_back();
+    }
+}
+
+
+const hessian_entry_t *
+HessianCache::find( const hessian_key_t & Key )
+{
+  std::map<hessian_key_t, entries_t::iterator>::iterator it = Index_.find(Key);
+  if( it == Index_.end() )
+    {
+      Misses_++;
+      return 0;
+    }
+  Hits_++;
+  Entries_.splice(Entries_.begin(),Entries_,it->second);
+  return &Entries_.front();
+}
+
+
+hessian_entry_t &
+HessianCache::store( const hessian_key_t & Key )
+{
+  std::map<hessian_key_t, entries_t::iterator>::iterator it = Index_.find(Key);
+  if( it != Index_.end() )
+    {
+      Entries_.splice(Entries_.begin(),Entries_,it->second);
+      return Entries_.front();
+    }
+  if( Index_.size() >= Capacity_ )
+    {
+      Index_.erase(Entries_.back().Key);
+      Entries_.pop_back();
+    }
+  Entries_.push_front(hessian_entry_t());
+  Entries_.front().Key = Key;
+  Index_[Key] = Entries_.begin();
+  return Entries_.front();
+}
+
+
+const hessian_entry_t &
+HessianCache::insert( const hessian_key_t & Key, const Eigen::MatrixXd & Q )
+{
+  hessian_entry_t & Entry = store(Key);
+  Entry.Q = Q;
+
+  Eigen::LLT<Eigen::MatrixXd> lLLT(Q);
+  if( lLLT.info() != Eigen::Success )
+    {
+      ODEBUG("Cached Hessian not positive definite");
+      Entry.Rinv.resize(0,0);
+      return Entry;
+    }
+  Entry.Rinv.setIdentity(Q.rows(),Q.cols());
+  lLLT.matrixU().solveInPlace(Entry.Rinv);
+  return Entry;
+}
+
+
+void
+HessianCache::clear()
+{
+  Entries_.clear();
+  Index_.clear();
+}
+
+
+int
+HessianCache::save( const std::string & FileName ) const
+{
+  ofstream aFile(FileName.c_str(),ofstream::out | ofstream::binary);
+  if( !aFile.is_open() )
+    return -1;
+
+  unsigned int lSize = (unsigned int)Entries_.size();
+  aFile.write(HESSIAN_CACHE_MAGIC,sizeof(HESSIAN_CACHE_MAGIC));
+  aFile.write((const char *)&HESSIAN_CACHE_VERSION,sizeof(HESSIAN_CACHE_VERSION));
+  aFile.write((const char *)&lSize,sizeof(lSize));
+  // Least recently used first, so that load() restores the order.
+  for( entries_t::const_reverse_iterator it = Entries_.rbegin();
+       it != Entries_.rend(); ++it )
+    {
+      const hessian_key_t & Key = it->Key;
+      unsigned int lPatternSize = (unsigned int)Key.Pattern.size();
+      aFile.write((const char *)&Key.N,sizeof(Key.N));
+      aFile.write((const char *)&Key.T,sizeof(Key.T));
+      aFile.write((const char *)&Key.CoMHeight,sizeof(Key.CoMHeight));
+      aFile.write((const char *)Key.Weights,sizeof(Key.Weights));
+      aFile.write((const char *)&lPatternSize,sizeof(lPatternSize));
+      if( lPatternSize > 0 )
+        aFile.write((const char *)&Key.Pattern[0],
+                    lPatternSize*sizeof(unsigned int));
+      write_matrix(aFile,it->Q);
+      write_matrix(aFile,it->Rinv);
+    }
+  return aFile.good() ? 0 : -1;
+}
+
+
+int
+HessianCache::load( const std::string & FileName )
+{
+  ifstream aFile(FileName.c_str(),ifstream::in | ifstream::binary);
+  char lMagic[sizeof(HESSIAN_CACHE_MAGIC)];
+  unsigned int lVersion = 0, lSize = 0;
+  aFile.read(lMagic,sizeof(lMagic));
+  aFile.read((char *)&lVersion,sizeof(lVersion));
+  aFile.read((char *)&lSize,sizeof(lSize));
+  if( !aFile || memcmp(lMagic,HESSIAN_CACHE_MAGIC,sizeof(lMagic)) != 0
+      || lVersion != HESSIAN_CACHE_VERSION )
+    return -1;
+
+  hessian_key_t Key;
+  Eigen::MatrixXd Q, Rinv;
+  for( unsigned int i = 0; i < lSize; i++ )
+    {
+      unsigned int lPatternSize = 0;
+      aFile.read((char *)&Key.N,sizeof(Key.N));
+      aFile.read((char *)&Key.T,sizeof(Key.T));
+      aFile.read((char *)&Key.CoMHeight,sizeof(Key.CoMHeight));
+      aFile.read((char *)Key.Weights,sizeof(Key.Weights));
+      aFile.read((char *)&lPatternSize,sizeof(lPatternSize));
+      if( !aFile || lPatternSize > 10000 )
+        return -1;
+      Key.Pattern.resize(lPatternSize);
+      if( lPatternSize > 0 )
+        aFile.read((char *)&Key.Pattern[0],lPatternSize*sizeof(unsigned int));
+      if( !read_matrix(aFile,Q) || !read_matrix(aFile,Rinv) ||
+          Q.rows() != Q.cols() ||
+          ( Rinv.size() > 0 &&
+            ( Rinv.rows() != Q.rows() || Rinv.cols() != Q.cols() ) ) )
+        return -1;
+
+      hessian_entry_t & Entry = store(Key);
+      Entry.Q = Q;
+      Entry.Rinv = Rinv;
+    }
+  return (int)lSize;
+}
@@ -0,0 +1,145 @@
+/*
+ * Copyright 2019,
+ *
+ * Olivier Stasse
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+/*! \file hessian-cache.hh
+  \brief Cache of the Hessians of the Herdt 2010 QP and of their factors. */
+
+#ifndef HESSIANCACHE_HH_
+#define HESSIANCACHE_HH_
+
+#include <list>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <Eigen/Dense>
+
+namespace PatternGeneratorJRL
+{
+
+  /// \brief Everything the Hessian of one coordinate depends on.
+  struct hessian_key_t
+  {
+    /// \brief Number of previewed samples
+    unsigned int N;
+    /// \brief Sampling period of the preview
+    double T;
+    double CoMHeight;
+    /// \brief Weights of the jerk, instant velocity
+    /// and CoP centering objectives
+    double Weights[3];
+    /// \brief Step number of each previewed sample,
+    /// empty for the invariant part
+    std::vector<unsigned int> Pattern;
+
+    hessian_key_t();
+
+    bool operator<( const hessian_key_t & Key ) const;
+  };
+
+  /// \brief Hessian of one coordinate and its factor.
+  struct hessian_entry_t
+  {
+    hessian_key_t Key;
+    /// \brief Jerks first, then the previewed feet positions
+    Eigen::MatrixXd Q;
+    /// \brief Inverse of the upper triangular R such that
+    /// \f$ Q = R^T R \f$. Empty if Q is not positive definite.
+    Eigen::MatrixXd Rinv;
+  };
+
+  /// \brief Least recently used cache of Hessians and their factors.
+  ///
+  /// The cache can be saved to disk and loaded back, so that a process
+  /// switching between known gait profiles does not rebuild them.
+  class HessianCache
+  {
+    //
+    //Public methods
+    //
+  public:
+
+    HessianCache( unsigned int Capacity = 64 );
+
+    /// \brief Entry of Key, which becomes the most recently used.
+    ///
+    /// \return 0 if Key is not cached
+    const hessian_entry_t * find( const hessian_key_t & Key );
+
+    /// \brief Store and factorize Q under Key.
+    /// The least recently used entry is dropped if the cache is full.
+    const hessian_entry_t & insert( const hessian_key_t & Key,
+                                    const Eigen::MatrixXd & Q );
+
+    /// \brief Drop all the entries.
+    void clear();
+
+    /// \brief Write the entries in a binary file.
+    ///
+    /// \return 0 on success, -1 otherwise
+    int save( const std::string & FileName ) const;
+
+    /// \brief Add the entries of a file written by save().
+    ///
+    /// \return Number of entries read, -1 if the file is not valid
+    int load( const std::string & FileName );
+
+    /// \name Accessors and mutators
+    /// \{
+    void Capacity( unsigned int Capacity );
+    inline unsigned int Capacity() const
+    { return Capacity_; }
+    inline unsigned int Size() const
+    { return (unsigned int)Index_.size(); }
+    inline unsigned long Hits() const
+    { return Hits_; }
+    inline unsigned long Misses() const
+    { return Misses_; }
+    /// \}
+
+    //
+    //Private methods
+    //
+  private:
+
+    /// \brief Store an entry, the factor included.
+    hessian_entry_t & store( const hessian_key_t & Key );
+
+    //
+    //Private members
+    //
+  private:
+
+    typedef std::list<hessian_entry_t> entries_t;
+    /// \brief Most recently used first
+    entries_t Entries_;
+    std::map<hessian_key_t, entries_t::iterator> Index_;
+
+    unsigned int Capacity_;
+    unsigned long Hits_, Misses_;
+
+  };
+
+}
+
+#endif /* HESSIANCACHE_HH_ */
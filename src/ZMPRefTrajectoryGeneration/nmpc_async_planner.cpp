@@ -0,0 +1,186 @@
+/*
+ * Copyright 2019,
+ *
+ * Olivier Stasse
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+/*! \file nmpc_async_planner.cpp
+  \brief Run the SQP solver of NMPCgenerator in a dedicated thread. */
+
+#include "portability/gettimeofday.hh"
+
+#include <ZMPRefTrajectoryGeneration/nmpc_async_planner.hh>
+
+#include <Debug.hh>
+
+using namespace std;
+using namespace PatternGeneratorJRL;
+
+nmpc_plan_t::nmpc_plan_t():
+  time(0.0),
+  RequestTime(0.0),
+  Tfirst(0.0),
+  Shift(0),
+  SolveDuration(0.0)
+{}
+
+void nmpc_plan_t::fill(NMPCgenerator & aGenerator, double ltime)
+{
+  // shift() shortens the jerks, their capacity is kept.
+  JerkX      .resize((long unsigned int)aGenerator.N()) ;
+  JerkY      .resize((long unsigned int)aGenerator.N()) ;
+  FootStepX  .resize((long unsigned int)(aGenerator.nf()+1));
+  FootStepY  .resize((long unsigned int)(aGenerator.nf()+1));
+  FootStepYaw.resize((long unsigned int)(aGenerator.nf()+1));
+  aGenerator.getSolution(JerkX, JerkY, FootStepX, FootStepY, FootStepYaw);
+  SupportStates_deq = aGenerator.SupportStates_deq();
+  CurrentSupport = aGenerator.currentSupport();
+  Tfirst = aGenerator.Tfirst();
+  Status = aGenerator.solveStatus();
+  time = ltime;
+  RequestTime = ltime;
+  Shift = 0;
+}
+
+bool nmpc_plan_t::shift(double ltime, double T, unsigned MinSize)
+{
+  // The first sampling period is over when the next one starts.
+  while(ltime + 0.00001 >= time + Tfirst)
+  {
+    if (JerkX.size()<=MinSize || SupportStates_deq.size()<=1)
+      return false;
+    time += Tfirst;
+    Tfirst = T;
+    JerkX.erase(JerkX.begin());
+    JerkY.erase(JerkY.begin());
+    SupportStates_deq.pop_front();
+    Shift++;
+  }
+  return true;
+}
+
+NMPCAsyncPlanner::NMPCAsyncPlanner(NMPCgenerator * aGenerator):
+  generator_(aGenerator),
+  thread_(0),
+  stopRequested_(false)
+{}
+
+NMPCAsyncPlanner::~NMPCAsyncPlanner()
+{
+  stop();
+}
+
+void NMPCAsyncPlanner::start()
+{
+  if (thread_!=0)
+  {
+    if (!stopRequested_.load())
+      return;
+    stop();
+  }
+  requests_.Reset();
+  plans_.Reset();
+  stopRequested_.store(false);
+  thread_ = new boost::thread(&NMPCAsyncPlanner::run,this);
+}
+
+void NMPCAsyncPlanner::stop()
+{
+  if (thread_==0)
+    return;
+  requestStop();
+  thread_->join();
+  delete thread_;
+  thread_ = 0;
+  requests_.Reset();
+  plans_.Reset();
+}
+
+void NMPCAsyncPlanner::requestStop()
+{
+  if (thread_==0)
+    return;
+  {
+    boost::lock_guard<boost::mutex> lock(wakeUpMutex_);
+    stopRequested_.store(true);
+  }
+  wakeUp_.notify_one();
+}
+
+void NMPCAsyncPlanner::post()
+{
+  // Publishing under the lock guarantees that the planner either sees
+  // the request before waiting or is waiting when notified.
+  {
+    boost::lock_guard<boost::mutex> lock(wakeUpMutex_);
+    requests_.Publish();
+  }
+  wakeUp_.notify_one();
+}
+
+void NMPCAsyncPlanner::waitForPlan()
+{
+  boost::unique_lock<boost::mutex> lock(planMutex_);
+  while(!plans_.Fetch())
+    planPublished_.wait(lock);
+}
+
+void NMPCAsyncPlanner::run()
+{
+  while(!stopRequested_.load())
+  {
+    if (!requests_.Fetch())
+    {
+      // Sleep until the next request or the stop.
+      boost::unique_lock<boost::mutex> lock(wakeUpMutex_);
+      while (!requests_.HasNewValue() && !stopRequested_.load())
+        wakeUp_.wait(lock);
+      continue;
+    }
+
+    nmpc_request_t & aRequest = requests_.ReadSlot();
+    nmpc_plan_t & aPlan = plans_.WriteSlot();
+    {
+      boost::lock_guard<boost::mutex> lock(generatorMutex_);
+
+      struct timeval begin,end;
+      gettimeofday(&begin,0);
+
+      generator_->updateInitialCondition(aRequest.time,
+                                         aRequest.LeftFoot,
+                                         aRequest.RightFoot,
+                                         aRequest.CoM,
+                                         aRequest.VelRef);
+      generator_->solve();
+      aPlan.fill(*generator_,aRequest.time);
+
+      gettimeofday(&end,0);
+      aPlan.SolveDuration = (double)(end.tv_sec-begin.tv_sec)
+        + 0.000001 * (double)(end.tv_usec-begin.tv_usec);
+    }
+    ODEBUG("Plan published for time " << aRequest.time
+           << " in " << aPlan.SolveDuration << " s");
+    {
+      boost::lock_guard<boost::mutex> lock(planMutex_);
+      plans_.Publish();
+    }
+    planPublished_.notify_one();
+  }
+}
@@ -0,0 +1,161 @@
+/*
+ * Copyright 2019,
+ *
+ * Olivier Stasse
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+/*! \file nmpc_async_planner.hh
+  \brief Run the SQP solver of NMPCgenerator in a dedicated thread. */
+
+#ifndef NMPC_ASYNC_PLANNER_H
+#define NMPC_ASYNC_PLANNER_H
+
+#include <deque>
+#include <vector>
+
+#include <boost/atomic.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+
+#include <privatepgtypes.hh>
+#include <TripleBuffer.hh>
+#include <ZMPRefTrajectoryGeneration/nmpc_generator.hh>
+
+namespace PatternGeneratorJRL
+{
+  /// \brief Initial condition sent by the control thread.
+  struct nmpc_request_t
+  {
+    double time ;
+    FootAbsolutePosition LeftFoot ;
+    FootAbsolutePosition RightFoot ;
+    COMState CoM ;
+    reference_t VelRef ;
+  };
+
+  /// \brief Solution of the SQP and the data needed to interpolate it.
+  struct nmpc_plan_t
+  {
+    /// \brief Beginning of the first sampling period of the plan.
+    double time ;
+    /// \brief Time of the initial condition the plan has been computed for.
+    double RequestTime ;
+    /// \brief Duration of the first sampling period.
+    double Tfirst ;
+    /// \brief Number of sampling periods dropped since the plan was solved.
+    unsigned Shift ;
+    /// \brief Wall-clock time spent in the solver (s).
+    double SolveDuration ;
+    /// \brief Report of the solver.
+    nmpc_solve_status_t Status ;
+    std::vector<double> JerkX, JerkY ;
+    std::vector<double> FootStepX, FootStepY, FootStepYaw ;
+    RingBuffer<support_state_t> SupportStates_deq ;
+    support_state_t CurrentSupport ;
+
+    nmpc_plan_t();
+
+    /// \brief Fill the plan from the last solution of the generator.
+    void fill(NMPCgenerator & aGenerator, double time);
+
+    /// \brief Drop the sampling periods of the plan which are over at
+    /// time, keeping at least MinSize of them.
+    /// Returns false if the plan could not cover time.
+    bool shift(double time, double T, unsigned MinSize);
+  };
+
+  /// \brief Dedicated planner thread for the Naveau 2015 SQP generator.
+  ///
+  /// The control thread posts the current initial condition with post()
+  /// and fetches the last published plan with fetch(). Both sides
+  /// exchange their data through triple buffers and never wait for each
+  /// other: post() only takes the lock of the condition variable waking
+  /// up the planner, which holds it while it checks for a request.
+  /// The generator is only used by the planner thread while it is
+  /// running; other accesses have to hold the mutex returned by
+  /// generatorMutex().
+  class NMPCAsyncPlanner
+  {
+  public:
+    NMPCAsyncPlanner(NMPCgenerator * aGenerator);
+    ~NMPCAsyncPlanner();
+
+    /// \brief Start the planner thread.
+    void start();
+    /// \brief Stop the planner thread and drop the pending data.
+    void stop();
+    /// \brief Ask the planner thread to stop after the solve in
+    /// progress, without waiting for it. The thread is joined by the
+    /// next call to start() or stop().
+    void requestStop();
+    /// \brief The thread exists, it may use the generator.
+    inline bool isRunning() const
+    { return thread_!=0; }
+    /// \brief The thread exists and has not been asked to stop.
+    inline bool isPlanning() const
+    { return thread_!=0 && !stopRequested_.load(); }
+
+    /// \brief Control thread: slot to fill before calling post().
+    inline nmpc_request_t & requestSlot()
+    { return requests_.WriteSlot(); }
+    /// \brief Control thread: send the request to the planner.
+    void post();
+
+    /// \brief Control thread: take the last published plan
+    /// if a new one is available. Returns true in this case.
+    inline bool fetch()
+    { return plans_.Fetch(); }
+    /// \brief Control thread: the last fetched plan.
+    inline nmpc_plan_t & plan()
+    { return plans_.ReadSlot(); }
+    /// \brief Control thread: wait until a plan is published.
+    /// Used only before the first plan is available.
+    void waitForPlan();
+
+    /// \brief Lock to take before modifying the generator
+    /// from another thread.
+    inline boost::mutex & generatorMutex()
+    { return generatorMutex_; }
+
+  private:
+    void run();
+
+    NMPCgenerator * generator_ ;
+    boost::thread * thread_ ;
+    boost::atomic<bool> stopRequested_ ;
+
+    TripleBuffer<nmpc_request_t> requests_ ;
+    TripleBuffer<nmpc_plan_t> plans_ ;
+
+    boost::mutex generatorMutex_ ;
+
+    /// \brief Used to wake up the planner when a request is posted.
+    boost::mutex wakeUpMutex_ ;
+    boost::condition_variable wakeUp_ ;
+
+    /// \brief Used to wake up the control thread waiting for
+    /// the first plan.
+    boost::mutex planMutex_ ;
+    boost::condition_variable planPublished_ ;
+  };
+}
+
+#endif // NMPC_ASYNC_PLANNER_H
@@ -26,6 +26,7 @@
   \brief implement an SQP method to generate online stable walking motion */
 
 #include <ZMPRefTrajectoryGeneration/nmpc_generator.hh>
+#include <QPCapture.hh>
 #include <cmath>
 #include <Debug.hh>
 
@@ -94,6 +95,7 @@ NMPCgenerator
 (SimplePluginManager * aSPM, PinocchioRobot *aPR)
 {
   time_=0.0;
+  iterationSolverFile_ = 0 ;
   T_ = 0.0 ;
   Tfirst_ = 0.0 ;
   N_ = 0 ;
@@ -129,11 +131,13 @@ NMPCgenerator
 
   SPM_ = aSPM ;
   PR_ = aPR ;
+  latencyProfile_ = (aSPM!=0) ? aSPM->GetLatencyProfile() : 0 ;
 
   FSM_ = new SupportFSM();
   RFI_ = new RelativeFeetInequalities(SPM_,PR_) ;
 
   QP_=NULL;
+  spareQP_=NULL;
   QuadProg_H_.resize(1,1);
   QuadProg_J_eq_.resize(1,1);
   QuadProg_J_ineq_.resize(1,1);
@@ -147,6 +151,14 @@ NMPCgenerator
   useLineSearch_ = false;
   itBeforeLanding_ = 0;
 
+  maxSolverIteration(1);
+  oneMoreStep_ = false;
+  solveBudget_ = 0.0 ;
+  feasibilityThreshold_ = 1e-6 ;
+
+  hessianIsValid_ = false ;
+  hessianIsDecomposed_ = false ;
+
   SupportStates_deq_.clear();
 }
 
@@ -157,6 +169,11 @@ NMPCgenerator::~NMPCgenerator()
     delete QP_;
     QP_ = NULL ;
   }
+  if (spareQP_ !=NULL)
+  {
+    delete spareQP_;
+    spareQP_ = NULL ;
+  }
   if (RFI_ !=NULL)
   {
     delete RFI_;
@@ -251,7 +268,6 @@ void NMPCgenerator::initNMPCgenerator(
 
   SecurityMarginX_ = 0.095 ;
   SecurityMarginY_ = 0.055 ;
-  maxSolverIteration_=1;
   oneMoreStep_=false;
 
   setLocalVelocityReference(local_vel_ref);
@@ -289,11 +305,29 @@ void NMPCgenerator::initNMPCgenerator(
   initializeConstraint();
   initializeCostFunction();
   initializeLineSearch();
+  // The weights, the CoM height or the horizon may have changed.
+  hessianFactor_.clear();
+  hessianIsValid_ = false ;
 
   // initialize the solver
   // we assume 0 equality constraint at the beginning
   // call QP_->problem((int)nv_,(int)nceq_,(int)ncineq_) before using it
+  if (QP_!=NULL)
+    delete QP_;
   QP_ = new Eigen::QuadProgDense((int)nv_,(int)nceq_,(int)ncineq_) ;
+  // When the swing foot is about to land, the velocity constraints
+  // (equalities) replace the foot pose constraints. The solver of this
+  // set of constraints is kept aside so that switching does not allocate.
+  unsigned spareNceq = 3*nf_ ;
+  unsigned spareNcineq = nc_cop_ + nc_rot_ + nc_obs_ + nc_stan_ ;
+  if (spareQP_!=NULL)
+    delete spareQP_;
+  spareQP_ = new Eigen::QuadProgDense((int)nv_,(int)spareNceq,
+                                      (int)spareNcineq) ;
+  spareQuadProg_J_eq_    .setZero(spareNceq,nv_);
+  spareQuadProg_bJ_eq_   .setZero(spareNceq);
+  spareQuadProg_J_ineq_  .setZero(spareNcineq,nv_);
+  spareQuadProg_lbJ_ineq_.setZero(spareNcineq);
   QuadProg_H_       .resize(nv_,nv_);
   QuadProg_g_       .resize(nv_);
   QuadProg_J_eq_    .resize(nceq_,nv_);
@@ -313,10 +347,6 @@ void NMPCgenerator::initNMPCgenerator(
 
 void NMPCgenerator::initializeConstraint()
 {
-  qp_J_.resize(nc_,nv_); {for(unsigned int i=0;i<qp_J_.rows();i++) for(unsigned int j=0;j<qp_J_.cols();j++) qp_J_(i,j)=0.0;};
-  qp_ubJ_.resize(nc_);     { for(unsigned int i=0;i<qp_ubJ_.size();qp_ubJ_[i++]=0.0);};
-  ub_.resize(nc_);    { for(unsigned int i=0;i<ub_.size();ub_[i++]=0.0);};
-  gU_.resize(nc_);    { for(unsigned int i=0;i<gU_.size();gU_[i++]=0.0);};
   Uxy_.resize(2*(N_+nf_));   { for(unsigned int i=0;i<Uxy_.size();Uxy_[i++]=0.0);};
 
   Pzuv_.resize(2*N_,2*(N_+nf_));
@@ -346,6 +376,19 @@ void NMPCgenerator::initializeConstraint()
   nceq_ = nc_vel_ ;
   nc_ = nceq_ + ncineq_;
 
+  // The number of constraints changes with the support phase: the
+  // velocity constraints replace the foot pose constraints when the
+  // swing foot is about to land. Size the constraint values for both
+  // so that building the QP does not allocate.
+  unsigned ncMax = nc_ + 3*nf_ + nc_stan_ ;
+  qp_J_.resize(ncMax,nv_); {for(unsigned int i=0;i<qp_J_.rows();i++) for(unsigned int j=0;j<qp_J_.cols();j++) qp_J_(i,j)=0.0;};
+  qp_ubJ_.resize(ncMax);   { for(unsigned int i=0;i<qp_ubJ_.size();qp_ubJ_[i++]=0.0);};
+  ub_.resize(ncMax);  { for(unsigned int i=0;i<ub_.size();ub_[i++]=0.0);};
+  gU_.resize(ncMax);  { for(unsigned int i=0;i<gU_.size();gU_[i++]=0.0);};
+  HobsUxy_.resize(2*(N_+nf_));
+  theta_vec_.resize(nf_+1);
+  support_state_.resize(nf_);
+
   gU_cop_.resize(nc_cop_);
   { for(unsigned int i=0;i<gU_cop_.size();gU_cop_[i++]=0.0);};
   gU_foot_.resize(nc_foot_);
@@ -388,10 +431,11 @@ void NMPCgenerator::updateConstraint()
   nc_ = ncineq_ + nceq_ ;
 
   unsigned N2nf2 = 2*(N_+nf_) ;
-  qp_J_.resize(nc_,nv_);
-  {for(unsigned int i=0;i<qp_J_.rows();i++)
-      for(unsigned int j=0;j<qp_J_.cols();j++)
-	qp_J_(i,j)=0.0;};
+  // qp_J_ is sized by initializeConstraint(), only its first nc_ rows
+  // are used.
+  if((unsigned)qp_J_.rows()<nc_)
+    qp_J_.resize(nc_,nv_);
+  qp_J_.setZero();
 
   // Fill up qp_J_
   unsigned index = 0 ;
@@ -466,32 +510,37 @@ void NMPCgenerator::evalConstraint(Eigen::VectorXd & U)
 
   //    CoP
   evalCoPconstraint(U);
-  gU_cop_ = Acop_xy_*Uxy_;
+  gU_cop_.noalias() = Acop_xy_*Uxy_;
   //    Foot
   evalFootPoseConstraint(U);
-  gU_foot_ = Afoot_xy_full_*Uxy_;
+  gU_foot_.noalias() = Afoot_xy_full_*Uxy_;
   //    Velocity
   { for(unsigned int i=0;i<gU_vel_.size();gU_vel_[i++]=0.0);};
   //    Rotation
-  gU_rot_ = Arot_*U;
+  gU_rot_.noalias() = Arot_*U;
   //    Obstacle
-  gU_obs_.resize(nc_obs_);
   for(unsigned obs=0 ; obs<obstacles_.size() ; ++obs)
   {
     for(unsigned n=0 ; n<nf_ ; ++n)
     {
-      Eigen::VectorXd HobsUxy = Hobs_[obs][n]*Uxy_;
+      HobsUxy_.noalias() = Hobs_[obs][n]*Uxy_;
       double deltaObs = 0 ;
-      for(unsigned i=0 ; i<HobsUxy.size() ; ++i)
-          deltaObs += Uxy_(i) * (HobsUxy(i) + Aobs_[obs][n](i)) ;
+      for(unsigned i=0 ; i<HobsUxy_.size() ; ++i)
+          deltaObs += Uxy_(i) * (HobsUxy_(i) + Aobs_[obs][n](i)) ;
       gU_obs_(obs*nf_ + n) = deltaObs ;
     }
   }
   // Standing
   //gU_stan_ = MAL_RET_A_by_B(Astan_,U) ;
 
-  ub_.resize(nc_);
-  gU_.resize(nc_);
+  // ub_ and gU_ are sized by initializeConstraint() for all the
+  // constraints, only the first nc_ values are used. Grow them
+  // in case more constraints were added since.
+  if((unsigned)ub_.size()<nc_)
+  {
+    ub_.resize(nc_);
+    gU_.resize(nc_);
+  }
 
   // Fill up lb_, ub_ and gU_
   unsigned index = 0 ;
@@ -530,6 +579,53 @@ void NMPCgenerator::evalConstraint(Eigen::VectorXd & U)
   return ;
 }
 
+void NMPCgenerator::getState(nmpc_state_t & aState) const
+{
+  aState.time = time_ ;
+  aState.c_k_x = c_k_x_ ;
+  aState.c_k_y = c_k_y_ ;
+  aState.c_k_z = c_k_z_ ;
+  aState.currentSupport = currentSupport_ ;
+  aState.SupportStates_deq = SupportStates_deq_ ;
+  aState.currentLeftFootAbsolutePosition = currentLeftFootAbsolutePosition_ ;
+  aState.currentRightFootAbsolutePosition = currentRightFootAbsolutePosition_ ;
+  aState.desiredNextSupportFootRelativePosition =
+      desiredNextSupportFootRelativePosition ;
+  aState.vel_ref = vel_ref_ ;
+  aState.Tfirst = Tfirst_ ;
+  aState.U = U_ ;
+  aState.U_xy = U_xy_ ;
+  aState.U_x = U_x_ ;
+  aState.U_y = U_y_ ;
+  aState.F_kp1_x = F_kp1_x_ ;
+  aState.F_kp1_y = F_kp1_y_ ;
+  aState.F_kp1_theta = F_kp1_theta_ ;
+}
+
+void NMPCgenerator::setState(const nmpc_state_t & aState)
+{
+  time_ = aState.time ;
+  c_k_x_ = aState.c_k_x ;
+  c_k_y_ = aState.c_k_y ;
+  c_k_z_ = aState.c_k_z ;
+  currentSupport_ = aState.currentSupport ;
+  SupportStates_deq_ = aState.SupportStates_deq ;
+  currentLeftFootAbsolutePosition_ = aState.currentLeftFootAbsolutePosition ;
+  currentRightFootAbsolutePosition_ = aState.currentRightFootAbsolutePosition ;
+  desiredNextSupportFootRelativePosition =
+      aState.desiredNextSupportFootRelativePosition ;
+  vel_ref_ = aState.vel_ref ;
+  Tfirst_ = aState.Tfirst ;
+  U_ = aState.U ;
+  U_xy_ = aState.U_xy ;
+  U_x_ = aState.U_x ;
+  U_y_ = aState.U_y ;
+  F_kp1_x_ = aState.F_kp1_x ;
+  F_kp1_y_ = aState.F_kp1_y ;
+  F_kp1_theta_ = aState.F_kp1_theta ;
+  hessianIsValid_ = false ;
+}
+
 void NMPCgenerator::updateInitialCondition(double time,
     FootAbsolutePosition & currentLeftFootAbsolutePosition,
     FootAbsolutePosition & currentRightFootAbsolutePosition,
@@ -676,6 +772,9 @@ void NMPCgenerator::guessWarmStart()
 
 void NMPCgenerator::updateInitialConditionDependentMatrices()
 {
+  // Tfirst_ and V_kp1_ have been updated
+  hessianIsValid_ = false ;
+
   // Compute Pzuv, it depends on the feet hulls
   for(unsigned i=0 ; i<N_ ; ++i)
   {
@@ -687,8 +786,8 @@ void NMPCgenerator::updateInitialConditionDependentMatrices()
   }
 
   // build Pzsc_ and v_kp1f_
-  Pzsc_x_ = Pzs_*c_k_x_;
-  Pzsc_y_ = Pzs_*c_k_y_;
+  Pzsc_x_.noalias() = Pzs_*c_k_x_;
+  Pzsc_y_.noalias() = Pzs_*c_k_y_;
 
   for (unsigned i=0 ; i<N_ ; ++i)
   {
@@ -728,16 +827,58 @@ void NMPCgenerator::updateInitialConditionDependentMatrices()
 
 void NMPCgenerator::solve()
 {
+  solveStatus_.NbOfIterations = 0 ;
+  solveStatus_.Converged = false ;
+  solveStatus_.DeadlineReached = false ;
+  solveStatus_.QPFailed = false ;
+  solveStatus_.Feasible = false ;
+  solveStatus_.ConstraintViolation = 0.0 ;
+  solveStatus_.Duration = 0.0 ;
+  solveStatus_.IterationDurations.clear();
+
   if(currentSupport_.Phase==DS && currentSupport_.NbStepsLeft == 0)
     return;
+
+  // Monotonic times in nanoseconds.
+  unsigned long long begin = MonotonicTime();
+  unsigned long long iterationBegin, qpBegin, qpEnd, end;
+  unsigned long long buildDuration = 0, qpDuration = 0;
+
   /* Process and solve problem, s.t. pattern generator data is consistent */
   unsigned iter = 0 ;
   oneMoreStep_ = true;
   double normDeltaU = 0.0 ;
+  unsigned long long lastIterationDuration = 0 ;
+  double bestViolation = -1.0 ;
+  bool lastIsBest = true ;
+  // Without budget, every step is applied and the last iterate is
+  // returned, as by the plain SQP.
+  bool anytime = solveBudget_>0.0 ;
   while(iter < maxSolverIteration_ && oneMoreStep_ == true)
   {
+    // Do not start an iteration which is expected to end after the
+    // deadline. Its duration is estimated by the previous one.
+    iterationBegin = MonotonicTime();
+    if(solveBudget_>0.0 && iter>0 &&
+       1e-9*(double)(iterationBegin-begin+lastIterationDuration) > solveBudget_)
+    {
+      solveStatus_.DeadlineReached = true ;
+      break;
+    }
+
     preprocess_solution() ;
+    qpBegin = MonotonicTime();
     solve_qp()            ;
+    qpEnd = MonotonicTime();
+    buildDuration += qpBegin-iterationBegin ;
+    qpDuration += qpEnd-qpBegin ;
+    if(QP_->fail()!=0)
+    {
+      solveStatus_.QPFailed = true ;
+      // The step is meaningless, keep the current iterate.
+      if(anytime)
+        break;
+    }
     postprocess_solution();
 
     normDeltaU = 0.0 ;
@@ -750,15 +891,56 @@ void NMPCgenerator::solve()
     else
       oneMoreStep_=false;
 
+    // Keep the last feasible iterate, or the least infeasible one.
+    if(anytime)
+    {
+      double violation = evalConstraintViolation();
+      lastIsBest = (bestViolation<0.0) ||
+        (violation<=feasibilityThreshold_) || (violation<bestViolation);
+      if(lastIsBest)
+      {
+        bestViolation = violation ;
+        if(iter+1<maxSolverIteration_)
+          bestU_ = U_ ;
+      }
+    }
+
     ++iter;
+    end = MonotonicTime();
+    lastIterationDuration = end-iterationBegin ;
+    solveStatus_.IterationDurations.push_back(1e-9*(double)lastIterationDuration);
+  }
+
+  if(!lastIsBest)
+  {
+    U_ = bestU_ ;
+    updateSolutionVectors();
+  }
+  else if(!anytime && iter>0)
+    bestViolation = evalConstraintViolation();
+
+  solveStatus_.NbOfIterations = iter ;
+  solveStatus_.Converged = !oneMoreStep_ ;
+  if(bestViolation>=0.0)
+  {
+    solveStatus_.ConstraintViolation = bestViolation ;
+    solveStatus_.Feasible = bestViolation<=feasibilityThreshold_ ;
   }
+  end = MonotonicTime();
+  solveStatus_.Duration = 1e-9*(double)(end-begin);
+
+  if(latencyProfile_!=0 && latencyProfile_->Enabled() && iter>0)
+  {
+    latencyProfile_->Stage(STAGE_QP_BUILD).Record(buildDuration);
+    latencyProfile_->Stage(STAGE_QP_SOLVE).Record(qpDuration);
+  }
+
 #ifdef DEBUG
-  static unsigned iteration_solver_file = 0 ;
-  if(iteration_solver_file == 0)
+  if(iterationSolverFile_ == 0)
   {
     ofstream os;
     os.open("iteration_solver.dat",ios::out);
-    ++iteration_solver_file ;
+    ++iterationSolverFile_ ;
   }
   ofstream os("iteration_solver.dat",ios::app);
   os << time_ << " "
@@ -774,8 +956,17 @@ void NMPCgenerator::preprocess_solution()
 {
   updateConstraint();
   updateCostFunction();
+  if((unsigned)QuadProg_J_eq_.rows()!=nceq_ ||
+     (unsigned)QuadProg_J_ineq_.rows()!=ncineq_)
+  {
+    // The other set of constraints is active.
+    std::swap(QP_,spareQP_);
+    QuadProg_J_eq_    .swap(spareQuadProg_J_eq_);
+    QuadProg_bJ_eq_   .swap(spareQuadProg_bJ_eq_);
+    QuadProg_J_ineq_  .swap(spareQuadProg_J_ineq_);
+    QuadProg_lbJ_ineq_.swap(spareQuadProg_lbJ_ineq_);
+  }
   QP_->problem((int)nv_,(int)nceq_,(int)ncineq_);
-  QuadProg_H_       .resize(nv_,nv_);
   QuadProg_g_       .resize(nv_);
   QuadProg_J_eq_    .resize(nceq_,nv_);
   QuadProg_bJ_eq_   .resize(nceq_);
@@ -784,14 +975,9 @@ void NMPCgenerator::preprocess_solution()
   deltaU_  .resize(nv_);
   deltaU_thresh_.resize(nv_);
 
+  // QuadProg_H_ is filled by updateHessianFactorization()
   for(unsigned i=0 ; i<nv_ ; ++i)
-  {
-    for(unsigned j=0 ; j<nv_ ; ++j)
-    {
-      QuadProg_H_(i,j) = qp_H_(i,j) ;
-    }
     QuadProg_g_(i) = qp_g_(i) ;
-  }
   for(unsigned i=0 ; i<nceq_ ; ++i)
   {
     for(unsigned j=0 ; j<nv_ ; ++j)
@@ -817,7 +1003,7 @@ void NMPCgenerator::solve_qp()
   // primal SQP solution
   QP_->solve(QuadProg_H_,QuadProg_g_,
              QuadProg_J_eq_,QuadProg_bJ_eq_,
-             QuadProg_J_ineq_,QuadProg_lbJ_ineq_,false);
+             QuadProg_J_ineq_,QuadProg_lbJ_ineq_,hessianIsDecomposed_);
   //  if(QP_->fail()==0)
   //    cerr << "qp solveur succeded" << endl ;
   if(QP_->fail()==1)
@@ -828,6 +1014,25 @@ void NMPCgenerator::solve_qp()
   deltaU_ = QP_->result() ;
   //cout << deltaU_.transpose() << endl ;
 
+  // Record the problem with the layout of QLD, from
+  // J_eq x = bJ_eq and J_ineq x <= lbJ_ineq.
+  // Only done when capturing, so the allocations do not matter.
+  QPCapture & aCapture = QPCapture::Instance();
+  if(aCapture.IsRunning())
+  {
+    int m = (int)(nceq_+ncineq_) ;
+    Eigen::MatrixXd DU(m,nv_) ;
+    Eigen::VectorXd DS(m) ;
+    DU.topRows(nceq_) = QuadProg_J_eq_ ;
+    DS.head(nceq_) = -QuadProg_bJ_eq_ ;
+    DU.bottomRows(ncineq_) = -QuadProg_J_ineq_ ;
+    DS.tail(ncineq_) = QuadProg_lbJ_ineq_ ;
+    aCapture.Record(QP_CAPTURE_NMPC,time_,(int)nv_,m,(int)nceq_,
+                    qp_H_.data(),QuadProg_g_.data(),
+                    DU.data(),m,DS.data(),0,0,
+                    deltaU_.data(),QP_->fail());
+  }
+
 #ifdef DEBUG_COUT
   bool endline = false;
   if(*cput_ >= 0.0007)
@@ -884,21 +1089,7 @@ void NMPCgenerator::postprocess_solution()
   }
 
   U_ += lineStep_ * deltaU_thresh_ ;
-
-  for(unsigned i=0 ; i<2*N_+2*nf_ ; ++i)
-    U_xy_(i)=U_(i);
-
-  for(unsigned i=0 ; i<N_ ; ++i)
-  {
-    U_x_(i) = U_(i);
-    U_y_(i) = U_(N_+nf_+i);
-  }
-  for(unsigned i=0 ; i<nf_ ; ++i)
-  {
-    F_kp1_x_(i)     = U_(N_+i);
-    F_kp1_y_(i)     = U_(2*N_+nf_+i);
-    F_kp1_theta_(i) = U_(2*N_+2*nf_+i);
-  }
+  updateSolutionVectors();
 #ifdef DEBUG
   DumpVector("U_",U_);
 #endif
@@ -923,6 +1114,36 @@ void NMPCgenerator::postprocess_solution()
   return ;
 }
 
+void NMPCgenerator::updateSolutionVectors()
+{
+  for(unsigned i=0 ; i<2*N_+2*nf_ ; ++i)
+    U_xy_(i)=U_(i);
+
+  for(unsigned i=0 ; i<N_ ; ++i)
+  {
+    U_x_(i) = U_(i);
+    U_y_(i) = U_(N_+nf_+i);
+  }
+  for(unsigned i=0 ; i<nf_ ; ++i)
+  {
+    F_kp1_x_(i)     = U_(N_+i);
+    F_kp1_y_(i)     = U_(2*N_+nf_+i);
+    F_kp1_theta_(i) = U_(2*N_+2*nf_+i);
+  }
+}
+
+double NMPCgenerator::evalConstraintViolation()
+{
+  // The equality constraints only hold on the steps,
+  // gU_ is not evaluated for them.
+  evalConstraint(U_);
+  double violation = 0.0 ;
+  for(unsigned i=nceq_ ; i<nc_ ; ++i)
+    if(gU_(i)>ub_(i))
+      violation += gU_(i)-ub_(i) ;
+  return violation ;
+}
+
 void NMPCgenerator::getSolution(std::vector<double> & JerkX,
                                 std::vector<double> & JerkY,
                                 std::vector<double> & FootStepX,
@@ -1024,7 +1245,7 @@ void NMPCgenerator::updateCurrentSupport(double time,
        << endl ;
 #endif
   const FootAbsolutePosition * FAP = NULL;
-  reference_t vel = vel_ref_;
+  const reference_t & vel = vel_ref_;
   //vel.Local.X=1;
   // DETERMINE CURRENT SUPPORT STATE:
   // --------------------------------
@@ -1048,7 +1269,7 @@ void NMPCgenerator::updateSupportdeque(double time,
 {
   SupportStates_deq_[0] = currentSupport_ ;
   const FootAbsolutePosition * FAP = NULL;
-  reference_t vel = vel_ref_;
+  const reference_t & vel = vel_ref_;
   // PREVIEW SUPPORT STATES:
   // -----------------------
   // initialize the previewed support state before previewing
@@ -1097,7 +1318,7 @@ void NMPCgenerator::updateSupportdeque(double time,
 
 void NMPCgenerator::computeFootSelectionMatrix()
 {
-  std::deque<support_state_t>::const_iterator SS_it;
+  RingBuffer<support_state_t>::const_iterator SS_it;
   SS_it = SupportStates_deq_.begin();//points at the cur. sup. st.
   ++SS_it;
   { for(unsigned int i=0;i<v_kp1_.size();v_kp1_[i++]=0.0);};
@@ -1376,31 +1597,25 @@ void NMPCgenerator::updateCoPconstraint(Eigen::VectorXd &U)
   evalCoPconstraint(U);
 
   // build Acop_theta_
-  vector<double>theta_vec(nf_+1);
-  theta_vec[0]=SupportStates_deq_[1].Yaw;
-  for(unsigned i=0 ; i<nf_ ; ++i)
-  {
-    theta_vec[i+1]=U(2*N_+2*nf_+i); //F_kp1_theta_(i);
-  }
-  Eigen::MatrixXd U_xy(2*N_+2*nf_,1);
-  for(unsigned i=0; i<U_xy.size() ; ++i)
-    U_xy(i)=U(i);
+  // theta_vec_ has been filled by evalCoPconstraint()
+  for(unsigned i=0; i<Uxy_.size() ; ++i)
+    Uxy_(i)=U(i);
   // every time instant in the pattern generator constraints
   // depend on the support order
   for (unsigned i=0 ; i<N_ ; ++i)
   {
-    double theta = theta_vec[SupportStates_deq_[i+1].StepNumber] ;
+    double theta = theta_vec_[SupportStates_deq_[i+1].StepNumber] ;
     rotMat_theta_(0,0)=-sin(theta) ; rotMat_theta_(0,1)= cos(theta) ;
     rotMat_theta_(1,0)=-cos(theta) ; rotMat_theta_(1,1)=-sin(theta) ;
     if (SupportStates_deq_[i+1].Phase == DS)
     {
-      A0_theta_ = A0ds_*rotMat_theta_ ;
+      A0_theta_.noalias() = A0ds_*rotMat_theta_ ;
     }
     else if (SupportStates_deq_[i+1].Foot == LEFT)
     {
-      A0_theta_ = A0lf_*rotMat_theta_ ;
+      A0_theta_.noalias() = A0lf_*rotMat_theta_ ;
     }else{
-      A0_theta_ = A0rf_*rotMat_theta_ ;
+      A0_theta_.noalias() = A0rf_*rotMat_theta_ ;
     }
 
     for (unsigned k=0 ; k<A0_theta_.rows() ; ++k)
@@ -1411,9 +1626,9 @@ void NMPCgenerator::updateCoPconstraint(Eigen::VectorXd &U)
       D_kp1_theta_(i*A0_theta_.rows()+k, i+N_) = A0_theta_(k,1);
     }
   }
-  derv_Acop_map2_ = derv_Acop_map_*V_kp1_;
-  Acop_theta_dummy0_ = D_kp1_theta_*Pzuv_;
-  Acop_theta_dummy1_ = Acop_theta_dummy0_*U_xy;
+  derv_Acop_map2_.noalias() = derv_Acop_map_*V_kp1_;
+  Acop_theta_dummy0_.noalias() = D_kp1_theta_*Pzuv_;
+  Acop_theta_dummy1_.noalias() = Acop_theta_dummy0_*Uxy_;
   for(unsigned i=0 ; i<Acop_theta_.rows() ; ++i)
   {
     for(unsigned j=0 ; j<Acop_theta_.cols() ; ++j)
@@ -1431,30 +1646,29 @@ void NMPCgenerator::evalCoPconstraint(Eigen::VectorXd & U)
     return ;
 
   // Compute D_kp1_, it depends on the feet hulls
-  vector<double>theta_vec(nf_+1);
-  theta_vec[0]=SupportStates_deq_[1].Yaw;
+  theta_vec_[0]=SupportStates_deq_[1].Yaw;
   for(unsigned i=0 ; i<nf_ ; ++i)
   {
-    theta_vec[i+1]=U(2*N_+2*nf_+i); //F_kp1_theta_(i);
+    theta_vec_[i+1]=U(2*N_+2*nf_+i); //F_kp1_theta_(i);
   }
   // every time instant in the pattern generator constraints
   // depend on the support order
   for (unsigned i=0 ; i<N_ ; ++i)
   {
-    double theta = theta_vec[SupportStates_deq_[i+1].StepNumber] ;
+    double theta = theta_vec_[SupportStates_deq_[i+1].StepNumber] ;
     rotMat_xy_(0,0)= cos(theta) ; rotMat_xy_(0,1)= sin(theta) ;
     rotMat_xy_(1,0)=-sin(theta) ; rotMat_xy_(1,1)= cos(theta) ;
     if (SupportStates_deq_[i+1].Phase == DS)
     {
-      A0_xy_    = A0ds_*rotMat_xy_ ;
+      A0_xy_.noalias() = A0ds_*rotMat_xy_ ;
       B0_ = ubB0ds_ ;
     }
     else if (SupportStates_deq_[i+1].Foot == LEFT)
     {
-      A0_xy_    = A0lf_*rotMat_xy_ ;
+      A0_xy_.noalias() = A0lf_*rotMat_xy_ ;
       B0_ = ubB0lf_ ;
     }else{
-      A0_xy_    = A0rf_*rotMat_xy_ ;
+      A0_xy_.noalias() = A0rf_*rotMat_xy_ ;
       B0_ = ubB0rf_ ;
     }
     for (unsigned k=0 ; k<A0_xy_.rows() ; ++k)
@@ -1470,9 +1684,11 @@ void NMPCgenerator::evalCoPconstraint(Eigen::VectorXd & U)
   }
 
   // build Acop_xy_
-  Acop_xy_ = D_kp1_xy_*Pzuv_;
+  Acop_xy_.noalias() = D_kp1_xy_*Pzuv_;
   // build UBcop_
-  UBcop_ = b_kp1_ + D_kp1_xy_*(v_kp1f_-Pzsc_);
+  v_kp1f_Pzsc_ = v_kp1f_-Pzsc_ ;
+  UBcop_ = b_kp1_ ;
+  UBcop_.noalias() += D_kp1_xy_*v_kp1f_Pzsc_;
 
 #ifdef DEBUG
   DumpMatrix("Pzuv_",Pzuv_);
@@ -1560,9 +1776,8 @@ void NMPCgenerator::updateFootPoseConstraint(Eigen::VectorXd &U)
 //    ignoreFirstStep = nbFoot ;
 //  }
 
-  Afoot_xy_full_.resize(nc_foot_,2*(N_+nf_));
-  Afoot_theta_full_.resize(nc_foot_,nf_);
-  UBfoot_full_.resize(nc_foot_);
+  // The full matrices keep the rows of all the steps,
+  // only the first nc_foot_ ones are used.
   Afoot_xy_full_.setZero();
   Afoot_theta_full_.setZero();
   UBfoot_full_.setZero();
@@ -1571,49 +1786,26 @@ void NMPCgenerator::updateFootPoseConstraint(Eigen::VectorXd &U)
   evalFootPoseConstraint(U);
 
   // compute Afoot_theta_full_
-  // rotation matrice from F_k+1 to F_k
-  vector<support_state_t>support_state(nf_);
-  support_state[0]=SupportStates_deq_[1];
-  bool done = false ;
-  for(unsigned i=0, n=1; n<nf_&&i<N_ ; ++i)
-  {
-    if(support_state[n-1].Foot != SupportStates_deq_[i+1].Foot)
-    {
-      support_state[n]=SupportStates_deq_[i+1];
-      if(support_state[n].StepNumber!=0)
-      {
-        support_state[n].Yaw = U(2*N_+2*nf_+n-1); //F_kp1_theta_(n-1);
-      }
-      ++n;
-      done = true ;
-    }
-  }
-  if(!done)
-  {
-    for(unsigned n=1;n<support_state.size();++n)
-    {
-      support_state[n]=support_state[0];
-    }
-  }
-
+  // rotation matrice from F_k+1 to F_k, support_state_ has been
+  // filled by evalFootPoseConstraint() when the loop below is not empty
   for(unsigned n=ignoreFirstStep ; n<nf_ ; ++n)
   {
-    drotMat_vec_[n](0,0)=-sin(support_state[n].Yaw) ;
-    drotMat_vec_[n](0,1)= cos(support_state[n].Yaw) ;
-    drotMat_vec_[n](1,0)=-cos(support_state[n].Yaw) ;
-    drotMat_vec_[n](1,1)=-sin(support_state[n].Yaw) ;
+    drotMat_vec_[n](0,0)=-sin(support_state_[n].Yaw) ;
+    drotMat_vec_[n](0,1)= cos(support_state_[n].Yaw) ;
+    drotMat_vec_[n](1,0)=-cos(support_state_[n].Yaw) ;
+    drotMat_vec_[n](1,1)=-sin(support_state_[n].Yaw) ;
 
-    if (support_state[n].Foot == LEFT)
+    if (support_state_[n].Foot == LEFT)
     {
-      A0f_theta_[n] = A0r_*drotMat_vec_[n] ;
+      A0f_theta_[n].noalias() = A0r_*drotMat_vec_[n] ;
     }else{
-      A0f_theta_[n] = A0l_*drotMat_vec_[n] ;
+      A0f_theta_[n].noalias() = A0l_*drotMat_vec_[n] ;
     }
     if(n!=0)
     {
       deltaF_[n](0)=U(N_+n)-U(N_+n-1) ;//F_kp1_x_[n]-F_kp1_x_[n-1];
       deltaF_[n](1)=U(2*N_+nf_+n)-U(2*N_+nf_+n-1) ;//F_kp1_y_[n]-F_kp1_y_[n-1];
-      AdRdF_[n] = A0f_theta_[n]*deltaF_[n];
+      AdRdF_[n].noalias() = A0f_theta_[n]*deltaF_[n];
       double sum = 0.0 ;
       for (unsigned j=0 ; j<n_vertices_ ; ++j)
       {
@@ -1658,17 +1850,16 @@ void NMPCgenerator::evalFootPoseConstraint(Eigen::VectorXd & U)
     ignoreFirstStep=1;
 
   // rotation matrice from F_k+1 to F_k
-  vector<support_state_t>support_state(nf_);
-  support_state[0]=SupportStates_deq_[1];
+  support_state_[0]=SupportStates_deq_[1];
   bool done = false ;
   for(unsigned i=0, n=1; n<nf_&&i<N_ ; ++i)
   {
-    if(support_state[n-1].Foot != SupportStates_deq_[i+1].Foot)
+    if(support_state_[n-1].Foot != SupportStates_deq_[i+1].Foot)
     {
-      support_state[n]=SupportStates_deq_[i+1];
-      if(support_state[n].StepNumber!=0)
+      support_state_[n]=SupportStates_deq_[i+1];
+      if(support_state_[n].StepNumber!=0)
       {
-        support_state[n].Yaw = U(2*N_+2*nf_+n-1); //F_kp1_theta_(n-1);
+        support_state_[n].Yaw = U(2*N_+2*nf_+n-1); //F_kp1_theta_(n-1);
       }
       ++n;
       done = true ;
@@ -1676,29 +1867,28 @@ void NMPCgenerator::evalFootPoseConstraint(Eigen::VectorXd & U)
   }
   if(!done)
   {
-    for(unsigned n=1;n<support_state.size();++n)
+    for(unsigned n=1;n<support_state_.size();++n)
     {
-      support_state[n]=support_state[0];
+      support_state_[n]=support_state_[0];
     }
   }
 
   for(unsigned n=ignoreFirstStep ; n<nf_ ; ++n)
   {
-    rotMat_vec_[n](0,0)= cos(support_state[n].Yaw) ;
-    rotMat_vec_[n](0,1)= sin(support_state[n].Yaw) ;
-    rotMat_vec_[n](1,0)=-sin(support_state[n].Yaw) ;
-    rotMat_vec_[n](1,1)= cos(support_state[n].Yaw) ;
+    rotMat_vec_[n](0,0)= cos(support_state_[n].Yaw) ;
+    rotMat_vec_[n](0,1)= sin(support_state_[n].Yaw) ;
+    rotMat_vec_[n](1,0)=-sin(support_state_[n].Yaw) ;
+    rotMat_vec_[n](1,1)= cos(support_state_[n].Yaw) ;
 
-    if (support_state[n].Foot == LEFT)
+    if (support_state_[n].Foot == LEFT)
     {
-      A0f_xy_   [n] = A0r_*rotMat_vec_ [n] ;
+      A0f_xy_   [n].noalias() = A0r_*rotMat_vec_ [n] ;
       B0f_      [n] = ubB0r_ ;
     }else{
-      A0f_xy_   [n] = A0l_*rotMat_vec_ [n] ;
+      A0f_xy_   [n].noalias() = A0l_*rotMat_vec_ [n] ;
       B0f_      [n] = ubB0l_ ;
     }
-    Afoot_xy_   [n].setZero();
-    Afoot_xy_[n] = A0f_xy_[n]*SelecMat_[n];
+    Afoot_xy_[n].noalias() = A0f_xy_[n]*SelecMat_[n];
     for(unsigned i=0 ; i<n_vertices_ ;++i)
       for(unsigned j=0 ; j<2*(N_+nf_) ; ++j)
         Afoot_xy_full_((n-ignoreFirstStep)*n_vertices_+i,j)
@@ -2029,79 +2219,85 @@ void NMPCgenerator::initializeCostFunction()
 
 void NMPCgenerator::updateCostFunction()
 {
-  // Q_xXX = (  0.5 * a * Pvu^T   * Pvu + b * Pzu^T * Pzu + c * I )
-  // Q_xXF = ( -0.5 * b * Pzu^T   * V_kp1 )
-  // Q_xFX = ( -0.5 * b * V_kp1^T * Pzu )^T
-  // Q_xFF = (  0.5 * b * V_kp1^T * V_kp1 )
-  Q_x_XX_ = alpha_x_ * Pvu_.transpose() * Pvu_
-          + beta_    * Pzu_.transpose() * Pzu_
-          + minjerk_ * I_NN_ ;
-
-  // Q_xXX = (  0.5 * a * Pvu^T   * Pvu + b * Pzu^T * Pzu + c * I )
-  // Q_xXF = ( -0.5 * b * Pzu^T   * V_kp1 )
-  // Q_xFX = ( -0.5 * b * V_kp1^T * Pzu ) = Q_xXF^T
-  // Q_xFF = (  0.5 * b * V_kp1^T * V_kp1 - 0.5 * d * I_FF_)
-  Q_x_XF_ = - beta_ * Pzu_.transpose() *V_kp1_;
-  Q_x_FX_ =   Q_x_XF_.transpose();
-  Q_x_FF_ =   beta_ * V_kp1_.transpose() *V_kp1_
-            + delta_ * I_FF_
-            + kappa_ * diffMat_.transpose() * diffMat_;
-
-  // Q_yXX = (  0.5 * a * Pvu^T   * Pvu + b * Pzu^T * Pzu + c * I )
-  Q_y_XX_ = alpha_y_ * Pvu_.transpose() *Pvu_
-          + beta_    * Pzu_.transpose() *Pzu_
-          + minjerk_   * I_NN_ ;
-
-
-  // define QP matrices
-  // Gauss-Newton Hessian
-  //                                     dim :
-  // H = (( Q_xXX  Q_xXF   0      0       0     ) N_
-  //      ( Q_xFX  Q_xFF   0      0       0     ) nf_
-  //      (   0      0   Q_yXX  Q_xXF     0     ) N_
-  //      (   0      0   Q_xFX  Q_xFF     0     ) nf_
-  //      (   0      0     0      0    Q_theta_ ) nf_
-  //dim :     N_     nf_   N_     nf_    nf_     = nv_
-  //
-  unsigned Nnf = N_+nf_ ;
-  unsigned N2nf = 2*N_+nf_ ;
-  unsigned N2nf2 = 2*(N_+nf_) ;
-  qp_H_.setZero();
-  for(unsigned i=0 ; i<N_ ; ++i)
-  {
-    for(unsigned j=0 ; j<N_ ; ++j)
+  // The Hessian only depends on the initial condition
+  if(!hessianIsValid_)
+  {
+    // Q_xXX = (  0.5 * a * Pvu^T   * Pvu + b * Pzu^T * Pzu + c * I )
+    // Q_xXF = ( -0.5 * b * Pzu^T   * V_kp1 )
+    // Q_xFX = ( -0.5 * b * V_kp1^T * Pzu )^T
+    // Q_xFF = (  0.5 * b * V_kp1^T * V_kp1 )
+    Q_x_XX_.noalias() = alpha_x_ * Pvu_.transpose() * Pvu_ ;
+    Q_x_XX_.noalias() += beta_ * Pzu_.transpose() * Pzu_ ;
+    Q_x_XX_ += minjerk_ * I_NN_ ;
+
+    // Q_xXX = (  0.5 * a * Pvu^T   * Pvu + b * Pzu^T * Pzu + c * I )
+    // Q_xXF = ( -0.5 * b * Pzu^T   * V_kp1 )
+    // Q_xFX = ( -0.5 * b * V_kp1^T * Pzu ) = Q_xXF^T
+    // Q_xFF = (  0.5 * b * V_kp1^T * V_kp1 - 0.5 * d * I_FF_)
+    Q_x_XF_.noalias() = - beta_ * Pzu_.transpose() *V_kp1_;
+    Q_x_FX_ =   Q_x_XF_.transpose();
+    Q_x_FF_.noalias() = beta_ * V_kp1_.transpose() *V_kp1_ ;
+    Q_x_FF_ += delta_ * I_FF_ ;
+    Q_x_FF_.noalias() += kappa_ * diffMat_.transpose() * diffMat_;
+
+    // Q_yXX = (  0.5 * a * Pvu^T   * Pvu + b * Pzu^T * Pzu + c * I )
+    Q_y_XX_.noalias() = alpha_y_ * Pvu_.transpose() *Pvu_ ;
+    Q_y_XX_.noalias() += beta_ * Pzu_.transpose() *Pzu_ ;
+    Q_y_XX_ += minjerk_ * I_NN_ ;
+
+
+    // define QP matrices
+    // Gauss-Newton Hessian
+    //                                     dim :
+    // H = (( Q_xXX  Q_xXF   0      0       0     ) N_
+    //      ( Q_xFX  Q_xFF   0      0       0     ) nf_
+    //      (   0      0   Q_yXX  Q_xXF     0     ) N_
+    //      (   0      0   Q_xFX  Q_xFF     0     ) nf_
+    //      (   0      0     0      0    Q_theta_ ) nf_
+    //dim :     N_     nf_   N_     nf_    nf_     = nv_
+    //
+    unsigned Nnf = N_+nf_ ;
+    unsigned N2nf = 2*N_+nf_ ;
+    unsigned N2nf2 = 2*(N_+nf_) ;
+    qp_H_.setZero();
+    for(unsigned i=0 ; i<N_ ; ++i)
     {
-      qp_H_(i,j) = Q_x_XX_(i,j) ;
-      qp_H_(Nnf+i,Nnf+j) = Q_y_XX_(i,j) ;
+      for(unsigned j=0 ; j<N_ ; ++j)
+      {
+        qp_H_(i,j) = Q_x_XX_(i,j) ;
+        qp_H_(Nnf+i,Nnf+j) = Q_y_XX_(i,j) ;
+      }
     }
-  }
-  for(unsigned i=0 ; i<N_ ; ++i)
-  {
-    for(unsigned j=0 ; j<nf_ ; ++j)
+    for(unsigned i=0 ; i<N_ ; ++i)
     {
-      qp_H_(i,N_+j) = Q_x_XF_(i,j) ;
-      qp_H_(Nnf+i,N2nf+j) = Q_x_XF_(i,j) ;
+      for(unsigned j=0 ; j<nf_ ; ++j)
+      {
+        qp_H_(i,N_+j) = Q_x_XF_(i,j) ;
+        qp_H_(Nnf+i,N2nf+j) = Q_x_XF_(i,j) ;
+      }
     }
-  }
-  for(unsigned i=0 ; i<nf_ ; ++i)
-  {
-    for(unsigned j=0 ; j<N_ ; ++j)
+    for(unsigned i=0 ; i<nf_ ; ++i)
     {
-      qp_H_(N_+i,j) = Q_x_FX_(i,j) ;
-      qp_H_(N2nf+i,Nnf+j) = Q_x_FX_(i,j) ;
+      for(unsigned j=0 ; j<N_ ; ++j)
+      {
+        qp_H_(N_+i,j) = Q_x_FX_(i,j) ;
+        qp_H_(N2nf+i,Nnf+j) = Q_x_FX_(i,j) ;
+      }
     }
-  }
-  for(unsigned i=0 ; i<nf_ ; ++i)
-  {
-    for(unsigned j=0 ; j<nf_ ; ++j)
+    for(unsigned i=0 ; i<nf_ ; ++i)
     {
-      qp_H_(N_+i,N_+j) = Q_x_FF_(i,j) ;
-      qp_H_(N2nf+i,N2nf+j) = Q_x_FF_(i,j) ;
+      for(unsigned j=0 ; j<nf_ ; ++j)
+      {
+        qp_H_(N_+i,N_+j) = Q_x_FF_(i,j) ;
+        qp_H_(N2nf+i,N2nf+j) = Q_x_FF_(i,j) ;
+      }
     }
+    for(unsigned i=0 ; i< nf_ ;++i)
+      for(unsigned j=0 ; j<nf_ ;++j)
+        qp_H_(i+N2nf2,j+N2nf2)=Q_theta_(i,j) ;
+
+    updateHessianFactorization();
   }
-  for(unsigned i=0 ; i< nf_ ;++i)
-    for(unsigned j=0 ; j<nf_ ;++j)
-      qp_H_(i+N2nf2,j+N2nf2)=Q_theta_(i,j) ;
 
   // p_xy_ =  ( p_xy_X_, p_xy_Fx_, p_xy_Y_, p_xy_Fy_ )
   // p_xy_X  =   0.5 * a * Pvu^T   * ( Pvs * c_k_x - dX^ref )
@@ -2114,13 +2310,15 @@ void NMPCgenerator::updateCostFunction()
   cout << vel_ref_.Global.X << " "
        << vel_ref_.Global.Y << endl;
 #endif
-  Pvsc_x_ = Pvs_*c_k_x_ ;
-  Pvsc_y_ = Pvs_*c_k_y_ ;
+  Pvsc_x_.noalias() = Pvs_*c_k_x_ ;
+  Pvsc_y_.noalias() = Pvs_*c_k_y_ ;
   // Pzsc_x_, Pzsc_y_ , v_kp1f_x_ and v_kp1f_y_ already up to date
   //from the CoP constraint building function
 
-  p_xy_X_ =    alpha_x_ * Pvu_.transpose() *( Pvsc_x_ - vel_ref_.Global.X_vec)
-    + beta_    * Pzu_.transpose() *( Pzsc_x_ - v_kp1f_x_            );
+  dp_N_ = Pvsc_x_ - vel_ref_.Global.X_vec ;
+  p_xy_X_.noalias() = alpha_x_ * Pvu_.transpose() * dp_N_ ;
+  dp_N_ = Pzsc_x_ - v_kp1f_x_ ;
+  p_xy_X_.noalias() += beta_ * Pzu_.transpose() * dp_N_ ;
 #ifdef DEBUG
   DumpVector("Pvsc_x_"    , Pvsc_x_                    ) ;
   DumpVector("RefVectorX" , vel_ref_.Global.X_vec ) ;
@@ -2128,17 +2326,20 @@ void NMPCgenerator::updateCostFunction()
   DumpVector("v_kp1f_x_"  , v_kp1f_x_                  ) ;
 #endif
   v_kf_x_(0) = currentSupport_.X ;
-  p_xy_Fx_ = - beta_  * V_kp1_.transpose()*( Pzsc_x_ - v_kp1f_x_)
-    - delta_ * I_FF_*F_kp1_x_ ;
-  - kappa_ * diffMat_*v_kf_x_;
+  // dp_N_ = Pzsc_x_ - v_kp1f_x_
+  p_xy_Fx_.noalias() = - beta_ * V_kp1_.transpose() * dp_N_ ;
+  p_xy_Fx_.noalias() -= delta_ * I_FF_*F_kp1_x_ ;
+  //  - kappa_ * diffMat_*v_kf_x_;
 
-  p_xy_Y_  =   alpha_y_ * Pvu_.transpose() * (Pvsc_y_ - vel_ref_.Global.Y_vec)
-    + beta_    * Pzu_.transpose() *( Pzsc_y_ - v_kp1f_y_                 );
+  dp_N_ = Pvsc_y_ - vel_ref_.Global.Y_vec ;
+  p_xy_Y_.noalias() = alpha_y_ * Pvu_.transpose() * dp_N_ ;
+  dp_N_ = Pzsc_y_ - v_kp1f_y_ ;
+  p_xy_Y_.noalias() += beta_ * Pzu_.transpose() * dp_N_ ;
 
   v_kf_y_(0) = currentSupport_.Y ;
-  p_xy_Fy_ = - beta_  * V_kp1_.transpose() * ( Pzsc_y_ - v_kp1f_y_)
-             - delta_ * I_FF_*F_kp1_y_ ;
-             - kappa_ * diffMat_*v_kf_y_ ;
+  p_xy_Fy_.noalias() = - beta_ * V_kp1_.transpose() * dp_N_ ;
+  p_xy_Fy_.noalias() -= delta_ * I_FF_*F_kp1_y_ ;
+  //  - kappa_ * diffMat_*v_kf_y_ ;
 
 #ifdef DEBUG
   DumpVector("Pvsc_y_"    , Pvsc_y_                    ) ;
@@ -2178,7 +2379,8 @@ void NMPCgenerator::updateCostFunction()
 #ifdef DEBUG
   DumpVector( "U_x_" , U_x_ );
 #endif
-  qp_g_ = qp_H_*U_+p_;
+  qp_g_ = p_ ;
+  qp_g_.noalias() += qp_H_*U_ ;
 
 #ifdef DEBUG
   DumpMatrix("qp_H_",qp_H_);
@@ -2187,6 +2389,24 @@ void NMPCgenerator::updateCostFunction()
   return ;
 }
 
+void NMPCgenerator::updateHessianFactorization()
+{
+  // Once the weights and the CoM height are set, Q_x_XX_ and Q_y_XX_ only
+  // depend on Tfirst_, which takes a few values: their factors are cached
+  // under Tfirst_ in us. The cache checks the blocks before using them.
+  long key = (long)floor(Tfirst_*1e6+0.5);
+  hessianIsDecomposed_ =
+      hessianFactor_.factorize(key,Q_x_XX_,Q_y_XX_,Q_x_XF_,Q_x_FF_,
+                               Q_theta_,QuadProg_H_);
+  if(!hessianIsDecomposed_)
+  {
+    // Let QuadProg try and report the failure.
+    ODEBUG("Hessian factorization failed");
+    QuadProg_H_ = qp_H_ ;
+  }
+  hessianIsValid_ = true ;
+}
+
 void NMPCgenerator::setLocalVelocityReference(reference_t local_vel_ref)
 {
   vel_ref_.Local = local_vel_ref.Local ;
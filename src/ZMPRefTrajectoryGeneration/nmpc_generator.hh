@@ -30,6 +30,8 @@
 
 #include <jrl/walkgen/pgtypes.hh>
 #include <Mathematics/relative-feet-inequalities.hh>
+#include <LatencyHistogram.hh>
+#include <ZMPRefTrajectoryGeneration/nmpc_hessian_factor.hh>
 #include <jrl/walkgen/pinocchiorobot.hh>
 #include <iomanip>
 #include <cmath>
@@ -37,6 +39,53 @@
 
 namespace PatternGeneratorJRL
 {
+  /// \brief Part of NMPCgenerator kept from one iteration to the next:
+  /// initial condition, support states and warm start.
+  struct nmpc_state_t
+  {
+    double time ;
+    Eigen::VectorXd c_k_x, c_k_y ;
+    double c_k_z ;
+    support_state_t currentSupport ;
+    RingBuffer<support_state_t> SupportStates_deq ;
+    FootAbsolutePosition currentLeftFootAbsolutePosition ;
+    FootAbsolutePosition currentRightFootAbsolutePosition ;
+    std::deque<RelativeFootPosition> desiredNextSupportFootRelativePosition ;
+    reference_t vel_ref ;
+    double Tfirst ;
+    Eigen::VectorXd U, U_xy, U_x, U_y ;
+    Eigen::VectorXd F_kp1_x, F_kp1_y, F_kp1_theta ;
+  };
+
+  /// \brief Report of the last call to NMPCgenerator::solve().
+  struct nmpc_solve_status_t
+  {
+    /// \brief Number of SQP iterations done.
+    unsigned NbOfIterations ;
+    /// \brief The last step was small enough to stop.
+    bool Converged ;
+    /// \brief The iterations were stopped by the time budget.
+    bool DeadlineReached ;
+    /// \brief A QP failed. With a solve budget, its step has not
+    /// been applied.
+    bool QPFailed ;
+    /// \brief The returned iterate satisfies the inequality constraints.
+    bool Feasible ;
+    /// \brief Sum of the violations of the inequality constraints
+    /// by the returned iterate.
+    double ConstraintViolation ;
+    /// \brief Wall-clock time spent in solve() (s).
+    double Duration ;
+    /// \brief Wall-clock time of each iteration (s).
+    std::vector<double> IterationDurations ;
+
+    nmpc_solve_status_t():
+      NbOfIterations(0), Converged(false), DeadlineReached(false),
+      QPFailed(false), Feasible(false), ConstraintViolation(0.0),
+      Duration(0.0)
+    {}
+  };
+
   class NMPCgenerator
   {
   public:
@@ -54,8 +103,45 @@ namespace PatternGeneratorJRL
                                 COMState & currentCOMState,
                                 reference_t & local_vel_ref
                                 );
+    /// \brief Run the SQP iterations.
+    /// The iterations stop when the step is small enough, after
+    /// maxSolverIteration() iterations, or when the next iteration is
+    /// expected to end after solveBudget(). At least one iteration is done.
+    /// Without budget, every step is applied, even the one of a failed
+    /// QP, and the last iterate is returned.
+    /// With a budget, a failed QP stops the iterations without applying
+    /// its step, and the returned iterate is the best one found: the last
+    /// feasible iterate, or the least infeasible one if none is feasible.
     void solve();
 
+    /// \brief Wall-clock budget of solve() in seconds, 0 for no budget.
+    inline double solveBudget() const
+    { return solveBudget_; }
+    inline void solveBudget(double solveBudget)
+    { solveBudget_ = solveBudget; }
+
+    /// \brief Maximal number of SQP iterations in solve().
+    inline unsigned maxSolverIteration() const
+    { return maxSolverIteration_; }
+    inline void maxSolverIteration(unsigned maxSolverIteration)
+    {
+      maxSolverIteration_ = (maxSolverIteration>0) ? maxSolverIteration : 1;
+      solveStatus_.IterationDurations.reserve(maxSolverIteration_);
+    }
+
+    /// \brief Report of the last call to solve().
+    inline const nmpc_solve_status_t & solveStatus() const
+    { return solveStatus_; }
+
+    /// \brief Profile receiving the QP build and solve latencies,
+    /// 0 to disable. It has to be fed by a single thread.
+    inline void latencyProfile(LatencyProfile * aProfile)
+    { latencyProfile_ = aProfile; }
+
+    /// \brief Cache of the factors of the Hessian.
+    inline const NMPCHessianFactor & hessianFactor() const
+    { return hessianFactor_; }
+
   private:
 
     //////////////////////
@@ -64,6 +150,10 @@ namespace PatternGeneratorJRL
     void preprocess_solution() ;
     void solve_qp()            ;
     void postprocess_solution();
+    // Copy U_ into the vectors read by the generator.
+    void updateSolutionVectors();
+    // Sum of the violations of the inequality constraints by U_.
+    double evalConstraintViolation();
 
     ///////////////////
     // Build Matrices :
@@ -116,6 +206,9 @@ namespace PatternGeneratorJRL
     // build the cost function
     void initializeCostFunction();
     void updateCostFunction();
+    // Give the Hessian to QuadProg through its inverse factor,
+    // computed once per control cycle
+    void updateHessianFactorization();
 
     // tools for line search
     void initializeLineSearch();
@@ -150,7 +243,7 @@ namespace PatternGeneratorJRL
                      std::vector<double> &FootStepX,
                      std::vector<double> &FootStepY,
                      std::vector<double> &FootStepYaw);
-    inline std::deque<support_state_t> const & SupportStates_deq() const
+    inline RingBuffer<support_state_t> const & SupportStates_deq() const
     { return SupportStates_deq_ ; }
 
     inline void addOneObstacle(double x, double y, double r)
@@ -209,6 +302,10 @@ namespace PatternGeneratorJRL
     std::deque <RelativeFootPosition> & relativeSupportDeque()
     {return desiredNextSupportFootRelativePosition;}
 
+    // Snapshot of the state
+    void getState(nmpc_state_t & aState) const;
+    void setState(const nmpc_state_t & aState);
+
 
   private:
     SimplePluginManager * SPM_ ;
@@ -219,6 +316,9 @@ namespace PatternGeneratorJRL
 
     double time_;
 
+    // Number of solver calls dumped in iteration_solver.dat (DEBUG only)
+    unsigned iterationSolverFile_ ;
+
     // [x, dx, ddx], com (pos, vel, acc) at instant t_k on axis X
     Eigen::VectorXd c_k_x_;
     // [y, dy, ddy], com (pos, vel, acc) at instant t_k on axis Y
@@ -238,7 +338,7 @@ namespace PatternGeneratorJRL
     // currentSupport_.y, support foot at time t_k on axis Y
     // currentSupport_.theta, support foot at time t_k around axis Z
     support_state_t currentSupport_ ;
-    std::deque<support_state_t> SupportStates_deq_ ;
+    RingBuffer<support_state_t> SupportStates_deq_ ;
     FootAbsolutePosition currentLeftFootAbsolutePosition_;
     FootAbsolutePosition currentRightFootAbsolutePosition_;
     SupportFSM * FSM_ ;
@@ -252,6 +352,7 @@ namespace PatternGeneratorJRL
     Eigen::MatrixXd D_kp1_xy_, D_kp1_theta_, Pzuv_, derv_Acop_map_  ;
     Eigen::MatrixXd derv_Acop_map2_ ;
     Eigen::VectorXd b_kp1_, Pzsc_, Pzsc_x_, Pzsc_y_, v_kp1f_, v_kp1f_x_, v_kp1f_y_ ;
+    Eigen::VectorXd v_kp1f_Pzsc_ ; // v_kp1f_ - Pzsc_
     Eigen::VectorXd v_kf_x_, v_kf_y_ ;
     Eigen::MatrixXd diffMat_ ;
     Eigen::MatrixXd rotMat_xy_, rotMat_theta_, rotMat_;
@@ -259,6 +360,7 @@ namespace PatternGeneratorJRL
     Eigen::VectorXd B0_;
     Eigen::MatrixXd Acop_theta_dummy0_;
     Eigen::VectorXd Acop_theta_dummy1_;
+    std::vector<double> theta_vec_ ; // support yaw, then F_kp1_theta_
 
     // Foot position constraint
     unsigned nc_foot_ ;
@@ -277,6 +379,7 @@ namespace PatternGeneratorJRL
     std::vector<Eigen::VectorXd> AdRdF_ ;
     Eigen::MatrixXd Afoot_xy_full_, Afoot_theta_full_  ;
     Eigen::VectorXd UBfoot_full_ ;
+    std::vector<support_state_t> support_state_ ; // support of each step
 
     // Foot Velocity constraint
     unsigned nc_vel_ ;
@@ -302,6 +405,7 @@ namespace PatternGeneratorJRL
     std::vector< Eigen::VectorXd > UBobs_ ;
     std::vector<Circle> obstacles_ ;
     Eigen::VectorXd qp_J_obs_i_ ;
+    Eigen::VectorXd HobsUxy_ ;
     // Standing constraint :
     unsigned nc_stan_ ;
     Eigen::MatrixXd Astan_ ;
@@ -325,6 +429,7 @@ namespace PatternGeneratorJRL
     // p_xy_ = ( p_xy_X_, p_xy_Fx_, p_xy_Y_, p_xy_Fy_ )
     Eigen::VectorXd p_xy_X_, p_xy_Fx_, p_xy_Y_, p_xy_Fy_ ;
     Eigen::VectorXd Pvsc_x_ , Pvsc_y_ ;
+    Eigen::VectorXd dp_N_ ; // difference of two N_ vectors
 
     // decomposition of Q_x_=Q_y_
     // Q_x = ( Q_x_XX Q_x_XF ) = Q_y
@@ -332,6 +437,13 @@ namespace PatternGeneratorJRL
     Eigen::MatrixXd Q_x_XX_, Q_x_XF_, Q_x_FX_, Q_x_FF_ ;
     Eigen::MatrixXd Q_y_XX_;// Q_x_XX_ != Q_y_XX_
 
+    // The Hessian does not change during the SQP iterations of a
+    // control cycle: it is built and factorized by the first one only.
+    bool hessianIsValid_ ;
+    // QuadProg_H_ holds R^-1 with qp_H_ = R^T R
+    bool hessianIsDecomposed_ ;
+    NMPCHessianFactor hessianFactor_ ;
+
     // Line Search
     bool useLineSearch_ ;
     Eigen::VectorXd p_ , U_n_, selectActiveConstraint ;
@@ -345,6 +457,13 @@ namespace PatternGeneratorJRL
     bool oneMoreStep_ ;
     unsigned maxSolverIteration_ ;
 
+    // Anytime solver
+    double solveBudget_ ;
+    double feasibilityThreshold_ ;
+    Eigen::VectorXd bestU_ ;
+    nmpc_solve_status_t solveStatus_ ;
+    LatencyProfile * latencyProfile_ ;
+
     // Gauss-Newton Hessian
     unsigned nceq_ ;
     unsigned ncineq_ ;
@@ -456,6 +575,11 @@ namespace PatternGeneratorJRL
     Eigen::QuadProgDense * QP_ ;
     Eigen::MatrixXd QuadProg_H_, QuadProg_J_eq_, QuadProg_J_ineq_;
     Eigen::VectorXd QuadProg_g_, QuadProg_bJ_eq_, QuadProg_lbJ_ineq_, deltaU_;
+    // QP and constraints of the other set of constraints, swapped with
+    // the ones above when the swing foot is about to land or has landed
+    Eigen::QuadProgDense * spareQP_ ;
+    Eigen::MatrixXd spareQuadProg_J_eq_, spareQuadProg_J_ineq_;
+    Eigen::VectorXd spareQuadProg_bJ_eq_, spareQuadProg_lbJ_ineq_;
     Eigen::VectorXd deltaU_thresh_ ;
   };
 
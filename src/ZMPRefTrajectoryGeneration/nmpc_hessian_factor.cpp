@@ -0,0 +1,154 @@
+/*
+ * Copyright 2019,
+ *
+ * Olivier Stasse
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+/*! \file nmpc_hessian_factor.cpp
+  \brief Factorization of the NMPC Hessian reused from one QP to the next. */
+
+#include <ZMPRefTrajectoryGeneration/nmpc_hessian_factor.hh>
+
+#include <Debug.hh>
+
+using namespace std;
+using namespace PatternGeneratorJRL;
+
+NMPCHessianFactor::NMPCHessianFactor():
+  maxCacheSize_(64),
+  hits_(0),
+  misses_(0)
+{}
+
+void NMPCHessianFactor::clear()
+{
+  cache_.clear();
+}
+
+bool NMPCHessianFactor::inverseFactor(const Eigen::MatrixXd & Q,
+                                      Eigen::MatrixXd & Rinv)
+{
+  llt_.compute(Q);
+  if (llt_.info()!=Eigen::Success)
+    return false;
+  // Q = R^T R with R = L^T, the back substitution keeps
+  // the lower part of Rinv to zero.
+  Rinv.setIdentity(Q.rows(),Q.cols());
+  llt_.matrixU().solveInPlace(Rinv);
+  return true;
+}
+
+const NMPCHessianFactor::xx_factor_t *
+NMPCHessianFactor::jerkFactors(long key,
+                               const Eigen::MatrixXd & Q_x_XX,
+                               const Eigen::MatrixXd & Q_y_XX)
+{
+  std::map<long, xx_factor_t>::iterator it = cache_.find(key);
+  if (it!=cache_.end() &&
+      it->second.Q_x_XX.rows()==Q_x_XX.rows() &&
+      it->second.Q_x_XX.isApprox(Q_x_XX,1e-12) &&
+      it->second.Q_y_XX.isApprox(Q_y_XX,1e-12))
+  {
+    hits_++;
+    return &it->second;
+  }
+  misses_++;
+
+  if (it==cache_.end())
+  {
+    if (cache_.size()>=maxCacheSize_)
+      cache_.clear();
+    it = cache_.insert(make_pair(key,xx_factor_t())).first;
+  }
+  xx_factor_t & aFactor = it->second;
+  aFactor.Q_x_XX = Q_x_XX;
+  aFactor.Q_y_XX = Q_y_XX;
+  bool ok = inverseFactor(Q_x_XX,aFactor.Rinv_x);
+  if (ok)
+  {
+    // Both blocks are equal when the velocity weights are.
+    if (Q_y_XX.isApprox(Q_x_XX,1e-12))
+      aFactor.Rinv_y = aFactor.Rinv_x;
+    else
+      ok = inverseFactor(Q_y_XX,aFactor.Rinv_y);
+  }
+  if (!ok)
+  {
+    ODEBUG("Jerk block of the Hessian not positive definite");
+    cache_.erase(it);
+    return 0;
+  }
+  return &aFactor;
+}
+
+bool NMPCHessianFactor::factorizeFeet(const Eigen::MatrixXd & Rinv_XX,
+                                      const Eigen::MatrixXd & Q_XF,
+                                      const Eigen::MatrixXd & Q_FF,
+                                      unsigned offset,
+                                      Eigen::MatrixXd & Rinv)
+{
+  unsigned N = (unsigned)Rinv_XX.rows();
+  unsigned nf = (unsigned)Q_FF.rows();
+
+  // ( R_XX R_XF ) with R_XX^T R_XF = Q_XF
+  // (  0   R_FF )     R_FF^T R_FF = Q_FF - R_XF^T R_XF
+  R_XF_.noalias() =
+    Rinv_XX.triangularView<Eigen::Upper>().transpose() * Q_XF;
+  S_FF_ = Q_FF;
+  S_FF_.noalias() -= R_XF_.transpose() * R_XF_;
+  if (!inverseFactor(S_FF_,Rinv_FF_))
+    return false;
+
+  // R^-1 = ( R_XX^-1  -R_XX^-1 R_XF R_FF^-1 )
+  //        (    0             R_FF^-1       )
+  Rinv_tmp_.noalias() = R_XF_ * Rinv_FF_.triangularView<Eigen::Upper>();
+  Rinv_tmp_ *= -1.0;
+  Rinv.block(offset,offset,N,N) = Rinv_XX;
+  Rinv.block(offset,offset+N,N,nf).noalias() =
+    Rinv_XX.triangularView<Eigen::Upper>() * Rinv_tmp_;
+  Rinv.block(offset+N,offset+N,nf,nf) = Rinv_FF_;
+  return true;
+}
+
+bool NMPCHessianFactor::factorize(long key,
+                                  const Eigen::MatrixXd & Q_x_XX,
+                                  const Eigen::MatrixXd & Q_y_XX,
+                                  const Eigen::MatrixXd & Q_XF,
+                                  const Eigen::MatrixXd & Q_FF,
+                                  const Eigen::MatrixXd & Q_theta,
+                                  Eigen::MatrixXd & Rinv)
+{
+  unsigned N = (unsigned)Q_x_XX.rows();
+  unsigned nf = (unsigned)Q_FF.rows();
+  unsigned Nnf = N+nf;
+  unsigned nv = 2*Nnf+nf;
+
+  const xx_factor_t * aFactor = jerkFactors(key,Q_x_XX,Q_y_XX);
+  if (aFactor==0)
+    return false;
+
+  Rinv.setZero(nv,nv);
+  if (!factorizeFeet(aFactor->Rinv_x,Q_XF,Q_FF,0,Rinv) ||
+      !factorizeFeet(aFactor->Rinv_y,Q_XF,Q_FF,Nnf,Rinv) ||
+      !inverseFactor(Q_theta,Rinv_FF_))
+    return false;
+  Rinv.block(2*Nnf,2*Nnf,nf,nf) = Rinv_FF_;
+  return true;
+}
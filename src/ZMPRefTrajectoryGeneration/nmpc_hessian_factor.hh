@@ -0,0 +1,122 @@
+/*
+ * Copyright 2019,
+ *
+ * Olivier Stasse
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+/*! \file nmpc_hessian_factor.hh
+  \brief Factorization of the NMPC Hessian reused from one QP to the next. */
+
+#ifndef NMPC_HESSIAN_FACTOR_H
+#define NMPC_HESSIAN_FACTOR_H
+
+#include <map>
+
+#include <Eigen/Dense>
+
+namespace PatternGeneratorJRL
+{
+  /// \brief Inverse Cholesky factor of the Gauss-Newton Hessian of
+  /// NMPCgenerator, in the form expected by QuadProgDense when the
+  /// Hessian is given decomposed.
+  ///
+  /// The Hessian is
+  /// \f[ H = \left( \begin{array}{ccc}
+  ///     H_x & 0 & 0 \\ 0 & H_y & 0 \\ 0 & 0 & Q_{\theta}
+  ///     \end{array} \right), \quad
+  ///     H_x = \left( \begin{array}{cc}
+  ///     Q_{x,XX} & Q_{XF} \\ Q_{XF}^T & Q_{FF}
+  ///     \end{array} \right) \f]
+  /// and \f$H_y\f$ has the same structure with \f$Q_{y,XX}\f$.
+  /// factorize() computes the upper triangular \f$R^{-1}\f$ with
+  /// \f$H = R^T R\f$.
+  ///
+  /// The jerk blocks \f$Q_{x,XX}\f$ and \f$Q_{y,XX}\f$ only depend on the
+  /// sampling of the preview, which takes a few values while walking.
+  /// Their factors are cached under a key given by the caller, and checked
+  /// against the blocks before being used. Only the blocks of the feet,
+  /// which depend on the support states, are factorized on each call:
+  /// this costs \f$O(N^2 n_f)\f$ instead of \f$O((N+n_f)^3)\f$.
+  class NMPCHessianFactor
+  {
+  public:
+    NMPCHessianFactor();
+
+    /// \brief Compute the inverse factor of the Hessian in Rinv.
+    /// Returns false if a block is not positive definite,
+    /// Rinv is then meaningless.
+    bool factorize(long key,
+                   const Eigen::MatrixXd & Q_x_XX,
+                   const Eigen::MatrixXd & Q_y_XX,
+                   const Eigen::MatrixXd & Q_XF,
+                   const Eigen::MatrixXd & Q_FF,
+                   const Eigen::MatrixXd & Q_theta,
+                   Eigen::MatrixXd & Rinv);
+
+    /// \brief Drop the cached factors.
+    void clear();
+
+    /// \brief Number of cached factors above which the cache is emptied.
+    inline void maxCacheSize(unsigned aSize)
+    { maxCacheSize_ = aSize; }
+    inline unsigned cacheSize() const
+    { return (unsigned)cache_.size(); }
+
+    /// \brief Number of calls to factorize() which found, or not, the
+    /// factors of the jerk blocks in the cache.
+    inline unsigned long hits() const
+    { return hits_; }
+    inline unsigned long misses() const
+    { return misses_; }
+
+  private:
+    struct xx_factor_t
+    {
+      Eigen::MatrixXd Q_x_XX, Q_y_XX ;
+      /// Upper triangular inverse factors of Q_x_XX and Q_y_XX.
+      Eigen::MatrixXd Rinv_x, Rinv_y ;
+    };
+
+    /// \brief Factors of the jerk blocks, computed if not cached.
+    const xx_factor_t * jerkFactors(long key,
+                                    const Eigen::MatrixXd & Q_x_XX,
+                                    const Eigen::MatrixXd & Q_y_XX);
+
+    /// \brief Upper triangular inverse factor of Q in Rinv.
+    bool inverseFactor(const Eigen::MatrixXd & Q, Eigen::MatrixXd & Rinv);
+
+    /// \brief Fill the block of H_x or H_y starting at offset.
+    bool factorizeFeet(const Eigen::MatrixXd & Rinv_XX,
+                       const Eigen::MatrixXd & Q_XF,
+                       const Eigen::MatrixXd & Q_FF,
+                       unsigned offset,
+                       Eigen::MatrixXd & Rinv);
+
+    std::map<long, xx_factor_t> cache_ ;
+    unsigned maxCacheSize_ ;
+    unsigned long hits_, misses_ ;
+
+    // Temporaries
+    Eigen::LLT<Eigen::MatrixXd> llt_ ;
+    Eigen::MatrixXd R_XF_, S_FF_, Rinv_FF_, Rinv_tmp_ ;
+  };
+}
+
+#endif // NMPC_HESSIAN_FACTOR_H
@@ -40,6 +40,7 @@
 #include <exception>
 
 #include <ZMPRefTrajectoryGeneration/qp-problem.hh>
+#include <QPCapture.hh>
 
 #ifdef LSSOL_FOUND
 # include <lssol/lssol.h>
@@ -56,7 +57,9 @@ QPProblem::QPProblem():
       iout_(0),ifail_(0), iprint_(0),
       lwar_(0), liwar_(0), eps_(0),
       NbVariables_(0), NbConstraints_(0),NbEqConstraints_(0),
-      nbInvariantRows_(0),nbInvariantCols_(0)
+      Race_(0),
+      nbInvariantRows_(0),nbInvariantCols_(0),
+      Time_(0.0)
 
 {
   NbVariables_ = 0;
@@ -90,6 +93,17 @@ QPProblem::QPProblem():
 QPProblem::~QPProblem()
 {
   release_memory();
+  if (Race_!=0)
+    delete Race_;
+}
+
+
+QPRace &
+QPProblem::race()
+{
+  if (Race_==0)
+    Race_ = new QPRace();
+  return *Race_;
 }
 
 
@@ -303,6 +317,63 @@ QPProblem::solve( solver_e Solver, solution_t & Result, const tests_e & tests )
         std::cout << "nb iterations : " << nb_itt_approx << std::endl;
     }
 
+    break;
+  case ACTIVE_SET:
+
+    ifail_ = ActiveSetSolver_.solve(n_, m_, me_, Q_dense_.Array_, D_.Array_,
+                                    DU_dense_.Array_, mmax_, DS_.Array_,
+                                    XL_.Array_, XU_.Array_,
+                                    X_.Array_, U_.Array_);
+
+    for(int i = 0; i < n_; i++)
+      {
+        Result.Solution_vec(i) = X_.Array_[i];
+        Result.LBoundsLagr_vec(i) = U_.Array_[m_+i];
+        Result.UBoundsLagr_vec(i) = U_.Array_[m_+n_+i];
+      }
+    for(int i = 0; i < m_; i++)
+      {
+        Result.ConstrLagr_vec(i) = U_.Array_[i];
+      }
+
+    Result.Fail = ifail_;
+    Result.Print = 0;
+    Result.NbIterations = ActiveSetSolver_.NbIterations();
+
+    if (tests==ITT || tests==ALL)
+      std::cout << "nb iterations : " << Result.NbIterations
+                << " (hot start: " << ActiveSetSolver_.NbHotStartConstraints()
+                << " constraints)" << std::endl;
+
+    break;
+  case RACE:
+
+    // The copies of the race follow the capacity of the arrays,
+    // which grows seldom, and do not allocate at each race.
+    race().reserve((int)Q_.NbCols_,(int)DS_.NbRows_);
+    ifail_ = race().solve(n_, m_, me_, Q_dense_.Array_, D_.Array_,
+                          DU_dense_.Array_, mmax_, DS_.Array_,
+                          XL_.Array_, XU_.Array_,
+                          X_.Array_, U_.Array_);
+
+    for(int i = 0; i < n_; i++)
+      {
+        Result.Solution_vec(i) = X_.Array_[i];
+        Result.LBoundsLagr_vec(i) = U_.Array_[m_+i];
+        Result.UBoundsLagr_vec(i) = U_.Array_[m_+n_+i];
+      }
+    for(int i = 0; i < m_; i++)
+      {
+        Result.ConstrLagr_vec(i) = U_.Array_[i];
+      }
+
+    Result.Fail = ifail_;
+    Result.Print = 0;
+
+    if (tests==ITT || tests==ALL)
+      std::cout << "race won by " << QPRace::name(Race_->winner())
+                << std::endl;
+
     break;
   case LSSOL:
 #ifdef LSSOL_FOUND
@@ -403,6 +474,14 @@ QPProblem::solve( solver_e Solver, solution_t & Result, const tests_e & tests )
 
   }
 
+  QPCapture & aCapture = QPCapture::Instance();
+  if (aCapture.IsRunning())
+    aCapture.Record(QP_CAPTURE_QPPROBLEM, Time_, n_, m_, me_,
+                    Q_dense_.Array_, D_.Array_,
+                    DU_dense_.Array_, mmax_, DS_.Array_,
+                    XL_.Array_, XU_.Array_,
+                    X_.Array_, Result.Fail);
+
 }
 
 
@@ -30,6 +30,8 @@
 
 
 #include <Mathematics/qld.hh>
+#include <Mathematics/active-set-qp.hh>
+#include <Mathematics/qp-race.hh>
 #include <privatepgtypes.hh>
 #include <PreviewControl/rigid-body-system.hh>
 #include <PreviewControl/rigid-body.hh>
@@ -101,6 +103,23 @@ namespace PatternGeneratorJRL
     /// \brief Set variant elements to zero
     int reset_variant();
 
+    /// \brief Provide the factorization of the Hessian to the
+    /// active-set solver. It is ignored if the Hessian differs from Q.
+    ///
+    /// \param[in] Q Hessian
+    /// \param[in] J0 Matrix such that \f$ J0 J0^T = Q^{-1} \f$
+    inline void hessian_factorization( const Eigen::MatrixXd & Q,
+                                       const Eigen::MatrixXd & J0 )
+    {
+      ActiveSetSolver_.factorization(Q,J0);
+      if (Race_!=0)
+        Race_->factorization(Q,J0);
+    };
+
+    /// \brief Solvers used with RACE. The threads are started
+    /// by QPRace::start() or by the first race.
+    QPRace & race();
+
     /// \brief Solve the optimization problem
     ///
     /// \param[in] Solver
@@ -134,6 +153,12 @@ namespace PatternGeneratorJRL
     { nbInvariantCols_ = nbInvariantCols;};
     inline unsigned int nbInvariantCols()
     { return nbInvariantCols_;};
+
+    /// \brief Time of the problem, recorded with it by QPCapture
+    inline void Time( double Time )
+    { Time_ = Time;};
+    inline double Time()
+    { return Time_;};
     /// \}
 
     /// \brief Print_ array
@@ -297,6 +322,13 @@ namespace PatternGeneratorJRL
     double eps_;
     /// \}
 
+    /// \brief Active-set solver, keeps its factorization
+    /// and its working set between two calls.
+    ActiveSetQP ActiveSetSolver_;
+
+    /// \brief Solvers racing with RACE, created on demand.
+    QPRace * Race_;
+
     ///  \brief Robot
     RigidBodySystem * Robot_;
 
@@ -315,6 +347,9 @@ namespace PatternGeneratorJRL
     /// \brief First row and column of variant Hessian part
     unsigned nbInvariantRows_, nbInvariantCols_;
 
+    /// \brief Time of the problem
+    double Time_;
+
   };
 
 }
@@ -358,6 +358,16 @@ namespace PatternGeneratorJRL
     /*! \brief This method register a method to a specific object which derivates from SimplePlugin class. */
     bool RegisterMethod(string &MethodName, SimplePlugin *aSP);
 
+    /*! \brief Resolve once the name of a command into a handle
+      for CallCommand(). Returns -1 if no object registered the command. */
+    CommandHandle ResolveCommand(const std::string &aCommandName);
+
+    /*! \brief Call all the objects which registered a resolved command,
+      with typed arguments and without any parsing.
+      Returns false if the handle is invalid. */
+    bool CallCommand(CommandHandle aHandle,
+		     const CommandArguments &Arguments);
+
     /*! @} */
 
 
@@ -392,6 +402,39 @@ namespace PatternGeneratorJRL
     void setCoMPerturbationForce(double x,
 			      double y);
 
+    /*! \name Snapshot of the generator state.
+      @{ */
+
+    /*! \brief Capture the state of the pattern generator.
+      Returns -1 if the current algorithm does not support it. */
+    SnapshotHandle Snapshot();
+
+    /*! \brief Set back the state captured by Snapshot(). */
+    bool Restore(SnapshotHandle aHandle);
+
+    /*! \brief Give back the storage of a snapshot. */
+    void ReleaseSnapshot(SnapshotHandle aHandle);
+
+    /*! @} */
+
+    /*! \brief Copy a time window of the planned trajectory
+      as structure of arrays. */
+    unsigned int GetTrajectoryWindow(unsigned int NbOfSamples,
+				     TrajectoryWindow & aWindow) const;
+
+    /*! \brief Latency statistics of a stage of the control cycle. */
+    void GetStageLatency(ControlCycleStage aStage,
+			 StageLatency & aLatency) const;
+
+    /*! \brief Restart the measurement of all the stages. */
+    void ResetStageLatencies();
+
+    /*! \brief Metrics of the asynchronous planning of Naveau 2015. */
+    bool GetPlannerStatistics(PlannerStatistics & aStatistics) const;
+
+    /*! \brief Report of the last SQP solve of Naveau 2015. */
+    bool GetSQPSolveStatus(SQPSolveStatus & aStatus) const;
+
   protected:
 
     /*! \name Methods for interpreter.
@@ -605,6 +648,19 @@ namespace PatternGeneratorJRL
 
     bool m_feedBackControl ;
 
+    /*! \name Real-time mode.
+      When set, the buffers are preallocated at initialization
+      and no heap allocation should occur inside
+      RunOneStepOfTheControlLoop (see AllocationMonitor).
+      @{
+     */
+    bool m_RealTimeMode;
+
+    /*! \brief Scratch vectors used by the overloads of
+      RunOneStepOfTheControlLoop which do not return the full state. */
+    Eigen::VectorXd m_RTConfiguration, m_RTVelocity,
+      m_RTAcceleration, m_RTZMPTarget;
+    /*! @} */
 
 
     /*! \name To handle a new step.
@@ -698,16 +754,70 @@ namespace PatternGeneratorJRL
      */
 
     /*! Buffer of ZMP positions */
-    deque<ZMPPosition> m_ZMPPositions;
+    RingBuffer<ZMPPosition> m_ZMPPositions;
 
     /*! Buffer of Absolute foot position (World frame) */
-    deque<FootAbsolutePosition> m_FootAbsolutePositions;
+    RingBuffer<FootAbsolutePosition> m_FootAbsolutePositions;
 
     /*! Buffer of absolute foot position. */
-    deque<FootAbsolutePosition> m_LeftFootPositions, m_RightFootPositions;
+    RingBuffer<FootAbsolutePosition> m_LeftFootPositions, m_RightFootPositions;
 
     /*! Buffer for the COM position. */
-    deque<COMState> m_COMBuffer;
+    RingBuffer<COMState> m_COMBuffer;
+
+    /*! @} */
+
+    /*! \name Snapshots of the generator state.
+      @{
+     */
+
+    /*! \brief Storage of one snapshot. A released slot keeps its
+      buffers and its generator state, so that capturing again
+      only copies the values. */
+    struct Snapshot_t
+    {
+      EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+      bool Used;
+      int AlgorithmforZMPCOM;
+
+      RingBuffer<ZMPPosition> ZMPPositions;
+      RingBuffer<FootAbsolutePosition> FootAbsolutePositions;
+      RingBuffer<FootAbsolutePosition> LeftFootPositions, RightFootPositions;
+      RingBuffer<COMState> COMBuffer;
+
+      double InternalClock;
+      unsigned long int count;
+      bool ShouldBeRunning, Running;
+      bool NewStep;
+      double NewStepX, NewStepY, NewStepZ, NewTheta;
+
+      double AbsTheta, AbsMotionTheta;
+      Eigen::Matrix4d MotionAbsPos, MotionAbsOrientation;
+      Eigen::Matrix4d WaistAbsPos, WaistRelativePos;
+      Eigen::Vector4d AbsLinearVelocity, AbsAngularVelocity, AbsLinearAcc;
+      int KeepLastCorrectSupportFoot;
+      COMState CurrentWaistState;
+      std::vector<double> CurrentActuatedJointValues;
+      Eigen::Vector3d ZMPInitialPoint;
+      bool ZMPInitialPointSet;
+
+      StepStackHandlerState StepStack;
+      int NbOfHitBottom;
+
+      /*! Generator which created GeneratorState. */
+      ZMPRefTrajectoryGeneration * Generator;
+      ZMPRefTrajectoryGenerationState * GeneratorState;
+
+      Snapshot_t();
+      ~Snapshot_t();
+    };
+
+    /*! \brief Snapshot slots, indexed by SnapshotHandle. */
+    std::vector<Snapshot_t *> m_Snapshots;
+
+    /*! \brief Generator of the current algorithm whose state
+      can be captured, 0 if there is none. */
+    ZMPRefTrajectoryGeneration * ActiveZMPRefTrajectoryGeneration();
 
     /*! @} */
 
@@ -715,9 +825,26 @@ namespace PatternGeneratorJRL
     virtual void CallMethod(string &MethodName,
 			    istringstream &istrm);
 
+    /*! \brief Reimplement the SimplePlugin interface for the commands
+      which do not need parsing. */
+    virtual bool CallTypedMethod(int MethodId,
+				 const CommandArguments &Arguments);
+
     /*! \brief Register the methods handled by the SimplePlugin part of this object. */
     void RegisterPluginMethods();
 
+    /*! \brief Identifiers of the methods implemented by CallTypedMethod(). */
+    enum TypedMethodIds_t
+    {
+      SET_VEL_REFERENCE=0,
+      SET_COM_PERTURBATION_FORCE,
+      FEEDBACK_CONTROL,
+      REAL_TIME_MODE
+    };
+
+    /*! \brief Switch the real-time mode. */
+    void setRealTimeMode(bool aRealTimeMode);
+
     /*! \brief Start FPE trapping. */
     void AllowFPE();
 
@@ -732,6 +859,10 @@ namespace PatternGeneratorJRL
       as well as Upper Body Positions. */
     void ExpandCOMPositionsQueues(int aNumber);
 
+    /*! \brief Size the scratch vectors and reserve the trajectory buffers
+      so that the control loop does not allocate in real-time mode. */
+    void PreallocateRealTimeBuffers();
+
     /*! \brief Compute the COM, left and right foot position for a given BodyAngle position */
     void EvaluateStartingCOM(Eigen::VectorXd &Configuration,
 			     Eigen::Vector3d &lStartingCOMPosition);
@@ -310,15 +310,18 @@ namespace PatternGeneratorJRL
   {
 
     D.X_mat.resize(NbRows, NbCols);
+    D.X_mat.setZero();
     D.Y_mat.resize(NbRows, NbCols);
+    D.Y_mat.setZero();
     D.Z_mat.resize(NbRows, NbCols);
+    D.Z_mat.setZero();
     Dc_vec.resize(NbRows);
 
   }
 
 
   solution_t::solution_t():
-      NbVariables(0),NbConstraints(0),Fail(0),Print(0),
+      NbVariables(0),NbConstraints(0),Fail(0),Print(0),NbIterations(0),
       Solution_vec(0),SupportOrientations_deq(0),SupportStates_deq(0),
       ConstrLagr_vec(0),LBoundsLagr_vec(0),UBoundsLagr_vec(0)
   {  }
@@ -332,14 +335,13 @@ namespace PatternGeneratorJRL
     NbConstraints =     0;
     Fail =              0;
     Print =             0;
+    NbIterations =      0;
 
-    Solution_vec.resize                 (0,false);
-    SupportOrientations_deq.resize      (0);
-    TrunkOrientations_deq.resize        (0);
-    SupportStates_deq.resize            (0);
-    ConstrLagr_vec.resize               (0,false);
-    LBoundsLagr_vec.resize              (0,false);
-    UBoundsLagr_vec.resize              (0,false);
+    // The containers keep their storage, they are resized
+    // when the next problem is solved.
+    SupportOrientations_deq.clear();
+    TrunkOrientations_deq.clear();
+    SupportStates_deq.clear();
 
   }
 
@@ -350,10 +352,41 @@ namespace PatternGeneratorJRL
     NbVariables = SizeSolution;
     NbConstraints = SizeConstraints;
 
-    Solution_vec.resize(SizeSolution, false);
-    ConstrLagr_vec.resize(SizeConstraints, false);
-    LBoundsLagr_vec.resize(SizeSolution, false);
-    UBoundsLagr_vec.resize(SizeSolution, false);
+    StoragePool.resize(Solution_vec,SizeSolution);
+    StoragePool.resize(ConstrLagr_vec,SizeConstraints);
+    StoragePool.resize(LBoundsLagr_vec,SizeSolution);
+    StoragePool.resize(UBoundsLagr_vec,SizeSolution);
+  }
+
+
+  solution_t &
+  solution_t::operator=( const solution_t & Solution )
+  {
+    if( this == &Solution )
+      return *this;
+
+    NbVariables = Solution.NbVariables;
+    NbConstraints = Solution.NbConstraints;
+    Fail = Solution.Fail;
+    Print = Solution.Print;
+    NbIterations = Solution.NbIterations;
+    useWarmStart = Solution.useWarmStart;
+
+    StoragePool.resize(Solution_vec,Solution.Solution_vec.size());
+    Solution_vec = Solution.Solution_vec;
+    StoragePool.resize(initialSolution,Solution.initialSolution.size());
+    initialSolution = Solution.initialSolution;
+    SupportOrientations_deq = Solution.SupportOrientations_deq;
+    TrunkOrientations_deq = Solution.TrunkOrientations_deq;
+    SupportStates_deq = Solution.SupportStates_deq;
+    StoragePool.resize(ConstrLagr_vec,Solution.ConstrLagr_vec.size());
+    ConstrLagr_vec = Solution.ConstrLagr_vec;
+    StoragePool.resize(LBoundsLagr_vec,Solution.LBoundsLagr_vec.size());
+    LBoundsLagr_vec = Solution.LBoundsLagr_vec;
+    StoragePool.resize(UBoundsLagr_vec,Solution.UBoundsLagr_vec.size());
+    UBoundsLagr_vec = Solution.UBoundsLagr_vec;
+
+    return *this;
   }
 
 
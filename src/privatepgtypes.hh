@@ -35,7 +35,9 @@
 #include <deque>
 
 #include <Eigen/Dense>
-#include <Eigen/Sparse>
+
+#include <RingBuffer.hh>
+#include <MatrixStoragePool.hh>
 
 namespace PatternGeneratorJRL
 {
@@ -111,7 +113,11 @@ namespace PatternGeneratorJRL
   enum solver_e
   {
     QLD,
-    LSSOL
+    LSSOL,
+    /// Dense active-set solver hot started from the previous call.
+    ACTIVE_SET,
+    /// Several solvers racing on a pool of threads, see QPRace.
+    RACE
   };
 
   enum tests_e
@@ -271,9 +277,9 @@ namespace PatternGeneratorJRL
   {
     struct coordinate_t
     {
-      Eigen::SparseMatrix<double,Eigen::RowMajor> X_mat;
-      Eigen::SparseMatrix<double,Eigen::RowMajor> Y_mat;
-      Eigen::SparseMatrix<double,Eigen::RowMajor> Z_mat;
+      Eigen::MatrixXd X_mat;
+      Eigen::MatrixXd Y_mat;
+      Eigen::MatrixXd Z_mat;
     };
     struct coordinate_t D;
 
@@ -362,6 +368,9 @@ namespace PatternGeneratorJRL
     ///   IPRINT > 0 :  BRIEF OUTPUT IN ERROR CASES.
     int Print;
 
+    /// \brief Number of active-set iterations (ACTIVE_SET only).
+    int NbIterations;
+
     bool useWarmStart ;
 
     /// \name Solution vectors
@@ -371,11 +380,11 @@ namespace PatternGeneratorJRL
     /// \brief QP initial solution vector
     Eigen::VectorXd initialSolution;
     /// \brief Previewed support orientations
-    std::deque<double> SupportOrientations_deq;
+    RingBuffer<double> SupportOrientations_deq;
     /// \brief Previewed trunk orientations (only yaw as for now)
-    std::deque<double> TrunkOrientations_deq;
+    RingBuffer<double> TrunkOrientations_deq;
     /// \brief Previewed support states
-    std::deque<support_state_t> SupportStates_deq;
+    RingBuffer<support_state_t> SupportStates_deq;
     /// \}
 
     /// \name{
@@ -388,6 +397,9 @@ namespace PatternGeneratorJRL
     Eigen::VectorXd UBoundsLagr_vec;
     /// \}
 
+    /// \brief Storage of the vectors for the sizes met before
+    MatrixStoragePool StoragePool;
+
     /// \brief Reset
     void reset();
 
@@ -403,6 +415,9 @@ namespace PatternGeneratorJRL
 
     solution_t();
 
+    /// \brief Copy the solution, the vectors keep their storage
+    solution_t & operator=( const solution_t & Solution );
+
   };
 
   /// \}
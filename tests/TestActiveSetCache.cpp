@@ -0,0 +1,195 @@
+/*
+ * Copyright 2019,
+ *
+ * Olivier Stasse
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+/*! \file TestActiveSetCache.cpp
+  \brief Replay the receding horizon of ZMPQPWithConstraint (Wieber 2006)
+  with the optimal active sets cached by support pattern, and compare
+  the explicit solutions with the active-set solver.
+*/
+
+#include <stdlib.h>
+#include <math.h>
+#include <sys/time.h>
+
+#include <iostream>
+#include <vector>
+
+#include <Eigen/Dense>
+
+#include "Mathematics/active-set-qp.hh"
+#include "Mathematics/active-set-cache.hh"
+
+using namespace std;
+using namespace PatternGeneratorJRL;
+
+double ElapsedTime(struct timeval &begin, struct timeval &end)
+{
+  return (double)(end.tv_sec-begin.tv_sec)*1e6 +
+    (double)(end.tv_usec-begin.tv_usec);
+}
+
+int main()
+{
+  const unsigned int N=75, NbOfCycles=800;
+  const double T=0.02, h=0.80, g=9.81, alpha=200.0, beta=1000.0;
+  const double StepDuration=0.8, StepLength=0.2, FeetDistance=0.19;
+  const double ConstraintOnX=0.04, ConstraintOnY=0.04;
+  const unsigned int SamplesPerStep = (unsigned int)(StepDuration/T+0.5);
+
+  Eigen::MatrixXd PPu = Eigen::MatrixXd::Zero(N,N), VPu = PPu, ZPu = PPu;
+  Eigen::MatrixXd PPx(N,3), VPx(N,3), ZPx(N,3);
+  for(unsigned int i=0;i<N;i++)
+  {
+    PPx(i,0) = 1.0; PPx(i,1) = (i+1)*T; PPx(i,2) = (i+1)*(i+1)*T*T*0.5;
+    VPx(i,0) = 0.0; VPx(i,1) = 1.0; VPx(i,2) = (i+1)*T;
+    ZPx(i,0) = 1.0; ZPx(i,1) = (i+1)*T; ZPx(i,2) = PPx(i,2)-h/g;
+    for(unsigned int k=0;k<=i;k++)
+    {
+      PPu(i,k) = (1+3*(i-k)+3*(i-k)*(i-k))*T*T*T/6.0;
+      VPu(i,k) = (2*(i-k)+1)*T*T*0.5;
+      ZPu(i,k) = PPu(i,k) - T*h/g;
+    }
+  }
+
+  int n = 2*N, m = 4*N, me = 0;
+  Eigen::MatrixXd Q = Eigen::MatrixXd::Zero(n,n);
+  Eigen::MatrixXd Q1 = Eigen::MatrixXd::Identity(N,N) +
+    alpha*VPu.transpose()*VPu + beta*PPu.transpose()*PPu;
+  Q.topLeftCorner(N,N) = Q1;
+  Q.bottomRightCorner(N,N) = Q1;
+  Eigen::VectorXd D(n), DS(m), ZMPRef(N);
+  Eigen::MatrixXd DU = Eigen::MatrixXd::Zero(m,n);
+  Eigen::VectorXd XL = Eigen::VectorXd::Constant(n,-1e8);
+  Eigen::VectorXd XU = Eigen::VectorXd::Constant(n,1e8);
+  vector<double> U(m+2*n);
+
+  ActiveSetQP aSolver;
+  ActiveSetCache aCache;
+  Eigen::VectorXd xSolver(n), xCache(n);
+  Eigen::Vector3d xk(0.0,0.0,0.0), yk(0.0,0.0,0.0);
+  struct timeval begin,end;
+  double lTimeSolver=0.0, lTimeHit=0.0, lTimeMiss=0.0, lMaxTimeHit=0.0;
+  double lMaxDelta=0.0;
+
+  for(unsigned int lCycle=0;lCycle<NbOfCycles;lCycle++)
+  {
+    // The support pattern over the window: the foot of each sample,
+    // and the double support of the first step.
+    unsigned long long Key = ActiveSetCache::EmptyKey;
+    for(unsigned int i=0;i<N;i++)
+    {
+      unsigned int lStep = (lCycle+i)/SamplesPerStep;
+      double lSupport = (lStep==0) ? 0.0 : (lStep%2==0 ? 1.0 : -1.0);
+      Key = ActiveSetCache::combine(Key,&lSupport,1);
+    }
+
+    for(unsigned int lAxis=0;lAxis<2;lAxis++)
+    {
+      Eigen::Vector3d & s = (lAxis==0 ? xk : yk);
+      for(unsigned int i=0;i<N;i++)
+      {
+        unsigned int lStep = (lCycle+i)/SamplesPerStep;
+        double c = 0.0, d = ConstraintOnX;
+        if (lAxis==0)
+          c = StepLength*lStep;
+        else if (lStep==0)
+          d = 0.5*FeetDistance+ConstraintOnY;
+        else
+        {
+          c = (lStep%2==0 ? 0.5 : -0.5)*FeetDistance;
+          d = ConstraintOnY;
+        }
+        // The reference stays between the feet: the constraints
+        // of the support foot are active.
+        ZMPRef(i) = (lAxis==0) ? c : 0.0;
+        double z = ZPx.row(i).dot(s);
+        for(unsigned int j=0;j<2;j++)
+        {
+          unsigned int r = 4*i+2*lAxis+j;
+          double lSign = (j==0 ? 1.0 : -1.0);
+          DU.row(r).segment(lAxis*N,N) = lSign*ZPu.row(i);
+          DS(r) = lSign*(z-c)+d;
+        }
+      }
+      D.segment(lAxis*N,N) = alpha*VPu.transpose()*VPx*s +
+        beta*PPu.transpose()*(PPx*s-ZMPRef);
+    }
+
+    gettimeofday(&begin,0);
+    bool lHit = aCache.solve(Key,n,m,me,Q.data(),D.data(),
+                             DU.data(),m,DS.data(),
+                             XL.data(),XU.data(),xCache.data());
+    gettimeofday(&end,0);
+    double lTimeCache = ElapsedTime(begin,end);
+
+    gettimeofday(&begin,0);
+    if (lCycle>0)
+      aSolver.shift_working_set(4);
+    int Fail = aSolver.solve(n,m,me,Q.data(),D.data(),DU.data(),m,DS.data(),
+                             XL.data(),XU.data(),xSolver.data(),&U[0]);
+    gettimeofday(&end,0);
+    lTimeSolver += ElapsedTime(begin,end);
+    if (Fail!=0)
+    {
+      cerr << "Cycle " << lCycle << ": failure " << Fail << endl;
+      return -1;
+    }
+
+    if (lHit)
+    {
+      lTimeHit += lTimeCache;
+      lMaxTimeHit = max(lMaxTimeHit,lTimeCache);
+      lMaxDelta = max(lMaxDelta,(xCache-xSolver).norm()/
+                      (1.0+xSolver.norm()));
+    }
+    else
+    {
+      gettimeofday(&begin,0);
+      aCache.store(Key,n,m,me,Q.data(),DU.data(),m,DS.data(),
+                   XL.data(),XU.data(),xSolver.data());
+      gettimeofday(&end,0);
+      lTimeMiss += lTimeCache+ElapsedTime(begin,end);
+    }
+
+    Eigen::Matrix3d A;
+    A << 1.0, T, T*T/2.0, 0.0, 1.0, T, 0.0, 0.0, 1.0;
+    Eigen::Vector3d B(T*T*T/6.0, T*T/2.0, T);
+    xk = A*xk + B*xSolver(0);
+    yk = A*yk + B*xSolver(N);
+  }
+
+  unsigned long int lHits = aCache.NbHits(), lMisses = aCache.NbMisses();
+  cout << "Active-set solver: " << lTimeSolver/NbOfCycles << " us" << endl;
+  cout << "Cache hits       : " << lHits << " ("
+       << 100.0*aCache.HitRate() << " %), "
+       << lTimeHit/max(lHits,1ul) << " us, max " << lMaxTimeHit << " us"
+       << endl;
+  cout << "Cache misses     : " << lMisses << ", "
+       << lTimeMiss/max(lMisses,1ul) << " us with the update" << endl;
+  cout << aCache.NbOfPatterns() << " support patterns, "
+       << "largest difference " << lMaxDelta << endl;
+
+  if ((lMaxDelta>1e-6) || (aCache.HitRate()<0.5))
+    return -1;
+  return 0;
+}
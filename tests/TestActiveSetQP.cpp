@@ -0,0 +1,372 @@
+/*
+ * Copyright 2019,
+ *
+ * Olivier Stasse
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+/*! \file TestActiveSetQP.cpp
+  \brief Compare the dense active-set solver with QLD on random problems
+  and on a sequence of slowly varying problems, as in the on-line
+  walking generators, where the hot start applies. The last check
+  replays the receding horizon of ZMPQPWithConstraint (Wieber 2006).
+*/
+
+#include <stdlib.h>
+#include <math.h>
+#include <sys/time.h>
+
+#include <iostream>
+#include <vector>
+
+#include <Eigen/Dense>
+
+#include "Mathematics/qld.hh"
+#include "Mathematics/active-set-qp.hh"
+
+using namespace std;
+using namespace PatternGeneratorJRL;
+
+double ElapsedTime(struct timeval &begin, struct timeval &end)
+{
+  return (double)(end.tv_sec-begin.tv_sec)*1e6 +
+    (double)(end.tv_usec-begin.tv_usec);
+}
+
+double Random()
+{
+  return 2.0*(double)rand()/(double)RAND_MAX-1.0;
+}
+
+/*! QP in the layout of QPProblem, with one empty constraint row. */
+struct Problem
+{
+  int n, m, me;
+  Eigen::MatrixXd Q, DU;
+  Eigen::VectorXd D, DS, XL, XU;
+
+  Problem(): n(0), m(0), me(0) {}
+
+  Problem(int ln, int lm, int lme):
+    n(ln), m(lm+1), me(lme)
+  {
+    Eigen::MatrixXd A = Eigen::MatrixXd::Random(n,n);
+    Q = A.transpose()*A + Eigen::MatrixXd::Identity(n,n);
+    D = Eigen::VectorXd::Random(n);
+    DU = Eigen::MatrixXd::Zero(m,n);
+    DU.topRows(lm) = Eigen::MatrixXd::Random(lm,n);
+    // Feasible by construction: x0 satisfies all the constraints.
+    Eigen::VectorXd x0 = 0.1*Eigen::VectorXd::Random(n);
+    DS = -DU*x0;
+    for(int i=me;i<m;i++)
+      DS(i) += 0.05*fabs(Random());
+    DS(m-1) = 0.0;
+    XL = Eigen::VectorXd::Constant(n,-1e8);
+    XU = Eigen::VectorXd::Constant(n,1e8);
+    for(int j=0;j<n;j+=5)
+    {
+      XL(j) = x0(j)-0.5;
+      XU(j) = x0(j)+0.5;
+    }
+  }
+
+  /*! Small drift of the problem between two control cycles. */
+  void Perturb(double Amplitude)
+  {
+    for(int j=0;j<n;j++)
+      D(j) += Amplitude*Random();
+    for(int i=me;i<m;i++)
+      DS(i) += 0.1*Amplitude*Random();
+    DS(m-1) = 0.0;
+  }
+
+  double Cost(const Eigen::VectorXd & x) const
+  { return 0.5*x.dot(Q*x) + D.dot(x); }
+
+  double Violation(const Eigen::VectorXd & x) const
+  {
+    Eigen::VectorXd s = DU*x + DS;
+    double v=0.0;
+    for(int i=0;i<m;i++)
+      v = max(v, (i<me) ? fabs(s(i)) : -s(i));
+    for(int j=0;j<n;j++)
+      v = max(v, max(XL(j)-x(j), x(j)-XU(j)));
+    return v;
+  }
+};
+
+int SolveQLD(Problem & P, Eigen::VectorXd & x)
+{
+  int m = P.m, me = P.me, mmax = P.m+1, n = P.n, nmax = P.n;
+  int mnn = m+2*n, iout = 0, ifail = 0, iprint = 1;
+  int lwar = 2*(3*n*n/2+10*n+2*(m+1)+20000), liwar = 2*n+1000;
+  double eps = 1e-8;
+  static vector<double> war, u, Q, DU;
+  static vector<int> iwar;
+  war.resize(lwar); iwar.resize(liwar); u.resize(mnn);
+  Q.assign(P.Q.data(),P.Q.data()+n*n);
+  DU.assign(mmax*n,0.0);
+  for(int j=0;j<n;j++)
+    for(int i=0;i<m;i++)
+      DU[i+mmax*j] = P.DU(i,j);
+  iwar[0] = 1;
+  x.resize(n);
+  ql0001_(&m, &me, &mmax, &n, &nmax, &mnn,
+          &Q[0], P.D.data(), &DU[0], P.DS.data(), P.XL.data(), P.XU.data(),
+          x.data(), &u[0], &iout, &ifail, &iprint,
+          &war[0], &lwar, &iwar[0], &liwar, &eps);
+  return ifail;
+}
+
+int SolveActiveSet(ActiveSetQP & aSolver, Problem & P, Eigen::VectorXd & x)
+{
+  static vector<double> u;
+  u.resize(P.m+2*P.n);
+  x.resize(P.n);
+  return aSolver.solve(P.n, P.m, P.me, P.Q.data(), P.D.data(),
+                       P.DU.data(), P.m, P.DS.data(),
+                       P.XL.data(), P.XU.data(), x.data(), &u[0]);
+}
+
+/*! Both solvers have to find the same optimum. */
+bool Compare(Problem & P, const Eigen::VectorXd & xQLD,
+             const Eigen::VectorXd & xAS, unsigned int Index)
+{
+  double lCostQLD = P.Cost(xQLD), lCostAS = P.Cost(xAS);
+  if ((P.Violation(xAS)>1e-6) ||
+      (fabs(lCostQLD-lCostAS)>1e-6*(1.0+fabs(lCostQLD))) ||
+      ((xQLD-xAS).norm()>1e-4*(1.0+xQLD.norm())))
+  {
+    cerr << "Problem " << Index << ": cost " << lCostAS
+         << " instead of " << lCostQLD
+         << ", violation " << P.Violation(xAS) << endl;
+    return false;
+  }
+  return true;
+}
+
+bool CheckRandomProblems()
+{
+  ActiveSetQP aSolver;
+  Eigen::VectorXd xQLD, xAS;
+  for(unsigned int i=0;i<200;i++)
+  {
+    Problem P(10+rand()%30, 20+rand()%60, (i%4==0) ? 3 : 0);
+    aSolver.reset();
+    if (SolveQLD(P,xQLD)!=0)
+      continue;
+    int Fail = SolveActiveSet(aSolver,P,xAS);
+    if (Fail!=0)
+    {
+      cerr << "Problem " << i << ": failure " << Fail << endl;
+      return false;
+    }
+    if (!Compare(P,xQLD,xAS,i))
+      return false;
+  }
+  return true;
+}
+
+/*! Sequence of problems of the size of the Herdt 2010 generator:
+  16 samples, 2 previewed steps, 4 ZMP constraints per sample. */
+bool CheckSequence()
+{
+  const unsigned int NbOfCycles=2000;
+  Problem P(2*16+4, 4*16+10, 0);
+  ActiveSetQP aHotSolver, aColdSolver;
+  Eigen::VectorXd xQLD, xHot, xCold;
+  struct timeval begin,end;
+  double lTimeQLD=0.0, lTimeHot=0.0;
+  unsigned long int lItHot=0, lItCold=0;
+
+  for(unsigned int i=0;i<NbOfCycles;i++)
+  {
+    P.Perturb(0.01);
+
+    gettimeofday(&begin,0);
+    int FailQLD = SolveQLD(P,xQLD);
+    gettimeofday(&end,0);
+    lTimeQLD += ElapsedTime(begin,end);
+
+    gettimeofday(&begin,0);
+    int Fail = SolveActiveSet(aHotSolver,P,xHot);
+    gettimeofday(&end,0);
+    lTimeHot += ElapsedTime(begin,end);
+    lItHot += aHotSolver.NbIterations();
+
+    aColdSolver.reset();
+    SolveActiveSet(aColdSolver,P,xCold);
+    lItCold += aColdSolver.NbIterations();
+
+    if (FailQLD!=0)
+      continue;
+    if (Fail!=0)
+    {
+      cerr << "Cycle " << i << ": failure " << Fail << endl;
+      return false;
+    }
+    if (!Compare(P,xQLD,xHot,i))
+      return false;
+  }
+
+  cout << "QLD                  : " << lTimeQLD/NbOfCycles << " us" << endl;
+  cout << "Active set, hot start: " << lTimeHot/NbOfCycles << " us, "
+       << (double)lItHot/NbOfCycles << " iterations" << endl;
+  cout << "Active set, cold     : "
+       << (double)lItCold/NbOfCycles << " iterations" << endl;
+  if (lItHot>=lItCold)
+  {
+    cerr << "The hot start does not save iterations" << endl;
+    return false;
+  }
+  return true;
+}
+
+/*! Receding horizon of ZMPQPWithConstraint: 75 samples of 20 ms,
+  the CoM follows the ZMP reference and the ZMP stays in a box
+  around the support foot. The first rows of the window are dropped
+  at each cycle, the hot start shifts the active set accordingly. */
+bool CheckWieber2006Sequence()
+{
+  const unsigned int N=75, NbOfCycles=300;
+  const double T=0.02, h=0.80, g=9.81, alpha=200.0, beta=1000.0;
+  const double StepDuration=0.8, StepLength=0.2, FeetDistance=0.19;
+  const double ConstraintOnX=0.04, ConstraintOnY=0.04;
+
+  Eigen::MatrixXd PPu = Eigen::MatrixXd::Zero(N,N), VPu = PPu, ZPu = PPu;
+  Eigen::MatrixXd PPx(N,3), VPx(N,3), ZPx(N,3);
+  for(unsigned int i=0;i<N;i++)
+  {
+    PPx(i,0) = 1.0; PPx(i,1) = (i+1)*T; PPx(i,2) = (i+1)*(i+1)*T*T*0.5;
+    VPx(i,0) = 0.0; VPx(i,1) = 1.0; VPx(i,2) = (i+1)*T;
+    ZPx(i,0) = 1.0; ZPx(i,1) = (i+1)*T; ZPx(i,2) = PPx(i,2)-h/g;
+    for(unsigned int k=0;k<=i;k++)
+    {
+      PPu(i,k) = (1+3*(i-k)+3*(i-k)*(i-k))*T*T*T/6.0;
+      VPu(i,k) = (2*(i-k)+1)*T*T*0.5;
+      ZPu(i,k) = PPu(i,k) - T*h/g;
+    }
+  }
+
+  Problem P;
+  P.n = 2*N; P.m = 4*N; P.me = 0;
+  P.Q = Eigen::MatrixXd::Zero(2*N,2*N);
+  Eigen::MatrixXd Q1 = Eigen::MatrixXd::Identity(N,N) +
+    alpha*VPu.transpose()*VPu + beta*PPu.transpose()*PPu;
+  P.Q.topLeftCorner(N,N) = Q1;
+  P.Q.bottomRightCorner(N,N) = Q1;
+  P.D.resize(2*N);
+  P.DU = Eigen::MatrixXd::Zero(4*N,2*N);
+  P.DS.resize(4*N);
+  P.XL = Eigen::VectorXd::Constant(2*N,-1e8);
+  P.XU = Eigen::VectorXd::Constant(2*N,1e8);
+
+  ActiveSetQP aHotSolver, aColdSolver;
+  Eigen::VectorXd xQLD, xHot, xCold, ZMPRef(N);
+  Eigen::Vector3d xk(0.0,0.0,0.0), yk(0.0,0.0,0.0);
+  struct timeval begin,end;
+  double lTimeQLD=0.0, lTimeHot=0.0;
+  unsigned long int lItHot=0, lItCold=0;
+
+  for(unsigned int lCycle=0;lCycle<NbOfCycles;lCycle++)
+  {
+    for(unsigned int lAxis=0;lAxis<2;lAxis++)
+    {
+      Eigen::Vector3d & s = (lAxis==0 ? xk : yk);
+      for(unsigned int i=0;i<N;i++)
+      {
+        unsigned int lStep = (lCycle+i)/(unsigned int)(StepDuration/T+0.5);
+        double c = 0.0, d = ConstraintOnX;
+        if (lAxis==0)
+          c = StepLength*lStep;
+        else if (lStep==0)
+          // Double support at the beginning.
+          d = 0.5*FeetDistance+ConstraintOnY;
+        else
+        {
+          c = (lStep%2==0 ? 0.5 : -0.5)*FeetDistance;
+          d = ConstraintOnY;
+        }
+        ZMPRef(i) = c;
+        double z = ZPx.row(i).dot(s);
+        for(unsigned int j=0;j<2;j++)
+        {
+          unsigned int r = 4*i+2*lAxis+j;
+          double lSign = (j==0 ? 1.0 : -1.0);
+          P.DU.row(r).segment(lAxis*N,N) = lSign*ZPu.row(i);
+          P.DS(r) = lSign*(z-c)+d;
+        }
+      }
+      P.D.segment(lAxis*N,N) = alpha*VPu.transpose()*VPx*s +
+        beta*PPu.transpose()*(PPx*s-ZMPRef);
+    }
+
+    gettimeofday(&begin,0);
+    int FailQLD = SolveQLD(P,xQLD);
+    gettimeofday(&end,0);
+    lTimeQLD += ElapsedTime(begin,end);
+
+    gettimeofday(&begin,0);
+    if (lCycle>0)
+      aHotSolver.shift_working_set(4);
+    int Fail = SolveActiveSet(aHotSolver,P,xHot);
+    gettimeofday(&end,0);
+    lTimeHot += ElapsedTime(begin,end);
+    lItHot += aHotSolver.NbIterations();
+
+    aColdSolver.reset();
+    SolveActiveSet(aColdSolver,P,xCold);
+    lItCold += aColdSolver.NbIterations();
+
+    if ((FailQLD!=0) || (Fail!=0))
+    {
+      cerr << "Cycle " << lCycle << ": failure " << FailQLD
+           << " (QLD) " << Fail << " (active set)" << endl;
+      return false;
+    }
+    if (!Compare(P,xQLD,xHot,lCycle))
+      return false;
+
+    // Apply the first jerk.
+    Eigen::Matrix3d A;
+    A << 1.0, T, T*T/2.0, 0.0, 1.0, T, 0.0, 0.0, 1.0;
+    Eigen::Vector3d B(T*T*T/6.0, T*T/2.0, T);
+    xk = A*xk + B*xHot(0);
+    yk = A*yk + B*xHot(N);
+  }
+
+  cout << "Wieber 2006, QLD     : " << lTimeQLD/NbOfCycles << " us" << endl;
+  cout << "Wieber 2006, hot     : " << lTimeHot/NbOfCycles << " us, "
+       << (double)lItHot/NbOfCycles << " iterations" << endl;
+  cout << "Wieber 2006, cold    : "
+       << (double)lItCold/NbOfCycles << " iterations" << endl;
+  return true;
+}
+
+int main()
+{
+  srand(0);
+  if (!CheckRandomProblems())
+    return -1;
+  if (!CheckSequence())
+    return -1;
+  if (!CheckWieber2006Sequence())
+    return -1;
+  return 0;
+}
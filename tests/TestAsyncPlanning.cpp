@@ -0,0 +1,287 @@
+/*
+ * Copyright 2019,
+ *
+ * Olivier Stasse
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+/*! \file TestAsyncPlanning.cpp
+  \brief Walk with the asynchronous planner of Naveau 2015
+  (:asyncplanning) and check the age of the plans, the fallback on
+  the previous plan when a deadline is missed, and the shutdown of
+  the planner thread.
+
+  The plans depend on the duration of the solves, so the trajectories
+  are not compared with a reference: the test checks properties which
+  hold whatever the timing.
+*/
+
+#include <cmath>
+#include <sys/time.h>
+
+#include <boost/thread/thread.hpp>
+
+#include "Debug.hh"
+#include "CommonTools.hh"
+#include "TestObject.hh"
+
+using namespace::PatternGeneratorJRL;
+using namespace::PatternGeneratorJRL::TestSuite;
+using namespace std;
+
+class TestAsyncPlanning: public TestObject
+{
+public:
+  TestAsyncPlanning(int argc, char *argv[], string &aTestName):
+    TestObject(argc,argv,aTestName)
+  {
+    m_DebugFGPI = false;
+    m_DebugFGPIFull = false;
+    m_NbOfPlans = 0;
+    // Sampling period set by CommonInitialization.
+    m_ControlPeriod = 0.005;
+  }
+
+  bool Run()
+  {
+    PatternGeneratorInterface & aPGI = *m_PGI;
+    CommonInitialization(aPGI);
+    {
+      istringstream strm2(":SetAlgoForZmpTrajectory Naveau");
+      aPGI.ParseCmd(strm2);
+    }
+    {
+      istringstream strm2(":singlesupporttime 0.7");
+      aPGI.ParseCmd(strm2);
+    }
+    {
+      istringstream strm2(":doublesupporttime 0.1");
+      aPGI.ParseCmd(strm2);
+    }
+    {
+      istringstream strm2(":NaveauOnline");
+      aPGI.ParseCmd(strm2);
+    }
+    {
+      istringstream strm2(":setfeetconstraint XY 0.095 0.055");
+      aPGI.ParseCmd(strm2);
+    }
+    {
+      istringstream strm2(":deleteallobstacles");
+      aPGI.ParseCmd(strm2);
+    }
+    {
+      istringstream strm2(":useDynamicFilter false");
+      aPGI.ParseCmd(strm2);
+    }
+    {
+      istringstream strm2(":asyncplanning true");
+      aPGI.ParseCmd(strm2);
+    }
+    aPGI.setVelocityReference(0.1,0.0,0.0);
+
+    PlannerStatistics aStatistics;
+    if (!aPGI.GetPlannerStatistics(aStatistics) || !aStatistics.Running)
+    {
+      cerr << "The planner thread is not running" << endl;
+      return false;
+    }
+
+    // 2 s at the pace of the control loop.
+    if (!Walk(400,true))
+      return false;
+    aPGI.GetPlannerStatistics(aStatistics);
+    if (aStatistics.NbOfPlans==0)
+    {
+      cerr << "No plan has been received" << endl;
+      return false;
+    }
+    cout << "Paced: " << aStatistics.NbOfPlans << " plans, "
+         << "maximum age " << aStatistics.MaxPlanAge << " s, "
+         << aStatistics.NbOfMissedDeadlines << " missed deadlines" << endl;
+
+    // 3 s as fast as possible: a control cycle is much shorter than a
+    // solve, so the plans are over before the next ones are available.
+    aPGI.setVelocityReference(0.2,0.0,0.1);
+    unsigned long int lNbOfMissedDeadlines = aStatistics.NbOfMissedDeadlines;
+    if (!Walk(600,false))
+      return false;
+    aPGI.GetPlannerStatistics(aStatistics);
+    cout << "Unpaced: " << aStatistics.NbOfPlans << " plans, "
+         << "maximum age " << aStatistics.MaxPlanAge << " s, "
+         << aStatistics.NbOfMissedDeadlines << " missed deadlines" << endl;
+    if (aStatistics.NbOfMissedDeadlines==lNbOfMissedDeadlines)
+    {
+      cerr << "No deadline has been missed" << endl;
+      return false;
+    }
+
+    // Synchronous planning: the thread is stopped.
+    {
+      istringstream strm2(":asyncplanning false");
+      aPGI.ParseCmd(strm2);
+    }
+    aPGI.GetPlannerStatistics(aStatistics);
+    if (aStatistics.Running)
+    {
+      cerr << "The planner thread is still running" << endl;
+      return false;
+    }
+    unsigned long int lNbOfPlans = aStatistics.NbOfPlans;
+    if (!Walk(200,false))
+      return false;
+    aPGI.GetPlannerStatistics(aStatistics);
+    if (aStatistics.NbOfPlans!=lNbOfPlans)
+    {
+      cerr << "Plans received in synchronous mode" << endl;
+      return false;
+    }
+
+    // Asynchronous again, until the end of the walk.
+    {
+      istringstream strm2(":asyncplanning true");
+      aPGI.ParseCmd(strm2);
+    }
+    if (!Walk(100,true))
+      return false;
+    aPGI.GetPlannerStatistics(aStatistics);
+    if (!aStatistics.Running || aStatistics.NbOfPlans==lNbOfPlans)
+    {
+      cerr << "The planner thread has not been restarted" << endl;
+      return false;
+    }
+    aPGI.setVelocityReference(0.0,0.0,0.0);
+    {
+      istringstream strm2(":stoppg");
+      aPGI.ParseCmd(strm2);
+    }
+    // The control loop stops once the buffers are empty.
+    for(unsigned int i=0;i<400;i++)
+      if (!aPGI.RunOneStepOfTheControlLoop(m_CurrentConfiguration,
+                                           m_CurrentVelocity,
+                                           m_CurrentAcceleration,
+                                           m_OneStep.m_ZMPTarget,
+                                           m_OneStep.m_finalCOMPosition,
+                                           m_OneStep.m_LeftFootPosition,
+                                           m_OneStep.m_RightFootPosition))
+        break;
+    aPGI.GetPlannerStatistics(aStatistics);
+    if (aStatistics.Running)
+    {
+      cerr << "The planner thread is running after the walk" << endl;
+      return false;
+    }
+    // The thread is joined when the pattern generator is deleted.
+    return true;
+  }
+
+protected:
+  /*! Run the control loop, at the pace of the control period if
+    Paced is true, and check the statistics of the planner and the
+    continuity of the trajectories at each cycle. */
+  bool Walk(unsigned int NbOfIterations, bool Paced)
+  {
+    // Preview of the SQP: 16 sampling periods of 0.1 s.
+    const double lHorizon = 1.6;
+    struct timeval begin,now;
+    gettimeofday(&begin,0);
+    for(unsigned int i=0;i<NbOfIterations;i++)
+    {
+      if (Paced)
+      {
+        gettimeofday(&now,0);
+        double lElapsed = (double)(now.tv_sec-begin.tv_sec) +
+          0.000001*(double)(now.tv_usec-begin.tv_usec);
+        double lWait = (double)i*m_ControlPeriod - lElapsed;
+        if (lWait>0.0)
+          boost::this_thread::sleep
+            (boost::posix_time::microseconds((long)(1e6*lWait)));
+      }
+
+      COMState lPrevious = m_OneStep.m_finalCOMPosition;
+      if (!m_PGI->RunOneStepOfTheControlLoop(m_CurrentConfiguration,
+                                             m_CurrentVelocity,
+                                             m_CurrentAcceleration,
+                                             m_OneStep.m_ZMPTarget,
+                                             m_OneStep.m_finalCOMPosition,
+                                             m_OneStep.m_LeftFootPosition,
+                                             m_OneStep.m_RightFootPosition))
+      {
+        cerr << "The control loop stopped" << endl;
+        return false;
+      }
+
+      // The previous plan is followed without discontinuity.
+      const COMState & aCoM = m_OneStep.m_finalCOMPosition;
+      if (!std::isfinite(aCoM.x[0]) || !std::isfinite(aCoM.y[0]) ||
+          ((m_NbOfPlans>0) &&
+           ((fabs(aCoM.x[0]-lPrevious.x[0])>0.01) ||
+            (fabs(aCoM.y[0]-lPrevious.y[0])>0.01))))
+      {
+        cerr << "The CoM jumps from (" << lPrevious.x[0] << ","
+             << lPrevious.y[0] << ") to (" << aCoM.x[0] << ","
+             << aCoM.y[0] << ")" << endl;
+        return false;
+      }
+
+      // Plans are computed for initial conditions taken at the
+      // control cycles, and always cover the preview.
+      PlannerStatistics aStatistics;
+      m_PGI->GetPlannerStatistics(aStatistics);
+      double lNbOfCycles = aStatistics.PlanAge/m_ControlPeriod;
+      if ((aStatistics.PlanAge<0.0) ||
+          (aStatistics.PlanAge>aStatistics.MaxPlanAge) ||
+          (aStatistics.MaxPlanAge>=lHorizon) ||
+          (fabs(lNbOfCycles-floor(lNbOfCycles+0.5))>1e-6) ||
+          (aStatistics.NbOfPlans<m_NbOfPlans))
+      {
+        cerr << "Wrong statistics of the planner: age "
+             << aStatistics.PlanAge << " s, maximum age "
+             << aStatistics.MaxPlanAge << " s, "
+             << aStatistics.NbOfPlans << " plans" << endl;
+        return false;
+      }
+      m_NbOfPlans = aStatistics.NbOfPlans;
+    }
+    return true;
+  }
+
+  void chooseTestProfile() {}
+  void generateEvent() {}
+
+  double m_ControlPeriod;
+  unsigned long int m_NbOfPlans;
+};
+
+int main(int argc, char *argv[])
+{
+  if (argc<3)
+  {
+    cerr << "Usage: " << argv[0] << " robot.urdf robot.srdf" << endl;
+    return -1;
+  }
+
+  string TestName("TestAsyncPlanning");
+  TestAsyncPlanning aTestAsyncPlanning(argc,argv,TestName);
+  if (!aTestAsyncPlanning.init())
+    return -1;
+  if (!aTestAsyncPlanning.Run())
+    return -1;
+  return 0;
+}
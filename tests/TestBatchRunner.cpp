@@ -0,0 +1,217 @@
+/*
+ * Copyright 2019,
+ *
+ * Olivier Stasse
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+/*! \file TestBatchRunner.cpp
+  \brief Throughput of on-line walking rollouts (Herdt 2010)
+  run by PatternGeneratorBatchRunner against the number of threads.
+*/
+
+#define BOOST_BIND_GLOBAL_PLACEHOLDERS
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
+
+#include <jrl/walkgen/batchrunner.hh>
+
+#include "Debug.hh"
+#include "CommonTools.hh"
+#include "TestObject.hh"
+
+using namespace::PatternGeneratorJRL;
+using namespace::PatternGeneratorJRL::TestSuite;
+using namespace std;
+
+/*! Robot model, state vectors and pattern generator of one worker. */
+class RolloutObject: public TestObject
+{
+public:
+  RolloutObject(int argc, char *argv[], string &aTestName):
+    TestObject(argc,argv,aTestName)
+  {
+    m_DebugFGPI = false;
+    m_DebugFGPIFull = false;
+  }
+
+  PatternGeneratorInterface * PGI()
+  { return m_PGI; }
+
+  /*! Walk with a reference depending on the rollout,
+    then stop. */
+  bool Rollout(unsigned int RolloutId,
+               PatternGeneratorInterface &aPGI,
+               unsigned int NbOfIterations)
+  {
+    const double lVelocities[4][3] =
+      { {0.2, 0.0, 0.0},
+        {0.1, 0.1, 0.0},
+        {0.2, 0.0, 0.2},
+        {0.0, 0.0, 0.3} };
+    const double * lVelocity = lVelocities[RolloutId%4];
+
+    // Start every rollout from the half-sitting configuration.
+    aPGI.SetCurrentJointValues(m_HalfSitting);
+    InitializeStateVectors();
+    CommonInitialization(aPGI);
+    {
+      istringstream strm2(":SetAlgoForZmpTrajectory Herdt");
+      aPGI.ParseCmd(strm2);
+    }
+    {
+      istringstream strm2(":singlesupporttime 0.7");
+      aPGI.ParseCmd(strm2);
+    }
+    {
+      istringstream strm2(":doublesupporttime 0.1");
+      aPGI.ParseCmd(strm2);
+    }
+    {
+      istringstream strm2(":HerdtOnline 0.0 0.0 0.0");
+      aPGI.ParseCmd(strm2);
+    }
+
+    CommandHandle lSetVelReference =
+      aPGI.ResolveCommand(":setVelReference");
+    aPGI.CallCommand(lSetVelReference,
+                     CommandArguments(lVelocity[0],
+                                      lVelocity[1],
+                                      lVelocity[2]));
+
+    for(unsigned int i=0;i<NbOfIterations;i++)
+    {
+      if (i==NbOfIterations/2)
+        aPGI.CallCommand(lSetVelReference,
+                         CommandArguments(0.0,0.0,0.0));
+      if (!aPGI.RunOneStepOfTheControlLoop(m_CurrentConfiguration,
+                                           m_CurrentVelocity,
+                                           m_CurrentAcceleration,
+                                           m_OneStep.m_ZMPTarget,
+                                           m_OneStep.m_finalCOMPosition,
+                                           m_OneStep.m_LeftFootPosition,
+                                           m_OneStep.m_RightFootPosition))
+        return false;
+    }
+    return true;
+  }
+
+protected:
+  void chooseTestProfile() {}
+  void generateEvent() {}
+};
+
+struct Workers_t
+{
+  int argc;
+  char ** argv;
+  vector<RolloutObject *> Objects;
+  unsigned int NbOfIterations;
+
+  PatternGeneratorInterface * Create(unsigned int WorkerId)
+  {
+    ostringstream oss;
+    oss << "TestBatchRunnerWorker" << WorkerId;
+    string aTestName = oss.str();
+    RolloutObject * anObject = new RolloutObject(argc,argv,aTestName);
+    if (!anObject->init())
+    {
+      delete anObject;
+      return 0;
+    }
+    if (Objects.size()<=WorkerId)
+      Objects.resize(WorkerId+1,0);
+    Objects[WorkerId] = anObject;
+    return anObject->PGI();
+  }
+
+  /*! The pattern generator is owned by its RolloutObject. */
+  void Release(unsigned int WorkerId, PatternGeneratorInterface *)
+  {
+    delete Objects[WorkerId];
+    Objects[WorkerId] = 0;
+  }
+
+  bool Rollout(unsigned int WorkerId, unsigned int RolloutId,
+               PatternGeneratorInterface & aPGI)
+  {
+    return Objects[WorkerId]->Rollout(RolloutId,aPGI,NbOfIterations);
+  }
+};
+
+int main(int argc, char *argv[])
+{
+  if (argc<3)
+  {
+    cerr << "Usage: " << argv[0] << " robot.urdf robot.srdf" << endl;
+    return -1;
+  }
+
+  Workers_t aWorkers;
+  aWorkers.argc = argc;
+  aWorkers.argv = argv;
+  // 4 s of walking at 5 ms.
+  aWorkers.NbOfIterations = 800;
+
+  unsigned int lMaxNbOfWorkers = boost::thread::hardware_concurrency();
+  if (lMaxNbOfWorkers==0)
+    lMaxNbOfWorkers = 1;
+
+  PatternGeneratorBatchRunner::Rollout aRollout =
+    boost::bind(&Workers_t::Rollout,&aWorkers,_1,_2,_3);
+
+  // 1, 2, 4, ... threads up to the number of hardware threads.
+  vector<unsigned int> lNbsOfWorkers;
+  for(unsigned int i=1;i<lMaxNbOfWorkers;i*=2)
+    lNbsOfWorkers.push_back(i);
+  lNbsOfWorkers.push_back(lMaxNbOfWorkers);
+
+  double lRolloutsPerSecondWithOneThread = 0.0;
+  cout << "threads rollouts/s speed-up" << endl;
+  for(unsigned int k=0;k<lNbsOfWorkers.size();k++)
+  {
+    unsigned int lNbOfWorkers = lNbsOfWorkers[k];
+    PatternGeneratorBatchRunner aRunner
+      (boost::bind(&Workers_t::Create,&aWorkers,_1),
+       lNbOfWorkers,
+       boost::bind(&Workers_t::Release,&aWorkers,_1,_2));
+
+    unsigned int NbOfRollouts = 4*lNbOfWorkers;
+    struct timeval begin,end;
+    gettimeofday(&begin,0);
+    unsigned int lNbOfSuccesses = aRunner.Run(NbOfRollouts,aRollout);
+    gettimeofday(&end,0);
+
+    if (lNbOfSuccesses!=NbOfRollouts)
+    {
+      cerr << NbOfRollouts-lNbOfSuccesses << " rollouts failed with "
+           << lNbOfWorkers << " threads" << endl;
+      return -1;
+    }
+
+    double lDuration = (double)(end.tv_sec-begin.tv_sec) +
+      0.000001*(double)(end.tv_usec-begin.tv_usec);
+    double lRolloutsPerSecond = NbOfRollouts/lDuration;
+    if (lNbOfWorkers==1)
+      lRolloutsPerSecondWithOneThread = lRolloutsPerSecond;
+    cout << lNbOfWorkers << " " << lRolloutsPerSecond << " "
+         << lRolloutsPerSecond/lRolloutsPerSecondWithOneThread << endl;
+  }
+  return 0;
+}
@@ -0,0 +1,182 @@
+/*
+ * Copyright 2019,
+ *
+ * Olivier Stasse
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+/*! \file TestCommandHandles.cpp
+  \brief Check the dispatch of resolved commands against the string
+  interface and compare their timings.
+*/
+
+#include <sys/time.h>
+
+#include <iostream>
+
+#include "SimplePlugin.hh"
+#include "SimplePluginManager.hh"
+
+using namespace std;
+using namespace PatternGeneratorJRL;
+
+double ElapsedTime(struct timeval &begin, struct timeval &end)
+{
+  return (double)(end.tv_sec-begin.tv_sec)*1e6 +
+    (double)(end.tv_usec-begin.tv_usec);
+}
+
+/*! Plugin implementing :setVelReference with and without parsing. */
+class TypedPlugin : public SimplePlugin
+{
+public:
+  double x,y,yaw;
+  unsigned int NbOfStringCalls;
+
+  TypedPlugin(SimplePluginManager *lSPM):
+    SimplePlugin(lSPM), x(0.0), y(0.0), yaw(0.0), NbOfStringCalls(0)
+  {
+    string aMethodName(":setVelReference");
+    RegisterMethod(aMethodName,0);
+  }
+
+  void CallMethod(string &Method, istringstream &strm)
+  {
+    if (Method==":setVelReference")
+    {
+      strm >> x >> y >> yaw;
+      NbOfStringCalls++;
+    }
+  }
+
+  bool CallTypedMethod(int MethodId, const CommandArguments &Arguments)
+  {
+    if ((MethodId!=0) || (Arguments.size()<3))
+      return false;
+    x = Arguments[0]; y = Arguments[1]; yaw = Arguments[2];
+    return true;
+  }
+};
+
+/*! Plugin only implementing the string interface. */
+class StringPlugin : public SimplePlugin
+{
+public:
+  double x;
+
+  StringPlugin(SimplePluginManager *lSPM):
+    SimplePlugin(lSPM), x(0.0)
+  {
+    string aMethodName(":setVelReference");
+    RegisterMethod(aMethodName);
+  }
+
+  void CallMethod(string &, istringstream &strm)
+  {
+    strm >> x;
+  }
+};
+
+int main()
+{
+  SimplePluginManager aSPM;
+  TypedPlugin aTypedPlugin(&aSPM);
+
+  if (aSPM.ResolveCommand(":unknown")!=-1)
+  {
+    cerr << "An unknown command has been resolved" << endl;
+    return -1;
+  }
+  CommandHandle aHandle = aSPM.ResolveCommand(":setVelReference");
+  if ((aHandle<0) || (aSPM.ResolveCommand(":setVelReference")!=aHandle))
+  {
+    cerr << "Wrong handle " << aHandle << endl;
+    return -1;
+  }
+
+  aSPM.CallMethod(aHandle,CommandArguments(0.1,0.2,0.3));
+  if ((aTypedPlugin.x!=0.1) || (aTypedPlugin.y!=0.2) ||
+      (aTypedPlugin.yaw!=0.3) || (aTypedPlugin.NbOfStringCalls!=0))
+  {
+    cerr << "Typed dispatch failed" << endl;
+    return -1;
+  }
+
+  // The handle follows the registration of a new plugin,
+  // which receives the arguments through the string interface.
+  {
+    StringPlugin aStringPlugin(&aSPM);
+    aSPM.CallMethod(aHandle,CommandArguments(0.4,0.5,0.6));
+    if ((aTypedPlugin.x!=0.4) || (aStringPlugin.x!=0.4))
+    {
+      cerr << "Dispatch to a string plugin failed" << endl;
+      return -1;
+    }
+  }
+  if (!aSPM.CallMethod(aHandle,CommandArguments(0.7,0.8,0.9)) ||
+      (aTypedPlugin.x!=0.7))
+  {
+    cerr << "Dispatch after unregistration failed" << endl;
+    return -1;
+  }
+
+  // Timings: ParseCmd builds and parses a string at each call.
+  unsigned int NbOfCalls=100000;
+  struct timeval begin,end;
+
+  gettimeofday(&begin,0);
+  for(unsigned int i=0;i<NbOfCalls;i++)
+  {
+    ostringstream oss;
+    oss << ":setVelReference " << 0.001*i << " 0.0 0.1";
+    istringstream strm(oss.str());
+    string aCmd;
+    strm >> aCmd;
+    aSPM.CallMethod(aCmd,strm);
+  }
+  gettimeofday(&end,0);
+  double lTimeString = ElapsedTime(begin,end);
+  if (aTypedPlugin.NbOfStringCalls!=NbOfCalls)
+  {
+    cerr << "String dispatch failed" << endl;
+    return -1;
+  }
+
+  CommandArguments lArguments(0.0,0.0,0.1);
+  gettimeofday(&begin,0);
+  for(unsigned int i=0;i<NbOfCalls;i++)
+  {
+    lArguments.Values[0] = 0.001*i;
+    aSPM.CallMethod(aHandle,lArguments);
+  }
+  gettimeofday(&end,0);
+  double lTimeTyped = ElapsedTime(begin,end);
+
+  cout << "String command : " << lTimeString/NbOfCalls
+       << " us per call" << endl;
+  cout << "Typed command  : " << lTimeTyped/NbOfCalls
+       << " us per call" << endl;
+
+  if (aTypedPlugin.x!=0.001*(NbOfCalls-1))
+  {
+    cerr << "Typed dispatch failed" << endl;
+    return -1;
+  }
+  return 0;
+}
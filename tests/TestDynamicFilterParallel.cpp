@@ -0,0 +1,239 @@
+/*
+ * Copyright 2019,
+ *
+ * Olivier Stasse
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+/*! \file TestDynamicFilterParallel.cpp
+  \brief Check that the multibody ZMPs of the dynamic filter computed
+  by a pool of threads, or reused by the incremental mode, are the
+  ones of the sequential computation, over several sliding preview
+  windows.
+*/
+
+#include <cmath>
+
+#include "Debug.hh"
+#include "CommonTools.hh"
+#include "TestObject.hh"
+#include <jrl/walkgen/pgtypes.hh>
+#include <ZMPRefTrajectoryGeneration/DynamicFilter.hh>
+
+using namespace::PatternGeneratorJRL;
+using namespace::PatternGeneratorJRL::TestSuite;
+using namespace std;
+
+class TestDynamicFilterParallel: public TestObject
+{
+public:
+  TestDynamicFilterParallel(int argc, char *argv[], string &aTestName):
+    TestObject(argc,argv,aTestName)
+  {
+    m_DebugFGPI = false;
+    m_DebugFGPIFull = false;
+    m_StepStackHandler = 0;
+    m_ControlPeriod = 0.005;
+    m_InterpolationPeriod = 0.035;
+  }
+
+  ~TestDynamicFilterParallel()
+  {
+    for(unsigned int i=0;i<m_Filters.size();i++)
+      delete m_Filters[i];
+    if (m_StepStackHandler!=0)
+      delete m_StepStackHandler;
+  }
+
+  /*! Creates the filters and the starting state. */
+  bool initFilters()
+  {
+    PatternGeneratorInterface &aPGI = *m_PGI;
+    CommonInitialization(aPGI);
+
+    Eigen::Vector3d lStartingZMP;
+    Eigen::Matrix<double,6,1> lStartingWaist;
+    aPGI.EvaluateStartingState(m_StartingCoM,lStartingZMP,lStartingWaist,
+                               m_StartingLeftFoot,m_StartingRightFoot);
+
+    m_StepStackHandler = new StepStackHandler(m_SPM);
+    // Sequential, one thread, four threads, then incremental
+    // sequentially and with four threads.
+    m_Filters.push_back(newFilter(0));
+    m_Filters.push_back(newFilter(1));
+    m_Filters.push_back(newFilter(4));
+    m_Filters.push_back(newFilter(0));
+    m_Filters.back()->setIncremental(0.0,1);
+    m_Filters.push_back(newFilter(4));
+    m_Filters.back()->setIncremental(0.0,1);
+    return true;
+  }
+
+  /*! Filters NbOfCycles preview windows shifted by one
+    interpolation period, and compares the multibody ZMPs of
+    each filter with the ones of the first (sequential) filter. */
+  bool compare(unsigned int NbOfCycles)
+  {
+    unsigned int N = (unsigned int)m_Filters[0]->zmpmb().size();
+    unsigned int inc = (unsigned int)round(m_InterpolationPeriod/
+                                           m_ControlPeriod);
+    unsigned int N1 = (N-1)*inc+1;
+
+    RingBuffer<COMState> lCoM(N);
+    RingBuffer<FootAbsolutePosition> lLeftFoot(N,m_StartingLeftFoot);
+    RingBuffer<FootAbsolutePosition> lRightFoot(N,m_StartingRightFoot);
+    RingBuffer<ZMPPosition> lZMP(N1);
+
+    bool ok = true;
+    for(unsigned int k=0;k<NbOfCycles;k++)
+    {
+      for(unsigned int i=0;i<N;i++)
+        CoMState((double)(k+i)*m_InterpolationPeriod,lCoM[i]);
+      for(unsigned int j=0;j<N1;j++)
+      {
+        COMState aCoM;
+        CoMState((double)(k*inc+j)*m_ControlPeriod,aCoM);
+        lZMP[j].px = aCoM.x[0];
+        lZMP[j].py = aCoM.y[0];
+        lZMP[j].pz = 0.0;
+        lZMP[j].theta = 0.0;
+        lZMP[j].time = (double)(k*inc+j)*m_ControlPeriod;
+        lZMP[j].stepType = 0;
+      }
+
+      deque<Eigen::Vector3d> lReference;
+      for(unsigned int l=0;l<m_Filters.size();l++)
+      {
+        RingBuffer<COMState> lDeltaCoM(1);
+        if (m_Filters[l]->OnLinefilter(lCoM,lZMP,lLeftFoot,lRightFoot,
+                                       lDeltaCoM)<0)
+        {
+          cerr << "Filter " << l << " failed at cycle " << k << endl;
+          return false;
+        }
+        deque<Eigen::Vector3d> lZMPMB = m_Filters[l]->zmpmb();
+        if (l==0)
+        {
+          lReference = lZMPMB;
+          continue;
+        }
+        double lMaxError = 0.0;
+        for(unsigned int i=0;i<N;i++)
+          lMaxError = std::max(lMaxError,
+                               (lZMPMB[i]-lReference[i]).cwiseAbs().maxCoeff());
+        if (lMaxError>1e-9)
+        {
+          cerr << "Cycle " << k << ": the ZMPMBs with "
+               << m_Filters[l]->getNbOfWorkers() << " threads"
+               << (m_Filters[l]->isIncremental() ? " (incremental)" : "")
+               << " differ from the sequential ones by "
+               << lMaxError << endl;
+          ok = false;
+        }
+      }
+    }
+    return ok && checkReuse(NbOfCycles,N);
+  }
+
+protected:
+  /*! Each window is the previous one shifted by one sample, so after
+    the first one the incremental filters reuse all the ZMPMBs but the
+    ones of samples 1 (its finite differences need two previous
+    postures in the window) and N-1 (new). The ZMPMB of sample 0 is
+    never computed. */
+  bool checkReuse(unsigned int NbOfCycles, unsigned int N)
+  {
+    unsigned long int lReused = (NbOfCycles-1)*(N-3);
+    unsigned long int lComputed = (N-1) + 2*(NbOfCycles-1);
+    bool ok = true;
+    for(unsigned int l=0;l<m_Filters.size();l++)
+    {
+      if (!m_Filters[l]->isIncremental())
+        continue;
+      if ((m_Filters[l]->NbOfReusedZMPMB()!=lReused) ||
+          (m_Filters[l]->NbOfComputedZMPMB()!=lComputed))
+      {
+        cerr << "The incremental filter with "
+             << m_Filters[l]->getNbOfWorkers() << " threads reused "
+             << m_Filters[l]->NbOfReusedZMPMB() << " ZMPMBs and computed "
+             << m_Filters[l]->NbOfComputedZMPMB() << ", instead of "
+             << lReused << " and " << lComputed << endl;
+        ok = false;
+      }
+    }
+    return ok;
+  }
+
+  void chooseTestProfile() {}
+  void generateEvent() {}
+
+  DynamicFilter * newFilter(unsigned int NbOfWorkers)
+  {
+    DynamicFilter * aDF = new DynamicFilter(m_SPM,m_PR);
+    aDF->getComAndFootRealization()->SetStepStackHandler(m_StepStackHandler);
+    aDF->getComAndFootRealization()->ShiftFoot(true);
+    aDF->init(m_ControlPeriod,m_InterpolationPeriod,m_ControlPeriod,
+              1.5,1.5-m_ControlPeriod,m_StartingCoM);
+    {
+      string aMethod(":useDynamicFilter");
+      istringstream strm2("true");
+      aDF->CallMethod(aMethod,strm2);
+    }
+    aDF->setNbOfWorkers(NbOfWorkers);
+    return aDF;
+  }
+
+  /*! Forward motion with a lateral sway, the feet stay in place. */
+  void CoMState(double t, COMState &aCoM)
+  {
+    double w = 2.0*M_PI;
+    aCoM.reset();
+    aCoM.x[0] = m_StartingCoM.x[0] + 0.02*t;
+    aCoM.x[1] = 0.02;
+    aCoM.y[0] = m_StartingCoM.y[0] + 0.01*sin(w*t);
+    aCoM.y[1] = 0.01*w*cos(w*t);
+    aCoM.y[2] = -0.01*w*w*sin(w*t);
+    aCoM.z[0] = m_StartingCoM.z[0];
+  }
+
+  double m_ControlPeriod;
+  double m_InterpolationPeriod;
+
+  COMState m_StartingCoM;
+  FootAbsolutePosition m_StartingLeftFoot;
+  FootAbsolutePosition m_StartingRightFoot;
+  StepStackHandler * m_StepStackHandler;
+  vector<DynamicFilter *> m_Filters;
+};
+
+int main(int argc, char *argv[])
+{
+  string aTestName("TestDynamicFilterParallel");
+  TestDynamicFilterParallel aTest(argc,argv,aTestName);
+  if (!aTest.init())
+  {
+    cerr << "Unable to initialize the test" << endl;
+    return -1;
+  }
+  if (!aTest.initFilters())
+    return -1;
+  if (!aTest.compare(10))
+    return -1;
+  return 0;
+}
@@ -0,0 +1,210 @@
+/*
+ * Copyright 2019,
+ *
+ * Olivier Stasse
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+/*! \file TestDynamicFilterScaling.cpp
+  \brief Duration of the dynamic filter of the on-line walking
+  (Herdt 2010) against the number of threads computing the
+  multibody ZMPs of the preview window, and with the incremental
+  mode reusing the ZMPs of the previous horizons.
+  Fails if the trajectories of a run differ from the sequential one.
+*/
+
+#include <sys/time.h>
+#include <cmath>
+
+#include <boost/thread/thread.hpp>
+
+#include "Debug.hh"
+#include "CommonTools.hh"
+#include "TestObject.hh"
+
+using namespace::PatternGeneratorJRL;
+using namespace::PatternGeneratorJRL::TestSuite;
+using namespace std;
+
+/*! Walk on-line with the dynamic filter. */
+class DynamicFilterObject: public TestObject
+{
+public:
+  DynamicFilterObject(int argc, char *argv[], string &aTestName):
+    TestObject(argc,argv,aTestName)
+  {
+    m_DebugFGPI = false;
+    m_DebugFGPIFull = false;
+  }
+
+  /*! Returns the duration of the walk in seconds,
+    or a negative value if it failed. IncrementalDepth 0 disables
+    the incremental mode. The ZMP and CoM are stored in Trajectory. */
+  double Walk(unsigned int NbOfWorkers,
+              unsigned int IncrementalDepth,
+              unsigned int NbOfIterations,
+              vector<double> & Trajectory)
+  {
+    PatternGeneratorInterface &aPGI = *m_PGI;
+    CommonInitialization(aPGI);
+    {
+      istringstream strm2(":SetAlgoForZmpTrajectory Herdt");
+      aPGI.ParseCmd(strm2);
+    }
+    {
+      istringstream strm2(":singlesupporttime 0.7");
+      aPGI.ParseCmd(strm2);
+    }
+    {
+      istringstream strm2(":doublesupporttime 0.1");
+      aPGI.ParseCmd(strm2);
+    }
+    {
+      istringstream strm2(":useDynamicFilter true");
+      aPGI.ParseCmd(strm2);
+    }
+    {
+      ostringstream oss;
+      oss << ":dynamicfilterworkers " << NbOfWorkers;
+      istringstream strm2(oss.str());
+      aPGI.ParseCmd(strm2);
+    }
+    {
+      ostringstream oss;
+      if (IncrementalDepth==0)
+        oss << ":dynamicfilterincremental off";
+      else
+        oss << ":dynamicfilterincremental 1e-9 " << IncrementalDepth;
+      istringstream strm2(oss.str());
+      aPGI.ParseCmd(strm2);
+    }
+    {
+      istringstream strm2(":HerdtOnline 0.2 0.0 0.0");
+      aPGI.ParseCmd(strm2);
+    }
+
+    Trajectory.resize(4*NbOfIterations);
+    struct timeval begin,end;
+    gettimeofday(&begin,0);
+    for(unsigned int i=0;i<NbOfIterations;i++)
+    {
+      if (!aPGI.RunOneStepOfTheControlLoop(m_CurrentConfiguration,
+                                           m_CurrentVelocity,
+                                           m_CurrentAcceleration,
+                                           m_OneStep.m_ZMPTarget,
+                                           m_OneStep.m_finalCOMPosition,
+                                           m_OneStep.m_LeftFootPosition,
+                                           m_OneStep.m_RightFootPosition))
+        return -1.0;
+      Trajectory[4*i]   = m_OneStep.m_ZMPTarget(0);
+      Trajectory[4*i+1] = m_OneStep.m_ZMPTarget(1);
+      Trajectory[4*i+2] = m_OneStep.m_finalCOMPosition.x[0];
+      Trajectory[4*i+3] = m_OneStep.m_finalCOMPosition.y[0];
+    }
+    gettimeofday(&end,0);
+    if (IncrementalDepth>0)
+    {
+      istringstream strm2(":dynamicfilterhitrate");
+      aPGI.ParseCmd(strm2);
+    }
+    return (double)(end.tv_sec-begin.tv_sec) +
+      0.000001*(double)(end.tv_usec-begin.tv_usec);
+  }
+
+protected:
+  void chooseTestProfile() {}
+  void generateEvent() {}
+};
+
+int main(int argc, char *argv[])
+{
+  if (argc<3)
+  {
+    cerr << "Usage: " << argv[0] << " robot.urdf robot.srdf" << endl;
+    return -1;
+  }
+
+  // 4 s of walking at 5 ms.
+  unsigned int NbOfIterations = 800;
+
+  unsigned int lMaxNbOfWorkers = boost::thread::hardware_concurrency();
+  if (lMaxNbOfWorkers==0)
+    lMaxNbOfWorkers = 1;
+
+  // 0 (sequential), then 1, 2, 4, ... threads
+  // up to the number of hardware threads.
+  vector<unsigned int> lNbsOfWorkers;
+  lNbsOfWorkers.push_back(0);
+  for(unsigned int i=1;i<lMaxNbOfWorkers;i*=2)
+    lNbsOfWorkers.push_back(i);
+  lNbsOfWorkers.push_back(lMaxNbOfWorkers);
+
+  // Last run: sequential, incremental on the horizons of the
+  // last 7 control cycles (one interpolation period).
+  lNbsOfWorkers.push_back(0);
+
+  // The incremental mode reuses the ZMPs within 1e-9,
+  // the threads compute exactly the sequential ones.
+  const double lTolerance = 1e-6;
+  vector<double> lSequential, lTrajectory;
+  double lSequentialDuration = 0.0;
+  cout << "threads ms/iteration speed-up" << endl;
+  for(unsigned int k=0;k<lNbsOfWorkers.size();k++)
+  {
+    unsigned int lNbOfWorkers = lNbsOfWorkers[k];
+    unsigned int lIncrementalDepth = (k+1==lNbsOfWorkers.size()) ? 7 : 0;
+    string aTestName("TestDynamicFilterScaling");
+    DynamicFilterObject anObject(argc,argv,aTestName);
+    if (!anObject.init())
+    {
+      cerr << "Unable to initialize the test" << endl;
+      return -1;
+    }
+
+    double lDuration = anObject.Walk(lNbOfWorkers,lIncrementalDepth,
+                                     NbOfIterations,
+                                     k==0 ? lSequential : lTrajectory);
+    if (lDuration<0.0)
+    {
+      cerr << "The walk failed with " << lNbOfWorkers
+           << " threads" << endl;
+      return -1;
+    }
+    if (k==0)
+      lSequentialDuration = lDuration;
+    else
+    {
+      double lMaxError = 0.0;
+      for(unsigned int i=0;i<lSequential.size();i++)
+        lMaxError = std::max(lMaxError,fabs(lTrajectory[i]-lSequential[i]));
+      if (lMaxError>lTolerance)
+      {
+        cerr << "The trajectories with " << lNbOfWorkers << " threads"
+             << (lIncrementalDepth>0 ? " (incremental)" : "")
+             << " differ from the sequential ones by " << lMaxError << endl;
+        return -1;
+      }
+    }
+    if (lIncrementalDepth>0)
+      cout << "incremental ";
+    cout << lNbOfWorkers << " " << 1000.0*lDuration/NbOfIterations << " "
+         << lSequentialDuration/lDuration << endl;
+  }
+  return 0;
+}
@@ -43,12 +43,30 @@ class TestHerdt2010: public TestObject
 
 private:
 public:
-  TestHerdt2010(int argc, char *argv[], string &aString, int TestProfile):
-    TestObject(argc,argv,aString)
+  TestHerdt2010(int argc, char *argv[], string &aString, int TestProfile,
+                string QPSolver="qld"):
+    TestObject(argc,argv,aString),
+    m_QPSolver(QPSolver)
   {
     m_TestProfile = TestProfile;
+    // The interior point method stops at a duality gap of 1e-8.
+    if (m_QPSolver=="riccati")
+      m_ReferenceTolerance = 1e-5;
   };
 
+  /*! Run the test and report the time spent in the QP solver. */
+  bool doTest(std::ostream &os)
+  {
+    bool lResult = TestObject::doTest(os);
+    StageLatency aLatency;
+    m_PGI->GetStageLatency(STAGE_QP_SOLVE,aLatency);
+    os << m_QPSolver
+       << " QP solve: " << aLatency.Count << " calls, p50 "
+       << aLatency.P50*1e6 << " us, p99 " << aLatency.P99*1e6
+       << " us, max " << aLatency.Max*1e6 << " us" << endl;
+    return lResult;
+  }
+
   typedef void (TestHerdt2010::* localeventHandler_t)(PatternGeneratorInterface &);
 
   struct localEvent
@@ -59,6 +77,15 @@ public:
 
 protected:
 
+  /*! Solver of the QP: qld, activeset, race or riccati. */
+  string m_QPSolver;
+
+  void selectQPSolver(PatternGeneratorInterface &aPGI)
+  {
+    istringstream strm2(":qpsolver "+m_QPSolver);
+    aPGI.ParseCmd(strm2);
+  }
+
   void startOnLineWalking(PatternGeneratorInterface &aPGI)
   {
     CommonInitialization(aPGI);
@@ -68,6 +95,7 @@ protected:
       aPGI.ParseCmd(strm2);
 
     }
+    selectQPSolver(aPGI);
     {
       istringstream strm2(":setfeetconstraint XY 0.09 0.06");
       m_PGI->ParseCmd(strm2);
@@ -100,6 +128,7 @@ protected:
       aPGI.ParseCmd(strm2);
 
     }
+    selectQPSolver(aPGI);
     {
       istringstream strm2(":setfeetconstraint XY 0.09 0.06");
       m_PGI->ParseCmd(strm2);
@@ -251,7 +280,7 @@ protected:
     // Test when triggering event.
     for(unsigned int i=0;i<localNbOfEvents;i++)
       {
-    if ( m_OneStep.NbOfIt==events[i].time)
+    if ( m_OneStep.m_NbOfIt==events[i].time)
       {
             ODEBUG3("********* GENERATE EVENT OLW ***********");
         (this->*(events[i].Handler))(*m_PGI);
@@ -272,7 +301,7 @@ protected:
     // Test when triggering event.
     for(unsigned int i=0;i<localNbOfEventsEMS;i++)
       {
-    if ( m_OneStep.NbOfIt==events[i].time)
+    if ( m_OneStep.m_NbOfIt==events[i].time)
       {
             ODEBUG3("********* GENERATE EVENT EMS ***********");
         (this->*(events[i].Handler))(*m_PGI);
@@ -310,6 +339,13 @@ int PerformTests(int argc, char *argv[])
     indexProfile=0;
   if (TestName.compare(13,13,"EmergencyStop")==0)
     indexProfile=1;
+  std::string QPSolver("qld");
+  if (TestName.find("ActiveSet")!=std::string::npos)
+    QPSolver = "activeset";
+  if (TestName.find("Riccati")!=std::string::npos)
+    QPSolver = "riccati";
+  if (TestName.find("Race")!=std::string::npos)
+    QPSolver = "race";
 
   if (indexProfile==-1)
   {
@@ -319,9 +355,27 @@ int PerformTests(int argc, char *argv[])
     exit(-1);
   }
 
+  // The trajectories of the other solvers are compared
+  // with the ones of QLD on the same scenario.
+  if (QPSolver!="qld")
+  {
+    std::string ReferenceName = TestName + "QLD";
+    TestHerdt2010 aReference(argc,argv,
+                             ReferenceName,
+                             TestProfiles[indexProfile]);
+    aReference.init();
+    // QLD has no reference file of its own.
+    std::ostringstream aLog;
+    aReference.doTest(aLog);
+    std::ifstream aTrajectory((ReferenceName+"TestFGPI.dat").c_str());
+    std::ofstream aCopy((TestName+"TestFGPI.datref").c_str());
+    aCopy << aTrajectory.rdbuf();
+  }
+
   TestHerdt2010 aTH2010(argc,argv,
             TestName,
-            TestProfiles[indexProfile]);
+            TestProfiles[indexProfile],
+            QPSolver);
   aTH2010.init();
   try
   {
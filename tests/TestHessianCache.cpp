@@ -0,0 +1,244 @@
+/*
+ * Copyright 2019,
+ *
+ * Olivier Stasse
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+/*! \file TestHessianCache.cpp
+  \brief Check the least recently used cache of Hessians, its file
+  format, and the use of its factors by the active-set solver.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+
+#include <iostream>
+
+#include <Eigen/Dense>
+
+#include "Mathematics/active-set-qp.hh"
+#include "ZMPRefTrajectoryGeneration/hessian-cache.hh"
+
+using namespace std;
+using namespace PatternGeneratorJRL;
+
+double ElapsedTime(struct timeval &begin, struct timeval &end)
+{
+  return (double)(end.tv_sec-begin.tv_sec)*1e6 +
+    (double)(end.tv_usec-begin.tv_usec);
+}
+
+/*! Key of a gait profile: one step every StepSamples samples. */
+hessian_key_t ProfileKey(unsigned int N, double CoMHeight,
+                         unsigned int StepSamples, unsigned int Phase)
+{
+  hessian_key_t Key;
+  Key.N = N;
+  Key.T = 0.1;
+  Key.CoMHeight = CoMHeight;
+  Key.Weights[0] = 0.00001;
+  Key.Weights[1] = 1.0;
+  Key.Weights[2] = 0.000001;
+  Key.Pattern.resize(N);
+  for(unsigned int i=0;i<N;i++)
+    Key.Pattern[i] = (i+1+Phase)/StepSamples;
+  return Key;
+}
+
+/*! Hessian of one coordinate of the Herdt 2010 QP for Key. */
+Eigen::MatrixXd BuildHessian(const hessian_key_t & Key)
+{
+  unsigned int N = Key.N, nf = Key.Pattern.back();
+  double T = Key.T, hg = Key.CoMHeight/9.81;
+  Eigen::MatrixXd Uv = Eigen::MatrixXd::Zero(N,N);
+  Eigen::MatrixXd Uz = Eigen::MatrixXd::Zero(N,N);
+  Eigen::MatrixXd V = Eigen::MatrixXd::Zero(N,nf);
+  for(unsigned int i=0;i<N;i++)
+  {
+    for(unsigned int j=0;j<=i;j++)
+    {
+      Uv(i,j) = (2*(i-j)+1)*T*T*0.5;
+      Uz(i,j) = (1 + 3*(i-j) + 3*(i-j)*(i-j))*T*T*T/6.0 - T*hg;
+    }
+    if (Key.Pattern[i]>0)
+      V(i,Key.Pattern[i]-1) = 1.0;
+  }
+  Eigen::MatrixXd Q(N+nf,N+nf);
+  Q.topLeftCorner(N,N) = Key.Weights[0]*Eigen::MatrixXd::Identity(N,N)
+    + Key.Weights[1]*Uv.transpose()*Uv + Key.Weights[2]*Uz.transpose()*Uz;
+  Q.topRightCorner(N,nf) = -Key.Weights[2]*Uz.transpose()*V;
+  Q.bottomLeftCorner(nf,N) = -Key.Weights[2]*V.transpose()*Uz;
+  Q.bottomRightCorner(nf,nf) = Key.Weights[2]*V.transpose()*V;
+  return Q;
+}
+
+bool CheckLRU()
+{
+  HessianCache aCache(3);
+  for(unsigned int Phase=0;Phase<3;Phase++)
+  {
+    hessian_key_t Key = ProfileKey(16,0.814,8,Phase);
+    aCache.insert(Key,BuildHessian(Key));
+  }
+  // Phase 0 becomes the most recently used, phase 1 is dropped.
+  if (aCache.find(ProfileKey(16,0.814,8,0))==0)
+    return false;
+  hessian_key_t Key = ProfileKey(16,0.814,8,3);
+  aCache.insert(Key,BuildHessian(Key));
+  if (aCache.Size()!=3 ||
+      aCache.find(ProfileKey(16,0.814,8,1))!=0 ||
+      aCache.find(ProfileKey(16,0.814,8,0))==0 ||
+      aCache.find(ProfileKey(16,0.814,8,2))==0)
+  {
+    cerr << "Wrong entries after an eviction" << endl;
+    return false;
+  }
+  // Same pattern, other CoM height.
+  if (aCache.find(ProfileKey(16,0.7,8,0))!=0)
+  {
+    cerr << "Different profiles share an entry" << endl;
+    return false;
+  }
+  return true;
+}
+
+bool CheckFactor()
+{
+  HessianCache aCache;
+  hessian_key_t Key = ProfileKey(16,0.814,8,5);
+  Eigen::MatrixXd Q = BuildHessian(Key);
+  const hessian_entry_t & Entry = aCache.insert(Key,Q);
+  Eigen::MatrixXd I = Entry.Rinv.transpose()*Q*Entry.Rinv;
+  if (!I.isApprox(Eigen::MatrixXd::Identity(Q.rows(),Q.cols()),1e-6))
+  {
+    cerr << "Wrong factor" << endl;
+    return false;
+  }
+
+  // The solver takes the factor instead of computing it.
+  unsigned int n = Q.rows();
+  Eigen::VectorXd D = Eigen::VectorXd::Random(n);
+  Eigen::VectorXd XL = Eigen::VectorXd::Constant(n,-1e10);
+  Eigen::VectorXd XU = Eigen::VectorXd::Constant(n,1e10);
+  Eigen::MatrixXd DU(2,n);
+  DU.setZero();
+  DU(0,0) = -1.0;
+  Eigen::VectorXd DS(1);
+  DS(0) = 0.01;
+  Eigen::VectorXd X1(n), X2(n), U(1+2*n);
+
+  ActiveSetQP Cold, Hot;
+  Cold.solve(n,1,0,Q.data(),D.data(),DU.data(),2,DS.data(),
+             XL.data(),XU.data(),X1.data(),U.data());
+  Hot.factorization(Q,Entry.Rinv);
+  Hot.solve(n,1,0,Q.data(),D.data(),DU.data(),2,DS.data(),
+            XL.data(),XU.data(),X2.data(),U.data());
+  if (!Hot.FactorizationReused() || !X1.isApprox(X2,1e-6))
+  {
+    cerr << "Factor of the cache not used by the solver" << endl;
+    return false;
+  }
+  return true;
+}
+
+bool CheckFile(const char * FileName)
+{
+  HessianCache aCache;
+  for(unsigned int Phase=0;Phase<8;Phase++)
+  {
+    hessian_key_t Key = ProfileKey(16,0.814,8,Phase);
+    aCache.insert(Key,BuildHessian(Key));
+  }
+  aCache.find(ProfileKey(16,0.814,8,2));
+  if (aCache.save(FileName)!=0)
+    return false;
+
+  HessianCache aLoaded(8);
+  if (aLoaded.load(FileName)!=8)
+  {
+    cerr << "Unable to read " << FileName << endl;
+    return false;
+  }
+  // The order of use is kept: phase 0 is the least recently used.
+  hessian_key_t Key = ProfileKey(16,0.7,8,0);
+  aLoaded.insert(Key,BuildHessian(Key));
+  if (aLoaded.find(ProfileKey(16,0.814,8,0))!=0)
+  {
+    cerr << "Wrong order of use after loading" << endl;
+    return false;
+  }
+  for(unsigned int Phase=1;Phase<8;Phase++)
+  {
+    const hessian_entry_t * Entry = aLoaded.find(ProfileKey(16,0.814,8,Phase));
+    const hessian_entry_t * Ref = aCache.find(ProfileKey(16,0.814,8,Phase));
+    if (Entry==0 || Entry->Q!=Ref->Q || Entry->Rinv!=Ref->Rinv)
+    {
+      cerr << "Different entries after loading" << endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+int main()
+{
+  if (!CheckLRU() || !CheckFactor() || !CheckFile("TestHessianCache.bin"))
+    return -1;
+  remove("TestHessianCache.bin");
+
+  // Switching between two gait profiles: one step every 8 or 7 samples.
+  const unsigned int NbCycles=2000;
+  struct timeval begin,end;
+  HessianCache aCache;
+  double lTimeBuild=0.0, lTimeCache=0.0;
+  for(unsigned int lCycle=0;lCycle<NbCycles;lCycle++)
+  {
+    unsigned int StepSamples = ((lCycle/100)%2==0) ? 8 : 7;
+    hessian_key_t Key = ProfileKey(16,0.814,StepSamples,lCycle%StepSamples);
+
+    gettimeofday(&begin,0);
+    Eigen::MatrixXd Q = BuildHessian(Key);
+    Eigen::LLT<Eigen::MatrixXd> aLLT(Q);
+    Eigen::MatrixXd Rinv = Eigen::MatrixXd::Identity(Q.rows(),Q.cols());
+    aLLT.matrixU().solveInPlace(Rinv);
+    gettimeofday(&end,0);
+    lTimeBuild += ElapsedTime(begin,end);
+
+    gettimeofday(&begin,0);
+    const hessian_entry_t * Entry = aCache.find(Key);
+    if (Entry==0)
+      Entry = &aCache.insert(Key,BuildHessian(Key));
+    gettimeofday(&end,0);
+    lTimeCache += ElapsedTime(begin,end);
+
+    if (Entry->Rinv!=Rinv)
+    {
+      cerr << "Different factors at cycle " << lCycle << endl;
+      return -1;
+    }
+  }
+  cout << "Build and factorization : " << lTimeBuild/NbCycles
+       << " us per cycle" << endl;
+  cout << "Cache                   : " << lTimeCache/NbCycles
+       << " us per cycle (" << aCache.Hits() << " hits, "
+       << aCache.Misses() << " misses)" << endl;
+  return 0;
+}
@@ -0,0 +1,136 @@
+/*
+ * Copyright 2019,
+ *
+ * Olivier Stasse
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+/*! \file TestLatencyHistogram.cpp
+  \brief Check the percentiles of LatencyHistogram against
+  a sorted copy of the samples, and the cost of a measurement.
+*/
+
+#include <stdlib.h>
+
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+#include "LatencyHistogram.hh"
+
+using namespace std;
+using namespace PatternGeneratorJRL;
+
+/*! The percentiles have to be upper bounds within the bucket precision. */
+bool CheckPercentiles()
+{
+  LatencyHistogram aHistogram;
+  vector<unsigned long long> lSamples;
+
+  srand(0);
+  for(unsigned int i=0;i<100000;i++)
+  {
+    // Mostly around 100 us, with a tail up to 10 ms.
+    unsigned long long lDuration = 50000 + rand()%100000;
+    if (rand()%100==0)
+      lDuration += rand()%10000000;
+    lSamples.push_back(lDuration);
+    aHistogram.Record(lDuration);
+  }
+  sort(lSamples.begin(),lSamples.end());
+
+  if (aHistogram.Count()!=lSamples.size())
+  {
+    cerr << "Wrong count" << endl;
+    return false;
+  }
+  if (aHistogram.Max()!=lSamples.back())
+  {
+    cerr << "Wrong maximum" << endl;
+    return false;
+  }
+
+  const double lFractions[4] = { 0.5, 0.9, 0.99, 0.999 };
+  for(unsigned int i=0;i<4;i++)
+  {
+    unsigned long long lExact =
+      lSamples[(size_t)(lFractions[i]*lSamples.size())-1];
+    unsigned long long lEstimate = aHistogram.Percentile(lFractions[i]);
+    if ((lEstimate<lExact) || ((double)lEstimate>1.04*(double)lExact))
+    {
+      cerr << "Percentile " << lFractions[i] << ": " << lEstimate
+           << " instead of " << lExact << endl;
+      return false;
+    }
+  }
+
+  aHistogram.Reset();
+  if ((aHistogram.Count()!=0) || (aHistogram.Percentile(0.5)!=0))
+  {
+    cerr << "Reset failed" << endl;
+    return false;
+  }
+  return true;
+}
+
+/*! Small and huge durations fall in the first and last buckets. */
+bool CheckRange()
+{
+  LatencyHistogram aHistogram;
+  for(unsigned long long i=0;i<64;i++)
+    aHistogram.Record(i);
+  if (aHistogram.Percentile(0.5)!=31)
+  {
+    cerr << "Small durations are not exact" << endl;
+    return false;
+  }
+  aHistogram.Record(1ULL<<50);
+  if (aHistogram.Percentile(1.0)!=(1ULL<<50))
+  {
+    cerr << "Wrong maximum for a huge duration" << endl;
+    return false;
+  }
+  return true;
+}
+
+int main()
+{
+  if (!CheckPercentiles() || !CheckRange())
+    return -1;
+
+  LatencyProfile aProfile;
+  const unsigned int NbOfMeasures=1000000;
+  unsigned long long lBegin = MonotonicTime();
+  for(unsigned int i=0;i<NbOfMeasures;i++)
+  {
+    ScopedLatency aLatency(&aProfile,STAGE_QP_SOLVE);
+  }
+  unsigned long long lDuration = MonotonicTime()-lBegin;
+  cout << "ScopedLatency: " << (double)lDuration/NbOfMeasures
+       << " ns per measure" << endl;
+
+  StageLatency aLatency;
+  aProfile.Stage(STAGE_QP_SOLVE).Statistics(aLatency);
+  cout << LatencyProfile::StageName(STAGE_QP_SOLVE)
+       << " p50: " << aLatency.P50 << " p99: " << aLatency.P99
+       << " max: " << aLatency.Max << endl;
+  if (aLatency.Count!=NbOfMeasures)
+    return -1;
+  return 0;
+}
@@ -0,0 +1,206 @@
+/*
+ * Copyright 2019,
+ *
+ * Olivier Stasse
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+/*! \file TestNMPCHessianFactor.cpp
+  \brief Check the cached factorization of the NMPC Hessian against a
+  full Cholesky decomposition, and compare their timings over a walk.
+*/
+
+#include <math.h>
+#include <sys/time.h>
+
+#include <iostream>
+
+#include <Eigen/Dense>
+
+#include "ZMPRefTrajectoryGeneration/nmpc_hessian_factor.hh"
+
+using namespace std;
+using namespace PatternGeneratorJRL;
+
+double ElapsedTime(struct timeval &begin, struct timeval &end)
+{
+  return (double)(end.tv_sec-begin.tv_sec)*1e6 +
+    (double)(end.tv_usec-begin.tv_usec);
+}
+
+/*! Blocks of the Hessian built by NMPCgenerator::updateCostFunction()
+  for a first sampling period Tfirst and a step every StepSamples. */
+struct HessianBlocks
+{
+  unsigned int N, nf;
+  double T, hg;
+  Eigen::MatrixXd Pvu, Pzu, V;
+  Eigen::MatrixXd Q_x_XX, Q_y_XX, Q_XF, Q_FF, Q_theta, H;
+
+  HessianBlocks(unsigned int lN, unsigned int lnf):
+    N(lN), nf(lnf), T(0.1), hg(0.814/9.81)
+  {
+    Pvu.setZero(N,N);
+    Pzu.setZero(N,N);
+    for(unsigned int i=0;i<N;i++)
+      for(unsigned int j=1;j<=i;j++)
+      {
+        double i_j = (double)(i-j);
+        Pvu(i,j) = (2.0*i_j+1)*T*T*0.5;
+        Pzu(i,j) = (3.0*i_j*i_j + 3.0*i_j + 1)*T*T*T/6.0 - T*hg;
+      }
+    Q_theta = 1e+06*Eigen::MatrixXd::Identity(nf,nf);
+  }
+
+  void update(double Tfirst, unsigned int StepSamples, unsigned int Phase)
+  {
+    double T1 = Tfirst;
+    for(unsigned int i=0;i<N;i++)
+    {
+      Pvu(i,0) = T1*T1*0.5 + i*T*T1;
+      Pzu(i,0) = (T1*T1*T1 + 3*i*T*T1*T1 + 3*i*i*T*T*T1)/6.0 - T1*hg;
+    }
+    V.setZero(N,nf);
+    for(unsigned int i=0;i<N;i++)
+    {
+      unsigned int lStep = (i+Phase)/StepSamples;
+      if (lStep>0 && lStep<=nf)
+        V(i,lStep-1) = 1.0;
+    }
+
+    const double alpha=5.0, beta=1e+03, minjerk=1e-08, delta=1e-06;
+    Q_x_XX = alpha*Pvu.transpose()*Pvu + beta*Pzu.transpose()*Pzu
+      + minjerk*Eigen::MatrixXd::Identity(N,N);
+    Q_y_XX = Q_x_XX;
+    Q_XF = -beta*Pzu.transpose()*V;
+    Q_FF = beta*V.transpose()*V + delta*Eigen::MatrixXd::Identity(nf,nf);
+
+    unsigned int Nnf = N+nf;
+    H.setZero(2*Nnf+nf,2*Nnf+nf);
+    for(unsigned int k=0;k<2;k++)
+    {
+      H.block(k*Nnf,k*Nnf,N,N) = Q_x_XX;
+      H.block(k*Nnf,k*Nnf+N,N,nf) = Q_XF;
+      H.block(k*Nnf+N,k*Nnf,nf,N) = Q_XF.transpose();
+      H.block(k*Nnf+N,k*Nnf+N,nf,nf) = Q_FF;
+    }
+    H.block(2*Nnf,2*Nnf,nf,nf) = Q_theta;
+  }
+};
+
+/*! What QuadProg does on each call when the Hessian is not given
+  decomposed: Cholesky decomposition and inversion of the factor. */
+void FullInverseFactor(const Eigen::MatrixXd & H,
+                       Eigen::LLT<Eigen::MatrixXd> & aLLT,
+                       Eigen::MatrixXd & Rinv)
+{
+  aLLT.compute(H);
+  Rinv.setIdentity(H.rows(),H.cols());
+  aLLT.matrixU().solveInPlace(Rinv);
+}
+
+int main()
+{
+  // Walk of the Naveau 2015 generator: 16 samples of 0.1 s, two previewed
+  // steps of 0.8 s, one control cycle every 5 ms.
+  const unsigned int N=16, nf=2, StepSamples=8;
+  const unsigned int NbCycles=16000, CyclesPerSample=20;
+  const double Tcontrol=0.005;
+
+  HessianBlocks aBlocks(N,nf);
+  NMPCHessianFactor aFactor;
+  Eigen::LLT<Eigen::MatrixXd> aLLT;
+  Eigen::MatrixXd Rinv, RinvRef;
+
+  // Check the factors, and that the lower part is zero
+  // as QuadProg expects an upper triangular matrix.
+  for(unsigned int lCycle=0;lCycle<2*StepSamples*CyclesPerSample;lCycle++)
+  {
+    unsigned int lSample = lCycle/CyclesPerSample;
+    double Tfirst = aBlocks.T - Tcontrol*(lCycle%CyclesPerSample);
+    aBlocks.update(Tfirst,StepSamples,lSample%StepSamples);
+    if (!aFactor.factorize((long)floor(Tfirst*1e6+0.5),
+                           aBlocks.Q_x_XX,aBlocks.Q_y_XX,aBlocks.Q_XF,
+                           aBlocks.Q_FF,aBlocks.Q_theta,Rinv))
+    {
+      cerr << "Factorization failed at cycle " << lCycle << endl;
+      return -1;
+    }
+    FullInverseFactor(aBlocks.H,aLLT,RinvRef);
+    Eigen::MatrixXd lIdentity = Rinv.transpose()*aBlocks.H*Rinv;
+    double lError = (lIdentity -
+                     Eigen::MatrixXd::Identity(Rinv.rows(),Rinv.cols()))
+      .cwiseAbs().maxCoeff();
+    double lLower = Rinv.triangularView<Eigen::StrictlyLower>()
+      .toDenseMatrix().cwiseAbs().maxCoeff();
+    if (lError>1e-6 || lLower!=0.0 ||
+        !Rinv.isApprox(RinvRef,1e-6))
+    {
+      cerr << "Wrong factor at cycle " << lCycle
+           << ": error " << lError << endl;
+      return -1;
+    }
+  }
+  if (aFactor.cacheSize()!=CyclesPerSample)
+  {
+    cerr << aFactor.cacheSize() << " cached factors instead of "
+         << CyclesPerSample << endl;
+    return -1;
+  }
+
+  // The SQP iterations of a cycle share the Hessian: it is factorized
+  // on each iteration by QuadProg, and on the first one only otherwise.
+  struct timeval begin,end;
+  for(unsigned int NbIterations=1;NbIterations<=3;NbIterations+=2)
+  {
+    double lTimeFull=0.0, lTimeCached=0.0, lSum=0.0;
+    for(unsigned int lCycle=0;lCycle<NbCycles;lCycle++)
+    {
+      unsigned int lSample = lCycle/CyclesPerSample;
+      double Tfirst = aBlocks.T - Tcontrol*(lCycle%CyclesPerSample);
+      aBlocks.update(Tfirst,StepSamples,lSample%StepSamples);
+
+      gettimeofday(&begin,0);
+      for(unsigned int lIt=0;lIt<NbIterations;lIt++)
+        FullInverseFactor(aBlocks.H,aLLT,RinvRef);
+      gettimeofday(&end,0);
+      lTimeFull += ElapsedTime(begin,end);
+
+      gettimeofday(&begin,0);
+      aFactor.factorize((long)floor(Tfirst*1e6+0.5),
+                        aBlocks.Q_x_XX,aBlocks.Q_y_XX,aBlocks.Q_XF,
+                        aBlocks.Q_FF,aBlocks.Q_theta,Rinv);
+      gettimeofday(&end,0);
+      lTimeCached += ElapsedTime(begin,end);
+      lSum += RinvRef(0,0)-Rinv(0,0);
+    }
+    cout << NbIterations << " SQP iteration(s) per cycle, "
+         << "factorization time per cycle:" << endl
+         << "  full Cholesky : " << lTimeFull/NbCycles << " us" << endl
+         << "  cached factor : " << lTimeCached/NbCycles << " us" << endl;
+    if (fabs(lSum)>1e-6)
+    {
+      cerr << "Different factors in the benchmark" << endl;
+      return -1;
+    }
+  }
+  cout << "Cache hits " << aFactor.hits()
+       << ", misses " << aFactor.misses() << endl;
+  return 0;
+}
@@ -73,6 +73,8 @@ namespace PatternGeneratorJRL
       m_DebugFGPI = true;
       m_DebugFGPIFull = false;
       m_DebugZMP2 = false;
+      m_ReferenceTolerance = 1e-6;
+      m_ReferenceFileName = m_TestName + "TestFGPI.datref";
       m_TestProfile = 0 ;
 
       /*! Extract options and fill in members. */
@@ -556,8 +558,7 @@ namespace PatternGeneratorJRL
         }
 
         ifstream arif;
-        aFileName = m_TestName;
-        aFileName += "TestFGPI.datref";
+        aFileName = m_ReferenceFileName;
         arif.open(aFileName.c_str(),ifstream::in);
         ODEBUG("ReportRef:" << aFileName);
 
@@ -620,7 +621,7 @@ namespace PatternGeneratorJRL
           for (unsigned int i=0;i<NB_OF_FIELDS;i++)
           {
             if  (fabs(LocalInput[i]-
-                      ReferenceInput[i])>=1e-6)
+                      ReferenceInput[i])>=m_ReferenceTolerance)
             {
               finalreport = false;
               ostringstream oss;
@@ -199,6 +199,14 @@ namespace PatternGeneratorJRL
       bool m_DebugFGPI;
       bool m_DebugFGPIFull ;
 
+      /*! \brief Largest difference accepted between the
+	trajectories and the reference file. */
+      double m_ReferenceTolerance;
+
+      /*! \brief File of the reference trajectories,
+	TestName followed by TestFGPI.datref by default. */
+      std::string m_ReferenceFileName;
+
       /*! \brief Reset debug files according to flags. */
       void prepareDebugFiles();
 
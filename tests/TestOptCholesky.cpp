@@ -24,9 +24,13 @@
 /*! \file TestOptCholesky.cpp
   \brief Example to compute a cholesky decomposition using
   an optimized implementation for QP solving.
+  The batch addition and the removal of constraints are checked
+  against a decomposition from scratch, and timed for several
+  numbers of constraints.
 */
 
 #include <stdlib.h>
+#include <sys/time.h>
 
 #include <iostream>
 #include <fstream>
@@ -92,6 +96,220 @@ double CheckCholeskyDecomposition(double *A, double *L, int n)
   return distance;
 }
 
+double ElapsedTime(struct timeval &begin, struct timeval &end)
+{
+  return (double)(end.tv_sec-begin.tv_sec)*1e6 +
+    (double)(end.tv_usec-begin.tv_usec);
+}
+
+/*! Random constraint matrix of size (m,n), stored by rows in the
+  normal mode, and by columns with a leading dimension m+1 in the
+  Fortran mode as done by PLDPSolver. */
+double * RandomConstraints(unsigned int m, unsigned int n, unsigned int mode)
+{
+  double * A = new double[(m+1)*n];
+  for(unsigned int i=0;i<m;i++)
+    for(unsigned int j=0;j<n;j++)
+      {
+	double v = (double)rand()/(double)RAND_MAX - 0.5;
+	if (mode==PatternGeneratorJRL::OptCholesky::MODE_NORMAL)
+	  A[i*n+j] = v;
+	else
+	  A[j*(m+1)+i] = v;
+      }
+  return A;
+}
+
+/*! Maximal difference between the lower parts of two factors. */
+double DistanceFactors(double *L1, double *L2, unsigned int n,
+		       unsigned int lda)
+{
+  double d=0.0;
+  for(unsigned int i=0;i<n;i++)
+    for(unsigned int j=0;j<=i;j++)
+      d = max(d,fabs(L1[i*lda+j]-L2[i*lda+j]));
+  return d;
+}
+
+/*! Batch addition and removal against the incremental addition. */
+int CheckBatchAndRemoval(unsigned int mode)
+{
+  unsigned int m=40, n=60;
+  double * A = RandomConstraints(m,n,mode);
+  double * L1 = new double[m*m];
+  double * L2 = new double[m*m];
+
+  PatternGeneratorJRL::OptCholesky Incremental(m,n,mode), Batch(m,n,mode);
+  Incremental.SetA(A,m);  Incremental.SetL(L1);
+  Batch.SetA(A,m);  Batch.SetL(L2);
+  Batch.SetBlockedUpdate(true);
+
+  vector<unsigned int> lFirst, lSecond;
+  for(unsigned int i=0;i<m;i++)
+    {
+      unsigned int lConstraint = (7*i)%m;
+      Incremental.AddActiveConstraint(lConstraint);
+      if (i<m/3)
+	lFirst.push_back(lConstraint);
+      else
+	lSecond.push_back(lConstraint);
+    }
+  Batch.AddActiveConstraints(lFirst);
+  Batch.AddActiveConstraints(lSecond);
+
+  int return_value=0;
+  double d = DistanceFactors(L1,L2,m,m);
+  if (d>1e-9)
+    {
+      cout << "Batch addition pb (mode " << mode << "): " << d << endl;
+      return_value=-1;
+    }
+
+  /* Remove a few constraints, and rebuild the factor on the others. */
+  Batch.RemoveActiveConstraint(lFirst[0]);
+  Batch.RemoveActiveConstraint(lSecond[5]);
+  Batch.RemoveActiveConstraint(lSecond.back());
+  if (Batch.RemoveActiveConstraint(m+3)!=-1)
+    {
+      cout << "Removal of an inactive constraint pb" << endl;
+      return_value=-1;
+    }
+
+  vector<unsigned int> lRemaining = Batch.ActiveConstraints();
+  Incremental.SetToZero();
+  for(unsigned int i=0;i<lRemaining.size();i++)
+    Incremental.AddActiveConstraint(lRemaining[i]);
+  d = DistanceFactors(L1,L2,(unsigned int)lRemaining.size(),m);
+  if ((lRemaining.size()!=m-3) || (d>1e-9))
+    {
+      cout << "Removal pb (mode " << mode << "): " << d << endl;
+      return_value=-1;
+    }
+
+  delete [] L2;
+  delete [] L1;
+  delete [] A;
+  return return_value;
+}
+
+/*! A list whose first constraint depends on the active ones
+  is reported as a failure, with the blocked update or not. */
+int CheckFailure(unsigned int mode, bool BlockedUpdate)
+{
+  unsigned int m=10, n=20;
+  double * A = RandomConstraints(m,n,mode);
+  double * L = new double[m*m];
+  /* The constraint 3 is null. */
+  for(unsigned int j=0;j<n;j++)
+    {
+      if (mode==PatternGeneratorJRL::OptCholesky::MODE_NORMAL)
+	A[3*n+j] = 0.0;
+      else
+	A[j*(m+1)+3] = 0.0;
+    }
+
+  PatternGeneratorJRL::OptCholesky anOptCholesky(m,n,mode);
+  anOptCholesky.SetA(A,m);
+  anOptCholesky.SetL(L);
+  anOptCholesky.SetBlockedUpdate(BlockedUpdate);
+
+  int return_value=0;
+  vector<unsigned int> lConstraints;
+  lConstraints.push_back(3);
+  lConstraints.push_back(1);
+  int r = anOptCholesky.AddActiveConstraints(lConstraints);
+  if (r!=-1)
+    {
+      cout << "First constraint failure pb (mode " << mode
+	   << ", blocked " << BlockedUpdate << "): " << r << endl;
+      return_value=-1;
+    }
+
+  anOptCholesky.SetToZero();
+  lConstraints[0] = 0;
+  lConstraints.push_back(3);
+  r = anOptCholesky.AddActiveConstraints(lConstraints);
+  if (r!=-3)
+    {
+      cout << "Third constraint failure pb (mode " << mode
+	   << ", blocked " << BlockedUpdate << "): " << r << endl;
+      return_value=-1;
+    }
+
+  delete [] L;
+  delete [] A;
+  return return_value;
+}
+
+/*! Time the update strategies for several numbers of constraints. */
+void Benchmark(unsigned int mode)
+{
+  unsigned int n=320, NbOfTrials=200;
+  unsigned int lSizes[5] = {10, 20, 40, 80, 160};
+
+  cout << (mode==PatternGeneratorJRL::OptCholesky::MODE_NORMAL ?
+	   "Normal" : "Fortran")
+       << " layout, |u|=" << n << ", times in us" << endl
+       << "constraints incremental batch rebuild-1 remove-1" << endl;
+
+  for(unsigned int ls=0;ls<5;ls++)
+    {
+      unsigned int m=lSizes[ls];
+      double * A = RandomConstraints(m,n,mode);
+      double * L = new double[m*m];
+      PatternGeneratorJRL::OptCholesky anOptCholesky(m,n,mode);
+      anOptCholesky.SetA(A,m);
+      anOptCholesky.SetL(L);
+
+      vector<unsigned int> lAll, lAllButOne;
+      for(unsigned int i=0;i<m;i++)
+	{
+	  lAll.push_back(i);
+	  if (i!=m/2)
+	    lAllButOne.push_back(i);
+	}
+
+      struct timeval begin,end;
+      double lIncremental=0.0, lBatch=0.0, lRebuild=0.0, lRemove=0.0;
+      for(unsigned int lt=0;lt<NbOfTrials;lt++)
+	{
+	  anOptCholesky.SetToZero();
+	  gettimeofday(&begin,0);
+	  for(unsigned int i=0;i<m;i++)
+	    anOptCholesky.AddActiveConstraint(i);
+	  gettimeofday(&end,0);
+	  lIncremental += ElapsedTime(begin,end);
+
+	  anOptCholesky.SetToZero();
+	  anOptCholesky.SetBlockedUpdate(true);
+	  gettimeofday(&begin,0);
+	  anOptCholesky.AddActiveConstraints(lAll);
+	  gettimeofday(&end,0);
+	  anOptCholesky.SetBlockedUpdate(false);
+	  lBatch += ElapsedTime(begin,end);
+
+	  /* Dropping the constraint in the middle of the active set. */
+	  gettimeofday(&begin,0);
+	  anOptCholesky.RemoveActiveConstraint(m/2);
+	  gettimeofday(&end,0);
+	  lRemove += ElapsedTime(begin,end);
+
+	  anOptCholesky.SetToZero();
+	  gettimeofday(&begin,0);
+	  anOptCholesky.AddActiveConstraints(lAllButOne);
+	  gettimeofday(&end,0);
+	  lRebuild += ElapsedTime(begin,end);
+	}
+      cout << m << " " << lIncremental/NbOfTrials
+	   << " " << lBatch/NbOfTrials
+	   << " " << lRebuild/NbOfTrials
+	   << " " << lRemove/NbOfTrials << endl;
+
+      delete [] L;
+      delete [] A;
+    }
+}
+
 int main()
 {
   PatternGeneratorJRL::OptCholesky *anOptCholesky;
@@ -184,6 +402,20 @@ int main()
   delete [] L;
   delete [] A;
 
+  if ((CheckBatchAndRemoval(PatternGeneratorJRL::OptCholesky::MODE_NORMAL)<0) ||
+      (CheckBatchAndRemoval(PatternGeneratorJRL::OptCholesky::MODE_FORTRAN)<0))
+    return_value = -1;
+
+  for(unsigned int lBlocked=0;lBlocked<2;lBlocked++)
+    if ((CheckFailure(PatternGeneratorJRL::OptCholesky::MODE_NORMAL,
+		      lBlocked==1)<0) ||
+	(CheckFailure(PatternGeneratorJRL::OptCholesky::MODE_FORTRAN,
+		      lBlocked==1)<0))
+      return_value = -1;
+
+  Benchmark(PatternGeneratorJRL::OptCholesky::MODE_NORMAL);
+  Benchmark(PatternGeneratorJRL::OptCholesky::MODE_FORTRAN);
+
   if (return_value == -1){
     cout << "Failed test" << endl;
   }
@@ -0,0 +1,277 @@
+/*
+ * Copyright 2019,
+ *
+ * Olivier Stasse
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+/*! \file TestPLDPReplay.cpp
+  \brief Replay captured problems of the Dimitrov 2008 formulation
+  with PLDPSolver and PLDPSolverEigen, compare their solutions and
+  their solve time.
+
+  Usage: TestPLDPReplay [capture]
+  The capture is recorded by ZMPConstrainedQPFastFormulation with
+  ":dimitrovcapture file" during a walk, e.g. StraightWalkingDimitrov
+  in TestFootPrintPGInterface. Without argument, a straight walk is
+  generated with the same formulation and replayed.
+*/
+
+#include <math.h>
+
+#include <fstream>
+#include <iostream>
+
+#include <Eigen/Dense>
+
+#include "LatencyHistogram.hh"
+#include "Mathematics/PLDPCapture.hh"
+#include "Mathematics/PLDPSolver.hh"
+#include "Mathematics/PLDPSolverEigen.hh"
+
+using namespace std;
+using namespace PatternGeneratorJRL;
+using namespace Optimization::Solver;
+
+typedef Eigen::Matrix<double,Eigen::Dynamic,Eigen::Dynamic,
+		      Eigen::RowMajor> MatrixRowMajor;
+
+/*! Walk 12 steps straight ahead and record the problems solved by
+  PLDPSolver. The ZMP is constrained in the support foot and attracted
+  toward the middle of the feet, so that the constraints are active.
+  The matrices are built as ZMPConstrainedQPFastFormulation does. */
+int GenerateCapture(const string &aFileName)
+{
+  const unsigned int N=16, NbOfCycles=96;
+  const double T=0.1, h=0.80, g=9.81, Beta=1000.0;
+  const double StepLength=0.2, FeetDistance=0.19, StepDuration=0.8;
+  const double HalfLength=0.07, HalfWidth=0.04;
+
+  /* ZMP over the preview window: z = Px xk + Pzu U */
+  MatrixRowMajor Px(N,3), Pzu(N,N);
+  Pzu.setZero();
+  for(unsigned int i=0;i<N;i++)
+    {
+      Px(i,0) = 1.0;
+      Px(i,1) = (i+1)*T;
+      Px(i,2) = (i+1)*(i+1)*T*T*0.5-h/g;
+      for(unsigned int k=0;k<=i;k++)
+	Pzu(i,k) = (1+3*(i-k)+3*(i-k)*(i-k))*T*T*T/6.0 - T*h/g;
+    }
+
+  /* Change of variable V = LQ' U with Q = LQ LQ' */
+  Eigen::MatrixXd Q = Eigen::MatrixXd::Identity(N,N) +
+    Beta*Pzu.transpose()*Pzu;
+  Eigen::MatrixXd LQ = Q.llt().matrixL();
+  MatrixRowMajor iLQ = LQ.inverse();
+  MatrixRowMajor Pu = iLQ*Pzu.transpose();
+  MatrixRowMajor iPu = Pu.inverse();
+  MatrixRowMajor iLQ2 = MatrixRowMajor::Zero(2*N,2*N);
+  iLQ2.topLeftCorner(N,N) = iLQ;
+  iLQ2.bottomRightCorner(N,N) = iLQ;
+
+  PLDPCapture aCapture;
+  if (aCapture.Open(aFileName,N,iPu.data(),Px.data(),
+		    Pu.data(),iLQ2.data())<0)
+    return -1;
+
+  PLDPSolver aSolver(N,iPu.data(),Px.data(),Pu.data(),iLQ2.data());
+  aSolver.SetLimitedComputationTime(false,0.0);
+
+  unsigned int m=4*N;
+  vector<double> D(2*N), A((m+1)*2*N,0.0), b(m), ZMPRef(2*N), X(2*N);
+  vector<int> SimilarConstraints(8*N,0);
+  double XkYk[6] = {0.0,0.0,0.0,0.0,0.0,0.0};
+
+  Eigen::Matrix3d Ad;
+  Ad << 1.0, T, T*T/2, 0.0, 1.0, T, 0.0, 0.0, 1.0;
+  Eigen::Vector3d Bd(T*T*T/6, T*T/2, T);
+
+  for(unsigned int lCycle=0;lCycle<NbOfCycles;lCycle++)
+    {
+      double StartingTime = lCycle*T;
+      Eigen::Map<Eigen::Vector3d> xk(XkYk), yk(XkYk+3);
+
+      for(unsigned int i=0;i<N;i++)
+	{
+	  double ltime = StartingTime + i*T;
+	  unsigned int lStep = (unsigned int)floor(ltime/StepDuration+1e-9);
+	  double cx = StepLength*lStep;
+	  double cy = (lStep%2==0 ? -0.5 : 0.5)*FeetDistance;
+	  double dy = HalfWidth;
+	  /* The first step is a double support phase. */
+	  if (lStep==0)
+	    {
+	      cy = 0.0;
+	      dy = 0.5*FeetDistance+HalfWidth;
+	    }
+	  ZMPRef[i] = cx;
+	  ZMPRef[i+N] = cy;
+
+	  /* x <= cx+dx, y <= cy+dy, x >= cx-dx, y >= cy-dy */
+	  double lBounds[4] = {cx+HalfLength, cy+dy,
+			       cx-HalfLength, cy-dy};
+	  for(unsigned int j=0;j<4;j++)
+	    {
+	      unsigned int c = 4*i+j;
+	      double lSign = (j<2 ? -1.0 : 1.0);
+	      unsigned int lAxis = j%2;
+	      double lPxX = Px.row(i).dot(lAxis==0 ? xk : yk);
+	      b[c] = lSign*(lPxX - lBounds[j]);
+	      for(unsigned int k=0;k<2*N;k++)
+		A[c+k*(m+1)] = 0.0;
+	      for(unsigned int k=0;k<N;k++)
+		A[c+(k+lAxis*N)*(m+1)] = lSign*Pu(k,i);
+	      SimilarConstraints[c] = (j<2 ? 0 : -2);
+	    }
+	}
+
+      /* The ZMP is attracted toward the line between the feet. */
+      for(unsigned int lAxis=0;lAxis<2;lAxis++)
+	{
+	  Eigen::VectorXd lTarget(N);
+	  for(unsigned int i=0;i<N;i++)
+	    lTarget(i) = (lAxis==0 ?
+			  StepLength*(StartingTime+(i+1)*T)/StepDuration :
+			  0.4*ZMPRef[i+N]);
+	  Eigen::VectorXd p = Beta*Pzu.transpose()*
+	    (Px*(lAxis==0 ? xk : yk) - lTarget);
+	  Eigen::Map<Eigen::VectorXd>(&D[lAxis*N],N) = iLQ*p;
+	}
+
+      if (aSolver.SolveProblem(&D[0],m,&A[0],&b[0],&ZMPRef[0],XkYk,&X[0],
+			       SimilarConstraints,
+			       (lCycle==0 ? 0 : 4),(lCycle==0))<0)
+	return -1;
+      aCapture.Record(StartingTime,&D[0],m,&A[0],&b[0],&ZMPRef[0],XkYk,
+		      SimilarConstraints,(lCycle==0 ? 0 : 4),(lCycle==0),
+		      &X[0]);
+
+      /* Apply the first jerk: U = iLQ' V */
+      for(unsigned int lAxis=0;lAxis<2;lAxis++)
+	{
+	  Eigen::Map<Eigen::VectorXd> V(&X[lAxis*N],N);
+	  double u = iLQ.col(0).dot(V);
+	  Eigen::Map<Eigen::Vector3d> s(XkYk+3*lAxis);
+	  s = Ad*s + Bd*u;
+	}
+    }
+  aCapture.Close();
+  return 0;
+}
+
+void Report(const string &aName, LatencyHistogram &aHistogram)
+{
+  cout << aName << ": p50 " << aHistogram.Percentile(0.5)/1000.0
+       << " us, p99 " << aHistogram.Percentile(0.99)/1000.0
+       << " us, max " << aHistogram.Max()/1000.0 << " us" << endl;
+}
+
+int Replay(const string &aFileName)
+{
+  ifstream aStream(aFileName.c_str(),ifstream::in | ifstream::binary);
+  PLDPConstants lConstants;
+  if (!PLDPCapture::ReadConstants(aStream,lConstants))
+    {
+      cerr << "Unable to read the capture " << aFileName << endl;
+      return -1;
+    }
+
+  unsigned int N = lConstants.CardU;
+  PLDPSolver aReference(N,&lConstants.iPu[0],&lConstants.Px[0],
+			&lConstants.Pu[0],&lConstants.iLQ[0]);
+  PLDPSolverEigen aSolver(N,&lConstants.iPu[0],&lConstants.Px[0],
+			  &lConstants.Pu[0],&lConstants.iLQ[0]);
+  aReference.SetLimitedComputationTime(false,0.0);
+  aSolver.SetLimitedComputationTime(false,0.0);
+
+  LatencyHistogram lReferenceTime, lSolverTime;
+  vector<double> X1(2*N), X2(2*N);
+  double lMaxDelta=0.0, lMaxDeltaCapture=0.0;
+  unsigned int lNbOfProblems=0, lNbOfIterations=0;
+
+  PLDPProblem aPb;
+  while(PLDPCapture::ReadProblem(aStream,N,aPb))
+    {
+      unsigned long long lStart = MonotonicTime();
+      int r1 = aReference.SolveProblem(&aPb.CstPartOfTheCostFunction[0],
+				       aPb.NbOfConstraints,
+				       &aPb.LinearPartOfConstraints[0],
+				       &aPb.CstPartOfConstraints[0],
+				       &aPb.ZMPRef[0],&aPb.XkYk[0],&X1[0],
+				       aPb.SimilarConstraints,
+				       aPb.NumberOfRemovedConstraints,
+				       aPb.StartingSequence);
+      unsigned long long lMiddle = MonotonicTime();
+      int r2 = aSolver.SolveProblem(&aPb.CstPartOfTheCostFunction[0],
+				    aPb.NbOfConstraints,
+				    &aPb.LinearPartOfConstraints[0],
+				    &aPb.CstPartOfConstraints[0],
+				    &aPb.ZMPRef[0],&aPb.XkYk[0],&X2[0],
+				    aPb.SimilarConstraints,
+				    aPb.NumberOfRemovedConstraints,
+				    aPb.StartingSequence);
+      unsigned long long lEnd = MonotonicTime();
+      if ((r1<0) || (r2<0))
+	{
+	  cerr << "Failure at time " << aPb.Time << endl;
+	  return -1;
+	}
+      lReferenceTime.Record(lMiddle-lStart);
+      lSolverTime.Record(lEnd-lMiddle);
+      lNbOfIterations += aSolver.NbOfIterations();
+
+      for(unsigned int i=0;i<2*N;i++)
+	{
+	  lMaxDelta = max(lMaxDelta,fabs(X1[i]-X2[i]));
+	  lMaxDeltaCapture = max(lMaxDeltaCapture,fabs(aPb.X[i]-X2[i]));
+	}
+      lNbOfProblems++;
+    }
+
+  cout << lNbOfProblems << " problems, "
+       << (double)lNbOfIterations/max(lNbOfProblems,1u)
+       << " iterations per problem" << endl;
+  Report("PLDPSolver     ",lReferenceTime);
+  Report("PLDPSolverEigen",lSolverTime);
+  cout << "Largest difference between the solvers: " << lMaxDelta << endl
+       << "Largest difference with the capture: " << lMaxDeltaCapture
+       << endl;
+
+  if ((lNbOfProblems==0) || (lMaxDelta>1e-6))
+    return -1;
+  return 0;
+}
+
+int main(int argc, char *argv[])
+{
+  string aFileName;
+  if (argc>1)
+    aFileName = argv[1];
+  else
+    {
+      aFileName = "TestPLDPReplay.capture";
+      if (GenerateCapture(aFileName)<0)
+	{
+	  cerr << "Unable to generate the capture" << endl;
+	  return -1;
+	}
+    }
+  return Replay(aFileName);
+}
@@ -0,0 +1,156 @@
+/*
+ * Copyright 2019,
+ *
+ * Olivier Stasse
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+/*! \file TestPreviewGainScheduling.cpp
+  \brief Compare the preview control with gains interpolated on a grid
+  of CoM heights to the one solving the Riccati equation for each height,
+  while the height of the CoM changes at each sample.
+*/
+
+#include <math.h>
+#include <sys/time.h>
+
+#include <deque>
+#include <iostream>
+
+#include <SimplePluginManager.hh>
+#include <PreviewControl/PreviewControl.hh>
+#include <PreviewControl/PreviewGainsCache.hh>
+
+using namespace std;
+using namespace PatternGeneratorJRL;
+
+double ElapsedTime(struct timeval &begin, struct timeval &end)
+{
+  return (double)(end.tv_sec-begin.tv_sec)*1e6 +
+    (double)(end.tv_usec-begin.tv_usec);
+}
+
+/*! Height of the CoM going down and up again, as when stepping
+  over an obstacle. */
+double CoMHeight(unsigned int i)
+{
+  return 0.78 - 0.06*sin(M_PI*i/400.0)*sin(M_PI*i/400.0);
+}
+
+/*! Preview along a ZMP reference going sideways and forward,
+  the height of the CoM being updated at each sample.
+  Returns the time spent updating the gains per sample. */
+double Run(PreviewControl & aPC, bool Solve,
+           vector<double> & Trajectory)
+{
+  deque<double> ZMP(1200,0.0);
+  for(unsigned int i=0;i<ZMP.size();i++)
+    ZMP[i] = 0.05*floor(i/160.0) + 0.02*sin(M_PI*i/80.0);
+
+  Eigen::MatrixXd x(3,1);
+  x.setZero();
+  double sxzmp = 0.0, zmpx2 = 0.0, lTime = 0.0;
+  struct timeval begin,end;
+  Trajectory.clear();
+  for(unsigned int i=0;i<800;i++)
+  {
+    gettimeofday(&begin,0);
+    aPC.SetHeightOfCoM(CoMHeight(i));
+    if (Solve)
+      aPC.ComputeOptimalWeights(OptimalControllerSolver::MODE_WITH_INITIALPOS);
+    gettimeofday(&end,0);
+    lTime += ElapsedTime(begin,end);
+
+    aPC.OneIterationOfPreview1D(x,sxzmp,ZMP,i,zmpx2,false);
+    Trajectory.push_back(x(0,0));
+  }
+  return lTime/800;
+}
+
+double LargestDifference(const vector<double> & A, const vector<double> & B)
+{
+  double r = 0.0;
+  for(unsigned int i=0;i<A.size();i++)
+    r = max(r,fabs(A[i]-B[i]));
+  return r;
+}
+
+int main()
+{
+  SimplePluginManager aSPM;
+  PreviewControl aPC(&aSPM);
+  aPC.SetSamplingPeriod(0.005);
+  aPC.SetPreviewControlTime(1.6);
+  aPC.SetHeightOfCoM(0.78);
+
+  // Each height differs, so the cache of the gains does not help.
+  vector<double> Solved;
+  double lTimeSolved = Run(aPC,true,Solved);
+  PreviewGainsCache::Instance().Clear();
+
+  int r = 0;
+  unsigned int NbOfHeights[3] = { 4, 8, 16 };
+  for(unsigned int k=0;k<3;k++)
+  {
+    struct timeval begin,end;
+    gettimeofday(&begin,0);
+    if (!aPC.ScheduleGains(0.70,0.80,NbOfHeights[k],
+                           OptimalControllerSolver::MODE_WITH_INITIALPOS))
+    {
+      cerr << "Unable to schedule the gains" << endl;
+      return -1;
+    }
+    gettimeofday(&end,0);
+
+    vector<double> Interpolated;
+    double lTimeInterpolated = Run(aPC,false,Interpolated);
+    double lDiff = LargestDifference(Solved,Interpolated);
+    cout << NbOfHeights[k] << " heights: "
+         << ElapsedTime(begin,end) << " us to schedule, "
+         << lTimeInterpolated << " us per sample instead of "
+         << lTimeSolved << " us, largest CoM difference "
+         << lDiff << " m" << endl;
+    if ((NbOfHeights[k]==16) && (lDiff>1e-4))
+    {
+      cerr << "Interpolated gains too far from the solved ones" << endl;
+      r = -1;
+    }
+  }
+
+  // Outside the grid, the gains are solved again.
+  vector<double> Trajectory;
+  aPC.SetHeightOfCoM(0.9);
+  if (!aPC.IsCoherent())
+  {
+    aPC.ComputeOptimalWeights(OptimalControllerSolver::MODE_WITH_INITIALPOS);
+    aPC.StopGainScheduling();
+    Run(aPC,true,Trajectory);
+    if (LargestDifference(Solved,Trajectory)!=0.0)
+    {
+      cerr << "Different gains after the scheduling" << endl;
+      r = -1;
+    }
+  }
+  else
+  {
+    cerr << "Gains interpolated outside the grid" << endl;
+    r = -1;
+  }
+  return r;
+}
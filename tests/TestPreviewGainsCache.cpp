@@ -0,0 +1,221 @@
+/*
+ * Copyright 2019,
+ *
+ * Olivier Stasse
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+/*! \file TestPreviewGainsCache.cpp
+  \brief Check that the preview control gives the same results with
+  cached gains, read from memory or from disk, and compare the time
+  spent to get them. Check also that the gains are written by Flush()
+  only, and that the memory holds at most Capacity() keys.
+*/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/time.h>
+
+#include <deque>
+#include <fstream>
+#include <iostream>
+
+#include <SimplePluginManager.hh>
+#include <PreviewControl/PreviewControl.hh>
+#include <PreviewControl/PreviewGainsCache.hh>
+
+using namespace std;
+using namespace PatternGeneratorJRL;
+
+double ElapsedTime(struct timeval &begin, struct timeval &end)
+{
+  return (double)(end.tv_sec-begin.tv_sec)*1e6 +
+    (double)(end.tv_usec-begin.tv_usec);
+}
+
+const unsigned int NB_OF_HEIGHTS = 4;
+const double HEIGHTS[NB_OF_HEIGHTS] = { 0.814, 0.78, 0.75, 0.7 };
+
+/*! Compute the gains for each height, and the final CoM of a
+  preview along a ZMP step. Returns the time spent in the gains. */
+double Run(unsigned int Mode, vector<double> & Results)
+{
+  SimplePluginManager aSPM;
+  PreviewControl aPC(&aSPM);
+  aPC.SetSamplingPeriod(0.005);
+  aPC.SetPreviewControlTime(1.6);
+
+  deque<double> ZMP(1000,0.0);
+  for(unsigned int i=100;i<ZMP.size();i++)
+    ZMP[i] = 0.1;
+
+  Results.clear();
+  double lTime = 0.0;
+  struct timeval begin,end;
+  for(unsigned int lHeight=0;lHeight<NB_OF_HEIGHTS;lHeight++)
+  {
+    aPC.SetHeightOfCoM(HEIGHTS[lHeight]);
+    gettimeofday(&begin,0);
+    aPC.ComputeOptimalWeights(Mode);
+    gettimeofday(&end,0);
+    lTime += ElapsedTime(begin,end);
+
+    Eigen::MatrixXd x(3,1);
+    x.setZero();
+    double sxzmp = 0.0, zmpx2 = 0.0;
+    for(unsigned int i=0;i<500;i++)
+      aPC.OneIterationOfPreview1D(x,sxzmp,ZMP,i,zmpx2,false);
+    for(unsigned int j=0;j<3;j++)
+      Results.push_back(x(j,0));
+  }
+  return lTime/NB_OF_HEIGHTS;
+}
+
+bool SameResults(const vector<double> & A, const vector<double> & B)
+{
+  if (A.size()!=B.size())
+    return false;
+  for(unsigned int i=0;i<A.size();i++)
+    if (A[i]!=B[i])
+      return false;
+  return true;
+}
+
+int main()
+{
+  PreviewGainsCache & aCache = PreviewGainsCache::Instance();
+  char lDirectory[] = "/tmp/TestPreviewGainsCacheXXXXXX";
+  if (mkdtemp(lDirectory)==0)
+  {
+    cerr << "Unable to create a temporary directory" << endl;
+    return -1;
+  }
+
+  unsigned int Modes[2] = { OptimalControllerSolver::MODE_WITH_INITIALPOS,
+                            OptimalControllerSolver::MODE_WITHOUT_INITIALPOS };
+  int r = 0;
+  for(unsigned int lMode=0;lMode<2;lMode++)
+  {
+    vector<double> Solved, FromMemory, FromDisk, Recomputed;
+
+    aCache.SetDirectory(lDirectory);
+    aCache.Clear();
+    double lTimeSolved = Run(Modes[lMode],Solved);
+    double lTimeMemory = Run(Modes[lMode],FromMemory);
+
+    // Nothing is written until the flush.
+    PreviewGainsKey aKey(0.005,HEIGHTS[0],1.0,1e-5,320,
+                         OptimalControllerSolver::MODE_WITH_INITIALPOS);
+    if (Modes[lMode]==OptimalControllerSolver::MODE_WITHOUT_INITIALPOS)
+      aKey = PreviewGainsKey(0.005,HEIGHTS[0],1.0,1e-6,320,
+                             OptimalControllerSolver::MODE_WITHOUT_INITIALPOS);
+    string lFileName = PreviewGainsCache::FileName(lDirectory,aKey);
+    if (ifstream(lFileName.c_str()).is_open())
+    {
+      cerr << "The gains have been written by Insert" << endl;
+      r = -1;
+    }
+    if (aCache.Flush()!=0)
+    {
+      cerr << "Unable to write the gains in " << lDirectory << endl;
+      r = -1;
+    }
+
+    // Same as a new process.
+    aCache.Clear();
+    double lTimeDisk = Run(Modes[lMode],FromDisk);
+
+    cout << "Mode " << Modes[lMode] << ": "
+         << lTimeSolved << " us solved, "
+         << lTimeMemory << " us from memory, "
+         << lTimeDisk << " us from disk" << endl;
+
+    if (!SameResults(Solved,FromMemory) || !SameResults(Solved,FromDisk))
+    {
+      cerr << "Different results with the cached gains" << endl;
+      r = -1;
+    }
+
+    // A damaged file is ignored and rewritten.
+    {
+      ofstream aFile(lFileName.c_str(),ofstream::out | ofstream::trunc);
+      aFile << "not a gain file";
+    }
+    aCache.Clear();
+    unsigned long int lNbOfMisses = aCache.NbOfMisses();
+    Run(Modes[lMode],Recomputed);
+    if (aCache.NbOfMisses()!=lNbOfMisses+1)
+    {
+      cerr << "The damaged file " << lFileName << " has been used" << endl;
+      r = -1;
+    }
+    if (!SameResults(Solved,Recomputed))
+    {
+      cerr << "Different results after a damaged file" << endl;
+      r = -1;
+    }
+    aCache.Flush();
+
+    for(unsigned int lHeight=0;lHeight<NB_OF_HEIGHTS;lHeight++)
+    {
+      aKey.Zc = HEIGHTS[lHeight];
+      remove(PreviewGainsCache::FileName(lDirectory,aKey).c_str());
+    }
+  }
+
+  // The least recently used gains are dropped beyond the capacity,
+  // and computed again when they are needed.
+  {
+    vector<double> Solved, Bounded;
+    aCache.SetDirectory("");
+    aCache.Clear();
+    Run(OptimalControllerSolver::MODE_WITH_INITIALPOS,Solved);
+    aCache.SetCapacity(2);
+    if (aCache.NbOfEntries()!=2)
+    {
+      cerr << aCache.NbOfEntries() << " gains kept for a capacity of 2"
+           << endl;
+      r = -1;
+    }
+    unsigned long int lNbOfMisses = aCache.NbOfMisses();
+    Run(OptimalControllerSolver::MODE_WITH_INITIALPOS,Bounded);
+    if ((aCache.NbOfEntries()>2) ||
+        (aCache.NbOfMisses()!=lNbOfMisses+NB_OF_HEIGHTS))
+    {
+      cerr << "The capacity is not respected" << endl;
+      r = -1;
+    }
+    if (!SameResults(Solved,Bounded))
+    {
+      cerr << "Different results with a bounded cache" << endl;
+      r = -1;
+    }
+    aCache.SetCapacity(64);
+  }
+
+  cout << aCache.NbOfMemoryHits() << " memory hits, "
+       << aCache.NbOfDiskHits() << " disk hits, "
+       << aCache.NbOfMisses() << " misses" << endl;
+
+  rmdir(lDirectory);
+  aCache.SetDirectory("");
+  return r;
+}
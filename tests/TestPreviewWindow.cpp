@@ -0,0 +1,186 @@
+/*
+ * Copyright 2019,
+ *
+ * Olivier Stasse
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+/*! \file TestPreviewWindow.cpp
+  \brief Check the contiguous preview window of PreviewControl against
+  the scalar preview loop, and compare their timings on the pattern of
+  DynamicFilter::OptimalControl.
+*/
+
+#include <math.h>
+#include <sys/time.h>
+
+#include <deque>
+#include <iostream>
+
+#include <SimplePluginManager.hh>
+#include <PreviewControl/PreviewControl.hh>
+
+using namespace std;
+using namespace PatternGeneratorJRL;
+
+double ElapsedTime(struct timeval &begin, struct timeval &end)
+{
+  return (double)(end.tv_sec-begin.tv_sec)*1e6 +
+    (double)(end.tv_usec-begin.tv_usec);
+}
+
+/*! ZMP reference of a walk: steps of 0.8 s alternating
+  between the feet, with a double support of 0.1 s. */
+void ZMPReference(double T, unsigned int NbOfSamples,
+                  RingBuffer<ZMPPosition> & ZMPPositions)
+{
+  ZMPPosition aZMP;
+  aZMP.pz = aZMP.theta = aZMP.stepType = aZMP.time = 0.0;
+  ZMPPositions.clear();
+  for(unsigned int i=0;i<NbOfSamples;i++)
+  {
+    double t = i*T;
+    int lStep = (int)floor(t/0.8);
+    double lPhase = t - 0.8*lStep;
+    double lRatio = lPhase<0.1 ? lPhase/0.1 : 1.0;
+    aZMP.px = 0.2*(lStep-1+lRatio);
+    aZMP.py = (lStep%2==0 ? 1.0 : -1.0)*0.095*(2.0*lRatio-1.0);
+    ZMPPositions.push_back(aZMP);
+  }
+}
+
+double LargestDifference(RingBuffer<COMState> & A,
+                         RingBuffer<COMState> & B)
+{
+  double r=0.0;
+  for(unsigned int i=0;i<A.size();i++)
+    for(unsigned int j=0;j<3;j++)
+    {
+      r = max(r,fabs(A[i].x[j]-B[i].x[j]));
+      r = max(r,fabs(A[i].y[j]-B[i].y[j]));
+    }
+  return r;
+}
+
+int main()
+{
+  SimplePluginManager aSPM;
+  PreviewControl aPC(&aSPM);
+  // Preview of 1.6 s at 5 ms, filtering of 0.1 s as in DynamicFilter.
+  double T=0.005;
+  aPC.SetSamplingPeriod(T);
+  aPC.SetPreviewControlTime(1.6);
+  aPC.SetHeightOfCoM(0.814);
+  aPC.ComputeOptimalWeights(OptimalControllerSolver::MODE_WITH_INITIALPOS);
+
+  unsigned int N = aPC.SizeOfPreviewWindow(), Nctrl = 20;
+  unsigned int NbOfCycles = 500;
+
+  RingBuffer<ZMPPosition> ZMPPositions;
+  ZMPReference(T,NbOfCycles+Nctrl+N,ZMPPositions);
+  deque<double> ZMPx, ZMPy;
+  for(unsigned int i=0;i<ZMPPositions.size();i++)
+  {
+    ZMPx.push_back(ZMPPositions[i].px);
+    ZMPy.push_back(ZMPPositions[i].py);
+  }
+
+  COMState aCOMState;
+  RingBuffer<COMState> Reference, RingBufferStates, BatchStates;
+  Reference.resize(NbOfCycles*Nctrl,aCOMState);
+  RingBufferStates.resize(NbOfCycles*Nctrl,aCOMState);
+  BatchStates.resize(NbOfCycles*Nctrl,aCOMState);
+
+  Eigen::MatrixXd x(3,1), y(3,1);
+  double sxzmp, syzmp, zmpx2, zmpy2;
+  struct timeval begin,end;
+
+  // Scalar loops along each axis.
+  x.setZero(); y.setZero(); sxzmp = syzmp = 0.0;
+  gettimeofday(&begin,0);
+  for(unsigned int lCycle=0;lCycle<NbOfCycles;lCycle++)
+    for(unsigned int i=0;i<Nctrl;i++)
+    {
+      aPC.OneIterationOfPreview1D(x,sxzmp,ZMPx,lCycle+i,zmpx2,false);
+      aPC.OneIterationOfPreview1D(y,syzmp,ZMPy,lCycle+i,zmpy2,false);
+      COMState & aState = Reference[lCycle*Nctrl+i];
+      for(unsigned int j=0;j<3;j++)
+      {
+        aState.x[j] = x(j,0);
+        aState.y[j] = y(j,0);
+      }
+    }
+  gettimeofday(&end,0);
+  double lTimeScalar = ElapsedTime(begin,end);
+
+  // Ring buffer adapter, one call per sample.
+  x.setZero(); y.setZero(); sxzmp = syzmp = 0.0;
+  gettimeofday(&begin,0);
+  for(unsigned int lCycle=0;lCycle<NbOfCycles;lCycle++)
+    for(unsigned int i=0;i<Nctrl;i++)
+    {
+      aPC.OneIterationOfPreview(x,y,sxzmp,syzmp,ZMPPositions,lCycle+i,
+                                zmpx2,zmpy2,false);
+      COMState & aState = RingBufferStates[lCycle*Nctrl+i];
+      for(unsigned int j=0;j<3;j++)
+      {
+        aState.x[j] = x(j,0);
+        aState.y[j] = y(j,0);
+      }
+    }
+  gettimeofday(&end,0);
+  double lTimeRingBuffer = ElapsedTime(begin,end);
+
+  // Window filled once per cycle, Nctrl samples in one call.
+  x.setZero(); y.setZero(); sxzmp = syzmp = 0.0;
+  PreviewControl::PreviewWindow aWindow;
+  RingBuffer<COMState> COMStates;
+  COMStates.resize(Nctrl,aCOMState);
+  gettimeofday(&begin,0);
+  for(unsigned int lCycle=0;lCycle<NbOfCycles;lCycle++)
+  {
+    PreviewControl::FillPreviewWindow(ZMPPositions,lCycle,Nctrl-1+N,aWindow);
+    aPC.IterationsOfPreview(x,y,sxzmp,syzmp,aWindow,0,Nctrl,COMStates,
+                            zmpx2,zmpy2,false);
+    for(unsigned int i=0;i<Nctrl;i++)
+      BatchStates[lCycle*Nctrl+i] = COMStates[i];
+  }
+  gettimeofday(&end,0);
+  double lTimeBatch = ElapsedTime(begin,end);
+
+  unsigned int NbOfSamples = NbOfCycles*Nctrl;
+  cout << "Scalar loops : " << lTimeScalar/NbOfSamples
+       << " us per sample" << endl;
+  cout << "Ring buffer  : " << lTimeRingBuffer/NbOfSamples
+       << " us per sample" << endl;
+  cout << "Window       : " << lTimeBatch/NbOfSamples
+       << " us per sample" << endl;
+
+  double lDiffRingBuffer = LargestDifference(Reference,RingBufferStates);
+  double lDiffBatch = LargestDifference(Reference,BatchStates);
+  cout << "Largest differences: " << lDiffRingBuffer << " "
+       << lDiffBatch << endl;
+
+  if ((lDiffRingBuffer>1e-9) || (lDiffBatch>1e-9))
+  {
+    cerr << "The preview window differs from the scalar loops" << endl;
+    return -1;
+  }
+  return 0;
+}
@@ -0,0 +1,166 @@
+/*
+ * Copyright 2019,
+ *
+ * Olivier Stasse
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+/*! \file TestQPRace.cpp
+  \brief Race QLD and the active-set solver on a sequence of problems
+  with changes of support, and compare the winner with QLD alone.
+  QLD takes part in the race, so the latency of the race is bounded
+  by the one of QLD when each solver has a core.
+*/
+
+#include <stdlib.h>
+#include <math.h>
+#include <sys/time.h>
+
+#include <iostream>
+#include <vector>
+
+#include <Eigen/Dense>
+#include <boost/thread/thread.hpp>
+
+#include "Mathematics/qld.hh"
+#include "Mathematics/qp-race.hh"
+
+using namespace std;
+using namespace PatternGeneratorJRL;
+
+double ElapsedTime(struct timeval &begin, struct timeval &end)
+{
+  return (double)(end.tv_sec-begin.tv_sec)*1e6 +
+    (double)(end.tv_usec-begin.tv_usec);
+}
+
+int SolveQLD(int n, int m, Eigen::MatrixXd & Q, Eigen::VectorXd & D,
+             Eigen::MatrixXd & DU, Eigen::VectorXd & DS,
+             Eigen::VectorXd & XL, Eigen::VectorXd & XU,
+             Eigen::VectorXd & x)
+{
+  int me = 0, mmax = m+1, nmax = n;
+  int mnn = m+2*n, iout = 0, ifail = 0, iprint = 0;
+  int lwar = 3*n*n/2+10*n+2*mmax+20000, liwar = n;
+  double eps = 1e-8;
+  vector<double> war(lwar), u(mnn), lDU(mmax*n,0.0), lDS(mmax,0.0);
+  vector<int> iwar(liwar);
+  for(int j=0;j<n;j++)
+    for(int i=0;i<m;i++)
+      lDU[i+mmax*j] = DU(i,j);
+  for(int i=0;i<m;i++)
+    lDS[i] = DS(i);
+  iwar[0] = 1;
+  x.resize(n);
+  ql0001_(&m, &me, &mmax, &n, &nmax, &mnn,
+          Q.data(), D.data(), &lDU[0], &lDS[0], XL.data(), XU.data(),
+          x.data(), &u[0], &iout, &ifail, &iprint,
+          &war[0], &lwar, &iwar[0], &liwar, &eps);
+  return ifail;
+}
+
+int main()
+{
+  // Slowly drifting problems, with a jump of the constraints every
+  // 40 problems as at a change of support.
+  const int n=60, m=120;
+  const unsigned int NbOfProblems=400;
+  srand(0);
+  Eigen::MatrixXd R = Eigen::MatrixXd::Random(n,n);
+  Eigen::MatrixXd Q = R.transpose()*R + 1e-2*Eigen::MatrixXd::Identity(n,n);
+  Eigen::MatrixXd DU = Eigen::MatrixXd::Random(m,n);
+  Eigen::VectorXd D0 = Eigen::VectorXd::Random(n);
+  Eigen::VectorXd D1 = Eigen::VectorXd::Random(n);
+  Eigen::VectorXd XL = Eigen::VectorXd::Constant(n,-2.0);
+  Eigen::VectorXd XU = Eigen::VectorXd::Constant(n,2.0);
+  Eigen::VectorXd D(n), DS(m), xQLD, xRace(n);
+  vector<double> U(m+2*n);
+
+  QPRace aRace;
+  aRace.start();
+  aRace.reserve(n,m);
+  struct timeval begin,end;
+  double lTimeQLD=0.0, lTimeRace=0.0, lMaxTimeQLD=0.0, lMaxTimeRace=0.0;
+  double lMaxDelta=0.0;
+  for(unsigned int k=0;k<NbOfProblems;k++)
+  {
+    double t = 0.005*k;
+    D = 10.0*(cos(t)*D0 + sin(t)*D1);
+    unsigned int lSupport = k/40;
+    for(int i=0;i<m;i++)
+      DS(i) = 1.0+0.2*sin(t+0.1*i)+0.5*((i+lSupport)%3==0 ? -1.0 : 0.0);
+
+    gettimeofday(&begin,0);
+    int FailQLD = SolveQLD(n,m,Q,D,DU,DS,XL,XU,xQLD);
+    gettimeofday(&end,0);
+    double lTime = ElapsedTime(begin,end);
+    lTimeQLD += lTime;
+    lMaxTimeQLD = max(lMaxTimeQLD,lTime);
+
+    gettimeofday(&begin,0);
+    int Fail = aRace.solve(n,m,0,Q.data(),D.data(),DU.data(),m,DS.data(),
+                           XL.data(),XU.data(),xRace.data(),&U[0]);
+    gettimeofday(&end,0);
+    lTime = ElapsedTime(begin,end);
+    lTimeRace += lTime;
+    lMaxTimeRace = max(lMaxTimeRace,lTime);
+
+    if ((FailQLD!=0) || (Fail!=0))
+    {
+      cerr << "Problem " << k << ": failure " << FailQLD
+           << " (QLD) " << Fail << " (race)" << endl;
+      return -1;
+    }
+    lMaxDelta = max(lMaxDelta,(xQLD-xRace).norm()/(1.0+xQLD.norm()));
+  }
+
+  cout << "QLD : " << lTimeQLD/NbOfProblems << " us, max "
+       << lMaxTimeQLD << " us" << endl;
+  cout << "Race: " << lTimeRace/NbOfProblems << " us, max "
+       << lMaxTimeRace << " us" << endl;
+  for(unsigned int i=0;i<QPRace::NB_OF_BACKENDS;i++)
+    cout << "  won by " << QPRace::name((QPRace::backend_e)i) << ": "
+         << aRace.NbOfWins((QPRace::backend_e)i) << endl;
+  cout << "  solvers left out while busy: " << aRace.NbOfSkips() << endl;
+  cout << "Largest difference with QLD: " << lMaxDelta << endl;
+
+  // Every race has a winner, even when the losers of the previous
+  // race are still running.
+  unsigned long int lNbOfRaces = aRace.NbOfFailures();
+  for(unsigned int i=0;i<QPRace::NB_OF_BACKENDS;i++)
+    lNbOfRaces += aRace.NbOfWins((QPRace::backend_e)i);
+  if ((lMaxDelta>1e-5) || (aRace.NbOfFailures()>0) ||
+      (lNbOfRaces!=NbOfProblems))
+    return -1;
+
+  // The tail latency of the race is not larger than the one of QLD.
+  // With fewer cores than solvers they share the time of a core,
+  // and the bound does not hold.
+  if (boost::thread::hardware_concurrency()<aRace.backends().size())
+  {
+    cout << "Fewer cores than solvers, latency bound not checked" << endl;
+    return 0;
+  }
+  if (lMaxTimeRace>lMaxTimeQLD)
+  {
+    cerr << "The race is slower than QLD in the worst case" << endl;
+    return -1;
+  }
+  return 0;
+}
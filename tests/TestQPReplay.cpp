@@ -0,0 +1,321 @@
+/*
+ * Copyright 2019,
+ *
+ * Olivier Stasse
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+/*! \file TestQPReplay.cpp
+  \brief Replay a capture of quadratic problems with the available
+  solvers and compare their solutions and their solve time.
+
+  Usage: TestQPReplay [capture]
+  The capture is recorded by QPCapture, e.g. by running any walking
+  test with JRL_WALKGEN_QP_CAPTURE=file in the environment. Without
+  argument, a drifting sequence of problems is generated, solved by
+  QLD and captured, then replayed.
+*/
+
+#include <math.h>
+#include <stdlib.h>
+
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#include <Eigen/Dense>
+#if defined(USE_QUADPROG) && USE_QUADPROG==1
+#include <eigen-quadprog/QuadProg.h>
+#endif
+
+#include "LatencyHistogram.hh"
+#include "QPCapture.hh"
+#include "Mathematics/qld.hh"
+#include "Mathematics/active-set-qp.hh"
+
+using namespace std;
+using namespace PatternGeneratorJRL;
+
+const unsigned int NB_OF_SOURCES=4;
+const char * SourceNames[NB_OF_SOURCES] =
+  { "QPProblem", "NMPC", "Dimitrov", "Wieber" };
+
+/*! Solve a captured problem with QLD.
+  The arrays are copied since QLD modifies the Hessian. */
+int SolveQLD(const QPCaptureProblem & P, vector<double> & X)
+{
+  int m = P.m, me = P.me, mmax = P.m+1, n = P.n, nmax = P.n;
+  int mnn = m+2*n, iout = 0, ifail = 0, iprint = 1;
+  int lwar = 2*(3*n*n/2+10*n+2*(m+1)+20000), liwar = 2*n+1000;
+  double eps = 1e-8;
+  static vector<double> war, u, Q, D, DU, DS, XL, XU;
+  static vector<int> iwar;
+  war.resize(lwar); iwar.resize(liwar); u.resize(mnn);
+  P.Hessian(Q);
+  D = P.D; DS = P.DS; XL = P.XL; XU = P.XU;
+  DS.resize(mmax,0.0);
+  DU.assign(mmax*n,0.0);
+  for(int j=0;j<n;j++)
+    for(int i=0;i<m;i++)
+      DU[i+mmax*j] = P.DU[i+m*j];
+  iwar[0] = 1;
+  X.resize(n);
+  ql0001_(&m, &me, &mmax, &n, &nmax, &mnn,
+          &Q[0], &D[0], &DU[0], &DS[0], &XL[0], &XU[0],
+          &X[0], &u[0], &iout, &ifail, &iprint,
+          &war[0], &lwar, &iwar[0], &liwar, &eps);
+  return ifail;
+}
+
+int SolveActiveSet(ActiveSetQP & aSolver, const QPCaptureProblem & P,
+                   vector<double> & X)
+{
+  static vector<double> u, Q;
+  u.resize(P.m+2*P.n);
+  P.Hessian(Q);
+  X.resize(P.n);
+  const double * DU = P.DU.empty() ? 0 : &P.DU[0];
+  const double * DS = P.DS.empty() ? 0 : &P.DS[0];
+  return aSolver.solve(P.n, P.m, P.me, &Q[0], &P.D[0],
+                       DU, P.m, DS, &P.XL[0], &P.XU[0], &X[0], &u[0]);
+}
+
+#if defined(USE_QUADPROG) && USE_QUADPROG==1
+/*! eigen-quadprog solves Aeq x = Beq, Aineq x <= Bineq:
+  the finite bounds become inequalities. */
+int SolveQuadProg(const QPCaptureProblem & P, vector<double> & X)
+{
+  int n = P.n, m = P.m, me = P.me;
+  Eigen::Map<const Eigen::MatrixXd> DU(P.DU.empty() ? 0 : &P.DU[0],m,n);
+  Eigen::Map<const Eigen::VectorXd> DS(P.DS.empty() ? 0 : &P.DS[0],m);
+  int lNbOfBounds=0;
+  for(int j=0;j<n;j++)
+  {
+    if (P.XL[j]>-ActiveSetQP::InfiniteBound) lNbOfBounds++;
+    if (P.XU[j]<ActiveSetQP::InfiniteBound) lNbOfBounds++;
+  }
+  Eigen::MatrixXd Aineq = Eigen::MatrixXd::Zero(m-me+lNbOfBounds,n);
+  Eigen::VectorXd Bineq(m-me+lNbOfBounds);
+  Aineq.topRows(m-me) = -DU.bottomRows(m-me);
+  Bineq.head(m-me) = DS.tail(m-me);
+  int k = m-me;
+  for(int j=0;j<n;j++)
+  {
+    if (P.XL[j]>-ActiveSetQP::InfiniteBound)
+    { Aineq(k,j) = -1.0; Bineq(k) = -P.XL[j]; k++; }
+    if (P.XU[j]<ActiveSetQP::InfiniteBound)
+    { Aineq(k,j) = 1.0; Bineq(k) = P.XU[j]; k++; }
+  }
+  vector<double> lQ;
+  P.Hessian(lQ);
+  Eigen::Map<Eigen::MatrixXd> Q(&lQ[0],n,n);
+  Eigen::Map<const Eigen::VectorXd> D(&P.D[0],n);
+
+  Eigen::QuadProgDense aSolver(n,me,m-me+lNbOfBounds);
+  aSolver.solve(Q,D,DU.topRows(me),-DS.head(me),Aineq,Bineq);
+  X.assign(aSolver.result().data(),aSolver.result().data()+n);
+  return aSolver.fail();
+}
+#endif
+
+/*! Receding horizon like sequence: the Hessian is constant, the
+  gradient and the constraints drift slowly, so that consecutive
+  problems share most of their active constraints.
+  Two streams are interleaved, one with a dense Hessian as QPProblem
+  records them, one with an identity Hessian as the PLDP solver
+  of the Dimitrov formulation records them. */
+int GenerateCapture(const string &aFileName)
+{
+  QPCapture & aCapture = QPCapture::Instance();
+  if (!aCapture.Start(aFileName))
+    return -1;
+
+  const int n=32, m=64, me=0;
+  srand(0);
+  Eigen::MatrixXd R = Eigen::MatrixXd::Random(n,n);
+  Eigen::MatrixXd Q = R.transpose()*R + 1e-2*Eigen::MatrixXd::Identity(n,n);
+  Eigen::MatrixXd A = Eigen::MatrixXd::Random(m,n);
+  Eigen::VectorXd D0 = Eigen::VectorXd::Random(n);
+  Eigen::VectorXd D1 = Eigen::VectorXd::Random(n);
+  Eigen::VectorXd XL = Eigen::VectorXd::Constant(n,-2.0);
+  Eigen::VectorXd XU = Eigen::VectorXd::Constant(n,2.0);
+
+  QPCaptureProblem P;
+  P.n = n; P.m = m; P.me = me; P.Fail = 0;
+  P.DU.assign(A.data(),A.data()+m*n);
+  P.XL.assign(XL.data(),XL.data()+n);
+  P.XU.assign(XU.data(),XU.data()+n);
+  P.DS.resize(m);
+  vector<double> X;
+  for(unsigned int k=0;k<400;k++)
+  {
+    double t = 0.005*k;
+    Eigen::VectorXd D = 10.0*(cos(t)*D0 + sin(t)*D1);
+    P.D.assign(D.data(),D.data()+n);
+    for(int i=0;i<m;i++)
+      P.DS[i] = (i<me) ? 0.1*sin(t+i) : 1.0+0.2*sin(t+0.1*i);
+
+    for(unsigned int s=0;s<2;s++)
+    {
+      P.IdentityHessian = (s==1);
+      P.Q.assign(Q.data(),Q.data()+n*n);
+      int lFail = SolveQLD(P,X);
+      if (lFail!=0)
+      {
+        cerr << "QLD failed at time " << t << endl;
+        aCapture.Stop();
+        return -1;
+      }
+      aCapture.Record(P.IdentityHessian ? QP_CAPTURE_DIMITROV
+                                        : QP_CAPTURE_QPPROBLEM,
+                      t, n, m, me, P.IdentityHessian ? 0 : Q.data(),
+                      &P.D[0], &P.DU[0], m, &P.DS[0],
+                      &P.XL[0], &P.XU[0], &X[0], lFail);
+    }
+  }
+  aCapture.Stop();
+  return 0;
+}
+
+/*! Statistics of one solver. */
+struct Backend
+{
+  string Name;
+  LatencyHistogram Time[NB_OF_SOURCES];
+  double MaxDelta;
+  unsigned int NbOfFailures;
+  Backend(const string & aName):
+    Name(aName), MaxDelta(0.0), NbOfFailures(0)
+  {}
+
+  void Add(const QPCaptureProblem & P, unsigned long long Duration,
+           int Fail, const vector<double> & X)
+  {
+    Time[P.Source].Record(Duration);
+    if (Fail!=0)
+    {
+      NbOfFailures++;
+      return;
+    }
+    if (P.Fail!=0)
+      return;
+    double lNorm=0.0;
+    for(int i=0;i<P.n;i++)
+      lNorm = max(lNorm,fabs(P.X[i]));
+    for(int i=0;i<P.n;i++)
+      MaxDelta = max(MaxDelta,fabs(P.X[i]-X[i])/(1.0+lNorm));
+  }
+
+  void Report() const
+  {
+    for(unsigned int s=0;s<NB_OF_SOURCES;s++)
+    {
+      if (Time[s].Count()==0)
+        continue;
+      cout << Name << " " << SourceNames[s] << ": "
+           << Time[s].Count() << " problems, p50 "
+           << Time[s].Percentile(0.5)/1000.0
+           << " us, p99 " << Time[s].Percentile(0.99)/1000.0
+           << " us, max " << Time[s].Max()/1000.0 << " us" << endl;
+    }
+    cout << Name << ": " << NbOfFailures << " failures, "
+         << "largest difference with the capture " << MaxDelta << endl;
+  }
+};
+
+int Replay(const string &aFileName)
+{
+  ifstream aStream(aFileName.c_str(),ifstream::in | ifstream::binary);
+  if (!QPCapture::ReadHeader(aStream))
+  {
+    cerr << aFileName << " is not a QP capture" << endl;
+    return -1;
+  }
+  // The problems are loaded first so that reading the file
+  // is not timed.
+  vector<QPCaptureProblem> lProblems;
+  QPCaptureProblem aProblem;
+  while(QPCapture::ReadProblem(aStream,aProblem))
+    if (aProblem.Source<NB_OF_SOURCES)
+      lProblems.push_back(aProblem);
+  cout << lProblems.size() << " problems" << endl;
+  if (lProblems.empty())
+    return -1;
+
+  Backend lQLD("QLD"), lHot("ActiveSetQP hot"), lCold("ActiveSetQP cold");
+  // The working set of a solver is reused only within the
+  // sequence of one source.
+  ActiveSetQP lHotSolvers[NB_OF_SOURCES], lColdSolver;
+#if defined(USE_QUADPROG) && USE_QUADPROG==1
+  Backend lQuadProg("QuadProg");
+#endif
+  vector<double> X;
+  for(unsigned int k=0;k<lProblems.size();k++)
+  {
+    const QPCaptureProblem & P = lProblems[k];
+    unsigned long long lStart = MonotonicTime();
+    int lFail = SolveQLD(P,X);
+    lQLD.Add(P,MonotonicTime()-lStart,lFail,X);
+
+    lStart = MonotonicTime();
+    lFail = SolveActiveSet(lHotSolvers[P.Source],P,X);
+    lHot.Add(P,MonotonicTime()-lStart,lFail,X);
+
+    lColdSolver.reset();
+    lStart = MonotonicTime();
+    lFail = SolveActiveSet(lColdSolver,P,X);
+    lCold.Add(P,MonotonicTime()-lStart,lFail,X);
+
+#if defined(USE_QUADPROG) && USE_QUADPROG==1
+    lStart = MonotonicTime();
+    lFail = SolveQuadProg(P,X);
+    lQuadProg.Add(P,MonotonicTime()-lStart,lFail,X);
+#endif
+  }
+
+  lQLD.Report();
+  lHot.Report();
+  lCold.Report();
+#if defined(USE_QUADPROG) && USE_QUADPROG==1
+  lQuadProg.Report();
+  if (lQuadProg.MaxDelta>1e-4)
+    return -1;
+#endif
+  if ((lQLD.MaxDelta>1e-6) || (lHot.MaxDelta>1e-4) ||
+      (lCold.MaxDelta>1e-4))
+    return -1;
+  return 0;
+}
+
+int main(int argc, char *argv[])
+{
+  string aFileName;
+  if (argc>1)
+    aFileName = argv[1];
+  else
+  {
+    aFileName = "TestQPReplay.capture";
+    if (GenerateCapture(aFileName)<0)
+    {
+      cerr << "Unable to generate the capture" << endl;
+      return -1;
+    }
+  }
+  return Replay(aFileName);
+}
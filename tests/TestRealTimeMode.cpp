@@ -0,0 +1,177 @@
+/*
+ * Copyright 2019,
+ *
+ * Olivier Stasse
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+/*! \file TestRealTimeMode.cpp
+  \brief Check that the control loop does not allocate in real-time
+  mode once the walk is running, with the online generators:
+  Herdt 2010 (QP) and Naveau 2015 (SQP, with eigen-quadprog).
+  The count needs the library compiled with
+  CHECK_REALTIME_ALLOCATIONS: without it the test fails.
+*/
+
+#include "Debug.hh"
+#include "CommonTools.hh"
+#include "TestObject.hh"
+#include "AllocationMonitor.hh"
+
+using namespace::PatternGeneratorJRL;
+using namespace::PatternGeneratorJRL::TestSuite;
+using namespace std;
+
+class TestRealTimeMode: public TestObject
+{
+public:
+  TestRealTimeMode(int argc, char *argv[], string &aTestName,
+                   const string & anAlgorithm):
+    TestObject(argc,argv,aTestName),
+    m_Algorithm(anAlgorithm)
+  {
+    m_DebugFGPI = false;
+    m_DebugFGPIFull = false;
+  }
+
+  bool Run()
+  {
+    PatternGeneratorInterface & aPGI = *m_PGI;
+    CommonInitialization(aPGI);
+    {
+      istringstream strm2(":SetAlgoForZmpTrajectory "+m_Algorithm);
+      aPGI.ParseCmd(strm2);
+    }
+    {
+      istringstream strm2(":singlesupporttime 0.7");
+      aPGI.ParseCmd(strm2);
+    }
+    {
+      istringstream strm2(":doublesupporttime 0.1");
+      aPGI.ParseCmd(strm2);
+    }
+    {
+      istringstream strm2(":useDynamicFilter false");
+      aPGI.ParseCmd(strm2);
+    }
+    if (m_Algorithm=="Herdt")
+    {
+      istringstream strm2(":HerdtOnline 0.2 0.0 0.0");
+      aPGI.ParseCmd(strm2);
+    }
+    else
+    {
+      {
+        istringstream strm2(":NaveauOnline");
+        aPGI.ParseCmd(strm2);
+      }
+      {
+        istringstream strm2(":setfeetconstraint XY 0.095 0.055");
+        aPGI.ParseCmd(strm2);
+      }
+      {
+        istringstream strm2(":deleteallobstacles");
+        aPGI.ParseCmd(strm2);
+      }
+      aPGI.setVelocityReference(0.2,0.0,0.0);
+    }
+
+    // The first steps are not checked: the buffers and the storage
+    // of the QP reach their sizes during the first cycles, and the
+    // number of previewed steps takes all its values.
+    if (!Walk(600))
+      return false;
+
+    {
+      istringstream strm2(":realtimemode true");
+      aPGI.ParseCmd(strm2);
+    }
+    AllocationMonitor::Reset();
+    if (!Walk(800))
+      return false;
+    {
+      istringstream strm2(":realtimemode false");
+      aPGI.ParseCmd(strm2);
+    }
+
+    cout << m_Algorithm << ": " << AllocationMonitor::NbOfAllocations()
+         << " allocations in the control loop" << endl;
+    return AllocationMonitor::NbOfAllocations()==0;
+  }
+
+protected:
+  bool Walk(unsigned int NbOfIterations)
+  {
+    for(unsigned int i=0;i<NbOfIterations;i++)
+    {
+      if (!m_PGI->RunOneStepOfTheControlLoop(m_CurrentConfiguration,
+                                             m_CurrentVelocity,
+                                             m_CurrentAcceleration,
+                                             m_OneStep.m_ZMPTarget,
+                                             m_OneStep.m_finalCOMPosition,
+                                             m_OneStep.m_LeftFootPosition,
+                                             m_OneStep.m_RightFootPosition))
+      {
+        cerr << m_Algorithm << ": the walk stopped at iteration "
+             << i << endl;
+        return false;
+      }
+    }
+    return true;
+  }
+
+  void chooseTestProfile() {}
+  void generateEvent() {}
+
+  /*! Name given to :SetAlgoForZmpTrajectory. */
+  string m_Algorithm;
+};
+
+int main(int argc, char *argv[])
+{
+  if (argc<3)
+  {
+    cerr << "Usage: " << argv[0] << " robot.urdf robot.srdf" << endl;
+    return -1;
+  }
+
+  if (!AllocationMonitor::IsHookActive())
+  {
+    cerr << "Allocations are not counted: "
+         << "compile with CHECK_REALTIME_ALLOCATIONS" << endl;
+    return -1;
+  }
+
+  vector<string> Algorithms;
+  Algorithms.push_back("Herdt");
+#if defined(USE_QUADPROG) && USE_QUADPROG==1
+  Algorithms.push_back("Naveau");
+#endif
+
+  for(unsigned int i=0;i<Algorithms.size();i++)
+  {
+    string TestName("TestRealTimeMode"+Algorithms[i]);
+    TestRealTimeMode aTestRealTimeMode(argc,argv,TestName,Algorithms[i]);
+    if (!aTestRealTimeMode.init())
+      return -1;
+    if (!aTestRealTimeMode.Run())
+      return -1;
+  }
+  return 0;
+}
@@ -0,0 +1,294 @@
+/*
+ * Copyright 2019,
+ *
+ * Olivier Stasse
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+/*! \file TestRiccatiQP.cpp
+  \brief Check the stage-wise interior-point solver against QLD on the
+  condensed form of a walking problem, and compare how both scale with
+  the length of the preview.
+*/
+
+#include <stdlib.h>
+#include <math.h>
+#include <sys/time.h>
+
+#include <iostream>
+#include <vector>
+
+#include <Eigen/Dense>
+
+#include "Mathematics/qld.hh"
+#include "Mathematics/riccati-qp.hh"
+
+using namespace std;
+using namespace PatternGeneratorJRL;
+
+double ElapsedTime(struct timeval &begin, struct timeval &end)
+{
+  return (double)(end.tv_sec-begin.tv_sec)*1e6 +
+    (double)(end.tv_usec-begin.tv_usec);
+}
+
+/*! Walking problem with the variables of the Herdt 2010 generator:
+  state (c_x, dc_x, ddc_x, c_y, dc_y, ddc_y, f_x, f_y) where f is the
+  support foot, input (dddc_x, dddc_y, p_x, p_y) where p moves the
+  support foot when a step starts. One step every 8 samples. */
+void BuildWalkingProblem(RiccatiQP & aSolver, unsigned int N)
+{
+  const double T = 0.1, hg = 0.814/9.81;
+  const unsigned int StepSamples = 8;
+  aSolver.resize(N,8,4);
+  aSolver.InitialState().setZero();
+
+  for(unsigned int k=0;k<=N;k++)
+    {
+      RiccatiQP::stage_t & aStage = aSolver.stage(k);
+      if (k<N)
+        {
+          for(unsigned int c=0;c<2;c++)
+            {
+              aStage.A(3*c,3*c+1) = T;
+              aStage.A(3*c,3*c+2) = T*T/2;
+              aStage.A(3*c+1,3*c+2) = T;
+              aStage.B(3*c,c) = T*T*T/6;
+              aStage.B(3*c+1,c) = T*T/2;
+              aStage.B(3*c+2,c) = T;
+            }
+          // Jerk weight, and regularization of the unused foot inputs.
+          aStage.R(0,0) = aStage.R(1,1) = 1e-5;
+          aStage.R(2,2) = aStage.R(3,3) = 1e-10;
+
+          bool NewStep = ((k+1)%StepSamples==0);
+          if (NewStep)
+            {
+              aStage.B(6,2) = aStage.B(7,3) = 1.0;
+              // Feasible displacements of the foot.
+              double Side = ((k+1)/StepSamples)%2 ? 1.0 : -1.0;
+              aSolver.NbInequalities(k,4);
+              aStage.D(0,2) = 1.0;  aStage.d(0) = 0.1;
+              aStage.D(1,2) = -1.0; aStage.d(1) = 0.3;
+              aStage.D(2,3) = Side;  aStage.d(2) = -0.15;
+              aStage.D(3,3) = -Side; aStage.d(3) = 0.25;
+            }
+        }
+      if (k>0)
+        {
+          // Instant velocity and CoP centering.
+          aStage.Q(1,1) = aStage.Q(4,4) = 1.0;
+          aStage.q(1) = -0.2;
+          for(unsigned int c=0;c<2;c++)
+            {
+              Eigen::VectorXd e = Eigen::VectorXd::Zero(8);
+              e(3*c) = 1.0; e(3*c+2) = -hg; e(6+c) = -1.0;
+              aStage.Q += 1e-6*e*e.transpose();
+            }
+          // CoP inside the support foot: |z-f| <= (0.09,0.05).
+          aSolver.NbInequalities(k,4);
+          for(unsigned int c=0;c<2;c++)
+            for(unsigned int side=0;side<2;side++)
+              {
+                double sgn = side ? -1.0 : 1.0;
+                unsigned int row = 2*c+side;
+                aStage.C(row,3*c) = -sgn;
+                aStage.C(row,3*c+2) = sgn*hg;
+                aStage.C(row,6+c) = sgn;
+                aStage.d(row) = c==0 ? 0.09 : 0.05;
+              }
+        }
+    }
+}
+
+/*! Condensed problem in the layout of QLD. The inputs which act
+  neither on the dynamics nor on the constraints are removed. */
+struct Condensed
+{
+  int n, m;
+  Eigen::MatrixXd Q, DU;
+  Eigen::VectorXd D, DS;
+  std::vector< std::pair<unsigned int,unsigned int> > Inputs;
+
+  void build(const RiccatiQP & aSolver)
+  {
+    unsigned int N = aSolver.NbStages();
+    unsigned int nx = (unsigned int)aSolver.stage(0).x.size();
+
+    Inputs.clear();
+    m = 0;
+    for(unsigned int k=0;k<=N;k++)
+      {
+        const RiccatiQP::stage_t & aStage = aSolver.stage(k);
+        m += (int)aStage.C.rows();
+        for(unsigned int j=0;j<aStage.u.size();j++)
+          if (aStage.B.col(j).norm()>0.0 || aStage.D.col(j).norm()>0.0)
+            Inputs.push_back(std::make_pair(k,j));
+      }
+    n = (int)Inputs.size();
+
+    Q.setZero(n,n); D.setZero(n);
+    DU.setZero(m,n); DS.setZero(m);
+
+    Eigen::MatrixXd X = Eigen::MatrixXd::Zero(nx,n), U;
+    Eigen::VectorXd c = aSolver.InitialState();
+    unsigned int lInput=0, lRow=0;
+    for(unsigned int k=0;k<=N;k++)
+      {
+        const RiccatiQP::stage_t & aStage = aSolver.stage(k);
+        U.setZero(aStage.u.size(),n);
+        while(lInput<Inputs.size() && Inputs[lInput].first==k)
+          {
+            U(Inputs[lInput].second,lInput) = 1.0;
+            lInput++;
+          }
+        Q += X.transpose()*aStage.Q*X + U.transpose()*aStage.R*U
+          + X.transpose()*aStage.S*U + U.transpose()*aStage.S.transpose()*X;
+        D += X.transpose()*(aStage.Q*c + aStage.q)
+          + U.transpose()*(aStage.S.transpose()*c + aStage.r);
+        unsigned int nc = (unsigned int)aStage.C.rows();
+        DU.middleRows(lRow,nc) = aStage.C*X + aStage.D*U;
+        DS.segment(lRow,nc) = aStage.C*c + aStage.d;
+        lRow += nc;
+        if (k<N)
+          {
+            X = aStage.A*X + aStage.B*U;
+            c = aStage.A*c + aStage.b;
+          }
+      }
+  }
+
+  int solveQLD(Eigen::VectorXd & x)
+  {
+    int lm = m, me = 0, mmax = m+1, ln = n, nmax = n;
+    int mnn = m+2*n, iout = 0, ifail = 0, iprint = 1;
+    int lwar = 2*(3*n*n/2+10*n+2*(m+1)+20000), liwar = 2*n+1000;
+    double eps = 1e-8;
+    vector<double> war(lwar), u(mnn), lQ(Q.data(),Q.data()+n*n);
+    vector<double> lDU(mmax*n,0.0);
+    vector<int> iwar(liwar);
+    Eigen::VectorXd XL = Eigen::VectorXd::Constant(n,-1e8);
+    Eigen::VectorXd XU = Eigen::VectorXd::Constant(n,1e8);
+    for(int j=0;j<n;j++)
+      for(int i=0;i<m;i++)
+        lDU[i+mmax*j] = DU(i,j);
+    iwar[0] = 1;
+    x.resize(n);
+    ql0001_(&lm, &me, &mmax, &ln, &nmax, &mnn,
+            &lQ[0], D.data(), &lDU[0], DS.data(), XL.data(), XU.data(),
+            x.data(), &u[0], &iout, &ifail, &iprint,
+            &war[0], &lwar, &iwar[0], &liwar, &eps);
+    return ifail;
+  }
+
+  /*! Set the inputs of the stages from the condensed variables. */
+  void expand(const Eigen::VectorXd & x, RiccatiQP & aSolver)
+  {
+    unsigned int N = aSolver.NbStages();
+    for(unsigned int k=0;k<N;k++)
+      aSolver.stage(k).u.setZero();
+    for(unsigned int i=0;i<Inputs.size();i++)
+      aSolver.stage(Inputs[i].first).u(Inputs[i].second) = x(i);
+  }
+};
+
+/*! Cost and largest constraint violation of the inputs
+  stored in the stages, the states are simulated. */
+void Evaluate(RiccatiQP & aSolver, double & Cost, double & Violation)
+{
+  unsigned int N = aSolver.NbStages();
+  Eigen::VectorXd x = aSolver.InitialState();
+  Cost = 0.0; Violation = 0.0;
+  for(unsigned int k=0;k<=N;k++)
+    {
+      const RiccatiQP::stage_t & aStage = aSolver.stage(k);
+      const Eigen::VectorXd & u = aStage.u;
+      Cost += 0.5*x.dot(aStage.Q*x) + x.dot(aStage.S*u)
+        + 0.5*u.dot(aStage.R*u) + aStage.q.dot(x) + aStage.r.dot(u);
+      if (aStage.C.rows()>0)
+        Violation = max(Violation,
+                        -(aStage.C*x+aStage.D*u+aStage.d).minCoeff());
+      if (k<N)
+        x = aStage.A*x + aStage.B*u + aStage.b;
+    }
+}
+
+bool CheckAgainstQLD(unsigned int N, bool Verbose, unsigned int NbOfRuns)
+{
+  RiccatiQP aSolver;
+  BuildWalkingProblem(aSolver,N);
+  Condensed aCondensed;
+  aCondensed.build(aSolver);
+
+  struct timeval begin,end;
+  double lTimeQLD = 0.0, lTimeRiccati = 0.0;
+  Eigen::VectorXd xQLD;
+  int FailQLD=0, Fail=0;
+  for(unsigned int i=0;i<NbOfRuns;i++)
+    {
+      gettimeofday(&begin,0);
+      FailQLD = aCondensed.solveQLD(xQLD);
+      gettimeofday(&end,0);
+      lTimeQLD += ElapsedTime(begin,end);
+
+      gettimeofday(&begin,0);
+      Fail = aSolver.solve();
+      gettimeofday(&end,0);
+      lTimeRiccati += ElapsedTime(begin,end);
+    }
+
+  if (Fail!=0 || FailQLD!=0)
+    {
+      cerr << "N=" << N << ": failure " << Fail
+           << " (QLD " << FailQLD << ")" << endl;
+      return false;
+    }
+
+  double lCost, lViolation, lCostQLD, lViolationQLD;
+  Evaluate(aSolver,lCost,lViolation);
+  aCondensed.expand(xQLD,aSolver);
+  Evaluate(aSolver,lCostQLD,lViolationQLD);
+
+  if (Verbose)
+    cout << "N=" << N << " (" << aCondensed.n << " condensed variables): "
+         << "QLD " << lTimeQLD/NbOfRuns << " us, Riccati "
+         << lTimeRiccati/NbOfRuns << " us, "
+         << aSolver.NbIterations() << " iterations" << endl;
+
+  if (lViolation>1e-6 ||
+      fabs(lCost-lCostQLD)>1e-6*(1.0+fabs(lCostQLD)))
+    {
+      cerr << "N=" << N << ": cost " << lCost << " instead of " << lCostQLD
+           << ", violation " << lViolation << endl;
+      return false;
+    }
+  return true;
+}
+
+int main()
+{
+  if (!CheckAgainstQLD(16,false,1))
+    return -1;
+
+  unsigned int Sizes[6] = { 16, 32, 64, 100, 150, 200 };
+  for(unsigned int i=0;i<6;i++)
+    if (!CheckAgainstQLD(Sizes[i],true,Sizes[i]<100 ? 20 : 3))
+      return -1;
+  return 0;
+}
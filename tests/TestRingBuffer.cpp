@@ -0,0 +1,179 @@
+/*
+ * Copyright 2019,
+ *
+ * Olivier Stasse
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+/*! \file TestRingBuffer.cpp
+  \brief Check RingBuffer against std::deque and compare their
+  timings on the access pattern of the on-line walking generators.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include <deque>
+#include <iostream>
+
+#include <jrl/walkgen/pgtypes.hh>
+#include "RingBuffer.hh"
+
+using namespace std;
+using namespace PatternGeneratorJRL;
+
+double ElapsedTime(struct timeval &begin, struct timeval &end)
+{
+  return (double)(end.tv_sec-begin.tv_sec)*1e6 +
+    (double)(end.tv_usec-begin.tv_usec);
+}
+
+/*! Random sequence of operations applied to both containers. */
+bool CheckAgainstDeque()
+{
+  deque<ZMPPosition> aDeque;
+  RingBuffer<ZMPPosition> aRingBuffer;
+  ZMPPosition aZMP;
+  memset(&aZMP,0,sizeof(aZMP));
+
+  srand(0);
+  for(unsigned int it=0;it<100000;it++)
+  {
+    aZMP.px = rand();
+    switch(rand()%7)
+    {
+    case 0:
+    case 1:
+      aDeque.push_back(aZMP);
+      aRingBuffer.push_back(aZMP);
+      break;
+    case 2:
+      aDeque.push_front(aZMP);
+      aRingBuffer.push_front(aZMP);
+      break;
+    case 3:
+      if (!aDeque.empty())
+      {
+        aDeque.pop_front();
+        aRingBuffer.pop_front();
+      }
+      break;
+    case 4:
+      if (!aDeque.empty())
+      {
+        aDeque.pop_back();
+        aRingBuffer.pop_back();
+      }
+      break;
+    case 5:
+      {
+        unsigned int lSize = rand()%64;
+        aDeque.resize(lSize,aZMP);
+        aRingBuffer.resize(lSize,aZMP);
+      }
+      break;
+    case 6:
+      {
+        RingBuffer<ZMPPosition> aCopy(aRingBuffer);
+        aRingBuffer = aCopy;
+      }
+      break;
+    }
+
+    if (aDeque.size()!=aRingBuffer.size())
+    {
+      cerr << "Size mismatch at iteration " << it << endl;
+      return false;
+    }
+    for(unsigned int i=0;i<aDeque.size();i++)
+      if (aDeque[i].px!=aRingBuffer[i].px)
+      {
+        cerr << "Value mismatch at iteration " << it << endl;
+        return false;
+      }
+  }
+  return true;
+}
+
+/*! Mimics one control cycle of the on-line generators:
+  the oldest sample is removed, the preview window is
+  rebuilt at the back, and the whole window is read. */
+template <typename Buffer>
+double OnLinePattern(Buffer & aBuffer,
+                     unsigned int NbOfCycles,
+                     unsigned int WindowSize,
+                     unsigned int NbOfNewSamples)
+{
+  FootAbsolutePosition aFAP;
+  memset(&aFAP,0,sizeof(aFAP));
+  aBuffer.resize(WindowSize,aFAP);
+
+  double sum=0.0;
+  for(unsigned int lCycle=0;lCycle<NbOfCycles;lCycle++)
+  {
+    aBuffer.pop_front();
+    aBuffer.resize(WindowSize-NbOfNewSamples);
+    for(unsigned int i=0;i<NbOfNewSamples;i++)
+    {
+      aFAP.x = lCycle+i;
+      aBuffer.push_back(aFAP);
+    }
+    for(unsigned int i=0;i<aBuffer.size();i++)
+      sum += aBuffer[i].x;
+  }
+  return sum;
+}
+
+int main()
+{
+  if (!CheckAgainstDeque())
+    return -1;
+
+  // Window of 1.6 s at 5 ms, one QP sample of 0.1 s added each cycle.
+  unsigned int NbOfCycles=20000, WindowSize=320, NbOfNewSamples=20;
+  struct timeval begin,end;
+
+  deque<FootAbsolutePosition> aDeque;
+  gettimeofday(&begin,0);
+  double lSumDeque = OnLinePattern(aDeque,NbOfCycles,
+                                   WindowSize,NbOfNewSamples);
+  gettimeofday(&end,0);
+  double lTimeDeque = ElapsedTime(begin,end);
+
+  RingBuffer<FootAbsolutePosition> aRingBuffer;
+  aRingBuffer.reserve(WindowSize);
+  gettimeofday(&begin,0);
+  double lSumRingBuffer = OnLinePattern(aRingBuffer,NbOfCycles,
+                                        WindowSize,NbOfNewSamples);
+  gettimeofday(&end,0);
+  double lTimeRingBuffer = ElapsedTime(begin,end);
+
+  cout << "std::deque : " << lTimeDeque/NbOfCycles
+       << " us per cycle" << endl;
+  cout << "RingBuffer : " << lTimeRingBuffer/NbOfCycles
+       << " us per cycle" << endl;
+
+  if (lSumDeque!=lSumRingBuffer)
+  {
+    cerr << "Different results on the on-line pattern" << endl;
+    return -1;
+  }
+  return 0;
+}
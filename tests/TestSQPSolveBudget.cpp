@@ -0,0 +1,215 @@
+/*
+ * Copyright 2019,
+ *
+ * Olivier Stasse
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+/*! \file TestSQPSolveBudget.cpp
+  \brief Walk with Naveau 2015 and check that the SQP solve is bounded
+  by :sqpmaxiterations and :sqpsolvebudget, and that the interface
+  reports it.
+
+  The number of iterations cut by the budget depends on the duration
+  of the solves, so the trajectories are not compared with a reference.
+*/
+
+#include <cmath>
+
+#include "Debug.hh"
+#include "CommonTools.hh"
+#include "TestObject.hh"
+
+using namespace::PatternGeneratorJRL;
+using namespace::PatternGeneratorJRL::TestSuite;
+using namespace std;
+
+class TestSQPSolveBudget: public TestObject
+{
+public:
+  TestSQPSolveBudget(int argc, char *argv[], string &aTestName):
+    TestObject(argc,argv,aTestName)
+  {
+    m_DebugFGPI = false;
+    m_DebugFGPIFull = false;
+    m_MaxNbOfIterations = 5;
+  }
+
+  bool Run()
+  {
+    PatternGeneratorInterface & aPGI = *m_PGI;
+    CommonInitialization(aPGI);
+    {
+      istringstream strm2(":SetAlgoForZmpTrajectory Naveau");
+      aPGI.ParseCmd(strm2);
+    }
+    {
+      istringstream strm2(":singlesupporttime 0.7");
+      aPGI.ParseCmd(strm2);
+    }
+    {
+      istringstream strm2(":doublesupporttime 0.1");
+      aPGI.ParseCmd(strm2);
+    }
+    {
+      istringstream strm2(":NaveauOnline");
+      aPGI.ParseCmd(strm2);
+    }
+    {
+      istringstream strm2(":setfeetconstraint XY 0.095 0.055");
+      aPGI.ParseCmd(strm2);
+    }
+    {
+      istringstream strm2(":deleteallobstacles");
+      aPGI.ParseCmd(strm2);
+    }
+    {
+      istringstream strm2(":useDynamicFilter false");
+      aPGI.ParseCmd(strm2);
+    }
+    {
+      ostringstream oss;
+      oss << ":sqpmaxiterations " << m_MaxNbOfIterations;
+      istringstream strm2(oss.str());
+      aPGI.ParseCmd(strm2);
+    }
+    aPGI.setVelocityReference(0.2,0.0,0.1);
+
+    SQPSolveStatus aStatus;
+    if (!aPGI.GetSQPSolveStatus(aStatus))
+    {
+      cerr << "No SQP solve status for Naveau 2015" << endl;
+      return false;
+    }
+
+    // Without budget, the iterations stop on convergence only.
+    unsigned int lMaxNbOfIterations = 0, lNbOfCutSolves = 0;
+    if (!Walk(400,lMaxNbOfIterations,lNbOfCutSolves))
+      return false;
+    cout << "Without budget: up to " << lMaxNbOfIterations
+         << " iterations" << endl;
+    if (lNbOfCutSolves>0)
+    {
+      cerr << "Deadline reached without budget" << endl;
+      return false;
+    }
+    if (lMaxNbOfIterations<2)
+    {
+      cerr << "The solves never iterate, the budget cannot be tested"
+           << endl;
+      return false;
+    }
+
+    // A budget shorter than any iteration: only the first one is done.
+    {
+      istringstream strm2(":sqpsolvebudget 0.000001");
+      aPGI.ParseCmd(strm2);
+    }
+    lMaxNbOfIterations = lNbOfCutSolves = 0;
+    if (!Walk(400,lMaxNbOfIterations,lNbOfCutSolves))
+      return false;
+    cout << "With budget: up to " << lMaxNbOfIterations
+         << " iterations, " << lNbOfCutSolves << " solves cut" << endl;
+    if ((lMaxNbOfIterations!=1) || (lNbOfCutSolves==0))
+    {
+      cerr << "The budget does not cut the solves" << endl;
+      return false;
+    }
+
+    // Removing the budget restores the iterations.
+    {
+      istringstream strm2(":sqpsolvebudget 0");
+      aPGI.ParseCmd(strm2);
+    }
+    lMaxNbOfIterations = lNbOfCutSolves = 0;
+    if (!Walk(400,lMaxNbOfIterations,lNbOfCutSolves))
+      return false;
+    if ((lNbOfCutSolves>0) || (lMaxNbOfIterations<2))
+    {
+      cerr << "The budget has not been removed" << endl;
+      return false;
+    }
+    return true;
+  }
+
+protected:
+  /*! Run the control loop and check the status of each solve.
+    Returns the largest number of iterations and the number of solves
+    stopped by the budget. */
+  bool Walk(unsigned int NbOfIterations,
+            unsigned int & MaxNbOfIterations,
+            unsigned int & NbOfCutSolves)
+  {
+    for(unsigned int i=0;i<NbOfIterations;i++)
+    {
+      if (!m_PGI->RunOneStepOfTheControlLoop(m_CurrentConfiguration,
+                                             m_CurrentVelocity,
+                                             m_CurrentAcceleration,
+                                             m_OneStep.m_ZMPTarget,
+                                             m_OneStep.m_finalCOMPosition,
+                                             m_OneStep.m_LeftFootPosition,
+                                             m_OneStep.m_RightFootPosition))
+      {
+        cerr << "The control loop stopped" << endl;
+        return false;
+      }
+
+      SQPSolveStatus aStatus;
+      m_PGI->GetSQPSolveStatus(aStatus);
+      if ((aStatus.NbOfIterations>m_MaxNbOfIterations) ||
+          (aStatus.ConstraintViolation<0.0) ||
+          (aStatus.Duration<aStatus.MaxIterationDuration) ||
+          (aStatus.DeadlineReached && aStatus.Converged))
+      {
+        cerr << "Wrong SQP status: " << aStatus.NbOfIterations
+             << " iterations, violation " << aStatus.ConstraintViolation
+             << ", duration " << aStatus.Duration << " s, longest iteration "
+             << aStatus.MaxIterationDuration << " s" << endl;
+        return false;
+      }
+      if (aStatus.NbOfIterations>MaxNbOfIterations)
+        MaxNbOfIterations = aStatus.NbOfIterations;
+      if (aStatus.DeadlineReached)
+        NbOfCutSolves++;
+    }
+    return true;
+  }
+
+  void chooseTestProfile() {}
+  void generateEvent() {}
+
+  unsigned int m_MaxNbOfIterations;
+};
+
+int main(int argc, char *argv[])
+{
+  if (argc<3)
+  {
+    cerr << "Usage: " << argv[0] << " robot.urdf robot.srdf" << endl;
+    return -1;
+  }
+
+  string TestName("TestSQPSolveBudget");
+  TestSQPSolveBudget aTestSQPSolveBudget(argc,argv,TestName);
+  if (!aTestSQPSolveBudget.init())
+    return -1;
+  if (!aTestSQPSolveBudget.Run())
+    return -1;
+  return 0;
+}
@@ -0,0 +1,252 @@
+/*
+ * Copyright 2019,
+ *
+ * Olivier Stasse
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+/*! \file TestSnapshot.cpp
+  \brief Check that restoring a snapshot of the pattern generator
+  replays exactly the same trajectories, and measure the cost of
+  Snapshot() and Restore(). The profile is given by the name of the
+  executable: Herdt 2010 (TestSnapshot), Herdt 2010 with the incremental
+  dynamic filter (TestSnapshotDynamicFilter) and Naveau 2015
+  (TestSnapshotNaveau).
+*/
+
+#include "Debug.hh"
+#include "CommonTools.hh"
+#include "TestObject.hh"
+
+using namespace::PatternGeneratorJRL;
+using namespace::PatternGeneratorJRL::TestSuite;
+using namespace std;
+
+enum Profiles_t {
+  PROFIL_HERDT,
+  PROFIL_HERDT_DYNAMIC_FILTER,
+  PROFIL_NAVEAU
+};
+
+class TestSnapshot: public TestObject
+{
+public:
+  TestSnapshot(int argc, char *argv[], string &aTestName, int TestProfile):
+    TestObject(argc,argv,aTestName)
+  {
+    m_TestProfile = TestProfile;
+    m_DebugFGPI = false;
+    m_DebugFGPIFull = false;
+  }
+
+  bool Run()
+  {
+    PatternGeneratorInterface & aPGI = *m_PGI;
+    CommonInitialization(aPGI);
+    if (m_TestProfile==PROFIL_NAVEAU)
+      InitializeNaveau(aPGI);
+    else
+      InitializeHerdt(aPGI);
+
+    // Walk for 1 s before taking the snapshot.
+    vector<double> lDummy;
+    if (!Walk(200,lDummy))
+      return false;
+
+    SnapshotHandle aHandle = aPGI.Snapshot();
+    if (aHandle<0)
+    {
+      cerr << "The snapshot failed" << endl;
+      return false;
+    }
+
+    // Branch A, then branch B, then branch A again from the snapshot.
+    vector<double> lFirstA, lSecondA;
+    aPGI.setVelocityReference(0.1,0.1,0.2);
+    if (!Walk(400,lFirstA))
+      return false;
+
+    if (!aPGI.Restore(aHandle))
+      return false;
+    aPGI.setVelocityReference(0.0,0.0,0.0);
+    if (!Walk(400,lDummy))
+      return false;
+
+    if (!aPGI.Restore(aHandle))
+      return false;
+    aPGI.setVelocityReference(0.1,0.1,0.2);
+    if (!Walk(400,lSecondA))
+      return false;
+
+    if (lFirstA!=lSecondA)
+    {
+      cerr << "The replayed branch differs from the first one" << endl;
+      return false;
+    }
+    aPGI.ReleaseSnapshot(aHandle);
+
+    // Cost of a snapshot once its storage has been allocated.
+    const unsigned int NbOfSnapshots=1000;
+    struct timeval begin,end;
+    double lSnapshotTime=0.0, lRestoreTime=0.0;
+    for(unsigned int i=0;i<NbOfSnapshots;i++)
+    {
+      gettimeofday(&begin,0);
+      aHandle = aPGI.Snapshot();
+      gettimeofday(&end,0);
+      lSnapshotTime += (double)(end.tv_sec-begin.tv_sec)*1e6 +
+        (double)(end.tv_usec-begin.tv_usec);
+
+      gettimeofday(&begin,0);
+      aPGI.Restore(aHandle);
+      gettimeofday(&end,0);
+      lRestoreTime += (double)(end.tv_sec-begin.tv_sec)*1e6 +
+        (double)(end.tv_usec-begin.tv_usec);
+      aPGI.ReleaseSnapshot(aHandle);
+    }
+    cout << "Snapshot: " << lSnapshotTime/NbOfSnapshots << " us" << endl;
+    cout << "Restore: " << lRestoreTime/NbOfSnapshots << " us" << endl;
+    return true;
+  }
+
+protected:
+  void InitializeHerdt(PatternGeneratorInterface & aPGI)
+  {
+    {
+      istringstream strm2(":SetAlgoForZmpTrajectory Herdt");
+      aPGI.ParseCmd(strm2);
+    }
+    {
+      istringstream strm2(":singlesupporttime 0.7");
+      aPGI.ParseCmd(strm2);
+    }
+    {
+      istringstream strm2(":doublesupporttime 0.1");
+      aPGI.ParseCmd(strm2);
+    }
+    if (m_TestProfile==PROFIL_HERDT_DYNAMIC_FILTER)
+    {
+      // The horizons kept by the incremental mode are part of the
+      // restored state: a branch must not reuse the postures of another.
+      {
+        istringstream strm2(":useDynamicFilter true");
+        aPGI.ParseCmd(strm2);
+      }
+      {
+        istringstream strm2(":dynamicfilterincremental 1e-9 2");
+        aPGI.ParseCmd(strm2);
+      }
+    }
+    {
+      istringstream strm2(":HerdtOnline 0.2 0.0 0.0");
+      aPGI.ParseCmd(strm2);
+    }
+  }
+
+  /*! The SQP of Naveau 2015 starts from the solution of the previous
+    iteration, which must be restored with the rest of the state. */
+  void InitializeNaveau(PatternGeneratorInterface & aPGI)
+  {
+    {
+      istringstream strm2(":SetAlgoForZmpTrajectory Naveau");
+      aPGI.ParseCmd(strm2);
+    }
+    {
+      istringstream strm2(":singlesupporttime 0.7");
+      aPGI.ParseCmd(strm2);
+    }
+    {
+      istringstream strm2(":doublesupporttime 0.1");
+      aPGI.ParseCmd(strm2);
+    }
+    {
+      istringstream strm2(":NaveauOnline");
+      aPGI.ParseCmd(strm2);
+    }
+    {
+      istringstream strm2(":setfeetconstraint XY 0.095 0.055");
+      aPGI.ParseCmd(strm2);
+    }
+    {
+      istringstream strm2(":deleteallobstacles");
+      aPGI.ParseCmd(strm2);
+    }
+    {
+      istringstream strm2(":useDynamicFilter false");
+      aPGI.ParseCmd(strm2);
+    }
+  }
+
+  /*! Run the control loop and store the ZMP, CoM and feet positions. */
+  bool Walk(unsigned int NbOfIterations, vector<double> & Trajectory)
+  {
+    Trajectory.clear();
+    for(unsigned int i=0;i<NbOfIterations;i++)
+    {
+      if (!m_PGI->RunOneStepOfTheControlLoop(m_CurrentConfiguration,
+                                             m_CurrentVelocity,
+                                             m_CurrentAcceleration,
+                                             m_OneStep.m_ZMPTarget,
+                                             m_OneStep.m_finalCOMPosition,
+                                             m_OneStep.m_LeftFootPosition,
+                                             m_OneStep.m_RightFootPosition))
+        return false;
+      Trajectory.push_back(m_OneStep.m_ZMPTarget(0));
+      Trajectory.push_back(m_OneStep.m_ZMPTarget(1));
+      Trajectory.push_back(m_OneStep.m_finalCOMPosition.x[0]);
+      Trajectory.push_back(m_OneStep.m_finalCOMPosition.y[0]);
+      Trajectory.push_back(m_OneStep.m_LeftFootPosition.x);
+      Trajectory.push_back(m_OneStep.m_LeftFootPosition.z);
+      Trajectory.push_back(m_OneStep.m_RightFootPosition.y);
+      Trajectory.push_back(m_OneStep.m_RightFootPosition.theta);
+    }
+    return true;
+  }
+
+  void chooseTestProfile() {}
+  void generateEvent() {}
+
+  int m_TestProfile;
+};
+
+int main(int argc, char *argv[])
+{
+  if (argc<3)
+  {
+    cerr << "Usage: " << argv[0] << " robot.urdf robot.srdf" << endl;
+    return -1;
+  }
+
+  string CompleteName(argv[0]);
+  std::size_t found = CompleteName.find_last_of("/\\");
+  string TestName = CompleteName.substr(found+1);
+
+  int TestProfile = PROFIL_HERDT;
+  if (TestName.find("DynamicFilter")!=string::npos)
+    TestProfile = PROFIL_HERDT_DYNAMIC_FILTER;
+  else if (TestName.find("Naveau")!=string::npos)
+    TestProfile = PROFIL_NAVEAU;
+
+  TestSnapshot aTestSnapshot(argc,argv,TestName,TestProfile);
+  if (!aTestSnapshot.init())
+    return -1;
+  if (!aTestSnapshot.Run())
+    return -1;
+  return 0;
+}
@@ -0,0 +1,219 @@
+/*
+ * Copyright 2019,
+ *
+ * Olivier Stasse
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+/*! \file TestTraceRecorder.cpp
+  \brief Record traces from several threads, convert them back
+  to .dat files and compare the cost of a record with the text
+  dump of ODEBUG4SIMPLE.
+*/
+
+#include <stdio.h>
+#include <sys/time.h>
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
+
+#include "TraceRecorder.hh"
+
+using namespace std;
+using namespace PatternGeneratorJRL;
+
+const unsigned int NB_OF_THREADS=4;
+const unsigned int NB_OF_RECORDS=2000;
+const unsigned int WIDE_LINE=100;
+
+double ElapsedTime(struct timeval &begin, struct timeval &end)
+{
+  return (double)(end.tv_sec-begin.tv_sec)*1e6 +
+    (double)(end.tv_usec-begin.tv_usec);
+}
+
+string ChannelName(unsigned int ThreadId)
+{
+  ostringstream aName;
+  aName << "TestTraceRecorder-" << ThreadId << ".dat";
+  return aName.str();
+}
+
+/*! Each thread writes on its own channel, pausing now and then
+  as a control loop would. */
+void Producer(unsigned int ThreadId)
+{
+  TraceRecorder & aRecorder = TraceRecorder::Instance();
+  unsigned int lChannel = aRecorder.Channel(ChannelName(ThreadId));
+  for(unsigned int i=0;i<NB_OF_RECORDS;i++)
+  {
+    TraceEntry(lChannel) << i << " " << ThreadId << " " << 0.5*i;
+    if (i%100==99)
+      boost::this_thread::sleep(boost::posix_time::milliseconds(2));
+  }
+}
+
+/*! Check the lines of a converted file, returns the number of lines. */
+int CheckDatFile(unsigned int ThreadId)
+{
+  ifstream aof(ChannelName(ThreadId).c_str());
+  if (!aof.is_open())
+    return -1;
+
+  int lNbOfLines=0;
+  double lIndex, lThreadId, lHalf, lPrevious=-1.0;
+  while (aof >> lIndex >> lThreadId >> lHalf)
+  {
+    if ((lThreadId!=ThreadId) || (lHalf!=0.5*lIndex) || (lIndex<=lPrevious))
+    {
+      cerr << "Wrong line " << lNbOfLines << " in "
+           << ChannelName(ThreadId) << endl;
+      return -1;
+    }
+    lPrevious = lIndex;
+    lNbOfLines++;
+  }
+  return lNbOfLines;
+}
+
+bool CheckRecordAndConvert()
+{
+  TraceRecorder & aRecorder = TraceRecorder::Instance();
+  if (!aRecorder.Start("TestTraceRecorder.trace"))
+  {
+    cerr << "Unable to start the recorder" << endl;
+    return false;
+  }
+
+  boost::thread_group lThreads;
+  for(unsigned int i=0;i<NB_OF_THREADS;i++)
+    lThreads.create_thread(boost::bind(&Producer,i));
+
+  // A line longer than a record, written while the threads run.
+  {
+    TraceEntry aWideEntry(aRecorder.Channel("TestTraceRecorder-Wide.dat"));
+    for(unsigned int i=0;i<WIDE_LINE;i++)
+      aWideEntry << i;
+  }
+  lThreads.join_all();
+  aRecorder.Stop();
+
+  unsigned long int lNbOfRecords = NB_OF_THREADS*NB_OF_RECORDS
+    + (WIDE_LINE+TRACE_MAX_VALUES-1)/TRACE_MAX_VALUES;
+  if (aRecorder.NbOfWritten()+aRecorder.NbOfDropped()!=lNbOfRecords)
+  {
+    cerr << "Records lost: " << aRecorder.NbOfWritten() << " written, "
+         << aRecorder.NbOfDropped() << " dropped" << endl;
+    return false;
+  }
+
+  if (TraceRecorder::ConvertToDat("TestTraceRecorder.trace",".")
+      !=(int)NB_OF_THREADS+1)
+  {
+    cerr << "Wrong number of converted files" << endl;
+    return false;
+  }
+
+  if (aRecorder.NbOfDropped()==0)
+  {
+    ifstream aof("TestTraceRecorder-Wide.dat");
+    double lValue;
+    unsigned int lNbOfValues=0;
+    while (aof >> lValue)
+      if (lValue!=lNbOfValues++)
+        break;
+    if (lNbOfValues!=WIDE_LINE)
+    {
+      cerr << "Wrong wide line" << endl;
+      return false;
+    }
+  }
+
+  unsigned long int lNbOfLines=0;
+  for(unsigned int i=0;i<NB_OF_THREADS;i++)
+  {
+    int lNbOfThreadLines = CheckDatFile(i);
+    if (lNbOfThreadLines<0)
+      return false;
+    lNbOfLines += lNbOfThreadLines;
+  }
+  // Without dropped records, every line has to be there.
+  if ((lNbOfLines>NB_OF_THREADS*NB_OF_RECORDS) ||
+      ((aRecorder.NbOfDropped()==0) &&
+       (lNbOfLines!=NB_OF_THREADS*NB_OF_RECORDS)))
+  {
+    cerr << "Wrong number of lines" << endl;
+    return false;
+  }
+  return true;
+}
+
+/*! Cost of one record, compared with opening the text file
+  and appending one line as ODEBUG4SIMPLE does. */
+void CompareWithTextDump()
+{
+  const unsigned int NbOfSamples=1000;
+  struct timeval begin,end;
+
+  TraceRecorder & aRecorder = TraceRecorder::Instance();
+  aRecorder.Start("TestTraceRecorder.trace");
+  gettimeofday(&begin,0);
+  for(unsigned int i=0;i<NbOfSamples;i++)
+  {
+    OTRACE(i << " " << 0.1*i << " " << 0.2*i,"TestTraceRecorder-Timing.dat");
+  }
+  gettimeofday(&end,0);
+  aRecorder.Stop();
+  double lTimeTrace = ElapsedTime(begin,end);
+
+  gettimeofday(&begin,0);
+  for(unsigned int i=0;i<NbOfSamples;i++)
+  {
+    std::ofstream DebugFile;
+    DebugFile.open("TestTraceRecorder-Text.dat",ofstream::app);
+    DebugFile << i << " " << 0.1*i << " " << 0.2*i << std::endl;
+    DebugFile.close();
+  }
+  gettimeofday(&end,0);
+  double lTimeText = ElapsedTime(begin,end);
+  remove("TestTraceRecorder-Text.dat");
+
+  cout << "Trace record : " << lTimeTrace/NbOfSamples << " us" << endl;
+  cout << "Text dump    : " << lTimeText/NbOfSamples << " us" << endl;
+}
+
+int main()
+{
+  if (!CheckRecordAndConvert())
+    return -1;
+  CompareWithTextDump();
+
+  // Nothing is recorded once stopped.
+  TraceRecorder & aRecorder = TraceRecorder::Instance();
+  unsigned long int lNbOfWritten = aRecorder.NbOfWritten();
+  OTRACE(1.0,"TestTraceRecorder-Timing.dat");
+  if (aRecorder.NbOfWritten()!=lNbOfWritten)
+    return -1;
+  return 0;
+}
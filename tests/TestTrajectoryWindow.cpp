@@ -0,0 +1,216 @@
+/*
+ * Copyright 2019,
+ *
+ * Olivier Stasse
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+/*! \file TestTrajectoryWindow.cpp
+  \brief Check the columns exported by GetTrajectoryWindow() against the
+  CoM, ZMP and feet buffers of the pattern generator (Herdt 2010).
+
+  The buffers are popped by each control cycle, so sample i of a window
+  is what the i-th next call to RunOneStepOfTheControlLoop() returns,
+  unless the QP replans the trajectory in between.
+*/
+
+#include "Debug.hh"
+#include "CommonTools.hh"
+#include "TestObject.hh"
+
+using namespace::PatternGeneratorJRL;
+using namespace::PatternGeneratorJRL::TestSuite;
+using namespace std;
+
+class TestTrajectoryWindow: public TestObject
+{
+public:
+  TestTrajectoryWindow(int argc, char *argv[], string &aTestName):
+    TestObject(argc,argv,aTestName)
+  {
+    m_DebugFGPI = false;
+    m_DebugFGPIFull = false;
+  }
+
+  bool Run()
+  {
+    PatternGeneratorInterface & aPGI = *m_PGI;
+    CommonInitialization(aPGI);
+    {
+      istringstream strm2(":SetAlgoForZmpTrajectory Herdt");
+      aPGI.ParseCmd(strm2);
+    }
+    {
+      istringstream strm2(":singlesupporttime 0.7");
+      aPGI.ParseCmd(strm2);
+    }
+    {
+      istringstream strm2(":doublesupporttime 0.1");
+      aPGI.ParseCmd(strm2);
+    }
+    {
+      istringstream strm2(":HerdtOnline 0.2 0.0 0.0");
+      aPGI.ParseCmd(strm2);
+    }
+
+    // Walk for 1 s so that the buffers are filled.
+    for(unsigned int i=0;i<200;i++)
+      if (!RunOneStep())
+        return false;
+    aPGI.setVelocityReference(0.1,0.1,0.2);
+
+    // A window larger than the buffers is clipped.
+    TrajectoryWindow aWindow;
+    unsigned int lSize = aPGI.GetTrajectoryWindow(100000,aWindow);
+    if ((lSize==0) || (lSize>=100000) ||
+        (aWindow.Time.size()!=(int)lSize) ||
+        (aWindow.ZMP.rows()!=(int)lSize) ||
+        (aWindow.CoM.rows()!=(int)lSize) ||
+        (aWindow.LeftFoot.rows()!=(int)lSize) ||
+        (aWindow.RightFoot.rows()!=(int)lSize))
+    {
+      cerr << "The clipped window has " << lSize << " samples" << endl;
+      return false;
+    }
+
+    // The window taken before cycle t is checked against the outputs
+    // of the cycles t to t+NbOfSamples-1 which do not follow a replan.
+    const unsigned int NbOfSamples=15, NbOfCycles=400;
+    vector<TrajectoryWindow> lWindows(NbOfSamples);
+    vector<unsigned int> lNbOfChecks(NbOfSamples,0);
+    StageLatency aLatency;
+    aPGI.GetStageLatency(STAGE_QP_SOLVE,aLatency);
+    unsigned long int lNbOfSolves = aLatency.Count;
+    int lLastReplan = -1;
+
+    for(unsigned int t=0;t<NbOfCycles;t++)
+    {
+      TrajectoryWindow & aCurrent = lWindows[t%NbOfSamples];
+      if (aPGI.GetTrajectoryWindow(NbOfSamples,aCurrent)!=NbOfSamples)
+      {
+        cerr << "The window of cycle " << t << " is too short" << endl;
+        return false;
+      }
+      if (!RunOneStep())
+        return false;
+
+      aPGI.GetStageLatency(STAGE_QP_SOLVE,aLatency);
+      if (aLatency.Count!=lNbOfSolves)
+        lLastReplan = (int)t;
+      lNbOfSolves = aLatency.Count;
+
+      for(unsigned int i=0;(i<NbOfSamples) && (i<=t);i++)
+      {
+        if ((int)(t-i)<=lLastReplan)
+          break;
+        if (!CheckSample(lWindows[(t-i)%NbOfSamples],i))
+        {
+          cerr << "Sample " << i << " of the window of cycle " << t-i
+               << " differs from the output of cycle " << t << endl;
+          return false;
+        }
+        lNbOfChecks[i]++;
+      }
+    }
+
+    for(unsigned int i=0;i<NbOfSamples;i++)
+    {
+      if (lNbOfChecks[i]==0)
+      {
+        cerr << "Sample " << i << " of the windows was never checked"
+             << endl;
+        return false;
+      }
+    }
+    cout << "Checked " << lNbOfChecks[0] << " windows" << endl;
+    return true;
+  }
+
+protected:
+  bool RunOneStep()
+  {
+    return m_PGI->RunOneStepOfTheControlLoop(m_CurrentConfiguration,
+                                             m_CurrentVelocity,
+                                             m_CurrentAcceleration,
+                                             m_OneStep.m_ZMPTarget,
+                                             m_OneStep.m_finalCOMPosition,
+                                             m_OneStep.m_LeftFootPosition,
+                                             m_OneStep.m_RightFootPosition);
+  }
+
+  /*! Compare the last outputs of the control loop with the sample
+    i of aWindow. The values are copies, so they must be equal. */
+  bool CheckSample(const TrajectoryWindow & aWindow, unsigned int i)
+  {
+    const COMState & aCOM = m_OneStep.m_finalCOMPosition;
+    if (aWindow.Time(i)!=m_OneStep.m_LeftFootPosition.time)
+      return false;
+    for(unsigned int j=0;j<3;j++)
+      if (aWindow.ZMP(i,TrajectoryWindow::ZMP_X+j)!=
+          m_OneStep.m_ZMPTarget(j))
+        return false;
+    for(unsigned int j=0;j<3;j++)
+    {
+      if ((aWindow.CoM(i,TrajectoryWindow::X+j)!=aCOM.x[j]) ||
+          (aWindow.CoM(i,TrajectoryWindow::Y+j)!=aCOM.y[j]) ||
+          (aWindow.CoM(i,TrajectoryWindow::Z+j)!=aCOM.z[j]) ||
+          (aWindow.CoM(i,TrajectoryWindow::YAW+j)!=aCOM.yaw[j]))
+        return false;
+    }
+    return CheckFoot(aWindow.LeftFoot,i,m_OneStep.m_LeftFootPosition) &&
+      CheckFoot(aWindow.RightFoot,i,m_OneStep.m_RightFootPosition);
+  }
+
+  bool CheckFoot(const TrajectoryWindow::Channels & aFoot, unsigned int i,
+                 const FootAbsolutePosition & aFAP)
+  {
+    return (aFoot(i,TrajectoryWindow::X)==aFAP.x) &&
+      (aFoot(i,TrajectoryWindow::DX)==aFAP.dx) &&
+      (aFoot(i,TrajectoryWindow::DDX)==aFAP.ddx) &&
+      (aFoot(i,TrajectoryWindow::Y)==aFAP.y) &&
+      (aFoot(i,TrajectoryWindow::DY)==aFAP.dy) &&
+      (aFoot(i,TrajectoryWindow::DDY)==aFAP.ddy) &&
+      (aFoot(i,TrajectoryWindow::Z)==aFAP.z) &&
+      (aFoot(i,TrajectoryWindow::DZ)==aFAP.dz) &&
+      (aFoot(i,TrajectoryWindow::DDZ)==aFAP.ddz) &&
+      (aFoot(i,TrajectoryWindow::YAW)==aFAP.theta) &&
+      (aFoot(i,TrajectoryWindow::DYAW)==aFAP.dtheta) &&
+      (aFoot(i,TrajectoryWindow::DDYAW)==aFAP.ddtheta);
+  }
+
+  void chooseTestProfile() {}
+  void generateEvent() {}
+};
+
+int main(int argc, char *argv[])
+{
+  if (argc<3)
+  {
+    cerr << "Usage: " << argv[0] << " robot.urdf robot.srdf" << endl;
+    return -1;
+  }
+
+  string TestName("TestTrajectoryWindow");
+  TestTrajectoryWindow aTestTrajectoryWindow(argc,argv,TestName);
+  if (!aTestTrajectoryWindow.init())
+    return -1;
+  if (!aTestTrajectoryWindow.Run())
+    return -1;
+  return 0;
+}
@@ -0,0 +1,188 @@
+/*
+ * Copyright 2019,
+ *
+ * Olivier Stasse
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+/*! \file TestWieber2006.cpp
+  \brief Walk with the linear MPC of Wieber 2006 (PBW), its QP windows
+  being solved by QLD or by the active-set solver.
+*/
+#include "CommonTools.hh"
+#include "TestObject.hh"
+
+#include <Debug.hh>
+
+using namespace::PatternGeneratorJRL;
+using namespace::PatternGeneratorJRL::TestSuite;
+using namespace std;
+
+enum Profiles_t {
+  PROFIL_STRAIGHT_WALKING        // 1
+};
+
+class TestWieber2006: public TestObject
+{
+
+private:
+public:
+  TestWieber2006(int argc, char *argv[], string &aString, int TestProfile,
+                 string QPSolver="qld",
+                 string ReferenceFileName=""):
+    TestObject(argc,argv,aString),
+    m_QPSolver(QPSolver)
+  {
+    m_TestProfile = TestProfile;
+    if (ReferenceFileName.size()>0)
+      m_ReferenceFileName = ReferenceFileName;
+  }
+
+protected:
+
+  /*! Solver of the QP windows: qld or activeset. */
+  string m_QPSolver;
+
+  void StraightWalking(PatternGeneratorInterface &aPGI)
+  {
+    CommonInitialization(aPGI);
+    {
+      istringstream strm2(":SetAlgoForZmpTrajectory PBW");
+      aPGI.ParseCmd(strm2);
+    }
+
+    {
+      istringstream strm2(":setpbwconstraint solver "+m_QPSolver);
+      aPGI.ParseCmd(strm2);
+    }
+
+    {
+      istringstream strm2(":stepseq 0.0 -0.105 0.0 0.0 \
+                     0.2 0.21 0.0 0.0 \
+                     0.2 -0.21 0.0 0.0 \
+                     0.2 0.21 0.0 0.0 \
+                     0.2 -0.21 0.0 0.0 \
+                     0.2 0.21 0.0 0.0 \
+                     0.0 -0.21 0.0 0.0");
+      aPGI.ParseCmd(strm2);
+    }
+  }
+
+  void chooseTestProfile()
+  {
+
+    switch(m_TestProfile)
+      {
+
+      case PROFIL_STRAIGHT_WALKING:
+	StraightWalking(*m_PGI);
+	break;
+      default:
+	throw("No correct test profile");
+	break;
+      }
+  }
+
+  void generateEvent()
+  {
+  }
+};
+
+int PerformTests(int argc, char *argv[])
+{
+
+  std::string CompleteName = string(argv[0]);
+  std::size_t found = CompleteName.find_last_of("/\\");
+  std::string TestName =  CompleteName.substr(found+1);
+
+  int indexProfile=-1;
+
+  if (TestName.compare(14,15,"StraightWalking")==0)
+    indexProfile=PROFIL_STRAIGHT_WALKING;
+
+  if (indexProfile==-1)
+    {
+      std::cerr << "CompleteName: " << CompleteName << std::endl;
+      std::cerr<< " TestName: " << TestName <<std::endl;
+      std::cerr<< "Failure to find the proper indexFile:"
+	       << TestName.substr(14,15) << endl;
+      exit(-1);
+    }
+
+  std::string QPSolver("qld");
+  std::string ReferenceFileName;
+  std::size_t ActiveSet = TestName.find("ActiveSet");
+  if (ActiveSet!=std::string::npos)
+    {
+      QPSolver = "activeset";
+      // The active-set solver has to find the reference of QLD.
+      std::string QLDName(TestName);
+      QLDName.erase(ActiveSet,9);
+      ReferenceFileName = QLDName + "TestFGPI.datref";
+      std::ifstream aReferenceFile(ReferenceFileName.c_str());
+      // Without reference file, the trajectories of QLD
+      // are computed on the same scenario.
+      if (!aReferenceFile.is_open())
+	{
+	  std::string ReferenceName = QLDName + "QLD";
+	  TestWieber2006 aReference(argc,argv,
+				    ReferenceName,
+				    indexProfile);
+	  aReference.init();
+	  std::ostringstream aLog;
+	  aReference.doTest(aLog);
+	  ReferenceFileName = ReferenceName + "TestFGPI.dat";
+	}
+    }
+
+  TestWieber2006 aTW2006(argc,argv,
+			 TestName,
+			 indexProfile,
+			 QPSolver,
+			 ReferenceFileName);
+  aTW2006.init();
+  try
+    {
+      if (!aTW2006.doTest(std::cout))
+	{
+	  cout << "Failed test " << indexProfile << endl;
+	  return -1;
+	}
+      else
+	cout << "Passed test " << indexProfile << endl;
+    }
+  catch (const char * astr)
+    { cerr << "Failed on following error " << astr << std::endl;
+      return -1; }
+
+  return 0;
+}
+
+int main(int argc, char *argv[])
+{
+  try
+    {
+      return PerformTests(argc,argv);
+    }
+  catch (const std::string& msg)
+    {
+      std::cerr << msg << std::endl;
+    }
+  return 1;
+}